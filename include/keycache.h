@@ -30,6 +30,7 @@ struct st_keycache_page;
 typedef struct st_keycache_page KEYCACHE_PAGE;
 struct st_hash_link;
 typedef struct st_hash_link HASH_LINK;
+struct st_keycache_part_cache;
 
 /* info about requests in a waiting queue */
 typedef struct st_keycache_wqueue
@@ -94,6 +95,7 @@ typedef struct st_key_cache
   ulonglong param_block_size;     /* size of the blocks in the key cache      */
   ulonglong param_division_limit; /* min. percentage of warm blocks           */
   ulonglong param_age_threshold;  /* determines when hot block is downgraded  */
+  ulonglong param_partitions;     /* number of partitions, 0 for one lock     */
 
   /* Statistics variables. These are reset in reset_key_cache_counters(). */
   ulong global_blocks_changed;	/* number of currently dirty blocks         */
@@ -104,6 +106,12 @@ typedef struct st_key_cache
 
   int blocks;                   /* max number of blocks in the cache        */
   my_bool in_init;		/* Set to 1 in MySQL during init/resize     */
+
+  /*
+    Set if the key cache was created with param_partitions > 0, the
+    functions below then use the partitioned key cache (mf_keycache_part.c)
+  */
+  struct st_keycache_part_cache *part_cache;
 } KEY_CACHE;
 
 /* The default key cache */
@@ -142,5 +150,6 @@ extern void multi_key_cache_change(KEY_CACHE *old_data,
 				   KEY_CACHE *new_data);
 extern int reset_key_cache_counters(const char *name,
                                     KEY_CACHE *key_cache);
+extern void update_key_cache_stats(KEY_CACHE *keycache);
 C_MODE_END
 #endif /* _keycache_h */
@@ -866,6 +866,8 @@ extern void init_alloc_root(MEM_ROOT *mem_root, size_t block_size,
 extern void *alloc_root(MEM_ROOT *mem_root, size_t Size);
 extern void *multi_alloc_root(MEM_ROOT *mem_root, ...);
 extern void free_root(MEM_ROOT *root, myf MyFLAGS);
+extern void recycle_root(MEM_ROOT *root, size_t *recycle_size,
+                         size_t min_size, size_t max_size);
 extern void set_prealloc_root(MEM_ROOT *root, char *ptr);
 extern void reset_root_defaults(MEM_ROOT *mem_root, size_t block_size,
                                 size_t prealloc_size);
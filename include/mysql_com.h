@@ -845,5 +845,6 @@ unsigned int net_length_size(ulonglong num);
 #define QATTR_RPC_ID "rpc_id"
 #define QATTR_RPC_ROLE "rpc_role"
 #define QATTR_RPC_DB "rpc_db"
+#define QATTR_RPC_TAG "rpc_tag"
 
 #endif
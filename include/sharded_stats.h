@@ -0,0 +1,128 @@
+/* Copyright (c) 2020, Facebook, Inc.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA */
+
+/* A block of statistics counters sharded by CPU.
+
+   Counters that every statement updates (user, db and table statistics)
+   bounce their cache line between all CPUs running statements for the same
+   user, db or table. sharded_stats keeps one copy of a counter block per
+   shard, a cache line apart, and writers update the copy of the CPU they
+   run on. The copies are only summed when the statistics are read.
+
+   The counters in a block are atomic_stat, so a thread that migrates to
+   another CPU between picking a shard and updating it does not lose
+   updates. Like atomic_stat, the sums are only approximately consistent.
+
+   The statistics structs are allocated with my_malloc(), which does not
+   align them to cache lines, so the shards are placed at the first cache
+   line boundary of a buffer one line longer than they need. A block then
+   takes SHARDED_STATS_SHARDS cache lines per started 64 bytes of
+   counters, plus one line: about 1KB for a block of up to 8 counters.
+   The blocks must not be copied, as that would move them relative to
+   the cache lines.
+
+   BLOCK must be a struct of atomic_stat members with a clear() method.
+   Like the structs that contain them, blocks in memory from my_malloc()
+   are not constructed, and must be cleared before use.
+*/
+
+#ifndef _sharded_stats_h_
+#define _sharded_stats_h_
+
+#include "my_global.h"
+#include "atomic_stat.h"
+
+#ifdef HAVE_SCHED_GETCPU
+#include <sched.h>
+#endif
+
+#include <atomic>
+#include <new>
+
+/* Number of shards, must be a power of 2 */
+#define SHARDED_STATS_SHARDS 16
+
+#ifndef CPU_LEVEL1_DCACHE_LINESIZE
+#define CPU_LEVEL1_DCACHE_LINESIZE 64
+#endif
+
+/* The shard of the calling thread, the CPU it runs on when known. */
+static inline uint sharded_stats_index()
+{
+#ifdef HAVE_SCHED_GETCPU
+  int cpu= sched_getcpu();
+  if (cpu >= 0)
+    return (uint) cpu;
+#endif
+  /* Otherwise spread threads round robin over the shards */
+  static std::atomic<uint> next_index(0);
+  static thread_local uint index=
+    next_index.fetch_add(1, std::memory_order_relaxed);
+  return index;
+}
+
+template <typename BLOCK, uint N = SHARDED_STATS_SHARDS>
+class sharded_stats {
+public:
+  sharded_stats()
+  {
+    for (uint i= 0; i < N; ++i)
+      new (&shard(i)) BLOCK();
+  }
+
+  /* The block the calling thread should update */
+  BLOCK &local()
+  {
+    return shard(sharded_stats_index() & (N - 1));
+  }
+
+  /* Sum of a counter over all the shards */
+  template <typename TYPE>
+  TYPE load(atomic_stat<TYPE> BLOCK::*member) const
+  {
+    TYPE total= TYPE();
+    for (uint i= 0; i < N; ++i)
+      total+= (shard(i).*member).load();
+    return total;
+  }
+
+  void clear()
+  {
+    for (uint i= 0; i < N; ++i)
+      shard(i).clear();
+  }
+
+private:
+  static_assert((N & (N - 1)) == 0, "the number of shards must be a power of 2");
+
+  /* Distance between the shards, a multiple of the cache line size */
+  static const size_t shard_size=
+    (sizeof(BLOCK) + CPU_LEVEL1_DCACHE_LINESIZE - 1) &
+    ~(size_t) (CPU_LEVEL1_DCACHE_LINESIZE - 1);
+
+  sharded_stats(const sharded_stats &);
+  sharded_stats &operator=(const sharded_stats &);
+
+  BLOCK &shard(uint i) const
+  {
+    uintptr_t first= ((uintptr_t) m_buffer + CPU_LEVEL1_DCACHE_LINESIZE - 1) &
+                     ~(uintptr_t) (CPU_LEVEL1_DCACHE_LINESIZE - 1);
+    return *reinterpret_cast<BLOCK*>(first + i * shard_size);
+  }
+
+  char m_buffer[N * shard_size + CPU_LEVEL1_DCACHE_LINESIZE - 1];
+};
+
+#endif // _sharded_stats_h_
@@ -374,6 +374,12 @@ int init_key_cache(KEY_CACHE *keycache, uint key_cache_block_size,
   DBUG_ASSERT(key_cache_block_size >= 512);
 
   KEYCACHE_DEBUG_OPEN;
+  /* A key cache created partitioned stays partitioned */
+  if (keycache->part_cache ||
+      (!keycache->key_cache_inited && keycache->param_partitions))
+    DBUG_RETURN(init_partitioned_key_cache(keycache, key_cache_block_size,
+                                           use_mem));
+
   if (keycache->key_cache_inited && keycache->disk_blocks > 0)
   {
     DBUG_PRINT("warning",("key cache already in use"));
@@ -567,6 +573,10 @@ int resize_key_cache(KEY_CACHE *keycache, uint key_cache_block_size,
   if (!keycache->key_cache_inited)
     DBUG_RETURN(keycache->disk_blocks);
 
+  if (keycache->part_cache)
+    DBUG_RETURN(resize_partitioned_key_cache(keycache, key_cache_block_size,
+                                             use_mem));
+
   if(key_cache_block_size == keycache->key_cache_block_size &&
      use_mem == keycache->key_cache_mem_size)
   {
@@ -698,6 +708,10 @@ void change_key_cache_param(KEY_CACHE *keycache, uint division_limit,
 {
   DBUG_ENTER("change_key_cache_param");
 
+  /* The partitioned key cache has no midpoint insertion */
+  if (keycache->part_cache)
+    DBUG_VOID_RETURN;
+
   keycache_pthread_mutex_lock(&keycache->cache_lock);
   if (division_limit)
     keycache->min_warm_blocks= (keycache->disk_blocks *
@@ -730,6 +744,12 @@ void end_key_cache(KEY_CACHE *keycache, my_bool cleanup)
   if (!keycache->key_cache_inited)
     DBUG_VOID_RETURN;
 
+  if (keycache->part_cache)
+  {
+    end_partitioned_key_cache(keycache, cleanup);
+    DBUG_VOID_RETURN;
+  }
+
   if (keycache->disk_blocks > 0)
   {
     if (keycache->block_mem)
@@ -2508,6 +2528,10 @@ uchar *key_cache_read(KEY_CACHE *keycache,
   DBUG_PRINT("enter", ("fd: %u  pos: %lu  length: %u",
                (uint) file, (ulong) filepos, length));
 
+  if (keycache->part_cache)
+    DBUG_RETURN(partitioned_key_cache_read(keycache, file, filepos,
+                                           buff, length));
+
   if (keycache->key_cache_inited)
   {
     /* Key cache is used */
@@ -2738,6 +2762,10 @@ int key_cache_insert(KEY_CACHE *keycache,
   DBUG_PRINT("enter", ("fd: %u  pos: %lu  length: %u",
                (uint) file,(ulong) filepos, length));
 
+  if (keycache->part_cache)
+    DBUG_RETURN(partitioned_key_cache_insert(keycache, file, filepos,
+                                             buff, length));
+
   if (keycache->key_cache_inited)
   {
     /* Key cache is used */
@@ -2991,6 +3019,11 @@ int key_cache_write(KEY_CACHE *keycache,
               (uint) file, (ulong) filepos, length, block_length,
               keycache ? keycache->key_cache_block_size : 0));
 
+  /* The partitioned key cache always writes through */
+  if (keycache->part_cache)
+    DBUG_RETURN(partitioned_key_cache_write(keycache, file, filepos,
+                                            buff, length));
+
   if (!dont_write)
   {
     /* purecov: begin inspected */
@@ -4043,6 +4076,9 @@ int flush_key_blocks(KEY_CACHE *keycache,
   if (!keycache->key_cache_inited)
     DBUG_RETURN(0);
 
+  if (keycache->part_cache)
+    DBUG_RETURN(partitioned_flush_key_blocks(keycache, file, type));
+
   keycache_pthread_mutex_lock(&keycache->cache_lock);
   /* While waiting for lock, keycache could have been ended. */
   if (keycache->disk_blocks > 0)
@@ -4222,10 +4258,32 @@ int reset_key_cache_counters(const char *name MY_ATTRIBUTE((unused)),
   key_cache->global_cache_read= 0;       /* Key_reads */
   key_cache->global_cache_w_requests= 0; /* Key_write_requests */
   key_cache->global_cache_write= 0;      /* Key_writes */
+  if (key_cache->part_cache)
+    partitioned_key_cache_stats(key_cache, TRUE);
   DBUG_RETURN(0);
 }
 
 
+/*
+  Update the statistics variables of a key cache
+
+  SYNOPSIS
+    update_key_cache_stats()
+    keycache            pointer to a key cache data structure
+
+  NOTES
+    The partitioned key cache keeps its statistics per partition and
+    CPU, they are summed into the key cache here. The statistics of the
+    other key caches are always up to date.
+*/
+
+void update_key_cache_stats(KEY_CACHE *keycache)
+{
+  if (keycache->key_cache_inited && keycache->part_cache)
+    partitioned_key_cache_stats(keycache, FALSE);
+}
+
+
 #ifndef DBUG_OFF
 /*
   Test if disk-cache is ok
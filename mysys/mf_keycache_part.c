@@ -0,0 +1,1146 @@
+/* Copyright (c) 2020, Facebook, Inc.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA */
+
+/**
+  @file
+  Partitioned key cache.
+
+  The key cache in mf_keycache.c serializes all requests on
+  keycache->cache_lock. A key cache created with param_partitions > 0
+  (key_cache_partitions in the server) uses the implementation in this
+  file instead, the functions in mf_keycache.c dispatch here.
+
+  - File blocks are hashed on file and position to one of the partitions.
+    Each partition has its own mutex, hash table and blocks, which are
+    replaced with the clock algorithm (an approximation of LRU: a block
+    that was used since the clock hand passed it gets a second chance).
+
+  - Every block has a pin count updated with atomic operations. Readers
+    pin a block shared (pins > 0). A thread loading, updating or evicting
+    a block pins it exclusively (pins == -1), exclusive pins are taken
+    and released with the partition mutex held only.
+
+  - All blocks are allocated when the cache is initialized and only freed
+    when it is resized or ended. So a reader can find and pin a cached
+    block without the partition mutex: it walks the hash chain, pins the
+    block and then checks that the block still holds the requested file
+    position. If anything does not match, the request is retried with the
+    partition mutex held.
+
+  - Writes go through to the file, cached blocks are updated in place.
+    There are no dirty blocks: flushing a file just drops its blocks
+    and evicting a block never does any I/O.
+
+  - A read request for several consecutive blocks that are not cached
+    reads all of them with one pread into the caller's buffer, and then
+    copies them into the cache.
+
+  - Requests register in one of KEYCACHE_PART_SLOTS counters, picked by
+    the CPU they run on. A resize blocks new requests, which bypass the
+    cache until it is done, and waits until all counters drop to zero
+    before it rebuilds the partitions. The slots also hold the statistics.
+
+  A block that is loaded from the file must not be published with data
+  older than a write that did not see the block in the cache. Threads
+  writing a block that is not cached are counted in partition->writers,
+  and partition->write_seq is bumped when they are done; a loaded block
+  is dropped instead of published if either changed while it was read.
+*/
+
+#include "mysys_priv.h"
+#include "mysys_err.h"
+#include <keycache.h>
+#include <m_string.h>
+#include <my_atomic.h>
+#include <my_bit.h>
+#include <errno.h>
+#ifdef HAVE_SCHED_GETCPU
+#include <sched.h>
+#endif
+
+#define KEYCACHE_MAX_PARTITIONS  64
+#define KEYCACHE_PART_SLOTS      64   /* must be a power of 2 */
+#define KEYCACHE_PART_FILE_HASH  128  /* must be a power of 2 */
+#define KEYCACHE_PART_MIN_BLOCKS 8    /* min number of blocks in a partition */
+#define KEYCACHE_PART_MAX_STEPS  16   /* max chain length walked unlocked */
+
+#ifndef CPU_LEVEL1_DCACHE_LINESIZE
+#define CPU_LEVEL1_DCACHE_LINESIZE 64
+#endif
+
+/*
+  The unlocked lookup must not write to the hash chains, so it needs
+  plain acquire loads: my_atomic_load*() is a read-modify-write with the
+  gcc builtins. Without them hits take the partition mutex.
+*/
+#ifdef __ATOMIC_ACQUIRE
+#define KEYCACHE_PART_LOCK_FREE_HITS
+#define part_load_acquire(A)     __atomic_load_n((A), __ATOMIC_ACQUIRE)
+#define part_store_release(A, V) __atomic_store_n((A), (V), __ATOMIC_RELEASE)
+#else
+#define part_load_acquire(A)     (*(A))
+#define part_store_release(A, V) (*(A)= (V))
+#endif
+
+typedef struct st_part_block PART_BLOCK;
+
+struct st_part_block
+{
+  PART_BLOCK * volatile hash_next;    /* next block in the hash chain        */
+  PART_BLOCK *file_next;              /* next block of a file_blocks chain   */
+  PART_BLOCK **file_prev;             /* previous link in file_blocks chain  */
+  uchar *buffer;                      /* page buffer of the block            */
+  my_off_t filepos;                   /* position of the block in the file   */
+  File file;                          /* -1 if the block is free             */
+  uint bucket;                        /* hash bucket of the block            */
+  uint length;                        /* number of bytes of the file block   */
+  volatile int32 pins;                /* shared pins, -1 if held exclusively */
+  volatile int32 accessed;            /* used since the clock hand passed    */
+};
+
+typedef struct st_keycache_part_slot
+{
+  volatile int32 ops;                 /* requests in progress                */
+  volatile int64 r_requests;          /* Key_read_requests                   */
+  volatile int64 reads;               /* Key_reads                           */
+  volatile int64 w_requests;          /* Key_write_requests                  */
+  volatile int64 writes;              /* Key_writes                          */
+  char pad[CPU_LEVEL1_DCACHE_LINESIZE];
+} KEYCACHE_PART_SLOT;
+
+typedef struct st_keycache_partition
+{
+  mysql_mutex_t lock;                 /* protects everything but pins        */
+  mysql_cond_t cond;                  /* exclusive pin released              */
+  uint waiting;                       /* threads waiting on cond             */
+  uint writers;                       /* writes of uncached blocks           */
+  ulonglong write_seq;                /* incremented when such a write ends  */
+  PART_BLOCK * volatile *hash_root;   /* hash table of cached blocks         */
+  uint hash_mask;
+  PART_BLOCK *blocks;                 /* all blocks of the partition         */
+  uint disk_blocks;                   /* number of blocks                    */
+  uint clock_hand;                    /* next block to check for eviction    */
+  ulong blocks_used;                  /* blocks holding a file block         */
+  PART_BLOCK *file_blocks[KEYCACHE_PART_FILE_HASH]; /* blocks by file        */
+  char pad[CPU_LEVEL1_DCACHE_LINESIZE];
+} KEYCACHE_PARTITION;
+
+struct st_keycache_part_cache
+{
+  KEYCACHE_PART_SLOT slots[KEYCACHE_PART_SLOTS];
+  volatile int32 blocked;             /* set while the cache is resized      */
+  uint partitions;                    /* 0 if the cache is disabled          */
+  uint block_size;                    /* size of the block buffers           */
+  uchar *block_mem;                   /* memory of the block buffers         */
+  uchar *block_root;                  /* memory of blocks and hash tables    */
+  KEYCACHE_PARTITION part[KEYCACHE_MAX_PARTITIONS];
+};
+
+typedef struct st_keycache_part_cache KEYCACHE_PART_CACHE;
+
+
+static inline uint32 part_hash(File file, my_off_t filepos, uint block_size)
+{
+  ulonglong key= ((ulonglong) file << 40) ^ (ulonglong) (filepos / block_size);
+  return (uint32) ((key * 0x9E3779B97F4A7C15ULL) >> 32);
+}
+
+
+/* The partition and hash bucket of a file block */
+static inline KEYCACHE_PARTITION *
+find_partition(KEYCACHE_PART_CACHE *cache, File file, my_off_t filepos,
+               uint *bucket)
+{
+  uint32 hash= part_hash(file, filepos, cache->block_size);
+  KEYCACHE_PARTITION *part= &cache->part[hash % cache->partitions];
+  *bucket= (hash / cache->partitions) & part->hash_mask;
+  return part;
+}
+
+
+/* The slot of the calling thread */
+static inline KEYCACHE_PART_SLOT *current_slot(KEYCACHE_PART_CACHE *cache)
+{
+  uint index;
+#ifdef HAVE_SCHED_GETCPU
+  int cpu= sched_getcpu();
+  if (cpu >= 0)
+    index= (uint) cpu;
+  else
+#endif
+  {
+    /* Threads run on different stacks */
+    char local;
+    index= (uint) ((size_t) &local >> 14);
+  }
+  return &cache->slots[index & (KEYCACHE_PART_SLOTS - 1)];
+}
+
+
+/*
+  Register a request
+
+  RETURN
+    the slot of the request
+    NULL  if the cache is resized or disabled, the request must bypass it
+*/
+
+static KEYCACHE_PART_SLOT *enter_cache(KEYCACHE_PART_CACHE *cache)
+{
+  KEYCACHE_PART_SLOT *slot= current_slot(cache);
+  /* A full barrier, so blocked is read after ops is incremented */
+  my_atomic_add32(&slot->ops, 1);
+  if (!part_load_acquire(&cache->blocked) && cache->partitions)
+    return slot;
+  my_atomic_add32(&slot->ops, -1);
+  return NULL;
+}
+
+
+static inline void leave_cache(KEYCACHE_PART_SLOT *slot)
+{
+  my_atomic_add32(&slot->ops, -1);
+}
+
+
+/* Pin a block shared, fails if it is held exclusively */
+static inline my_bool pin_block(PART_BLOCK *block)
+{
+  int32 pins= part_load_acquire(&block->pins);
+  while (pins >= 0)
+  {
+    if (my_atomic_cas32(&block->pins, &pins, pins + 1))
+      return TRUE;
+  }
+  return FALSE;
+}
+
+
+static inline void unpin_block(PART_BLOCK *block)
+{
+  my_atomic_add32(&block->pins, -1);
+}
+
+
+/* Pin a block exclusively, the partition mutex must be held */
+static inline my_bool lock_block(PART_BLOCK *block)
+{
+  int32 unpinned= 0;
+  return my_atomic_cas32(&block->pins, &unpinned, -1);
+}
+
+
+/* Release an exclusive pin, the partition mutex must be held */
+static void unlock_block(KEYCACHE_PARTITION *part, PART_BLOCK *block,
+                         int32 pins)
+{
+  DBUG_ASSERT(block->pins == -1);
+  part_store_release(&block->pins, pins);
+  if (part->waiting)
+    mysql_cond_broadcast(&part->cond);
+}
+
+
+/*
+  Wait until a block that could not be pinned may have been released.
+  The partition mutex must be held, it is released while waiting.
+*/
+
+static void wait_for_block(KEYCACHE_PARTITION *part, PART_BLOCK *block)
+{
+  if (block->pins < 0)
+  {
+    /* Exclusive pins are released with the mutex, no wakeup is lost */
+    part->waiting++;
+    mysql_cond_wait(&part->cond, &part->lock);
+    part->waiting--;
+  }
+  else
+  {
+    /* Shared pins are released without the mutex */
+    mysql_mutex_unlock(&part->lock);
+    pthread_yield();
+    mysql_mutex_lock(&part->lock);
+  }
+}
+
+
+/*
+  Find the block of a file position in a hash chain
+
+  NOTES
+    Without the partition mutex the block may be reassigned at any time,
+    it must be pinned and checked again. A block reassigned while it is
+    passed can lead the walk into another chain, so at most max_steps
+    blocks are visited.
+*/
+
+static PART_BLOCK *find_block(KEYCACHE_PARTITION *part, uint bucket,
+                              File file, my_off_t filepos, uint max_steps)
+{
+  PART_BLOCK *block= part_load_acquire(&part->hash_root[bucket]);
+  uint steps;
+
+  for (steps= 0; block && steps < max_steps; steps++)
+  {
+    if (block->file == file && block->filepos == filepos)
+      return block;
+    block= part_load_acquire(&block->hash_next);
+  }
+  return NULL;
+}
+
+
+/* Assign a block held exclusively to a file position */
+static void link_block(KEYCACHE_PARTITION *part, uint bucket,
+                       PART_BLOCK *block, File file, my_off_t filepos)
+{
+  PART_BLOCK **file_root= &part->file_blocks[(uint) file &
+                                             (KEYCACHE_PART_FILE_HASH - 1)];
+  DBUG_ASSERT(block->pins == -1 && block->file < 0);
+
+  block->file= file;
+  block->filepos= filepos;
+  block->bucket= bucket;
+  block->length= 0;
+  block->accessed= 1;
+  block->hash_next= part->hash_root[bucket];
+  part_store_release(&part->hash_root[bucket], block);
+
+  if ((block->file_next= *file_root))
+    block->file_next->file_prev= &block->file_next;
+  block->file_prev= file_root;
+  *file_root= block;
+  part->blocks_used++;
+}
+
+
+/*
+  Free a block held exclusively
+
+  NOTES
+    hash_next is left alone, an unlocked lookup may still be at the block.
+*/
+
+static void unlink_block(KEYCACHE_PARTITION *part, PART_BLOCK *block)
+{
+  PART_BLOCK * volatile *pos= &part->hash_root[block->bucket];
+  DBUG_ASSERT(block->pins == -1 && block->file >= 0);
+
+  while (*pos != block)
+    pos= &(*pos)->hash_next;
+  part_store_release(pos, block->hash_next);
+
+  if ((*block->file_prev= block->file_next))
+    block->file_next->file_prev= block->file_prev;
+  block->file= -1;
+  part->blocks_used--;
+}
+
+
+/*
+  Get a block to assign to a new file position
+
+  RETURN
+    a free block held exclusively
+    NULL  if all blocks are pinned
+
+  NOTES
+    The partition mutex must be held.
+*/
+
+static PART_BLOCK *get_free_block(KEYCACHE_PARTITION *part)
+{
+  uint scanned;
+
+  for (scanned= 0; scanned < 2 * part->disk_blocks; scanned++)
+  {
+    PART_BLOCK *block= part->blocks + part->clock_hand;
+    if (++part->clock_hand == part->disk_blocks)
+      part->clock_hand= 0;
+
+    if (block->file >= 0 && block->accessed)
+    {
+      /* Second chance */
+      block->accessed= 0;
+      continue;
+    }
+    if (lock_block(block))
+    {
+      if (block->file >= 0)
+        unlink_block(part, block);
+      return block;
+    }
+  }
+  return NULL;
+}
+
+
+/*
+  Pin the block of a file position shared, reading it if it is not cached
+
+  SYNOPSIS
+    get_block()
+      cache           the partitioned cache
+      slot            slot of the request
+      part, bucket    partition and hash bucket of the file block
+      file, filepos   the file block
+      min_length      number of bytes of the block that must exist
+      error     OUT   set to 1 on a read error
+
+  RETURN
+    the pinned block
+    NULL  if the block can not be cached now, or on error
+*/
+
+static PART_BLOCK *get_block(KEYCACHE_PART_CACHE *cache,
+                             KEYCACHE_PART_SLOT *slot,
+                             KEYCACHE_PARTITION *part, uint bucket,
+                             File file, my_off_t filepos, uint min_length,
+                             int *error)
+{
+  PART_BLOCK *block;
+  ulonglong write_seq;
+  size_t length;
+
+  mysql_mutex_lock(&part->lock);
+  while ((block= find_block(part, bucket, file, filepos, UINT_MAX)))
+  {
+    if (block->length < min_length)
+    {
+      /* The file was extended past a cached last block, read it again */
+      if (lock_block(block))
+      {
+        unlink_block(part, block);
+        unlock_block(part, block, 0);
+        continue;
+      }
+    }
+    else if (pin_block(block))
+    {
+      mysql_mutex_unlock(&part->lock);
+      return block;
+    }
+    wait_for_block(part, block);
+  }
+
+  if (part->writers || !(block= get_free_block(part)))
+  {
+    mysql_mutex_unlock(&part->lock);
+    return NULL;
+  }
+  link_block(part, bucket, block, file, filepos);
+  write_seq= part->write_seq;
+  mysql_mutex_unlock(&part->lock);
+
+  /* Readers of the block wait until it is released */
+  my_atomic_add64(&slot->reads, (int64) 1);
+  length= my_pread(file, block->buffer, cache->block_size, filepos, MYF(0));
+
+  mysql_mutex_lock(&part->lock);
+  if (length == MY_FILE_ERROR || length < min_length ||
+      part->writers || part->write_seq != write_seq)
+  {
+    if (length != MY_FILE_ERROR && length < min_length)
+      my_errno= -1;
+    *error= (length == MY_FILE_ERROR || length < min_length);
+    unlink_block(part, block);
+    unlock_block(part, block, 0);
+    mysql_mutex_unlock(&part->lock);
+    return NULL;
+  }
+  block->length= (uint) length;
+  /* Keep a shared pin for the caller */
+  unlock_block(part, block, 1);
+  mysql_mutex_unlock(&part->lock);
+  return block;
+}
+
+
+/*
+  Copy a file block read by the caller into the cache
+
+  SYNOPSIS
+    insert_block()
+      cache           the partitioned cache
+      file, filepos   the file block
+      buff, length    data of the file block
+      write_seq       write_seq of the partition before the data was read,
+                      NULL if no write can run concurrently
+
+  NOTES
+    Nothing is done if the block is cached already or if it might have
+    been written since the data was read.
+*/
+
+static void insert_block(KEYCACHE_PART_CACHE *cache, File file,
+                         my_off_t filepos, const uchar *buff, uint length,
+                         const ulonglong *write_seq)
+{
+  uint bucket;
+  KEYCACHE_PARTITION *part= find_partition(cache, file, filepos, &bucket);
+  PART_BLOCK *block;
+
+  mysql_mutex_lock(&part->lock);
+  if (!part->writers && (!write_seq || *write_seq == part->write_seq) &&
+      !find_block(part, bucket, file, filepos, UINT_MAX) &&
+      (block= get_free_block(part)))
+  {
+    link_block(part, bucket, block, file, filepos);
+    memcpy(block->buffer, buff, length);
+    block->length= length;
+    unlock_block(part, block, 0);
+  }
+  mysql_mutex_unlock(&part->lock);
+}
+
+
+/*
+  Count the consecutive blocks from a file position that are not cached
+
+  SYNOPSIS
+    count_missing()
+      cache           the partitioned cache
+      file, filepos   first file block
+      max_blocks      number of blocks to check
+      write_seq OUT   write_seq of the partitions of the blocks
+
+  NOTES
+    Blocks being written without a cache block end the run.
+*/
+
+static uint count_missing(KEYCACHE_PART_CACHE *cache, File file,
+                          my_off_t filepos, uint max_blocks,
+                          ulonglong *write_seq)
+{
+  uint count;
+
+  for (count= 0; count < max_blocks; count++)
+  {
+    uint bucket;
+    KEYCACHE_PARTITION *part= find_partition(cache, file, filepos, &bucket);
+    my_bool missing;
+
+#ifdef KEYCACHE_PART_LOCK_FREE_HITS
+    /* Most blocks are cached, check without the mutex first */
+    if (find_block(part, bucket, file, filepos, KEYCACHE_PART_MAX_STEPS))
+      break;
+#endif
+    mysql_mutex_lock(&part->lock);
+    missing= !part->writers &&
+             !find_block(part, bucket, file, filepos, UINT_MAX);
+    write_seq[count]= part->write_seq;
+    mysql_mutex_unlock(&part->lock);
+    if (!missing)
+      break;
+    filepos+= cache->block_size;
+  }
+  return count;
+}
+
+
+/* Read a part of one file block */
+static int read_block(KEYCACHE_PART_CACHE *cache, KEYCACHE_PART_SLOT *slot,
+                      File file, my_off_t filepos, uint offset,
+                      uchar *buff, uint length)
+{
+  uint bucket;
+  KEYCACHE_PARTITION *part= find_partition(cache, file, filepos, &bucket);
+  PART_BLOCK *block;
+  int error= 0;
+
+  my_atomic_add64(&slot->r_requests, (int64) 1);
+#ifdef KEYCACHE_PART_LOCK_FREE_HITS
+  if ((block= find_block(part, bucket, file, filepos,
+                         KEYCACHE_PART_MAX_STEPS)) &&
+      pin_block(block))
+  {
+    /* The block may have been reassigned before it was pinned */
+    if (block->file == file && block->filepos == filepos &&
+        block->length >= offset + length)
+    {
+      memcpy(buff, block->buffer + offset, length);
+      if (!block->accessed)
+        block->accessed= 1;
+      unpin_block(block);
+      return 0;
+    }
+    unpin_block(block);
+  }
+#endif
+
+  if ((block= get_block(cache, slot, part, bucket, file, filepos,
+                        offset + length, &error)))
+  {
+    memcpy(buff, block->buffer + offset, length);
+    block->accessed= 1;
+    unpin_block(block);
+    return 0;
+  }
+  if (error)
+    return 1;
+
+  /* No block could be used, read the file directly */
+  my_atomic_add64(&slot->reads, (int64) 1);
+  return my_pread(file, buff, length, filepos + offset, MYF(MY_NABP)) != 0;
+}
+
+
+/*
+  Read consecutive file blocks that are not cached with one read
+
+  NOTES
+    The blocks are read into the caller's buffer and copied into the cache
+    from there.
+*/
+
+static int read_blocks(KEYCACHE_PART_CACHE *cache, KEYCACHE_PART_SLOT *slot,
+                       File file, my_off_t filepos, uchar *buff, uint count,
+                       const ulonglong *write_seq)
+{
+  uint block_size= cache->block_size;
+  uint i;
+
+  my_atomic_add64(&slot->r_requests, (int64) count);
+  my_atomic_add64(&slot->reads, (int64) count);
+  if (my_pread(file, buff, (size_t) count * block_size, filepos,
+               MYF(MY_NABP)))
+    return 1;
+
+  for (i= 0; i < count; i++)
+    insert_block(cache, file, filepos + (my_off_t) i * block_size,
+                 buff + (size_t) i * block_size, block_size, write_seq + i);
+  return 0;
+}
+
+
+/* Write a part of one file block */
+static int write_block(KEYCACHE_PART_CACHE *cache, KEYCACHE_PART_SLOT *slot,
+                       File file, my_off_t filepos, uint offset,
+                       const uchar *buff, uint length)
+{
+  uint bucket;
+  KEYCACHE_PARTITION *part= find_partition(cache, file, filepos, &bucket);
+  PART_BLOCK *block;
+  int error;
+
+  my_atomic_add64(&slot->w_requests, (int64) 1);
+  mysql_mutex_lock(&part->lock);
+  while ((block= find_block(part, bucket, file, filepos, UINT_MAX)))
+  {
+    if (lock_block(block))
+      break;
+    wait_for_block(part, block);
+  }
+  /* Cache blocks that are written completely */
+  if (!block && !offset && length == cache->block_size &&
+      (block= get_free_block(part)))
+    link_block(part, bucket, block, file, filepos);
+  if (!block)
+    part->writers++;
+  mysql_mutex_unlock(&part->lock);
+
+  my_atomic_add64(&slot->writes, (int64) 1);
+  error= my_pwrite(file, buff, length, filepos + offset,
+                   MYF(MY_NABP | MY_WAIT_IF_FULL)) != 0;
+
+  if (block && !error && offset <= block->length)
+  {
+    memcpy(block->buffer + offset, buff, length);
+    set_if_bigger(block->length, offset + length);
+  }
+
+  mysql_mutex_lock(&part->lock);
+  if (block)
+  {
+    /* Drop the block if it could not be updated */
+    if (error || block->length < offset + length)
+      unlink_block(part, block);
+    unlock_block(part, block, 0);
+  }
+  else
+  {
+    part->writers--;
+    part->write_seq++;
+  }
+  mysql_mutex_unlock(&part->lock);
+  return error;
+}
+
+
+/*
+  Allocate the blocks of the partitions
+
+  RETURN
+    number of blocks, -1 if use_mem is too small for a cache, 0 on error
+*/
+
+static int alloc_partitions(KEY_CACHE *keycache, uint block_size,
+                            size_t use_mem)
+{
+  KEYCACHE_PART_CACHE *cache= keycache->part_cache;
+  uint partitions, blocks_per_part, hash_entries, i;
+  size_t length;
+  ulong blocks;
+
+  partitions= (uint) MY_MIN(keycache->param_partitions,
+                            KEYCACHE_MAX_PARTITIONS);
+  if (!partitions)
+    partitions= cache->partitions ? cache->partitions : 1;
+
+  blocks= (ulong) (use_mem / (sizeof(PART_BLOCK) + 2 * sizeof(PART_BLOCK*) +
+                              block_size));
+  if (blocks < KEYCACHE_PART_MIN_BLOCKS)
+  {
+    /* key_buffer_size is specified too small. Disable the cache. */
+    cache->partitions= 0;
+    return -1;
+  }
+  set_if_smaller(partitions, blocks / KEYCACHE_PART_MIN_BLOCKS);
+
+  for ( ; ; )
+  {
+    blocks_per_part= (uint) (blocks / partitions);
+    hash_entries= my_round_up_to_next_power(blocks_per_part * 5 / 4);
+    length= ALIGN_SIZE(blocks * sizeof(PART_BLOCK)) +
+            ALIGN_SIZE(sizeof(PART_BLOCK*) * hash_entries) * partitions;
+    if ((cache->block_mem= my_large_malloc((size_t) blocks * block_size,
+                                           MYF(0))))
+    {
+      if ((cache->block_root= my_malloc(length, MYF(MY_ZEROFILL))))
+        break;
+      my_large_free(cache->block_mem);
+      cache->block_mem= NULL;
+    }
+    blocks= blocks / 4 * 3;
+    if (blocks < KEYCACHE_PART_MIN_BLOCKS * partitions)
+    {
+      my_errno= ENOMEM;
+      my_error(EE_OUTOFMEMORY, MYF(ME_FATALERROR),
+               blocks * block_size);
+      cache->partitions= 0;
+      return 0;
+    }
+  }
+
+  cache->block_size= block_size;
+  for (i= 0; i < partitions; i++)
+  {
+    KEYCACHE_PARTITION *part= &cache->part[i];
+    uint j;
+
+    part->blocks= (PART_BLOCK*) cache->block_root + i * blocks_per_part;
+    part->disk_blocks= blocks_per_part;
+    part->hash_root= (PART_BLOCK**)
+      (cache->block_root + ALIGN_SIZE(blocks * sizeof(PART_BLOCK)) +
+       ALIGN_SIZE(sizeof(PART_BLOCK*) * hash_entries) * i);
+    part->hash_mask= hash_entries - 1;
+    part->clock_hand= 0;
+    part->blocks_used= 0;
+    memset(part->file_blocks, 0, sizeof(part->file_blocks));
+    for (j= 0; j < blocks_per_part; j++)
+    {
+      PART_BLOCK *block= &part->blocks[j];
+      block->file= -1;
+      block->buffer= cache->block_mem +
+                     ((size_t) i * blocks_per_part + j) * block_size;
+    }
+  }
+  cache->partitions= partitions;
+  return (int) (blocks_per_part * partitions);
+}
+
+
+static void free_partitions(KEYCACHE_PART_CACHE *cache)
+{
+  if (cache->block_mem)
+  {
+    my_large_free(cache->block_mem);
+    cache->block_mem= NULL;
+    my_free(cache->block_root);
+    cache->block_root= NULL;
+  }
+  cache->partitions= 0;
+}
+
+
+/* Set up the key cache fields that describe the cache */
+static void set_cache_state(KEY_CACHE *keycache, uint block_size,
+                            size_t use_mem, int blocks)
+{
+  uint i;
+  keycache->key_cache_mem_size= use_mem;
+  keycache->key_cache_block_size= block_size;
+  keycache->disk_blocks= blocks;
+  keycache->blocks= blocks > 0 ? blocks : 0;
+  keycache->can_be_used= blocks > 0;
+  keycache->blocks_used= keycache->blocks_changed= 0;
+  keycache->blocks_unused= keycache->blocks;
+  keycache->global_blocks_changed= 0;
+  keycache->global_cache_w_requests= keycache->global_cache_r_requests= 0;
+  keycache->global_cache_read= keycache->global_cache_write= 0;
+  for (i= 0; i < KEYCACHE_PART_SLOTS; i++)
+  {
+    KEYCACHE_PART_SLOT *slot= &keycache->part_cache->slots[i];
+    slot->r_requests= slot->reads= slot->w_requests= slot->writes= 0;
+  }
+}
+
+
+/*
+  Initialize a partitioned key cache
+
+  SYNOPSIS
+    init_partitioned_key_cache()
+    keycache                  pointer to a key cache data structure
+    key_cache_block_size      size of blocks to keep cached data
+    use_mem                   total memory to use for the key cache
+
+  RETURN VALUE
+    number of blocks in the key cache, if successful,
+    0 - otherwise.
+
+  NOTES
+    The number of partitions is taken from keycache->param_partitions,
+    and is at most KEYCACHE_MAX_PARTITIONS.
+*/
+
+int init_partitioned_key_cache(KEY_CACHE *keycache, uint key_cache_block_size,
+                               size_t use_mem)
+{
+  KEYCACHE_PART_CACHE *cache;
+  int blocks;
+  DBUG_ENTER("init_partitioned_key_cache");
+
+  if (keycache->key_cache_inited && keycache->disk_blocks > 0)
+  {
+    DBUG_PRINT("warning",("key cache already in use"));
+    DBUG_RETURN(0);
+  }
+
+  if (!keycache->key_cache_inited)
+  {
+    uint i;
+    if (!(cache= (KEYCACHE_PART_CACHE*) my_malloc(sizeof(*cache),
+                                                  MYF(MY_ZEROFILL))))
+      DBUG_RETURN(0);
+    for (i= 0; i < KEYCACHE_MAX_PARTITIONS; i++)
+    {
+      mysql_mutex_init(key_KEY_CACHE_partition_lock,
+                       &cache->part[i].lock, MY_MUTEX_INIT_FAST);
+      mysql_cond_init(key_KEY_CACHE_partition_cond, &cache->part[i].cond,
+                      NULL);
+    }
+    /* cache_lock serializes resizes */
+    mysql_mutex_init(key_KEY_CACHE_cache_lock,
+                     &keycache->cache_lock, MY_MUTEX_INIT_FAST);
+    keycache->part_cache= cache;
+    keycache->in_resize= 0;
+    keycache->resize_in_flush= 0;
+    keycache->in_init= 0;
+    keycache->key_cache_inited= 1;
+  }
+
+  blocks= alloc_partitions(keycache, key_cache_block_size, use_mem);
+  set_cache_state(keycache, key_cache_block_size, use_mem, blocks);
+  DBUG_PRINT("exit", ("partitions: %u  blocks: %d",
+                      keycache->part_cache->partitions, blocks));
+  DBUG_RETURN(blocks);
+}
+
+
+/*
+  Resize a partitioned key cache
+
+  NOTES
+    Requests that start during the resize bypass the cache. The blocks are
+    reallocated once the requests in progress are done, the number of
+    partitions may change too.
+*/
+
+int resize_partitioned_key_cache(KEY_CACHE *keycache,
+                                 uint key_cache_block_size, size_t use_mem)
+{
+  KEYCACHE_PART_CACHE *cache= keycache->part_cache;
+  int blocks;
+  uint i;
+  DBUG_ENTER("resize_partitioned_key_cache");
+
+  if (key_cache_block_size == keycache->key_cache_block_size &&
+      use_mem == keycache->key_cache_mem_size &&
+      (!keycache->param_partitions || !cache->partitions ||
+       keycache->param_partitions == cache->partitions))
+    DBUG_RETURN(keycache->disk_blocks);
+
+  mysql_mutex_lock(&keycache->cache_lock);
+  keycache->in_resize= 1;
+  my_atomic_store32(&cache->blocked, 1);
+  for (i= 0; i < KEYCACHE_PART_SLOTS; i++)
+  {
+    while (my_atomic_load32(&cache->slots[i].ops))
+      pthread_yield();
+  }
+
+  free_partitions(cache);
+  blocks= alloc_partitions(keycache, key_cache_block_size, use_mem);
+  set_cache_state(keycache, key_cache_block_size, use_mem, blocks);
+
+  my_atomic_store32(&cache->blocked, 0);
+  keycache->in_resize= 0;
+  mysql_mutex_unlock(&keycache->cache_lock);
+  DBUG_RETURN(blocks);
+}
+
+
+void end_partitioned_key_cache(KEY_CACHE *keycache, my_bool cleanup)
+{
+  KEYCACHE_PART_CACHE *cache= keycache->part_cache;
+  DBUG_ENTER("end_partitioned_key_cache");
+
+  free_partitions(cache);
+  keycache->disk_blocks= -1;
+  keycache->blocks_used= 0;
+  keycache->blocks_unused= 0;
+
+  if (cleanup)
+  {
+    uint i;
+    for (i= 0; i < KEYCACHE_MAX_PARTITIONS; i++)
+    {
+      mysql_mutex_destroy(&cache->part[i].lock);
+      mysql_cond_destroy(&cache->part[i].cond);
+    }
+    mysql_mutex_destroy(&keycache->cache_lock);
+    my_free(cache);
+    keycache->part_cache= NULL;
+    keycache->key_cache_inited= keycache->can_be_used= 0;
+  }
+  DBUG_VOID_RETURN;
+}
+
+
+uchar *partitioned_key_cache_read(KEY_CACHE *keycache, File file,
+                                  my_off_t filepos, uchar *buff, uint length)
+{
+  KEYCACHE_PART_CACHE *cache= keycache->part_cache;
+  KEYCACHE_PART_SLOT *slot;
+  uchar *start= buff;
+  uint block_size, offset;
+  int error= 0;
+  DBUG_ENTER("partitioned_key_cache_read");
+
+  if (!(slot= enter_cache(cache)))
+  {
+    error= my_pread(file, buff, length, filepos, MYF(MY_NABP)) != 0;
+    DBUG_RETURN(error ? (uchar*) 0 : start);
+  }
+
+  block_size= cache->block_size;
+  offset= (uint) (filepos % block_size);
+  filepos-= offset;
+  while (length)
+  {
+    uint read_length;
+
+    if (!offset && length >= 2 * block_size)
+    {
+      ulonglong write_seq[64];
+      uint count= count_missing(cache, file, filepos,
+                                MY_MIN(length / block_size,
+                                       array_elements(write_seq)),
+                                write_seq);
+      if (count > 1)
+      {
+        if ((error= read_blocks(cache, slot, file, filepos, buff, count,
+                                write_seq)))
+          break;
+        read_length= count * block_size;
+        buff+= read_length;
+        filepos+= read_length;
+        length-= read_length;
+        continue;
+      }
+    }
+
+    read_length= MY_MIN(length, block_size - offset);
+    if ((error= read_block(cache, slot, file, filepos, offset, buff,
+                           read_length)))
+      break;
+    buff+= read_length;
+    filepos+= block_size;
+    length-= read_length;
+    offset= 0;
+  }
+
+  leave_cache(slot);
+  DBUG_RETURN(error ? (uchar*) 0 : start);
+}
+
+
+int partitioned_key_cache_insert(KEY_CACHE *keycache, File file,
+                                 my_off_t filepos, uchar *buff, uint length)
+{
+  KEYCACHE_PART_CACHE *cache= keycache->part_cache;
+  KEYCACHE_PART_SLOT *slot;
+  uint block_size, offset;
+  DBUG_ENTER("partitioned_key_cache_insert");
+
+  if (!(slot= enter_cache(cache)))
+    DBUG_RETURN(0);
+
+  block_size= cache->block_size;
+  offset= (uint) (filepos % block_size);
+  filepos-= offset;
+  while (length)
+  {
+    uint read_length= MY_MIN(length, block_size - offset);
+    /* Only whole blocks, or the last block of the file, can be inserted */
+    if (!offset)
+      insert_block(cache, file, filepos, buff, read_length, NULL);
+    buff+= read_length;
+    filepos+= block_size;
+    length-= read_length;
+    offset= 0;
+  }
+
+  leave_cache(slot);
+  DBUG_RETURN(0);
+}
+
+
+int partitioned_key_cache_write(KEY_CACHE *keycache, File file,
+                                my_off_t filepos, uchar *buff, uint length)
+{
+  KEYCACHE_PART_CACHE *cache= keycache->part_cache;
+  KEYCACHE_PART_SLOT *slot;
+  uint block_size, offset;
+  int error= 0;
+  DBUG_ENTER("partitioned_key_cache_write");
+
+  if (!(slot= enter_cache(cache)))
+    DBUG_RETURN(my_pwrite(file, buff, length, filepos,
+                          MYF(MY_NABP | MY_WAIT_IF_FULL)) != 0);
+
+  block_size= cache->block_size;
+  offset= (uint) (filepos % block_size);
+  filepos-= offset;
+  while (length)
+  {
+    uint write_length= MY_MIN(length, block_size - offset);
+    if ((error= write_block(cache, slot, file, filepos, offset, buff,
+                            write_length)))
+      break;
+    buff+= write_length;
+    filepos+= block_size;
+    length-= write_length;
+    offset= 0;
+  }
+
+  leave_cache(slot);
+  DBUG_RETURN(error);
+}
+
+
+/*
+  Flush the blocks of a file
+
+  NOTES
+    Blocks are never dirty. FLUSH_RELEASE and FLUSH_IGNORE_CHANGED drop
+    the blocks of the file, which must not be used concurrently.
+*/
+
+int partitioned_flush_key_blocks(KEY_CACHE *keycache, File file,
+                                 enum flush_type type)
+{
+  KEYCACHE_PART_CACHE *cache= keycache->part_cache;
+  KEYCACHE_PART_SLOT *slot;
+  uint i;
+  DBUG_ENTER("partitioned_flush_key_blocks");
+
+  if (type != FLUSH_RELEASE && type != FLUSH_IGNORE_CHANGED)
+    DBUG_RETURN(0);
+  /* A resized cache is empty */
+  if (!(slot= enter_cache(cache)))
+    DBUG_RETURN(0);
+
+  for (i= 0; i < cache->partitions; i++)
+  {
+    KEYCACHE_PARTITION *part= &cache->part[i];
+    PART_BLOCK **file_root= &part->file_blocks[(uint) file &
+                                               (KEYCACHE_PART_FILE_HASH - 1)];
+    PART_BLOCK *block, *next;
+
+    mysql_mutex_lock(&part->lock);
+  restart:
+    for (block= *file_root; block; block= next)
+    {
+      next= block->file_next;
+      if (block->file != file)
+        continue;
+      if (!lock_block(block))
+      {
+        wait_for_block(part, block);
+        goto restart;
+      }
+      unlink_block(part, block);
+      unlock_block(part, block, 0);
+    }
+    mysql_mutex_unlock(&part->lock);
+  }
+
+  leave_cache(slot);
+  DBUG_RETURN(0);
+}
+
+
+/*
+  Sum the statistics of the partitions into the key cache, or reset them
+*/
+
+void partitioned_key_cache_stats(KEY_CACHE *keycache, my_bool reset)
+{
+  KEYCACHE_PART_CACHE *cache= keycache->part_cache;
+  ulonglong r_requests= 0, reads= 0, w_requests= 0, writes= 0;
+  ulong blocks_used= 0;
+  uint i;
+
+  for (i= 0; i < KEYCACHE_PART_SLOTS; i++)
+  {
+    KEYCACHE_PART_SLOT *slot= &cache->slots[i];
+    if (reset)
+    {
+      my_atomic_store64(&slot->r_requests, (int64) 0);
+      my_atomic_store64(&slot->reads, (int64) 0);
+      my_atomic_store64(&slot->w_requests, (int64) 0);
+      my_atomic_store64(&slot->writes, (int64) 0);
+      continue;
+    }
+    r_requests+= my_atomic_load64(&slot->r_requests);
+    reads+= my_atomic_load64(&slot->reads);
+    w_requests+= my_atomic_load64(&slot->w_requests);
+    writes+= my_atomic_load64(&slot->writes);
+  }
+  /* Read without the partition mutexes, the counts are approximate */
+  for (i= 0; i < cache->partitions; i++)
+    blocks_used+= cache->part[i].blocks_used;
+
+  keycache->global_cache_r_requests= r_requests;
+  keycache->global_cache_read= reads;
+  keycache->global_cache_w_requests= w_requests;
+  keycache->global_cache_write= writes;
+  keycache->blocks_used= blocks_used;
+  keycache->blocks_unused= keycache->blocks > (int) blocks_used ?
+                           keycache->blocks - blocks_used : 0;
+}
@@ -443,6 +443,80 @@ void free_root(MEM_ROOT *root, myf MyFlags)
   DBUG_VOID_RETURN;
 }
 
+/*
+  Free the memory of a finished task, keeping one block sized for the
+  next ones
+
+  SYNOPSIS
+    recycle_root()
+      root              Memory root
+      recycle_size      Memory recently used from the root, kept by the
+                        caller between calls. Must be 0 on the first call.
+      min_size          Smallest size of the kept block, the prealloc size
+      max_size          Largest size of the kept block
+
+  DESCRIPTION
+    Like free_root(root, MYF(MY_KEEP_PREALLOC)), but the preallocated block
+    follows the memory the root is used for: a task that needed several
+    blocks makes the kept block grow to its size, so that the following
+    tasks of the same shape allocate no memory at all. The size shrinks
+    back slowly (by 1/8 per call) when the tasks get smaller, and the block
+    is only replaced when it is outside of [size, 2 * size].
+
+    When max_size is not larger than min_size this is the same as
+    free_root(root, MYF(MY_KEEP_PREALLOC)).
+*/
+
+void recycle_root(MEM_ROOT *root, size_t *recycle_size,
+                  size_t min_size, size_t max_size)
+{
+#if !(defined(HAVE_purify) && defined(EXTRA_DEBUG))
+  USED_MEM *next, *block;
+  size_t used= 0, size;
+  uint blocks= 0;
+  DBUG_ENTER("recycle_root");
+
+  if (max_size <= min_size)
+  {
+    free_root(root, MYF(MY_KEEP_PREALLOC));
+    DBUG_VOID_RETURN;
+  }
+
+  for (next= root->used; next; next= next->next, blocks++)
+    used+= next->size - next->left - ALIGN_SIZE(sizeof(USED_MEM));
+  for (next= root->free; next; next= next->next, blocks++)
+    used+= next->size - next->left - ALIGN_SIZE(sizeof(USED_MEM));
+
+  /* Follow larger tasks at once and smaller ones slowly */
+  *recycle_size= MY_MAX(used, *recycle_size - *recycle_size / 8);
+  size= MY_MIN(MY_MAX(*recycle_size, min_size), max_size);
+  size= MY_ALIGN(size, 1024) + ALIGN_SIZE(sizeof(USED_MEM));
+
+  block= root->used ? root->used : root->free;
+  if (blocks == 1 && block->size >= size && block->size / 2 <= size)
+  {
+    /* The only block fits the recent tasks, keep it */
+    root->pre_alloc= block;
+    free_root(root, MYF(MY_KEEP_PREALLOC));
+    DBUG_VOID_RETURN;
+  }
+
+  free_root(root, MYF(0));
+  if (is_mem_available(root, size) &&
+      (block= (USED_MEM*) my_malloc(size, MYF(0))))
+  {
+    block->size= size;
+    block->left= size - ALIGN_SIZE(sizeof(USED_MEM));
+    block->next= 0;
+    root->free= root->pre_alloc= block;
+    root->allocated_size= size;
+  }
+  DBUG_VOID_RETURN;
+#else
+  free_root(root, MYF(MY_KEEP_PREALLOC));
+#endif
+}
+
 /*
   Find block that contains an object and set the pre_alloc to it
 */
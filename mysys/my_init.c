@@ -24,7 +24,7 @@
 #ifdef _MSC_VER
 #include <locale.h>
 #include <crtdbg.h>
-/* WSAStartup needs winsock library*/
+/* WSAStartup needs winsock library*/
 #pragma comment(lib, "ws2_32")
 #endif
 my_bool have_tcpip=0;
@@ -464,8 +464,8 @@ PSI_mutex_key key_LOCK_localtime_r;
 #endif /* !defined(HAVE_LOCALTIME_R) || !defined(HAVE_GMTIME_R) */
 
 PSI_mutex_key key_BITMAP_mutex, key_IO_CACHE_append_buffer_lock,
-  key_IO_CACHE_SHARE_mutex, key_KEY_CACHE_cache_lock, key_LOCK_alarm,
-  key_my_thread_var_mutex, key_THR_LOCK_charset, key_THR_LOCK_heap,
+  key_IO_CACHE_SHARE_mutex, key_KEY_CACHE_cache_lock,
+  key_KEY_CACHE_partition_lock, key_LOCK_alarm, key_my_thread_var_mutex, key_THR_LOCK_charset, key_THR_LOCK_heap,
   key_THR_LOCK_lock, key_THR_LOCK_malloc,
   key_THR_LOCK_mutex, key_THR_LOCK_myisam, key_THR_LOCK_net,
   key_THR_LOCK_open, key_THR_LOCK_threads,
@@ -483,6 +483,7 @@ static PSI_mutex_info all_mysys_mutexes[]=
   { &key_IO_CACHE_append_buffer_lock, "IO_CACHE::append_buffer_lock", 0},
   { &key_IO_CACHE_SHARE_mutex, "IO_CACHE::SHARE_mutex", 0},
   { &key_KEY_CACHE_cache_lock, "KEY_CACHE::cache_lock", 0},
+  { &key_KEY_CACHE_partition_lock, "KEY_CACHE::partition_lock", 0},
   { &key_LOCK_alarm, "LOCK_alarm", PSI_FLAG_GLOBAL},
   { &key_my_thread_var_mutex, "my_thread_var::mutex", 0},
   { &key_THR_LOCK_charset, "THR_LOCK_charset", PSI_FLAG_GLOBAL},
@@ -499,7 +500,8 @@ static PSI_mutex_info all_mysys_mutexes[]=
 };
 
 PSI_cond_key key_COND_alarm, key_IO_CACHE_SHARE_cond,
-  key_IO_CACHE_SHARE_cond_writer, key_my_thread_var_suspend,
+  key_IO_CACHE_SHARE_cond_writer, key_KEY_CACHE_partition_cond,
+  key_my_thread_var_suspend,
   key_THR_COND_threads;
 
 static PSI_cond_info all_mysys_conds[]=
@@ -507,6 +509,7 @@ static PSI_cond_info all_mysys_conds[]=
   { &key_COND_alarm, "COND_alarm", PSI_FLAG_GLOBAL},
   { &key_IO_CACHE_SHARE_cond, "IO_CACHE_SHARE::cond", 0},
   { &key_IO_CACHE_SHARE_cond_writer, "IO_CACHE_SHARE::cond_writer", 0},
+  { &key_KEY_CACHE_partition_cond, "KEY_CACHE::partition_cond", 0},
   { &key_my_thread_var_suspend, "my_thread_var::suspend", 0},
   { &key_THR_COND_threads, "THR_COND_threads", 0}
 };
@@ -37,15 +37,16 @@ extern PSI_mutex_key key_LOCK_localtime_r;
 #endif /* !defined(HAVE_LOCALTIME_R) || !defined(HAVE_GMTIME_R) */
 
 extern PSI_mutex_key key_BITMAP_mutex, key_IO_CACHE_append_buffer_lock,
-  key_IO_CACHE_SHARE_mutex, key_KEY_CACHE_cache_lock, key_LOCK_alarm,
-  key_my_thread_var_mutex, key_THR_LOCK_charset, key_THR_LOCK_heap,
+  key_IO_CACHE_SHARE_mutex, key_KEY_CACHE_cache_lock,
+  key_KEY_CACHE_partition_lock, key_LOCK_alarm, key_my_thread_var_mutex, key_THR_LOCK_charset, key_THR_LOCK_heap,
   key_THR_LOCK_lock, key_THR_LOCK_malloc,
   key_THR_LOCK_mutex, key_THR_LOCK_myisam, key_THR_LOCK_net,
   key_THR_LOCK_open, key_THR_LOCK_threads,
   key_TMPDIR_mutex, key_THR_LOCK_myisam_mmap;
 
 extern PSI_cond_key key_COND_alarm, key_IO_CACHE_SHARE_cond,
-  key_IO_CACHE_SHARE_cond_writer, key_my_thread_var_suspend,
+  key_IO_CACHE_SHARE_cond_writer, key_KEY_CACHE_partition_cond,
+  key_my_thread_var_suspend,
   key_THR_COND_threads;
 
 #ifdef USE_ALARM_THREAD
@@ -79,6 +80,30 @@ extern PSI_file_key key_file_charset;
 
 void my_error_unregister_all(void);
 
+/* mf_keycache_part.c, used by the mf_keycache.c entry points */
+struct st_key_cache;
+extern int init_partitioned_key_cache(struct st_key_cache *keycache,
+                                      uint key_cache_block_size,
+                                      size_t use_mem);
+extern int resize_partitioned_key_cache(struct st_key_cache *keycache,
+                                        uint key_cache_block_size,
+                                        size_t use_mem);
+extern void end_partitioned_key_cache(struct st_key_cache *keycache,
+                                      my_bool cleanup);
+extern uchar *partitioned_key_cache_read(struct st_key_cache *keycache,
+                                         File file, my_off_t filepos,
+                                         uchar *buff, uint length);
+extern int partitioned_key_cache_insert(struct st_key_cache *keycache,
+                                        File file, my_off_t filepos,
+                                        uchar *buff, uint length);
+extern int partitioned_key_cache_write(struct st_key_cache *keycache,
+                                       File file, my_off_t filepos,
+                                       uchar *buff, uint length);
+extern int partitioned_flush_key_blocks(struct st_key_cache *keycache,
+                                        File file, enum flush_type type);
+extern void partitioned_key_cache_stats(struct st_key_cache *keycache,
+                                        my_bool reset);
+
 #ifdef _WIN32
 #include <sys/stat.h>
 /* my_winfile.c exports, should not be used outside mysys */
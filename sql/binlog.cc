@@ -30,12 +30,17 @@
 #include "sql_show.h"
 #include "sql_parse.h"
 #include "rpl_mi.h"
+#include "my_murmur3.h"
 #include <list>
+#include <vector>
 #include <chrono>
 #include <sstream>
 #include <my_stacktrace.h>
 #include <boost/algorithm/string.hpp>
 #include <exception>
+#ifdef __linux__
+#include <sys/syscall.h>
+#endif
 #ifdef HAVE_RAPIDJSON
 #include "rapidjson/document.h"
 #include "rapidjson/writer.h"
@@ -325,6 +330,18 @@ exit0:
 };
 
 
+/**
+  An event staged by binlog_cache_data::stage(): its offset in the stage
+  file, and the multiplier that carries a change of its end_log_pos to its
+  checksum, see crc32_shift().
+*/
+struct Binlog_staged_event
+{
+  my_off_t offset;
+  uint32 crc_shift;
+};
+
+
 /**
   Caches for non-transactional and transactional data before writing
   it to the binary log.
@@ -345,6 +362,7 @@ public:
     ptr_binlog_cache_use(ptr_binlog_cache_use_arg),
     ptr_binlog_cache_disk_use(ptr_binlog_cache_disk_use_arg)
   {
+    stage_from= MY_OFF_T_UNDEF;
     reset();
     flags.transactional= trx_cache_arg;
     cache_log.end_of_file= saved_max_binlog_cache_size;
@@ -359,6 +377,20 @@ public:
   {
     DBUG_ASSERT(is_binlog_empty());
     close_cached_file(&cache_log);
+    if (my_b_inited(&stage_log))
+      close_cached_file(&stage_log);
+  }
+
+  void stage();
+
+  /**
+    True if the events of the cache after stage_from are staged in
+    stage_log for the current binlog checksum algorithm.
+  */
+  bool is_staged() const
+  {
+    return stage_from != MY_OFF_T_UNDEF &&
+           stage_checksum_alg == binlog_checksum_options;
   }
 
   bool is_binlog_empty() const
@@ -447,6 +479,36 @@ public:
     return my_b_tell(&cache_log);
   }
 
+  /**
+    Add the hash of a row modified by the group to the writeset of this
+    cache, see @c opt_binlog_writeset_dependency_tracking.
+  */
+  void add_to_writeset(uint64_t hash)
+  {
+    if (!writeset_unusable)
+      writeset.insert(hash);
+  }
+
+  /**
+    The writeset of the group cannot be used to compute its dependency, the
+    group will depend on all previous groups.
+  */
+  void set_writeset_unusable()
+  {
+    writeset_unusable= true;
+    writeset.clear();
+  }
+
+  bool is_writeset_unusable() const
+  {
+    return writeset_unusable;
+  }
+
+  const std::unordered_set<uint64_t> *get_writeset() const
+  {
+    return (writeset_unusable || writeset.empty()) ? NULL : &writeset;
+  }
+
   virtual void reset()
   {
     compute_statistics();
@@ -485,6 +547,11 @@ public:
     */
     cache_log.disk_writes= 0;
     group_cache.clear();
+    writeset.clear();
+    writeset_unusable= false;
+    writeset_dependency_pos= MY_OFF_T_UNDEF;
+    group_head_end= 0;
+    release_stage();
     DBUG_ASSERT(is_binlog_empty());
   }
 
@@ -538,6 +605,33 @@ public:
   */
   Group_cache group_cache;
 
+  /**
+    Position of the Metadata_log_event holding the writeset dependency
+    placeholder of the group, MY_OFF_T_UNDEF if there is none. The actual
+    dependency is written during the flush stage.
+  */
+  my_off_t writeset_dependency_pos;
+
+  /**
+    End of the events written at the beginning of the group, the Gtid event
+    and the metadata placeholders, which are rewritten during the flush
+    stage. 0 if the cache has none.
+  */
+  my_off_t group_head_end;
+
+  /**
+    The events of the cache from stage_from on, with their final length,
+    checksum and end_log_pos relative to the beginning of the group, see
+    binlog_cache_data::stage(). The flush stage adds the position of the
+    group to end_log_pos and patches the checksum of each event in
+    stage_events.
+  */
+  IO_CACHE stage_log;
+  my_off_t stage_from;
+  my_off_t stage_length;
+  ulong stage_checksum_alg;
+  std::vector<Binlog_staged_event> stage_events;
+
 protected:
   /*
     It truncates the cache to a certain position. This includes deleting the
@@ -557,6 +651,26 @@ protected:
     cache_log.end_of_file= saved_max_binlog_cache_size;
   }
 
+  /**
+    Drops the staged events, keeping the file of stage_log for the next
+    transaction.
+  */
+  void release_stage()
+  {
+    if (stage_from == MY_OFF_T_UNDEF && stage_events.empty())
+      return;
+    if (my_b_inited(&stage_log))
+    {
+      reinit_io_cache(&stage_log, WRITE_CACHE, 0, 0, 1);
+      if (stage_log.file != -1 &&
+          my_chsize(stage_log.file, 0, 0, MYF(MY_WME)))
+        sql_print_warning("Unable to resize binlog stage file");
+    }
+    stage_events.clear();
+    stage_from= MY_OFF_T_UNDEF;
+    stage_length= 0;
+  }
+
   /**
      Flush pending event to the cache buffer.
    */
@@ -614,6 +728,17 @@ private:
    */
   Rows_log_event *m_pending;
 
+  /*
+    Hashes of the rows modified by the group, see
+    THD::binlog_add_row_to_writeset.
+  */
+  std::unordered_set<uint64_t> writeset;
+
+  /*
+    TRUE if the group modified rows which cannot be identified by a hash.
+  */
+  bool writeset_unusable;
+
   /**
     This function computes binlog cache and disk usage.
   */
@@ -1090,6 +1215,18 @@ int binlog_cache_data::write_event(THD *thd,
         if (metadata_ev.write(&cache_log))
           DBUG_RETURN(1);
       }
+
+      /* Add a placeholder for the writeset dependency, the actual dependency
+       * is computed during ordered commit (binlog flush stage) */
+      if (opt_binlog_writeset_dependency_tracking)
+      {
+        writeset_dependency_pos= get_byte_position();
+        Metadata_log_event metadata_ev(thd, is_trx_cache());
+        metadata_ev.set_writeset_dependency(0, 0);
+        if (metadata_ev.write(&cache_log))
+          DBUG_RETURN(1);
+      }
+      group_head_end= get_byte_position();
     }
   }
 
@@ -1147,6 +1284,254 @@ int binlog_cache_data::write_event(THD *thd,
 }
 
 
+/* Size of the buffers used to stage a binlog cache */
+#define BINLOG_STAGE_BUFFER_SIZE (1024 * 1024)
+
+/**
+  Multiplies two polynomials modulo the CRC-32 polynomial, in the reflected
+  bit order of the checksum.
+*/
+static uint32 crc32_multmodp(uint32 a, uint32 b)
+{
+  uint32 m= 1U << 31, p= 0;
+
+  if (!a)
+    return 0;
+  for (;;)
+  {
+    if (a & m)
+    {
+      p^= b;
+      if (!(a & (m - 1)))
+        break;
+    }
+    m>>= 1;
+    b= (b & 1) ? (b >> 1) ^ 0xedb88320U : b >> 1;
+  }
+  return p;
+}
+
+/**
+  x^(8n) modulo the CRC-32 polynomial: changing 4 bytes followed by n bytes
+  of checksummed data changes the CRC-32 by the CRC of the change, without
+  its pre and post conditioning, times crc32_shift(n).
+*/
+static uint32 crc32_shift(ulonglong n)
+{
+  uint32 p= 1U << 31, x= 1U << 23;              /* x^0 and x^8 */
+
+  for (; n; n>>= 1)
+  {
+    if (n & 1)
+      p= crc32_multmodp(x, p);
+    x= crc32_multmodp(x, x);
+  }
+  return p;
+}
+
+/**
+  The change of the CRC-32 of an event when 4 bytes are xor-ed with delta,
+  crc_shift being crc32_shift() of the number of checksummed bytes after
+  them.
+*/
+static uint32 crc32_patch(uint32 crc_shift, const uchar *delta)
+{
+  uint32 raw= (uint32) my_checksum(0xffffffffUL, delta, 4) ^ 0xffffffffU;
+  return crc32_multmodp(crc_shift, raw);
+}
+
+
+/**
+  Reads the file of a binlog cache from its beginning through a buffer.
+*/
+class Binlog_cache_reader
+{
+  File file;
+  my_off_t length;
+  uchar *buffer;
+  size_t size;
+  my_off_t pos;                                 /* offset of buffer[0] */
+  size_t filled;
+  size_t at;
+
+public:
+  Binlog_cache_reader(File file_arg, my_off_t length_arg, uchar *buffer_arg,
+                      size_t size_arg)
+    : file(file_arg), length(length_arg), buffer(buffer_arg),
+      size(size_arg), pos(0), filled(0), at(0)
+  {}
+
+  /**
+    Makes n bytes available at ptr().
+    @return false on a read error or at the end of the file
+  */
+  bool fill(size_t n)
+  {
+    if (filled - at >= n)
+      return true;
+    memmove(buffer, buffer + at, filled - at);
+    pos+= at;
+    filled-= at;
+    at= 0;
+    size_t want= (size_t) MY_MIN((my_off_t) (size - filled),
+                                 length - (pos + filled));
+    if (want && mysql_file_pread(file, buffer + filled, want, pos + filled,
+                                 MYF(MY_NABP)))
+      return false;
+    filled+= want;
+    return filled >= n;
+  }
+
+  const uchar *ptr() const { return buffer + at; }
+  size_t available() const { return filled - at; }
+  my_off_t tell() const { return pos + at; }
+  void consume(size_t n) { at+= n; }
+
+  void skip(my_off_t n)
+  {
+    if (n <= available())
+      at+= (size_t) n;
+    else
+    {
+      pos+= at + n;
+      filled= at= 0;
+    }
+  }
+};
+
+
+/**
+  Stages the events of a transaction whose cache spilled to disk, before
+  the transaction enters the flush stage of group commit.
+
+  The events are copied to stage_log with the length, checksum and
+  end_log_pos that do_write_cache() would give them if the group began at
+  position 0 of the binary log. The flush stage writes the events before
+  stage_from from the cache as before, as it rewrites them, and
+  MYSQL_BIN_LOG::write_staged_cache() adds the position of the group to
+  the end_log_pos of the staged events, patches their checksum for the
+  change and copies them to the binary log.
+
+  Staging is best effort: on any error the cache is written by
+  do_write_cache() as if it was not staged.
+*/
+void binlog_cache_data::stage()
+{
+  const my_off_t length= my_b_tell(&cache_log);
+  const ulong checksum_alg= binlog_checksum_options;
+  const bool do_checksum= checksum_alg != BINLOG_CHECKSUM_ALG_OFF;
+  uint32 events= 0;
+  my_off_t staged= 0;
+  uchar *buffer= NULL;
+  DBUG_ENTER("binlog_cache_data::stage");
+
+  DBUG_ASSERT(!is_staged());
+  if (!binlog_cache_stage_size || length < binlog_cache_stage_size ||
+      cache_log.pos_in_file == 0 || group_cache.get_n_groups() > 1 ||
+      length - group_head_end > (my_off_t) SIZE_T_MAX ||
+      DBUG_EVALUATE_IF("fault_injection_crc_value", 1, 0))
+    DBUG_VOID_RETURN;
+
+  if (!my_b_inited(&stage_log) &&
+      open_cached_file(&stage_log, mysql_tmpdir, LOG_PREFIX,
+                       BINLOG_STAGE_BUFFER_SIZE, MYF(0)))
+    DBUG_VOID_RETURN;
+
+  if (my_b_flush_io_cache(&cache_log, 1) ||
+      !(buffer= (uchar *) my_malloc(BINLOG_STAGE_BUFFER_SIZE, MYF(0))))
+    goto err;
+
+  {
+    Binlog_cache_reader reader(cache_log.file, length, buffer,
+                               BINLOG_STAGE_BUFFER_SIZE);
+    while (reader.tell() < length)
+    {
+      uchar header[LOG_EVENT_HEADER_LEN];
+      uchar buf[BINLOG_CHECKSUM_LEN];
+      const my_off_t event_pos= reader.tell();
+
+      if (!reader.fill(LOG_EVENT_HEADER_LEN))
+        goto err;
+      memcpy(header, reader.ptr(), LOG_EVENT_HEADER_LEN);
+      uint32 event_len= uint4korr(header + EVENT_LEN_OFFSET); // netto len
+      if (event_len < LOG_EVENT_HEADER_LEN || event_pos + event_len > length)
+        goto err;
+      events++;
+
+      /* The head of the group is rewritten during the flush stage */
+      if (event_pos < group_head_end)
+      {
+        if (event_pos + event_len > group_head_end)
+          goto err;
+        reader.skip(event_len);
+        continue;
+      }
+      if (stage_from == MY_OFF_T_UNDEF)
+        stage_from= event_pos;
+
+      /* fix end_log_pos, relative to the beginning of the group */
+      int4store(header + LOG_POS_OFFSET,
+                uint4korr(header + LOG_POS_OFFSET) +
+                (do_checksum ? events * BINLOG_CHECKSUM_LEN : 0));
+
+      Binlog_staged_event staged_event= { staged, 0 };
+      ha_checksum crc= 0;
+      if (do_checksum)
+      {
+        /* fix len */
+        int4store(header + EVENT_LEN_OFFSET, event_len + BINLOG_CHECKSUM_LEN);
+        staged_event.crc_shift= crc32_shift(event_len - LOG_POS_OFFSET - 4);
+        crc= my_checksum(my_checksum(0L, NULL, 0), header,
+                         LOG_EVENT_HEADER_LEN);
+      }
+      stage_events.push_back(staged_event);
+
+      if (my_b_write(&stage_log, header, LOG_EVENT_HEADER_LEN))
+        goto err;
+      reader.consume(LOG_EVENT_HEADER_LEN);
+      for (size_t rest= event_len - LOG_EVENT_HEADER_LEN; rest; )
+      {
+        if (!reader.fill(1))
+          goto err;
+        size_t chunk= MY_MIN(rest, reader.available());
+        if (do_checksum)
+          crc= my_checksum(crc, reader.ptr(), chunk);
+        if (my_b_write(&stage_log, reader.ptr(), chunk))
+          goto err;
+        reader.consume(chunk);
+        rest-= chunk;
+      }
+      if (do_checksum)
+      {
+        int4store(buf, crc);
+        if (my_b_write(&stage_log, buf, BINLOG_CHECKSUM_LEN))
+          goto err;
+      }
+      staged+= event_len + (do_checksum ? BINLOG_CHECKSUM_LEN : 0);
+    }
+  }
+
+  /* write_staged_cache() maps the file, make sure it holds all the events */
+  if (stage_from == MY_OFF_T_UNDEF ||
+      (stage_log.file == -1 && real_open_cached_file(&stage_log)) ||
+      my_b_flush_io_cache(&stage_log, 1))
+    goto err;
+
+  stage_length= staged;
+  stage_checksum_alg= checksum_alg;
+  my_free(buffer);
+  statistic_increment(binlog_cache_stage_use, &LOCK_status);
+  DBUG_PRINT("info", ("staged %llu bytes from %llu", (ulonglong) staged,
+                      (ulonglong) stage_from));
+  DBUG_VOID_RETURN;
+
+err:
+  release_stage();
+  my_free(buffer);
+  DBUG_VOID_RETURN;
+}
+
+
 /**
   Checks if the given GTID exists in the Group_cache. If not, add it
   as an empty group.
@@ -1262,6 +1647,52 @@ static int hlc_before_write_cache(THD* thd, binlog_cache_data* cache_data)
 }
 
 
+/**
+ * Update the writeset dependency in the cache during ordered commit
+ *
+ * @param thd - the THD in group commit
+ * @cache_data - The cache that needs to be updated with the dependency
+ *
+ * @return zero on success, non-zero on failure
+ */
+static int writeset_before_write_cache(THD* thd, binlog_cache_data* cache_data)
+{
+  DBUG_ENTER("writeset_before_write_cache");
+
+  if (cache_data->writeset_dependency_pos == MY_OFF_T_UNDEF)
+    DBUG_RETURN(0);
+
+  uint64_t last_committed= 0;
+  uint64_t sequence_number= mysql_bin_log.get_writeset_dependency(
+      cache_data->is_trx_cache() ? cache_data->get_writeset() : NULL,
+      &last_committed);
+
+  Metadata_log_event metadata_ev(thd, cache_data->is_trx_cache());
+  metadata_ev.set_writeset_dependency(last_committed, sequence_number);
+
+  bool using_file= cache_data->cache_log.pos_in_file > 0;
+  my_off_t saved_position= cache_data->reset_write_pos(
+      cache_data->writeset_dependency_pos, using_file);
+
+  if (cache_data->cache_log.error ||
+      metadata_ev.write(&cache_data->cache_log))
+  {
+    cache_data->set_flush_error(thd);
+    DBUG_RETURN(1);
+  }
+
+  cache_data->reset_write_pos(saved_position, using_file);
+
+  if (cache_data->cache_log.error)
+  {
+    cache_data->set_flush_error(thd);
+    DBUG_RETURN(1);
+  }
+
+  DBUG_RETURN(0);
+}
+
+
 /**
 
   @todo Move this function into the cache class?
@@ -1471,7 +1902,8 @@ binlog_cache_data::flush(THD *thd, my_off_t *bytes_written, bool *wrote_xid,
       transactions might trigger attempts to write to the binary log
       if the cache is not reset.
      */
-    if (!(error= gtid_before_write_cache(thd, this)))
+    if (!(error= gtid_before_write_cache(thd, this)) &&
+        !(error= writeset_before_write_cache(thd, this)))
       error= mysql_bin_log.write_cache(thd, this, async);
     else
       thd->commit_error= THD::CE_FLUSH_ERROR;
@@ -1821,6 +2253,39 @@ uint64_t HybridLogicalClock::update(uint64_t minimum_hlc)
   return new_min_hlc;
 }
 
+uint64_t Writeset_history::get_dependency(
+    const std::unordered_set<uint64_t> *writeset, uint64_t *last_committed)
+{
+  uint64_t sequence_number= ++sequence_number_;
+
+  // case: the writeset cannot be used or the history would grow beyond the
+  // limit, this trx depends on all previous trxs and so do all following trxs
+  if (writeset == NULL ||
+      history_.size() + writeset->size() > opt_binlog_writeset_history_size)
+  {
+    *last_committed= sequence_number - 1;
+    history_.clear();
+    history_start_= sequence_number;
+    return sequence_number;
+  }
+
+  uint64_t parent= history_start_;
+  for (const auto hash : *writeset)
+  {
+    auto it= history_.find(hash);
+    if (it != history_.end())
+    {
+      parent= std::max(parent, it->second);
+      it->second= sequence_number;
+    }
+    else
+      history_.emplace(hash, sequence_number);
+  }
+
+  *last_committed= parent;
+  return sequence_number;
+}
+
 /**
   Write a rollback record of the transaction to the binary log.
 
@@ -2951,7 +3416,7 @@ MYSQL_BIN_LOG::MYSQL_BIN_LOG(uint *sync_period)
   :bytes_written(0), file_id(1), open_count(1),
    sync_period_ptr(sync_period), sync_counter(0),
    m_prep_xids(0),
-   binlog_end_pos(0),
+   binlog_end_pos(0), durable_file_num(0), durable_pos(0),
    is_relay_log(0), signal_cnt(0),
    checksum_alg_reset(BINLOG_CHECKSUM_ALG_UNDEF),
    relay_log_checksum_alg(BINLOG_CHECKSUM_ALG_UNDEF),
@@ -3918,6 +4383,13 @@ bool MYSQL_BIN_LOG::open_binlog(const char *log_name,
     bytes_written+= metadata_ev.get_total_size();
   }
 
+  /* Sequence numbers of the writeset dependencies start afresh in every
+   * binlog file, the slave treats a sequence number going back as a point
+   * where it has to wait for all trxs in flight (see
+   * Metadata_log_event::prepare_dep) */
+  if (!is_relay_log)
+    writeset_history.reset();
+
   if (need_sid_lock)
     global_sid_lock->unlock();
 
@@ -4568,6 +5040,12 @@ bool MYSQL_BIN_LOG::reset_logs(THD* thd)
   mysql_mutex_lock(&LOCK_log);
   mysql_mutex_lock(&LOCK_index);
 
+  /* The numbering of the files starts again */
+  mysql_mutex_lock(&LOCK_binlog_end_pos);
+  durable_file_num= 0;
+  durable_pos= 0;
+  mysql_mutex_unlock(&LOCK_binlog_end_pos);
+
   /*
     The following mutex is needed to ensure that no threads call
     'delete thd' as we would then risk missing a 'rollback' from this
@@ -5811,9 +6289,13 @@ bool MYSQL_BIN_LOG::after_append_to_relay_log(Master_info *mi)
   DBUG_ASSERT(is_relay_log);
   DBUG_ASSERT(current_thd->system_thread == SYSTEM_THREAD_SLAVE_IO);
 
-  // Flush and sync
+  /*
+    Flush and sync. With relay_log_group_sync the sync is left to
+    sync_relay_log_batch(), at the end of the batch.
+  */
+  bool defer_sync= opt_relay_log_group_sync > 0;
   bool error= false;
-  if (flush_and_sync(0, 0) == 0)
+  if (flush_and_sync(defer_sync, 0) == 0)
   {
     DBUG_EXECUTE_IF ("set_max_size_zero",
                      {max_size=0;});
@@ -5823,6 +6305,12 @@ bool MYSQL_BIN_LOG::after_append_to_relay_log(Master_info *mi)
                           DBUG_EVALUATE_IF("slave_skipping_gtid",
                                            870, max_size)))
     {
+      /* The events of the current batch must be synced before rotating. */
+      if (defer_sync && flush_and_sync(false, true))
+      {
+        update_binlog_end_pos();
+        DBUG_RETURN(true);
+      }
       mysql_mutex_lock(&mi->fde_lock);
       error= new_file_without_locking(
                mi->get_mi_descripion_event_with_no_lock());
@@ -5918,6 +6406,29 @@ bool MYSQL_BIN_LOG::append_buffer(const char* buf, uint len, Master_info *mi)
   mysql_mutex_lock(&mi->data_lock);
   DBUG_RETURN(error);
 }
+
+
+/**
+  Syncs the relay log at the end of a batch of events appended by the
+  slave I/O thread when relay_log_group_sync is set. The batch counts
+  as one event for sync_relay_log.
+
+  @retval false success
+  @retval true error
+*/
+bool MYSQL_BIN_LOG::sync_relay_log_batch()
+{
+  DBUG_ENTER("MYSQL_BIN_LOG::sync_relay_log_batch");
+  DBUG_ASSERT(is_relay_log);
+
+  bool error= false;
+  mysql_mutex_lock(&LOCK_log);
+  if (is_open())
+    error= sync_binlog_file(false, false).first;
+  mysql_mutex_unlock(&LOCK_log);
+
+  DBUG_RETURN(error);
+}
 #endif // ifdef HAVE_REPLICATION
 
 bool MYSQL_BIN_LOG::flush_and_sync(bool async, const bool force)
@@ -5932,6 +6443,173 @@ bool MYSQL_BIN_LOG::flush_and_sync(bool async, const bool force)
   return result.first;
 }
 
+
+/**
+  Return the number of a binary log file, which is the extension of its
+  name, or 0 if the name has no numeric extension.
+
+  @param name       file name
+  @param name_end   end of the file name
+  @param[out] base_length length of the name before the extension
+*/
+static ulong binlog_file_num(const char *name, const char *name_end,
+                             size_t *base_length)
+{
+  const char *ext= name_end;
+  ulong num= 0;
+
+  while (ext > name && my_isdigit(&my_charset_latin1, ext[-1]))
+    ext--;
+  if (ext == name_end || ext == name || ext[-1] != '.')
+    return 0;
+  *base_length= ext - name;
+  for (; ext < name_end; ext++)
+    num= num * 10 + (*ext - '0');
+  return num;
+}
+
+
+/**
+  Check a commit ticket against the binary log.
+
+  @param ticket       commit ticket
+  @param base_length  length of the file name of the ticket before its
+                      extension
+  @param file_num     number of the file of the ticket
+  @param pos          position of the ticket
+
+  @retval 0  the transactions up to the ticket are durable
+  @retval 1  the ticket is a position of the binary log not yet durable
+  @retval -1 the ticket is not a position of the binary log
+*/
+int MYSQL_BIN_LOG::check_commit_ticket(const char *ticket, size_t base_length,
+                                       ulong file_num, my_off_t pos)
+{
+  int state;
+
+  mysql_mutex_lock(&LOCK_binlog_end_pos);
+  const char *name= binlog_file_name + dirname_length(binlog_file_name);
+  size_t current_base_length= 0;
+  ulong current_num= binlog_file_num(name, name + strlen(name),
+                                     &current_base_length);
+
+  if (base_length != current_base_length ||
+      memcmp(name, ticket, base_length) ||
+      file_num > current_num ||
+      (file_num == current_num && pos > binlog_end_pos))
+    state= -1;
+  else if (file_num < durable_file_num ||
+           (file_num == durable_file_num && pos <= durable_pos))
+    state= 0;
+  else
+    state= 1;
+  mysql_mutex_unlock(&LOCK_binlog_end_pos);
+  return state;
+}
+
+
+/**
+  Make the transactions written to the binary log up to a commit ticket
+  durable, in the binary log and in the storage engines.
+
+  A commit ticket is the "<binary log file>:<end position>" of a
+  transaction, set in the flush stage. With sql_async_commit, COMMIT
+  returns after the flush stage without syncing the binary log, and the
+  session can get the durability of its transactions later from here.
+
+  The engine logs are flushed and the binary log file is synced unless the
+  sync of a commit group or an earlier call did it past the ticket. Callers
+  serialize on LOCK_log, so that one sync serves all the tickets written
+  before it. The files before the current one were synced when they were
+  closed.
+
+  @param ticket commit ticket
+
+  @retval 0  the transactions up to the ticket are durable
+  @retval 1  error, reported
+  @retval -1 the ticket is not a position of the binary log
+*/
+int MYSQL_BIN_LOG::wait_for_commit_ticket(const char *ticket)
+{
+  DBUG_ENTER("MYSQL_BIN_LOG::wait_for_commit_ticket");
+  const char *colon= strrchr(ticket, ':');
+  char *end;
+  int state;
+
+  if (colon == NULL || !my_isdigit(&my_charset_latin1, colon[1]))
+    DBUG_RETURN(-1);
+
+  size_t base_length= 0;
+  ulong file_num= binlog_file_num(ticket, colon, &base_length);
+  my_off_t pos= strtoull(colon + 1, &end, 10);
+  if (file_num == 0 || *end != '\0')
+    DBUG_RETURN(-1);
+
+  if ((state= check_commit_ticket(ticket, base_length, file_num, pos)) <= 0)
+    DBUG_RETURN(state);
+
+  mysql_mutex_lock(&LOCK_log);
+  if (is_open() &&
+      check_commit_ticket(ticket, base_length, file_num, pos) > 0)
+  {
+    bool engines_durable= true;
+    if (ha_flush_logs(NULL, NULL, &engines_durable) ||
+        flush_and_sync(false, true))
+    {
+      if (!current_thd->is_error())
+        my_error(ER_ERROR_ON_WRITE, MYF(0), log_file_name, errno);
+      mysql_mutex_unlock(&LOCK_log);
+      DBUG_RETURN(1);
+    }
+
+    if (engines_durable)
+      set_durable_pos(log_file_num(), my_b_tell(&log_file));
+  }
+  mysql_mutex_unlock(&LOCK_log);
+  DBUG_RETURN(0);
+}
+
+
+/**
+  Get the number of the current binary log file, from its extension.
+
+  Caller must hold LOCK_log mutex when the file is in use.
+*/
+ulong MYSQL_BIN_LOG::log_file_num()
+{
+  const char *name= log_file_name + dirname_length(log_file_name);
+  size_t base_length= 0;
+  return binlog_file_num(name, name + strlen(name), &base_length);
+}
+
+
+/**
+  Record that the transactions written to the binary log up to a position
+  are durable, after the file was synced. Their prepared records were
+  flushed in the storage engines before they were written to the binary
+  log, so crash recovery commits them.
+
+  The durable position only moves forward: a commit group can finish its
+  sync after a later one.
+
+  @param file_num number of the binary log file
+  @param pos      position in the file
+*/
+void MYSQL_BIN_LOG::set_durable_pos(ulong file_num, my_off_t pos)
+{
+  if (is_relay_log)
+    return;
+
+  mysql_mutex_lock(&LOCK_binlog_end_pos);
+  if (file_num > durable_file_num ||
+      (file_num == durable_file_num && pos > durable_pos))
+  {
+    durable_file_num= file_num;
+    durable_pos= pos;
+  }
+  mysql_mutex_unlock(&LOCK_binlog_end_pos);
+}
+
 void MYSQL_BIN_LOG::start_union_events(THD *thd, query_id_t query_id_param)
 {
   DBUG_ASSERT(!thd->binlog_evt_union.do_union);
@@ -6401,8 +7079,8 @@ void MYSQL_BIN_LOG::unlock_commits(const snapshot_info_st *ss_info)
 
   SYNOPSIS
     do_write_cache()
-    cache    Cache to write to the binary log
-    lock_log True if the LOCK_log mutex should be aquired, false otherwise
+    cache        Cache to write to the binary log
+    end_of_cache End of the events of the cache to write
 
   DESCRIPTION
     Write the contents of the cache to the binary log. The cache will
@@ -6413,9 +7091,9 @@ void MYSQL_BIN_LOG::unlock_commits(const snapshot_info_st *ss_info)
     events prior to fill in the binlog cache.
 */
 
-int MYSQL_BIN_LOG::do_write_cache(IO_CACHE *cache)
+int MYSQL_BIN_LOG::do_write_cache(IO_CACHE *cache, my_off_t end_of_cache)
 {
-  DBUG_ENTER("MYSQL_BIN_LOG::do_write_cache(IO_CACHE *)");
+  DBUG_ENTER("MYSQL_BIN_LOG::do_write_cache(IO_CACHE *, my_off_t)");
 
   DBUG_EXECUTE_IF("simulate_do_write_cache_failure",
                   {
@@ -6425,6 +7103,13 @@ int MYSQL_BIN_LOG::do_write_cache(IO_CACHE *cache)
 
   if (reinit_io_cache(cache, READ_CACHE, 0, 0, 0))
     DBUG_RETURN(ER_ERROR_ON_WRITE);
+  if (end_of_cache < cache->end_of_file)
+  {
+    /* The events after end_of_cache are written by write_staged_cache() */
+    cache->end_of_file= end_of_cache;
+    if ((my_off_t) (cache->read_end - cache->read_pos) > end_of_cache)
+      cache->read_end= cache->read_pos + end_of_cache;
+  }
   uint length= my_b_bytes_in_cache(cache), group, carry, hdr_offs;
   ulong remains= 0; // part of unprocessed yet netto length of the event
   long val;
@@ -6722,6 +7407,92 @@ bool MYSQL_BIN_LOG::write_incident(THD *thd, bool need_lock_log,
   DBUG_RETURN(write_incident(&ev, need_lock_log, do_flush_and_sync));
 }
 
+/**
+  Writes the events of a cache staged by binlog_cache_data::stage(), after
+  do_write_cache() wrote the events before them.
+
+  The position of the group is added to the end_log_pos of each staged
+  event, and its checksum patched for the change, in place in the stage
+  file mapped in memory. The events are then copied from the stage file to
+  the binary log by the kernel where it can, else written through log_file.
+
+  @param cache_data  The staged cache
+  @param group       Position of the group in the binary log
+
+  @return 0 or ER_ERROR_ON_WRITE
+*/
+
+int MYSQL_BIN_LOG::write_staged_cache(binlog_cache_data *cache_data,
+                                      my_off_t group)
+{
+  const my_off_t length= cache_data->stage_length;
+  const bool do_checksum= binlog_checksum_options != BINLOG_CHECKSUM_ALG_OFF;
+  my_off_t copied= 0;
+  int error= 0;
+  uchar *events;
+  DBUG_ENTER("MYSQL_BIN_LOG::write_staged_cache");
+
+  DBUG_ASSERT(cache_data->is_staged() && log_file.type == WRITE_CACHE);
+  events= (uchar *) my_mmap(0, (size_t) length, PROT_READ | PROT_WRITE,
+                            MAP_SHARED, cache_data->stage_log.file, 0);
+  if (events == MAP_FAILED)
+    DBUG_RETURN(ER_ERROR_ON_WRITE);
+
+  for (const Binlog_staged_event &staged : cache_data->stage_events)
+  {
+    uchar *ev= events + staged.offset;
+    uchar *log_pos= ev + LOG_POS_OFFSET;
+    uchar delta[4];
+
+    memcpy(delta, log_pos, sizeof(delta));
+    int4store(log_pos, uint4korr(log_pos) + (uint32) group);
+    if (do_checksum)
+    {
+      uchar *crc= ev + uint4korr(ev + EVENT_LEN_OFFSET) - BINLOG_CHECKSUM_LEN;
+      for (uint i= 0; i < sizeof(delta); i++)
+        delta[i]^= log_pos[i];
+      int4store(crc, uint4korr(crc) ^ crc32_patch(staged.crc_shift, delta));
+    }
+  }
+
+#ifdef SYS_copy_file_range
+  if (my_b_flush_io_cache(&log_file, 1))
+    error= ER_ERROR_ON_WRITE;
+  else
+  {
+    loff_t from= 0, to= (loff_t) my_b_tell(&log_file);
+    while (copied < length)
+    {
+      ssize_t n= syscall(SYS_copy_file_range, cache_data->stage_log.file,
+                         &from, log_file.file, &to,
+                         (size_t) MY_MIN(length - copied, (my_off_t) 1 << 30),
+                         0);
+      if (n <= 0)
+        break;
+      copied+= n;
+    }
+    if (copied)
+    {
+      /*
+        The events went to the file behind log_file: move the cache past
+        them, as my_b_flush_io_cache() does after a write.
+      */
+      log_file.pos_in_file+= copied;
+      log_file.seek_not_done= 1;
+      log_file.write_end= log_file.write_buffer + log_file.buffer_length -
+                          (log_file.pos_in_file & (IO_SIZE - 1));
+      set_if_bigger(log_file.end_of_file, log_file.pos_in_file);
+    }
+  }
+#endif
+
+  if (!error && copied < length &&
+      my_b_write(&log_file, events + copied, (size_t) (length - copied)))
+    error= ER_ERROR_ON_WRITE;
+  my_munmap(events, (size_t) length);
+  DBUG_RETURN(error);
+}
+
 /**
   Write a cached log entry to the binary log.
 
@@ -6772,7 +7543,8 @@ bool MYSQL_BIN_LOG::write_cache(THD *thd, binlog_cache_data *cache_data,
     {
       DBUG_EXECUTE_IF("crash_before_writing_xid",
                       {
-                        if ((write_error= do_write_cache(cache)))
+                        if ((write_error= do_write_cache(cache,
+                                                         my_b_tell(cache))))
                           DBUG_PRINT("info", ("error writing binlog cache: %d",
                                                write_error));
                         flush_and_sync(async, true);
@@ -6780,13 +7552,21 @@ bool MYSQL_BIN_LOG::write_cache(THD *thd, binlog_cache_data *cache_data,
                         DBUG_SUICIDE();
                       });
 
-      if ((write_error= do_write_cache(cache)))
+      const my_off_t cache_length= my_b_tell(cache);
+      if (cache_data->is_staged() && log_file.type == WRITE_CACHE)
+      {
+        const my_off_t group= my_b_tell(&log_file);
+        if ((write_error= do_write_cache(cache, cache_data->stage_from)) ||
+            (write_error= write_staged_cache(cache_data, group)))
+          goto err;
+      }
+      else if ((write_error= do_write_cache(cache, cache_length)))
         goto err;
       if (us)
       {
-        us->binlog_bytes_written.inc(my_b_tell(cache));
+        us->binlog_bytes_written.inc(cache_length);
       }
-      binlog_bytes_written += my_b_tell(cache);
+      binlog_bytes_written += cache_length;
 
       if (incident && write_incident(thd, false/*need_lock_log=false*/,
                                      false/*do_flush_and_sync==false*/))
@@ -6979,7 +7759,12 @@ void MYSQL_BIN_LOG::close(uint exiting)
     }
 
     /* this will cleanup IO_CACHE, sync and close the file */
+    ulong end_file_num= log_file_num();
+    my_off_t end_pos= my_b_tell(&log_file);
+    bool had_write_error= write_error;
     MYSQL_LOG::close(exiting);
+    if (!had_write_error && !write_error)
+      set_durable_pos(end_file_num, end_pos);
   }
 
   /*
@@ -7399,6 +8184,7 @@ TC_LOG::enum_result MYSQL_BIN_LOG::commit(THD *thd, bool all, bool async)
       if (cache_mngr->trx_cache.finalize(thd, &end_evt))
         DBUG_RETURN(RESULT_ABORTED);
     }
+    cache_mngr->trx_cache.stage();
     stuff_logged= true;
   }
 
@@ -7438,6 +8224,31 @@ TC_LOG::enum_result MYSQL_BIN_LOG::commit(THD *thd, bool all, bool async)
 }
 
 
+/**
+  Record the commit ticket of a transaction written to the binary log,
+  and send it to the client as a response attribute if the session asked
+  for it.
+
+  @param thd  the session of the transaction
+  @param file name of the binary log file
+  @param pos  end position of the transaction in the file
+*/
+static void set_commit_ticket(THD *thd, const char *file, my_off_t pos)
+{
+  my_snprintf(thd->commit_ticket, sizeof(thd->commit_ticket), "%s:%llu",
+              file + dirname_length(file), (ulonglong) pos);
+
+  auto tracker= thd->session_tracker.get_tracker(SESSION_RESP_ATTR_TRACKER);
+  if (thd->variables.response_attrs_contain_commit_ticket &&
+      tracker->is_enabled())
+  {
+    static LEX_CSTRING key= { STRING_WITH_LEN("commit_ticket") };
+    LEX_CSTRING value= { thd->commit_ticket, strlen(thd->commit_ticket) };
+    tracker->mark_as_changed(thd, &key, &value);
+  }
+}
+
+
 /**
    Flush caches for session.
 
@@ -7480,6 +8291,7 @@ MYSQL_BIN_LOG::flush_thread_caches(THD *thd, bool async)
       this function documentation for more info.
     */
     thd->set_trans_pos(log_file_name, my_b_tell(&log_file), last_group);
+    set_commit_ticket(thd, log_file_name, my_b_tell(&log_file));
     if (wrote_xid)
       inc_prep_xids(thd);
   }
@@ -7498,6 +8310,10 @@ MYSQL_BIN_LOG::flush_thread_caches(THD *thd, bool async)
   binlog rotation should be performed after releasing locks. If rotate
   is not necessary, the variable will not be touched.
 
+  @param durable_var Pointer to variable that will be set to false if
+  the storage engines wrote the prepared records of the group to their
+  logs without syncing them, and to true otherwise.
+
   @return Error code on error, zero on success
  */
 
@@ -7505,7 +8321,8 @@ int
 MYSQL_BIN_LOG::process_flush_stage_queue(my_off_t *total_bytes_var,
                                          bool *rotate_var,
                                          THD **out_queue_var,
-                                         bool async)
+                                         bool async,
+                                         bool *durable_var)
 {
   DBUG_ASSERT(total_bytes_var && rotate_var && out_queue_var);
   my_off_t total_bytes= 0;
@@ -7523,8 +8340,10 @@ MYSQL_BIN_LOG::process_flush_stage_queue(my_off_t *total_bytes_var,
 
   /* Do an explicit transaction log group write before flushing binary log
      cache to file. */
-  if (!first_seen->prepared_engine->is_empty())
-    ha_flush_logs(NULL, first_seen->prepared_engine);
+  *durable_var= true;
+  if (!first_seen->prepared_engine->is_empty() &&
+      ha_flush_logs(NULL, first_seen->prepared_engine, durable_var))
+    *durable_var= false;
 
 #ifndef DBUG_OFF
   for (THD *head= first_seen ; head ; head = head->next_to_commit)
@@ -7813,6 +8632,8 @@ MYSQL_BIN_LOG::sync_binlog_file(bool force, bool async)
   {
     sync_counter= 0;
     statistic_increment(binlog_fsync_count, &LOCK_status);
+    if (is_relay_log)
+      statistic_increment(relay_log_fsync_count, &LOCK_status);
 
     /**
       On *pure non-transactional* workloads there is a small window
@@ -8151,6 +8972,8 @@ int MYSQL_BIN_LOG::ordered_commit(THD *thd, bool all, bool skip_commit,
   THD *final_queue= NULL;
   mysql_mutex_t *leave_mutex_before_commit_stage= NULL;
   my_off_t flush_end_pos= 0;
+  ulong flush_end_file_num= 0;
+  bool engines_durable= false;
   if (unlikely(!is_open()))
   {
     final_queue= stage_manager.fetch_queue_for(Stage_manager::FLUSH_STAGE);
@@ -8165,10 +8988,14 @@ int MYSQL_BIN_LOG::ordered_commit(THD *thd, bool all, bool skip_commit,
   }
   DEBUG_SYNC(thd, "waiting_in_the_middle_of_flush_stage");
   flush_error= process_flush_stage_queue(&total_bytes, &do_rotate,
-                                         &final_queue, async);
+                                         &final_queue, async,
+                                         &engines_durable);
 
   if (flush_error == 0 && total_bytes > 0)
+  {
     flush_error = flush_cache_to_file(&flush_end_pos);
+    flush_end_file_num= log_file_num();
+  }
 
   DBUG_EXECUTE_IF("crash_after_flush_binlog", DBUG_SUICIDE(););
   /*
@@ -8196,6 +9023,13 @@ int MYSQL_BIN_LOG::ordered_commit(THD *thd, bool all, bool skip_commit,
       DEBUG_SYNC(thd, "before_sync_binlog_file");
       std::pair<bool, bool> result = sync_binlog_file(false, async);
       flush_error = result.first;
+      /*
+        Without a sync of the engine logs, the prepared records of the
+        group can be lost and the group is only durable after
+        wait_for_commit_ticket() syncs them.
+      */
+      if (result.second && engines_durable)
+        set_durable_pos(flush_end_file_num, flush_end_pos);
     }
 
     /*
@@ -10188,6 +11022,98 @@ CPP_UNNAMED_NS_START
 
 CPP_UNNAMED_NS_END
 
+/**
+  Adds the hashes of the unique keys of a row modified by the current trx to
+  the writeset of the binlog cache (see
+  @c opt_binlog_writeset_dependency_tracking).
+
+  The hash of a key is computed from the database, table and key names and
+  the sort key image of the key parts, so rows which are duplicates for the
+  key (e.g. differ only in case for a case insensitive collation) get the same
+  hash. If a row cannot be identified this way the writeset of the trx is
+  marked as unusable and the trx will depend on all previous trxs.
+
+  @param table             The table the row belongs to
+  @param is_transactional  Which cache the row is logged to
+  @param record            The row in record format
+*/
+void THD::binlog_add_row_to_writeset(TABLE *table, bool is_transactional,
+                                     const uchar *record)
+{
+  binlog_cache_data *cache_data=
+    thd_get_cache_mngr(this)->get_binlog_cache_data(is_transactional);
+
+  if (cache_data->is_writeset_unusable())
+    return;
+
+  // case: rows of non transactional tables, tables without a primary key and
+  // tables with foreign keys cannot be tracked using unique keys alone
+  if (!is_transactional || table->s->primary_key == MAX_KEY ||
+      table->file->referenced_by_foreign_key() ||
+      table->file->is_fk_defined_on_table_or_index(MAX_KEY))
+  {
+    cache_data->set_writeset_unusable();
+    return;
+  }
+
+  const my_ptrdiff_t ptrdiff= record - table->record[0];
+  std::string key;
+
+  for (uint i= 0; i < table->s->keys; ++i)
+  {
+    const KEY *key_info= table->key_info + i;
+    if (!(key_info->flags & HA_NOSAME))
+      continue;
+
+    key.assign(table->s->db.str, table->s->db.length);
+    key.push_back('\0');
+    key.append(table->s->table_name.str, table->s->table_name.length);
+    key.push_back('\0');
+    key.append(key_info->name);
+    key.push_back('\0');
+
+    bool has_null= false;
+    for (uint j= 0; j < key_info->user_defined_key_parts; ++j)
+    {
+      const KEY_PART_INFO *key_part= key_info->key_part + j;
+      Field *field= key_part->field;
+
+      // case: the value of the column is not known or only a prefix of the
+      // column is unique
+      if ((!bitmap_is_set(table->read_set, field->field_index) &&
+           !bitmap_is_set(table->write_set, field->field_index)) ||
+          (key_part->key_part_flag & HA_PART_KEY_SEG))
+      {
+        cache_data->set_writeset_unusable();
+        return;
+      }
+
+      // NULLs are never duplicates, so this key doesn't identify the row
+      if (field->is_null(ptrdiff))
+      {
+        has_null= true;
+        break;
+      }
+
+      const size_t pos= key.length();
+      const uint length= field->sort_length();
+      key.resize(pos + length);
+      field->move_field_offset(ptrdiff);
+      field->make_sort_key((uchar *) &key[pos], length);
+      field->move_field_offset(-ptrdiff);
+    }
+
+    if (has_null)
+      continue;
+
+    const uint64_t hash=
+      ((uint64_t) murmur3_32((const uchar *) key.data(), key.length(), 0)
+       << 32) |
+      murmur3_32((const uchar *) key.data(), key.length(), 1);
+    cache_data->add_to_writeset(hash);
+  }
+}
+
 int THD::binlog_write_row(TABLE* table, bool is_trans,
                           uchar const *record,
                           const uchar* extra_row_info)
@@ -10214,6 +11140,9 @@ int THD::binlog_write_row(TABLE* table, bool is_trans,
   if (unlikely(ev == 0))
     return HA_ERR_OUT_OF_MEM;
 
+  if (opt_binlog_writeset_dependency_tracking)
+    binlog_add_row_to_writeset(table, is_trans, record);
+
   return ev->add_row_data(row_data, len);
 }
 
@@ -10281,6 +11210,12 @@ int THD::binlog_update_row(TABLE* table, bool is_trans,
   table->column_bitmaps_set_no_signal(old_read_set,
                                       old_write_set);
 
+  if (!error && opt_binlog_writeset_dependency_tracking)
+  {
+    binlog_add_row_to_writeset(table, is_trans, before_record);
+    binlog_add_row_to_writeset(table, is_trans, after_record);
+  }
+
   return error;
 }
 
@@ -10332,6 +11267,9 @@ int THD::binlog_delete_row(TABLE* table, bool is_trans,
   table->column_bitmaps_set_no_signal(old_read_set,
                                       old_write_set);
 
+  if (!error && opt_binlog_writeset_dependency_tracking)
+    binlog_add_row_to_writeset(table, is_trans, record);
+
   return error;
 }
 
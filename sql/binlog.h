@@ -22,6 +22,8 @@
 #include "rpl_gtid.h"
 #include <atomic>
 #include <list>
+#include <unordered_map>
+#include <unordered_set>
 
 extern ulong rpl_read_size;
 extern char *histogram_step_size_binlog_fsync;
@@ -311,6 +313,51 @@ class HybridLogicalClock {
   std::atomic<uint64_t> current_;
 };
 
+/**
+ * Tracks the sequence number of the last trx which modified each row hash
+ * (see THD::binlog_add_row_to_writeset) to compute writeset based
+ * dependencies of trxs in the binlog flush stage. Trxs with disjoint
+ * writesets can be applied in parallel on the slave, the dependency of a trx
+ * (last_committed) is the largest sequence number of the trxs sharing a row
+ * hash with it. This is only accessed in the flush stage, so it is protected
+ * by LOCK_log.
+ */
+class Writeset_history {
+ public:
+  /**
+   * Assign the next sequence number to a trx and compute its dependency
+   *
+   * @param writeset       - Row hashes of the trx, NULL if the writeset of the
+   *                         trx cannot be used (e.g. DDL, tables without unique
+   *                         keys, tables with foreign keys)
+   * @param last_committed - [out] Sequence number of the last trx this trx
+   *                         conflicts with
+   *
+   * @return   The sequence number of this trx
+   */
+  uint64_t get_dependency(const std::unordered_set<uint64_t> *writeset,
+                          uint64_t *last_committed);
+
+  /**
+   * Forget all trxs, this is done when a new binlog file is opened
+   */
+  void reset()
+  {
+    sequence_number_= 0;
+    history_start_= 0;
+    history_.clear();
+  }
+
+ private:
+  // Last sequence number assigned to a trx
+  uint64_t sequence_number_= 0;
+  // All trxs up to this sequence number are treated as conflicting with the
+  // next trx, this moves forward when the history is cleared
+  uint64_t history_start_= 0;
+  // Row hash -> sequence number of the last trx which modified it
+  std::unordered_map<uint64_t, uint64_t> history_;
+};
+
 class MYSQL_BIN_LOG: public TC_LOG, private MYSQL_LOG
 {
 public:
@@ -418,6 +465,19 @@ public:
   // log_file_name is protected by LOCK_log mutex.
   char binlog_file_name[FN_REFLEN];
 
+  /*
+    The transactions written to the binary log up to this file number and
+    position are durable in the binary log and in the storage engines.
+    Protected by LOCK_binlog_end_pos, and only changed under LOCK_log,
+    after a sync of the binary log file. See wait_for_commit_ticket().
+  */
+  ulong durable_file_num;
+  my_off_t durable_pos;
+  ulong log_file_num();
+  void set_durable_pos(ulong file_num, my_off_t pos);
+  int check_commit_ticket(const char *ticket, size_t base_length,
+                          ulong file_num, my_off_t pos);
+
   /**
     Increment the prepared XID counter.
    */
@@ -652,6 +712,15 @@ public:
     return hlc.update(minimum_hlc);
   }
 
+  /* Return the writeset dependency for the trx being flushed. This should be
+     called only from the flush stage */
+  uint64_t get_writeset_dependency(
+      const std::unordered_set<uint64_t> *writeset, uint64_t *last_committed)
+  {
+    mysql_mutex_assert_owner(&LOCK_log);
+    return writeset_history.get_dependency(writeset, last_committed);
+  }
+
 private:
   Gtid_set* previous_gtid_set;
 
@@ -665,6 +734,9 @@ private:
   */
   HybridLogicalClock hlc;
 
+  /* Writeset history for binlog_writeset_dependency_tracking */
+  Writeset_history writeset_history;
+
 
   int open(const char *opt_name) { return open_binlog(opt_name); }
   bool change_stage(THD *thd, Stage_manager::StageID stage,
@@ -677,7 +749,8 @@ private:
   void process_commit_stage_queue(THD *thd, THD *queue, bool async);
   void process_after_commit_stage_queue(THD *thd, THD *first, bool async);
   int process_flush_stage_queue(my_off_t *total_bytes_var, bool *rotate_var,
-                                THD **out_queue_var, bool async);
+                                THD **out_queue_var, bool async,
+                                bool *durable_var);
   int ordered_commit(THD *thd, bool all, bool skip_commit = false,
                      bool async=false);
   void handle_binlog_flush_or_sync_error(THD *thd, bool need_lock_log);
@@ -760,7 +833,9 @@ public:
                    bool write_meta_data_event= false);
   bool write_cache(THD *thd, class binlog_cache_data *binlog_cache_data,
                    bool async);
-  int  do_write_cache(IO_CACHE *cache);
+  int  do_write_cache(IO_CACHE *cache, my_off_t end_of_cache);
+  int  write_staged_cache(class binlog_cache_data *cache_data,
+                          my_off_t group);
 
   void set_write_error(THD *thd, bool is_transactional);
   bool check_write_error(THD *thd);
@@ -776,6 +851,7 @@ public:
 #ifdef HAVE_REPLICATION
   bool append_buffer(const char* buf, uint len, Master_info *mi);
   bool append_event(Log_event* ev, Master_info *mi);
+  bool sync_relay_log_batch();
 private:
   bool after_append_to_relay_log(Master_info *mi);
 #endif // ifdef HAVE_REPLICATION
@@ -804,6 +880,7 @@ public:
      @retval other Failure
   */
   bool flush_and_sync(bool async, const bool force);
+  int wait_for_commit_ticket(const char *ticket);
   int purge_logs(const char *to_log, bool included,
                  bool need_lock_index, bool need_update_threads,
                  std::atomic_ullong *decrease_log_space, bool auto_purge);
@@ -13,13 +13,7 @@ unsigned char num_db_stats_entries = 0;
 static void
 clear_db_stats_counters(DB_STATS* db_stats)
 {
-  db_stats->us_user.clear();
-  db_stats->us_sys.clear();
-  db_stats->us_tot.clear();
-  db_stats->rows_deleted.clear();
-  db_stats->rows_inserted.clear();
-  db_stats->rows_read.clear();
-  db_stats->rows_updated.clear();
+  db_stats->counters.clear();
 }
 
 extern "C" uchar *get_key_db_stats(const uchar *ptr, size_t *length,
@@ -109,13 +103,14 @@ int fill_db_stats(THD *thd, TABLE_LIST *tables, Item *cond)
                                system_charset_info);
       table->field[f++]->store(0);
 
-    table->field[f++]->store(db_stats->us_user.load(), TRUE);
-    table->field[f++]->store(db_stats->us_sys.load(), TRUE);
-    table->field[f++]->store(db_stats->us_tot.load(), TRUE);
-    table->field[f++]->store(db_stats->rows_deleted.load(), TRUE);
-    table->field[f++]->store(db_stats->rows_inserted.load(), TRUE);
-    table->field[f++]->store(db_stats->rows_read.load(), TRUE);
-    table->field[f++]->store(db_stats->rows_updated.load(), TRUE);
+    typedef db_stats_counters C;
+    table->field[f++]->store(db_stats->counters.load(&C::us_user), TRUE);
+    table->field[f++]->store(db_stats->counters.load(&C::us_sys), TRUE);
+    table->field[f++]->store(db_stats->counters.load(&C::us_tot), TRUE);
+    table->field[f++]->store(db_stats->counters.load(&C::rows_deleted), TRUE);
+    table->field[f++]->store(db_stats->counters.load(&C::rows_inserted), TRUE);
+    table->field[f++]->store(db_stats->counters.load(&C::rows_read), TRUE);
+    table->field[f++]->store(db_stats->counters.load(&C::rows_updated), TRUE);
 
     if (schema_table_store_record(thd, table))
     {
@@ -898,7 +898,8 @@ static void ndbcluster_reset_slave(THD *thd)
   ndb data to be logged has made it to the binary log to get a deterministic
   behavior on the rotation of the log.
  */
-static bool ndbcluster_flush_logs(handlerton *hton, ulonglong target_lsn)
+static bool ndbcluster_flush_logs(handlerton *hton, ulonglong target_lsn,
+                                  bool *durable)
 {
   if (target_lsn == 0)
     ndbcluster_binlog_wait(current_thd);
@@ -162,6 +162,9 @@ bool Partition_share::init(uint num_parts)
   auto_inc_initialized= false;
   partition_name_hash_initialized= false;
   next_auto_inc_val= 0;
+  partitions_opened_once= false;
+  partition_ref_length= 0;
+  partition_names= NULL;
   partitions_share_refs= new Parts_share_refs;
   if (!partitions_share_refs)
     DBUG_RETURN(true);
@@ -1491,6 +1494,9 @@ int ha_partition::handle_opt_partitions(THD *thd, HA_CHECK_OPT *check_opt,
   DBUG_ENTER("ha_partition::handle_opt_partitions");
   DBUG_PRINT("enter", ("flag= %u", flag));
 
+  if ((error= open_all_partitions()))
+    DBUG_RETURN(error);
+
   do
   {
     partition_element *part_elem= part_it++;
@@ -1583,6 +1589,8 @@ bool ha_partition::check_and_repair(THD *thd)
   handler **file= m_file;
   DBUG_ENTER("ha_partition::check_and_repair");
 
+  if (open_all_partitions())
+    DBUG_RETURN(TRUE);
   do
   {
     if ((*file)->ha_check_and_repair(thd))
@@ -1616,6 +1624,9 @@ bool ha_partition::auto_repair() const
 
   @retval TRUE  Crashed
   @retval FALSE Not crashed
+
+  @note A partition that cannot be opened is reported as crashed, so
+  that check_and_repair() is tried and reports the error.
 */
 
 bool ha_partition::is_crashed() const
@@ -1623,6 +1634,8 @@ bool ha_partition::is_crashed() const
   handler **file= m_file;
   DBUG_ENTER("ha_partition::is_crashed");
 
+  if (const_cast<ha_partition*>(this)->open_all_partitions())
+    DBUG_RETURN(TRUE);
   do
   {
     if ((*file)->is_crashed())
@@ -2296,6 +2309,10 @@ void ha_partition::update_create_info(HA_CREATE_INFO *create_info)
   }
   part_it.rewind();
 
+  /* The DATA DIRECTORY of a partition is only known once it is opened. */
+  if (m_handler_status == handler_opened && open_all_partitions())
+    DBUG_VOID_RETURN;
+
   for (i= 0; i < num_parts; i++)
   {
     part_elem= part_it++;
@@ -3309,6 +3326,7 @@ void ha_partition::free_partition_bitmaps()
   bitmap_free(&m_locked_partitions);
   bitmap_free(&m_partitions_to_reset);
   bitmap_free(&m_key_not_found_partitions);
+  bitmap_free(&m_opened_partitions);
 }
 
 
@@ -3357,6 +3375,17 @@ bool ha_partition::init_partition_bitmaps()
   }
   bitmap_clear_all(&m_key_not_found_partitions);
   m_key_not_found= false;
+
+  /* Initialize the bitmap we use to keep track of opened partitions */
+  if (bitmap_init(&m_opened_partitions, NULL, m_tot_parts, FALSE))
+  {
+    bitmap_free(&m_bulk_insert_started);
+    bitmap_free(&m_locked_partitions);
+    bitmap_free(&m_partitions_to_reset);
+    bitmap_free(&m_key_not_found_partitions);
+    DBUG_RETURN(true);
+  }
+  bitmap_clear_all(&m_opened_partitions);
   /* Initialize the bitmap for read/lock_partitions */
   if (!m_is_clone_of)
   {
@@ -3401,6 +3430,7 @@ int ha_partition::open(const char *name, int mode, uint test_if_locked)
   handler **file;
   char name_buff[FN_REFLEN];
   ulonglong check_table_flags;
+  bool open_lazily= FALSE;
   DBUG_ENTER("ha_partition::open");
 
   DBUG_ASSERT(table->s == table_share);
@@ -3424,9 +3454,18 @@ int ha_partition::open(const char *name, int mode, uint test_if_locked)
 
   DBUG_ASSERT(m_part_info);
 
+  if (!m_is_clone_of && opt_part_lazy_open &&
+      !(test_if_locked & HA_OPEN_FOR_REPAIR))
+  {
+    lock_shared_ha_data();
+    open_lazily= part_share->partitions_opened_once;
+    unlock_shared_ha_data();
+  }
+
   if (m_is_clone_of)
   {
     uint i, alloc_len;
+    Handler_share **ha_shares= part_share->partitions_share_refs->ha_shares;
     DBUG_ASSERT(m_clone_mem_root);
     /* Allocate an array of handler pointers for the partitions handlers. */
     alloc_len= (m_tot_parts + 1) * sizeof(handler*);
@@ -3438,38 +3477,60 @@ int ha_partition::open(const char *name, int mode, uint test_if_locked)
     memset(m_file, 0, alloc_len);
     /*
       Populate them by cloning the original partitions. This also opens them.
-      Note that file->ref is allocated too.
+      Note that file->ref is allocated too. Partitions not yet opened by the
+      original get a new handler, which is opened on first use.
     */
     file= m_is_clone_of->m_file;
     for (i= 0; i < m_tot_parts; i++)
     {
-      create_partition_name(name_buff, name, name_buffer_ptr, NORMAL_PART_NAME,
-                            FALSE);
-      /* ::clone() will also set ha_share from the original. */
-      if (!(m_file[i]= file[i]->clone(name_buff, m_clone_mem_root)))
+      if (!bitmap_is_set(&m_is_clone_of->m_opened_partitions, i))
       {
-        error= HA_ERR_INITIALIZATION;
-        file= &m_file[i];
-        goto err_handler;
+        if (!(m_file[i]= get_new_handler(table_share, m_clone_mem_root,
+                                         file[i]->ht)) ||
+            m_file[i]->set_ha_share_ref(&ha_shares[i]))
+        {
+          error= HA_ERR_INITIALIZATION;
+          goto err_handler;
+        }
+      }
+      else
+      {
+        create_partition_name(name_buff, name, name_buffer_ptr,
+                              NORMAL_PART_NAME, FALSE);
+        /* ::clone() will also set ha_share from the original. */
+        if (!(m_file[i]= file[i]->clone(name_buff, m_clone_mem_root)))
+        {
+          error= HA_ERR_INITIALIZATION;
+          goto err_handler;
+        }
+        bitmap_set_bit(&m_opened_partitions, i);
+        statistic_increment(open_partitions_count, &LOCK_status);
       }
       name_buffer_ptr+= strlen(name_buffer_ptr) + 1;
     }
   }
   else
   {
-   file= m_file;
-   do
-   {
+    /*
+      When another instance of the table has opened all partitions, only
+      the first one is opened here, to get the properties of the
+      underlying handlers. The others are opened on first use.
+    */
+    uint i, num_parts_to_open= open_lazily ? 1 : m_tot_parts;
+    for (i= 0; i < num_parts_to_open; i++)
+    {
       create_partition_name(name_buff, name, name_buffer_ptr, NORMAL_PART_NAME,
                             FALSE);
-      if ((error= (*file)->ha_open(table, name_buff, mode,
-                                   test_if_locked | HA_OPEN_NO_PSI_CALL)))
+      if ((error= m_file[i]->ha_open(table, name_buff, mode,
+                                     test_if_locked | HA_OPEN_NO_PSI_CALL)))
         goto err_handler;
-      if (m_file == file)
-        m_num_locks= (*file)->lock_count();
-      DBUG_ASSERT(m_num_locks == (*file)->lock_count());
+      bitmap_set_bit(&m_opened_partitions, i);
+      statistic_increment(open_partitions_count, &LOCK_status);
+      if (i == 0)
+        m_num_locks= m_file[i]->lock_count();
+      DBUG_ASSERT(m_num_locks == m_file[i]->lock_count());
       name_buffer_ptr+= strlen(name_buffer_ptr) + 1;
-    } while (*(++file));
+    }
   }
   
   file= m_file;
@@ -3479,6 +3540,8 @@ int ha_partition::open(const char *name, int mode, uint test_if_locked)
                       (PARTITION_ENABLED_TABLE_FLAGS));
   while (*(++file))
   {
+    if (!bitmap_is_set(&m_opened_partitions, (uint) (file - m_file)))
+      continue;
     /* MyISAM can have smaller ref_length for partitions with MAX_ROWS set */
     set_if_bigger(ref_length, ((*file)->ref_length));
     /*
@@ -3490,11 +3553,15 @@ int ha_partition::open(const char *name, int mode, uint test_if_locked)
                               (PARTITION_ENABLED_TABLE_FLAGS)))
     {
       error= HA_ERR_INITIALIZATION;
-      /* set file to last handler, so all of them are closed */
-      file = &m_file[m_tot_parts - 1];
       goto err_handler;
     }
   }
+  /* Also covers the partitions that are not opened yet. */
+  if (share_partition_open_info(m_name_buffer_ptr))
+  {
+    error= HA_ERR_OUT_OF_MEM;
+    goto err_handler;
+  }
   key_used_on_scan= m_file[0]->key_used_on_scan;
   implicit_emptied= m_file[0]->implicit_emptied;
   /*
@@ -3514,21 +3581,21 @@ int ha_partition::open(const char *name, int mode, uint test_if_locked)
     Some handlers update statistics as part of the open call. This will in
     some cases corrupt the statistics of the partition handler and thus
     to ensure we have correct statistics we call info from open after
-    calling open on all individual handlers.
+    calling open on all individual handlers. Partitions that are not
+    opened yet are not opened for this, see info().
   */
-  m_handler_status= handler_opened;
   if (m_part_info->part_expr)
     m_part_func_monotonicity_info=
                             m_part_info->part_expr->get_monotonicity_info();
   else if (m_part_info->list_of_part_fields)
     m_part_func_monotonicity_info= MONOTONIC_STRICT_INCREASING;
   info(HA_STATUS_VARIABLE | HA_STATUS_CONST);
+  m_handler_status= handler_opened;
   DBUG_RETURN(0);
 
 err_handler:
   DEBUG_SYNC(ha_thd(), "partition_open_error");
-  while (file-- != m_file)
-    (*file)->ha_close();
+  close_partitions();
 err_alloc:
   free_partition_bitmaps();
 
@@ -3536,6 +3603,178 @@ err_alloc:
 }
 
 
+/**
+  Make the partition handler properties that are needed to open the
+  partitions on first use available to all instances of the table.
+
+  @param name_buffer_ptr  Partition names read from the .par file
+
+  @return Operation status
+    @retval true   Failure (out of memory)
+    @retval false  Success
+
+  @note The first instance of the table that opens all partitions stores
+  the partition names and the largest ref_length of the partitions in the
+  Partition_share. Instances that have not opened all partitions take
+  ref_length from there, since an unopened partition may need a longer
+  ref than the opened ones (MyISAM with MAX_ROWS).
+*/
+
+bool ha_partition::share_partition_open_info(const char *name_buffer_ptr)
+{
+  bool error= false;
+  DBUG_ENTER("ha_partition::share_partition_open_info");
+
+  lock_shared_ha_data();
+  if (part_share->partitions_opened_once)
+    set_if_bigger(ref_length, part_share->partition_ref_length);
+  else
+  {
+    const char *name;
+    size_t names_length= 0;
+    uint i;
+    char *name_buffer;
+    /* Only the first instance of a table_share can be opened lazily. */
+    DBUG_ASSERT(bitmap_is_set_all(&m_opened_partitions));
+
+    for (i= 0, name= name_buffer_ptr; i < m_tot_parts; i++)
+    {
+      names_length+= strlen(name) + 1;
+      name+= strlen(name) + 1;
+    }
+    if (!(part_share->partition_names=
+            (const char**) my_malloc(m_tot_parts * sizeof(char*) +
+                                     names_length, MYF(MY_WME))))
+      error= true;
+    else
+    {
+      name_buffer= (char*) (part_share->partition_names + m_tot_parts);
+      memcpy(name_buffer, name_buffer_ptr, names_length);
+      for (i= 0; i < m_tot_parts; i++)
+      {
+        part_share->partition_names[i]= name_buffer;
+        name_buffer+= strlen(name_buffer) + 1;
+      }
+      part_share->partition_ref_length= ref_length;
+      part_share->partitions_opened_once= true;
+    }
+  }
+  unlock_shared_ha_data();
+  DBUG_RETURN(error);
+}
+
+
+/**
+  Open the handler of a partition that was left unopened by open().
+
+  @param part_id  Partition to open
+
+  @return Operation status
+    @retval 0     Success
+    @retval != 0  Error code
+*/
+
+int ha_partition::open_partition(uint part_id)
+{
+  int error;
+  handler *file= m_file[part_id];
+  char name_buff[FN_REFLEN];
+  DBUG_ENTER("ha_partition::open_partition");
+  DBUG_PRINT("info", ("opening partition %u", part_id));
+
+  DBUG_ASSERT(m_handler_status == handler_opened);
+  DBUG_ASSERT(!bitmap_is_set(&m_opened_partitions, part_id));
+  DBUG_ASSERT(part_share->partitions_opened_once);
+
+  create_partition_name(name_buff, table_share->normalized_path.str,
+                        part_share->partition_names[part_id],
+                        NORMAL_PART_NAME, FALSE);
+  /*
+    Allocate ref on the MEM_ROOT of the clone, as handler::clone() does.
+    The ref_length of the partition is not known before it is opened, so
+    use the largest one.
+  */
+  if (m_is_clone_of && !file->ref &&
+      !(file->ref= (uchar*) alloc_root(m_clone_mem_root,
+                                       ALIGN_SIZE(m_ref_length) * 2)))
+    DBUG_RETURN(HA_ERR_OUT_OF_MEM);
+  if ((error= file->ha_open(table, name_buff, m_mode,
+                            m_open_test_lock | HA_OPEN_NO_PSI_CALL)))
+    DBUG_RETURN(error);
+  if (file->ref_length + PARTITION_BYTES_IN_POS > m_ref_length ||
+      file->lock_count() != m_num_locks ||
+      ((file->ha_table_flags() & ~(PARTITION_DISABLED_TABLE_FLAGS)) |
+       (PARTITION_ENABLED_TABLE_FLAGS)) !=
+      ((m_file[0]->ha_table_flags() & ~(PARTITION_DISABLED_TABLE_FLAGS)) |
+       (PARTITION_ENABLED_TABLE_FLAGS)))
+  {
+    file->ha_close();
+    DBUG_RETURN(HA_ERR_INITIALIZATION);
+  }
+  bitmap_set_bit(&m_opened_partitions, part_id);
+  statistic_increment(open_partitions_count, &LOCK_status);
+  DBUG_RETURN(0);
+}
+
+
+/**
+  Open the partitions in a set that are not open yet.
+
+  @param parts  Partitions to open, NULL for all partitions
+
+  @return Operation status
+    @retval 0     Success
+    @retval != 0  Error code
+
+  @note With part_lazy_open, only the first partition is opened by open()
+  when another instance of the table has already opened all of them. The
+  rest are opened here on first use, normally for the partitions left in
+  lock_partitions after pruning, from store_lock() and external_lock().
+*/
+
+int ha_partition::open_partitions(const MY_BITMAP *parts)
+{
+  int error;
+  uint i;
+  DBUG_ENTER("ha_partition::open_partitions");
+
+  if (parts ? bitmap_is_subset(parts, &m_opened_partitions) :
+              bitmap_is_set_all(&m_opened_partitions))
+    DBUG_RETURN(0);
+
+  for (i= 0; i < m_tot_parts; i++)
+  {
+    if (bitmap_is_set(&m_opened_partitions, i) ||
+        (parts && !bitmap_is_set(parts, i)))
+      continue;
+    if ((error= open_partition(i)))
+      DBUG_RETURN(error);
+  }
+  DBUG_RETURN(0);
+}
+
+
+/**
+  Close the handlers of all opened partitions.
+*/
+
+void ha_partition::close_partitions()
+{
+  uint i;
+  DBUG_ENTER("ha_partition::close_partitions");
+
+  for (i= bitmap_get_first_set(&m_opened_partitions);
+       i < m_tot_parts;
+       i= bitmap_get_next_set(&m_opened_partitions, i))
+  {
+    m_file[i]->ha_close();
+    statistic_decrement(open_partitions_count, &LOCK_status);
+  }
+  bitmap_clear_all(&m_opened_partitions);
+  DBUG_VOID_RETURN;
+}
+
+
 /*
   Disabled since it is not possible to prune yet.
   without pruning, it need to rebind/unbind every partition in every
@@ -3648,27 +3887,22 @@ err:
 
 int ha_partition::close(void)
 {
-  bool first= TRUE;
   handler **file;
   DBUG_ENTER("ha_partition::close");
 
   DBUG_ASSERT(table->s == table_share);
   destroy_record_priority_queue();
-  free_partition_bitmaps();
   DBUG_ASSERT(m_part_info);
-  file= m_file;
-
-repeat:
-  do
-  {
-    (*file)->ha_close();
-  } while (*(++file));
+  close_partitions();
+  free_partition_bitmaps();
 
-  if (first && m_added_file && m_added_file[0])
+  if (m_added_file && m_added_file[0])
   {
     file= m_added_file;
-    first= FALSE;
-    goto repeat;
+    do
+    {
+      (*file)->ha_close();
+    } while (*(++file));
   }
 
   m_handler_status= handler_closed;
@@ -3727,7 +3961,12 @@ int ha_partition::external_lock(THD *thd, int lock_type)
   if (lock_type == F_UNLCK)
     used_partitions= &m_locked_partitions;
   else
+  {
     used_partitions= &(m_part_info->lock_partitions);
+    /* Normally done by store_lock(), which cannot report errors. */
+    if ((error= open_partitions(used_partitions)))
+      DBUG_RETURN(error);
+  }
 
   first_used_partition= bitmap_get_first_set(used_partitions);
 
@@ -3840,7 +4079,10 @@ THR_LOCK_DATA **ha_partition::store_lock(THD *thd,
   */
   if (thd != table->in_use)
   {
-    for (i= 0; i < m_tot_parts; i++)
+    /* Partitions that are not opened hold no locks. */
+    for (i= bitmap_get_first_set(&m_opened_partitions);
+         i < m_tot_parts;
+         i= bitmap_get_next_set(&m_opened_partitions, i))
       to= m_file[i]->store_lock(thd, to, lock_type);
   }
   else
@@ -3850,6 +4092,12 @@ THR_LOCK_DATA **ha_partition::store_lock(THD *thd,
          i= bitmap_get_next_set(&m_part_info->lock_partitions, i))
     {
       DBUG_PRINT("info", ("store lock %d iteration", i));
+      /*
+        This is the first use of the partitions left after pruning.
+        If the open fails, the error is reported by external_lock().
+      */
+      if (!bitmap_is_set(&m_opened_partitions, i) && open_partition(i))
+        continue;
       to= m_file[i]->store_lock(thd, to, lock_type);
     }
   }
@@ -4447,6 +4695,9 @@ int ha_partition::truncate()
   part_share->auto_inc_initialized= false;
   unlock_auto_increment();
 
+  if ((error= open_all_partitions()))
+    DBUG_RETURN(error);
+
   file= m_file;
   do
   {
@@ -6155,6 +6406,77 @@ int ha_partition::handle_unordered_scan_next_partition(uchar * buf)
     entries.
 */
 
+/*
+  Overlap the initial index reads of an ordered index scan.
+
+  SYNOPSIS
+    prefetch_ordered_index_scan()
+
+  DESCRIPTION
+    The first row of every used partition must be read before the first
+    row can be returned from an ordered scan, and handle_ordered_index_scan
+    does those reads one partition at a time. When the index pages are not
+    in memory this costs one synchronous read per tree level and
+    partition. Here the storage engines are asked to start reading the
+    pages the positioning calls will need for all partitions, so that the
+    reads are in flight concurrently. Each round descends one more level
+    of the index trees, until no partition reports pending reads.
+
+    The partition handlers share the transaction of the session, so the
+    reads are issued from this thread instead of from worker threads.
+*/
+
+void ha_partition::prefetch_ordered_index_scan()
+{
+  /* Enough rounds for the deepest index trees seen in practice. */
+  const uint max_rounds= 8;
+  bool pending= TRUE;
+  DBUG_ENTER("ha_partition::prefetch_ordered_index_scan");
+
+  for (uint round= 0; pending && round < max_rounds; round++)
+  {
+    pending= FALSE;
+    for (uint i= m_part_spec.start_part;
+         i <= m_part_spec.end_part;
+         i= bitmap_get_next_set(&m_part_info->read_partitions, i))
+    {
+      handler *file= m_file[i];
+
+      switch (m_index_scan_type) {
+      case partition_index_read:
+        pending|= file->index_read_prefetch(m_start_key.key,
+                                            m_start_key.keypart_map,
+                                            m_start_key.flag);
+        break;
+      case partition_index_first:
+        pending|= file->index_read_prefetch(NULL, 0, HA_READ_AFTER_KEY);
+        break;
+      case partition_index_last:
+        pending|= file->index_read_prefetch(NULL, 0, HA_READ_BEFORE_KEY);
+        break;
+      case partition_index_read_last:
+        pending|= file->index_read_prefetch(m_start_key.key,
+                                            m_start_key.keypart_map,
+                                            HA_READ_PREFIX_LAST);
+        break;
+      case partition_read_range:
+        if (m_start_key.key)
+          pending|= file->index_read_prefetch(m_start_key.key,
+                                              m_start_key.keypart_map,
+                                              m_start_key.flag);
+        else
+          pending|= file->index_read_prefetch(NULL, 0, HA_READ_AFTER_KEY);
+        break;
+      default:
+        DBUG_ASSERT(FALSE);
+        DBUG_VOID_RETURN;
+      }
+    }
+  }
+  DBUG_VOID_RETURN;
+}
+
+
 int ha_partition::handle_ordered_index_scan(uchar *buf, bool reverse_order)
 {
   uint i;
@@ -6188,6 +6510,9 @@ int ha_partition::handle_ordered_index_scan(uchar *buf, bool reverse_order)
   }
   DBUG_PRINT("info", ("m_part_spec.start_part %u first_used_part %u",
                       m_part_spec.start_part, i));
+  if (ha_thd()->variables.part_ordered_scan_prefetch &&
+      m_part_spec.start_part != m_part_spec.end_part)
+    prefetch_ordered_index_scan();
   for (/* continue from above */ ;
        i <= m_part_spec.end_part;
        i= bitmap_get_next_set(&m_part_info->read_partitions, i))
@@ -6650,6 +6975,12 @@ int ha_partition::info(uint flag)
         */
         handler *file, **file_array;
         ulonglong auto_increment_value= 0;
+        int error;
+        if ((error= open_all_partitions()))
+        {
+          unlock_auto_increment();
+          DBUG_RETURN(error);
+        }
         file_array= m_file;
         DBUG_PRINT("info",
                    ("checking all partitions for auto_increment_value"));
@@ -6705,6 +7036,20 @@ int ha_partition::info(uint flag)
   {
     uint i;
     DBUG_PRINT("info", ("HA_STATUS_VARIABLE"));
+    /*
+      The statistics from the partitions that are not opened yet are only
+      left out when called from open().
+    */
+    if (m_handler_status == handler_opened)
+    {
+      int error;
+      if ((error= open_partitions(&m_part_info->read_partitions)))
+      {
+        if (stats_on_metadata && m_innodb)
+          current_thd->variables.innodb_stats_on_metadata= true;
+        DBUG_RETURN(error);
+      }
+    }
     /*
       Calculates statistical variables
       records:           Estimate of number records in table
@@ -6735,6 +7080,8 @@ int ha_partition::info(uint flag)
          i < m_tot_parts;
          i= bitmap_get_next_set(&m_part_info->read_partitions, i))
     {
+      if (!bitmap_is_set(&m_opened_partitions, i))
+        continue;
       file= m_file[i];
       file->info(HA_STATUS_VARIABLE | no_lock_flag | extra_var_flag);
       stats.records+= file->stats.records;
@@ -6813,15 +7160,19 @@ int ha_partition::info(uint flag)
     do
     {
       file= *file_array;
-      /* Get variables if not already done */
-      if (!(flag & HA_STATUS_VARIABLE) ||
-          !bitmap_is_set(&(m_part_info->read_partitions),
-                         (file_array - m_file)))
-        file->info(HA_STATUS_VARIABLE | no_lock_flag | extra_var_flag);
-      if (file->stats.records > max_records)
+      /* Partitions that are not opened yet are not used for estimates. */
+      if (bitmap_is_set(&m_opened_partitions, i))
       {
-        max_records= file->stats.records;
-        handler_instance= i;
+        /* Get variables if not already done */
+        if (!(flag & HA_STATUS_VARIABLE) ||
+            !bitmap_is_set(&(m_part_info->read_partitions),
+                           (file_array - m_file)))
+          file->info(HA_STATUS_VARIABLE | no_lock_flag | extra_var_flag);
+        if (file->stats.records > max_records)
+        {
+          max_records= file->stats.records;
+          handler_instance= i;
+        }
       }
       i++;
     } while (*(++file_array));
@@ -6865,6 +7216,8 @@ int ha_partition::info(uint flag)
     do
     {
       file= *file_array;
+      if (!bitmap_is_set(&m_opened_partitions, (uint) (file_array - m_file)))
+        continue;
       file->info(HA_STATUS_TIME | no_lock_flag);
       if (file->stats.update_time > stats.update_time)
 	stats.update_time= file->stats.update_time;
@@ -6879,6 +7232,11 @@ void ha_partition::get_dynamic_partition_info(PARTITION_STATS *stat_info,
 {
   handler *file= m_file[part_id];
   DBUG_ASSERT(bitmap_is_set(&(m_part_info->read_partitions), part_id));
+  if (!bitmap_is_set(&m_opened_partitions, part_id) && open_partition(part_id))
+  {
+    memset(stat_info, 0, sizeof(*stat_info));
+    return;
+  }
   file->info(HA_STATUS_TIME | HA_STATUS_VARIABLE |
              HA_STATUS_VARIABLE_EXTRA | HA_STATUS_NO_LOCK);
 
@@ -7532,11 +7890,17 @@ int ha_partition::loop_extra(enum ha_extra_function operation)
        i < m_tot_parts;
        i= bitmap_get_next_set(&m_part_info->lock_partitions, i))
   {
+    /*
+      Partitions that are not opened yet have no state to change. This
+      only happens when called before the table is locked.
+    */
+    if (!bitmap_is_set(&m_opened_partitions, i))
+      continue;
     if ((tmp= m_file[i]->extra(operation)))
       result= tmp;
+    /* Add all used partitions to be called in reset(). */
+    bitmap_set_bit(&m_partitions_to_reset, i);
   }
-  /* Add all used partitions to be called in reset(). */
-  bitmap_union(&m_partitions_to_reset, &m_part_info->lock_partitions);
   DBUG_RETURN(result);
 }
 
@@ -7863,7 +8227,9 @@ bool ha_partition::can_switch_engines()
 {
   handler **file;
   DBUG_ENTER("ha_partition::can_switch_engines");
- 
+
+  if (open_all_partitions())
+    DBUG_RETURN(FALSE);
   file= m_file;
   do
   {
@@ -8010,6 +8376,9 @@ const char *ha_partition::index_type(uint inx)
     DBUG_ASSERT(0);                             // How can this happen?
     DBUG_RETURN(handler::index_type(inx));
   }
+  /* All partitions have the same index types, the first one is open. */
+  if (!bitmap_is_set(&m_opened_partitions, first_used_partition))
+    first_used_partition= 0;
 
   DBUG_RETURN(m_file[first_used_partition]->index_type(inx));
 }
@@ -8025,6 +8394,9 @@ enum row_type ha_partition::get_row_type() const
   DBUG_ASSERT(i < m_tot_parts);
   if (i >= m_tot_parts)
     DBUG_RETURN(ROW_TYPE_NOT_USED);
+  /* Only the partitions that are opened are checked. */
+  if (!bitmap_is_set(&m_opened_partitions, i))
+    i= 0;
 
   type= m_file[i]->get_row_type();
   DBUG_PRINT("info", ("partition %u, row_type: %d", i, type));
@@ -8033,6 +8405,8 @@ enum row_type ha_partition::get_row_type() const
        i < m_tot_parts;
        i= bitmap_get_next_set(&m_part_info->lock_partitions, i))
   {
+    if (!bitmap_is_set(&m_opened_partitions, i))
+      continue;
     enum row_type part_type= m_file[i]->get_row_type();
     DBUG_PRINT("info", ("partition %u, row_type: %d", i, type));
     if (part_type != type)
@@ -8240,6 +8614,8 @@ bool ha_partition::check_if_incompatible_data(HA_CREATE_INFO *create_info,
     in mysql_alter_table (by fix_partition_func), so it is only up to
     the underlying handlers.
   */
+  if (open_all_partitions())
+    return COMPATIBLE_DATA_NO;
   for (file= m_file; *file; file++)
     if ((ret=  (*file)->check_if_incompatible_data(create_info,
                                                    table_changes)) !=
@@ -8287,6 +8663,7 @@ ha_partition::check_if_supported_inplace_alter(TABLE *altered_table,
                                                Alter_inplace_info *ha_alter_info)
 {
   uint index= 0;
+  int error;
   enum_alter_inplace_result result= HA_ALTER_INPLACE_NO_LOCK;
   ha_partition_inplace_ctx *part_inplace_ctx;
   bool first_is_set= false;
@@ -8321,6 +8698,16 @@ ha_partition::check_if_supported_inplace_alter(TABLE *altered_table,
     }
   }
 
+  /*
+    All the partitions are altered, keep them open until the end of the
+    in-place alter.
+  */
+  if ((error= open_all_partitions()))
+  {
+    print_error(error, MYF(0));
+    DBUG_RETURN(HA_ALTER_ERROR);
+  }
+
   part_inplace_ctx=
     new (thd->mem_root) ha_partition_inplace_ctx(thd, m_tot_parts);
   if (!part_inplace_ctx)
@@ -8387,6 +8774,7 @@ bool ha_partition::prepare_inplace_alter_table(TABLE *altered_table,
   if (ha_alter_info->alter_info->flags == Alter_info::ALTER_PARTITION)
     DBUG_RETURN(false);
 
+  DBUG_ASSERT(bitmap_is_set_all(&m_opened_partitions));
   part_inplace_ctx=
     static_cast<class ha_partition_inplace_ctx*>(ha_alter_info->handler_ctx);
 
@@ -8421,6 +8809,7 @@ bool ha_partition::inplace_alter_table(TABLE *altered_table,
   if (ha_alter_info->alter_info->flags == Alter_info::ALTER_PARTITION)
     DBUG_RETURN(false);
 
+  DBUG_ASSERT(bitmap_is_set_all(&m_opened_partitions));
   part_inplace_ctx=
     static_cast<class ha_partition_inplace_ctx*>(ha_alter_info->handler_ctx);
 
@@ -8461,6 +8850,7 @@ bool ha_partition::commit_inplace_alter_table(TABLE *altered_table,
   if (ha_alter_info->alter_info->flags == Alter_info::ALTER_PARTITION)
     DBUG_RETURN(false);
 
+  DBUG_ASSERT(bitmap_is_set_all(&m_opened_partitions));
   part_inplace_ctx=
     static_cast<class ha_partition_inplace_ctx*>(ha_alter_info->handler_ctx);
 
@@ -8519,8 +8909,10 @@ void ha_partition::notify_table_changed()
 
   DBUG_ENTER("ha_partition::notify_table_changed");
 
+  /* Partitions that are not open have nothing cached about the table */
   for (file= m_file; *file; file++)
-    (*file)->ha_notify_table_changed();
+    if (bitmap_is_set(&m_opened_partitions, (uint) (file - m_file)))
+      (*file)->ha_notify_table_changed();
 
   DBUG_VOID_RETURN;
 }
@@ -8686,6 +9078,8 @@ int ha_partition::reset_auto_increment(ulonglong value)
   handler **file= m_file;
   int res;
   DBUG_ENTER("ha_partition::reset_auto_increment");
+  if ((res= open_all_partitions()))
+    DBUG_RETURN(res);
   lock_auto_increment();
   part_share->auto_inc_initialized= false;
   part_share->next_auto_inc_val= 0;
@@ -8730,6 +9124,11 @@ void ha_partition::get_auto_increment(ulonglong offset, ulonglong increment,
     ulonglong first_value_part, max_first_value;
     handler **file= m_file;
     first_value_part= max_first_value= *first_value;
+    if (open_all_partitions())
+    {
+      *first_value= ULONGLONG_MAX;
+      DBUG_VOID_RETURN;
+    }
     /* Must lock and find highest value among all partitions. */
     lock_auto_increment();
     do
@@ -8869,6 +9268,8 @@ uint ha_partition::checksum() const
   if ((table_flags() & HA_HAS_CHECKSUM))
   {
     handler **file= m_file;
+    if (const_cast<ha_partition*>(this)->open_all_partitions())
+      DBUG_RETURN(0);
     do
     {
       sum+= (*file)->checksum();
@@ -93,6 +93,16 @@ public:
   HASH partition_name_hash;
   /** Storage for each partitions Handler_share */
   Parts_share_refs *partitions_share_refs;
+  /**
+    Set by the first ha_partition::open() for the table_share that opens
+    all partitions. After that the members below are read-only, and other
+    instances of the table may open their partitions on first use.
+  */
+  bool partitions_opened_once;
+  /** Largest ref_length of the partition handlers. */
+  uint partition_ref_length;
+  /** Name of each partition (as in the .par file), by partition id. */
+  const char **partition_names;
   Partition_share() {}
   ~Partition_share()
   {
@@ -102,6 +112,7 @@ public:
       my_hash_free(&partition_name_hash);
     if (partitions_share_refs)
       delete partitions_share_refs;
+    my_free(partition_names);
     DBUG_VOID_RETURN;
   }
   bool init(uint num_parts);
@@ -260,6 +271,8 @@ private:
                                        const uint32 *b);
   /** keep track of partitions to call ha_reset */
   MY_BITMAP m_partitions_to_reset;
+  /** partitions whose handler is open, see open_partitions() */
+  MY_BITMAP m_opened_partitions;
   /** partitions that returned HA_ERR_KEY_NOT_FOUND. */
   MY_BITMAP m_key_not_found_partitions;
   bool m_key_not_found;
@@ -388,6 +401,11 @@ private:
   void fix_data_dir(char* path);
   bool init_partition_bitmaps();
   void free_partition_bitmaps();
+  int open_partition(uint part_id);
+  int open_partitions(const MY_BITMAP *parts);
+  int open_all_partitions() { return open_partitions(NULL); }
+  void close_partitions();
+  bool share_partition_open_info(const char *name_buffer_ptr);
 
 public:
 
@@ -631,6 +649,7 @@ private:
   int partition_scan_set_up(uchar * buf, bool idx_read_flag);
   int handle_unordered_next(uchar * buf, bool next_same);
   int handle_unordered_scan_next_partition(uchar * buf);
+  void prefetch_ordered_index_scan();
   int handle_ordered_index_scan(uchar * buf, bool reverse_order);
   int handle_ordered_index_scan_key_not_found();
   int handle_ordered_next(uchar * buf, bool next_same);
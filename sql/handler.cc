@@ -2537,19 +2537,26 @@ int ha_start_shared_snapshot(THD *thd,
   return ss_ctx.error;
 }
 
+struct st_flush_logs_args
+{
+  engine_lsn_map *engine_map;
+  bool *durable;
+};
+
 static my_bool flush_handlerton(THD *thd, plugin_ref plugin,
                                 void *arg)
 {
   handlerton *hton= plugin_data(plugin, handlerton *);
+  st_flush_logs_args *args= (st_flush_logs_args *) arg;
   ulonglong target_lsn= 0;
 
-  if (arg)
+  if (args->engine_map)
   {
     /*
-      If arg is not NULL, this means we have specified engine
+      If engine_map is not NULL, this means we have specified engine
       types to do log flushing.
     */
-    engine_lsn_map* engine_map= (engine_lsn_map *)arg;
+    engine_lsn_map* engine_map= args->engine_map;
 
     /* Shoudn't be empty.*/
     DBUG_ASSERT(!engine_map->is_empty());
@@ -2561,24 +2568,39 @@ static my_bool flush_handlerton(THD *thd, plugin_ref plugin,
   }
 
   if (hton->state == SHOW_OPTION_YES && hton->flush_logs &&
-      hton->flush_logs(hton, target_lsn))
+      hton->flush_logs(hton, target_lsn, args->durable))
     return TRUE;
   return FALSE;
 }
 
 
-bool ha_flush_logs(handlerton *db_type, engine_lsn_map *engine_map)
+/**
+  Flush the logs of the storage engines.
+
+  @param db_type     engine to flush, or NULL for all the engines
+  @param engine_map  with db_type NULL, the engines to flush and the log
+                     positions to flush them to, or NULL to sync the logs
+                     of all the engines
+  @param[out] durable set to false if the log of an engine was not synced,
+                     left unchanged otherwise. May be NULL.
+
+  @retval TRUE  error
+  @retval FALSE success
+*/
+bool ha_flush_logs(handlerton *db_type, engine_lsn_map *engine_map,
+                   bool *durable)
 {
   if (db_type == NULL)
   {
+    st_flush_logs_args args= { engine_map, durable };
     if (plugin_foreach(NULL, flush_handlerton,
-                          MYSQL_STORAGE_ENGINE_PLUGIN, (void *)(engine_map)))
+                          MYSQL_STORAGE_ENGINE_PLUGIN, &args))
       return TRUE;
   }
   else
   {
     if (db_type->state != SHOW_OPTION_YES ||
-        (db_type->flush_logs && db_type->flush_logs(db_type, 0)))
+        (db_type->flush_logs && db_type->flush_logs(db_type, 0, durable)))
       return TRUE;
   }
   return FALSE;
@@ -7498,22 +7520,24 @@ void update_shared_table_stats(
     SHARED_TABLE_STATS *table_stats,
     ha_statistics *stats)
 {
+  shared_table_stats_counters &counters= table_stats->counters.local();
+
   /* Queries statistics */
-  table_stats->queries_used.inc();
+  counters.queries_used.inc();
 
   if (thd != NULL && thd->lex != NULL &&
       thd->lex->sql_command == SQLCOM_SELECT &&
       thd->get_sent_row_count() == 0)
   {
-    table_stats->queries_empty.inc();
+    counters.queries_empty.inc();
   }
 
   /* Rows statistics */
-  table_stats->rows_inserted.inc(stats->rows_inserted);
-  table_stats->rows_updated.inc(stats->rows_updated);
-  table_stats->rows_deleted.inc(stats->rows_deleted);
-  table_stats->rows_read.inc(stats->rows_read);
-  table_stats->rows_requested.inc(stats->rows_requested);
+  counters.rows_inserted.inc(stats->rows_inserted);
+  counters.rows_updated.inc(stats->rows_updated);
+  counters.rows_deleted.inc(stats->rows_deleted);
+  counters.rows_read.inc(stats->rows_read);
+  counters.rows_requested.inc(stats->rows_requested);
 }
 
 /*
@@ -7524,7 +7548,9 @@ void update_shared_table_stats(
 
   NOTES
     Should be called at the end of a statement.
-    TODO(mcallaghan): support more concurrency on update, shard the hash table
+    The TABLE_STATS object is cached in the handler and in the TABLE_SHARE,
+    so the hash table is only searched the first time a table is used.
+    See TABLE_SHARE::table_stats for why the cached pointers stay valid.
 */
 void handler::update_global_table_stats(THD *thd)
 {
@@ -7532,7 +7558,31 @@ void handler::update_global_table_stats(THD *thd)
     return;
 
   if (!table_stats)
-    table_stats = get_table_stats(table, ht);
+  {
+    /*
+      Partitions of a partitioned table share the TABLE_SHARE but are
+      counted for their own engine, only cache the engine of the share.
+    */
+    TABLE_SHARE *share= table->s;
+    bool use_share= share->db_type() == ht;
+
+    if (use_share)
+      table_stats= (TABLE_STATS*)
+        my_atomic_loadptr((void * volatile *) &share->table_stats);
+
+    /* Index names are cleared by a statistics reset, look up to reset them */
+    if (table_stats && table_stats->num_indexes !=
+                       std::min(share->keys, (uint) MAX_INDEX_STATS))
+      table_stats= NULL;
+
+    if (!table_stats)
+    {
+      table_stats= get_table_stats(table, ht);
+      if (use_share && table_stats)
+        my_atomic_storeptr((void * volatile *) &share->table_stats,
+                           table_stats);
+    }
+  }
 
   if (table_stats)
   {
@@ -7564,13 +7614,14 @@ void handler::update_global_table_stats(THD *thd)
     }
 
     /* update the remaining table statistics, specific to TABLE_STATISTICS */
-    table_stats->index_inserts.inc(stats.index_inserts);
-    table_stats->rows_index_first.inc(stats.rows_index_first);
-    table_stats->rows_index_next.inc(stats.rows_index_next);
+    table_stats_counters &counters= table_stats->counters.local();
+    counters.index_inserts.inc(stats.index_inserts);
+    counters.rows_index_first.inc(stats.rows_index_first);
+    counters.rows_index_next.inc(stats.rows_index_next);
 
     if (thd && thd->open_tables)
     {
-      table_stats->comment_bytes.inc(table->count_comment_bytes);
+      counters.comment_bytes.inc(table->count_comment_bytes);
       table->count_comment_bytes = 0;
     }
 
@@ -8030,6 +8081,78 @@ int handler::ha_write_row(uchar *buf)
 }
 
 
+/**
+  Write a batch of rows, see write_rows().
+
+  Auto-increment values are not generated for the rows of a batch, so
+  the table must not have an auto-increment column.
+
+  When the table is instrumented, the rows are passed to write_rows() one
+  at a time, so that each row is recorded as a table io wait as with
+  ha_write_row().
+*/
+
+int handler::ha_write_rows(uchar **rows, uint n_rows, uint *n_written)
+{
+  int error= 0;
+  uint n;
+  Log_func *log_func= Write_rows_log_event::binlog_row_logging_function;
+  DBUG_ASSERT(table_share->tmp_table != NO_TMP_TABLE ||
+              m_lock_type == F_WRLCK);
+  DBUG_ASSERT(!table->next_number_field);
+
+  DBUG_ENTER("handler::ha_write_rows");
+  DBUG_EXECUTE_IF("inject_error_ha_write_row",
+                  *n_written= 0;
+                  DBUG_RETURN(HA_ERR_INTERNAL_ERROR); );
+
+  MYSQL_INSERT_ROW_START(table_share->db.str, table_share->table_name.str);
+  mark_trx_read_write();
+
+  *n_written= 0;
+  while (!error && *n_written < n_rows)
+  {
+    n= 0;
+    MYSQL_TABLE_IO_WAIT(m_psi, PSI_TABLE_WRITE_ROW, MAX_KEY, 0,
+      { error= write_rows(rows + *n_written,
+                          m_psi ? 1 : n_rows - *n_written, &n); })
+    *n_written+= n;
+  }
+
+  MYSQL_INSERT_ROW_DONE(error);
+
+  for (uint i= 0; i < *n_written; i++)
+  {
+    int log_error;
+    if (unlikely(log_error= binlog_log_row(table, 0, rows[i], log_func)))
+    {
+      *n_written= i;
+      DBUG_RETURN(log_error); /* purecov: inspected */
+    }
+  }
+
+  DEBUG_SYNC_C("ha_write_row_end");
+  DBUG_RETURN(error);
+}
+
+
+int handler::write_rows(uchar **rows, uint n_rows, uint *n_written)
+{
+  int error= 0;
+  uint i;
+
+  for (i= 0; i < n_rows; i++)
+  {
+    if (rows[i] != table->record[0])
+      memcpy(table->record[0], rows[i], table->s->reclength);
+    if ((error= write_row(table->record[0])))
+      break;
+  }
+  *n_written= i;
+  return error;
+}
+
+
 int handler::ha_update_row(const uchar *old_data, uchar *new_data)
 {
   int error;
@@ -959,7 +959,13 @@ struct handlerton
                                     snapshot_info_st *ss_info);
    int (*start_shared_snapshot)(handlerton *hton, THD *thd,
                                     snapshot_info_st *ss_info);
-   bool (*flush_logs)(handlerton *hton, unsigned long long target_lsn);
+   /*
+     Write the log up to target_lsn, or sync the whole log when target_lsn
+     is 0. *durable is set to false when the log was written but not
+     synced, it may be NULL.
+   */
+   bool (*flush_logs)(handlerton *hton, unsigned long long target_lsn,
+                      bool *durable);
    bool (*show_status)(handlerton *hton, THD *thd, stat_print_fn *print, enum ha_stat_type stat);
    uint (*partition_flags)();
    uint (*alter_table_flags)(uint flags);
@@ -2259,6 +2265,7 @@ public:
   */
   int ha_external_lock(THD *thd, int lock_type);
   int ha_write_row(uchar * buf);
+  int ha_write_rows(uchar **rows, uint n_rows, uint *n_written);
   int ha_update_row(const uchar * old_data, uchar * new_data);
   int ha_delete_row(const uchar * buf);
   int write_locked_table_maps(THD *thd);
@@ -2549,6 +2556,27 @@ public:
                                bool eq_range, bool sorted);
   virtual int read_range_next();
 
+  /**
+    Start asynchronous reads of the index pages that a subsequent
+    index_read_map(), index_first() or index_last() call with the same
+    arguments will need, without waiting for them. Used by ha_partition
+    to overlap the initial reads of an ordered index scan over many
+    partitions.
+
+    @param key          Key to position on, or NULL to position on the
+                        first (HA_READ_AFTER_KEY) or the last
+                        (HA_READ_BEFORE_KEY) entry of the index
+    @param keypart_map  Which key parts are used in key
+    @param find_flag    Search mode, as for index_read_map()
+
+    @retval true   Reads were issued and are still pending; calling
+                   again later makes further progress
+    @retval false  Nothing more to prefetch (the default)
+  */
+  virtual bool index_read_prefetch(const uchar *key, key_part_map keypart_map,
+                                   enum ha_rkey_function find_flag)
+  { return false; }
+
   /**
     Set the end position for a range scan. This is used for checking
     for when to end the range scan and by the ICP code to determine
@@ -3340,6 +3368,25 @@ protected:
     tables.
   */
   virtual int delete_table(const char *name);
+  /**
+    Write a batch of rows in order, as write_row() would write each of
+    them, and stop at the first row that cannot be written.
+
+    The default implementation copies each row to table->record[0] and
+    calls write_row(). Engines can override it to share work between
+    the rows of the batch, and call it for the rows themselves. When the
+    table is instrumented by the performance schema, ha_write_rows()
+    passes a batch one row per call.
+
+    @param rows            Rows in the format of table->record[0].
+    @param n_rows          Number of rows.
+    @param[out] n_written  Number of rows written. If an error is
+                           returned, rows[*n_written] is the row that
+                           failed.
+
+    @return 0 or the error of the row that failed.
+  */
+  virtual int write_rows(uchar **rows, uint n_rows, uint *n_written);
 private:
   /* Private helpers */
   inline void mark_trx_read_write();
@@ -3729,7 +3776,8 @@ TYPELIB* ha_known_exts();
 int ha_panic(enum ha_panic_function flag);
 void ha_close_connection(THD* thd);
 void ha_kill_connection(THD *thd);
-bool ha_flush_logs(handlerton *db_type, engine_lsn_map *engine_map= NULL);
+bool ha_flush_logs(handlerton *db_type, engine_lsn_map *engine_map= NULL,
+                   bool *durable= NULL);
 void ha_drop_database(char* path);
 int ha_create_table(THD *thd, const char *path,
                     const char *db, const char *table_name,
@@ -32,6 +32,7 @@
 #include "sp_head.h"
 #include "sp.h"
 #include "item_inetfunc.h"
+#include "item_sum_percentile.h"
 #include "sql_time.h"
 
 /*
@@ -371,6 +372,19 @@ protected:
 };
 
 
+class Create_func_approx_percentile : public Create_func_arg2
+{
+public:
+  virtual Item *create(THD *thd, Item *arg1, Item *arg2);
+
+  static Create_func_approx_percentile s_singleton;
+
+protected:
+  Create_func_approx_percentile() {}
+  virtual ~Create_func_approx_percentile() {}
+};
+
+
 #ifdef HAVE_SPATIAL
 class Create_func_area : public Create_func_arg1
 {
@@ -1289,6 +1303,45 @@ protected:
 };
 
 
+class Create_func_hll_cardinality : public Create_func_arg1
+{
+public:
+  virtual Item *create(THD *thd, Item *arg1);
+
+  static Create_func_hll_cardinality s_singleton;
+
+protected:
+  Create_func_hll_cardinality() {}
+  virtual ~Create_func_hll_cardinality() {}
+};
+
+
+class Create_func_hll_merge : public Create_func_arg1
+{
+public:
+  virtual Item *create(THD *thd, Item *arg1);
+
+  static Create_func_hll_merge s_singleton;
+
+protected:
+  Create_func_hll_merge() {}
+  virtual ~Create_func_hll_merge() {}
+};
+
+
+class Create_func_hll_sketch : public Create_func_arg1
+{
+public:
+  virtual Item *create(THD *thd, Item *arg1);
+
+  static Create_func_hll_sketch s_singleton;
+
+protected:
+  Create_func_hll_sketch() {}
+  virtual ~Create_func_hll_sketch() {}
+};
+
+
 class Create_func_ifnull : public Create_func_arg2
 {
 public:
@@ -2022,6 +2075,45 @@ protected:
 #endif
 
 
+class Create_func_percentile_merge : public Create_func_arg1
+{
+public:
+  virtual Item *create(THD *thd, Item *arg1);
+
+  static Create_func_percentile_merge s_singleton;
+
+protected:
+  Create_func_percentile_merge() {}
+  virtual ~Create_func_percentile_merge() {}
+};
+
+
+class Create_func_percentile_sketch : public Create_func_arg1
+{
+public:
+  virtual Item *create(THD *thd, Item *arg1);
+
+  static Create_func_percentile_sketch s_singleton;
+
+protected:
+  Create_func_percentile_sketch() {}
+  virtual ~Create_func_percentile_sketch() {}
+};
+
+
+class Create_func_percentile_value : public Create_func_arg2
+{
+public:
+  virtual Item *create(THD *thd, Item *arg1, Item *arg2);
+
+  static Create_func_percentile_value s_singleton;
+
+protected:
+  Create_func_percentile_value() {}
+  virtual ~Create_func_percentile_value() {}
+};
+
+
 class Create_func_period_add : public Create_func_arg2
 {
 public:
@@ -2614,6 +2706,18 @@ protected:
 };
 
 
+class Create_func_wait_for_commit_ticket : public Create_native_func
+{
+public:
+  virtual Item *create_native(THD *thd, LEX_STRING name, List<Item> *item_list);
+
+  static Create_func_wait_for_commit_ticket s_singleton;
+
+protected:
+  Create_func_wait_for_commit_ticket() {}
+  virtual ~Create_func_wait_for_commit_ticket() {}
+};
+
 class Create_func_weekday : public Create_func_arg1
 {
 public:
@@ -3118,6 +3222,15 @@ Create_func_aes_decrypt Create_func_aes_decrypt::s_singleton;
 Create_func_random_bytes Create_func_random_bytes::s_singleton;
 
 
+Create_func_approx_percentile Create_func_approx_percentile::s_singleton;
+
+Item*
+Create_func_approx_percentile::create(THD *thd, Item *arg1, Item *arg2)
+{
+  return new (thd->mem_root) Item_sum_approx_percentile(arg1, arg2);
+}
+
+
 #ifdef HAVE_SPATIAL
 Create_func_area Create_func_area::s_singleton;
 
@@ -4092,6 +4205,33 @@ Create_func_hex::create(THD *thd, Item *arg1)
 }
 
 
+Create_func_hll_cardinality Create_func_hll_cardinality::s_singleton;
+
+Item*
+Create_func_hll_cardinality::create(THD *thd, Item *arg1)
+{
+  return new (thd->mem_root) Item_func_hll_cardinality(arg1);
+}
+
+
+Create_func_hll_merge Create_func_hll_merge::s_singleton;
+
+Item*
+Create_func_hll_merge::create(THD *thd, Item *arg1)
+{
+  return new (thd->mem_root) Item_sum_hll_merge(arg1);
+}
+
+
+Create_func_hll_sketch Create_func_hll_sketch::s_singleton;
+
+Item*
+Create_func_hll_sketch::create(THD *thd, Item *arg1)
+{
+  return new (thd->mem_root) Item_sum_hll_sketch(arg1);
+}
+
+
 Create_func_ifnull Create_func_ifnull::s_singleton;
 
 Item*
@@ -4804,6 +4944,33 @@ Create_func_overlaps::create(THD *thd, Item *arg1, Item *arg2)
 #endif
 
 
+Create_func_percentile_merge Create_func_percentile_merge::s_singleton;
+
+Item*
+Create_func_percentile_merge::create(THD *thd, Item *arg1)
+{
+  return new (thd->mem_root) Item_sum_percentile_merge(arg1);
+}
+
+
+Create_func_percentile_sketch Create_func_percentile_sketch::s_singleton;
+
+Item*
+Create_func_percentile_sketch::create(THD *thd, Item *arg1)
+{
+  return new (thd->mem_root) Item_sum_percentile_sketch(arg1);
+}
+
+
+Create_func_percentile_value Create_func_percentile_value::s_singleton;
+
+Item*
+Create_func_percentile_value::create(THD *thd, Item *arg1, Item *arg2)
+{
+  return new (thd->mem_root) Item_func_percentile_value(arg1, arg2);
+}
+
+
 Create_func_period_add Create_func_period_add::s_singleton;
 
 Item*
@@ -5332,6 +5499,43 @@ Create_func_version::create(THD *thd)
 }
 
 
+Create_func_wait_for_commit_ticket
+  Create_func_wait_for_commit_ticket::s_singleton;
+
+Item*
+Create_func_wait_for_commit_ticket::create_native(THD *thd, LEX_STRING name,
+                                                  List<Item> *item_list)
+{
+  Item *func= NULL;
+  int arg_count= 0;
+
+  thd->lex->set_stmt_unsafe(LEX::BINLOG_STMT_UNSAFE_SYSTEM_FUNCTION);
+
+  if (item_list != NULL)
+    arg_count= item_list->elements;
+
+  switch (arg_count) {
+  case 0:
+    func= new (thd->mem_root) Item_func_wait_for_commit_ticket();
+    thd->lex->safe_to_cache_query= 0;
+    break;
+  case 1:
+  {
+    Item *param_1= item_list->pop();
+    func= new (thd->mem_root) Item_func_wait_for_commit_ticket(param_1);
+    thd->lex->safe_to_cache_query= 0;
+    break;
+  }
+  default:
+  {
+    my_error(ER_WRONG_PARAMCOUNT_TO_NATIVE_FCT, MYF(0), name.str);
+    break;
+  }
+  }
+
+  return func;
+}
+
 Create_func_weekday Create_func_weekday::s_singleton;
 
 Item*
@@ -5657,6 +5861,7 @@ static Native_func_registry func_array[] =
   { { C_STRING_WITH_LEN("ADDTIME") }, BUILDER(Create_func_addtime)},
   { { C_STRING_WITH_LEN("AES_DECRYPT") }, BUILDER(Create_func_aes_decrypt)},
   { { C_STRING_WITH_LEN("AES_ENCRYPT") }, BUILDER(Create_func_aes_encrypt)},
+  { { C_STRING_WITH_LEN("APPROX_PERCENTILE") }, BUILDER(Create_func_approx_percentile)},
   { { C_STRING_WITH_LEN("AREA") }, GEOM_BUILDER(Create_func_area)},
   { { C_STRING_WITH_LEN("ASBINARY") }, GEOM_BUILDER(Create_func_as_wkb)},
   { { C_STRING_WITH_LEN("ASIN") }, BUILDER(Create_func_asin)},
@@ -5732,6 +5937,9 @@ static Native_func_registry func_array[] =
   { { C_STRING_WITH_LEN("GTID_SUBTRACT") }, BUILDER(Create_func_gtid_subtract) },
   { { C_STRING_WITH_LEN("GTID_SUBSET") }, BUILDER(Create_func_gtid_subset) },
   { { C_STRING_WITH_LEN("HEX") }, BUILDER(Create_func_hex)},
+  { { C_STRING_WITH_LEN("HLL_CARDINALITY") }, BUILDER(Create_func_hll_cardinality)},
+  { { C_STRING_WITH_LEN("HLL_MERGE") }, BUILDER(Create_func_hll_merge)},
+  { { C_STRING_WITH_LEN("HLL_SKETCH") }, BUILDER(Create_func_hll_sketch)},
   { { C_STRING_WITH_LEN("IFNULL") }, BUILDER(Create_func_ifnull)},
   { { C_STRING_WITH_LEN("INET_ATON") }, BUILDER(Create_func_inet_aton)},
   { { C_STRING_WITH_LEN("INET_NTOA") }, BUILDER(Create_func_inet_ntoa)},
@@ -5806,6 +6014,9 @@ static Native_func_registry func_array[] =
   { { C_STRING_WITH_LEN("OCTET_LENGTH") }, BUILDER(Create_func_length)},
   { { C_STRING_WITH_LEN("ORD") }, BUILDER(Create_func_ord)},
   { { C_STRING_WITH_LEN("OVERLAPS") }, GEOM_BUILDER(Create_func_mbr_overlaps)},
+  { { C_STRING_WITH_LEN("PERCENTILE_MERGE") }, BUILDER(Create_func_percentile_merge)},
+  { { C_STRING_WITH_LEN("PERCENTILE_SKETCH") }, BUILDER(Create_func_percentile_sketch)},
+  { { C_STRING_WITH_LEN("PERCENTILE_VALUE") }, BUILDER(Create_func_percentile_value)},
   { { C_STRING_WITH_LEN("PERIOD_ADD") }, BUILDER(Create_func_period_add)},
   { { C_STRING_WITH_LEN("PERIOD_DIFF") }, BUILDER(Create_func_period_diff)},
   { { C_STRING_WITH_LEN("PI") }, BUILDER(Create_func_pi)},
@@ -5836,6 +6047,7 @@ static Native_func_registry func_array[] =
   { { C_STRING_WITH_LEN("SLEEP") }, BUILDER(Create_func_sleep)},
   { { C_STRING_WITH_LEN("SOUNDEX") }, BUILDER(Create_func_soundex)},
   { { C_STRING_WITH_LEN("SPACE") }, BUILDER(Create_func_space)},
+  { { C_STRING_WITH_LEN("WAIT_FOR_COMMIT_TICKET") }, BUILDER(Create_func_wait_for_commit_ticket)},
   { { C_STRING_WITH_LEN("WAIT_UNTIL_SQL_THREAD_AFTER_GTIDS") }, BUILDER(Create_func_master_gtid_set_wait)},
   { { C_STRING_WITH_LEN("SQRT") }, BUILDER(Create_func_sqrt)},
   { { C_STRING_WITH_LEN("SRID") }, GEOM_BUILDER(Create_func_srid)},
@@ -4134,6 +4134,41 @@ longlong Item_master_gtid_set_wait::val_int()
   return event_count;
 }
 
+/**
+  Wait until the transactions written to the binary log up to a commit
+  ticket, or up to the last transaction of the session, are durable.
+
+  Return 1 once they are, and NULL if the session has no ticket, the
+  ticket is not a position of the binary log, or the binary log is not
+  open.
+*/
+longlong Item_func_wait_for_commit_ticket::val_int()
+{
+  DBUG_ASSERT(fixed == 1);
+  THD *thd= current_thd;
+  const char *ticket= thd->commit_ticket;
+
+  null_value= 0;
+  if (arg_count == 1)
+  {
+    String *str= args[0]->val_str(&value);
+    if (!str)
+    {
+      null_value= 1;
+      return 0;
+    }
+    ticket= str->c_ptr_safe();
+  }
+
+  if (!ticket[0] || !mysql_bin_log.is_open() ||
+      mysql_bin_log.wait_for_commit_ticket(ticket))
+  {
+    null_value= 1;
+    return 0;
+  }
+  return 1;
+}
+
 /**
   Return 1 if both arguments are Gtid_sets and the first is a subset
   of the second.  Generate an error if any of the arguments is not a
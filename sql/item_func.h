@@ -1603,6 +1603,17 @@ public:
   void fix_length_and_dec() { max_length= 21; maybe_null= 1; }
 };
 
+class Item_func_wait_for_commit_ticket :public Item_int_func
+{
+  String value;
+public:
+  Item_func_wait_for_commit_ticket() :Item_int_func() {}
+  Item_func_wait_for_commit_ticket(Item *a) :Item_int_func(a) {}
+  longlong val_int();
+  const char *func_name() const { return "wait_for_commit_ticket"; }
+  void fix_length_and_dec() { max_length= 1; maybe_null= 1; }
+};
+
 class Item_func_gtid_subset : public Item_int_func
 {
   String buf1;
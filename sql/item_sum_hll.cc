@@ -8,6 +8,10 @@
 #include "sql_optimizer.h"                 // JOIN
 #include "mysqld.h"
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 Item *Item_sum_count_hll::copy_or_same(THD* thd)
 {
   return new (thd->mem_root) Item_sum_count_hll(thd, this);
@@ -16,6 +20,7 @@ Item *Item_sum_count_hll::copy_or_same(THD* thd)
 void Item_sum_count_hll::clear()
 {
   count = 0;
+  hll_reset();
 }
 
 bool Item_sum_count_hll::add()
@@ -75,7 +80,7 @@ void Item_sum_count_hll::update_field()
 const double long_range_adjustment_constant32 = 4.294967296e9;
 
 // alpha_m in the hyperloglog paper. Refer to the comment in hyperloglog.h
-double Item_sum_count_hll::get_harmonic_mean_constant(uint data_size) {
+static double get_harmonic_mean_constant(uint data_size) {
   if (data_size >= 128) {
     return 0.7213 / (1.079 / data_size + 1.0);
   } else if (data_size == 16) {
@@ -89,6 +94,55 @@ double Item_sum_count_hll::get_harmonic_mean_constant(uint data_size) {
   return 0;
 }
 
+// Position of the lowest set bit of the last last_len bits of a hash,
+// last_len + 1 if they are all zero.
+static inline uint hll_rank(uint last_bit, uint last_len) {
+  uint i;
+  for (i = 1; i <= last_len; i++) {
+    if (last_bit & 1) {
+      break;
+    } else {
+      last_bit >>= 1;
+    }
+  }
+  return i;
+}
+
+// Estimate from sum(2^-rank) over all registers and the number of zero
+// registers.
+static longlong hll_estimate(double sum, uint count_zero_elements,
+                             uint data_size) {
+  double harmonic_mean_constant = get_harmonic_mean_constant(data_size);
+  double cardinality_estimate =
+    harmonic_mean_constant * data_size * data_size / sum;
+
+  if(cardinality_estimate <= 2.5 * data_size) {
+    if(count_zero_elements != 0){
+      cardinality_estimate =
+        log((double)data_size / count_zero_elements) * data_size;
+    }
+  }else if (cardinality_estimate > long_range_adjustment_constant32 / 30.0) {
+    cardinality_estimate = -long_range_adjustment_constant32 *
+      log(1.0 - cardinality_estimate / long_range_adjustment_constant32);
+  }
+  return (longlong)(cardinality_estimate + 0.5);
+}
+
+template <typename T>
+static longlong hll_estimate(const T *data, uint data_size) {
+  double sum = 0.0;
+  uint count_zero_elements = 0;
+
+  for(uint i = 0; i < data_size; i++){
+    if(data[i] == 0){
+      count_zero_elements++;
+    }
+
+    sum += 1.0 / ((uint)1 << data[i]);
+  }
+  return hll_estimate(sum, count_zero_elements, data_size);
+}
+
 void Item_sum_count_hll::hll_init(){
   THD* thd = current_thd;
 
@@ -106,42 +160,385 @@ void Item_sum_count_hll::hll_insert(uint hash){
   uint last_len = 32 - data_size_log2;
   uint index = hash >> last_len;
   uint last_bit = hash - (index << last_len);
-  uint i;
-  for (i = 1; i <= last_len; i++) {
-    if (last_bit & 1) {
-      break;
-    } else {
-      last_bit >>= 1;
-    }
-  }
+  uint i = hll_rank(last_bit, last_len);
   if(data[index] < i){
     data[index] = i;
   }
 }
 
 longlong Item_sum_count_hll::hll_count(){
-  double harmonic_mean_constant = get_harmonic_mean_constant(data_size);
-  double sum = 0.0;
-  double cardinality_estimate = 0.0;
-  uint count_zero_elements = 0;
+  return hll_estimate(data, data_size);
+}
 
-  for(uint i = 0; i < data_size; i++){
-    if(data[i] == 0){
-      count_zero_elements++;
+
+/*****************************************************************************
+  Serializable sketches: HLL_SKETCH(), HLL_MERGE() and HLL_CARDINALITY()
+*****************************************************************************/
+
+bool Hll_sketch::alloc()
+{
+  if (registers == NULL)
+    registers= (uchar*) my_malloc(1 << MAX_PRECISION, MYF(MY_WME));
+  return registers == NULL;
+}
+
+void Hll_sketch::free()
+{
+  my_free(registers);
+  registers= NULL;
+  precision= 0;
+}
+
+void Hll_sketch::init(uint precision_arg)
+{
+  DBUG_ASSERT(registers != NULL);
+  DBUG_ASSERT(precision_arg >= MIN_PRECISION &&
+              precision_arg <= MAX_PRECISION);
+  precision= precision_arg;
+  memset(registers, 0, (size_t) 1 << precision);
+}
+
+void Hll_sketch::insert(uint32 hash)
+{
+  const uint last_len= 32 - precision;
+  const uint index= hash >> last_len;
+  const uint rank= hll_rank(hash & ((1U << last_len) - 1), last_len);
+  if (registers[index] < rank)
+    registers[index]= rank;
+}
+
+/**
+  Check that buf holds a serialized sketch.
+*/
+bool Hll_sketch::is_valid(const uchar *buf, size_t length)
+{
+  if (length < 2 || buf[1] < MIN_PRECISION || buf[1] > MAX_PRECISION)
+    return false;
+  const uint p= buf[1];
+  const uint data_size= 1 << p;
+  const uint max_rank= 32 - p + 1;
+  const uchar *pos= buf + 2;
+  const uchar *end= buf + length;
+
+  switch (buf[0]) {
+  case SPARSE:
+  {
+    if ((length - 2) % 3 != 0)
+      return false;
+    int prev_index= -1;
+    for (; pos < end; pos+= 3)
+    {
+      const uint index= uint2korr(pos);
+      if ((int) index <= prev_index || index >= data_size ||
+          pos[2] == 0 || pos[2] > max_rank)
+        return false;
+      prev_index= index;
     }
+    return true;
+  }
+  case DENSE:
+    if (length != 2 + data_size)
+      return false;
+    for (; pos < end; pos++)
+      if (*pos > max_rank)
+        return false;
+    return true;
+  default:
+    return false;
+  }
+}
 
-    sum += 1.0 / ((uint)1 << data[i]);
+/**
+  Fold the registers to 2^new_precision registers. The index bits that
+  are dropped become the top bits of the part of the hash that the rank
+  is computed from, so they only matter for registers where that part
+  was all zero.
+*/
+void Hll_sketch::reduce_precision(uint new_precision)
+{
+  DBUG_ASSERT(new_precision < precision);
+  const uint shift= precision - new_precision;
+  const uint last_len= 32 - precision;
+  const uint data_size= 1 << precision;
+
+  for (uint i= 0; i < data_size; i++)
+  {
+    uint rank= registers[i];
+    if (rank > last_len)
+      rank= last_len + hll_rank(i & ((1U << shift) - 1), shift);
+    registers[i]= 0;
+    const uint index= i >> shift;
+    if (registers[index] < rank)
+      registers[index]= rank;
   }
-  cardinality_estimate = harmonic_mean_constant * data_size * data_size / sum;
+  precision= new_precision;
+}
 
-  if(cardinality_estimate <= 2.5 * data_size) {
-    if(count_zero_elements != 0){
-      cardinality_estimate =
-        log((double)data_size / count_zero_elements) * data_size;
+/**
+  Merge a serialized sketch into this one.
+
+  @return true if buf is not a serialized sketch
+*/
+bool Hll_sketch::merge(const uchar *buf, size_t length)
+{
+  DBUG_ASSERT(registers != NULL);
+  if (!is_valid(buf, length))
+    return true;
+
+  const uint p= buf[1];
+  if (is_empty())
+    init(p);
+  else if (p < precision)
+    reduce_precision(p);
+
+  const uint shift= p - precision;
+  const uint last_len= 32 - p;
+
+  if (buf[0] == DENSE && shift == 0)
+  {
+    /* Register-wise maximum, the common case when merging rollups */
+    const uchar *src= buf + 2;
+    const size_t data_size= (size_t) 1 << precision;
+    size_t i= 0;
+#ifdef __SSE2__
+    for (; i + 16 <= data_size; i+= 16)
+    {
+      __m128i a= _mm_loadu_si128((const __m128i*) (registers + i));
+      __m128i b= _mm_loadu_si128((const __m128i*) (src + i));
+      _mm_storeu_si128((__m128i*) (registers + i), _mm_max_epu8(a, b));
     }
-  }else if (cardinality_estimate > long_range_adjustment_constant32 / 30.0) {
-    cardinality_estimate = -long_range_adjustment_constant32 *
-      log(1.0 - cardinality_estimate / long_range_adjustment_constant32);
+#endif
+    for (; i < data_size; i++)
+      if (registers[i] < src[i])
+        registers[i]= src[i];
+    return false;
   }
-  return (longlong)(cardinality_estimate + 0.5);
+
+  const uchar *pos= buf + 2;
+  const uchar *end= buf + length;
+  const uint step= buf[0] == DENSE ? 1 : 3;
+  for (uint i= 0; pos < end; pos+= step, i++)
+  {
+    uint index, rank;
+    if (buf[0] == DENSE)
+    {
+      index= i;
+      rank= *pos;
+    }
+    else
+    {
+      index= uint2korr(pos);
+      rank= pos[2];
+    }
+    if (shift && rank > last_len)
+      rank= last_len + hll_rank(index & ((1U << shift) - 1), shift);
+    index>>= shift;
+    if (registers[index] < rank)
+      registers[index]= rank;
+  }
+  return false;
+}
+
+/**
+  Serialize the sketch, sparse if that is shorter.
+
+  @return true if out of memory
+*/
+bool Hll_sketch::serialize(String *str) const
+{
+  DBUG_ASSERT(!is_empty());
+  const uint data_size= 1 << precision;
+  uint count_nonzero= 0;
+  for (uint i= 0; i < data_size; i++)
+    if (registers[i])
+      count_nonzero++;
+
+  const bool sparse= 3 * count_nonzero < data_size;
+  const uint32 length= 2 + (sparse ? 3 * count_nonzero : data_size);
+  str->length(0);
+  if (str->alloc(length))
+    return true;
+  uchar *pos= (uchar*) str->ptr();
+  pos[0]= sparse ? SPARSE : DENSE;
+  pos[1]= precision;
+  pos+= 2;
+  if (sparse)
+  {
+    for (uint i= 0; i < data_size; i++)
+    {
+      if (registers[i])
+      {
+        int2store(pos, i);
+        pos[2]= registers[i];
+        pos+= 3;
+      }
+    }
+  }
+  else
+    memcpy(pos, registers, data_size);
+  str->length(length);
+  return false;
+}
+
+/**
+  Estimate the cardinality of a serialized sketch without expanding it.
+
+  @return true if buf is not a serialized sketch
+*/
+bool Hll_sketch::estimate(const uchar *buf, size_t length, longlong *result)
+{
+  if (!is_valid(buf, length))
+    return true;
+  const uint data_size= 1 << buf[1];
+  if (buf[0] == DENSE)
+  {
+    *result= hll_estimate(buf + 2, data_size);
+    return false;
+  }
+  const uint count_nonzero= (length - 2) / 3;
+  double sum= data_size - count_nonzero;
+  for (const uchar *pos= buf + 2; pos < buf + length; pos+= 3)
+    sum+= 1.0 / ((uint) 1 << pos[2]);
+  *result= hll_estimate(sum, data_size - count_nonzero, data_size);
+  return false;
+}
+
+
+bool Item_sum_hll_str::fix_fields(THD *thd, Item **ref)
+{
+  DBUG_ASSERT(fixed == 0);
+
+  if (init_sum_func_check(thd))
+    return TRUE;
+
+  if ((!args[0]->fixed && args[0]->fix_fields(thd, args)) ||
+      args[0]->check_cols(1))
+    return TRUE;
+
+  result_field= 0;
+  decimals= 0;
+  maybe_null= 1;
+  null_value= 1;
+  collation.set(&my_charset_bin);
+  max_length= Hll_sketch::MAX_LENGTH;
+
+  if (check_sum_func(thd, ref))
+    return TRUE;
+
+  fixed= 1;
+  return FALSE;
+}
+
+String *Item_sum_hll_str::val_str(String *str)
+{
+  DBUG_ASSERT(fixed == 1);
+  if (sketch.is_empty() || sketch.serialize(&result))
+  {
+    null_value= 1;
+    return NULL;
+  }
+  null_value= 0;
+  return &result;
+}
+
+double Item_sum_hll_str::val_real()
+{
+  String *res= val_str(&str_value);
+  return res ? double_from_string_with_check(res->charset(),
+                                             res->ptr(),
+                                             (char*) res->ptr() +
+                                             res->length()) : 0.0;
+}
+
+longlong Item_sum_hll_str::val_int()
+{
+  String *res= val_str(&str_value);
+  return res ? longlong_from_string_with_check(res->charset(),
+                                               res->ptr(),
+                                               (char*) res->ptr() +
+                                               res->length()) : 0;
+}
+
+void Item_sum_hll_str::cleanup()
+{
+  DBUG_ENTER("Item_sum_hll_str::cleanup");
+  sketch.free();
+  result.free();
+  Item_sum::cleanup();
+  DBUG_VOID_RETURN;
+}
+
+
+Item *Item_sum_hll_sketch::copy_or_same(THD* thd)
+{
+  return new (thd->mem_root) Item_sum_hll_sketch(thd, this);
+}
+
+void Item_sum_hll_sketch::clear()
+{
+  uint precision= current_thd->variables.hll_data_size_log2;
+  set_if_bigger(precision, Hll_sketch::MIN_PRECISION);
+  set_if_smaller(precision, Hll_sketch::MAX_PRECISION);
+  if (sketch.alloc())
+    sketch.clear();
+  else
+    sketch.init(precision);
+}
+
+bool Item_sum_hll_sketch::add()
+{
+  if (sketch.is_empty())
+    return TRUE;                                // Out of memory in clear()
+  /* Hash the values as HLL() does, so that the estimates are the same */
+  String tmp;
+  String *val= args[0]->val_str_ascii(&tmp);
+  if (val == NULL)
+    return FALSE;
+  sketch.insert(my_sbox_hash((uchar*) val->ptr(), val->length()));
+  return FALSE;
+}
+
+
+Item *Item_sum_hll_merge::copy_or_same(THD* thd)
+{
+  return new (thd->mem_root) Item_sum_hll_merge(thd, this);
+}
+
+void Item_sum_hll_merge::clear()
+{
+  sketch.clear();
+}
+
+bool Item_sum_hll_merge::add()
+{
+  String tmp;
+  String *val= args[0]->val_str(&tmp);
+  if (val == NULL)
+    return FALSE;
+  if (sketch.alloc())
+    return TRUE;
+  if (sketch.merge((const uchar*) val->ptr(), val->length()))
+    push_warning_printf(current_thd, Sql_condition::WARN_LEVEL_WARN,
+                        ER_WRONG_ARGUMENTS, ER(ER_WRONG_ARGUMENTS),
+                        "hll_merge");
+  return FALSE;
+}
+
+
+longlong Item_func_hll_cardinality::val_int()
+{
+  DBUG_ASSERT(fixed == 1);
+  String *val= args[0]->val_str(&value);
+  longlong result= 0;
+  if ((null_value= (val == NULL)))
+    return 0;
+  if (Hll_sketch::estimate((const uchar*) val->ptr(), val->length(), &result))
+  {
+    push_warning_printf(current_thd, Sql_condition::WARN_LEVEL_WARN,
+                        ER_WRONG_ARGUMENTS, ER(ER_WRONG_ARGUMENTS),
+                        func_name());
+    null_value= 1;
+    return 0;
+  }
+  return result;
 }
@@ -73,8 +73,6 @@ class Item_sum_count_hll :public Item_sum_int
   void hll_insert(uint hash);
   longlong hll_count();
 
-  double get_harmonic_mean_constant(uint data_size);
-
   uchar data_size_log2;
   uint data_size;
   uchar max_bit_position;
@@ -82,4 +80,153 @@ class Item_sum_count_hll :public Item_sum_int
 
 };
 
+
+/**
+  HyperLogLog sketch that can be serialized, stored in a BLOB column and
+  merged with other sketches, see HLL_SKETCH(), HLL_MERGE() and
+  HLL_CARDINALITY().
+
+  The registers are dense in memory. The serialized form is sparse while
+  few registers are set:
+
+    byte 0    encoding, SPARSE or DENSE
+    byte 1    precision p, the sketch has 2^p registers
+    SPARSE    3 bytes for each nonzero register in index order: the
+              index (2 bytes) and the rank
+    DENSE     2^p bytes, the rank of each register
+
+  Sketches of different precisions can be merged: the result has the
+  lower precision, and is the sketch that would have been built with
+  it from the union of the values.
+*/
+class Hll_sketch
+{
+public:
+  static const uint MIN_PRECISION= 4;
+  static const uint MAX_PRECISION= 16;
+  static const uchar SPARSE= 1;
+  static const uchar DENSE= 2;
+  /** Maximum length of a serialized sketch */
+  static const uint MAX_LENGTH= 2 + (1 << MAX_PRECISION);
+
+  Hll_sketch() : precision(0), registers(NULL) {}
+  ~Hll_sketch() { free(); }
+
+  bool alloc();
+  void free();
+  /** Start an empty sketch with 2^precision_arg registers */
+  void init(uint precision_arg);
+  /** Forget the precision, the next merge() sets it */
+  void clear() { precision= 0; }
+  bool is_empty() const { return precision == 0; }
+
+  void insert(uint32 hash);
+  bool merge(const uchar *buf, size_t length);
+  bool serialize(String *str) const;
+
+  static bool estimate(const uchar *buf, size_t length, longlong *result);
+
+private:
+  Hll_sketch(const Hll_sketch &);
+  Hll_sketch &operator=(const Hll_sketch &);
+
+  static bool is_valid(const uchar *buf, size_t length);
+  void reduce_precision(uint new_precision);
+
+  uint precision;
+  uchar *registers;
+};
+
+
+/**
+  Common part of HLL_SKETCH() and HLL_MERGE(), which return a serialized
+  sketch. Groups are not updated in temporary tables (quick_group= 0).
+*/
+class Item_sum_hll_str :public Item_sum
+{
+protected:
+  Hll_sketch sketch;
+  String result;
+
+public:
+  Item_sum_hll_str(Item *item_par) :Item_sum(item_par)
+  { quick_group= 0; }
+  Item_sum_hll_str(THD *thd, Item_sum_hll_str *item) :Item_sum(thd, item)
+  { quick_group= 0; }
+
+  bool fix_fields(THD *thd, Item **ref);
+  enum Sumfunctype sum_func () const { return HLL_SKETCH_FUNC; }
+  enum Item_result result_type () const { return STRING_RESULT; }
+  enum_field_types field_type() const { return MYSQL_TYPE_BLOB; }
+  virtual bool have_field_update(void) const { return 0; }
+
+  String *val_str(String *str);
+  double val_real();
+  longlong val_int();
+  my_decimal *val_decimal(my_decimal *decimal_value)
+  {
+    return val_decimal_from_string(decimal_value);
+  }
+  bool get_date(MYSQL_TIME *ltime, uint fuzzydate)
+  {
+    return get_date_from_string(ltime, fuzzydate);
+  }
+  bool get_time(MYSQL_TIME *ltime)
+  {
+    return get_time_from_string(ltime);
+  }
+  void reset_field() {}
+  void update_field() {}
+  void cleanup();
+};
+
+
+/** HLL_SKETCH(expr): sketch of the non-NULL values of expr */
+class Item_sum_hll_sketch :public Item_sum_hll_str
+{
+public:
+  Item_sum_hll_sketch(Item *item_par) :Item_sum_hll_str(item_par) {}
+  Item_sum_hll_sketch(THD *thd, Item_sum_hll_sketch *item)
+    :Item_sum_hll_str(thd, item) {}
+
+  void clear();
+  bool add();
+  const char *func_name() const { return "hll_sketch("; }
+  Item *copy_or_same(THD* thd);
+};
+
+
+/**
+  HLL_MERGE(sketch): union of the sketches, NULL if all of them are NULL.
+  Values that are not sketches are skipped with a warning.
+*/
+class Item_sum_hll_merge :public Item_sum_hll_str
+{
+public:
+  Item_sum_hll_merge(Item *item_par) :Item_sum_hll_str(item_par) {}
+  Item_sum_hll_merge(THD *thd, Item_sum_hll_merge *item)
+    :Item_sum_hll_str(thd, item) {}
+
+  void clear();
+  bool add();
+  const char *func_name() const { return "hll_merge("; }
+  Item *copy_or_same(THD* thd);
+};
+
+
+/**
+  HLL_CARDINALITY(sketch): estimated number of distinct values in a
+  sketch. NULL, with a warning, if the argument is not a sketch.
+*/
+class Item_func_hll_cardinality :public Item_int_func
+{
+  String value;
+
+public:
+  Item_func_hll_cardinality(Item *a) :Item_int_func(a) {}
+  longlong val_int();
+  const char *func_name() const { return "hll_cardinality"; }
+  void fix_length_and_dec() { max_length= 21; maybe_null= 1; }
+};
+
 #endif
@@ -0,0 +1,488 @@
+/* Copyright (c) 2016, Facebook. All rights reserved.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA */
+
+#include "item_sum_percentile.h"
+
+#include <algorithm>
+#include <math.h>
+
+#include "sql_class.h"
+
+
+/*****************************************************************************
+  Kll_sketch
+*****************************************************************************/
+
+void Kll_sketch::clear()
+{
+  levels.clear();
+  n= 0;
+  min_value= max_value= 0.0;
+  parity= 0;
+}
+
+void Kll_sketch::free()
+{
+  std::vector<std::vector<double> >().swap(levels);
+  clear();
+}
+
+/**
+  Number of values level can hold before it is compacted: K for the top
+  level, 2/3 of that for each level below, and at least 2.
+*/
+uint Kll_sketch::capacity(uint level) const
+{
+  const uint depth= levels.size() - 1 - level;
+  const uint cap= (uint) ceil(K * pow(2.0 / 3.0, (double) depth));
+  return cap > 2 ? cap : 2;
+}
+
+void Kll_sketch::insert(double value)
+{
+  if (levels.empty())
+    levels.resize(1);
+  if (n == 0)
+    min_value= max_value= value;
+  else
+  {
+    set_if_smaller(min_value, value);
+    set_if_bigger(max_value, value);
+  }
+  levels[0].push_back(value);
+  n++;
+  if (levels[0].size() >= capacity(0))
+    compress();
+}
+
+/**
+  Compact full levels, lowest first, until no level is full. Adding a
+  level lowers the capacity of the levels below it, so this can take
+  more than one pass.
+
+  The total weight of the values is the number of values seen, which
+  merge() keeps below 2^64, so level MAX_LEVELS - 1 cannot fill up. It
+  is still never compacted, it could only grow past its capacity.
+*/
+void Kll_sketch::compress()
+{
+  for (;;)
+  {
+    uint level;
+    for (level= 0; level < levels.size() && level + 1 < MAX_LEVELS; level++)
+      if (levels[level].size() >= capacity(level))
+        break;
+    if (level == levels.size() || level + 1 == MAX_LEVELS)
+      return;
+    compact(level);
+  }
+}
+
+/**
+  Move every other value of level one level up, keeping the largest
+  value of an odd-sized level where it is.
+*/
+void Kll_sketch::compact(uint level)
+{
+  DBUG_ASSERT(level + 1 < MAX_LEVELS);
+  if (level + 1 == levels.size())
+    levels.resize(level + 2);
+  std::vector<double> &from= levels[level];
+  std::vector<double> &to= levels[level + 1];
+
+  /* Levels above 0 are kept sorted */
+  if (level == 0)
+    std::sort(from.begin(), from.end());
+
+  const size_t even= from.size() & ~(size_t) 1;
+  const size_t offset= (parity >> level) & 1;
+  parity^= 1ULL << level;
+
+  std::vector<double> merged;
+  merged.reserve(to.size() + even / 2);
+  size_t up= offset, old= 0;
+  while (up < even || old < to.size())
+  {
+    if (old == to.size() || (up < even && from[up] < to[old]))
+    {
+      merged.push_back(from[up]);
+      up+= 2;
+    }
+    else
+      merged.push_back(to[old++]);
+  }
+  to.swap(merged);
+  from.erase(from.begin(), from.begin() + even);
+}
+
+/**
+  Merge a serialized sketch into this one.
+
+  @return true if buf is not a serialized sketch, or if the sketches
+  together would have seen more than ULONGLONG_MAX values
+*/
+bool Kll_sketch::merge(const uchar *buf, size_t length)
+{
+  if (length < HEADER_LENGTH || buf[0] != FORMAT_VERSION ||
+      buf[1] > MAX_LEVELS)
+    return true;
+  const uint n_levels= buf[1];
+  const ulonglong count= uint8korr(buf + 2);
+  double other_min, other_max;
+  float8get(other_min, buf + 10);
+  float8get(other_max, buf + 18);
+  if (length < HEADER_LENGTH + 4 * n_levels)
+    return true;
+
+  /* Check the level sizes against the length and the number of values */
+  const uchar *sizes= buf + HEADER_LENGTH;
+  const uchar *values= sizes + 4 * n_levels;
+  ulonglong total_items= 0, total_weight= 0;
+  for (uint level= 0; level < n_levels; level++)
+  {
+    const ulonglong size= uint4korr(sizes + 4 * level);
+    if (size > (ULONGLONG_MAX - total_weight) >> level)
+      return true;
+    total_items+= size;
+    total_weight+= size << level;
+  }
+  if (total_weight != count || count > ULONGLONG_MAX - n ||
+      (ulonglong) (buf + length - values) != 8 * total_items)
+    return true;
+
+  /* Levels above 0 must be sorted, and there are no NaNs */
+  const uchar *pos= values;
+  for (uint level= 0; level < n_levels; level++)
+  {
+    const uint size= uint4korr(sizes + 4 * level);
+    double prev= 0.0;
+    for (uint i= 0; i < size; i++, pos+= 8)
+    {
+      double value;
+      float8get(value, pos);
+      if (my_isnan(value) || (level > 0 && i > 0 && value < prev))
+        return true;
+      prev= value;
+    }
+  }
+  if (count == 0)
+    return false;
+
+  if (levels.size() < n_levels)
+    levels.resize(n_levels);
+  pos= values;
+  for (uint level= 0; level < n_levels; level++)
+  {
+    const uint size= uint4korr(sizes + 4 * level);
+    std::vector<double> &to= levels[level];
+    const size_t old_size= to.size();
+    for (uint i= 0; i < size; i++, pos+= 8)
+    {
+      double value;
+      float8get(value, pos);
+      to.push_back(value);
+    }
+    if (level > 0)
+      std::inplace_merge(to.begin(), to.begin() + old_size, to.end());
+  }
+  if (n == 0)
+  {
+    min_value= other_min;
+    max_value= other_max;
+  }
+  else
+  {
+    set_if_smaller(min_value, other_min);
+    set_if_bigger(max_value, other_max);
+  }
+  n+= count;
+  compress();
+  return false;
+}
+
+static bool value_less(const std::pair<double, ulonglong> &a,
+                       const std::pair<double, ulonglong> &b)
+{
+  return a.first < b.first;
+}
+
+/**
+  Smallest value whose weighted rank is at least fraction * n. This is
+  the exact nearest-rank percentile while no level was compacted.
+*/
+double Kll_sketch::quantile(double fraction) const
+{
+  DBUG_ASSERT(n > 0);
+  if (fraction <= 0.0)
+    return min_value;
+  if (fraction >= 1.0)
+    return max_value;
+
+  std::vector<std::pair<double, ulonglong> > items;
+  for (uint level= 0; level < levels.size(); level++)
+    for (size_t i= 0; i < levels[level].size(); i++)
+      items.push_back(std::make_pair(levels[level][i], 1ULL << level));
+  std::sort(items.begin(), items.end(), value_less);
+
+  const double rank= fraction * n;
+  ulonglong weight= 0;
+  for (size_t i= 0; i < items.size(); i++)
+  {
+    weight+= items[i].second;
+    if (weight >= rank)
+      return items[i].first;
+  }
+  return max_value;
+}
+
+/**
+  @return true if out of memory
+*/
+bool Kll_sketch::serialize(String *str) const
+{
+  size_t total_items= 0;
+  for (uint level= 0; level < levels.size(); level++)
+    total_items+= levels[level].size();
+  const uint32 length= HEADER_LENGTH + 4 * levels.size() + 8 * total_items;
+
+  str->length(0);
+  if (str->alloc(length))
+    return true;
+  uchar *pos= (uchar*) str->ptr();
+  pos[0]= FORMAT_VERSION;
+  pos[1]= (uchar) levels.size();
+  int8store(pos + 2, n);
+  float8store(pos + 10, min_value);
+  float8store(pos + 18, max_value);
+  pos+= HEADER_LENGTH;
+  for (uint level= 0; level < levels.size(); level++, pos+= 4)
+    int4store(pos, (uint32) levels[level].size());
+  for (uint level= 0; level < levels.size(); level++)
+    for (size_t i= 0; i < levels[level].size(); i++, pos+= 8)
+      float8store(pos, levels[level][i]);
+  str->length(length);
+  return false;
+}
+
+
+/** Check that a percentile is in [0, 1], warn if not */
+static bool check_fraction(double fraction, const char *func_name)
+{
+  if (fraction < 0.0 || fraction > 1.0)
+  {
+    push_warning_printf(current_thd, Sql_condition::WARN_LEVEL_WARN,
+                        ER_WRONG_ARGUMENTS, ER(ER_WRONG_ARGUMENTS),
+                        func_name);
+    return true;
+  }
+  return false;
+}
+
+
+/*****************************************************************************
+  APPROX_PERCENTILE()
+*****************************************************************************/
+
+bool Item_sum_approx_percentile::fix_fields(THD *thd, Item **ref)
+{
+  if (Item_sum_num::fix_fields(thd, ref))
+    return TRUE;
+  /* The same percentile for all groups */
+  if (!args[1]->const_item())
+  {
+    my_error(ER_WRONG_ARGUMENTS, MYF(0), "approx_percentile");
+    return TRUE;
+  }
+  return FALSE;
+}
+
+Item *Item_sum_approx_percentile::copy_or_same(THD* thd)
+{
+  return new (thd->mem_root) Item_sum_approx_percentile(thd, this);
+}
+
+void Item_sum_approx_percentile::clear()
+{
+  sketch.clear();
+}
+
+bool Item_sum_approx_percentile::add()
+{
+  const double value= args[0]->val_real();
+  if (!args[0]->null_value)
+    sketch.insert(value);
+  return FALSE;
+}
+
+double Item_sum_approx_percentile::val_real()
+{
+  DBUG_ASSERT(fixed == 1);
+  const double fraction= args[1]->val_real();
+  if ((null_value= (sketch.count() == 0 || args[1]->null_value ||
+                    check_fraction(fraction, "approx_percentile"))))
+    return 0.0;
+  return sketch.quantile(fraction);
+}
+
+void Item_sum_approx_percentile::cleanup()
+{
+  DBUG_ENTER("Item_sum_approx_percentile::cleanup");
+  sketch.free();
+  Item_sum_num::cleanup();
+  DBUG_VOID_RETURN;
+}
+
+
+/*****************************************************************************
+  PERCENTILE_SKETCH(), PERCENTILE_MERGE() and PERCENTILE_VALUE()
+*****************************************************************************/
+
+bool Item_sum_percentile_str::fix_fields(THD *thd, Item **ref)
+{
+  DBUG_ASSERT(fixed == 0);
+
+  if (init_sum_func_check(thd))
+    return TRUE;
+
+  if ((!args[0]->fixed && args[0]->fix_fields(thd, args)) ||
+      args[0]->check_cols(1))
+    return TRUE;
+
+  result_field= 0;
+  decimals= 0;
+  maybe_null= 1;
+  null_value= 1;
+  collation.set(&my_charset_bin);
+  /* Levels hold less than 3 * K values, plus at most 3 each for rounding */
+  max_length= Kll_sketch::HEADER_LENGTH + 4 * Kll_sketch::MAX_LEVELS +
+              8 * (3 * Kll_sketch::K + 3 * Kll_sketch::MAX_LEVELS);
+
+  if (check_sum_func(thd, ref))
+    return TRUE;
+
+  fixed= 1;
+  return FALSE;
+}
+
+void Item_sum_percentile_str::clear()
+{
+  sketch.clear();
+  has_value= false;
+}
+
+String *Item_sum_percentile_str::val_str(String *str)
+{
+  DBUG_ASSERT(fixed == 1);
+  if (!has_value || sketch.serialize(&result))
+  {
+    null_value= 1;
+    return NULL;
+  }
+  null_value= 0;
+  return &result;
+}
+
+double Item_sum_percentile_str::val_real()
+{
+  String *res= val_str(&str_value);
+  return res ? double_from_string_with_check(res->charset(),
+                                             res->ptr(),
+                                             (char*) res->ptr() +
+                                             res->length()) : 0.0;
+}
+
+longlong Item_sum_percentile_str::val_int()
+{
+  String *res= val_str(&str_value);
+  return res ? longlong_from_string_with_check(res->charset(),
+                                               res->ptr(),
+                                               (char*) res->ptr() +
+                                               res->length()) : 0;
+}
+
+void Item_sum_percentile_str::cleanup()
+{
+  DBUG_ENTER("Item_sum_percentile_str::cleanup");
+  sketch.free();
+  result.free();
+  has_value= false;
+  Item_sum::cleanup();
+  DBUG_VOID_RETURN;
+}
+
+
+Item *Item_sum_percentile_sketch::copy_or_same(THD* thd)
+{
+  return new (thd->mem_root) Item_sum_percentile_sketch(thd, this);
+}
+
+void Item_sum_percentile_sketch::clear()
+{
+  Item_sum_percentile_str::clear();
+  has_value= true;                              // Empty sketch, not NULL
+}
+
+bool Item_sum_percentile_sketch::add()
+{
+  const double value= args[0]->val_real();
+  if (!args[0]->null_value)
+    sketch.insert(value);
+  return FALSE;
+}
+
+
+Item *Item_sum_percentile_merge::copy_or_same(THD* thd)
+{
+  return new (thd->mem_root) Item_sum_percentile_merge(thd, this);
+}
+
+bool Item_sum_percentile_merge::add()
+{
+  String tmp;
+  String *val= args[0]->val_str(&tmp);
+  if (val == NULL)
+    return FALSE;
+  if (sketch.merge((const uchar*) val->ptr(), val->length()))
+    push_warning_printf(current_thd, Sql_condition::WARN_LEVEL_WARN,
+                        ER_WRONG_ARGUMENTS, ER(ER_WRONG_ARGUMENTS),
+                        "percentile_merge");
+  else
+    has_value= true;
+  return FALSE;
+}
+
+
+double Item_func_percentile_value::val_real()
+{
+  DBUG_ASSERT(fixed == 1);
+  String *val= args[0]->val_str(&value);
+  const double fraction= args[1]->val_real();
+  if ((null_value= (val == NULL || args[1]->null_value ||
+                    check_fraction(fraction, func_name()))))
+    return 0.0;
+
+  Kll_sketch sketch;
+  if (sketch.merge((const uchar*) val->ptr(), val->length()))
+  {
+    push_warning_printf(current_thd, Sql_condition::WARN_LEVEL_WARN,
+                        ER_WRONG_ARGUMENTS, ER(ER_WRONG_ARGUMENTS),
+                        func_name());
+    null_value= 1;
+    return 0.0;
+  }
+  if ((null_value= sketch.count() == 0))
+    return 0.0;
+  return sketch.quantile(fraction);
+}
@@ -0,0 +1,226 @@
+#ifndef ITEM_SUM_PERCENTILE_INCLUDED
+#define ITEM_SUM_PERCENTILE_INCLUDED
+
+/* Copyright (c) 2016, Facebook. All rights reserved.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA */
+
+#include <vector>
+
+#include "item.h"
+#include "item_sum.h"
+
+/**
+  KLL quantile sketch (Karnin, Lang, Liberty: "Optimal quantile
+  approximation in streams").
+
+  Level h holds values that each stand for 2^h input values. When a
+  level is full, it is sorted and every other value, starting at an
+  offset that alternates between compactions, moves up one level. The
+  capacity of a level decreases geometrically (by 2/3) with its distance
+  from the top level, so a sketch holds at most about 3 * K values
+  however many values it has seen, and percentiles are exact as long as
+  fewer than K values were inserted.
+
+  Serialized form, all numbers little endian:
+
+    byte 0          format version, FORMAT_VERSION
+    byte 1          number of levels L
+    bytes 2..9      number of values seen
+    bytes 10..25    minimum and maximum value (doubles)
+    4 * L bytes     number of values in each level
+    8 bytes         each value (double), level by level
+*/
+class Kll_sketch
+{
+public:
+  /** Capacity of the top level, gives rank errors below about 2% */
+  static const uint K= 200;
+  static const uint MAX_LEVELS= 60;
+  static const uchar FORMAT_VERSION= 1;
+  static const uint HEADER_LENGTH= 26;
+
+  Kll_sketch() { clear(); }
+
+  void clear();
+  /** Release the memory of the levels */
+  void free();
+  ulonglong count() const { return n; }
+
+  void insert(double value);
+  bool merge(const uchar *buf, size_t length);
+  double quantile(double fraction) const;
+  bool serialize(String *str) const;
+
+private:
+  void compress();
+  void compact(uint level);
+  uint capacity(uint level) const;
+
+  std::vector<std::vector<double> > levels;
+  /** Number of values seen */
+  ulonglong n;
+  double min_value, max_value;
+  /** Offset of the next compaction of each level */
+  ulonglong parity;
+};
+
+
+/**
+  APPROX_PERCENTILE(expr, fraction): approximate percentile of the
+  non-NULL values of expr, fraction is a constant in [0, 1]. The rank of
+  the value returned is within about 2% of fraction * count.
+
+  Groups are not updated in temporary tables (quick_group= 0): GROUP BY
+  sorts the rows, and each group is aggregated in one sketch of bounded
+  size.
+*/
+class Item_sum_approx_percentile :public Item_sum_num
+{
+  Kll_sketch sketch;
+
+public:
+  Item_sum_approx_percentile(Item *a, Item *b) :Item_sum_num(a, b)
+  { quick_group= 0; }
+  Item_sum_approx_percentile(THD *thd, Item_sum_approx_percentile *item)
+    :Item_sum_num(thd, item)
+  { quick_group= 0; }
+
+  bool fix_fields(THD *thd, Item **ref);
+  void fix_length_and_dec()
+  {
+    decimals= NOT_FIXED_DEC;
+    max_length= float_length(decimals);
+    maybe_null= 1;
+  }
+  enum Sumfunctype sum_func () const { return PERCENTILE_FUNC; }
+  enum Item_result result_type () const { return REAL_RESULT; }
+  enum_field_types field_type() const { return MYSQL_TYPE_DOUBLE; }
+  virtual bool have_field_update(void) const { return 0; }
+
+  void clear();
+  bool add();
+  double val_real();
+  void reset_field() {}
+  void update_field() {}
+  void cleanup();
+  const char *func_name() const { return "approx_percentile("; }
+  Item *copy_or_same(THD* thd);
+};
+
+
+/**
+  Common part of PERCENTILE_SKETCH() and PERCENTILE_MERGE(), which return
+  a serialized Kll_sketch.
+*/
+class Item_sum_percentile_str :public Item_sum
+{
+protected:
+  Kll_sketch sketch;
+  String result;
+  /** false if the result is NULL */
+  bool has_value;
+
+public:
+  Item_sum_percentile_str(Item *item_par)
+    :Item_sum(item_par), has_value(false)
+  { quick_group= 0; }
+  Item_sum_percentile_str(THD *thd, Item_sum_percentile_str *item)
+    :Item_sum(thd, item), has_value(false)
+  { quick_group= 0; }
+
+  bool fix_fields(THD *thd, Item **ref);
+  enum Sumfunctype sum_func () const { return PERCENTILE_FUNC; }
+  enum Item_result result_type () const { return STRING_RESULT; }
+  enum_field_types field_type() const { return MYSQL_TYPE_BLOB; }
+  virtual bool have_field_update(void) const { return 0; }
+
+  String *val_str(String *str);
+  double val_real();
+  longlong val_int();
+  my_decimal *val_decimal(my_decimal *decimal_value)
+  {
+    return val_decimal_from_string(decimal_value);
+  }
+  bool get_date(MYSQL_TIME *ltime, uint fuzzydate)
+  {
+    return get_date_from_string(ltime, fuzzydate);
+  }
+  bool get_time(MYSQL_TIME *ltime)
+  {
+    return get_time_from_string(ltime);
+  }
+  void clear();
+  void reset_field() {}
+  void update_field() {}
+  void cleanup();
+};
+
+
+/** PERCENTILE_SKETCH(expr): sketch of the non-NULL values of expr */
+class Item_sum_percentile_sketch :public Item_sum_percentile_str
+{
+public:
+  Item_sum_percentile_sketch(Item *item_par)
+    :Item_sum_percentile_str(item_par) {}
+  Item_sum_percentile_sketch(THD *thd, Item_sum_percentile_sketch *item)
+    :Item_sum_percentile_str(thd, item) {}
+
+  void clear();
+  bool add();
+  const char *func_name() const { return "percentile_sketch("; }
+  Item *copy_or_same(THD* thd);
+};
+
+
+/**
+  PERCENTILE_MERGE(sketch): union of the sketches, NULL if all of them
+  are NULL. Values that are not sketches are skipped with a warning.
+*/
+class Item_sum_percentile_merge :public Item_sum_percentile_str
+{
+public:
+  Item_sum_percentile_merge(Item *item_par)
+    :Item_sum_percentile_str(item_par) {}
+  Item_sum_percentile_merge(THD *thd, Item_sum_percentile_merge *item)
+    :Item_sum_percentile_str(thd, item) {}
+
+  bool add();
+  const char *func_name() const { return "percentile_merge("; }
+  Item *copy_or_same(THD* thd);
+};
+
+
+/**
+  PERCENTILE_VALUE(sketch, fraction): approximate percentile of the
+  values of a sketch. NULL if the sketch is empty, and NULL with a
+  warning if the arguments are not a sketch and a fraction in [0, 1].
+*/
+class Item_func_percentile_value :public Item_real_func
+{
+  String value;
+
+public:
+  Item_func_percentile_value(Item *a, Item *b) :Item_real_func(a, b) {}
+  double val_real();
+  const char *func_name() const { return "percentile_value"; }
+  void fix_length_and_dec()
+  {
+    decimals= NOT_FIXED_DEC;
+    max_length= float_length(decimals);
+    maybe_null= 1;
+  }
+};
+
+#endif
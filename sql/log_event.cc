@@ -3444,6 +3444,10 @@ Log_event::handle_terminal_dep_event(Relay_log_info *rli,
     // NOTE: we store the end event for a single event trx
     auto to_add= rli->prev_event ? rli->prev_event : ev;
     mysql_mutex_lock(&rli->dep_key_lookup_mutex);
+    // case: all trxs in flight are done before a sync group is executed, so
+    // there is nothing left to depend on
+    if (rli->dep_sync_group)
+      rli->dep_trx_lookup.clear();
     if (!to_add->finalized())
     {
       for (const auto& key : rli->keys_accessed_by_group)
@@ -3451,9 +3455,16 @@ Log_event::handle_terminal_dep_event(Relay_log_info *rli,
         rli->dep_key_lookup[key]= to_add;
         to_add->keys.insert(key);
       }
+      if (rli->dep_sequence_number)
+        rli->dep_trx_lookup[rli->dep_sequence_number]= to_add;
     }
     mysql_mutex_unlock(&rli->dep_key_lookup_mutex);
 
+    rli->dep_last_sequence_number= rli->dep_sequence_number;
+    rli->dep_last_group_keyed= !rli->dep_sequence_number;
+    rli->dep_last_committed= rli->dep_sequence_number= 0;
+    rli->dep_writeset_deps_added= false;
+
     // update rli state
     rli->table_map_events.clear();
     rli->dbs_accessed_by_group.clear();
@@ -12311,6 +12322,14 @@ void Rows_log_event::prepare_dep(Relay_log_info *rli,
   DBUG_ASSERT(rli->prev_event != NULL);
   DBUG_ASSERT(rli->table_map_events.count(get_table_id()));
 
+  // case: the previous group was scheduled using its writeset dependency,
+  // the trxs in flight are not tracked in the key lookup, so this group needs
+  // to be executed in isolation
+  if (!rli->dep_sequence_number && rli->dep_last_sequence_number)
+  {
+    rli->dep_sync_group= true;
+  }
+
   // case: this group will be synced, so we don't need to parse and store keys
   if (rli->dep_sync_group)
   {
@@ -12330,6 +12349,32 @@ void Rows_log_event::prepare_dep(Relay_log_info *rli,
   m_table_name= full_table_name;
   DBUG_ASSERT(!m_table_name.empty());
 
+  // case: the master generated a writeset dependency for this group, so we
+  // don't need to parse keys, the group only needs to wait for the trxs with
+  // sequence numbers up to last_committed
+  if (rli->dep_sequence_number)
+  {
+    if (!rli->dep_writeset_deps_added)
+    {
+      mysql_mutex_lock(&rli->dep_key_lookup_mutex);
+      auto it= rli->dep_trx_lookup.begin();
+      while (it != rli->dep_trx_lookup.end() &&
+             it->first <= rli->dep_last_committed)
+      {
+        if (it->second->finalized())
+        {
+          it= rli->dep_trx_lookup.erase(it);
+          continue;
+        }
+        it->second->add_dependent(ev);
+        ++it;
+      }
+      mysql_mutex_unlock(&rli->dep_key_lookup_mutex);
+      rli->dep_writeset_deps_added= true;
+    }
+    DBUG_VOID_RETURN;
+  }
+
   // case: something went wrong while finding keys for this event, switch to
   // sync mode!
   if (unlikely(
@@ -15951,6 +15996,18 @@ uint64_t Metadata_log_event::get_prev_hlc_time()
   return prev_hlc_time_ns_;
 }
 
+void Metadata_log_event::set_writeset_dependency(uint64_t last_committed,
+                                                 uint64_t sequence_number)
+{
+  last_committed_= last_committed;
+  sequence_number_= sequence_number;
+  set_exist(Metadata_log_event_types::WRITESET_DEPENDENCY_TYPE);
+
+  // Update the size of the event when it gets serialized into the stream.
+  size_ += (ENCODED_TYPE_SIZE + ENCODED_LENGTH_SIZE +
+            ENCODED_WRITESET_DEPENDENCY_SIZE);
+}
+
 uint Metadata_log_event::read_type(
     Metadata_log_event_types type, char const* buffer)
 {
@@ -15972,6 +16029,12 @@ uint Metadata_log_event::read_type(
       DBUG_ASSERT(value_length == 8);
       set_prev_hlc_time(uint8korr(buffer + ENCODED_LENGTH_SIZE));
       break;
+    case MLET::WRITESET_DEPENDENCY_TYPE:
+      // last_committed and sequence_number are 8 byte numerical fields
+      DBUG_ASSERT(value_length == ENCODED_WRITESET_DEPENDENCY_SIZE);
+      set_writeset_dependency(uint8korr(buffer + ENCODED_LENGTH_SIZE),
+                              uint8korr(buffer + ENCODED_LENGTH_SIZE + 8));
+      break;
     default:
       // This is a event which we do not know about. Just skip this
       // NO_LINT_DEBUG
@@ -16000,6 +16063,9 @@ bool Metadata_log_event::write_data_body(IO_CACHE *file)
   if (write_prev_hlc_time(file))
     DBUG_RETURN(1);
 
+  if (write_writeset_dependency(file))
+    DBUG_RETURN(1);
+
   DBUG_RETURN(0);
 }
 
@@ -16057,6 +16123,35 @@ bool Metadata_log_event::write_prev_hlc_time(IO_CACHE* file)
   DBUG_RETURN(ret);
 }
 
+bool Metadata_log_event::write_writeset_dependency(IO_CACHE* file)
+{
+  DBUG_ENTER("Metadata_log_event::write_writeset_dependency");
+
+  if (!does_exist(Metadata_log_event_types::WRITESET_DEPENDENCY_TYPE))
+    DBUG_RETURN(0); /* No need to write writeset dependency */
+
+  char buffer[ENCODED_WRITESET_DEPENDENCY_SIZE];
+  char* ptr_buffer= buffer;
+
+  if (write_type_and_length(
+        file,
+        Metadata_log_event_types::WRITESET_DEPENDENCY_TYPE,
+        ENCODED_WRITESET_DEPENDENCY_SIZE))
+  {
+    DBUG_RETURN(1);
+  }
+
+  int8store(ptr_buffer, last_committed_);
+  ptr_buffer+= sizeof(last_committed_);
+  int8store(ptr_buffer, sequence_number_);
+  ptr_buffer+= sizeof(sequence_number_);
+
+  DBUG_ASSERT(ptr_buffer == (buffer + sizeof(buffer)));
+
+  bool ret= wrapper_my_b_safe_write(file, (uchar *) buffer, sizeof(buffer));
+  DBUG_RETURN(ret);
+}
+
 bool Metadata_log_event::write_type_and_length(
     IO_CACHE* file, Metadata_log_event_types type, uint32_t length)
 {
@@ -16117,6 +16212,16 @@ int Metadata_log_event::pack_info(Protocol *protocol)
     buffer.append(std::to_string(prev_hlc_time_ns_));
   }
 
+  if (does_exist(Metadata_log_event_types::WRITESET_DEPENDENCY_TYPE))
+  {
+    if (buffer.length() > 0)
+      buffer.append(" ");
+    buffer.append("last_committed: ");
+    buffer.append(std::to_string(last_committed_));
+    buffer.append(" sequence_number: ");
+    buffer.append(std::to_string(sequence_number_));
+  }
+
   if (buffer.length() > 0)
     protocol->store(buffer.c_str(), buffer.length(), &my_charset_bin);
 
@@ -16140,6 +16245,9 @@ Metadata_log_event::print(FILE *file, PRINT_EVENT_INFO *print_event_info)
       buffer.append("\tHLC time: " + std::to_string(hlc_time_ns_));
     if (does_exist(Metadata_log_event_types::PREV_HLC_TYPE))
       buffer.append("\tPrev HLC time: " + std::to_string(prev_hlc_time_ns_));
+    if (does_exist(Metadata_log_event_types::WRITESET_DEPENDENCY_TYPE))
+      buffer.append("\tlast_committed=" + std::to_string(last_committed_) +
+                    "\tsequence_number=" + std::to_string(sequence_number_));
 
     print_header(head, print_event_info, FALSE);
     my_b_printf(head, "%s\n", buffer.c_str());
@@ -16151,6 +16259,41 @@ Metadata_log_event::print(FILE *file, PRINT_EVENT_INFO *print_event_info)
 #endif
 
 #if defined(MYSQL_SERVER) && defined(HAVE_REPLICATION)
+/**
+  Stashes the writeset dependency generated by the master for the current
+  group so that @Rows_log_event::prepare_dep can schedule the group without
+  extracting keys from the rows events.
+*/
+void Metadata_log_event::prepare_dep(Relay_log_info *rli,
+                                     std::shared_ptr<Log_event_wrapper> &ev)
+{
+  DBUG_ENTER("Metadata_log_event::prepare_dep");
+
+  Log_event::prepare_dep(rli, ev);
+
+  if (!does_exist(Metadata_log_event_types::WRITESET_DEPENDENCY_TYPE) ||
+      !ev->begin_event())
+  {
+    DBUG_VOID_RETURN;
+  }
+
+  // case: the previous group was scheduled using keys or the sequence numbers
+  // went back (new binlog file or new master), so the dependency cannot be
+  // trusted relative to the trxs in flight, let's execute this group in
+  // isolation and start afresh
+  if (rli->dep_last_group_keyed ||
+      sequence_number_ <= rli->dep_last_sequence_number ||
+      last_committed_ >= sequence_number_)
+  {
+    rli->dep_sync_group= true;
+  }
+
+  rli->dep_last_committed= last_committed_;
+  rli->dep_sequence_number= sequence_number_;
+
+  DBUG_VOID_RETURN;
+}
+
 int Metadata_log_event::do_apply_event(Relay_log_info const *rli)
 {
   DBUG_ENTER("Metadata_log_event::do_apply_event");
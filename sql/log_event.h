@@ -1620,6 +1620,7 @@ private:
   void handle_terminal_dep_event(Relay_log_info *rli,
                                  std::shared_ptr<Log_event_wrapper> &ev);
 
+protected:
   /**
      Called by @schedule_dep to prepare a dependency event
   */
@@ -5342,6 +5343,8 @@ public:
 
 
 #if defined(MYSQL_SERVER) && defined(HAVE_REPLICATION)
+  void prepare_dep(Relay_log_info *rli,
+                   std::shared_ptr<Log_event_wrapper> &ev);
   int do_apply_event(Relay_log_info const *rli);
   int do_update_pos(Relay_log_info *rli);
   enum_skip_reason do_shall_skip(Relay_log_info*);
@@ -5379,6 +5382,32 @@ public:
    */
   uint64_t get_prev_hlc_time();
 
+  /**
+   * Set the writeset based dependency information computed on the master
+   * during the binlog flush stage and update internal state needed later to
+   * write this to stream
+   *
+   * @param last_committed  - sequence number of the last transaction this
+   *                          transaction conflicts with
+   * @param sequence_number - sequence number of this transaction
+   */
+  void set_writeset_dependency(uint64_t last_committed,
+                               uint64_t sequence_number);
+
+  /**
+   * Get last_committed
+   *
+   * @return last_committed if present. 0 otherwise
+   */
+  uint64_t get_last_committed() const { return last_committed_; }
+
+  /**
+   * Get sequence_number
+   *
+   * @return sequence_number if present. 0 otherwise
+   */
+  uint64_t get_sequence_number() const { return sequence_number_; }
+
   /**
    * The spec for different 'types' supported by this event
    */
@@ -5397,6 +5426,11 @@ public:
     RAFT_TERM_INDEX_TYPE= 2,
     /* Config added by raft consensus plugin */
     RAFT_CONFIG_TYPE= 3,
+    /* Writeset based dependency (last_committed, sequence_number) of the
+     * transaction. This is generated in the binlog flush stage when
+     * binlog_writeset_dependency_tracking is enabled and used by dependency
+     * replication to schedule transactions without extracting row keys */
+    WRITESET_DEPENDENCY_TYPE= 4,
     METADATA_EVENT_TYPE_MAX,
   };
 
@@ -5441,6 +5475,15 @@ private:
    */
   bool write_prev_hlc_time(IO_CACHE* file);
 
+  /**
+   * Write writeset dependency (last_committed, sequence_number) to file
+   *
+   * @param file - file to write into
+   *
+   * @returns - 0 on success, 1 on false
+   */
+  bool write_writeset_dependency(IO_CACHE* file);
+
   /**
    * Write type and length to file
    *
@@ -5466,6 +5509,13 @@ private:
   uint64_t prev_hlc_time_ns_= 0;
   static const uint32_t ENCODED_PREV_HLC_SIZE= sizeof(prev_hlc_time_ns_);
 
+  /* Writeset dependency. The type corresponding to this is
+   * WRITESET_DEPENDENCY_TYPE. */
+  uint64_t last_committed_= 0;
+  uint64_t sequence_number_= 0;
+  static const uint32_t ENCODED_WRITESET_DEPENDENCY_SIZE=
+    sizeof(last_committed_) + sizeof(sequence_number_);
+
   /* Total size of this event when encoded into the stream */
   uint32_t size_= 0;
 
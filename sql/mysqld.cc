@@ -136,6 +136,7 @@
 
 #ifndef EMBEDDED_LIBRARY
 #include "srv_session.h"
+#include "sql_parse_com_rpc.h"             // rpc_multiplex_init
 #endif
 
 #ifdef HAVE_JEMALLOC
@@ -431,6 +432,9 @@ static bool volatile select_thread_in_use, signal_thread_in_use;
 volatile bool ready_to_exit;
 static my_bool opt_debugging= 0, opt_external_locking= 0, opt_console= 0;
 my_bool opt_allow_multiple_engines= 0;
+my_bool opt_part_lazy_open= 0;
+/* Number of partition handlers currently opened by ha_partition. */
+ulong open_partitions_count= 0;
 static my_bool opt_short_log_format= 0;
 static std::atomic<bool> kill_blocked_pthreads_flag(false);
 static uint wake_pthread;
@@ -640,6 +644,8 @@ ulong opt_binlog_rows_event_max_size;
 ulonglong opt_binlog_rows_event_max_rows;
 bool opt_log_only_query_comments = false;
 bool opt_binlog_trx_meta_data = false;
+bool opt_binlog_writeset_dependency_tracking = false;
+ulong opt_binlog_writeset_history_size = 25000;
 bool opt_log_column_names = false;
 const char *binlog_checksum_default= "NONE";
 ulong binlog_checksum_options;
@@ -717,10 +723,12 @@ uint slave_rows_last_search_algorithm_used;
 #endif
 ulonglong binlog_bytes_written = 0;
 ulonglong relay_log_bytes_written = 0;
+ulonglong relay_log_fsync_count = 0;
 ulong binlog_cache_size=0;
 char *enable_jemalloc_hpp;
 char *thread_nice_value = NULL;
 ulonglong  max_binlog_cache_size=0;
+ulonglong binlog_cache_stage_size= 0;
 ulong slave_max_allowed_packet= 0;
 ulong binlog_stmt_cache_size=0;
 ulonglong  max_binlog_stmt_cache_size=0;
@@ -740,9 +748,11 @@ ulong delayed_insert_errors,flush_time;
 bool flush_only_old_table_cache_entries = false;
 ulong specialflag=0;
 ulong binlog_cache_use= 0, binlog_cache_disk_use= 0;
+ulong binlog_cache_stage_use= 0;
 ulong binlog_stmt_cache_use= 0, binlog_stmt_cache_disk_use= 0;
 ulong max_connections, max_connect_errors;
 uint max_nonsuper_connections;
+uint rpc_multiplex_threads;
 ulong opt_max_running_queries, opt_max_waiting_queries;
 my_bool opt_admission_control_by_trx= 0;
 extern AC *db_ac;
@@ -803,7 +813,8 @@ ulong current_pid;
 ulong slow_launch_threads = 0;
 uint sync_binlog_period= 0, sync_relaylog_period= 0,
      sync_relayloginfo_period= 0, sync_masterinfo_period= 0,
-     opt_mts_checkpoint_period, opt_mts_checkpoint_group;
+     opt_mts_checkpoint_period, opt_mts_checkpoint_group,
+     opt_relay_log_group_sync= 0;
 ulong expire_logs_days = 0;
 ulong binlog_expire_logs_seconds= 0;
 /**
@@ -1220,6 +1231,8 @@ void add_global_thread(THD *thd)
   {
     ++global_thread_count;
     global_thread_list->insert(thd);
+    thd->status_record= thd_status_acquire();
+    thd->publish_status();
   }
   // Adding the same THD twice is an error.
   DBUG_ASSERT(!have_thread);
@@ -1257,6 +1270,11 @@ void remove_global_thread(THD *thd)
   const size_t num_erased= global_thread_list->erase(thd);
   if (num_erased == 1)
     --global_thread_count;
+  if (thd->status_record)
+  {
+    thd_status_release(thd->status_record);
+    thd->status_record= NULL;
+  }
   // Removing a THD that was never added is an error.
   DBUG_ASSERT(1 == num_erased);
 
@@ -2312,6 +2330,7 @@ void clean_up(bool print_message)
     return; /* purecov: inspected */
 
 #ifndef EMBEDDED_LIBRARY
+    rpc_multiplex_deinit();
     Srv_session::module_deinit();
 #endif
 
@@ -2383,6 +2402,7 @@ void clean_up(bool print_message)
   bitmap_free(&temp_pool);
   free_global_table_stats();
   free_global_db_stats();
+  thd_status_free();
   free_max_user_conn();
 #ifndef NO_EMBEDDED_ACCESS_CHECKS
   free_aux_user_table_stats();
@@ -7657,6 +7677,9 @@ int mysqld_main(int argc, char **argv)
 
   create_shutdown_thread();
   start_handle_manager();
+#ifndef EMBEDDED_LIBRARY
+  rpc_multiplex_init();
+#endif
 
   // NO_LINT_DEBUG
   sql_print_information(ER_DEFAULT(ER_GIT_HASH), "MySQL", git_hash, git_date);
@@ -10550,6 +10573,7 @@ SHOW_VAR status_vars[]= {
   {"Last_evicted_page_age",    (char*) &last_evicted_page_age,  SHOW_LONG},
   {"Binlog_bytes_written",     (char*) &binlog_bytes_written,   SHOW_LONGLONG},
   {"Binlog_cache_disk_use",    (char*) &binlog_cache_disk_use,  SHOW_LONG},
+  {"Binlog_cache_stage_use",   (char*) &binlog_cache_stage_use, SHOW_LONG},
   {"Binlog_cache_use",         (char*) &binlog_cache_use,       SHOW_LONG},
   {"Binlog_fsync_count",       (char*) &binlog_fsync_count, SHOW_LONGLONG},
   {"Binlog_stmt_cache_disk_use",(char*) &binlog_stmt_cache_disk_use,  SHOW_LONG},
@@ -10654,6 +10678,7 @@ SHOW_VAR status_vars[]= {
   {"Non_super_connections",    (char*) &nonsuper_connections,   SHOW_INT},
   {"Not_flushed_delayed_rows", (char*) &delayed_rows_in_use,    SHOW_LONG_NOFLUSH},
   {"Open_files",               (char*) &my_file_opened,         SHOW_LONG_NOFLUSH},
+  {"Open_partitions",          (char*) &open_partitions_count,  SHOW_LONG_NOFLUSH},
   {"Open_streams",             (char*) &my_stream_opened,       SHOW_LONG_NOFLUSH},
   {"Open_table_definitions",   (char*) &show_table_definitions, SHOW_FUNC},
   {"Open_tables",              (char*) &show_open_tables,       SHOW_FUNC},
@@ -10681,6 +10706,7 @@ SHOW_VAR status_vars[]= {
   {"Read_requests",            (char*) offsetof(STATUS_VAR, read_requests), SHOW_LONG_STATUS},
   {"Read_seconds",             (char*) offsetof(STATUS_VAR, read_time), SHOW_TIMER_STATUS},
   {"Relay_log_bytes_written",  (char*) &relay_log_bytes_written, SHOW_LONGLONG},
+  {"Relay_log_fsync_count",    (char*) &relay_log_fsync_count, SHOW_LONGLONG},
   {"Relay_log_io_connected",   (char*) &relay_io_connected, SHOW_LONG},
   {"Relay_log_io_events",      (char*) &relay_io_events, SHOW_LONG},
   {"Relay_log_io_bytes",       (char*) &relay_io_bytes, SHOW_LONGLONG},
@@ -11046,8 +11072,10 @@ static int mysql_init_variables(void)
   specialflag= 0;
   binlog_bytes_written= 0;
   binlog_cache_use=  binlog_cache_disk_use= 0;
+  binlog_cache_stage_use= 0;
   binlog_fsync_count= 0;
   relay_log_bytes_written= 0;
+  relay_log_fsync_count= 0;
   max_used_connections= slow_launch_threads = 0;
   mysqld_user= mysqld_chroot= opt_init_file= opt_bin_logname = 0;
   prepared_stmt_count= 0;
@@ -11647,6 +11675,7 @@ mysql_getopt_value(const char *keyname, uint key_length,
   case OPT_KEY_CACHE_BLOCK_SIZE:
   case OPT_KEY_CACHE_DIVISION_LIMIT:
   case OPT_KEY_CACHE_AGE_THRESHOLD:
+  case OPT_KEY_CACHE_PARTITIONS:
   {
     KEY_CACHE *key_cache;
     if (!(key_cache= get_or_create_key_cache(keyname, key_length)))
@@ -11664,6 +11693,8 @@ mysql_getopt_value(const char *keyname, uint key_length,
       return &key_cache->param_division_limit;
     case OPT_KEY_CACHE_AGE_THRESHOLD:
       return &key_cache->param_age_threshold;
+    case OPT_KEY_CACHE_PARTITIONS:
+      return &key_cache->param_partitions;
     }
   }
   }
@@ -12546,6 +12577,7 @@ PSI_mutex_key key_BINLOG_LOCK_sync_queue;
 PSI_mutex_key key_BINLOG_LOCK_xids;
 PSI_mutex_key key_BINLOG_LOCK_binlog_end_pos;
 PSI_mutex_key key_commit_order_manager_mutex;
+PSI_mutex_key key_load_data_parallel_mutex;
 PSI_mutex_key
   key_delayed_insert_mutex, key_hash_filo_lock, key_LOCK_active_mi,
   key_LOCK_connection_count, key_LOCK_crypt, key_LOCK_delayed_create,
@@ -12629,6 +12661,7 @@ static PSI_mutex_info all_server_mutexes[]=
   { &key_BINLOG_LOCK_xids, "MYSQL_BIN_LOG::LOCK_xids", 0 },
   { &key_BINLOG_LOCK_binlog_end_pos, "MYSQL_BIN_LOG::LOCK_binlog_end_pos", 0 },
   { &key_commit_order_manager_mutex, "Commit_order_manager::m_mutex", 0 },
+  { &key_load_data_parallel_mutex, "Load_data_parallel::m_mutex", 0 },
   { &key_RELAYLOG_LOCK_commit, "MYSQL_RELAY_LOG::LOCK_commit", 0},
   { &key_RELAYLOG_LOCK_commit_queue, "MYSQL_RELAY_LOG::LOCK_commit_queue", 0 },
   { &key_RELAYLOG_LOCK_done, "MYSQL_RELAY_LOG::LOCK_done", 0 },
@@ -12770,6 +12803,7 @@ PSI_cond_key key_BINLOG_prep_xids_cond;
 PSI_cond_key key_RELAYLOG_prep_xids_cond;
 PSI_cond_key key_gtid_ensure_index_cond;
 PSI_cond_key key_commit_order_manager_cond;
+PSI_cond_key key_load_data_parallel_cond;
 
 static PSI_cond_info all_server_conds[]=
 {
@@ -12818,12 +12852,14 @@ static PSI_cond_info all_server_conds[]=
   { &key_gtid_info_start_cond, "Gtid_info::start_cond", 0},
   { &key_gtid_info_stop_cond, "Gtid_info::stop_cond", 0},
   { &key_gtid_info_sleep_cond, "Gtid_info::sleep_cond", 0},
-  { &key_commit_order_manager_cond, "Commit_order_manager::m_workers.cond", 0}
+  { &key_commit_order_manager_cond, "Commit_order_manager::m_workers.cond", 0},
+  { &key_load_data_parallel_cond, "Load_data_parallel::m_cond", 0}
 };
 
 PSI_thread_key key_thread_bootstrap, key_thread_delayed_insert,
   key_thread_handle_manager, key_thread_main,
-  key_thread_one_connection, key_thread_signal_hand;
+  key_thread_one_connection, key_thread_signal_hand,
+  key_thread_load_data_parse, key_thread_rpc_worker;
 
 #ifdef HAVE_MY_TIMER
 PSI_thread_key key_thread_timer_notifier;
@@ -12856,7 +12892,9 @@ static PSI_thread_info all_server_threads[]=
   { &key_thread_handle_manager, "manager", PSI_FLAG_GLOBAL},
   { &key_thread_main, "main", PSI_FLAG_GLOBAL},
   { &key_thread_one_connection, "one_connection", 0},
-  { &key_thread_signal_hand, "signal_handler", PSI_FLAG_GLOBAL}
+  { &key_thread_signal_hand, "signal_handler", PSI_FLAG_GLOBAL},
+  { &key_thread_load_data_parse, "load_data_parse", 0},
+  { &key_thread_rpc_worker, "rpc_worker", 0}
 };
 
 #ifdef HAVE_MMAP
@@ -283,6 +283,8 @@ extern bool opt_improved_dup_key_error;
 extern my_bool opt_log, opt_slow_log, opt_log_raw;
 extern char* opt_gap_lock_logname;
 extern my_bool opt_allow_multiple_engines;
+extern my_bool opt_part_lazy_open;
+extern ulong open_partitions_count;
 extern my_bool opt_backup_history_log;
 extern my_bool opt_backup_progress_log;
 extern ulonglong log_output_options;
@@ -365,7 +367,8 @@ extern my_bool relay_log_recovery;
 extern ulong binlog_expire_logs_seconds;
 extern uint sync_binlog_period, sync_relaylog_period,
             sync_relayloginfo_period, sync_masterinfo_period,
-            opt_mts_checkpoint_period, opt_mts_checkpoint_group;
+            opt_mts_checkpoint_period, opt_mts_checkpoint_group,
+            opt_relay_log_group_sync;
 extern ulong opt_tc_log_size, tc_log_max_pages_used, tc_log_page_size;
 extern ulong tc_log_page_waits;
 extern my_bool relay_log_purge, opt_innodb_safe_binlog, opt_innodb;
@@ -881,9 +884,11 @@ extern my_thread_id thread_id_counter;
 extern std::atomic<uint64_t> total_thread_ids;
 extern const my_thread_id reserved_thread_id;
 extern ulong binlog_cache_use, binlog_cache_disk_use;
+extern ulong binlog_cache_stage_use;
 extern ulong binlog_stmt_cache_use, binlog_stmt_cache_disk_use;
 extern ulonglong binlog_bytes_written;
 extern ulonglong relay_log_bytes_written;
+extern ulonglong relay_log_fsync_count;
 extern ulong aborted_threads,aborted_connects;
 extern ulong delayed_insert_timeout;
 extern ulong delayed_insert_limit, delayed_queue_size;
@@ -917,6 +922,7 @@ extern double opt_mts_imbalance_threshold;
 extern ulonglong opt_mts_pending_jobs_size_max;
 extern uint max_user_connections;
 extern uint max_nonsuper_connections;
+extern uint rpc_multiplex_threads;
 extern ulong rpl_stop_slave_timeout;
 extern my_bool rpl_skip_tx_api;
 extern my_bool log_bin_use_v1_row_events;
@@ -926,12 +932,15 @@ extern ulong max_prepared_stmt_count, prepared_stmt_count;
 extern ulong open_files_limit;
 extern ulong binlog_cache_size, binlog_stmt_cache_size;
 extern ulonglong max_binlog_cache_size, max_binlog_stmt_cache_size;
+extern ulonglong binlog_cache_stage_size;
 extern ulong max_binlog_size, max_relay_log_size;
 extern ulong slave_max_allowed_packet;
 extern ulong opt_binlog_rows_event_max_size;
 extern ulonglong opt_binlog_rows_event_max_rows;
 extern bool opt_log_only_query_comments;
 extern bool opt_binlog_trx_meta_data;
+extern bool opt_binlog_writeset_dependency_tracking;
+extern ulong opt_binlog_writeset_history_size;
 extern bool opt_log_column_names;
 extern ulong binlog_checksum_options;
 extern const char *binlog_checksum_type_names[];
@@ -1151,6 +1160,7 @@ extern PSI_mutex_key key_BINLOG_LOCK_sync_queue;
 extern PSI_mutex_key key_BINLOG_LOCK_xids;
 extern PSI_mutex_key key_BINLOG_LOCK_binlog_end_pos;
 extern PSI_mutex_key key_commit_order_manager_mutex;
+extern PSI_mutex_key key_load_data_parallel_mutex;
 extern PSI_mutex_key
   key_delayed_insert_mutex, key_hash_filo_lock, key_LOCK_active_mi,
   key_LOCK_connection_count, key_LOCK_crypt, key_LOCK_delayed_create,
@@ -1237,10 +1247,12 @@ extern PSI_cond_key key_BINLOG_prep_xids_cond;
 extern PSI_cond_key key_RELAYLOG_prep_xids_cond;
 extern PSI_cond_key key_gtid_ensure_index_cond;
 extern PSI_cond_key key_commit_order_manager_cond;
+extern PSI_cond_key key_load_data_parallel_cond;
 
 extern PSI_thread_key key_thread_bootstrap, key_thread_delayed_insert,
   key_thread_handle_manager, key_thread_kill_server, key_thread_main,
-  key_thread_one_connection, key_thread_signal_hand;
+  key_thread_one_connection, key_thread_signal_hand,
+  key_thread_load_data_parse, key_thread_rpc_worker;
 
 #ifdef HAVE_MMAP
 extern PSI_file_key key_file_map;
@@ -1505,6 +1517,7 @@ enum options_mysqld
   OPT_KEY_CACHE_AGE_THRESHOLD,
   OPT_KEY_CACHE_BLOCK_SIZE,
   OPT_KEY_CACHE_DIVISION_LIMIT,
+  OPT_KEY_CACHE_PARTITIONS,
   OPT_LC_MESSAGES_DIRECTORY,
   OPT_LOWER_CASE_TABLE_NAMES,
   OPT_MASTER_RETRY_COUNT,
@@ -933,9 +933,7 @@ public:
   enum_return_status _add_gtid(rpl_sidno sidno, rpl_gno gno)
   {
     DBUG_ENTER("Gtid_set::_add_gtid(sidno, gno)");
-    Interval_iterator ivit(this, sidno);
-    Free_intervals_lock lock(this);
-    enum_return_status ret= add_gno_interval(&ivit, gno, gno + 1, &lock);
+    enum_return_status ret= add_gno_interval(sidno, gno, gno + 1);
     DBUG_RETURN(ret);
   }
   /**
@@ -950,9 +948,7 @@ public:
     DBUG_ENTER("Gtid_set::_remove_gtid(rpl_sidno, rpl_gno)");
     if (sidno <= get_max_sidno())
     {
-      Interval_iterator ivit(this, sidno);
-      Free_intervals_lock lock(this);
-      enum_return_status ret= remove_gno_interval(&ivit, gno, gno + 1, &lock);
+      enum_return_status ret= remove_gno_interval(sidno, gno, gno + 1);
       DBUG_RETURN(ret);
     }
     RETURN_OK;
@@ -1116,8 +1112,7 @@ public:
     DBUG_ASSERT(sidno >= 1);
     if (sidno > get_max_sidno())
       return false;
-    Const_interval_iterator ivit(this, sidno);
-    return ivit.get() != NULL;
+    return get_interval_array(sidno)->count > 0;
   }
   /**
     Returns true if the given string is a valid specification of a
@@ -1237,7 +1232,7 @@ public:
   Sid_map *get_sid_map() const { return sid_map; }
 
   /**
-    Represents one element in the linked list of intervals associated
+    Represents one element in the sorted array of intervals associated
     with a SIDNO.
   */
   struct Interval
@@ -1252,27 +1247,25 @@ public:
     {
       return start == other.start && end == other.end;
     }
-    /// Pointer to next interval in list.
-    Interval *next;
   };
 
   /**
-    Provides an array of Intervals that this Gtid_set can use when
-    groups are subsequently added.  This can be used as an
-    optimization, to reduce allocation for sets that have a known
-    number of intervals.
+    The intervals of one SIDNO.
 
-    @param n_intervals The number of intervals to add.
-    @param intervals Array of n_intervals intervals.
+    The intervals are kept in a contiguous array, sorted by start, and
+    no two intervals overlap or touch.  This makes membership tests a
+    binary search and lets set operations merge two arrays in a single
+    linear pass, instead of chasing pointers through a linked list.
   */
-  void add_interval_memory(int n_intervals, Interval *intervals_param)
+  struct Interval_array
   {
-    if (sid_lock != NULL)
-      mysql_mutex_lock(&free_intervals_mutex);
-    add_interval_memory_lock_taken(n_intervals, intervals_param);
-    if (sid_lock != NULL)
-      mysql_mutex_unlock(&free_intervals_mutex);
-  }
+    /// The intervals, allocated with my_malloc; NULL if capacity is 0.
+    Interval *ivs;
+    /// The number of intervals in use.
+    int count;
+    /// The number of intervals allocated.
+    int capacity;
+  };
 
 
   /**
@@ -1281,11 +1274,11 @@ public:
     This is an abstract template class, used as a common base class
     for Const_interval_iterator and Interval_iterator.
 
-    The iterator always points to an interval pointer.  The interval
-    pointer is either the initial pointer into the list, or the next
-    pointer of one of the intervals in the list.
+    The iterator holds the interval array of the SIDNO and the index
+    of the current interval in it.
   */
-  template<typename Gtid_set_p, typename Interval_p> class Interval_iterator_base
+  template<typename Gtid_set_p, typename Interval_p,
+           typename Interval_array_p> class Interval_iterator_base
   {
   public:
     /**
@@ -1299,82 +1292,63 @@ public:
       DBUG_ASSERT(sidno >= 1 && sidno <= gtid_set->get_max_sidno());
       init(gtid_set, sidno);
     }
-    /// Construct a new iterator over the free intervals of a Gtid_set.
-    Interval_iterator_base(Gtid_set_p gtid_set)
-    { p= const_cast<Interval_p *>(&gtid_set->free_intervals); }
+    /// Construct an iterator that is positioned at no interval.
+    Interval_iterator_base(Gtid_set_p gtid_set) : arr(NULL), pos(0) {}
     /// Reset this iterator.
     inline void init(Gtid_set_p gtid_set, rpl_sidno sidno)
-    { p= dynamic_element(&gtid_set->intervals, sidno - 1, Interval_p *); }
+    {
+      arr= gtid_set->get_interval_array(sidno);
+      pos= 0;
+    }
     /// Advance current_elem one step.
     inline void next()
     {
-      DBUG_ASSERT(*p != NULL);
-      p= const_cast<Interval_p *>(&(*p)->next);
+      DBUG_ASSERT(get() != NULL);
+      pos++;
     }
     /// Return current_elem.
-    inline Interval_p get() const { return *p; }
+    inline Interval_p get() const
+    { return arr != NULL && pos < arr->count ? arr->ivs + pos : NULL; }
   protected:
-    /**
-      Holds the address of the 'next' pointer of the previous element,
-      or the address of the initial pointer into the list, if the
-      current element is the first element.
-    */
-    Interval_p *p;
+    /// The intervals of the SIDNO, or NULL.
+    Interval_array_p arr;
+    /// Index of the current element in arr.
+    int pos;
   };
 
   /**
     Iterator over intervals of a const Gtid_set.
   */
   class Const_interval_iterator
-    : public Interval_iterator_base<const Gtid_set *, const Interval *>
+    : public Interval_iterator_base<const Gtid_set *, const Interval *,
+                                    const Interval_array *>
   {
   public:
     /// Create this Const_interval_iterator.
     Const_interval_iterator(const Gtid_set *gtid_set, rpl_sidno sidno)
-      : Interval_iterator_base<const Gtid_set *, const Interval *>(gtid_set, sidno) {}
+      : Interval_iterator_base<const Gtid_set *, const Interval *,
+                               const Interval_array *>(gtid_set, sidno) {}
     /// Create this Const_interval_iterator.
     Const_interval_iterator(const Gtid_set *gtid_set)
-      : Interval_iterator_base<const Gtid_set *, const Interval *>(gtid_set) {}
+      : Interval_iterator_base<const Gtid_set *, const Interval *,
+                               const Interval_array *>(gtid_set) {}
   };
 
   /**
-    Iterator over intervals of a non-const Gtid_set, with additional
-    methods to modify the Gtid_set.
+    Iterator over intervals of a non-const Gtid_set.
   */
   class Interval_iterator
-    : public Interval_iterator_base<Gtid_set *, Interval *>
+    : public Interval_iterator_base<Gtid_set *, Interval *, Interval_array *>
   {
   public:
     /// Create this Interval_iterator.
     Interval_iterator(Gtid_set *gtid_set, rpl_sidno sidno)
-      : Interval_iterator_base<Gtid_set *, Interval *>(gtid_set, sidno) {}
-    /// Destroy this Interval_iterator.
+      : Interval_iterator_base<Gtid_set *, Interval *,
+                               Interval_array *>(gtid_set, sidno) {}
+    /// Create this Interval_iterator.
     Interval_iterator(Gtid_set *gtid_set)
-      : Interval_iterator_base<Gtid_set *, Interval *>(gtid_set) {}
-  private:
-    /**
-      Set current_elem to the given Interval but do not touch the
-      next pointer of the given Interval.
-    */
-    inline void set(Interval *iv) { *p= iv; }
-    /// Insert the given element before current_elem.
-    inline void insert(Interval *iv) { iv->next= *p; set(iv); }
-    /// Remove current_elem.
-    inline void remove(Gtid_set *gtid_set)
-    {
-      DBUG_ASSERT(get() != NULL);
-      Interval *next= (*p)->next;
-      gtid_set->put_free_interval(*p);
-      set(next);
-    }
-    /**
-      Only Gtid_set is allowed to use set/insert/remove.
-
-      They are not safe to use from other code because: (1) very easy
-      to make a mistakes (2) they don't clear cached_string_format or
-      cached_string_length.
-    */
-    friend class Gtid_set;
+      : Interval_iterator_base<Gtid_set *, Interval *,
+                               Interval_array *>(gtid_set) {}
   };
 
 
@@ -1474,19 +1448,8 @@ public:
   size_t get_encoded_length() const;
 
 private:
-  /**
-    Contains a list of intervals allocated by this Gtid_set.  When a
-    method of this class needs a new interval and there are no more
-    free intervals, a new Interval_chunk is allocated and the
-    intervals of it are added to the list of free intervals.
-  */
-  struct Interval_chunk
-  {
-    Interval_chunk *next;
-    Interval intervals[1];
-  };
-  /// The default number of intervals in an Interval_chunk.
-  static const int CHUNK_GROW_SIZE= 8;
+  /// The minimal number of intervals allocated for a SIDNO.
+  static const int INTERVAL_ARRAY_MIN_SIZE= 8;
 
 /*
   Functions sidno_equals() and equals() are only used by unitests
@@ -1507,18 +1470,15 @@ private:
   bool equals(const Gtid_set *other) const;
 #endif
 
+  /// Return the intervals of the given sidno.
+  Interval_array *get_interval_array(rpl_sidno sidno)
+  { return dynamic_element(&intervals, sidno - 1, Interval_array *); }
+  /// Return the intervals of the given sidno.
+  const Interval_array *get_interval_array(rpl_sidno sidno) const
+  { return dynamic_element(&intervals, sidno - 1, const Interval_array *); }
   /// Return the number of intervals for the given sidno.
   int get_n_intervals(rpl_sidno sidno) const
-  {
-    Const_interval_iterator ivit(this, sidno);
-    int ret= 0;
-    while (ivit.get() != NULL)
-    {
-      ret++;
-      ivit.next();
-    }
-    return ret;
-  }
+  { return get_interval_array(sidno)->count; }
   /// Return the number of intervals in this Gtid_set.
   int get_n_intervals() const
   {
@@ -1531,218 +1491,131 @@ private:
     return ret;
   }
   /**
-    Allocates a new chunk of Intervals and adds them to the list of
-    unused intervals.
+    Grows the given interval array so that it has space for at least
+    n intervals.  The capacity is at least doubled, so that appending
+    intervals one at a time takes amortized constant time.
 
-    @param size The number of intervals in this chunk
+    @param arr The array to grow.
+    @param n The number of intervals needed.
     @return RETURN_STATUS_OK or RETURN_STATUS_REPORTED_ERROR.
   */
-  enum_return_status create_new_chunk(int size);
+  static enum_return_status reserve_intervals(Interval_array *arr, int n);
   /**
-    Returns a fresh new Interval object.
-
-    This usually does not require any real allocation, it only pops
-    the first interval from the list of free intervals.  If there are
-    no free intervals, it calls create_new_chunk.
-
-    @param out The resulting Interval* will be stored here.
-    @return RETURN_STATUS_OK or RETURN_STATUS_REPORTED_ERROR.
+    Returns the index of the first interval in arr that ends at or
+    after gno, i.e., the first interval that contains gno or touches
+    or follows it.  Returns arr->count if there is no such interval.
   */
-  enum_return_status get_free_interval(Interval **out);
+  static int find_interval(const Interval_array *arr, rpl_gno gno);
   /**
-    Puts the given interval in the list of free intervals.  Does not
-    unlink it from its place in any other list.
+    Replaces the intervals of arr by the n intervals in ivs, which
+    must have been allocated with my_malloc and have capacity for
+    max_n intervals.  The old intervals of arr are freed.
   */
-  void put_free_interval(Interval *iv);
-  /**
-    Like add_interval_memory, but does not acquire
-    free_intervals_mutex.
-    @see Gtid_set::add_interval_memory
-  */
-  void add_interval_memory_lock_taken(int n_ivs, Interval *ivs);
+  static void replace_intervals(Interval_array *arr, Interval *ivs, int n,
+                                int max_n);
 
   /// Read-write lock that protects updates to the number of SIDs.
   mutable Checkable_rwlock *sid_lock;
-  /**
-    Lock protecting the list of free intervals.  This lock is only
-    used if sid_lock is not NULL.
-  */
-  mysql_mutex_t free_intervals_mutex;
-  /**
-    Class representing a lock on free_intervals_mutex.
-
-    This is used by the add_* and remove_* functions.  The lock is
-    declared by the top-level function and a pointer to the lock is
-    passed down to low-level functions. If the low-level function
-    decides to access the free intervals list, then it acquires the
-    lock.  The lock is then automatically released by the destructor
-    when the top-level function returns.
-
-    The lock is not taken if Gtid_set->sid_lock == NULL; such
-    Gtid_sets are assumed to be thread-local.
-  */
-  class Free_intervals_lock
-  {
-  public:
-    /// Create a new lock, but do not acquire it.
-    Free_intervals_lock(Gtid_set *_gtid_set)
-      : gtid_set(_gtid_set), locked(false) {}
-    /// Lock the lock if it is not already locked.
-    void lock_if_not_locked()
-    {
-      if (gtid_set->sid_lock && !locked)
-      {
-        mysql_mutex_lock(&gtid_set->free_intervals_mutex);
-        locked= true;
-      }
-    }
-    /// Lock the lock if it is locked.
-    void unlock_if_locked()
-    {
-      if (gtid_set->sid_lock && locked)
-      {
-        mysql_mutex_unlock(&gtid_set->free_intervals_mutex);
-        locked= false;
-      }
-    }
-    /// Destroy this object and unlock the lock if it is locked.
-    ~Free_intervals_lock()
-    {
-      unlock_if_locked();
-    }
-  private:
-    Gtid_set *gtid_set;
-    bool locked;
-  };
-  void assert_free_intervals_locked()
-  {
-    if (sid_lock != NULL)
-      mysql_mutex_assert_owner(&free_intervals_mutex);
-  }
 
   /**
-    Adds the interval (start, end) to the given Interval_iterator.
+    Adds the interval (start, end) to the given SIDNO.
 
     This is the lowest-level function that adds groups; this is where
-    Interval objects are added, grown, or merged.
+    Interval objects are added, grown, or merged.  The position is
+    found by binary search, and appending after the last interval,
+    which is what happens when new transactions are committed, does
+    not move any other interval.
 
-    @param ivitp Pointer to iterator.  After this function returns,
-    the current_element of the iterator will be the interval that
-    contains start and end.
+    The SIDNO must exist in the Gtid_set before this function is called.
+
+    @param sidno The SIDNO to which the interval will be added.
     @param start The first GNO in the interval.
     @param end The first GNO after the interval.
-    @param lock If this function has to add or remove an interval,
-    then this lock will be taken unless it is already taken.  This
-    mechanism means that the lock will be taken lazily by
-    e.g. add_gtid_set() the first time that the list of free intervals
-    is accessed, and automatically released when add_gtid_set()
-    returns.
     @return RETURN_STATUS_OK or RETURN_STATUS_REPORTED_ERROR.
   */
-  enum_return_status add_gno_interval(Interval_iterator *ivitp,
-                                      rpl_gno start, rpl_gno end,
-                                      Free_intervals_lock *lock);
+  enum_return_status add_gno_interval(rpl_sidno sidno,
+                                      rpl_gno start, rpl_gno end);
   /**
-    Removes the interval (start, end) from the given
-    Interval_iterator. This is the lowest-level function that removes
-    groups; this is where Interval objects are removed, truncated, or
-    split.
+    Removes the interval (start, end) from the given SIDNO. This is
+    the lowest-level function that removes groups; this is where
+    Interval objects are removed, truncated, or split.
 
     It is not required that the groups in the interval exist in this
     Gtid_set.
 
-    @param ivitp Pointer to iterator.  After this function returns,
-    the current_element of the iterator will be the next interval
-    after end.
+    @param sidno The SIDNO from which the interval will be removed.
     @param start The first GNO in the interval.
     @param end The first GNO after the interval.
-    @param lock If this function has to add or remove an interval,
-    then this lock will be taken unless it is already taken.  This
-    mechanism means that the lock will be taken lazily by
-    e.g. add_gtid_set() the first time that the list of free intervals
-    is accessed, and automatically released when add_gtid_set()
-    returns.
     @return RETURN_STATUS_OK or RETURN_STATUS_REPORTED_ERROR.
   */
-  enum_return_status remove_gno_interval(Interval_iterator *ivitp,
-                                         rpl_gno start, rpl_gno end,
-                                         Free_intervals_lock *lock);
+  enum_return_status remove_gno_interval(rpl_sidno sidno,
+                                         rpl_gno start, rpl_gno end);
   /**
-    Adds a list of intervals to the given SIDNO.
+    Adds all intervals of the given array to the given SIDNO.
+
+    The two sorted arrays are merged in one linear pass into a new
+    array.  If all the intervals to add come after the existing ones,
+    they are appended in place.
 
     The SIDNO must exist in the Gtid_set before this function is called.
 
     @param sidno The SIDNO to which intervals will be added.
-    @param ivit Iterator over the intervals to add. This is typically
-    an iterator over some other Gtid_set.
-    @param lock If this function has to add or remove an interval,
-    then this lock will be taken unless it is already taken.  This
-    mechanism means that the lock will be taken lazily by
-    e.g. add_gtid_set() the first time that the list of free intervals
-    is accessed, and automatically released when add_gtid_set()
-    returns.
+    @param other The intervals to add. This is typically the interval
+    array of some other Gtid_set.
     @return RETURN_STATUS_OK or RETURN_STATUS_REPORTED_ERROR.
   */
   enum_return_status add_gno_intervals(rpl_sidno sidno,
-                                       Const_interval_iterator ivit,
-                                       Free_intervals_lock *lock);
+                                       const Interval_array *other);
   /**
-    Removes a list of intervals from the given SIDNO.
+    Removes all intervals of the given array from the given SIDNO.
 
     It is not required that the intervals exist in this Gtid_set.
+    The difference is computed in one linear pass over both arrays.
 
     @param sidno The SIDNO from which intervals will be removed.
-    @param ivit Iterator over the intervals to remove. This is typically
-    an iterator over some other Gtid_set.
-    @param lock If this function has to add or remove an interval,
-    then this lock will be taken unless it is already taken.  This
-    mechanism means that the lock will be taken lazily by
-    e.g. add_gtid_set() the first time that the list of free intervals
-    is accessed, and automatically released when add_gtid_set()
-    returns.
+    @param other The intervals to remove. This is typically the
+    interval array of some other Gtid_set.
     @return RETURN_STATUS_OK or RETURN_STATUS_REPORTED_ERROR.
   */
   enum_return_status remove_gno_intervals(rpl_sidno sidno,
-                                          Const_interval_iterator ivit,
-                                          Free_intervals_lock *lock);
+                                          const Interval_array *other);
+  /**
+    Adds the intersection of the two given arrays to the given SIDNO,
+    in one linear pass over both arrays.
+
+    @param sidno The SIDNO to which intervals will be added.
+    @param arr1 The first array.
+    @param arr2 The second array.
+    @return RETURN_STATUS_OK or RETURN_STATUS_REPORTED_ERROR.
+  */
+  enum_return_status add_interval_intersection(rpl_sidno sidno,
+                                               const Interval_array *arr1,
+                                               const Interval_array *arr2);
 
   /// Returns true if every interval of sub is a subset of some
   /// interval of super.
-  static bool is_interval_subset(Const_interval_iterator *sub,
-                                 Const_interval_iterator *super);
-  /// Returns true if at least one sidno in ivit1 is also in ivit2.
-  static bool is_interval_intersection_nonempty(Const_interval_iterator *ivit1,
-                                                Const_interval_iterator *ivit2);
+  static bool is_interval_subset(const Interval_array *sub,
+                                 const Interval_array *super);
+  /// Returns true if at least one sidno in arr1 is also in arr2.
+  static bool is_interval_intersection_nonempty(const Interval_array *arr1,
+                                                const Interval_array *arr2);
 
   /// Sid_map associated with this Gtid_set.
   Sid_map *sid_map;
   /**
-    Array where the N'th element contains the head pointer to the
-    intervals of SIDNO N+1.
+    Array where the N'th element contains the Interval_array of
+    SIDNO N+1.
   */
   DYNAMIC_ARRAY intervals;
-  /// Linked list of free intervals.
-  Interval *free_intervals;
-  /// Linked list of chunks.
-  Interval_chunk *chunks;
   /// The string length.
   mutable int cached_string_length;
   /// The String_format that was used when cached_string_length was computed.
   mutable const String_format *cached_string_format;
-#ifndef DBUG_OFF
-  /**
-    The number of chunks.  Used only to check some invariants when
-    DBUG is on.
-  */
-  int n_chunks;
-#endif
 
   /// Used by unit tests that need to access private members.
 #ifdef FRIEND_OF_GTID_SET
   friend FRIEND_OF_GTID_SET;
 #endif
-  /// Only Free_intervals_lock is allowed to access free_intervals_mutex.
-  friend class Gtid_set::Free_intervals_lock;
 };
 
 
@@ -21,7 +21,6 @@
 #include <algorithm>
 #include "my_dbug.h"
 #include "mysqld_error.h"
-#include <algorithm>
 
 using std::min;
 using std::max;
@@ -69,14 +68,7 @@ void Gtid_set::init()
   DBUG_ENTER("Gtid_set::init");
   cached_string_length= -1;
   cached_string_format= NULL;
-  chunks= NULL;
-  free_intervals= NULL;
-  my_init_dynamic_array(&intervals, sizeof(Interval *), 0, 8);
-  if (sid_lock)
-    mysql_mutex_init(0, &free_intervals_mutex, NULL);
-#ifndef DBUG_OFF
-  n_chunks= 0;
-#endif
+  my_init_dynamic_array(&intervals, sizeof(Interval_array), 0, 8);
   DBUG_VOID_RETURN;
 }
 
@@ -84,20 +76,9 @@ void Gtid_set::init()
 Gtid_set::~Gtid_set()
 {
   DBUG_ENTER("Gtid_set::~Gtid_set");
-  Interval_chunk *chunk= chunks;
-  while (chunk != NULL)
-  {
-    Interval_chunk *next_chunk= chunk->next;
-    free(chunk);
-    chunk= next_chunk;
-#ifndef DBUG_OFF
-    n_chunks--;
-#endif
-  }
-  DBUG_ASSERT(n_chunks == 0);
+  for (uint i= 0; i < intervals.elements; i++)
+    my_free(dynamic_element(&intervals, i, Interval_array *)->ivs);
   delete_dynamic(&intervals);
-  if (sid_lock)
-    mysql_mutex_destroy(&free_intervals_mutex);
   DBUG_VOID_RETURN;
 }
 
@@ -143,9 +124,9 @@ enum_return_status Gtid_set::ensure_sidno(rpl_sidno sidno)
     if (allocate_dynamic(&intervals,
                          sid_map == NULL ? sidno : sid_map->get_max_sidno()))
       goto error;
-    Interval *null_p= NULL;
+    Interval_array empty_array= { NULL, 0, 0 };
     for (rpl_sidno i= max_sidno; i < sidno; i++)
-      if (insert_dynamic(&intervals, &null_p))
+      if (insert_dynamic(&intervals, &empty_array))
         goto error;
     if (sid_lock != NULL)
     {
@@ -163,66 +144,46 @@ error:
 }
 
 
-void Gtid_set::add_interval_memory_lock_taken(int n_ivs, Interval *ivs)
+enum_return_status Gtid_set::reserve_intervals(Interval_array *arr, int n)
 {
-  DBUG_ENTER("Gtid_set::add_interval_memory");
-  assert_free_intervals_locked();
-  // make ivs a linked list
-  for (int i= 0; i < n_ivs - 1; i++)
-    ivs[i].next= &(ivs[i + 1]);
-  Interval_iterator ivit(this);
-  ivs[n_ivs - 1].next= ivit.get();
-  // add intervals to list of free intervals
-  ivit.set(&(ivs[0]));
-  DBUG_VOID_RETURN;
-}
-
-
-enum_return_status Gtid_set::create_new_chunk(int size)
-{
-  DBUG_ENTER("Gtid_set::create_new_chunk");
-  // allocate the new chunk. one element is already pre-allocated, so
-  // we only add size-1 elements to the size of the struct.
-  assert_free_intervals_locked();
-  Interval_chunk *new_chunk=
-    (Interval_chunk *)my_malloc(sizeof(Interval_chunk) +
-                                sizeof(Interval) * (size - 1),
-                                MYF(MY_WME));
-  if (new_chunk == NULL)
-    RETURN_REPORTED_ERROR;
-  // store the chunk in the list of chunks
-  new_chunk->next= chunks;
-  chunks= new_chunk;
-#ifndef DBUG_OFF
-  n_chunks++;
-#endif
-  // add the intervals in the chunk to the list of free intervals
-  add_interval_memory_lock_taken(size, new_chunk->intervals);
+  DBUG_ENTER("Gtid_set::reserve_intervals");
+  if (n > arr->capacity)
+  {
+    int capacity= max(max(n, 2 * arr->capacity), INTERVAL_ARRAY_MIN_SIZE);
+    Interval *ivs= (Interval *)my_realloc(arr->ivs, capacity * sizeof(Interval),
+                                          MYF(MY_WME | MY_ALLOW_ZERO_PTR));
+    if (ivs == NULL)
+      RETURN_REPORTED_ERROR;
+    arr->ivs= ivs;
+    arr->capacity= capacity;
+  }
   RETURN_OK;
 }
 
 
-enum_return_status Gtid_set::get_free_interval(Interval **out)
+int Gtid_set::find_interval(const Interval_array *arr, rpl_gno gno)
 {
-  DBUG_ENTER("Gtid_set::get_free_interval");
-  assert_free_intervals_locked();
-  Interval_iterator ivit(this);
-  if (ivit.get() == NULL)
-    PROPAGATE_REPORTED_ERROR(create_new_chunk(CHUNK_GROW_SIZE));
-  *out= ivit.get();
-  ivit.set((*out)->next);
-  RETURN_OK;
+  // Binary search for the first interval with end >= gno.
+  int lo= 0, hi= arr->count;
+  while (lo < hi)
+  {
+    int mid= lo + (hi - lo) / 2;
+    if (arr->ivs[mid].end < gno)
+      lo= mid + 1;
+    else
+      hi= mid;
+  }
+  return lo;
 }
 
 
-void Gtid_set::put_free_interval(Interval *iv)
+void Gtid_set::replace_intervals(Interval_array *arr, Interval *ivs, int n,
+                                 int max_n)
 {
-  DBUG_ENTER("Gtid_set::put_free_interval");
-  assert_free_intervals_locked();
-  Interval_iterator ivit(this);
-  iv->next= ivit.get();
-  ivit.set(iv);
-  DBUG_VOID_RETURN;
+  my_free(arr->ivs);
+  arr->ivs= ivs;
+  arr->count= n;
+  arr->capacity= max_n;
 }
 
 
@@ -231,28 +192,9 @@ void Gtid_set::clear()
   DBUG_ENTER("Gtid_set::clear");
   cached_string_length= -1;
   rpl_sidno max_sidno= get_max_sidno();
-  if (max_sidno == 0)
-    DBUG_VOID_RETURN;
-  Interval_iterator free_ivit(this);
+  // Keep the allocated arrays so that they can be re-used.
   for (rpl_sidno sidno= 1; sidno <= max_sidno; sidno++)
-  {
-    /*
-      Link in this list of intervals at the end of the list of
-      free intervals.
-    */
-    Interval_iterator ivit(this, sidno);
-    Interval *iv= ivit.get();
-    if (iv != NULL)
-    {
-      // find the end of the list of free intervals
-      while (free_ivit.get() != NULL)
-        free_ivit.next();
-      // append the present list
-      free_ivit.set(iv);
-      // clear the pointer to the head of this list
-      ivit.set(NULL);
-    }
-  }
+    get_interval_array(sidno)->count= 0;
   DBUG_VOID_RETURN;
 }
 
@@ -262,149 +204,111 @@ void Gtid_set::remove(const std::vector<rpl_sidno>& sidnos)
     sid_lock->assert_some_wrlock();
   cached_string_length = -1;
   rpl_sidno max_sidno = get_max_sidno();
-  if (!max_sidno)
-    return;
-  Free_intervals_lock lock(this);
-  lock.lock_if_not_locked();
   for (auto sidno: sidnos)
   {
-    if (sidno >= 1 && sidno <= max_sidno) {
-      Interval_iterator ivit(this, sidno);
-      if (ivit.get())
-        ivit.remove(this);
-    }
+    if (sidno >= 1 && sidno <= max_sidno)
+      get_interval_array(sidno)->count= 0;
   }
-  lock.unlock_if_locked();
 }
 
 enum_return_status
-Gtid_set::add_gno_interval(Interval_iterator *ivitp,
-                           rpl_gno start, rpl_gno end,
-                           Free_intervals_lock *lock)
+Gtid_set::add_gno_interval(rpl_sidno sidno, rpl_gno start, rpl_gno end)
 {
-  DBUG_ENTER("Gtid_set::add_gno_interval(Interval_iterator*, rpl_gno, rpl_gno)");
+  DBUG_ENTER("Gtid_set::add_gno_interval(rpl_sidno, rpl_gno, rpl_gno)");
   DBUG_ASSERT(start > 0);
   DBUG_ASSERT(start < end);
   DBUG_PRINT("info", ("start=%lld end=%lld", start, end));
-  Interval *iv;
-  Interval_iterator ivit= *ivitp;
+  Interval_array *arr= get_interval_array(sidno);
   cached_string_length= -1;
 
-  while ((iv= ivit.get()) != NULL)
+  // Fast path: the new interval extends or follows the last interval.
+  if (arr->count == 0 || arr->ivs[arr->count - 1].end < start)
   {
-    if (iv->end >= start)
-    {
-      if (iv->start > end)
-        // (start, end) is strictly before the current interval
-        break;
-      // (start, end) and (iv->start, iv->end) touch or intersect.
-      // Save the start of the merged interval.
-      if (iv->start < start)
-        start= iv->start;
-      // Remove the current interval as long as the new interval
-      // intersects with the next interval.
-      while (iv->next && end >= iv->next->start)
-      {
-        lock->lock_if_not_locked();
-        ivit.remove(this);
-        iv= ivit.get();
-      }
-      // Store the interval in the current interval.
-      iv->start= start;
-      if (iv->end < end)
-        iv->end= end;
-      *ivitp= ivit;
-      RETURN_OK;
-    }
-    ivit.next();
+    PROPAGATE_REPORTED_ERROR(reserve_intervals(arr, arr->count + 1));
+    arr->ivs[arr->count].start= start;
+    arr->ivs[arr->count].end= end;
+    arr->count++;
+    RETURN_OK;
   }
-  /*
-    We come here if the interval cannot be combined with any existing
-    interval: it is after the previous interval (if any) and before
-    the current interval (if any). So we allocate a new interval and
-    insert it at the current position.
-  */
-  Interval *new_iv;
-  lock->lock_if_not_locked();
-  PROPAGATE_REPORTED_ERROR(get_free_interval(&new_iv));
-  new_iv->start= start;
-  new_iv->end= end;
-  ivit.insert(new_iv);
-  *ivitp= ivit;
+
+  // i is the first interval that touches or follows (start, end).
+  int i= find_interval(arr, start);
+  // j is the first interval after i that is strictly after (start, end).
+  int j= i;
+  while (j < arr->count && arr->ivs[j].start <= end)
+    j++;
+
+  if (i == j)
+  {
+    /*
+      The interval cannot be combined with any existing interval: it
+      is after interval i-1 (if any) and before interval i (if any).
+      So we insert a new interval at position i.
+    */
+    PROPAGATE_REPORTED_ERROR(reserve_intervals(arr, arr->count + 1));
+    memmove(arr->ivs + i + 1, arr->ivs + i,
+            (arr->count - i) * sizeof(Interval));
+    arr->ivs[i].start= start;
+    arr->ivs[i].end= end;
+    arr->count++;
+    RETURN_OK;
+  }
+
+  // (start, end) touches or intersects intervals i..j-1: merge them
+  // into interval i and remove the rest.
+  arr->ivs[i].start= min(arr->ivs[i].start, start);
+  arr->ivs[i].end= max(arr->ivs[j - 1].end, end);
+  memmove(arr->ivs + i + 1, arr->ivs + j,
+          (arr->count - j) * sizeof(Interval));
+  arr->count-= j - i - 1;
   RETURN_OK;
 }
 
 
-enum_return_status Gtid_set::remove_gno_interval(Interval_iterator *ivitp,
-                                                 rpl_gno start, rpl_gno end,
-                                                 Free_intervals_lock *lock)
+enum_return_status
+Gtid_set::remove_gno_interval(rpl_sidno sidno, rpl_gno start, rpl_gno end)
 {
-  DBUG_ENTER("Gtid_set::remove_gno_interval(Interval_iterator *ivitp, rpl_gno start, rpl_gno end)");
+  DBUG_ENTER("Gtid_set::remove_gno_interval(rpl_sidno, rpl_gno, rpl_gno)");
   DBUG_ASSERT(start < end);
-  Interval_iterator ivit= *ivitp;
-  Interval *iv;
+  Interval_array *arr= get_interval_array(sidno);
   cached_string_length= -1;
 
-  // Skip intervals of 'this' that are completely before the removed interval.
-  while (1)
+  // Skip intervals that are completely before the removed interval.
+  int i= find_interval(arr, start + 1);
+  if (i == arr->count || arr->ivs[i].start >= end)
+    RETURN_OK;
+
+  // Now interval i ends after the beginning of the removed interval.
+  Interval *iv= arr->ivs + i;
+  if (iv->start < start && iv->end > end)
   {
-    iv= ivit.get();
-    if (iv == NULL)
-      goto ok;
-    if (iv->end > start)
-      break;
-    ivit.next();
+    // iv cuts also the end of the removed interval: split iv in two
+    PROPAGATE_REPORTED_ERROR(reserve_intervals(arr, arr->count + 1));
+    iv= arr->ivs + i;
+    memmove(iv + 1, iv, (arr->count - i) * sizeof(Interval));
+    iv->end= start;
+    (iv + 1)->start= end;
+    arr->count++;
+    RETURN_OK;
   }
-
-  // Now iv ends after the beginning of the removed interval.
-  DBUG_ASSERT(iv != NULL && iv->end > start);
   if (iv->start < start)
   {
-    if (iv->end > end)
-    {
-      // iv cuts also the end of the removed interval: split iv in two
-      Interval *new_iv;
-      lock->lock_if_not_locked();
-      PROPAGATE_REPORTED_ERROR(get_free_interval(&new_iv));
-      new_iv->start= end;
-      new_iv->end= iv->end;
-      iv->end= start;
-      ivit.next();
-      ivit.insert(new_iv);
-      goto ok;
-    }
     // iv cuts the beginning but not the end of the removed interval:
-    // truncate iv, and iterate one step to next interval
+    // truncate iv, and continue with the next interval
     iv->end= start;
-    ivit.next();
-    iv= ivit.get();
-    if (iv == NULL)
-      goto ok;
+    i++;
   }
 
-  // Now iv starts after the beginning of the removed interval.
-  DBUG_ASSERT(iv != NULL && iv->start >= start);
-  while (iv->end <= end)
-  {
-    // iv ends before the end of the removed interval, so it is
-    // completely covered: remove iv.
-    lock->lock_if_not_locked();
-    ivit.remove(this);
-    iv= ivit.get();
-    if (iv == NULL)
-      goto ok;
-  }
-
-  // Now iv ends after the removed interval.
-  DBUG_ASSERT(iv != NULL && iv->end > end);
-  if (iv->start < end)
-  {
-    // iv begins before the end of the removed interval: truncate iv
-    iv->start= end;
-  }
-
-ok:
-  *ivitp= ivit;
+  // Intervals i..j-1 are completely covered by the removed interval.
+  int j= i;
+  while (j < arr->count && arr->ivs[j].end <= end)
+    j++;
+  // Interval j, if any, ends after the removed interval.  If it begins
+  // before the end of the removed interval, truncate it.
+  if (j < arr->count && arr->ivs[j].start < end)
+    arr->ivs[j].start= end;
+  memmove(arr->ivs + i, arr->ivs + j, (arr->count - j) * sizeof(Interval));
+  arr->count-= j - i;
   RETURN_OK;
 }
 
@@ -446,25 +350,7 @@ enum_return_status Gtid_set::add_gtid_text(const char *text, bool *anonymous)
     RETURN_OK;
   }
 
-  Free_intervals_lock lock(this);
-
   DBUG_PRINT("info", ("'%s' not only whitespace", text));
-  // Allocate space for all intervals at once, if nothing is allocated.
-  if (chunks == NULL)
-  {
-    // compute number of intervals in text: it is equal to the number of
-    // colons
-    int n_intervals= 0;
-    text= s;
-    for (; *s; s++)
-      if (*s == ':')
-        n_intervals++;
-    // allocate all intervals in one chunk
-    lock.lock_if_not_locked();
-    create_new_chunk(n_intervals);
-    lock.unlock_if_locked();
-    s= text;
-  }
 
   while (1)
   {
@@ -506,7 +392,6 @@ enum_return_status Gtid_set::add_gtid_text(const char *text, bool *anonymous)
       SKIP_WHITESPACE();
 
       // Iterate over intervals.
-      Interval_iterator ivit(this, sidno);
       while (*s == ':')
       {
         // Skip ':'.
@@ -544,13 +429,8 @@ enum_return_status Gtid_set::add_gtid_text(const char *text, bool *anonymous)
 
         if (end > start)
         {
-          // Add interval.  Use the existing iterator position if the
-          // current interval does not begin before it.  Otherwise iterate
-          // from the beginning.
-          Interval *current= ivit.get();
-          if (current == NULL || start < current->start)
-            ivit.init(this, sidno);
-          if (add_gno_interval(&ivit, start, end, &lock) != RETURN_STATUS_OK)
+          // Add interval.
+          if (add_gno_interval(sidno, start, end) != RETURN_STATUS_OK)
           {
             RETURN_REPORTED_ERROR;
           }
@@ -627,41 +507,120 @@ bool Gtid_set::is_valid(const char *text)
 
 
 enum_return_status
-Gtid_set::add_gno_intervals(rpl_sidno sidno,
-                            Const_interval_iterator other_ivit,
-                            Free_intervals_lock *lock)
+Gtid_set::add_gno_intervals(rpl_sidno sidno, const Interval_array *other)
 {
-  DBUG_ENTER("Gtid_set::add_gno_intervals(rpl_sidno, Const_interval_iterator, bool *)");
+  DBUG_ENTER("Gtid_set::add_gno_intervals(rpl_sidno, const Interval_array *)");
   DBUG_ASSERT(sidno >= 1 && sidno <= get_max_sidno());
-  const Interval *other_iv;
-  Interval_iterator ivit(this, sidno);
-  while ((other_iv= other_ivit.get()) != NULL)
+  if (other->count == 0)
+    RETURN_OK;
+  Interval_array *arr= get_interval_array(sidno);
+  cached_string_length= -1;
+
+  /*
+    Fast path: all intervals of other come after the intervals of
+    this set.  Merge the first one with our last interval if they
+    touch, and append the rest.
+  */
+  const Interval *other_iv= other->ivs;
+  const Interval *other_end= other->ivs + other->count;
+  if (arr->count == 0 || arr->ivs[arr->count - 1].end <= other_iv->start)
   {
-    PROPAGATE_REPORTED_ERROR(add_gno_interval(&ivit,
-                                              other_iv->start, other_iv->end,
-                                              lock));
-    other_ivit.next();
+    PROPAGATE_REPORTED_ERROR(reserve_intervals(arr,
+                                               arr->count + other->count));
+    if (arr->count > 0 && arr->ivs[arr->count - 1].end == other_iv->start)
+      arr->ivs[arr->count - 1].end= (other_iv++)->end;
+    memcpy(arr->ivs + arr->count, other_iv,
+           (other_end - other_iv) * sizeof(Interval));
+    arr->count+= (int)(other_end - other_iv);
+    RETURN_OK;
   }
+
+  // General case: merge the two sorted arrays into a new array.
+  int max_n= arr->count + other->count;
+  Interval *ivs= (Interval *)my_malloc(max_n * sizeof(Interval), MYF(MY_WME));
+  if (ivs == NULL)
+    RETURN_REPORTED_ERROR;
+  const Interval *iv= arr->ivs;
+  const Interval *end= arr->ivs + arr->count;
+  int n= 0;
+  while (iv != end || other_iv != other_end)
+  {
+    // Take the interval that starts first.
+    const Interval *next;
+    if (other_iv == other_end ||
+        (iv != end && iv->start <= other_iv->start))
+      next= iv++;
+    else
+      next= other_iv++;
+    // Extend the last output interval if they touch or intersect.
+    if (n > 0 && ivs[n - 1].end >= next->start)
+    {
+      if (ivs[n - 1].end < next->end)
+        ivs[n - 1].end= next->end;
+    }
+    else
+      ivs[n++]= *next;
+  }
+  replace_intervals(arr, ivs, n, max_n);
   RETURN_OK;
 }
 
 
 enum_return_status
-Gtid_set::remove_gno_intervals(rpl_sidno sidno,
-                               Const_interval_iterator other_ivit,
-                               Free_intervals_lock *lock)
+Gtid_set::remove_gno_intervals(rpl_sidno sidno, const Interval_array *other)
 {
-  DBUG_ENTER("Gtid_set::remove_gno_intervals(rpl_sidno, Interval_iterator, bool *)");
+  DBUG_ENTER("Gtid_set::remove_gno_intervals(rpl_sidno, const Interval_array *)");
   DBUG_ASSERT(sidno >= 1 && sidno <= get_max_sidno());
-  const Interval *other_iv;
-  Interval_iterator ivit(this, sidno);
-  while ((other_iv= other_ivit.get()) != NULL)
+  Interval_array *arr= get_interval_array(sidno);
+  if (arr->count == 0 || other->count == 0)
+    RETURN_OK;
+  cached_string_length= -1;
+
+  /*
+    Each interval of other can split at most one interval of this set
+    in two, so the result has at most arr->count + other->count
+    intervals.
+  */
+  int max_n= arr->count + other->count;
+  Interval *ivs= (Interval *)my_malloc(max_n * sizeof(Interval), MYF(MY_WME));
+  if (ivs == NULL)
+    RETURN_REPORTED_ERROR;
+  const Interval *other_iv= other->ivs;
+  const Interval *other_end= other->ivs + other->count;
+  int n= 0;
+  for (int i= 0; i < arr->count; i++)
   {
-    PROPAGATE_REPORTED_ERROR(remove_gno_interval(&ivit,
-                                                 other_iv->start, other_iv->end,
-                                                 lock));
-    other_ivit.next();
+    rpl_gno start= arr->ivs[i].start;
+    rpl_gno end= arr->ivs[i].end;
+    // Skip intervals of other that end before the current interval.
+    while (other_iv != other_end && other_iv->end <= start)
+      other_iv++;
+    // Cut out all intervals of other that intersect the current interval.
+    while (other_iv != other_end && other_iv->start < end)
+    {
+      if (other_iv->start > start)
+      {
+        ivs[n].start= start;
+        ivs[n].end= other_iv->start;
+        n++;
+      }
+      if (other_iv->end >= end)
+      {
+        start= end;
+        break;
+      }
+      start= other_iv->end;
+      other_iv++;
+    }
+    if (start < end)
+    {
+      ivs[n].start= start;
+      ivs[n].end= end;
+      n++;
+    }
   }
+  DBUG_ASSERT(n <= max_n);
+  replace_intervals(arr, ivs, n, max_n);
   RETURN_OK;
 }
 
@@ -672,14 +631,12 @@ enum_return_status Gtid_set::add_gtid_set(const Gtid_set *other)
   if (sid_lock != NULL)
     sid_lock->assert_some_wrlock();
   rpl_sidno max_other_sidno= other->get_max_sidno();
-  Free_intervals_lock lock(this);
   if (other->sid_map == sid_map || other->sid_map == NULL || sid_map == NULL)
   {
     PROPAGATE_REPORTED_ERROR(ensure_sidno(max_other_sidno));
     for (rpl_sidno sidno= 1; sidno <= max_other_sidno; sidno++)
       PROPAGATE_REPORTED_ERROR(
-        add_gno_intervals(sidno, Const_interval_iterator(other, sidno),
-                          &lock));
+        add_gno_intervals(sidno, other->get_interval_array(sidno)));
   }
   else
   {
@@ -693,16 +650,16 @@ enum_return_status Gtid_set::add_gtid_set(const Gtid_set *other)
     for (rpl_sidno other_sidno= 1; other_sidno <= max_other_sidno;
          other_sidno++)
     {
-      Const_interval_iterator other_ivit(other, other_sidno);
-      if (other_ivit.get() != NULL)
+      if (other->contains_sidno(other_sidno))
       {
         const rpl_sid &sid= other_sid_map->sidno_to_sid(other_sidno);
         rpl_sidno this_sidno= sid_map->add_sid(sid);
         if (this_sidno <= 0)
           RETURN_REPORTED_ERROR;
         PROPAGATE_REPORTED_ERROR(ensure_sidno(this_sidno));
-        PROPAGATE_REPORTED_ERROR(add_gno_intervals(this_sidno, other_ivit,
-                                                   &lock));
+        PROPAGATE_REPORTED_ERROR(
+          add_gno_intervals(this_sidno,
+                            other->get_interval_array(other_sidno)));
       }
     }
   }
@@ -716,14 +673,12 @@ enum_return_status Gtid_set::remove_gtid_set(const Gtid_set *other)
   if (sid_lock != NULL)
     sid_lock->assert_some_wrlock();
   rpl_sidno max_other_sidno= other->get_max_sidno();
-  Free_intervals_lock lock(this);
   if (other->sid_map == sid_map || other->sid_map == NULL || sid_map == NULL)
   {
     rpl_sidno max_sidno= min(max_other_sidno, get_max_sidno());
     for (rpl_sidno sidno= 1; sidno <= max_sidno; sidno++)
       PROPAGATE_REPORTED_ERROR(
-        remove_gno_intervals(sidno, Const_interval_iterator(other, sidno),
-                             &lock));
+        remove_gno_intervals(sidno, other->get_interval_array(sidno)));
   }
   else
   {
@@ -739,14 +694,14 @@ enum_return_status Gtid_set::remove_gtid_set(const Gtid_set *other)
     for (rpl_sidno other_sidno= 1; other_sidno <= max_other_sidno;
          other_sidno++)
     {
-      Const_interval_iterator other_ivit(other, other_sidno);
-      if (other_ivit.get() != NULL)
+      if (other->contains_sidno(other_sidno))
       {
         const rpl_sid &sid= other_sid_map->sidno_to_sid(other_sidno);
         rpl_sidno this_sidno= sid_map->sid_to_sidno(sid);
         if (this_sidno != 0)
           PROPAGATE_REPORTED_ERROR(
-            remove_gno_intervals(this_sidno, other_ivit, &lock));
+            remove_gno_intervals(this_sidno,
+                                 other->get_interval_array(other_sidno)));
       }
     }
 #endif
@@ -763,17 +718,11 @@ bool Gtid_set::contains_gtid(rpl_sidno sidno, rpl_gno gno) const
     sid_lock->assert_some_lock();
   if (sidno > get_max_sidno())
     DBUG_RETURN(false);
-  Const_interval_iterator ivit(this, sidno);
-  const Interval *iv;
-  while ((iv= ivit.get()) != NULL)
-  {
-    if (gno < iv->start)
-      DBUG_RETURN(false);
-    else if (gno < iv->end)
-      DBUG_RETURN(true);
-    ivit.next();
-  }
-  DBUG_RETURN(false);
+  const Interval_array *arr= get_interval_array(sidno);
+  // The first interval that ends after gno is the only one that can
+  // contain it.
+  int i= find_interval(arr, gno + 1);
+  DBUG_RETURN(i < arr->count && arr->ivs[i].start <= gno);
 }
 
 int Gtid_set::to_string(char **buf_arg, const Gtid_set::String_format *sf_arg) const
@@ -1028,14 +977,12 @@ bool Gtid_set::equals(const Gtid_set *other) const
 #endif
 
 
-bool Gtid_set::is_interval_subset(Const_interval_iterator *sub,
-                                  Const_interval_iterator *super)
+bool Gtid_set::is_interval_subset(const Interval_array *sub,
+                                  const Interval_array *super)
 {
   DBUG_ENTER("is_interval_subset");
   // check if all intervals for this sidno are contained in some
   // interval of super
-  const Interval *super_iv= super->get();
-  const Interval *sub_iv= sub->get();
 
   /*
     Algorithm: Let sub_iv iterate over intervals of sub.  For each
@@ -1043,32 +990,24 @@ bool Gtid_set::is_interval_subset(Const_interval_iterator *sub,
     find the first super-interval that does not end before sub_iv,
     check if it covers sub_iv.
   */
-  do
+  const Interval *super_iv= super->ivs;
+  const Interval *super_end= super->ivs + super->count;
+  for (const Interval *sub_iv= sub->ivs; sub_iv != sub->ivs + sub->count;
+       sub_iv++)
   {
-    if (super_iv == NULL)
-      DBUG_RETURN(false);
-
     // Skip over 'smaller' intervals of super.
-    while (sub_iv->start > super_iv->end)
-    {
-      super->next();
-      super_iv= super->get();
-      // If we reach end of super, then no interal covers sub_iv, so
-      // sub is not a subset of super.
-      if (super_iv == NULL)
-        DBUG_RETURN(false);
-    }
+    while (super_iv != super_end && sub_iv->start > super_iv->end)
+      super_iv++;
+    // If we reach end of super, then no interal covers sub_iv, so
+    // sub is not a subset of super.
+    if (super_iv == super_end)
+      DBUG_RETURN(false);
 
     // If super_iv does not cover sub_iv, then sub is not a subset of
     // super.
     if (sub_iv->start < super_iv->start || sub_iv->end > super_iv->end)
       DBUG_RETURN(false);
-
-    // Next iteration.
-    sub->next();
-    sub_iv= sub->get();
-
-  } while (sub_iv != NULL);
+  }
 
   // If every GNO in sub also exists in super, then it was a subset.
   DBUG_RETURN(true);
@@ -1110,9 +1049,8 @@ bool Gtid_set::is_subset_for_sid(const Gtid_set *super,
     Once we have valid(non-zero) subset's and superset's sid numbers, call
     is_interval_subset().
   */
-  Const_interval_iterator subset_ivit(this, subset_sidno);
-  Const_interval_iterator superset_ivit(super, superset_sidno);
-  if (!is_interval_subset(&subset_ivit, &superset_ivit))
+  if (!is_interval_subset(get_interval_array(subset_sidno),
+                          super->get_interval_array(superset_sidno)))
     DBUG_RETURN(false);
 
   DBUG_RETURN(true);
@@ -1138,9 +1076,7 @@ bool Gtid_set::is_subset(const Gtid_set *super) const
   */
   for (int sidno= 1; sidno <= max_sidno; sidno++)
   {
-    Const_interval_iterator ivit(this, sidno);
-    const Interval *iv= ivit.get();
-    if (iv != NULL)
+    if (contains_sidno(sidno))
     {
 
       // Get the corresponding super_sidno
@@ -1158,8 +1094,8 @@ bool Gtid_set::is_subset(const Gtid_set *super) const
 
       // Check if all GNOs in this Gtid_set for sidno exist in other
       // Gtid_set for super_
-      Const_interval_iterator super_ivit(super, super_sidno);
-      if (!is_interval_subset(&ivit, &super_ivit))
+      if (!is_interval_subset(get_interval_array(sidno),
+                              super->get_interval_array(super_sidno)))
         DBUG_RETURN(false);
     }
   }
@@ -1170,47 +1106,36 @@ bool Gtid_set::is_subset(const Gtid_set *super) const
 }
 
 
-bool Gtid_set::is_interval_intersection_nonempty(Const_interval_iterator *ivit1,
-                                                 Const_interval_iterator *ivit2)
+bool Gtid_set::is_interval_intersection_nonempty(const Interval_array *arr1,
+                                                 const Interval_array *arr2)
 {
   DBUG_ENTER("is_interval_intersection_nonempty");
-  const Interval *iv1= ivit1->get();
-  const Interval *iv2= ivit2->get();
-  DBUG_ASSERT(iv1 != NULL);
-  if (iv2 == NULL)
-    DBUG_RETURN(false);
+  DBUG_ASSERT(arr1->count > 0);
 
   /*
-    Algorithm: Let iv1 iterate over all intervals of ivit1.  For each
-    iv1, skip over intervals of iv2 that end before iv1.  When we
+    Algorithm: Let iv1 iterate over all intervals of arr1.  For each
+    iv1, skip over intervals of arr2 that end before iv1.  When we
     reach the first interval that does not end before iv1, check if it
     intersects with iv1.
   */
-  do
+  const Interval *iv2= arr2->ivs;
+  const Interval *end2= arr2->ivs + arr2->count;
+  for (const Interval *iv1= arr1->ivs; iv1 != arr1->ivs + arr1->count; iv1++)
   {
-
-    // Skip over intervals of iv2 that end before iv1.
-    while (iv2->end <= iv1->start)
-    {
-      ivit2->next();
-      iv2= ivit2->get();
-      // If we reached the end of ivit2, then there is no intersection.
-      if (iv2 == NULL)
-        DBUG_RETURN(false);
-    }
+    // Skip over intervals of arr2 that end before iv1.
+    while (iv2 != end2 && iv2->end <= iv1->start)
+      iv2++;
+    // If we reached the end of arr2, then there is no intersection.
+    if (iv2 == end2)
+      DBUG_RETURN(false);
 
     // If iv1 and iv2 intersect, return true.
     if (iv2->start < iv1->end)
       DBUG_RETURN(true);
+  }
 
-    // Next iteration.
-    ivit1->next();
-    iv1= ivit1->get();
-
-  } while (iv1 != NULL);
-
-  // If we iterated over all intervals of ivit1 without finding any
-  // intersection with ivit2, then there is no intersection.
+  // If we iterated over all intervals of arr1 without finding any
+  // intersection with arr2, then there is no intersection.
   DBUG_RETURN(false);
 }
 
@@ -1249,9 +1174,7 @@ bool Gtid_set::is_intersection_nonempty(const Gtid_set *other) const
   */
   for (int sidno= 1; sidno <= max_sidno; sidno++)
   {
-    Const_interval_iterator ivit(this, sidno);
-    const Interval *iv= ivit.get();
-    if (iv != NULL)
+    if (contains_sidno(sidno))
     {
 
       // Get the corresponding other_sidno.
@@ -1269,8 +1192,8 @@ bool Gtid_set::is_intersection_nonempty(const Gtid_set *other) const
 
       // Check if there is any GNO in this for sidno that also exists
       // in other for other_sidno.
-      Const_interval_iterator other_ivit(other, other_sidno);
-      if (is_interval_intersection_nonempty(&ivit, &other_ivit))
+      if (is_interval_intersection_nonempty(
+            get_interval_array(sidno), other->get_interval_array(other_sidno)))
         DBUG_RETURN(true);
     }
   }
@@ -1289,23 +1212,76 @@ Gtid_set::intersection(const Gtid_set *other, Gtid_set *result)
   DBUG_ASSERT(result != this);
   DBUG_ASSERT(result != other);
   DBUG_ASSERT(other != this);
-  /**
-    @todo: This algorithm is simple, a little bit slower than
-    necessary.  It would be more efficient to iterate over intervals
-    of 'this' and 'other' similar to add_gno_interval(). At the moment
-    the performance of this is not super-important. /Sven
-  */
-  Gtid_set this_minus_other(sid_map);
-  Gtid_set intersection(sid_map);
-  // In set theory, intersection(A, B) == A - (A - B)
-  PROPAGATE_REPORTED_ERROR(this_minus_other.add_gtid_set(this));
-  PROPAGATE_REPORTED_ERROR(this_minus_other.remove_gtid_set(other));
-  PROPAGATE_REPORTED_ERROR(intersection.add_gtid_set(this));
-  PROPAGATE_REPORTED_ERROR(intersection.remove_gtid_set(&this_minus_other));
-  PROPAGATE_REPORTED_ERROR(result->add_gtid_set(&intersection));
+  if (sid_map != NULL &&
+      ((other->sid_map != sid_map && other->sid_map != NULL) ||
+       (result->sid_map != sid_map && result->sid_map != NULL)))
+  {
+    /*
+      The sets use different Sid_maps, so the sidnos have to be
+      translated; fall back to computing the intersection in terms of
+      set differences.
+    */
+    Gtid_set this_minus_other(sid_map);
+    Gtid_set intersection(sid_map);
+    // In set theory, intersection(A, B) == A - (A - B)
+    PROPAGATE_REPORTED_ERROR(this_minus_other.add_gtid_set(this));
+    PROPAGATE_REPORTED_ERROR(this_minus_other.remove_gtid_set(other));
+    PROPAGATE_REPORTED_ERROR(intersection.add_gtid_set(this));
+    PROPAGATE_REPORTED_ERROR(intersection.remove_gtid_set(&this_minus_other));
+    PROPAGATE_REPORTED_ERROR(result->add_gtid_set(&intersection));
+    RETURN_OK;
+  }
+  rpl_sidno max_sidno= min(get_max_sidno(), other->get_max_sidno());
+  for (rpl_sidno sidno= 1; sidno <= max_sidno; sidno++)
+  {
+    if (contains_sidno(sidno) && other->contains_sidno(sidno))
+    {
+      PROPAGATE_REPORTED_ERROR(result->ensure_sidno(sidno));
+      PROPAGATE_REPORTED_ERROR(
+        result->add_interval_intersection(sidno, get_interval_array(sidno),
+                                          other->get_interval_array(sidno)));
+    }
+  }
   RETURN_OK;
 }
 
+
+enum_return_status
+Gtid_set::add_interval_intersection(rpl_sidno sidno,
+                                    const Interval_array *arr1,
+                                    const Interval_array *arr2)
+{
+  DBUG_ENTER("Gtid_set::add_interval_intersection");
+  /*
+    Collect the intersection in a temporary array and merge it into
+    this set, so that the result is correct also if this set already
+    contains intervals for the sidno.
+  */
+  Interval_array tmp= { NULL, 0, 0 };
+  PROPAGATE_REPORTED_ERROR(reserve_intervals(&tmp, arr1->count + arr2->count));
+  const Interval *iv1= arr1->ivs, *end1= arr1->ivs + arr1->count;
+  const Interval *iv2= arr2->ivs, *end2= arr2->ivs + arr2->count;
+  while (iv1 != end1 && iv2 != end2)
+  {
+    rpl_gno start= max(iv1->start, iv2->start);
+    rpl_gno end= min(iv1->end, iv2->end);
+    if (start < end)
+    {
+      tmp.ivs[tmp.count].start= start;
+      tmp.ivs[tmp.count].end= end;
+      tmp.count++;
+    }
+    // Advance the interval that ends first.
+    if (iv1->end < iv2->end)
+      iv1++;
+    else
+      iv2++;
+  }
+  enum_return_status ret= add_gno_intervals(sidno, &tmp);
+  my_free(tmp.ivs);
+  DBUG_RETURN(ret);
+}
+
 /*
   Allocates memory and returns the pointer to the memory which
   contains binary string format of Gtid_set. Stores encoded_length
@@ -1392,7 +1368,6 @@ enum_return_status Gtid_set::add_gtid_encoding(const uchar *encoded,
     sid_lock->assert_some_wrlock();
   size_t pos= 0;
   uint64 n_sids;
-  Free_intervals_lock lock(this);
   // read number of SIDs
   if (length < 8)
   {
@@ -1431,7 +1406,6 @@ enum_return_status Gtid_set::add_gtid_encoding(const uchar *encoded,
                            (ulong) length, (ulong) pos, n_intervals));
       goto report_error;
     }
-    Interval_iterator ivit(this, sidno);
     rpl_gno last= 0;
     for (uint i= 0; i < n_intervals; i++)
     {
@@ -1447,14 +1421,8 @@ enum_return_status Gtid_set::add_gtid_encoding(const uchar *encoded,
         goto report_error;
       }
       last= end;
-      // Add interval.  Use the existing iterator position if the
-      // current interval does not begin before it.  Otherwise iterate
-      // from the beginning.
-      Interval *current= ivit.get();
-      if (current == NULL || start < current->start)
-        ivit.init(this, sidno);
       DBUG_PRINT("info", ("adding %d:%lld-%lld", sidno, start, end - 1));
-      PROPAGATE_REPORTED_ERROR(add_gno_interval(&ivit, start, end, &lock));
+      PROPAGATE_REPORTED_ERROR(add_gno_interval(sidno, start, end));
     }
   }
   DBUG_ASSERT(pos <= length);
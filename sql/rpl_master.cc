@@ -2199,7 +2199,7 @@ void mysql_binlog_send(THD* thd, char* log_ident, my_off_t pos,
       {
         ulonglong n_timer = my_timer_now();
         double micro_secs = my_timer_to_microseconds(n_timer - cur_timer);
-        us->microseconds_wall.inc(micro_secs);
+        us->counters.local().microseconds_wall.inc(micro_secs);
         cur_timer = n_timer;
       }
       time_t created;
@@ -3077,7 +3077,8 @@ end:
   if (us)
   {
     ulonglong n_timer = my_timer_now();
-    us->microseconds_wall.inc(my_timer_to_microseconds(n_timer - cur_timer));
+    us->counters.local().microseconds_wall.inc(
+      my_timer_to_microseconds(n_timer - cur_timer));
   }
   DBUG_VOID_RETURN;
 
@@ -3130,7 +3131,8 @@ err:
   if (us)
   {
     ulonglong n_timer = my_timer_now();
-    us->microseconds_wall.inc(my_timer_to_microseconds(n_timer - cur_timer));
+    us->counters.local().microseconds_wall.inc(
+      my_timer_to_microseconds(n_timer - cur_timer));
   }
   DBUG_VOID_RETURN;
 }
@@ -32,6 +32,7 @@
 
 #include <atomic>
 #include <deque>
+#include <map>
 
 struct RPL_TABLE_LIST;
 class Master_info;
@@ -1151,6 +1152,22 @@ public:
   /* Set of keys accessed by the group */
   std::unordered_set<Dependency_key> keys_accessed_by_group;
 
+  /* Mapping from master's sequence number to penultimate/end event of the
+     trx, populated only for groups carrying a writeset dependency (see
+     @Metadata_log_event::prepare_dep), protected by dep_key_lookup_mutex */
+  std::map<ulonglong, std::shared_ptr<Log_event_wrapper>> dep_trx_lookup;
+
+  /* Writeset dependency of the current group, 0 if there is none */
+  ulonglong dep_last_committed= 0;
+  ulonglong dep_sequence_number= 0;
+  /* Have the dependencies of the current group been added already? */
+  bool dep_writeset_deps_added= false;
+  /* Sequence number of the last scheduled group, 0 if it didn't carry a
+     writeset dependency */
+  ulonglong dep_last_sequence_number= 0;
+  /* Was the last scheduled group tracked in the key lookup? */
+  bool dep_last_group_keyed= false;
+
   /* Set of all DBs accessed by the current group */
   std::unordered_set<std::string> dbs_accessed_by_group;
 
@@ -1235,6 +1252,11 @@ public:
     keys_accessed_by_group.clear();
     dbs_accessed_by_group.clear();
 
+    dep_last_committed= dep_sequence_number= 0;
+    dep_writeset_deps_added= false;
+    dep_last_sequence_number= 0;
+    dep_last_group_keyed= false;
+
     mysql_cond_broadcast(&dep_empty_cond);
     mysql_cond_broadcast(&dep_full_cond);
     mysql_cond_broadcast(&dep_trx_all_done_cond);
@@ -1243,6 +1265,7 @@ public:
 
     mysql_mutex_lock(&dep_key_lookup_mutex);
     dep_key_lookup.clear();
+    dep_trx_lookup.clear();
     mysql_mutex_unlock(&dep_key_lookup_mutex);
 
     trx_queued= false;
@@ -428,8 +428,13 @@ int Slave_worker::flush_info(const bool force)
     now that we are handling a Slave_worker. This needs to be
     update every time we call flush because the option may be
     dinamically set.
+
+    With relay_log_group_sync, a non-transactional repository is only
+    synced when forced, which commit_positions() does once per
+    checkpoint.
   */
-  handler->set_sync_period(sync_relayloginfo_period);
+  handler->set_sync_period(opt_relay_log_group_sync && !is_transactional() ?
+                           0 : sync_relayloginfo_period);
 
 #if defined(FLUSH_REP_INFO)
   if (!handler->need_write(force))
@@ -584,6 +589,8 @@ const char* Slave_worker::get_master_log_name()
 bool Slave_worker::commit_positions(Log_event *ev, Slave_job_group* ptr_g, bool force)
 {
   int error = 0;
+  /* The first group after a checkpoint carries the checkpoint positions. */
+  const bool checkpoint= ptr_g->checkpoint_log_name != NULL;
   DBUG_ENTER("Slave_worker::checkpoint_positions");
 
   /*
@@ -702,7 +709,7 @@ bool Slave_worker::commit_positions(Log_event *ev, Slave_job_group* ptr_g, bool
   worker_last_gtid[0] = 0;
   reset_dynamic(&worker_gtid_infos);
 
-  DBUG_RETURN(flush_info(force));
+  DBUG_RETURN(flush_info(force || (opt_relay_log_group_sync && checkpoint)));
 }
 
 void Slave_worker::rollback_positions(Slave_job_group* ptr_g)
@@ -5018,6 +5018,28 @@ static int try_to_reconnect(THD *thd, MYSQL *mysql, Master_info *mi,
 }
 
 
+/**
+  Checks if more data sent by the master can be read without waiting,
+  either from the buffers of the connection or from the socket.
+
+  @param mysql  Connection to the master.
+
+  @retval true   More data is available.
+  @retval false  The next read would wait for the master.
+*/
+static bool slave_io_has_pending_data(MYSQL *mysql)
+{
+  NET *net= &mysql->net;
+  if (net->remain_in_buf)
+    return true;
+  Vio *vio= net->vio;
+  if (vio == NULL)
+    return false;
+  return (vio->has_data(vio) ||
+          vio_io_wait(vio, VIO_IO_EVENT_READ, timeout_from_millis(0)) > 0);
+}
+
+
 /**
   Slave IO thread entry point.
 
@@ -5038,6 +5060,7 @@ pthread_handler_t handle_slave_io(void *arg)
   bool suppress_warnings;
   int ret;
   int binlog_version;
+  uint batch_events= 0;
 #ifndef DBUG_OFF
   uint retry_count_reg= 0, retry_count_dump= 0, retry_count_event= 0;
 #endif
@@ -5325,16 +5348,38 @@ Stopping slave I/O thread due to out-of-memory error from master");
         goto err;
       }
 
-      mysql_mutex_lock(&mi->data_lock);
-      if (flush_master_info(mi, FALSE))
+      /*
+        With relay_log_group_sync, the relay log is synced and the master
+        info flushed only once the events already sent by the master have
+        been queued, so that a burst of events shares one sync.
+      */
+      if (!opt_relay_log_group_sync ||
+          ++batch_events >= opt_relay_log_group_sync ||
+          !slave_io_has_pending_data(mysql))
       {
-        mi->report(ERROR_LEVEL, ER_SLAVE_FATAL_ERROR,
-                   ER(ER_SLAVE_FATAL_ERROR),
-                   "Failed to flush master info.");
+        if (batch_events)
+        {
+          batch_events= 0;
+          if (rli->relay_log.sync_relay_log_batch())
+          {
+            mi->report(ERROR_LEVEL, ER_SLAVE_RELAY_LOG_WRITE_FAILURE,
+                       ER(ER_SLAVE_RELAY_LOG_WRITE_FAILURE),
+                       "could not sync relay log");
+            goto err;
+          }
+        }
+
+        mysql_mutex_lock(&mi->data_lock);
+        if (flush_master_info(mi, FALSE))
+        {
+          mi->report(ERROR_LEVEL, ER_SLAVE_FATAL_ERROR,
+                     ER(ER_SLAVE_FATAL_ERROR),
+                     "Failed to flush master info.");
+          mysql_mutex_unlock(&mi->data_lock);
+          goto err;
+        }
         mysql_mutex_unlock(&mi->data_lock);
-        goto err;
       }
-      mysql_mutex_unlock(&mi->data_lock);
 
       /*
         See if the relay logs take too much space.
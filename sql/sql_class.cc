@@ -663,6 +663,8 @@ void THD::enter_stage(const PSI_stage_info *new_stage,
 
     m_current_stage_key= new_stage->m_key;
     proc_info= msg;
+    if (status_record)
+      status_record->set_state(msg);
 
     MYSQL_SET_STAGE(m_current_stage_key, calling_file, calling_line);
   }
@@ -1009,6 +1011,8 @@ THD::THD(bool enable_plugins)
     will be re-initialized in init_for_queries().
   */
   init_sql_alloc(&main_mem_root, ALLOC_ROOT_MIN_BLOCK_SIZE, 0);
+  main_mem_root_recycle_size= 0;
+  status_record= NULL;
   stmt_arena= this;
   thread_stack= 0;
   catalog= (char*)"std"; // the only catalog we have for now
@@ -1928,6 +1932,8 @@ void THD::awake(THD::killed_state state_to_set)
 
   /* Set the 'killed' flag of 'this', which is the target THD object. */
   killed= state_to_set;
+  if (status_record)
+    status_record->set_killed(state_to_set == THD::KILL_CONNECTION);
 
   if (state_to_set != THD::KILL_QUERY && state_to_set != THD::KILL_TIMEOUT)
   {
@@ -5248,6 +5254,7 @@ void THD::set_command(enum enum_server_command command)
 #ifdef HAVE_PSI_THREAD_INTERFACE
   PSI_STATEMENT_CALL(set_thread_command)(m_command);
 #endif
+  publish_status();
 }
 
 
@@ -5260,6 +5267,7 @@ void THD::set_query(const CSET_STRING &string_arg, bool need_lock)
   set_query_inner(string_arg);
   if (need_lock)
     mysql_mutex_unlock(&LOCK_thd_data);
+  publish_status();
 
 #ifdef HAVE_PSI_THREAD_INTERFACE
   PSI_THREAD_CALL(set_thread_info)(query(), query_length());
@@ -5276,6 +5284,7 @@ void THD::set_query_and_id(char *query_arg, uint32 query_length_arg,
   set_query_inner(query_arg, query_length_arg, cs);
   query_id= new_query_id;
   mysql_mutex_unlock(&LOCK_thd_data);
+  publish_status();
 }
 
 /** Assign a new value to thd->query_id.  */
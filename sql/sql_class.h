@@ -57,6 +57,7 @@
 #include "my_atomic.h"
 #include "sql_db.h"
 #include "rpl_master.h"
+#include "thd_status.h"                   // Thd_status_record
 
 #ifdef HAVE_RAPIDJSON
 #include "rapidjson/document.h"
@@ -124,6 +125,7 @@ class PerfCounter;
 }
 
 class Srv_session;
+class Rpc_connection;
 
 struct st_thd_timer;
 
@@ -652,8 +654,11 @@ typedef struct system_variables
   ha_rows max_join_size;
   ulong auto_increment_increment, auto_increment_offset;
   ulong bulk_insert_buff_size;
+  uint  load_data_parse_threads;
+  uint  insert_batch_rows;
   uint  eq_range_index_dive_limit;
   uint  part_scan_max;
+  my_bool part_ordered_scan_prefetch;
   uint  hll_data_size_log2;
   ulong join_buff_size;
   ulonglong lock_wait_timeout_nsec;
@@ -691,6 +696,7 @@ typedef struct system_variables
   ulong range_alloc_block_size;
   ulong query_alloc_block_size;
   ulong query_prealloc_size;
+  ulong query_prealloc_max_size;
   ulong trans_alloc_block_size;
   ulong trans_prealloc_size;
   ulong group_concat_max_len;
@@ -777,6 +783,12 @@ typedef struct system_variables
    */
   bool response_attrs_contain_hlc;
 
+  /*
+    Should we send the commit ticket of a transaction written to the binary
+    log in response attribute?
+   */
+  bool response_attrs_contain_commit_ticket;
+
   /**
     Compatibility option to mark the pre MySQL-5.6.4 temporals columns using
     the old format using comments for SHOW CREATE TABLE and in I_S.COLUMNS
@@ -2392,6 +2404,12 @@ public:
   /* Next HLC value */
   uint64_t hlc_time_ns_next= 0;
   bool should_update_hlc= false;
+  /*
+    "<binary log file>:<end position>" of the last transaction of the
+    session written to the binary log, or empty. See
+    WAIT_FOR_COMMIT_TICKET().
+  */
+  char commit_ticket[FN_REFLEN + 22]= "";
   void reset_for_next_command();
   /*
     Constant for THD::where initialization in the beginning of every query.
@@ -2493,6 +2511,13 @@ public:
   bool rw_trans = false;
   /* record the current statement start time */
   ulonglong stmt_start = 0;
+
+  void set_stmt_start(ulonglong start)
+  {
+    stmt_start= start;
+    if (status_record)
+      status_record->set_stmt_start(start);
+  }
   /* record the transaction time (including in-fly) */
   ulonglong trx_time = 0;
   /* record the semisync ack time */
@@ -2725,6 +2750,8 @@ public:
                         const uchar *old_data, const uchar *new_data,
                         const uchar* extra_row_info);
   void binlog_prepare_row_images(TABLE* table, bool is_update);
+  void binlog_add_row_to_writeset(TABLE *table, bool is_transactional,
+                                  const uchar *record);
 
   std::string gen_trx_metadata();
 #ifdef HAVE_RAPIDJSON
@@ -3754,6 +3781,17 @@ public:
   void init_for_queries(Relay_log_info *rli= NULL);
   void cleanup_connection(void);
   void cleanup_after_query();
+  /**
+    Free the memory of a finished statement, keeping a block for the
+    next ones sized to the recent statements, up to
+    query_prealloc_max_size. @see recycle_root()
+  */
+  void free_statement_mem_root()
+  {
+    recycle_root(mem_root, &main_mem_root_recycle_size,
+                 variables.query_prealloc_size,
+                 variables.query_prealloc_max_size);
+  }
   bool store_globals();
   bool restore_globals();
 #ifdef SIGNAL_WITH_VIO_SHUTDOWN
@@ -4462,7 +4500,8 @@ public:
     if (result)
       PSI_THREAD_CALL(set_thread_db)(new_db, static_cast<int>(new_db_len));
 #endif
-    db_stats= get_db_stats(db);
+    update_db_stats();
+    publish_status();
     return result;
   }
 
@@ -4487,8 +4526,21 @@ public:
 #ifdef HAVE_PSI_THREAD_INTERFACE
     PSI_THREAD_CALL(set_thread_db)(new_db, static_cast<int>(new_db_len));
 #endif
-    db_stats= get_db_stats(db);
+    update_db_stats();
+    publish_status();
   }
+
+  /*
+    Point db_stats to the entry of the current database. Entries are never
+    freed, so the lookup under LOCK_global_db_stats is skipped when the
+    database did not change.
+  */
+  void update_db_stats()
+  {
+    if (db_stats == NULL || db == NULL || strcmp(db_stats->db, db) != 0)
+      db_stats= get_db_stats(db);
+  }
+
   /*
     Copy the current database to the argument. Use the current arena to
     allocate memory for a deep copy: current database may be freed after
@@ -4610,6 +4662,19 @@ public:
 
   void set_command(enum enum_server_command command);
 
+  /*
+    Status published for processlist_snapshot, see thd_status.h. Set while
+    the THD is in the global thread list.
+  */
+  Thd_status_record *status_record;
+
+  /* Only published while processlist_snapshot is on */
+  void publish_status()
+  {
+    if (opt_processlist_snapshot && status_record)
+      thd_status_publish(this);
+  }
+
   inline enum enum_server_command get_command() const
   { return m_command; }
 
@@ -4793,6 +4858,8 @@ private:
     tree itself is reused between executions and thus is stored elsewhere.
   */
   MEM_ROOT main_mem_root;
+  /** Memory recently used by statements, see free_statement_mem_root() */
+  size_t main_mem_root_recycle_size;
   Diagnostics_area main_da;
   Diagnostics_area *m_stmt_da;
 
@@ -4902,6 +4969,9 @@ private:
   std::shared_ptr<Srv_session> default_srv_session;
 
 public:
+  // Responses of the multiplexed requests of this connection, created on
+  // the first one. See sql_parse_com_rpc.cc.
+  std::shared_ptr<Rpc_connection> rpc_connection;
   DB_STATS *db_stats;
   std::shared_ptr<utils::PerfCounter> query_perf;
   std::string trace_id;
@@ -30,6 +30,7 @@
 #include "sql_parse.h"                          // sql_command_flags,
                                                 // execute_init_command,
                                                 // do_command
+#include "sql_parse_com_rpc.h"                  // rpc_multiplex_wait
 #include "sql_db.h"                             // mysql_change_db
 #include "hostname.h" // inc_host_errors, ip_to_hostname,
                       // reset_host_errors
@@ -1444,6 +1445,8 @@ void do_handle_one_connection(THD *thd_arg)
         set_conn_timeout_err(thd, timeout_error_msg_buf);
       }
     }
+    // The workers may still be writing responses to the connection
+    rpc_multiplex_wait(thd);
     thd_update_net_stats(thd);
     // release connection in multi_tenancy plugin
     attrs = {
@@ -1541,14 +1544,7 @@ void init_user_stats(USER_STATS *user_stats)
   user_stats->binlog_disk_reads.clear();
   user_stats->bytes_received.clear();
   user_stats->bytes_sent.clear();
-  user_stats->commands_ddl.clear();
-  user_stats->commands_delete.clear();
-  user_stats->commands_handler.clear();
-  user_stats->commands_insert.clear();
-  user_stats->commands_other.clear();
-  user_stats->commands_select.clear();
-  user_stats->commands_transaction.clear();
-  user_stats->commands_update.clear();
+  user_stats->counters.clear();
   user_stats->connections_denied_max_global.clear();
   user_stats->connections_denied_max_user.clear();
   user_stats->connections_lost.clear();
@@ -1564,28 +1560,10 @@ void init_user_stats(USER_STATS *user_stats)
   user_stats->errors_net_ER_NET_UNCOMPRESS_ERROR.clear();
   user_stats->errors_net_ER_NET_WRITE_INTERRUPTED.clear();
   user_stats->errors_total.clear();
-  user_stats->microseconds_wall.clear();
-  user_stats->microseconds_ddl.clear();
-  user_stats->microseconds_delete.clear();
-  user_stats->microseconds_handler.clear();
-  user_stats->microseconds_insert.clear();
-  user_stats->microseconds_other.clear();
-  user_stats->microseconds_select.clear();
-  user_stats->microseconds_transaction.clear();
-  user_stats->microseconds_update.clear();
   user_stats->microseconds_cpu.clear();
   user_stats->microseconds_cpu_user.clear();
   user_stats->microseconds_cpu_sys.clear();
-  user_stats->queries_empty.clear();
-  user_stats->query_comment_bytes.clear();
   user_stats->relay_log_bytes_written.clear();
-  user_stats->rows_deleted.clear();
-  user_stats->rows_fetched.clear();
-  user_stats->rows_inserted.clear();
-  user_stats->rows_read.clear();
-  user_stats->rows_updated.clear();
-  user_stats->rows_index_first.clear();
-  user_stats->rows_index_next.clear();
   user_stats->transactions_commit.clear();
   user_stats->transactions_rollback.clear();
   user_stats->n_gtid_unsafe_create_select.clear();
@@ -1632,27 +1610,28 @@ update_user_stats_after_statement(USER_STATS *us,
   my_io_perf_t diff_io_perf, diff_io_perf_blob;
   my_io_perf_t diff_io_perf_primary, diff_io_perf_secondary;
   ulonglong wall_microsecs= my_timer_to_microseconds(wall_time);
+  user_stats_counters &counters= us->counters.local();
 
-  us->microseconds_wall.inc(wall_microsecs);
+  counters.microseconds_wall.inc(wall_microsecs);
 
   /* COM_QUERY is counted in mysql_execute_command */
   if (is_other_command)
   {
-    us->commands_other.inc();
-    us->microseconds_other.inc(wall_microsecs);
+    counters.commands_other.inc();
+    counters.microseconds_other.inc(wall_microsecs);
   }
 
   if (!is_xid_event)
   {
-    us->query_comment_bytes.inc(thd->count_comment_bytes);
+    counters.query_comment_bytes.inc(thd->count_comment_bytes);
 
-    us->rows_updated.inc(thd->rows_updated);
-    us->rows_deleted.inc(thd->rows_deleted);
-    us->rows_inserted.inc(thd->rows_inserted);
-    us->rows_read.inc(thd->rows_read);
+    counters.rows_updated.inc(thd->rows_updated);
+    counters.rows_deleted.inc(thd->rows_deleted);
+    counters.rows_inserted.inc(thd->rows_inserted);
+    counters.rows_read.inc(thd->rows_read);
 
-    us->rows_index_first.inc(thd->rows_index_first);
-    us->rows_index_next.inc(thd->rows_index_next);
+    counters.rows_index_first.inc(thd->rows_index_first);
+    counters.rows_index_next.inc(thd->rows_index_next);
 
     diff_io_perf.diff(thd->io_perf_read, *start_perf_read);
     diff_io_perf_blob.diff(thd->io_perf_read_blob, *start_perf_read_blob);
@@ -1668,8 +1647,8 @@ update_user_stats_after_statement(USER_STATS *us,
   }
   else
   {
-    us->commands_transaction.inc();
-    us->microseconds_transaction.inc(wall_microsecs);
+    counters.commands_transaction.inc();
+    counters.microseconds_transaction.inc(wall_microsecs);
   }
 }
 
@@ -1680,10 +1659,11 @@ update_db_stats_after_statement(DB_STATS *dbstats,
 {
   if (!is_xid_event)
   {
-    dbstats->rows_deleted.inc(thd->rows_deleted);
-    dbstats->rows_inserted.inc(thd->rows_inserted);
-    dbstats->rows_read.inc(thd->rows_read);
-    dbstats->rows_updated.inc(thd->rows_updated);
+    db_stats_counters &counters= dbstats->counters.local();
+    counters.rows_deleted.inc(thd->rows_deleted);
+    counters.rows_inserted.inc(thd->rows_inserted);
+    counters.rows_read.inc(thd->rows_read);
+    counters.rows_updated.inc(thd->rows_updated);
   }
 }
 
@@ -1816,6 +1796,7 @@ fill_one_user_stats(TABLE *table, USER_CONN *uc, USER_STATS* us,
 {
   DBUG_ENTER("fill_one_user_stats");
   int f= 0; /* field offset */
+  typedef user_stats_counters C;
 
   restore_record(table, s->default_values);
 
@@ -1825,14 +1806,14 @@ fill_one_user_stats(TABLE *table, USER_CONN *uc, USER_STATS* us,
   table->field[f++]->store(us->binlog_disk_reads.load(), TRUE);
   table->field[f++]->store(us->bytes_received.load(), TRUE);
   table->field[f++]->store(us->bytes_sent.load(), TRUE);
-  table->field[f++]->store(us->commands_ddl.load(), TRUE);
-  table->field[f++]->store(us->commands_delete.load(), TRUE);
-  table->field[f++]->store(us->commands_handler.load(), TRUE);
-  table->field[f++]->store(us->commands_insert.load(), TRUE);
-  table->field[f++]->store(us->commands_other.load(), TRUE);
-  table->field[f++]->store(us->commands_select.load(), TRUE);
-  table->field[f++]->store(us->commands_transaction.load(), TRUE);
-  table->field[f++]->store(us->commands_update.load(), TRUE);
+  table->field[f++]->store(us->counters.load(&C::commands_ddl), TRUE);
+  table->field[f++]->store(us->counters.load(&C::commands_delete), TRUE);
+  table->field[f++]->store(us->counters.load(&C::commands_handler), TRUE);
+  table->field[f++]->store(us->counters.load(&C::commands_insert), TRUE);
+  table->field[f++]->store(us->counters.load(&C::commands_other), TRUE);
+  table->field[f++]->store(us->counters.load(&C::commands_select), TRUE);
+  table->field[f++]->store(us->counters.load(&C::commands_transaction), TRUE);
+  table->field[f++]->store(us->counters.load(&C::commands_update), TRUE);
   /* concurrent connections for this user */
   table->field[f++]->store(connections, TRUE);
   table->field[f++]->store(us->connections_denied_max_global.load(), TRUE);
@@ -1882,29 +1863,30 @@ fill_one_user_stats(TABLE *table, USER_CONN *uc, USER_STATS* us,
   table->field[f++]->store(us->errors_net_ER_NET_WRITE_INTERRUPTED.load(),
                            TRUE);
   table->field[f++]->store(us->errors_total.load(), TRUE);
-  table->field[f++]->store(us->microseconds_wall.load(), TRUE);
-  table->field[f++]->store(us->microseconds_ddl.load(), TRUE);
-  table->field[f++]->store(us->microseconds_delete.load(), TRUE);
-  table->field[f++]->store(us->microseconds_handler.load(), TRUE);
-  table->field[f++]->store(us->microseconds_insert.load(), TRUE);
-  table->field[f++]->store(us->microseconds_other.load(), TRUE);
-  table->field[f++]->store(us->microseconds_select.load(), TRUE);
-  table->field[f++]->store(us->microseconds_transaction.load(), TRUE);
-  table->field[f++]->store(us->microseconds_update.load(), TRUE);
+  table->field[f++]->store(us->counters.load(&C::microseconds_wall), TRUE);
+  table->field[f++]->store(us->counters.load(&C::microseconds_ddl), TRUE);
+  table->field[f++]->store(us->counters.load(&C::microseconds_delete), TRUE);
+  table->field[f++]->store(us->counters.load(&C::microseconds_handler), TRUE);
+  table->field[f++]->store(us->counters.load(&C::microseconds_insert), TRUE);
+  table->field[f++]->store(us->counters.load(&C::microseconds_other), TRUE);
+  table->field[f++]->store(us->counters.load(&C::microseconds_select), TRUE);
+  table->field[f++]->store(us->counters.load(&C::microseconds_transaction),
+                           TRUE);
+  table->field[f++]->store(us->counters.load(&C::microseconds_update), TRUE);
   table->field[f++]->store(us->microseconds_cpu.load(), TRUE);
   table->field[f++]->store(us->microseconds_cpu_user.load(), TRUE);
   table->field[f++]->store(us->microseconds_cpu_sys.load(), TRUE);
 
-  table->field[f++]->store(us->queries_empty.load(), TRUE);
-  table->field[f++]->store(us->query_comment_bytes.load(), TRUE);
+  table->field[f++]->store(us->counters.load(&C::queries_empty), TRUE);
+  table->field[f++]->store(us->counters.load(&C::query_comment_bytes), TRUE);
   table->field[f++]->store(us->relay_log_bytes_written.load(), TRUE);
-  table->field[f++]->store(us->rows_deleted.load(), TRUE);
-  table->field[f++]->store(us->rows_fetched.load(), TRUE);
-  table->field[f++]->store(us->rows_inserted.load(), TRUE);
-  table->field[f++]->store(us->rows_read.load(), TRUE);
-  table->field[f++]->store(us->rows_updated.load(), TRUE);
-  table->field[f++]->store(us->rows_index_first.load(), TRUE);
-  table->field[f++]->store(us->rows_index_next.load(), TRUE);
+  table->field[f++]->store(us->counters.load(&C::rows_deleted), TRUE);
+  table->field[f++]->store(us->counters.load(&C::rows_fetched), TRUE);
+  table->field[f++]->store(us->counters.load(&C::rows_inserted), TRUE);
+  table->field[f++]->store(us->counters.load(&C::rows_read), TRUE);
+  table->field[f++]->store(us->counters.load(&C::rows_updated), TRUE);
+  table->field[f++]->store(us->counters.load(&C::rows_index_first), TRUE);
+  table->field[f++]->store(us->counters.load(&C::rows_index_next), TRUE);
   table->field[f++]->store(us->transactions_commit.load(), TRUE);
   table->field[f++]->store(us->transactions_rollback.load(), TRUE);
   table->field[f++]->store(us->n_gtid_unsafe_create_select.load(), TRUE);
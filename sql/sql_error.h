@@ -436,6 +436,10 @@ private:
   /** Reset the current row counter. Start counting from the first row. */
   void reset_current_row_for_warning() { m_current_row_for_warning= 1; }
 
+  /** Point the current row counter at a row that was counted before. */
+  void set_current_row_for_warning(ulong row)
+  { m_current_row_for_warning= row; }
+
   /** Return the current counter value. */
   ulong current_row_for_warning() const { return m_current_row_for_warning; }
 
@@ -740,6 +744,9 @@ public:
   void reset_current_row_for_warning()
   { get_warning_info()->reset_current_row_for_warning(); }
 
+  void set_current_row_for_warning(ulong row)
+  { get_warning_info()->set_current_row_for_warning(row); }
+
   bool is_warning_info_read_only() const
   { return get_warning_info()->is_read_only(); }
 
@@ -598,6 +598,151 @@ create_insert_stmt_from_insert_delayed(THD *thd, String *buf)
 }
 
 
+/**
+  Rows of an INSERT ... VALUES statement that are passed to the storage
+  engine in batches of up to insert_batch_rows rows, see
+  handler::ha_write_rows().
+
+  Only plain INSERT and INSERT IGNORE statements are batched, and only
+  when the rows need no auto-increment value, have no BLOB columns and
+  fire no triggers: a row is then complete once it has been copied out
+  of table->record[0], and nothing but the storage engine looks at it
+  until it is written.
+*/
+
+class Insert_batch
+{
+public:
+  Insert_batch(THD *thd, COPY_INFO *info)
+    : m_thd(thd), m_table(NULL), m_info(info), m_rows(NULL),
+      m_row_numbers(NULL), m_max_rows(0), m_n_rows(0)
+  {}
+
+  /**
+    Allocate the row buffers if the rows of the statement can be written
+    in batches. Must be called after table->next_number_field is set.
+
+    @param table     Table to insert into.
+    @param n_values  Number of rows in the VALUES list.
+  */
+  void init(TABLE *table, uint n_values)
+  {
+    const uint batch_rows= m_thd->variables.insert_batch_rows;
+    m_table= table;
+    if (batch_rows <= 1 || n_values <= 1 ||
+        m_info->get_duplicate_handling() != DUP_ERROR ||
+        m_table->triggers || m_table->next_number_field ||
+        m_table->s->blob_fields ||
+        m_thd->locked_tables_mode > LTM_LOCK_TABLES)
+      return;
+
+    const uint max_rows= MY_MIN(batch_rows, n_values);
+    const size_t reclength= m_table->s->reclength;
+    if (!(m_rows= (uchar**) m_thd->alloc(max_rows * sizeof(uchar*))) ||
+        !(m_row_numbers= (ulong*) m_thd->alloc(max_rows * sizeof(ulong))))
+      return;
+    for (uint i= 0; i < max_rows; i++)
+      if (!(m_rows[i]= (uchar*) m_thd->alloc(reclength)))
+        return;
+    m_max_rows= max_rows;
+  }
+
+  bool is_active() const { return m_max_rows != 0; }
+
+  /**
+    Add the row in table->record[0] to the batch, and write the batch if
+    it is full. Does for the row what write_record() does before writing
+    it.
+
+    @return 0 if ok, 1 if a row could not be written
+  */
+  int add()
+  {
+    DBUG_ASSERT(is_active());
+    m_info->stats.records++;
+    m_info->set_function_defaults(m_table);
+    m_row_numbers[m_n_rows]=
+      m_thd->get_stmt_da()->current_row_for_warning();
+    memcpy(m_rows[m_n_rows++], m_table->record[0], m_table->s->reclength);
+    return m_n_rows == m_max_rows ? flush() : 0;
+  }
+
+  /**
+    Write the rows of the batch. A row that fails with an error that
+    IGNORE can ignore is skipped, as in write_record(), and the rows
+    after it are written. Warnings and errors are reported against the
+    row that failed.
+
+    @return 0 if ok, 1 if a row could not be written
+  */
+  int flush()
+  {
+    handler *file= m_table->file;
+    Diagnostics_area *da= m_thd->get_stmt_da();
+    const ulong current_row= da->current_row_for_warning();
+    const uint n_rows= m_n_rows;
+    uint done= 0;
+    int error= 0;
+
+    m_n_rows= 0;
+    while (done < n_rows)
+    {
+      uint n_written= 0;
+      error= file->ha_write_rows(m_rows + done, n_rows - done, &n_written);
+      DBUG_ASSERT(n_written <= n_rows - done);
+      DBUG_ASSERT(!error || n_written < n_rows - done);
+      m_info->stats.copied+= n_written;
+      done+= n_written;
+      if (!error)
+        break;
+
+      DEBUG_SYNC(m_thd, "write_row_noreplace");
+      if (!m_info->get_ignore_errors() ||
+          file->is_fatal_error(error, HA_CHECK_DUP | HA_CHECK_FK_ERROR))
+        break;
+      if (!file->is_fatal_error(error, HA_CHECK_FK_ERROR))
+      {
+        da->set_current_row_for_warning(m_row_numbers[done]);
+        warn_fk_constraint_violation(m_thd, m_table, error);
+        da->set_current_row_for_warning(current_row);
+      }
+      error= 0;
+      done++;
+    }
+
+    if (!file->has_transactions() && (done || error == 0))
+      m_thd->transaction.stmt.mark_modified_non_trans_table();
+
+    if (error)
+    {
+      /* print_error() reports duplicate key values from table->record[0] */
+      memcpy(m_table->record[0], m_rows[done], m_table->s->reclength);
+      m_info->last_errno= error;
+      if (m_thd->lex->current_select)
+        m_thd->lex->current_select->no_error= 0;  // Give error
+      da->set_current_row_for_warning(m_row_numbers[done]);
+      file->print_error(error, MYF(0));
+      da->set_current_row_for_warning(current_row);
+      return 1;
+    }
+    return 0;
+  }
+
+private:
+  THD *m_thd;
+  TABLE *m_table;
+  COPY_INFO *m_info;
+  /** Row buffers, in the format of table->record[0] */
+  uchar **m_rows;
+  /** Row of the statement each buffered row is, for warnings */
+  ulong *m_row_numbers;
+  /** Capacity of the batch, 0 if rows are written one at a time */
+  uint m_max_rows;
+  /** Number of rows in the batch */
+  uint m_n_rows;
+};
+
+
 /**
   INSERT statement implementation
 
@@ -641,6 +786,7 @@ bool mysql_insert(THD *thd,TABLE_LIST *table_list,
                  duplic,
                  ignore);
   COPY_INFO update(COPY_INFO::UPDATE_OPERATION, &update_fields, &update_values);
+  Insert_batch batch(thd, &info);
   Name_resolution_context *context;
   Name_resolution_context_state ctx_state;
 #ifndef EMBEDDED_LIBRARY
@@ -935,6 +1081,11 @@ bool mysql_insert(THD *thd,TABLE_LIST *table_list,
       table_list->prepare_check_option(thd))
     error= 1;
 
+#ifndef EMBEDDED_LIBRARY
+  if (lock_type != TL_WRITE_DELAYED)
+#endif
+    batch.init(table, values_list.elements);
+
   while ((values= its++))
   {
     if (fields.elements || !value_count)
@@ -1027,12 +1178,19 @@ bool mysql_insert(THD *thd,TABLE_LIST *table_list,
     }
     else
 #endif
+    if (batch.is_active())
+      error= batch.add();
+    else
       error= write_record(thd, table, &info, &update);
     if (error)
       break;
     thd->get_stmt_da()->inc_current_row_for_warning();
   }
 
+  /* Write the rows added before the last row or an error in VALUES */
+  if (batch.is_active() && batch.flush() && !error)
+    error= 1;
+
   free_underlaid_joins(thd, &thd->lex->select_lex);
   joins_freed= TRUE;
 
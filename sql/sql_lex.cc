@@ -256,6 +256,55 @@ Lex_input_stream::reset(char *buffer, unsigned int length)
   in_comment=NO_COMMENT;
   m_underscore_cs= NULL;
   m_cpp_ptr= m_cpp_buf;
+  m_tok_buf= NULL;
+  m_tok_buf_end= NULL;
+  m_tok_buf_root= NULL;
+}
+
+
+/** Largest piece of the buffer for token copies */
+#define LEX_TOKEN_BUFFER_SIZE 4096
+
+/**
+  Allocate memory for the copy of a token.
+
+  The copies of identifiers and literals are taken from a buffer large
+  enough for the tokens of the rest of the query, so that a short
+  statement allocates memory once for all its tokens instead of once per
+  token. A new buffer is taken when the memory root of the THD changes,
+  as the body of a stored program is parsed into the memory root of the
+  program.
+
+  @param length  size of the copy, including the terminating 0
+
+  @return the memory of the copy, NULL if out of memory
+*/
+
+char *Lex_input_stream::alloc_token(size_t length)
+{
+  char *token;
+  if (m_tok_buf_root != m_thd->mem_root ||
+      (size_t) (m_tok_buf_end - m_tok_buf) < length)
+  {
+    /*
+      The tokens of the rest of the query, each with its 0, need at most
+      twice its length. Big queries take the buffer in pieces.
+    */
+    size_t size= length + 2 * (size_t) (m_end_of_query - m_ptr) + 1;
+    set_if_smaller(size, LEX_TOKEN_BUFFER_SIZE);
+    set_if_bigger(size, length);
+    if (!(m_tok_buf= (char*) m_thd->alloc(size)))
+    {
+      m_tok_buf_end= NULL;
+      m_tok_buf_root= NULL;
+      return NULL;
+    }
+    m_tok_buf_end= m_tok_buf + size;
+    m_tok_buf_root= m_thd->mem_root;
+  }
+  token= m_tok_buf;
+  m_tok_buf+= length;
+  return token;
 }
 
 
@@ -661,7 +710,11 @@ static LEX_STRING get_token(Lex_input_stream *lip, uint skip, uint length)
   LEX_STRING tmp;
   lip->yyUnget();                       // ptr points now after last token char
   tmp.length=lip->yytoklen=length;
-  tmp.str= lip->m_thd->strmake(lip->get_tok_start() + skip, tmp.length);
+  if ((tmp.str= lip->alloc_token(tmp.length + 1)))
+  {
+    memcpy(tmp.str, lip->get_tok_start() + skip, tmp.length);
+    tmp.str[tmp.length]= 0;
+  }
 
   lip->m_cpp_text_start= lip->get_cpp_tok_start() + skip;
   lip->m_cpp_text_end= lip->m_cpp_text_start + tmp.length;
@@ -685,7 +738,7 @@ static LEX_STRING get_quoted_token(Lex_input_stream *lip,
   char *to;
   lip->yyUnget();                       // ptr points now after last token char
   tmp.length= lip->yytoklen=length;
-  tmp.str=(char*) lip->m_thd->alloc(tmp.length+1);
+  tmp.str= lip->alloc_token(tmp.length + 1);
   from= lip->get_tok_start() + skip;
   to= tmp.str;
   end= to+length;
@@ -764,7 +817,7 @@ static char *get_text(Lex_input_stream *lip, int pre_skip, int post_skip)
       end -= post_skip;
       DBUG_ASSERT(end >= str);
 
-      if (!(start= (char*) lip->m_thd->alloc((uint) (end-str)+1)))
+      if (!(start= lip->alloc_token((uint) (end-str)+1)))
 	return (char*) "";		// Sql_alloc has set error flag
 
       lip->m_cpp_text_start= lip->get_cpp_tok_start() + pre_skip;
@@ -1179,6 +1232,7 @@ static int lex_one_token(YYSTYPE *yylval, THD *thd)
           }
           lip->skip_binary(l - 1);
         }
+        lip->skip_ascii_ident(ident_map);
         while (ident_map[c=lip->yyGet()])
         {
           if (my_mbcharlen(cs, c) > 1)
@@ -1195,6 +1249,7 @@ static int lex_one_token(YYSTYPE *yylval, THD *thd)
       else
 #endif
       {
+        lip->skip_ascii_ident(ident_map);
         for (result_state= c; ident_map[c= lip->yyGet()]; result_state|= c) ;
         /* If there were non-ASCII characters, mark that we must convert */
         result_state= result_state & 0x80 ? IDENT_QUOTED : IDENT;
@@ -1323,6 +1378,7 @@ static int lex_one_token(YYSTYPE *yylval, THD *thd)
       if (use_mb(cs))
       {
 	result_state= IDENT_QUOTED;
+        lip->skip_ascii_ident(ident_map);
         while (ident_map[c=lip->yyGet()])
         {
           if (my_mbcharlen(cs, c) > 1)
@@ -1339,6 +1395,7 @@ static int lex_one_token(YYSTYPE *yylval, THD *thd)
       else
 #endif
       {
+        lip->skip_ascii_ident(ident_map);
         for (result_state=0; ident_map[c= lip->yyGet()]; result_state|= c) ;
         /* If there were non-ASCII characters, mark that we must convert */
         result_state= result_state & 0x80 ? IDENT_QUOTED : IDENT;
@@ -1757,6 +1814,7 @@ static int lex_one_token(YYSTYPE *yylval, THD *thd)
 	[(global | local | session) .]variable_name
       */
 
+      lip->skip_ascii_ident(ident_map);
       for (result_state= 0; ident_map[c= lip->yyGet()]; result_state|= c) ;
       /* If there were non-ASCII characters, mark that we must convert */
       result_state= result_state & 0x80 ? IDENT_QUOTED : IDENT;
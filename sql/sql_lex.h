@@ -1864,6 +1864,8 @@ public:
 
   void reset(char *buff, unsigned int length);
 
+  char *alloc_token(size_t length);
+
   /**
     Set the echo mode.
 
@@ -1977,6 +1979,24 @@ public:
     m_ptr += n;
   }
 
+  /**
+    Accept the 7 bit identifier characters at the current position at once.
+    The characters after them are left for the caller to handle.
+    @param ident_map the identifier characters of the character set
+  */
+  void skip_ascii_ident(const uchar *ident_map)
+  {
+    const char *start= m_ptr;
+    uchar c;
+    while ((c= (uchar) *m_ptr) < 0x80 && ident_map[c])
+      m_ptr++;
+    if (m_echo)
+    {
+      memcpy(m_cpp_ptr, start, m_ptr - start);
+      m_cpp_ptr+= m_ptr - start;
+    }
+  }
+
   /**
     Puts a character back into the stream, canceling
     the effect of the last yyGet() or yySkip().
@@ -2195,6 +2215,15 @@ private:
   /** Pointer to the current position in the pre-processed input stream. */
   char *m_cpp_ptr;
 
+  /** Free part of the buffer for token copies, see alloc_token(). */
+  char *m_tok_buf;
+
+  /** End of the buffer for token copies. */
+  char *m_tok_buf_end;
+
+  /** The memory root the buffer for token copies is allocated from. */
+  MEM_ROOT *m_tok_buf_root;
+
   /**
     Starting position of the last token parsed,
     in the pre-processed buffer.
@@ -40,6 +40,7 @@
 #include "sql_trigger.h"
 #include "sql_show.h"
 #include <algorithm>
+#include <vector>
 #if defined(__linux__)
 #include <sys/vfs.h>
 #include <linux/magic.h>
@@ -139,6 +140,169 @@ public:
     while (GET != my_b_EOF)
       ;
   }
+
+  /**
+    Do not log the blocks that are read to the binary log. Used for the
+    readers of the Load_data_parallel workers, which only run when the
+    rows are logged instead of the file.
+  */
+  void disable_block_logging()
+  {
+    io_cache_set_preread_callback(&cache, NULL);
+    io_cache_set_preclose_callback(&cache, NULL);
+  }
+
+  /**
+    Restart reading at 'start', and stop at 'end' as if it was the end of
+    the file. 'start' must be the start of a line.
+  */
+  bool set_chunk(my_off_t start, my_off_t end)
+  {
+    found_end_of_line= eof= false;
+    line_cuted= found_null= false;
+    stack_pos= stack;
+    if (reinit_io_cache(&cache, READ_CACHE, start, 0, 1))
+      return true;
+    cache.end_of_file= end;
+    return false;
+  }
+};
+
+
+/**
+  Finds the lines of a LOAD DATA file in a memory buffer, so that the
+  file can be cut into chunks that are parsed in parallel.
+
+  The scanner takes the same steps as the READ_INFO::read_field() and
+  READ_INFO::next_line() calls that read_sep_field() makes for a row,
+  without storing the fields, so a line found by the scanner is exactly
+  a row read by READ_INFO. This holds byte by byte only for the formats
+  accepted by Load_data_parallel::can_parse().
+*/
+class Load_data_line_scanner
+{
+public:
+  Load_data_line_scanner(const CHARSET_INFO *cs, const String &field_term,
+                         const String &line_term, const String &enclosed,
+                         int escape, uint fields);
+
+  bool scan_line(const uchar *buf, size_t length, bool at_eof, bool skip,
+                 size_t *line_length, size_t *read_length);
+
+private:
+  /* Like GET and PUSH of READ_INFO, past the buffer reads my_b_EOF. */
+  int get()
+  {
+    int chr= m_pos < m_length ? m_buf[m_pos] : my_b_EOF;
+    if (++m_pos > m_max)
+      m_max= m_pos;
+    return chr;
+  }
+  void unget(uint count) { m_pos-= count; }
+  bool terminator(const uchar *ptr, uint length);
+  int read_field();
+  int next_line();
+
+  const CHARSET_INFO *m_charset;
+  const uchar *m_field_term_ptr, *m_line_term_ptr;
+  uint m_field_term_length, m_line_term_length;
+  int m_field_term_char, m_line_term_char, m_enclosed_char, m_escape_char;
+  uint m_fields;
+
+  const uchar *m_buf;
+  size_t m_length;
+  /* Position of the next character, and the highest position read. */
+  size_t m_pos, m_max;
+  bool m_found_end_of_line, m_eof;
+};
+
+
+/**
+  Parses the file of a LOAD DATA INFILE statement on worker threads.
+
+  The file is cut into chunks of whole lines with Load_data_line_scanner.
+  Worker threads claim the chunks in file order, and parse them with their
+  own READ_INFO into a buffer of fields. The client thread reads the
+  fields back in file order through the same interface as READ_INFO, so
+  read_sep_field() fills and writes the rows exactly as when it parses the
+  file itself.
+*/
+class Load_data_parallel
+{
+public:
+  /* The members of READ_INFO used by read_sep_field(). */
+  bool error, line_cuted, found_null, enclosed;
+  uchar *row_start, *row_end;
+  const CHARSET_INFO *read_charset;
+
+  Load_data_parallel(const char *file_name, uint fields,
+                     const CHARSET_INFO *cs, const String &field_term,
+                     const String &line_start, const String &line_term,
+                     const String &enclosed, int escape, ulong skip_lines);
+  ~Load_data_parallel();
+
+  static bool can_parse(THD *thd, const sql_exchange *ex,
+                        const CHARSET_INFO *cs, bool from_client,
+                        bool is_fifo);
+  bool start(uint threads, uint tot_length);
+  int read_field();
+  int next_line();
+
+  struct Worker
+  {
+    Load_data_parallel *load;
+    READ_INFO *read_info;
+    File file;
+    pthread_t thread;
+    bool started;
+  };
+  void run_worker(READ_INFO *read_info);
+
+private:
+  /* A chunk of the file, parsed into rows of fields. */
+  struct Chunk
+  {
+    std::vector<uchar> rows;
+    bool ready;
+    bool failed;
+  };
+
+  bool claim_chunk(my_off_t *start, my_off_t *end, Chunk **chunk);
+  bool find_chunk(my_off_t *start, my_off_t *end);
+  bool parse_chunk(READ_INFO *read_info, my_off_t start, my_off_t end,
+                   Chunk *chunk);
+  bool next_chunk();
+  void stop();
+
+  const char *m_file_name;
+  uint m_fields;
+  const String &m_field_term, &m_line_start, &m_line_term, &m_enclosed;
+  int m_escape;
+
+  /* Finding the chunks, by one worker at a time. */
+  Load_data_line_scanner m_scanner;
+  File m_scan_file;
+  uchar *m_scan_buf;
+  size_t m_scan_buf_size, m_chunk_size;
+  my_off_t m_scan_pos;
+  ulong m_skip_lines;
+  bool m_scanning, m_scan_done, m_scan_failed;
+
+  /* Chunks in file order, m_consumed is the one read by the client. */
+  std::vector<Chunk> m_chunks;
+  ulonglong m_claimed, m_consumed;
+  bool m_abort;
+  int m_errno;
+  std::vector<Worker> m_workers;
+  mysql_mutex_t m_mutex;
+  mysql_cond_t m_cond;
+
+  /* Reading of the current chunk by the client thread. */
+  Chunk *m_chunk;
+  size_t m_pos;
+  uint m_row_fields, m_field;
+  uchar m_row_flags;
+  bool m_in_row;
 };
 
 static int read_fixed_length(THD *thd, COPY_INFO &info, TABLE_LIST *table_list,
@@ -146,9 +310,10 @@ static int read_fixed_length(THD *thd, COPY_INFO &info, TABLE_LIST *table_list,
                              List<Item> &set_values, READ_INFO &read_info,
 			     ulong skip_lines,
 			     bool ignore_check_option_errors);
+template <class READER>
 static int read_sep_field(THD *thd, COPY_INFO &info, TABLE_LIST *table_list,
                           List<Item> &fields_vars, List<Item> &set_fields,
-                          List<Item> &set_values, READ_INFO &read_info,
+                          List<Item> &set_values, READER &read_info,
 			  const String &enclosed, ulong skip_lines,
 			  bool ignore_check_option_errors);
 
@@ -510,6 +675,12 @@ int mysql_load(THD *thd,sql_exchange *ex,TABLE_LIST *table_list,
     DBUG_RETURN(TRUE);				// Can't allocate buffers
   }
 
+  /* Parse the file on worker threads if its format allows it */
+  const bool parse_in_parallel=
+    thd->variables.load_data_parse_threads > 0 &&
+    Load_data_parallel::can_parse(thd, ex, read_info.read_charset,
+                                  read_file_from_client, is_fifo);
+
 #ifndef EMBEDDED_LIBRARY
   if (mysql_bin_log.is_open())
   {
@@ -523,8 +694,12 @@ int mysql_load(THD *thd,sql_exchange *ex,TABLE_LIST *table_list,
 
   thd->count_cuted_fields= CHECK_FIELD_WARN;		/* calc cuted fields */
   thd->cuted_fields=0L;
-  /* Skip lines if there is a line terminator */
-  if (ex->line_term->length() && ex->filetype != FILETYPE_XML)
+  /*
+    Skip lines if there is a line terminator. The parallel workers skip
+    them when they cut the file into chunks.
+  */
+  if (ex->line_term->length() && ex->filetype != FILETYPE_XML &&
+      !parse_in_parallel)
   {
     /* ex->skip_lines needs to be preserved for logging */
     while (skip_lines > 0)
@@ -560,6 +735,21 @@ int mysql_load(THD *thd,sql_exchange *ex,TABLE_LIST *table_list,
       error= read_fixed_length(thd, info, table_list, fields_vars,
                                set_fields, set_values, read_info,
 			       skip_lines, ignore);
+    else if (parse_in_parallel)
+    {
+      Load_data_parallel parallel_info(name, fields_vars.elements,
+                                       read_info.read_charset, *field_term,
+                                       *ex->line_start, *ex->line_term,
+                                       *enclosed, info.escape_char,
+                                       skip_lines);
+      if (parallel_info.start(thd->variables.load_data_parse_threads,
+                              tot_length))
+        error= 1;
+      else
+        error= read_sep_field(thd, info, table_list, fields_vars,
+                              set_fields, set_values, parallel_info,
+                              *enclosed, 0, ignore);
+    }
     else
       error= read_sep_field(thd, info, table_list, fields_vars,
                             set_fields, set_values, read_info,
@@ -1003,10 +1193,11 @@ continue_loop:;
 
 
 
+template <class READER>
 static int
 read_sep_field(THD *thd, COPY_INFO &info, TABLE_LIST *table_list,
                List<Item> &fields_vars, List<Item> &set_fields,
-               List<Item> &set_values, READ_INFO &read_info,
+               List<Item> &set_values, READER &read_info,
 	       const String &enclosed, ulong skip_lines,
 	       bool ignore_check_option_errors)
 {
@@ -2188,3 +2379,693 @@ found_eof:
   eof= 1;
   DBUG_RETURN(1);
 }
+
+
+/* Load_data_line_scanner */
+
+Load_data_line_scanner::Load_data_line_scanner(const CHARSET_INFO *cs,
+                                               const String &field_term,
+                                               const String &line_term,
+                                               const String &enclosed,
+                                               int escape, uint fields)
+  :m_charset(cs), m_escape_char(escape), m_fields(fields)
+{
+  /* Same as in the READ_INFO constructor */
+  m_field_term_ptr=
+    static_cast<const uchar*>(static_cast<const void*>(field_term.ptr()));
+  m_field_term_length= field_term.length();
+  m_line_term_ptr=
+    static_cast<const uchar*>(static_cast<const void*>(line_term.ptr()));
+  m_line_term_length= line_term.length();
+  m_enclosed_char= enclosed.length() ? (uchar) enclosed[0] : INT_MAX;
+  m_field_term_char= m_field_term_length ? m_field_term_ptr[0] : INT_MAX;
+  m_line_term_char= m_line_term_length ? m_line_term_ptr[0] : INT_MAX;
+}
+
+
+/**
+  Find the end of the line starting at 'buf'.
+
+  @param buf          Start of the line.
+  @param length       Number of bytes in the buffer.
+  @param at_eof       If the buffer ends at the end of the file.
+  @param skip         Only skip to the next line, as for IGNORE n LINES.
+  @param line_length  Set to the length of the line.
+  @param read_length  Set to the number of bytes looked at to find the end,
+                      which may be past the end of the line.
+
+  @retval true   The line was found.
+  @retval false  The buffer ends before the line, or before the bytes that
+                 are needed to find its end.
+*/
+
+bool Load_data_line_scanner::scan_line(const uchar *buf, size_t length,
+                                       bool at_eof, bool skip,
+                                       size_t *line_length,
+                                       size_t *read_length)
+{
+  m_buf= buf;
+  m_length= length;
+  m_pos= m_max= 0;
+  m_found_end_of_line= m_eof= false;
+
+  if (!skip)
+  {
+    for (uint i= 0; i < m_fields; i++)
+    {
+      if (read_field())
+        break;
+    }
+  }
+  next_line();
+
+  if (m_max > m_length && !at_eof)
+    return false;
+  *line_length= min(m_pos, m_length);
+  *read_length= min(m_max, m_length);
+  return true;
+}
+
+
+bool Load_data_line_scanner::terminator(const uchar *ptr, uint length)
+{
+  uint i;
+  for (i= 1; i < length; i++)
+  {
+    if (get() != ptr[i])
+      break;
+  }
+  if (i == length)
+    return true;
+  unget(i);
+  return false;
+}
+
+
+/**
+  The steps of READ_INFO::read_field(), without storing the field.
+*/
+
+int Load_data_line_scanner::read_field()
+{
+  int chr, found_enclosed_char;
+
+  if (m_found_end_of_line)
+    return 1;
+  if ((chr= get()) == my_b_EOF)
+  {
+    m_found_end_of_line= m_eof= true;
+    return 1;
+  }
+  if (chr == m_enclosed_char)
+    found_enclosed_char= m_enclosed_char;
+  else
+  {
+    found_enclosed_char= INT_MAX;
+    unget(1);
+  }
+
+  for (;;)
+  {
+    chr= get();
+    if (chr == my_b_EOF)
+      break;
+    if (chr == m_escape_char)
+    {
+      if ((chr= get()) == my_b_EOF)
+        break;
+      if (m_escape_char != m_enclosed_char || chr == m_escape_char)
+        continue;
+      unget(1);
+      chr= m_escape_char;
+    }
+    if (chr == m_line_term_char && found_enclosed_char == INT_MAX)
+    {
+      if (terminator(m_line_term_ptr, m_line_term_length))
+      {
+        m_found_end_of_line= true;
+        return 0;
+      }
+    }
+    if (chr == found_enclosed_char)
+    {
+      if ((chr= get()) == found_enclosed_char)
+        continue;
+      if (chr == my_b_EOF ||
+          (chr == m_line_term_char && terminator(m_line_term_ptr,
+                                                 m_line_term_length)))
+      {
+        m_found_end_of_line= true;
+        return 0;
+      }
+      if (chr == m_field_term_char &&
+          terminator(m_field_term_ptr, m_field_term_length))
+        return 0;
+      unget(1);
+      chr= found_enclosed_char;
+    }
+    else if (chr == m_field_term_char && found_enclosed_char == INT_MAX)
+    {
+      if (terminator(m_field_term_ptr, m_field_term_length))
+        return 0;
+    }
+#ifdef USE_MB
+    uint ml= my_mbcharlen(m_charset, chr);
+    if (ml > 1)
+    {
+      size_t start= m_pos - 1;
+      uint i;
+      for (i= 1; i < ml; i++)
+      {
+        if (get() == my_b_EOF)
+          break;
+      }
+      if (i < ml)
+        break;
+      if (my_ismbchar(m_charset, (const char *) m_buf + start,
+                      (const char *) m_buf + m_pos))
+        continue;
+      unget(ml - 1);
+    }
+#endif
+  }
+
+  /* End of file */
+  m_found_end_of_line= m_eof= true;
+  return 0;
+}
+
+
+/**
+  The steps of READ_INFO::next_line().
+*/
+
+int Load_data_line_scanner::next_line()
+{
+  if (m_found_end_of_line || m_eof)
+  {
+    m_found_end_of_line= false;
+    return m_eof;
+  }
+  for (;;)
+  {
+    int chr= get();
+#ifdef USE_MB
+    if (chr == my_b_EOF)
+    {
+      m_eof= true;
+      return 1;
+    }
+    if (my_mbcharlen(m_charset, chr) > 1)
+    {
+      for (uint i= 1;
+           chr != my_b_EOF && i < my_mbcharlen(m_charset, chr);
+           i++)
+        chr= get();
+      if (chr == m_escape_char)
+        continue;
+    }
+#endif
+    if (chr == my_b_EOF)
+    {
+      m_eof= true;
+      return 1;
+    }
+    if (chr == m_escape_char)
+    {
+      if (get() == my_b_EOF)
+        return 1;
+      continue;
+    }
+    if (chr == m_line_term_char &&
+        terminator(m_line_term_ptr, m_line_term_length))
+      return 0;
+  }
+}
+
+
+/* Load_data_parallel */
+
+/* Lines are collected into chunks of at least this size. */
+static const size_t LOAD_DATA_CHUNK_SIZE= 4 * 1024 * 1024;
+
+/* Layout of the rows of a parsed chunk. */
+static const uint LOAD_DATA_HEADER_SIZE= 5;
+static const uchar LOAD_DATA_ROW_LINE_CUTED= 1;
+static const uchar LOAD_DATA_ROW_EOF= 2;
+static const uchar LOAD_DATA_FIELD_ENCLOSED= 1;
+static const uchar LOAD_DATA_FIELD_NULL= 2;
+
+
+Load_data_parallel::Load_data_parallel(const char *file_name, uint fields,
+                                       const CHARSET_INFO *cs,
+                                       const String &field_term,
+                                       const String &line_start,
+                                       const String &line_term,
+                                       const String &enclosed_par,
+                                       int escape, ulong skip_lines)
+  :error(false), line_cuted(false), found_null(false), enclosed(false),
+   row_start(NULL), row_end(NULL), read_charset(cs),
+   m_file_name(file_name), m_fields(fields), m_field_term(field_term),
+   m_line_start(line_start), m_line_term(line_term), m_enclosed(enclosed_par),
+   m_escape(escape),
+   m_scanner(cs, field_term, line_term, enclosed_par, escape, fields),
+   m_scan_file(-1), m_scan_buf(NULL), m_scan_buf_size(0),
+   m_chunk_size(LOAD_DATA_CHUNK_SIZE), m_scan_pos(0), m_skip_lines(skip_lines),
+   m_scanning(false), m_scan_done(false), m_scan_failed(false),
+   m_claimed(0), m_consumed(0), m_abort(false), m_errno(0),
+   m_chunk(NULL), m_pos(0), m_row_fields(0), m_field(0), m_row_flags(0),
+   m_in_row(false)
+{
+  DBUG_EXECUTE_IF("load_data_parse_small_chunks", m_chunk_size= 16;);
+  mysql_mutex_init(key_load_data_parallel_mutex, &m_mutex,
+                   MY_MUTEX_INIT_FAST);
+  mysql_cond_init(key_load_data_parallel_cond, &m_cond, NULL);
+}
+
+
+Load_data_parallel::~Load_data_parallel()
+{
+  stop();
+  for (size_t i= 0; i < m_workers.size(); i++)
+  {
+    delete m_workers[i].read_info;
+    if (m_workers[i].file >= 0)
+      mysql_file_close(m_workers[i].file, MYF(0));
+  }
+  if (m_scan_file >= 0)
+    mysql_file_close(m_scan_file, MYF(0));
+  my_free(m_scan_buf);
+  mysql_cond_destroy(&m_cond);
+  mysql_mutex_destroy(&m_mutex);
+}
+
+
+/**
+  Check if the file of a LOAD DATA statement can be parsed in parallel.
+
+  The file must be a regular file on the server, as it is read again by
+  the workers, and its lines must be found without parsing the file from
+  the start: the fields are delimited, the lines have a terminator and no
+  prefix, and no byte of a multi-byte character can be taken for one of
+  the separators. The file must not be needed for the binary log either.
+*/
+
+bool Load_data_parallel::can_parse(THD *thd, const sql_exchange *ex,
+                                   const CHARSET_INFO *cs, bool from_client,
+                                   bool is_fifo)
+{
+  const String *field_term= ex->field_term, *line_term= ex->line_term;
+
+  if (from_client || is_fifo || thd->slave_thread || ex->load_compressed ||
+      thd->lex->disable_flashcache || ex->filetype == FILETYPE_XML)
+    return false;
+  if ((!field_term->length() && !ex->enclosed->length()) ||
+      ex->line_start->length() || !line_term->length() ||
+      (field_term->length() == line_term->length() &&
+       !memcmp(field_term->ptr(), line_term->ptr(), line_term->length())))
+    return false;
+  if (!field_term->is_ascii() || !line_term->is_ascii() ||
+      !ex->enclosed->is_ascii() || !ex->escaped->is_ascii())
+    return false;
+  if (cs->mbmaxlen > 1 && strcmp(cs->csname, "utf8") &&
+      strcmp(cs->csname, "utf8mb4"))
+    return false;
+  if (mysql_bin_log.is_open() && !thd->is_current_stmt_binlog_format_row())
+    return false;
+  return true;
+}
+
+
+pthread_handler_t load_data_parse_thread(void *arg)
+{
+  Load_data_parallel::Worker *worker=
+    static_cast<Load_data_parallel::Worker*>(arg);
+  my_thread_init();
+  worker->load->run_worker(worker->read_info);
+  my_thread_end();
+  return NULL;
+}
+
+
+/**
+  Open the file for the workers, and start them.
+
+  The readers of the workers are created here, as READ_INFO allocates on
+  the MEM_ROOT of the statement.
+*/
+
+bool Load_data_parallel::start(uint threads, uint tot_length)
+{
+  DBUG_ENTER("Load_data_parallel::start");
+  m_scan_buf_size= 2 * m_chunk_size;
+  if ((m_scan_file= mysql_file_open(key_file_load, m_file_name, O_RDONLY,
+                                    MYF(MY_WME))) < 0 ||
+      !(m_scan_buf= (uchar*) my_malloc(m_scan_buf_size, MYF(MY_WME))))
+    DBUG_RETURN(true);
+
+  m_chunks.resize(2 * threads);
+  m_workers.resize(threads);
+  for (uint i= 0; i < threads; i++)
+  {
+    Worker *worker= &m_workers[i];
+    worker->load= this;
+    worker->read_info= NULL;
+    worker->started= false;
+    if ((worker->file= mysql_file_open(key_file_load, m_file_name, O_RDONLY,
+                                       MYF(MY_WME))) < 0)
+      DBUG_RETURN(true);
+    worker->read_info= new READ_INFO(worker->file, tot_length, read_charset,
+                                     m_field_term, m_line_start, m_line_term,
+                                     m_enclosed, m_escape, false, false,
+                                     false, false);
+    if (worker->read_info->error)
+    {
+      my_error(ER_OUTOFMEMORY, MYF(ME_FATALERROR), tot_length);
+      DBUG_RETURN(true);
+    }
+    worker->read_info->disable_block_logging();
+  }
+
+  for (uint i= 0; i < threads; i++)
+  {
+    Worker *worker= &m_workers[i];
+    if (mysql_thread_create(key_thread_load_data_parse, &worker->thread,
+                            NULL, load_data_parse_thread, worker))
+    {
+      my_error(ER_CANT_CREATE_THREAD, MYF(0), errno);
+      DBUG_RETURN(true);
+    }
+    worker->started= true;
+  }
+  DBUG_RETURN(false);
+}
+
+
+/**
+  Stop the workers, also when the client thread stops reading the rows
+  before the end of the file.
+*/
+
+void Load_data_parallel::stop()
+{
+  mysql_mutex_lock(&m_mutex);
+  m_abort= true;
+  mysql_cond_broadcast(&m_cond);
+  mysql_mutex_unlock(&m_mutex);
+
+  for (size_t i= 0; i < m_workers.size(); i++)
+  {
+    if (m_workers[i].started)
+    {
+      pthread_join(m_workers[i].thread, NULL);
+      m_workers[i].started= false;
+    }
+  }
+}
+
+
+void Load_data_parallel::run_worker(READ_INFO *read_info)
+{
+  my_off_t start, end;
+  Chunk *chunk;
+
+  while (claim_chunk(&start, &end, &chunk))
+  {
+    bool failed= parse_chunk(read_info, start, end, chunk);
+    int errcode= my_errno;
+
+    mysql_mutex_lock(&m_mutex);
+    chunk->failed= failed;
+    chunk->ready= true;
+    if (failed && !m_errno)
+      m_errno= errcode;
+    mysql_cond_broadcast(&m_cond);
+    mysql_mutex_unlock(&m_mutex);
+  }
+}
+
+
+/**
+  Find the next chunk of the file, and reserve a buffer for its rows.
+
+  At most two chunks per worker are parsed ahead of the client thread.
+  The chunks are found by one worker at a time, but without holding the
+  mutex, which the client thread needs to get the parsed chunks.
+
+  @retval false  No more chunks, or the load is stopped.
+*/
+
+bool Load_data_parallel::claim_chunk(my_off_t *start, my_off_t *end,
+                                     Chunk **chunk)
+{
+  bool claimed= false;
+
+  mysql_mutex_lock(&m_mutex);
+  while (!m_abort && !m_scan_done &&
+         (m_scanning || m_claimed - m_consumed >= m_chunks.size()))
+    mysql_cond_wait(&m_cond, &m_mutex);
+
+  if (!m_abort && !m_scan_done)
+  {
+    m_scanning= true;
+    mysql_mutex_unlock(&m_mutex);
+    bool failed= find_chunk(start, end);
+    int errcode= my_errno;
+    mysql_mutex_lock(&m_mutex);
+    m_scanning= false;
+
+    if (failed)
+    {
+      m_scan_failed= m_scan_done= true;
+      if (!m_errno)
+        m_errno= errcode;
+    }
+    else if (*start == *end)
+      m_scan_done= true;
+    else
+    {
+      *chunk= &m_chunks[m_claimed % m_chunks.size()];
+      (*chunk)->ready= (*chunk)->failed= false;
+      m_claimed++;
+      m_scan_pos= *end;
+      claimed= true;
+    }
+    mysql_cond_broadcast(&m_cond);
+  }
+  mysql_mutex_unlock(&m_mutex);
+  return claimed;
+}
+
+
+/**
+  Find the lines of the next chunk, which starts at m_scan_pos after the
+  lines that are still to be skipped. The chunk ends at the first line
+  end after m_chunk_size bytes, or at the end of the file.
+*/
+
+bool Load_data_parallel::find_chunk(my_off_t *start, my_off_t *end)
+{
+  for (;;)
+  {
+    size_t length= mysql_file_pread(m_scan_file, m_scan_buf, m_scan_buf_size,
+                                    m_scan_pos, MYF(0));
+    if (length == MY_FILE_ERROR)
+      return true;
+    bool at_eof= length < m_scan_buf_size;
+    ulong skip_lines= m_skip_lines;
+    size_t pos= 0, chunk_start= 0, chunk_end= 0, read_end= 0;
+    bool complete= true;
+
+    while (pos < length)
+    {
+      size_t line_length, read_length;
+      if (!m_scanner.scan_line(m_scan_buf + pos, length - pos, at_eof,
+                               skip_lines > 0, &line_length, &read_length))
+      {
+        complete= false;
+        break;
+      }
+      set_if_bigger(read_end, pos + read_length);
+      pos+= line_length;
+      if (line_length == 0)
+        break;
+      if (skip_lines)
+      {
+        skip_lines--;
+        chunk_start= chunk_end= pos;
+        continue;
+      }
+      /*
+        A line may only end the chunk if the line after it was not looked
+        at, so that the reader of the chunk takes the same steps.
+      */
+      if (read_end <= pos)
+      {
+        chunk_end= pos;
+        if (chunk_end - chunk_start >= m_chunk_size)
+          break;
+      }
+    }
+
+    if (complete && at_eof)
+      chunk_end= pos;
+    if (chunk_end == chunk_start && !(complete && at_eof))
+    {
+      /* A line does not fit in the buffer */
+      uchar *new_buf= (uchar*) my_realloc(m_scan_buf, 2 * m_scan_buf_size,
+                                          MYF(MY_WME));
+      if (!new_buf)
+        return true;
+      m_scan_buf= new_buf;
+      m_scan_buf_size*= 2;
+      continue;
+    }
+    m_skip_lines= skip_lines;
+    *start= m_scan_pos + chunk_start;
+    *end= m_scan_pos + chunk_end;
+    return false;
+  }
+}
+
+
+/**
+  Parse a chunk with the READ_INFO of the worker, like read_sep_field()
+  does, and store the fields of each row in the buffer of the chunk:
+
+    row:   [fields:4][flags:1] followed by the fields
+    field: [length:4][flags:1][data][0]
+
+  The chunk ends with a row of 0 fields.
+*/
+
+bool Load_data_parallel::parse_chunk(READ_INFO *read_info, my_off_t start,
+                                     my_off_t end, Chunk *chunk)
+{
+  std::vector<uchar> &rows= chunk->rows;
+
+  rows.clear();
+  if (read_info->set_chunk(start, end))
+    return true;
+  for (;;)
+  {
+    size_t row_pos= rows.size();
+    uint fields;
+
+    rows.resize(row_pos + LOAD_DATA_HEADER_SIZE);
+    for (fields= 0; fields < m_fields; fields++)
+    {
+      if (read_info->read_field())
+        break;
+      size_t length= read_info->row_end - read_info->row_start;
+      size_t pos= rows.size();
+      rows.resize(pos + LOAD_DATA_HEADER_SIZE + length + 1);
+      int4store(&rows[pos], (uint32) length);
+      rows[pos + 4]= (read_info->enclosed ? LOAD_DATA_FIELD_ENCLOSED : 0) |
+                     (read_info->found_null ? LOAD_DATA_FIELD_NULL : 0);
+      memcpy(&rows[pos + LOAD_DATA_HEADER_SIZE], read_info->row_start,
+             length);
+      rows[pos + LOAD_DATA_HEADER_SIZE + length]= 0;
+    }
+    if (read_info->error)
+      return true;
+    if (fields == 0)
+    {
+      int4store(&rows[row_pos], 0);
+      rows[row_pos + 4]= 0;
+      return false;
+    }
+    bool eof= read_info->next_line();
+    int4store(&rows[row_pos], fields);
+    rows[row_pos + 4]= (read_info->line_cuted ? LOAD_DATA_ROW_LINE_CUTED : 0) |
+                       (eof ? LOAD_DATA_ROW_EOF : 0);
+    if (eof)
+    {
+      rows.resize(rows.size() + LOAD_DATA_HEADER_SIZE);
+      int4store(&rows[rows.size() - LOAD_DATA_HEADER_SIZE], 0);
+      return false;
+    }
+  }
+}
+
+
+/**
+  Wait for the next chunk in file order to be parsed.
+
+  @retval false  No more rows, or an error, which is set in 'error'.
+*/
+
+bool Load_data_parallel::next_chunk()
+{
+  mysql_mutex_lock(&m_mutex);
+  if (m_chunk)
+  {
+    m_chunk= NULL;
+    m_consumed++;
+    mysql_cond_broadcast(&m_cond);
+  }
+
+  Chunk *chunk= &m_chunks[m_consumed % m_chunks.size()];
+  while (!(m_consumed < m_claimed && chunk->ready) &&
+         !(m_scan_done && m_consumed == m_claimed))
+    mysql_cond_wait(&m_cond, &m_mutex);
+
+  if (m_consumed < m_claimed ? chunk->failed : m_scan_failed)
+    error= true;
+  else if (m_consumed < m_claimed)
+  {
+    m_chunk= chunk;
+    m_pos= 0;
+  }
+  int errcode= m_errno;
+  mysql_mutex_unlock(&m_mutex);
+
+  if (error)
+  {
+    char errbuf[MYSYS_STRERROR_SIZE];
+    my_error(ER_ERROR_ON_READ, MYF(0), m_file_name, errcode,
+             my_strerror(errbuf, sizeof(errbuf), errcode));
+  }
+  return m_chunk != NULL;
+}
+
+
+int Load_data_parallel::read_field()
+{
+  found_null= false;
+  if (!m_in_row)
+  {
+    /* Start the next row, from the next chunk if this one is done */
+    while (!m_chunk || !uint4korr(&m_chunk->rows[m_pos]))
+    {
+      if (!next_chunk())
+        return 1;
+    }
+    m_row_fields= uint4korr(&m_chunk->rows[m_pos]);
+    m_row_flags= m_chunk->rows[m_pos + 4];
+    m_pos+= LOAD_DATA_HEADER_SIZE;
+    m_field= 0;
+    m_in_row= true;
+  }
+  if (m_field == m_row_fields)
+    return 1;
+
+  const uchar *row= &m_chunk->rows[0];
+  size_t length= uint4korr(row + m_pos);
+  enclosed= row[m_pos + 4] & LOAD_DATA_FIELD_ENCLOSED;
+  found_null= row[m_pos + 4] & LOAD_DATA_FIELD_NULL;
+  row_start= const_cast<uchar*>(row) + m_pos + LOAD_DATA_HEADER_SIZE;
+  row_end= row_start + length;
+  m_pos+= LOAD_DATA_HEADER_SIZE + length + 1;
+  m_field++;
+  return 0;
+}
+
+
+int Load_data_parallel::next_line()
+{
+  DBUG_ASSERT(m_in_row);
+  m_in_row= false;
+  line_cuted= m_row_flags & LOAD_DATA_ROW_LINE_CUTED;
+  return MY_TEST(m_row_flags & LOAD_DATA_ROW_EOF);
+}
@@ -1555,6 +1555,8 @@ static inline bool is_query(enum enum_server_command command) {
   @param packet_length   length of packet + 1 (to show that data is
                          null-terminated) except for COM_SLEEP, where it
                          can be zero.
+  @param rpc_session     the detached session a multiplexed request runs
+                         in, attached to the current thread; thd is its THD
 
   @todo
     set thd->lex->sql_command to SQLCOM_END here.
@@ -1568,7 +1570,8 @@ static inline bool is_query(enum enum_server_command command) {
         COM_QUIT/COM_SHUTDOWN
 */
 bool dispatch_command(enum enum_server_command command, THD *thd, char* packet,
-                      uint packet_length)
+                      uint packet_length,
+                      std::shared_ptr<Srv_session> rpc_session)
 {
   NET *net= thd->get_net();
   bool error= 0;
@@ -1586,7 +1589,7 @@ bool dispatch_command(enum enum_server_command command, THD *thd, char* packet,
   bool rpc_error = false;
   bool state_changed = false;
   THD *save_thd = nullptr;
-  std::shared_ptr<Srv_session> srv_session;
+  std::shared_ptr<Srv_session> srv_session = std::move(rpc_session);
 
   if (command == COM_QUERY_ATTRS) {
     auto packet_ptr = packet;
@@ -1601,6 +1604,14 @@ bool dispatch_command(enum enum_server_command command, THD *thd, char* packet,
     packet_length -= bytes_to_skip;
     packet += bytes_to_skip; // command byte gets jumped below
 
+    if (rpc_multiplex_requested(thd))
+      DBUG_RETURN(dispatch_multiplexed_rpc(thd, packet, packet_length));
+  }
+
+  // Send the responses to the multiplexed requests of the connection first
+  rpc_multiplex_wait(thd);
+
+  if (command == COM_QUERY_ATTRS) {
     std::tie(rpc_error, srv_session) = handle_com_rpc(thd);
     if (rpc_error) {
       goto done;
@@ -2453,7 +2464,7 @@ done:
 
   dec_thread_running();
   thd->packet.shrink(thd->variables.net_buffer_length);	// Reclaim some memory
-  free_root(thd->mem_root,MYF(MY_KEEP_PREALLOC));
+  thd->free_statement_mem_root();
 
   /* DTRACE instrumentation, end */
   if (MYSQL_QUERY_DONE_ENABLED() || MYSQL_COMMAND_DONE_ENABLED())
@@ -2498,11 +2509,12 @@ done:
   if (thd->lex->sql_command == SQLCOM_SELECT && thd->get_sent_row_count() == 0)
   {
     USER_STATS *us= thd_get_user_stats(thd);
-    us->queries_empty.inc();
+    us->counters.local().queries_empty.inc();
   }
 
   // if it's a COM RPC, clean up all the server session information
-  if (srv_session) {
+  // (a multiplexed request is cleaned up by its worker)
+  if (srv_session && save_thd) {
     // stage information (for SHOW PROCESSLIST)
     save_thd->copy_stage_info(thd);
     thd->clear_net();
@@ -3314,7 +3326,7 @@ mysql_execute_command(THD *thd,
   DBUG_ENTER("mysql_execute_command");
   DBUG_ASSERT(!lex->describe || is_explainable_query(lex->sql_command));
 
-  thd->stmt_start = *statement_start_time;
+  thd->set_stmt_start(*statement_start_time);
 
 #if HAVE_CLOCK_GETTIME
     timespec time_beg;
@@ -6387,18 +6399,19 @@ finish:
     ulonglong latency = my_timer_since(*statement_start_time);
     ulonglong microsecs= (ulonglong)
       my_timer_to_microseconds(latency);
+    user_stats_counters &counters= us->counters.local();
 
     switch (lex->sql_command) {
     case SQLCOM_UPDATE:
     case SQLCOM_UPDATE_MULTI:
-      us->commands_update.inc();
-      us->microseconds_update.inc(microsecs);
+      counters.commands_update.inc();
+      counters.microseconds_update.inc(microsecs);
       latency_histogram_increment(&(us->histogram_update_command), latency, 1);
       break;
     case SQLCOM_DELETE:
     case SQLCOM_DELETE_MULTI:
-      us->commands_delete.inc();
-      us->microseconds_delete.inc(microsecs);
+      counters.commands_delete.inc();
+      counters.microseconds_delete.inc(microsecs);
       latency_histogram_increment(&(us->histogram_delete_command), latency, 1);
       break;
     case SQLCOM_INSERT:
@@ -6406,13 +6419,13 @@ finish:
     case SQLCOM_REPLACE:
     case SQLCOM_REPLACE_SELECT:
     case SQLCOM_LOAD:
-      us->commands_insert.inc();
-      us->microseconds_insert.inc(microsecs);
+      counters.commands_insert.inc();
+      counters.microseconds_insert.inc(microsecs);
       latency_histogram_increment(&(us->histogram_insert_command), latency, 1);
       break;
     case SQLCOM_SELECT:
-      us->commands_select.inc();
-      us->microseconds_select.inc(microsecs);
+      counters.commands_select.inc();
+      counters.microseconds_select.inc(microsecs);
       latency_histogram_increment(&(us->histogram_select_command), latency, 1);
       break;
     case SQLCOM_CREATE_TABLE:
@@ -6424,15 +6437,15 @@ finish:
     case SQLCOM_DROP_DB:
     case SQLCOM_ALTER_DB:
     case SQLCOM_TRUNCATE:
-      us->commands_ddl.inc();
-      us->microseconds_other.inc(microsecs);
+      counters.commands_ddl.inc();
+      counters.microseconds_other.inc(microsecs);
       latency_histogram_increment(&(us->histogram_ddl_command), latency, 1);
       break;
     case SQLCOM_BEGIN:
     case SQLCOM_COMMIT:
     case SQLCOM_ROLLBACK:
-      us->commands_transaction.inc();
-      us->microseconds_transaction.inc(microsecs);
+      counters.commands_transaction.inc();
+      counters.microseconds_transaction.inc(microsecs);
       latency_histogram_increment(&(us->histogram_transaction_command),
                                   latency, 1);
       break;
@@ -6440,13 +6453,13 @@ finish:
     case SQLCOM_HA_OPEN:
     case SQLCOM_HA_READ:
 //    case SQLCOM_HA_OPEN_READ_CLOSE:
-      us->commands_handler.inc();
-      us->microseconds_handler.inc(microsecs);
+      counters.commands_handler.inc();
+      counters.microseconds_handler.inc(microsecs);
       latency_histogram_increment(&(us->histogram_handler_command), latency, 1);
       break;
     default:
-      us->commands_other.inc();
-      us->microseconds_other.inc(microsecs);
+      counters.commands_other.inc();
+      counters.microseconds_other.inc(microsecs);
       latency_histogram_increment(&(us->histogram_other_command), latency, 1);
       break;
     }
@@ -6490,7 +6503,7 @@ finish:
   if (thd->is_real_trans)
     thd->trx_time = 0;
   // Reset statement start time
-  thd->stmt_start = 0;
+  thd->set_stmt_start(0);
   lex->unit.cleanup();
   /* Free tables */
   THD_STAGE_INFO(thd, stage_closing_tables);
@@ -8077,7 +8090,7 @@ void mysql_parse(THD *thd, char *rawbuf, uint length,
   {
     USER_STATS *us=
       &((const_cast<USER_CONN*>(thd->get_user_connect()))->user_stats);
-    us->rows_fetched.inc(thd->get_sent_row_count());
+    us->counters.local().rows_fetched.inc(thd->get_sent_row_count());
   }
 
   DBUG_VOID_RETURN;
@@ -1,6 +1,11 @@
 #include "sql_parse.h"
 #include "sql_parse_com_rpc.h"
 
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+
+#include "mysqld.h"
 #include "sql_acl.h"
 #include "srv_session.h"
 
@@ -59,7 +64,171 @@ void reset_conn_thd_after_query_execution(THD* thd) {
 
   thd->get_stmt_da()->reset_message();
   thd->packet.shrink(thd->variables.net_buffer_length);	// Reclaim some memory
-  free_root(thd->mem_root,MYF(MY_KEEP_PREALLOC));
+  thd->free_statement_mem_root();
+}
+
+/*
+  Find the detached session of rpc_id, for a client connecting from
+  host_or_ip.
+
+  @retval
+    false  success
+  @retval
+    true   failure, the error is set
+*/
+static bool access_rpc_session(const std::string& rpc_id,
+                               const std::string& host_or_ip,
+                               std::shared_ptr<Srv_session>& srv_session)
+{
+  auto session_id = Srv_session::parse_session_key(rpc_id);
+  if (session_id == (my_thread_id) -1) {
+    my_error(ER_RPC_MALFORMED_ID, MYF(0), rpc_id.c_str());
+    return true;
+  }
+
+  srv_session = Srv_session::access_session(session_id);
+  if (!srv_session)
+  {
+    bool timed_out;
+    std::chrono::milliseconds idle_timeout;
+    std::tie(timed_out, idle_timeout) =
+        Srv_session::session_timed_out(session_id);
+    if (timed_out) {
+      my_error(ER_RPC_IDLE_TIMEOUT, MYF(0), rpc_id.c_str(),
+          (uint32_t) idle_timeout.count());
+    } else {
+      my_error(ER_RPC_INVALID_ID, MYF(0), rpc_id.c_str());
+    }
+
+    return true;
+  }
+
+  // Check to make sure the current user is coming from the same machine as
+  // the srv_session was originally created from
+  std::string curr_host_or_ip = host_or_ip;
+
+  DBUG_EXECUTE_IF("rpc_id_different_ip",
+      {
+        curr_host_or_ip = "other_host";
+      });
+
+  if (srv_session->get_host_or_ip() != curr_host_or_ip)
+  {
+    my_error(ER_RPC_HOST_MISMATCH, MYF(0), rpc_id.c_str());
+    return true;
+  }
+
+  DBUG_PRINT("info", ("Found session in map, rpc_id=%s", rpc_id.c_str()));
+  return false;
+}
+
+/*
+  Open a session for rpc_role and rpc_db, on behalf of the user of the
+  connection. With use_default the default session of the connection is
+  used if it has one, and a new session becomes the default session.
+
+  @retval
+    false  success
+  @retval
+    true   failure, the error is set
+*/
+static bool open_rpc_session(THD *conn_thd,
+                             const std::string& rpc_role,
+                             const std::string& rpc_db,
+                             bool use_default,
+                             std::shared_ptr<Srv_session>& srv_session,
+                             bool *used_default_srv_session)
+{
+  THD* srv_session_thd = NULL;
+  Security_context* conn_security_ctx = NULL;
+
+  // Use default session from conn thd. We put it back at the end if execution
+  // was successful and there was no session state change.
+  if (use_default)
+    srv_session = conn_thd->get_default_srv_session();
+  if (!srv_session)
+  {
+    // default one not present, allocate a new session
+    srv_session = std::shared_ptr<Srv_session>(new Srv_session);
+
+    if (srv_session->open(conn_thd))
+    {
+      my_error(ER_RPC_SESSION_OPEN, MYF(0));
+      return true;
+    }
+
+    // enable state change tracking
+    srv_session->get_thd()->session_tracker.get_tracker(
+              SESSION_STATE_CHANGE_TRACKER)->force_enable();
+    srv_session->get_thd()->session_tracker.get_tracker(
+              SESSION_RESP_ATTR_TRACKER)->force_enable();
+    if (use_default)
+      conn_thd->set_default_srv_session(srv_session);
+    // newly created sessions need the net_ptr set to null
+    srv_session->get_thd()->clear_net();
+  }
+  else
+  {
+    // set to know if to reset if after query execution state changes
+    *used_default_srv_session = true;
+  }
+
+  srv_session_thd = srv_session->get_thd();
+  srv_session->set_host_or_ip(conn_thd->main_security_ctx.host_or_ip);
+
+  // update user to the one in rpc attributes
+  conn_security_ctx = conn_thd->security_context();
+
+  // Make sure the current user has permission to proxy for the requested
+  // user
+  if (strcmp(conn_security_ctx->user, rpc_role.c_str()) == 0) {
+    // Attempting to proxy as ourselves - just copy the user_connect
+    srv_session_thd->copy_user_connect(conn_thd);
+  } else {
+    // For the attached session the net_ptr should be null, but we need it
+    // set to the connection's net_ptr for the acl_validate_proxy_user()
+    // call, because inside it there is a call got get_or_create_user_conn()
+    // which will attempt to increment a counter based on whether the
+    // the connection is an SSL connection or not and the net_ptr has that
+    // information.  Reset it after we call this as we may fail to use this
+    // session and we don't want to leave it set until we know we will
+    // succeed.  It will be set again outside this function by the caller.
+    DBUG_ASSERT(srv_session_thd->get_net_nullable() == nullptr);
+    srv_session_thd->set_net(conn_thd->get_net());
+
+    auto res = acl_validate_proxy_user(
+          srv_session_thd,
+          conn_security_ctx->user, conn_security_ctx->get_host()->c_ptr(),
+          conn_security_ctx->get_ip()->c_ptr(),
+          rpc_role.c_str());
+    // Clear the net_ptr again - see above comment
+    srv_session_thd->clear_net();
+
+    if (!res)
+    {
+      my_error(ER_RPC_NO_PERMISSION, MYF(0), conn_security_ctx->user,
+          rpc_role.c_str());
+      return true;
+    }
+  }
+
+  if (srv_session->switch_to_user(rpc_role.c_str(),
+        conn_security_ctx->get_host()->c_ptr(),
+        conn_security_ctx->get_ip()->c_ptr(), rpc_db.c_str()))
+  {
+    my_error(ER_RPC_FAILED_TO_SWITCH_USER, MYF(0), rpc_role.c_str());
+    return true;
+  }
+
+  // update db
+  if (rpc_db.size() > 0 &&
+      srv_session_thd->set_db(rpc_db.c_str(), rpc_db.size()))
+  {
+    my_error(ER_RPC_FAILED_TO_SWITCH_DB, MYF(0), rpc_db.c_str());
+    return true;
+  }
+  per_user_session_variables.set_thd(srv_session_thd);
+  return false;
 }
 
 /*
@@ -76,7 +245,6 @@ std::pair<bool, std::shared_ptr<Srv_session>>  handle_com_rpc(THD *conn_thd)
   DBUG_ENTER(__func__);
   std::string rpc_role, rpc_db, rpc_id;
   bool used_default_srv_session = false;
-  Security_context* conn_security_ctx = NULL;
   THD* srv_session_thd = NULL;
   std::shared_ptr<Srv_session> srv_session;
 
@@ -98,132 +266,14 @@ std::pair<bool, std::shared_ptr<Srv_session>>  handle_com_rpc(THD *conn_thd)
 
   if (rpc_id.size())
   {
-    auto session_id = Srv_session::parse_session_key(rpc_id);
-    if (session_id == (my_thread_id) -1) {
-      my_error(ER_RPC_MALFORMED_ID, MYF(0), rpc_id.c_str());
-      goto error;
-    }
-
-    srv_session = Srv_session::access_session(session_id);
-    if (!srv_session)
-    {
-      bool timed_out;
-      std::chrono::milliseconds idle_timeout;
-      std::tie(timed_out, idle_timeout) =
-          Srv_session::session_timed_out(session_id);
-      if (timed_out) {
-        my_error(ER_RPC_IDLE_TIMEOUT, MYF(0), rpc_id.c_str(),
-            (uint32_t) idle_timeout.count());
-      } else {
-        my_error(ER_RPC_INVALID_ID, MYF(0), rpc_id.c_str());
-      }
-
-      goto error;
-    }
-
-    // Check to make sure the current user is coming from the same machine as
-    // the srv_session was originally created from
-    std::string curr_host_or_ip = conn_thd->main_security_ctx.host_or_ip;
-
-    DBUG_EXECUTE_IF("rpc_id_different_ip",
-        {
-          curr_host_or_ip = "other_host";
-        });
-
-    if (srv_session->get_host_or_ip() != curr_host_or_ip)
-    {
-      my_error(ER_RPC_HOST_MISMATCH, MYF(0), rpc_id.c_str());
+    if (access_rpc_session(rpc_id, conn_thd->main_security_ctx.host_or_ip,
+                           srv_session))
       goto error;
-    }
-
-    DBUG_PRINT("info", ("Found session in map, rpc_id=%s", rpc_id.c_str()));
   }
-  else
+  else if (open_rpc_session(conn_thd, rpc_role, rpc_db, true, srv_session,
+                            &used_default_srv_session))
   {
-    // Use default session from conn thd. We put it back at the end if execution
-    // was successful and there was no session state change.
-    srv_session = conn_thd->get_default_srv_session();
-    if (!srv_session)
-    {
-      // default one not present, allocate a new session
-      srv_session = std::shared_ptr<Srv_session>(new Srv_session);
-
-      if (srv_session->open(conn_thd))
-      {
-        my_error(ER_RPC_SESSION_OPEN, MYF(0));
-        goto error;
-      }
-
-      // enable state change tracking
-      srv_session->get_thd()->session_tracker.get_tracker(
-                SESSION_STATE_CHANGE_TRACKER)->force_enable();
-      srv_session->get_thd()->session_tracker.get_tracker(
-                SESSION_RESP_ATTR_TRACKER)->force_enable();
-      conn_thd->set_default_srv_session(srv_session);
-      // newly created sessions need the net_ptr set to null
-      srv_session->get_thd()->clear_net();
-    }
-    else
-    {
-      // set to know if to reset if after query execution state changes
-      used_default_srv_session = true;
-    }
-
-    srv_session_thd = srv_session->get_thd();
-    srv_session->set_host_or_ip(conn_thd->main_security_ctx.host_or_ip);
-
-    // update user to the one in rpc attributes
-    conn_security_ctx = conn_thd->security_context();
-
-    // Make sure the current user has permission to proxy for the requested
-    // user
-    if (strcmp(conn_security_ctx->user, rpc_role.c_str()) == 0) {
-      // Attempting to proxy as ourselves - just copy the user_connect
-      srv_session_thd->copy_user_connect(conn_thd);
-    } else {
-      // For the attached session the net_ptr should be null, but we need it
-      // set to the connection's net_ptr for the acl_validate_proxy_user()
-      // call, because inside it there is a call got get_or_create_user_conn()
-      // which will attempt to increment a counter based on whether the
-      // the connection is an SSL connection or not and the net_ptr has that
-      // information.  Reset it after we call this as we may fail to use this
-      // session and we don't want to leave it set until we know we will
-      // succeed.  It will be set again outside this function by the caller.
-      DBUG_ASSERT(srv_session_thd->get_net_nullable() == nullptr);
-      srv_session_thd->set_net(conn_thd->get_net());
-
-      auto res = acl_validate_proxy_user(
-            srv_session_thd,
-            conn_security_ctx->user, conn_security_ctx->get_host()->c_ptr(),
-            conn_security_ctx->get_ip()->c_ptr(),
-            rpc_role.c_str());
-      // Clear the net_ptr again - see above comment
-      srv_session_thd->clear_net();
-
-      if (!res)
-      {
-        my_error(ER_RPC_NO_PERMISSION, MYF(0), conn_security_ctx->user,
-            rpc_role.c_str());
-        goto error;
-      }
-    }
-
-    if (srv_session->switch_to_user(rpc_role.c_str(),
-          conn_security_ctx->get_host()->c_ptr(),
-          conn_security_ctx->get_ip()->c_ptr(), rpc_db.c_str()))
-    {
-      my_error(ER_RPC_FAILED_TO_SWITCH_USER, MYF(0), rpc_role.c_str());
-      goto error;
-    }
-
-    // update db
-    if (rpc_db.size() > 0 &&
-        srv_session_thd->set_db(rpc_db.c_str(), rpc_db.size()))
-    {
-      my_error(ER_RPC_FAILED_TO_SWITCH_DB, MYF(0), rpc_db.c_str());
-      goto error;
-    }
-    per_user_session_variables.set_thd(srv_session_thd);
+    goto error;
   }
 
   if (srv_session->attach())
@@ -313,6 +363,562 @@ void srv_session_end_statement(Srv_session& session) {
   session.end_statement();
 }
 
+/*
+  Multiplexed requests
+
+  A COM_QUERY_ATTRS request with the rpc_tag attribute is queued to a worker
+  thread, and the connection thread goes on with the next request without
+  waiting for the result. The request needs rpc_id or rpc_role: it runs in
+  its own detached session, a new one for rpc_role, as the default session
+  of the connection can't be used by several workers at once.
+
+  The worker writes the response into a buffer, after a packet holding the
+  value of rpc_tag, and writes the buffer to the connection at once. So
+  responses are never interleaved, but they are sent as the statements
+  finish, which may be in another order than the requests. All requests
+  for a session go to the same worker, and run in order; requests for
+  different sessions run concurrently.
+
+  A request without rpc_tag waits until the responses to the multiplexed
+  requests of the connection have been sent. Multiplexing is not available
+  on compressed or SSL connections, where the connection thread and the
+  workers can't use the socket concurrently.
+*/
+
+/* Responses to the multiplexed requests of a connection */
+class Rpc_connection
+{
+public:
+  explicit Rpc_connection(THD *conn_thd)
+    : vio_(conn_thd->get_net()->vio), write_error_(false), in_flight_(0) {}
+
+  void begin_request()
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    in_flight_++;
+  }
+
+  void end_request()
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (--in_flight_ == 0)
+      requests_done_.notify_all();
+  }
+
+  // Wait until the responses to all requests have been sent
+  void wait_for_requests()
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    requests_done_.wait(lock, [this] { return in_flight_ == 0; });
+  }
+
+  // Write a whole response. If this fails the connection is shut down, as
+  // the client could not tell where the next response starts.
+  void write(const uchar *buf, size_t length)
+  {
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    while (length && !write_error_)
+    {
+      size_t sent = vio_write(vio_, buf, length);
+      if (sent == VIO_SOCKET_ERROR && vio_should_retry(vio_))
+        continue;
+      if (sent == VIO_SOCKET_ERROR || sent == VIO_SOCKET_READ_TIMEOUT ||
+          sent == VIO_SOCKET_WRITE_TIMEOUT)
+      {
+        write_error_ = true;
+        vio_shutdown(vio_);
+        break;
+      }
+      buf += sent;
+      length -= sent;
+    }
+  }
+
+  // Held by the connection thread while it sends a response itself
+  std::mutex& write_mutex() { return write_mutex_; }
+
+  Vio *vio() const { return vio_; }
+
+private:
+  Vio *vio_;
+  std::mutex write_mutex_;
+  bool write_error_;
+
+  std::mutex mutex_;
+  std::condition_variable requests_done_;
+  uint in_flight_;
+};
+
+/* A multiplexed request queued to a worker */
+struct Rpc_request
+{
+  std::shared_ptr<Rpc_connection> conn;
+  // The session opened by the connection thread when there is no rpc_id
+  std::shared_ptr<Srv_session> srv_session;
+  std::string rpc_id;
+  std::string rpc_tag;
+  std::string host_or_ip;
+  std::string query;
+  std::unordered_map<std::string, std::string> query_attrs;
+  my_thread_id conn_thd_id;
+  // For the errors the worker sends before a session is attached
+  ulong client_capabilities;
+  const CHARSET_INFO *character_set_results;
+};
+
+/*
+  Vio of the workers, it appends what is written to a buffer. The
+  connection state and the peer address are those of the client
+  connection of the request being executed.
+*/
+struct Rpc_response_vio
+{
+  Vio vio;                                      // must be the first member
+  String *buffer;
+  Vio *conn_vio;                                // NULL between requests
+};
+
+static Vio *rpc_conn_vio(Vio *vio)
+{
+  return reinterpret_cast<Rpc_response_vio*>(vio)->conn_vio;
+}
+
+static size_t rpc_response_write(Vio *vio, const uchar *buf, size_t size)
+{
+  String *buffer = reinterpret_cast<Rpc_response_vio*>(vio)->buffer;
+  if (buffer->append((const char*) buf, size))
+    return VIO_SOCKET_ERROR;
+  return size;
+}
+
+// Requests are read by the connection thread, never by the workers
+static size_t rpc_response_read(Vio *vio MY_ATTRIBUTE((unused)),
+                                uchar *buf MY_ATTRIBUTE((unused)),
+                                size_t size MY_ATTRIBUTE((unused)))
+{
+  return VIO_SOCKET_ERROR;
+}
+
+static int rpc_response_zero(Vio *vio MY_ATTRIBUTE((unused)))
+{
+  return 0;
+}
+
+static int rpc_response_timeout(Vio *vio MY_ATTRIBUTE((unused)),
+                                uint which MY_ATTRIBUTE((unused)),
+                                my_bool old_mode MY_ATTRIBUTE((unused)))
+{
+  return 0;
+}
+
+static int rpc_response_keepalive(Vio *vio MY_ATTRIBUTE((unused)),
+                                  my_bool onoff MY_ATTRIBUTE((unused)))
+{
+  return 0;
+}
+
+static my_bool rpc_response_false(Vio *vio MY_ATTRIBUTE((unused)))
+{
+  return FALSE;
+}
+
+static my_bool rpc_response_true(Vio *vio MY_ATTRIBUTE((unused)))
+{
+  return TRUE;
+}
+
+static int rpc_response_set_blocking(Vio *vio MY_ATTRIBUTE((unused)),
+                                     my_bool val MY_ATTRIBUTE((unused)))
+{
+  return 0;
+}
+
+static void rpc_response_delete(Vio *vio MY_ATTRIBUTE((unused))) {}
+
+// Shutting down a session must not close the connection of other requests
+static int rpc_response_shutdown(Vio *vio)
+{
+  vio->inactive = TRUE;
+  return 0;
+}
+
+static my_bool rpc_response_is_connected(Vio *vio)
+{
+  Vio *conn_vio = rpc_conn_vio(vio);
+  return !vio->inactive && conn_vio && vio_is_connected(conn_vio);
+}
+
+static my_bool rpc_response_peer_addr(Vio *vio, char *buf, uint16 *port,
+                                      size_t buflen)
+{
+  Vio *conn_vio = rpc_conn_vio(vio);
+  if (!conn_vio)
+    return TRUE;
+  return vio_peer_addr(conn_vio, buf, port, buflen);
+}
+
+static void rpc_response_in_addr(Vio *vio, struct sockaddr_storage *in)
+{
+  Vio *conn_vio = rpc_conn_vio(vio);
+  if (conn_vio)
+    conn_vio->in_addr(conn_vio, in);
+  else
+    memset(in, 0, sizeof(*in));
+}
+
+// Writes never block, and there is nothing to read
+static int rpc_response_io_wait(Vio *vio MY_ATTRIBUTE((unused)),
+                                enum enum_vio_io_event event,
+                                timeout_t timeout MY_ATTRIBUTE((unused)))
+{
+  return event == VIO_IO_EVENT_WRITE ? 1 : 0;
+}
+
+static void rpc_response_vio_init(Rpc_response_vio *response_vio,
+                                  String *buffer)
+{
+  Vio *vio = &response_vio->vio;
+
+  memset(vio, 0, sizeof(*vio));
+  vio->type = VIO_TYPE_TCPIP;
+  vio->mysql_socket = MYSQL_INVALID_SOCKET;
+  vio->read_timeout = vio->write_timeout = timeout_infinite();
+  vio->is_blocking_flag = TRUE;
+  vio->viodelete = rpc_response_delete;
+  vio->vioerrno = rpc_response_zero;
+  vio->read = rpc_response_read;
+  vio->write = rpc_response_write;
+  vio->timeout = rpc_response_timeout;
+  vio->viokeepalive = rpc_response_keepalive;
+  vio->fastsend = rpc_response_zero;
+  vio->peer_addr = rpc_response_peer_addr;
+  vio->in_addr = rpc_response_in_addr;
+  vio->should_retry = rpc_response_false;
+  vio->was_timeout = rpc_response_false;
+  vio->vioshutdown = rpc_response_shutdown;
+  vio->is_connected = rpc_response_is_connected;
+  vio->has_data = rpc_response_false;
+  vio->io_wait = rpc_response_io_wait;
+  vio->is_blocking = rpc_response_true;
+  vio->set_blocking = rpc_response_set_blocking;
+  response_vio->buffer = buffer;
+  response_vio->conn_vio = NULL;
+}
+
+// The response vio takes the type and addresses of the client connection
+static void rpc_response_vio_attach(Rpc_response_vio *response_vio,
+                                    Vio *conn_vio)
+{
+  Vio *vio = &response_vio->vio;
+
+  response_vio->conn_vio = conn_vio;
+  vio->type = conn_vio->type;
+  vio->localhost = conn_vio->localhost;
+  vio->local = conn_vio->local;
+  vio->remote = conn_vio->remote;
+  vio->addrLen = conn_vio->addrLen;
+  vio->inactive = FALSE;
+}
+
+class Rpc_worker
+{
+public:
+  Rpc_worker() : stop_(false) {}
+
+  void enqueue(Rpc_request *request)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    queue_.push_back(request);
+    work_.notify_one();
+  }
+
+  // Stop once the queue is empty
+  void stop()
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+    work_.notify_one();
+  }
+
+  void run();
+
+  pthread_t thread;
+
+private:
+  void execute(THD *thd, Rpc_response_vio *response_vio, String *response,
+               Rpc_request *request);
+
+  std::mutex mutex_;
+  std::condition_variable work_;
+  std::deque<Rpc_request*> queue_;
+  bool stop_;
+};
+
+static std::vector<Rpc_worker*> rpc_workers;
+
+pthread_handler_t rpc_worker_thread(void *arg)
+{
+  Rpc_worker *worker = static_cast<Rpc_worker*>(arg);
+  my_thread_init();
+  worker->run();
+  my_thread_end();
+  return NULL;
+}
+
+void Rpc_worker::run()
+{
+  Rpc_response_vio response_vio;
+  String response;
+  THD *thd = new THD;
+
+  thd->thread_stack = (char*) &thd;
+  thd->store_globals();
+
+  // The worker THD plays the part of the connection THD for the sessions
+  // it attaches, its NET writes into the response buffer.
+  rpc_response_vio_init(&response_vio, &response);
+  my_net_init(thd->get_net(), &response_vio.vio);
+
+  for (;;)
+  {
+    Rpc_request *request;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      work_.wait(lock, [this] { return stop_ || !queue_.empty(); });
+      if (queue_.empty())
+        break;
+      request = queue_.front();
+      queue_.pop_front();
+    }
+
+    response.length(0);
+    execute(thd, &response_vio, &response, request);
+    delete request;
+  }
+
+  net_end(thd->get_net());
+  thd->get_net()->vio = NULL;
+  delete thd;
+  my_pthread_setspecific_ptr(THR_THD, NULL);
+}
+
+void Rpc_worker::execute(THD *thd, Rpc_response_vio *response_vio,
+                         String *response, Rpc_request *request)
+{
+  DBUG_ENTER(__func__);
+  NET *net = thd->get_net();
+  std::shared_ptr<Srv_session> srv_session = std::move(request->srv_session);
+  bool new_session = srv_session != nullptr;
+  bool error = false;
+
+  rpc_response_vio_attach(response_vio, request->conn->vio());
+
+  net_clear(net, FALSE);
+  net->error = 0;
+  thd->clear_error();
+  thd->get_stmt_da()->reset_diagnostics_area();
+  thd->client_capabilities = request->client_capabilities;
+  thd->variables.character_set_results = request->character_set_results;
+
+  my_net_write(net, (const uchar*) request->rpc_tag.data(),
+               request->rpc_tag.size());
+
+  // A session given by rpc_id is looked up here, after the earlier
+  // requests for it are done
+  if (!new_session)
+    error = access_rpc_session(request->rpc_id, request->host_or_ip,
+                               srv_session);
+
+  if (!error && srv_session->attach())
+  {
+    my_error(ER_RPC_FAILED_TO_ATTACH, MYF(0));
+    error = true;
+  }
+  else if (!error && new_session && Srv_session::store_session(srv_session))
+  {
+    srv_session->detach();
+    thd->store_globals();
+    my_error(ER_RPC_FAILED_TO_STORE_DETACHED_SESSION, MYF(0));
+    error = true;
+  }
+
+  if (error)
+  {
+    thd->protocol->end_statement(thd);
+
+    if (srv_session != nullptr && !new_session)
+      srv_session->enableWaitTimeout();
+  }
+  else
+  {
+    THD *srv_session_thd = srv_session->get_thd();
+
+    DBUG_PRINT("info", ("rpc_tag='%s' rpc_thread_id=%d",
+                        request->rpc_tag.c_str(),
+                        srv_session_thd->thread_id()));
+
+    srv_session->set_conn_thd_id(request->conn_thd_id);
+    srv_session_thd->set_net(net);
+    srv_session_thd->set_query_attrs(request->query_attrs);
+
+    dispatch_command(COM_QUERY, srv_session_thd, &request->query[0],
+                     request->query.size(), srv_session);
+
+    srv_session_thd->clear_net();
+    srv_session->detach();
+    // from this point on other threads can access the session
+
+    thd->store_globals();
+
+    // Only the sessions kept for later requests time out
+    if (srv_session->has_been_detached())
+      srv_session->enableWaitTimeout();
+  }
+
+  net_flush(net);
+  response_vio->conn_vio = NULL;
+  request->conn->write((const uchar*) response->ptr(), response->length());
+  request->conn->end_request();
+  DBUG_VOID_RETURN;
+}
+
+bool rpc_multiplex_requested(THD *thd)
+{
+  return thd->query_attrs_map.count(QATTR_RPC_TAG) != 0;
+}
+
+bool dispatch_multiplexed_rpc(THD *conn_thd, char *packet,
+                              uint packet_length)
+{
+  DBUG_ENTER(__func__);
+  std::string rpc_role, rpc_db, rpc_id, rpc_tag;
+  std::shared_ptr<Srv_session> srv_session;
+  bool used_default_srv_session = false;
+  my_thread_id session_id;
+  NET *net = conn_thd->get_net();
+  Rpc_request *request;
+
+  check_for_attribute(conn_thd, QATTR_RPC_ROLE, rpc_role);
+  check_for_attribute(conn_thd, QATTR_RPC_DB, rpc_db);
+  check_for_attribute(conn_thd, QATTR_RPC_ID, rpc_id);
+  check_for_attribute(conn_thd, QATTR_RPC_TAG, rpc_tag);
+
+  DBUG_PRINT("info", ("rpc_tag='%s', rpc_role='%s', rpc_id='%s'",
+                      rpc_tag.c_str(), rpc_role.c_str(), rpc_id.c_str()));
+
+  if (!conn_thd->rpc_connection)
+    conn_thd->rpc_connection = std::make_shared<Rpc_connection>(conn_thd);
+
+  if (rpc_workers.empty())
+  {
+    my_error(ER_RPC_MULTIPLEX_UNAVAILABLE, MYF(0),
+             "rpc_multiplex_threads is 0");
+    goto error;
+  }
+
+  if (net->compress || vio_type(net->vio) == VIO_TYPE_SSL)
+  {
+    my_error(ER_RPC_MULTIPLEX_UNAVAILABLE, MYF(0),
+             "the connection uses compression or SSL");
+    goto error;
+  }
+
+  if (rpc_id.size())
+  {
+    session_id = Srv_session::parse_session_key(rpc_id);
+    if (session_id == (my_thread_id) -1)
+    {
+      my_error(ER_RPC_MALFORMED_ID, MYF(0), rpc_id.c_str());
+      goto error;
+    }
+  }
+  else if (rpc_role.size())
+  {
+    if (open_rpc_session(conn_thd, rpc_role, rpc_db, false, srv_session,
+                         &used_default_srv_session))
+      goto error;
+    session_id = srv_session->get_session_id();
+  }
+  else
+  {
+    my_error(ER_RPC_MULTIPLEX_UNAVAILABLE, MYF(0),
+             "the request has no rpc_id or rpc_role");
+    goto error;
+  }
+
+  request = new Rpc_request;
+  request->conn = conn_thd->rpc_connection;
+  request->srv_session = std::move(srv_session);
+  request->rpc_id = rpc_id;
+  request->rpc_tag = rpc_tag;
+  request->host_or_ip = conn_thd->main_security_ctx.host_or_ip;
+  request->query.assign(packet, packet_length);
+  request->query_attrs = conn_thd->query_attrs_map;
+  request->conn_thd_id = conn_thd->thread_id();
+  request->client_capabilities = conn_thd->client_capabilities;
+  request->character_set_results =
+    conn_thd->variables.character_set_results;
+
+  request->conn->begin_request();
+  rpc_workers[session_id % rpc_workers.size()]->enqueue(request);
+
+  reset_conn_thd_after_query_execution(conn_thd);
+  DBUG_RETURN(false);
+
+error:
+  {
+    // The error is tagged like the responses of the workers
+    std::lock_guard<std::mutex> lock(
+        conn_thd->rpc_connection->write_mutex());
+    my_net_write(net, (const uchar*) rpc_tag.data(), rpc_tag.size());
+    conn_thd->protocol->end_statement(conn_thd);
+    net_flush(net);
+  }
+
+  // Close a session opened for the request only now, as closing it clears
+  // the diagnostics area of the connection.
+  srv_session = nullptr;
+
+  reset_conn_thd_after_query_execution(conn_thd);
+  DBUG_RETURN(false);
+}
+
+void rpc_multiplex_wait(THD *conn_thd)
+{
+  if (conn_thd->rpc_connection)
+    conn_thd->rpc_connection->wait_for_requests();
+}
+
+void rpc_multiplex_init()
+{
+  for (uint i = 0; i < rpc_multiplex_threads; i++)
+  {
+    Rpc_worker *worker = new Rpc_worker;
+    if (mysql_thread_create(key_thread_rpc_worker, &worker->thread,
+                            NULL, rpc_worker_thread, worker))
+    {
+      sql_print_warning("Could not create a thread for multiplexed requests, "
+                        "using %u of %u threads (errno %d)",
+                        i, rpc_multiplex_threads, errno);
+      delete worker;
+      break;
+    }
+    rpc_workers.push_back(worker);
+  }
+}
+
+void rpc_multiplex_deinit()
+{
+  for (auto worker : rpc_workers)
+    worker->stop();
+  for (auto worker : rpc_workers)
+  {
+    pthread_join(worker->thread, NULL);
+    delete worker;
+  }
+  rpc_workers.clear();
+}
+
 #else
 
 void cleanup_com_rpc(
@@ -325,6 +931,13 @@ std::pair<bool, std::shared_ptr<Srv_session>> handle_com_rpc(THD *conn_thd) {
   return std::make_pair(false, nullptr);
 }
 
+bool rpc_multiplex_requested(THD *thd) { return false; }
+bool dispatch_multiplexed_rpc(THD *conn_thd, char *packet,
+                              uint packet_length) { return false; }
+void rpc_multiplex_wait(THD *conn_thd) {}
+void rpc_multiplex_init() {}
+void rpc_multiplex_deinit() {}
+
 #endif // #ifndef EMBEDDED_LIBRARY
 
 
@@ -12,3 +12,14 @@ void cleanup_com_rpc(
     bool state_changed);
 void srv_session_end_statement(Srv_session& session);
 
+// Multiplexed requests, see sql_parse_com_rpc.cc.
+// True if the COM_QUERY_ATTRS request has the rpc_tag attribute.
+bool rpc_multiplex_requested(THD *thd);
+// Queue the request to a worker, or send a tagged error.
+bool dispatch_multiplexed_rpc(THD *conn_thd, char *packet,
+                              uint packet_length);
+// Wait until the responses to all multiplexed requests of the connection
+// have been sent.
+void rpc_multiplex_wait(THD *conn_thd);
+void rpc_multiplex_init();
+void rpc_multiplex_deinit();
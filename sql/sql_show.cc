@@ -2219,28 +2219,34 @@ static const char *thread_state_info(THD *tmp)
 
 typedef std::tuple<double, double, double> time_stat_tuple;
 
-static time_stat_tuple get_thd_time_stats(THD *thd)
+static time_stat_tuple get_time_stats(ulonglong stmt_start,
+                                      ulonglong trx_time,
+                                      ulonglong command_time)
 {
   double cmd_secs = 0, stmt_secs = 0, trx_secs = 0;
-  ulonglong stmt_start = thd->stmt_start;
   if (stmt_start)
   {
     stmt_secs = my_timer_to_seconds(my_timer_since(stmt_start));
-    trx_secs = my_timer_to_seconds(thd->trx_time) + stmt_secs;
-    cmd_secs =
-        my_timer_to_seconds(thd->status_var.command_time) + stmt_secs;
+    trx_secs = my_timer_to_seconds(trx_time) + stmt_secs;
+    cmd_secs = my_timer_to_seconds(command_time) + stmt_secs;
   }
   else
   {
     stmt_secs = 0; // not in the mid of any statement execution
-    trx_secs = my_timer_to_seconds(thd->trx_time);
-    cmd_secs = my_timer_to_seconds(thd->status_var.command_time);
+    trx_secs = my_timer_to_seconds(trx_time);
+    cmd_secs = my_timer_to_seconds(command_time);
   }
 
   // return std::tuple (move)
   return std::make_tuple(stmt_secs, trx_secs, cmd_secs);
 }
 
+static time_stat_tuple get_thd_time_stats(THD *thd)
+{
+  return get_time_stats(thd->stmt_start, thd->trx_time,
+                        thd->status_var.command_time);
+}
+
 // For sorting by thread_id().
 static bool thd_compare (const THD* p1, const THD* p2)
 {
@@ -2623,6 +2629,181 @@ static bool access_thread(const char *user, THD *thd)
                      !strcmp(thd_sctx->user, user))));
 }
 
+/****************************************************************************
+  processlist_snapshot: the lists are built from the status the threads
+  publish (see thd_status.h), without blocking thread removal or locking
+  the threads.
+****************************************************************************/
+
+static bool status_compare(const Thd_status &s1, const Thd_status &s2)
+{
+  return s1.thread_id < s2.thread_id;
+}
+
+// Copy the published status of the threads, sorted by thread_id.
+static void get_thread_status_sorted(std::vector<Thd_status> *statuses)
+{
+  statuses->reserve(get_thread_count());
+  thd_status_snapshot(statuses);
+  std::sort(statuses->begin(), statuses->end(), status_compare);
+}
+
+// As access_thread(), for a published status
+static bool access_thread_status(const char *user, const Thd_status &status)
+{
+  return (status.visible &&
+          (!user || (!status.system_thread && status.user[0] &&
+                     !strcmp(status.user, user))));
+}
+
+static const char *status_user(const Thd_status &status)
+{
+  return status.user[0] ? status.user :
+         (status.system_thread ? "system user" : "unauthenticated user");
+}
+
+static const char *status_state_info(const Thd_status &status)
+{
+  return status.command == COM_SLEEP ? "" : status.state;
+}
+
+/* Format the HOST column into buff, of LIST_PROCESS_HOST_LEN + 1 bytes */
+static const char *status_host(THD *thd, const Thd_status &status, char *buff)
+{
+  if (status.peer_port && thd->security_ctx->host_or_ip[0])
+  {
+    my_snprintf(buff, LIST_PROCESS_HOST_LEN, "%s:%u",
+                status.host_or_ip, status.peer_port);
+    return buff;
+  }
+  return status.host_or_ip;
+}
+
+static void set_thread_info_status(thread_info *thd_info, THD *thd,
+                                   const Thd_status &status,
+                                   ulong max_query_length)
+{
+  char host[LIST_PROCESS_HOST_LEN + 1];
+
+  thd_info->thread_id= status.thread_id;
+  thd_info->system_thread_id= status.system_thread_id;
+  thd_info->user= thd->strdup(status_user(status));
+  thd_info->host= thd->strdup(status_host(thd, status, host));
+  thd_info->command= status.command;
+  thd_info->db= status.has_db ? thd->strdup(status.db) : NULL;
+  thd_info->proc_info= status.killed ? "Killed" : NULL;
+  thd_info->state_info= status_state_info(status);
+  thd_info->rows_examined= status.rows_examined;
+  thd_info->rows_sent= status.rows_sent;
+  thd_info->start_time= status.start_time;
+  if (status.has_query)
+  {
+    uint length= min<uint>(max_query_length, status.query_length);
+    char *q= thd->strmake(status.query, length);
+    thd_info->query_string=
+      CSET_STRING(q, q ? length : 0, status.query_charset);
+  }
+
+  auto time_stats = get_time_stats(status.stmt_start, status.trx_time,
+                                   status.command_time);
+  thd_info->stmt_secs = std::get<0>(time_stats);
+  thd_info->trx_secs = std::get<1>(time_stats);
+  thd_info->cmd_secs = std::get<2>(time_stats);
+  thd_info->rw_trans = status.rw_trans;
+  thd_info->sql_log_bin = status.sql_log_bin;
+}
+
+static void fill_fields_status_common(THD *thd, const Thd_status &status,
+                                      TABLE *table, CHARSET_INFO *cs)
+{
+  char host[LIST_PROCESS_HOST_LEN + 1];
+  const char *val;
+
+  restore_record(table, s->default_values);
+
+  /* ID */
+  table->field[0]->store((ulonglong) status.thread_id, TRUE);
+  /* USER */
+  val= status_user(status);
+  table->field[1]->store(val, strlen(val), cs);
+  /* HOST */
+  val= status_host(thd, status, host);
+  table->field[2]->store(val, strlen(val), cs);
+  /* DB */
+  if (status.has_db)
+  {
+    table->field[3]->store(status.db, strlen(status.db), cs);
+    table->field[3]->set_notnull();
+  }
+  /* COMMAND */
+  if (status.killed)
+    table->field[4]->store(STRING_WITH_LEN("Killed"), cs);
+  else
+    table->field[4]->store(command_name[status.command].str,
+                           command_name[status.command].length, cs);
+}
+
+static void fill_fields_processlist_status(THD *thd, const Thd_status &status,
+                                           TABLE *table, CHARSET_INFO *cs,
+                                           timeval *time_now)
+{
+  const char *val;
+  timeval tm_delta;
+
+  fill_fields_status_common(thd, status, table, cs);
+
+  /* MYSQL_TIME */
+  my_timeval_minus(time_now, &status.start_time, &tm_delta);
+  if (thd->variables.high_precision_processlist)
+    table->field[5]->store(my_timeval_to_double(&tm_delta));
+  else
+    table->field[5]->store(my_timeval_to_longlong(&tm_delta), FALSE);
+  /* STATE */
+  if ((val= status_state_info(status)))
+  {
+    table->field[6]->store(val, strlen(val), cs);
+    table->field[6]->set_notnull();
+  }
+  /* INFO */
+  if (status.has_query)
+  {
+    size_t const width=
+      min<size_t>(PROCESS_LIST_INFO_WIDTH, status.query_length);
+    table->field[7]->store(status.query, width, cs);
+    table->field[7]->set_notnull();
+  }
+}
+
+static void fill_fields_transaction_list_status(THD *thd,
+                                                const Thd_status &status,
+                                                TABLE *table,
+                                                CHARSET_INFO *cs)
+{
+  const char *val;
+
+  fill_fields_status_common(thd, status, table, cs);
+
+  /* STATE */
+  if ((val= status_state_info(status)))
+  {
+    table->field[5]->store(val, strlen(val), cs);
+    table->field[5]->set_notnull();
+  }
+
+  auto time_stats = get_time_stats(status.stmt_start, status.trx_time,
+                                   status.command_time);
+  /* Statement_seconds */
+  table->field[6]->store(std::get<0>(time_stats));
+  /* Transaction_seconds */
+  table->field[7]->store(std::get<1>(time_stats));
+  /* Command_seconds */
+  table->field[8]->store(std::get<2>(time_stats));
+  /* Read_only */
+  table->field[9]->store((uint) (!status.rw_trans));
+  /* Sql_log_bin */
+  table->field[10]->store((uint) status.sql_log_bin);
+}
+
 /* Return false if the current row (process) is skipped */
 static bool fill_fields_process_common(THD *thd, THD *tmp, TABLE *table,
                                        char *user, CHARSET_INFO *cs,
@@ -2987,6 +3168,24 @@ void mysqld_list_process_trx_helper(THD *thd, const char *user, bool verbose,
       mutex_unlock_all_shards(SHARDED(&LOCK_thd_remove));
 #endif // EMBEDDED_LIBRARY
     }
+    else if (opt_processlist_snapshot &&
+             (type == process_list_type::SHOW_PROCESS_LIST ||
+              type == process_list_type::SHOW_TRANSACTION_LIST))
+    {
+      std::vector<Thd_status> statuses;
+      get_thread_status_sorted(&statuses);
+
+      thread_infos.reserve(statuses.size());
+      for (const auto &status: statuses)
+      {
+        if (access_thread_status(user, status))
+        {
+          thread_info *thd_info= new thread_info;
+          set_thread_info_status(thd_info, thd, status, max_query_length);
+          thread_infos.push_back(thd_info);
+        }
+      }
+    }
     else
     {
       /* take copy of global_thread_list, sorted by thread_id */
@@ -3136,6 +3335,25 @@ int fill_schema_process_trx_helper(THD *thd, TABLE_LIST *tables, Item *cond,
       mutex_unlock_all_shards(SHARDED(&LOCK_thd_remove));
 #endif  // EMBEDDED_LIBRARY
     }
+    else if (opt_processlist_snapshot &&
+             (type == process_list_type::SHOW_PROCESS_LIST ||
+              type == process_list_type::SHOW_TRANSACTION_LIST))
+    {
+      std::vector<Thd_status> statuses;
+      get_thread_status_sorted(&statuses);
+
+      for (const auto &status: statuses)
+      {
+        if (!access_thread_status(user, status))
+          continue;
+        if (type == process_list_type::SHOW_PROCESS_LIST)
+          fill_fields_processlist_status(thd, status, table, cs, &time_now);
+        else
+          fill_fields_transaction_list_status(thd, status, table, cs);
+        if (schema_table_store_record(thd, table))
+          DBUG_RETURN(1);
+      }
+    }
     else
     {
       /* take copy of global_thread_list, sorted by thread_id */
@@ -4346,10 +4564,12 @@ static bool show_status_array(THD *thd, const char *wild,
           break;
         }
         case SHOW_KEY_CACHE_LONG:
+          update_key_cache_stats(dflt_key_cache);
           value= (char*) dflt_key_cache + (ulong)value;
           end= int10_to_str(*(long*) value, buff, 10);
           break;
         case SHOW_KEY_CACHE_LONGLONG:
+          update_key_cache_stats(dflt_key_cache);
           value= (char*) dflt_key_cache + (ulong)value;
 	  end= longlong10_to_str(*(longlong*) value, buff, 10);
 	  break;
@@ -201,6 +201,10 @@ public:
           (thd_.locked_tables_mode != LTM_NONE); // LOCK table active
   }
 
+  // True once a statement changed the session state, the session is then
+  // kept in the session map for later requests.
+  bool has_been_detached() const { return has_been_detached_; }
+
   void set_host_or_ip(const char* str) { host_or_ip = str; }
   const std::string& get_host_or_ip() { return host_or_ip; }
 
@@ -28,6 +28,7 @@
 #include "mysql_com.h"                 /* NAME_LEN */
 #include "mysqld.h"                    /* my_io_perf */
 #include "atomic_stat.h"
+#include "sharded_stats.h"
 #include "hash.h"
 
 struct TABLE;
@@ -230,6 +231,68 @@ typedef struct user_resources {
 
 #define USER_STATS_MAGIC 0x17171717
 
+/* Per user counters updated by every statement, see USER_STATS */
+struct user_stats_counters {
+  atomic_stat<ulonglong> commands_ddl;
+  atomic_stat<ulonglong> commands_delete;
+  atomic_stat<ulonglong> commands_handler;
+  atomic_stat<ulonglong> commands_insert;
+  atomic_stat<ulonglong> commands_other;
+  atomic_stat<ulonglong> commands_select;
+  atomic_stat<ulonglong> commands_transaction;
+  atomic_stat<ulonglong> commands_update;
+  atomic_stat<ulonglong> microseconds_wall;
+  atomic_stat<ulonglong> microseconds_ddl;
+  atomic_stat<ulonglong> microseconds_delete;
+  atomic_stat<ulonglong> microseconds_handler;
+  atomic_stat<ulonglong> microseconds_insert;
+  atomic_stat<ulonglong> microseconds_other;
+  atomic_stat<ulonglong> microseconds_select;
+  atomic_stat<ulonglong> microseconds_transaction;
+  atomic_stat<ulonglong> microseconds_update;
+  atomic_stat<ulonglong> queries_empty;
+  atomic_stat<ulonglong> query_comment_bytes;
+  atomic_stat<ulonglong> rows_deleted;
+  atomic_stat<ulonglong> rows_fetched;
+  atomic_stat<ulonglong> rows_inserted;
+  atomic_stat<ulonglong> rows_read;
+  atomic_stat<ulonglong> rows_updated;
+
+  /* see variables of same name in ha_statistics */
+  atomic_stat<ulonglong> rows_index_first;
+  atomic_stat<ulonglong> rows_index_next;
+
+  void clear()
+  {
+    commands_ddl.clear();
+    commands_delete.clear();
+    commands_handler.clear();
+    commands_insert.clear();
+    commands_other.clear();
+    commands_select.clear();
+    commands_transaction.clear();
+    commands_update.clear();
+    microseconds_wall.clear();
+    microseconds_ddl.clear();
+    microseconds_delete.clear();
+    microseconds_handler.clear();
+    microseconds_insert.clear();
+    microseconds_other.clear();
+    microseconds_select.clear();
+    microseconds_transaction.clear();
+    microseconds_update.clear();
+    queries_empty.clear();
+    query_comment_bytes.clear();
+    rows_deleted.clear();
+    rows_fetched.clear();
+    rows_inserted.clear();
+    rows_read.clear();
+    rows_updated.clear();
+    rows_index_first.clear();
+    rows_index_next.clear();
+  }
+};
+
 /** Counts resources consumed per-user.
     Data is exported via IS.user_statistics.
 */
@@ -242,14 +305,6 @@ typedef struct st_user_stats {
   atomic_stat<ulonglong> bytes_sent;
   atomic_stat<ulonglong> binlog_bytes_written;
   atomic_stat<ulonglong> binlog_disk_reads;
-  atomic_stat<ulonglong> commands_ddl;
-  atomic_stat<ulonglong> commands_delete;
-  atomic_stat<ulonglong> commands_handler;
-  atomic_stat<ulonglong> commands_insert;
-  atomic_stat<ulonglong> commands_other;
-  atomic_stat<ulonglong> commands_select;
-  atomic_stat<ulonglong> commands_transaction;
-  atomic_stat<ulonglong> commands_update;
   atomic_stat<ulonglong> connections_denied_max_global; // over global limit
   atomic_stat<ulonglong> connections_denied_max_user;   // over per user limit
   atomic_stat<ulonglong> connections_lost;              // closed on error
@@ -268,26 +323,13 @@ typedef struct st_user_stats {
   atomic_stat<ulonglong> errors_net_ER_NET_WRITE_INTERRUPTED;
 
   atomic_stat<ulonglong> errors_total;
-  atomic_stat<ulonglong> microseconds_wall;
-  atomic_stat<ulonglong> microseconds_ddl;
-  atomic_stat<ulonglong> microseconds_delete;
-  atomic_stat<ulonglong> microseconds_handler;
-  atomic_stat<ulonglong> microseconds_insert;
-  atomic_stat<ulonglong> microseconds_other;
-  atomic_stat<ulonglong> microseconds_select;
-  atomic_stat<ulonglong> microseconds_transaction;
-  atomic_stat<ulonglong> microseconds_update;
   atomic_stat<ulonglong> microseconds_cpu;
   atomic_stat<ulonglong> microseconds_cpu_user;
   atomic_stat<ulonglong> microseconds_cpu_sys;
-  atomic_stat<ulonglong> queries_empty;
   atomic_stat<ulonglong> relay_log_bytes_written;
-  atomic_stat<ulonglong> rows_deleted;
-  atomic_stat<ulonglong> rows_fetched;
-  atomic_stat<ulonglong> rows_inserted;
-  atomic_stat<ulonglong> rows_read;
-  atomic_stat<ulonglong> rows_updated;
-  atomic_stat<ulonglong> query_comment_bytes;
+
+  /* Counters updated by every statement */
+  sharded_stats<user_stats_counters> counters;
 
   latency_histogram histogram_connection_create;
   latency_histogram histogram_update_command;
@@ -299,10 +341,6 @@ typedef struct st_user_stats {
   latency_histogram histogram_handler_command;
   latency_histogram histogram_other_command;
 
-  /* see variables of same name in ha_statistics */
-  atomic_stat<ulonglong> rows_index_first;
-  atomic_stat<ulonglong> rows_index_next;
-
   atomic_stat<ulonglong> transactions_commit;
   atomic_stat<ulonglong> transactions_rollback;
 
@@ -423,16 +461,8 @@ typedef struct st_index_stats {
  */
 #define MAX_INDEX_STATS 10
 
-typedef struct st_shared_table_stats
-{
-  char db[NAME_LEN + 1];                /* [db] + '\0' */
-  char table[NAME_LEN + 1];             /* [table] + '\0' */
-  const char* engine_name;
-
-  /* Hash table key, table->s->table_cache_key for the table */
-  char hash_key[NAME_LEN * 2 + 2];
-  int  hash_key_len;                    /* table->s->key_length for the table */
-
+/* Counters of SHARED_TABLE_STATS, updated by every statement */
+struct shared_table_stats_counters {
   atomic_stat<ulonglong> queries_used;	/* number of times used by a query */
   atomic_stat<ulonglong> queries_empty;	/* Number of non-join empty queries */
 
@@ -443,6 +473,30 @@ typedef struct st_shared_table_stats
   atomic_stat<ulonglong> rows_requested;/* Number of row read attempts for
                                          this table.  This counts requests
                                          that do not return a row. */
+
+  void clear()
+  {
+    queries_used.clear();
+    queries_empty.clear();
+    rows_inserted.clear();
+    rows_updated.clear();
+    rows_deleted.clear();
+    rows_read.clear();
+    rows_requested.clear();
+  }
+};
+
+typedef struct st_shared_table_stats
+{
+  char db[NAME_LEN + 1];                /* [db] + '\0' */
+  char table[NAME_LEN + 1];             /* [table] + '\0' */
+  const char* engine_name;
+
+  /* Hash table key, table->s->table_cache_key for the table */
+  char hash_key[NAME_LEN * 2 + 2];
+  int  hash_key_len;                    /* table->s->key_length for the table */
+
+  sharded_stats<shared_table_stats_counters> counters;
 } SHARED_TABLE_STATS;
 
 /* user table statistics */
@@ -450,6 +504,24 @@ typedef struct st_user_table_stats {
   SHARED_TABLE_STATS shared_stats;
 } USER_TABLE_STATS;
 
+/* Counters of TABLE_STATS, updated by every statement */
+struct table_stats_counters {
+  /* See variables of same name in ha_statistics */
+  atomic_stat<ulonglong> rows_index_first;
+  atomic_stat<ulonglong> rows_index_next;
+
+  atomic_stat<ulonglong> index_inserts;	/* Number of secondary index inserts. */
+  atomic_stat<ulonglong> comment_bytes;	/* Number of non-join empty queries */
+
+  void clear()
+  {
+    rows_index_first.clear();
+    rows_index_next.clear();
+    index_inserts.clear();
+    comment_bytes.clear();
+  }
+};
+
 /* global table statistics */
 typedef struct st_table_stats {
   SHARED_TABLE_STATS shared_stats;
@@ -468,9 +540,8 @@ typedef struct st_table_stats {
 
   page_stats_atomic_t page_stats;       /* per page type statistics */
 
-  /* See variables of same name in ha_statistics */
-  atomic_stat<ulonglong> rows_index_first;
-  atomic_stat<ulonglong> rows_index_next;
+  /* Counters updated by every statement */
+  sharded_stats<table_stats_counters> counters;
 
   my_io_perf_atomic_t io_perf_read;	/* Read IO performance counters */
   my_io_perf_atomic_t io_perf_write;	/* Write IO performance counters */
@@ -479,17 +550,14 @@ typedef struct st_table_stats {
                                               primary index */
   my_io_perf_atomic_t io_perf_read_secondary;/* Read IO performance counters for
                                                 secondary index */
-  atomic_stat<ulonglong> index_inserts;	/* Number of secondary index inserts. */
-  atomic_stat<ulonglong> comment_bytes;	/* Number of non-join empty queries */
-
   bool should_update; /* Set for partitioned tables so later partitions will
                          increment the perf stats. Clear after collecting
                          table stats. */
 
 } TABLE_STATS;
 
-typedef struct st_db_stats {
-  char db[NAME_LEN + 1];
+/* Per database counters updated by every statement, see DB_STATS */
+struct db_stats_counters {
   atomic_stat<ulonglong> us_user;
   atomic_stat<ulonglong> us_sys;
   atomic_stat<ulonglong> us_tot;
@@ -497,18 +565,35 @@ typedef struct st_db_stats {
   atomic_stat<ulonglong> rows_inserted; /* Number of rows inserted */
   atomic_stat<ulonglong> rows_read;     /* Number of rows read for this table */
   atomic_stat<ulonglong> rows_updated;  /* Number of rows updated */
+
+  void clear()
+  {
+    us_user.clear();
+    us_sys.clear();
+    us_tot.clear();
+    rows_deleted.clear();
+    rows_inserted.clear();
+    rows_read.clear();
+    rows_updated.clear();
+  }
+};
+
+typedef struct st_db_stats {
+  char db[NAME_LEN + 1];
+  sharded_stats<db_stats_counters> counters;
   unsigned char index;
 
   void update_cpu_stats(ulonglong us_u, ulonglong us_s)
   {
-    us_user.inc(us_u);
-    us_sys.inc(us_s);
-    us_tot.inc(us_s + us_u);
+    db_stats_counters &c= counters.local();
+    c.us_user.inc(us_u);
+    c.us_sys.inc(us_s);
+    c.us_tot.inc(us_s + us_u);
   }
 
   void update_cpu_stats_tot(ulonglong us_t)
   {
-    us_tot.inc(us_t);
+    counters.local().us_tot.inc(us_t);
   }
 } DB_STATS;
 
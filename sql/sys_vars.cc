@@ -713,6 +713,17 @@ static Sys_var_ulong Sys_binlog_stmt_cache_size(
        NO_MUTEX_GUARD, NOT_IN_BINLOG, ON_CHECK(0),
        ON_UPDATE(fix_binlog_stmt_cache_size));
 
+static Sys_var_ulonglong Sys_binlog_cache_stage_size(
+       "binlog_cache_stage_size",
+       "Transactions whose transactional cache for the binary log spilled "
+       "to disk and holds at least this many bytes prepare their events "
+       "for the binary log before entering the flush stage of group commit. "
+       "The flush stage then only fixes the positions of the events and "
+       "copies them to the binary log in the kernel where the platform "
+       "allows it. 0 disables staging",
+       GLOBAL_VAR(binlog_cache_stage_size), CMD_LINE(REQUIRED_ARG),
+       VALID_RANGE(0, ULONGLONG_MAX), DEFAULT(0), BLOCK_SIZE(IO_SIZE));
+
 static Sys_var_ulonglong Sys_binlog_rows_event_max_rows(
        "binlog_rows_event_max_rows",
        "Max number of rows in a single rows event",
@@ -1100,6 +1111,37 @@ static Sys_var_mybool Sys_binlog_trx_meta_data(
        GLOBAL_VAR(opt_binlog_trx_meta_data),
        CMD_LINE(OPT_ARG), DEFAULT(FALSE));
 
+static bool check_binlog_writeset_dependency_tracking(sys_var *self,
+                                                      THD *thd, set_var *var)
+{
+  if (gtid_mode != GTID_MODE_ON && var->save_result.ulonglong_value)
+    return true; // Needs gtid mode to write the dependency metadata
+
+  return false;
+}
+
+static Sys_var_mybool Sys_binlog_writeset_dependency_tracking(
+       "binlog_writeset_dependency_tracking",
+       "Compute the writeset of every trx during the binlog flush stage and "
+       "log the last conflicting trx (last_committed) and the trx's own "
+       "sequence number as part of Metadata log event. Dependency replication "
+       "uses this information to schedule trxs without extracting keys from "
+       "rows events.",
+       GLOBAL_VAR(opt_binlog_writeset_dependency_tracking),
+       CMD_LINE(OPT_ARG), DEFAULT(FALSE),
+       NO_MUTEX_GUARD, NOT_IN_BINLOG,
+       ON_CHECK(check_binlog_writeset_dependency_tracking));
+
+static Sys_var_ulong Sys_binlog_writeset_history_size(
+       "binlog_writeset_history_size",
+       "Max number of row hashes remembered to compute the writeset "
+       "dependency of trxs (see binlog_writeset_dependency_tracking). When "
+       "the history is full it is cleared and the next trx depends on all "
+       "previous trxs.",
+       GLOBAL_VAR(opt_binlog_writeset_history_size),
+       CMD_LINE(REQUIRED_ARG),
+       VALID_RANGE(1, 1000000), DEFAULT(25000), BLOCK_SIZE(1));
+
 static Sys_var_mybool Sys_log_column_names(
        "log_column_names",
        "Writes column name information in table map log events.",
@@ -1871,6 +1913,20 @@ static Sys_var_keycache Sys_key_cache_division_limit(
        BLOCK_SIZE(1), NO_MUTEX_GUARD, NOT_IN_BINLOG, ON_CHECK(0),
        ON_UPDATE(update_keycache_param));
 
+static Sys_var_keycache Sys_key_cache_partitions(
+       "key_cache_partitions",
+       "Number of partitions of a key cache. A key cache created with "
+       "partitions hashes blocks to partitions with their own lock and "
+       "replacement, serves cached blocks without locking and writes "
+       "blocks through to the index file. 0 uses a single lock. Only "
+       "takes effect when the key cache is created, a partitioned key "
+       "cache changes its number of partitions on the next resize",
+       KEYCACHE_VAR(param_partitions),
+       CMD_LINE(REQUIRED_ARG, OPT_KEY_CACHE_PARTITIONS),
+       VALID_RANGE(0, 64), DEFAULT(0),
+       BLOCK_SIZE(1), NO_MUTEX_GUARD, NOT_IN_BINLOG, ON_CHECK(0),
+       ON_UPDATE(update_keycache_param));
+
 static Sys_var_keycache Sys_key_cache_age_threshold(
        "key_cache_age_threshold", "This characterizes the number of "
        "hits a hot block has to be untouched until it is considered aged "
@@ -1910,6 +1966,27 @@ static Sys_var_mybool Sys_local_infile(
        "local_infile", "Enable LOAD DATA LOCAL INFILE",
        GLOBAL_VAR(opt_local_infile), CMD_LINE(OPT_ARG), DEFAULT(TRUE));
 
+static Sys_var_uint Sys_load_data_parse_threads(
+       "load_data_parse_threads",
+       "Number of threads that parse the file of a LOAD DATA INFILE "
+       "statement in parallel, while the rows are written to the table "
+       "in file order. Only used for files on the server with delimited "
+       "fields, no LINES STARTING BY, ASCII separators and a single-byte "
+       "or UTF-8 character set, when the statement is not logged in "
+       "statement format. 0 parses the file in the client thread",
+       SESSION_VAR(load_data_parse_threads), CMD_LINE(REQUIRED_ARG),
+       VALID_RANGE(0, 64), DEFAULT(0), BLOCK_SIZE(1));
+
+static Sys_var_uint Sys_insert_batch_rows(
+       "insert_batch_rows",
+       "Maximum number of rows of an INSERT ... VALUES statement that are "
+       "passed to the storage engine in one call. Statements that need "
+       "auto-increment values, fire triggers, write BLOB columns or use "
+       "REPLACE or ON DUPLICATE KEY UPDATE write one row at a time. "
+       "0 or 1 writes one row at a time",
+       SESSION_VAR(insert_batch_rows), CMD_LINE(REQUIRED_ARG),
+       VALID_RANGE(0, 1024), DEFAULT(0), BLOCK_SIZE(1));
+
 static void update_cached_timeout_var(ulonglong &dest, double src)
 {
   dest = double2ulonglong(src * 1e9);
@@ -2481,6 +2558,14 @@ static Sys_var_uint Sys_max_nonsuper_connections(
        VALID_RANGE(0, UINT_MAX), DEFAULT(0), BLOCK_SIZE(1), NO_MUTEX_GUARD,
        NOT_IN_BINLOG);
 
+static Sys_var_uint Sys_rpc_multiplex_threads(
+       "rpc_multiplex_threads",
+       "Number of threads executing multiplexed requests, the COM_RPC "
+       "requests with an rpc_tag query attribute. "
+       "0 disables multiplexed requests",
+       READ_ONLY GLOBAL_VAR(rpc_multiplex_threads), CMD_LINE(REQUIRED_ARG),
+       VALID_RANGE(0, 1024), DEFAULT(0), BLOCK_SIZE(1));
+
 static Sys_var_ulong Sys_max_tmp_tables(
        "max_tmp_tables",
        "Maximum number of temporary tables a client can keep open at a time",
@@ -3015,6 +3100,21 @@ static Sys_var_uint Sys_part_scan_max(
        SESSION_VAR(part_scan_max), CMD_LINE(REQUIRED_ARG),
        VALID_RANGE(1, UINT_MAX32), DEFAULT(10), BLOCK_SIZE(1));
 
+static Sys_var_mybool Sys_part_ordered_scan_prefetch(
+       "part_ordered_scan_prefetch",
+       "Before an ordered index scan of a partitioned table reads the "
+       "first row of each partition, ask the storage engine to start "
+       "reading the needed index pages of all partitions concurrently.",
+       SESSION_VAR(part_ordered_scan_prefetch), CMD_LINE(OPT_ARG),
+       DEFAULT(FALSE));
+
+static Sys_var_mybool Sys_part_lazy_open(
+       "part_lazy_open",
+       "Open the partitions of a partitioned table on first use after "
+       "partition pruning, instead of all of them when the table is opened. "
+       "Applies once one instance of the table has opened all partitions.",
+       GLOBAL_VAR(opt_part_lazy_open), CMD_LINE(OPT_ARG), DEFAULT(FALSE));
+
 static Sys_var_ulong Sys_range_alloc_block_size(
        "range_alloc_block_size",
        "Allocation block size for storing ranges during optimization",
@@ -3067,6 +3167,17 @@ static Sys_var_ulong Sys_query_prealloc_size(
        BLOCK_SIZE(1024), NO_MUTEX_GUARD, NOT_IN_BINLOG, ON_CHECK(0),
        ON_UPDATE(fix_thd_mem_root));
 
+static Sys_var_ulong Sys_query_prealloc_max_size(
+       "query_prealloc_max_size",
+       "Largest size the persistent buffer for query parsing and execution "
+       "grows to. When larger than query_prealloc_size, the buffer follows "
+       "the memory used by recent statements, so that statements like them "
+       "allocate no more memory. 0 keeps the buffer at query_prealloc_size",
+       SESSION_VAR(query_prealloc_max_size), CMD_LINE(REQUIRED_ARG),
+       VALID_RANGE(0, ULONG_MAX), DEFAULT(0),
+       BLOCK_SIZE(1024), NO_MUTEX_GUARD, NOT_IN_BINLOG, ON_CHECK(0),
+       ON_UPDATE(fix_thd_mem_root));
+
 #ifdef HAVE_SMEM
 static Sys_var_mybool Sys_shared_memory(
        "shared_memory", "Enable the shared memory",
@@ -5231,6 +5342,18 @@ static Sys_var_uint Sys_sync_relayloginfo_period(
        GLOBAL_VAR(sync_relayloginfo_period), CMD_LINE(REQUIRED_ARG),
        VALID_RANGE(0, UINT_MAX), DEFAULT(10000), BLOCK_SIZE(1));
 
+static Sys_var_uint Sys_relay_log_group_sync(
+       "relay_log_group_sync", "If non-zero, the slave I/O thread syncs "
+       "the relay log and flushes the master info once per batch of events "
+       "received from the master without waiting, instead of after every "
+       "event, and sync_relay_log and sync_master_info count batches. The "
+       "value is the maximum number of events in a batch. Multi-threaded "
+       "slave workers with a non-transactional relay log info repository "
+       "then also sync their positions once per checkpoint instead of as "
+       "per sync_relay_log_info. Use 0 to disable batching",
+       GLOBAL_VAR(opt_relay_log_group_sync), CMD_LINE(REQUIRED_ARG),
+       VALID_RANGE(0, UINT_MAX), DEFAULT(0), BLOCK_SIZE(1));
+
 static Sys_var_uint Sys_checkpoint_mts_period(
        "slave_checkpoint_period", "Gather workers' activities to "
        "Update progress status of Multi-threaded slave and flush "
@@ -6206,6 +6329,19 @@ static Sys_var_mybool Sys_response_attrs_contain_hlc(
     ON_CHECK(check_outside_transaction),
     ON_UPDATE(0));
 
+static Sys_var_mybool Sys_response_attrs_contain_commit_ticket(
+    "response_attrs_contain_commit_ticket",
+    "If this is enabled, then the commit ticket of a transaction written to "
+    "the binary log is sent back to clients as part of OK packet in session "
+    "response attribute, with the key 'commit_ticket'. The ticket is the "
+    "binary log file and end position of the transaction, and "
+    "WAIT_FOR_COMMIT_TICKET() waits until the transactions up to it are "
+    "durable. With sql_async_commit, COMMIT returns before the binary log "
+    "is synced",
+    SESSION_VAR(response_attrs_contain_commit_ticket), CMD_LINE(OPT_ARG),
+    DEFAULT(FALSE), NO_MUTEX_GUARD, NOT_IN_BINLOG, ON_CHECK(0),
+    ON_UPDATE(0));
+
 static bool update_session_track_state_change(sys_var *self, THD *thd,
                                               enum_var_type type)
 {
@@ -6487,3 +6623,26 @@ static Sys_var_mybool Sys_high_precision_processlist(
        CMD_LINE(OPT_ARG), DEFAULT(FALSE));
 
 #endif
+
+static bool fix_processlist_snapshot(sys_var *self, THD *thd,
+                                     enum_var_type type)
+{
+  if (opt_processlist_snapshot)
+  {
+    mysql_mutex_unlock(&LOCK_global_system_variables);
+    thd_status_publish_all();
+    mysql_mutex_lock(&LOCK_global_system_variables);
+  }
+  return false;
+}
+
+static Sys_var_mybool Sys_processlist_snapshot(
+       "processlist_snapshot",
+       "If set, SHOW PROCESSLIST, SHOW TRANSACTION_LIST and their "
+       "information_schema tables are built from the status each thread "
+       "publishes at statement boundaries, without blocking connections "
+       "from exiting or locking them. Queries are truncated to 1024 bytes "
+       "and attached sessions are not shown.",
+       GLOBAL_VAR(opt_processlist_snapshot),
+       CMD_LINE(OPT_ARG), DEFAULT(FALSE), NO_MUTEX_GUARD, NOT_IN_BINLOG,
+       ON_CHECK(0), ON_UPDATE(fix_processlist_snapshot));
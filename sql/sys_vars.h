@@ -2203,10 +2203,6 @@ public:
     DBUG_ENTER("Sys_var_gtid_ended_groups::session_value_ptr");
     Gtid_set gs(global_sid_map);
     char *buf;
-    // As an optimization, add 10 Intervals that do not need to be
-    // allocated.
-    Gtid_set::Interval ivs[10];
-    gs.add_interval_memory(10, ivs);
     global_sid_lock->wrlock();
     if (get_gtid_set(thd, &gs) != RETURN_STATUS_OK)
       goto error;
@@ -809,6 +809,15 @@ struct TABLE_SHARE
   */
   int cached_row_logging_check;
 
+  /*
+    Global statistics of this table, looked up by the first handler that
+    updates them. Read and set with my_atomic_loadptr/my_atomic_storeptr.
+    The entry is freed by table_stats_delete() when the table is dropped,
+    which happens after the share was removed from the table definition
+    cache under an exclusive metadata lock, so no share still points to it.
+  */
+  struct st_table_stats *table_stats;
+
   /*
     Storage media to use for this table (unless another storage
     media has been specified on an individual column - in versions
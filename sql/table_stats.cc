@@ -35,14 +35,7 @@ void update_table_stats(THD *thd, TABLE *tablep, bool follow_next)
 static void
 clear_shared_table_stats(SHARED_TABLE_STATS *table_stats)
 {
-  table_stats->queries_used.clear();
-  table_stats->queries_empty.clear();
-
-  table_stats->rows_inserted.clear();
-  table_stats->rows_updated.clear();
-  table_stats->rows_deleted.clear();
-  table_stats->rows_read.clear();
-  table_stats->rows_requested.clear();
+  table_stats->counters.clear();
 }
 
 static void
@@ -70,16 +63,13 @@ clear_table_stats(TABLE_STATS* table_stats)
   table_stats->n_lock_wait_timeout.clear();
   table_stats->n_lock_deadlock.clear();
 
-  table_stats->rows_index_first.clear();
-  table_stats->rows_index_next.clear();
+  table_stats->counters.clear();
 
   table_stats->io_perf_read.init();
   table_stats->io_perf_write.init();
   table_stats->io_perf_read_blob.init();
   table_stats->io_perf_read_primary.init();
   table_stats->io_perf_read_secondary.init();
-  table_stats->index_inserts.clear();
-  table_stats->comment_bytes.clear();
 
   memset(&table_stats->page_stats, 0, sizeof(table_stats->page_stats));
   memset(&table_stats->comp_stats, 0, sizeof(table_stats->comp_stats));
@@ -528,13 +518,15 @@ void fill_table_stats_cb(const char *db,
 static
 bool valid_shared_table_stats(SHARED_TABLE_STATS *stats)
 {
-  if (stats->rows_inserted.load() == 0 &&
-      stats->rows_updated.load() == 0 &&
-      stats->rows_deleted.load() == 0 &&
-      stats->rows_read.load() == 0 &&
-      stats->rows_requested.load() == 0 &&
-      stats->queries_used.load() == 0 &&
-      stats->queries_empty.load() == 0)
+  typedef shared_table_stats_counters C;
+
+  if (stats->counters.load(&C::rows_inserted) == 0 &&
+      stats->counters.load(&C::rows_updated) == 0 &&
+      stats->counters.load(&C::rows_deleted) == 0 &&
+      stats->counters.load(&C::rows_read) == 0 &&
+      stats->counters.load(&C::rows_requested) == 0 &&
+      stats->counters.load(&C::queries_used) == 0 &&
+      stats->counters.load(&C::queries_empty) == 0)
     return false;
   else
     return true;
@@ -571,7 +563,7 @@ bool valid_global_table_stats(TABLE_STATS *table_stats)
       table_stats->io_perf_read_blob.requests.load() == 0 &&
       table_stats->io_perf_read_primary.requests.load() == 0 &&
       table_stats->io_perf_read_secondary.requests.load() == 0 &&
-      table_stats->comment_bytes.load() == 0 &&
+      table_stats->counters.load(&table_stats_counters::comment_bytes) == 0 &&
       table_stats->page_stats.n_pages_read.load() == 0 &&
       table_stats->page_stats.n_pages_read_index.load() == 0 &&
       table_stats->page_stats.n_pages_read_blob.load() == 0 &&
@@ -635,8 +627,12 @@ int fill_table_stats(THD *thd, TABLE_LIST *tables, Item *cond)
     table->field[f++]->store((ulonglong)my_timer_to_microseconds(
       table_stats->comp_stats.decompressed_time.load()), TRUE);
 
-    table->field[f++]->store(table_stats->rows_index_first.load(), TRUE);
-    table->field[f++]->store(table_stats->rows_index_next.load(), TRUE);
+    table->field[f++]->store(
+      table_stats->counters.load(&table_stats_counters::rows_index_first),
+      TRUE);
+    table->field[f++]->store(
+      table_stats->counters.load(&table_stats_counters::rows_index_next),
+      TRUE);
 
     table->field[f++]->store(table_stats->io_perf_read.bytes.load(), TRUE);
     table->field[f++]->store(table_stats->io_perf_read.requests.load(), TRUE);
@@ -718,9 +714,11 @@ int fill_table_stats(THD *thd, TABLE_LIST *tables, Item *cond)
     table->field[f++]->store(
       table_stats->io_perf_read_secondary.slow_ios.load(), TRUE);
 
-    table->field[f++]->store(table_stats->index_inserts.load(), TRUE);
+    table->field[f++]->store(
+      table_stats->counters.load(&table_stats_counters::index_inserts), TRUE);
 
-    table->field[f++]->store(table_stats->comment_bytes.load(), TRUE);
+    table->field[f++]->store(
+      table_stats->counters.load(&table_stats_counters::comment_bytes), TRUE);
 
     table->field[f++]->store(
       table_stats->page_stats.n_pages_read.load(), TRUE);
@@ -1421,14 +1419,16 @@ void fill_shared_table_stats(
   table->field[f++]->store(stats->engine_name, strlen(stats->engine_name),
                            system_charset_info);
 
-  table->field[f++]->store(stats->rows_inserted.load(), TRUE);
-  table->field[f++]->store(stats->rows_updated.load(), TRUE);
-  table->field[f++]->store(stats->rows_deleted.load(), TRUE);
-  table->field[f++]->store(stats->rows_read.load(), TRUE);
-  table->field[f++]->store(stats->rows_requested.load(), TRUE);
+  typedef shared_table_stats_counters C;
+
+  table->field[f++]->store(stats->counters.load(&C::rows_inserted), TRUE);
+  table->field[f++]->store(stats->counters.load(&C::rows_updated), TRUE);
+  table->field[f++]->store(stats->counters.load(&C::rows_deleted), TRUE);
+  table->field[f++]->store(stats->counters.load(&C::rows_read), TRUE);
+  table->field[f++]->store(stats->counters.load(&C::rows_requested), TRUE);
 
-  table->field[f++]->store(stats->queries_used.load(), TRUE);
-  table->field[f++]->store(stats->queries_empty.load(), TRUE);
+  table->field[f++]->store(stats->counters.load(&C::queries_used), TRUE);
+  table->field[f++]->store(stats->counters.load(&C::queries_empty), TRUE);
 
   *offset = f;
 }
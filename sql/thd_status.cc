@@ -0,0 +1,260 @@
+/* Copyright (c) 2020, Facebook, Inc.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA */
+
+#include "thd_status.h"
+#include "sql_class.h"
+#include "global_threads.h"
+
+#include <mutex>
+
+/* Read the processlists from the published thread status */
+my_bool opt_processlist_snapshot= FALSE;
+
+/* Records are allocated in chunks, which are never freed */
+#define THD_STATUS_CHUNK_SIZE 256
+#define THD_STATUS_MAX_CHUNKS 4096
+
+class Thd_status_registry
+{
+public:
+  static Thd_status_record *acquire();
+  static void release(Thd_status_record *record);
+  static void snapshot(std::vector<Thd_status> *snapshot);
+  static void free_all();
+
+private:
+  /* Protects the free list and the allocation of chunks */
+  static std::mutex m_lock;
+  static std::vector<Thd_status_record *> m_free;
+  /* Readers go through the chunks without m_lock */
+  static std::atomic<Thd_status_record *> m_chunks[THD_STATUS_MAX_CHUNKS];
+  static std::atomic<uint> m_chunk_count;
+};
+
+std::mutex Thd_status_registry::m_lock;
+std::vector<Thd_status_record *> Thd_status_registry::m_free;
+std::atomic<Thd_status_record *>
+  Thd_status_registry::m_chunks[THD_STATUS_MAX_CHUNKS];
+std::atomic<uint> Thd_status_registry::m_chunk_count(0);
+
+
+Thd_status_record *Thd_status_registry::acquire()
+{
+  Thd_status_record *record;
+  std::lock_guard<std::mutex> guard(m_lock);
+
+  if (m_free.empty())
+  {
+    uint chunk= m_chunk_count.load(std::memory_order_relaxed);
+    if (chunk == THD_STATUS_MAX_CHUNKS)
+      return NULL;
+    Thd_status_record *records=
+      new (std::nothrow) Thd_status_record[THD_STATUS_CHUNK_SIZE];
+    if (!records)
+      return NULL;
+    m_chunks[chunk].store(records, std::memory_order_relaxed);
+    m_chunk_count.store(chunk + 1, std::memory_order_release);
+    for (uint i= THD_STATUS_CHUNK_SIZE; i-- > 0; )
+      m_free.push_back(&records[i]);
+  }
+  record= m_free.back();
+  m_free.pop_back();
+  record->m_in_use.store(true, std::memory_order_release);
+  return record;
+}
+
+
+void Thd_status_registry::release(Thd_status_record *record)
+{
+  record->m_in_use.store(false, std::memory_order_release);
+  std::lock_guard<std::mutex> guard(m_lock);
+  m_free.push_back(record);
+}
+
+
+/*
+  Copy the status of the threads in use. A thread added or removed during
+  the copy may or may not be part of it.
+*/
+
+void Thd_status_registry::snapshot(std::vector<Thd_status> *snapshot)
+{
+  uint chunks= m_chunk_count.load(std::memory_order_acquire);
+  Thd_status status;
+
+  for (uint chunk= 0; chunk < chunks; chunk++)
+  {
+    const Thd_status_record *records=
+      m_chunks[chunk].load(std::memory_order_relaxed);
+    for (uint i= 0; i < THD_STATUS_CHUNK_SIZE; i++)
+    {
+      if (records[i].read(&status))
+        snapshot->push_back(status);
+    }
+  }
+}
+
+
+void Thd_status_registry::free_all()
+{
+  std::lock_guard<std::mutex> guard(m_lock);
+  uint chunks= m_chunk_count.load(std::memory_order_relaxed);
+  for (uint chunk= 0; chunk < chunks; chunk++)
+    delete [] m_chunks[chunk].load(std::memory_order_relaxed);
+  m_chunk_count.store(0, std::memory_order_relaxed);
+  m_free.clear();
+}
+
+
+/*
+  Copy the published status of a thread.
+
+  @retval false  the record is not used by a thread
+*/
+
+bool Thd_status_record::read(Thd_status *to) const
+{
+  for (;;)
+  {
+    if (!m_in_use.load(std::memory_order_acquire))
+      return false;
+    ulonglong seq= m_seq.load(std::memory_order_acquire);
+    if (seq & 1)
+    {
+      pthread_yield();
+      continue;
+    }
+    memcpy(to, &m_status, sizeof(*to));
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (m_seq.load(std::memory_order_relaxed) == seq)
+      break;
+  }
+  to->killed= m_killed.load(std::memory_order_relaxed);
+  to->stmt_start= m_stmt_start.load(std::memory_order_relaxed);
+  to->state= m_state.load(std::memory_order_relaxed);
+  return true;
+}
+
+
+Thd_status_record *thd_status_acquire()
+{
+  return Thd_status_registry::acquire();
+}
+
+
+void thd_status_release(Thd_status_record *record)
+{
+  Thd_status_registry::release(record);
+}
+
+
+void thd_status_snapshot(std::vector<Thd_status> *snapshot)
+{
+  Thd_status_registry::snapshot(snapshot);
+}
+
+
+void thd_status_free()
+{
+  Thd_status_registry::free_all();
+}
+
+
+/*
+  Publish the status of a thread, at a statement boundary.
+*/
+
+void thd_status_publish(THD *thd)
+{
+  Thd_status_record *record= thd->status_record;
+  Security_context *sctx= thd->security_ctx;
+  const char *host;
+  const char *query= NULL;
+  uint query_length= 0;
+
+  if (!record)
+    return;
+
+  Thd_status *status= record->begin_write();
+  status->thread_id= thd->thread_id();
+  status->system_thread_id= (ulong) thd->system_thread_id;
+  status->command= thd->get_command();
+  status->system_thread= thd->system_thread != NON_SYSTEM_THREAD;
+  status->visible= thd->vio_ok() || thd->system_thread ||
+                   thd->is_a_srv_session();
+  status->start_time= thd->start_time;
+  status->trx_time= thd->trx_time;
+  status->command_time= thd->status_var.command_time;
+  status->rw_trans= thd->rw_trans;
+  status->sql_log_bin= thd->variables.sql_log_bin;
+  status->rows_examined= (ulong) thd->get_examined_row_count();
+  status->rows_sent= (ulong) thd->get_sent_row_count();
+  status->query_charset= thd->query_charset();
+
+  strmake(status->user, sctx->user ? sctx->user : "", USERNAME_LENGTH);
+  /* The host is shown with the port when the peer has an address */
+  status->peer_port= thd->peer_port && (sctx->get_host()->length() ||
+                                        sctx->get_ip()->length()) ?
+                     thd->peer_port : 0;
+  host= sctx->host_or_ip && sctx->host_or_ip[0] ? sctx->host_or_ip :
+        sctx->get_host()->length() ? sctx->get_host()->ptr() : "";
+  strmake(status->host_or_ip, host, THD_STATUS_HOST_LENGTH);
+
+  if ((status->has_db= thd->db != NULL))
+    strmake(status->db, thd->db, NAME_LEN);
+
+  if (!thd->row_query.empty())
+  {
+    query= thd->row_query.c_str();
+    query_length= thd->row_query.length();
+  }
+  else if (thd->query())
+  {
+    query= thd->query();
+    query_length= thd->query_length();
+  }
+  if ((status->has_query= query != NULL))
+  {
+    query_length= MY_MIN(query_length, THD_STATUS_QUERY_LENGTH);
+    memcpy(status->query, query, query_length);
+    status->query[query_length]= 0;
+  }
+  status->query_length= query_length;
+  record->end_write();
+
+  record->set_killed(thd->killed == THD::KILL_CONNECTION);
+  record->set_stmt_start(thd->stmt_start);
+}
+
+
+/*
+  Publish the status of all threads, when processlist_snapshot is turned
+  on. The records were not written while it was off.
+*/
+
+void thd_status_publish_all()
+{
+  std::set<THD*> threads;
+
+  mutex_lock_all_shards(SHARDED(&LOCK_thd_remove));
+  copy_global_thread_list(&threads);
+  for (THD *thd : threads)
+  {
+    mysql_mutex_lock(&thd->LOCK_thd_data);
+    thd->publish_status();
+    mysql_mutex_unlock(&thd->LOCK_thd_data);
+  }
+  mutex_unlock_all_shards(SHARDED(&LOCK_thd_remove));
+}
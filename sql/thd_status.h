@@ -0,0 +1,145 @@
+/* Copyright (c) 2020, Facebook, Inc.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA */
+
+/* Published status of the threads, for lock-free processlist snapshots.
+
+   SHOW PROCESSLIST, SHOW TRANSACTION_LIST and their information_schema
+   tables normally block the removal of all threads while they run and lock
+   every THD they show. With processlist_snapshot they instead copy the
+   status each thread publishes in a Thd_status_record.
+
+   A thread writes its record at statement boundaries (command, query,
+   current database changes), seqlock style: the sequence number is odd
+   while the record is written, and readers retry a copy during which it
+   changed. Threads only write their record while processlist_snapshot is
+   on, and turning it on publishes the status of all threads once, so the
+   statements pay nothing for the records while it is off. The state, the
+   statement start and the killed flag change in the middle of statements,
+   possibly from other threads, and are published as separate atomics.
+
+   Records are never freed. A THD takes one when it is added to the thread
+   list and returns it when it is removed, so a reader may copy the record
+   of a thread that is going away, but never freed memory.
+*/
+
+#ifndef THD_STATUS_INCLUDED
+#define THD_STATUS_INCLUDED
+
+#include "my_global.h"
+#include "my_sys.h"
+#include "mysql_com.h"
+#include "my_time.h"
+
+#include <atomic>
+#include <vector>
+
+class THD;
+
+/* Longest query text kept in a record */
+#define THD_STATUS_QUERY_LENGTH 1024
+
+/* Length of the host in a record, as the processlist shows it */
+#define THD_STATUS_HOST_LENGTH 64
+
+/* The status a thread publishes, copied out by readers */
+struct Thd_status
+{
+  my_thread_id thread_id;
+  ulong system_thread_id;
+  enum enum_server_command command;
+  bool system_thread;
+  bool visible;                         // see access_thread()
+  timeval start_time;
+  ulonglong stmt_start;
+  ulonglong trx_time;
+  ulonglong command_time;
+  bool rw_trans;
+  bool sql_log_bin;
+  bool killed;
+  ulong rows_examined;
+  ulong rows_sent;
+  const char *state;                    // static string, or NULL
+  const CHARSET_INFO *query_charset;
+  uint peer_port;
+  uint query_length;
+  bool has_db;
+  bool has_query;
+  char user[USERNAME_LENGTH + 1];       // "" if not authenticated
+  char host_or_ip[THD_STATUS_HOST_LENGTH + 1];
+  char db[NAME_LEN + 1];
+  char query[THD_STATUS_QUERY_LENGTH + 1];
+};
+
+class Thd_status_record
+{
+public:
+  Thd_status_record() : m_seq(0), m_in_use(false), m_killed(false),
+                        m_stmt_start(0), m_state(NULL) {}
+
+  /*
+    Start writing the status. Returns the status to fill in, which
+    end_write() publishes.
+  */
+  Thd_status *begin_write()
+  {
+    ulonglong seq= m_seq.load(std::memory_order_relaxed);
+    /* Writers of other threads (KILL does not write here) are rare */
+    while ((seq & 1) ||
+           !m_seq.compare_exchange_weak(seq, seq + 1,
+                                        std::memory_order_relaxed))
+    {
+      seq= m_seq.load(std::memory_order_relaxed);
+    }
+    std::atomic_thread_fence(std::memory_order_release);
+    return &m_status;
+  }
+
+  void end_write()
+  {
+    m_seq.fetch_add(1, std::memory_order_release);
+  }
+
+  bool read(Thd_status *to) const;
+
+  void set_killed(bool killed)
+  { m_killed.store(killed, std::memory_order_relaxed); }
+
+  void set_stmt_start(ulonglong stmt_start)
+  { m_stmt_start.store(stmt_start, std::memory_order_relaxed); }
+
+  void set_state(const char *state)
+  { m_state.store(state, std::memory_order_relaxed); }
+
+private:
+  friend class Thd_status_registry;
+
+  std::atomic<ulonglong> m_seq;
+  std::atomic<bool> m_in_use;
+  std::atomic<bool> m_killed;
+  std::atomic<ulonglong> m_stmt_start;
+  std::atomic<const char *> m_state;
+  Thd_status m_status;
+};
+
+Thd_status_record *thd_status_acquire();
+void thd_status_release(Thd_status_record *record);
+void thd_status_publish(THD *thd);
+void thd_status_publish_all();
+void thd_status_snapshot(std::vector<Thd_status> *snapshot);
+void thd_status_free();
+
+extern my_bool opt_processlist_snapshot;
+
+#endif /* THD_STATUS_INCLUDED */
@@ -159,7 +159,8 @@ int write_header(azio_stream *s)
     return 0;
 
   s->block_size= AZ_BUFSIZE_WRITE;
-  s->version = (unsigned char)az_magic[1];
+  if (s->version != AZ_COLUMNAR_VERSION)
+    s->version = (unsigned char)az_magic[1];
   s->minor_version = (unsigned char)az_magic[2];
 
 
@@ -201,6 +202,26 @@ int azopen(azio_stream *s, const char *path, int Flags)
   return az_open(s, path, Flags, -1);
 }
 
+/* ===========================================================================
+  Opens a file, created in the columnar format if Flags create it.
+*/
+int azopen_columnar(azio_stream *s, const char *path, int Flags)
+{
+  if (!az_open(s, path, Flags, -1))
+    return 0;
+
+  if (Flags & O_CREAT || Flags & O_TRUNC)
+  {
+    s->version= AZ_COLUMNAR_VERSION;
+    if (write_header(s))
+    {
+      destroy(s);
+      return 0;
+    }
+  }
+  return 1;
+}
+
 /* ===========================================================================
   Associate a gzFile with the file descriptor fd. fd is not dup'ed here
   to mimic the behavio(u)r of fdopen.
@@ -314,7 +335,9 @@ void check_header(azio_stream *s)
     if (!s->start)
       s->start= my_tell(s->file, MYF(0)) - s->stream.avail_in;
   }
-  else if ( s->stream.next_in[0] == az_magic[0]  && s->stream.next_in[1] == az_magic[1])
+  else if ( s->stream.next_in[0] == az_magic[0]  &&
+            (s->stream.next_in[1] == az_magic[1] ||
+             s->stream.next_in[1] == AZ_COLUMNAR_VERSION))
   {
     unsigned char buffer[AZHEADER_SIZE + AZMETA_BUFFER_SIZE];
 
@@ -335,7 +358,8 @@ void check_header(azio_stream *s)
 
 void read_header(azio_stream *s, unsigned char *buffer)
 {
-  if (buffer[0] == az_magic[0]  && buffer[1] == az_magic[1])
+  if (buffer[0] == az_magic[0]  &&
+      (buffer[1] == az_magic[1] || buffer[1] == AZ_COLUMNAR_VERSION))
   {
     s->version= (unsigned int)buffer[AZ_VERSION_POS];
     s->minor_version= (unsigned int)buffer[AZ_MINOR_VERSION_POS];
@@ -642,6 +666,16 @@ int ZEXPORT azflush (s, flush)
 
     return Z_OK;
   }
+  else if (s->version == AZ_COLUMNAR_VERSION)
+  {
+    /* Blocks are written as a whole, only the header is behind */
+    s->forced_flushes++;
+    s->dirty= AZ_STATE_SAVED;
+    if (write_header(s))
+      return Z_ERRNO;
+    my_sync(s->file, MYF(0));
+    return Z_OK;
+  }
   else
   {
     s->forced_flushes++;
@@ -811,7 +845,13 @@ int azclose (azio_stream *s)
   
   if (s->file < 1) return Z_OK;
 
-  if (s->mode == 'w') 
+  if (s->mode == 'w' && s->version == AZ_COLUMNAR_VERSION)
+  {
+    s->dirty= AZ_STATE_CLEAN;
+    s->check_point= my_tell(s->file, MYF(0));
+    write_header(s);
+  }
+  else if (s->mode == 'w') 
   {
     if (do_flush(s, Z_FINISH) != Z_OK)
       return destroy(s);
@@ -826,6 +866,26 @@ int azclose (azio_stream *s)
   return destroy(s);
 }
 
+/*
+  Blocks of the columnar format. The file offset of a writer is kept at the
+  end of the file.
+*/
+my_off_t azwrite_block(azio_stream *s, const uchar *blob, size_t length)
+{
+  if (s->mode == 'r' || s->version != AZ_COLUMNAR_VERSION)
+    return MY_FILEPOS_ERROR;
+
+  if (mysql_file_write(s->file, blob, length, MYF(MY_NABP)))
+    return MY_FILEPOS_ERROR;
+
+  return my_tell(s->file, MYF(0));
+}
+
+size_t azread_block(azio_stream *s, uchar *blob, size_t length, my_off_t pos)
+{
+  return my_pread(s->file, blob, length, pos, MYF(0));
+}
+
 /*
   Though this was added to support MySQL's FRM file, anything can be 
   stored in this location.
@@ -73,6 +73,11 @@ extern "C" {
 #define AZ_COMMENT_LENGTH_POS 73
 #define AZ_DIRTY_POS 77
 
+/*
+  Version of the files whose rows are stored in blocks of columns, see
+  ha_archive.cc, rather than in a deflate stream.
+*/
+#define AZ_COLUMNAR_VERSION 4
 
 /*
   Flags for state
@@ -331,6 +336,28 @@ extern int azclose(azio_stream *file);
    error number (see function gzerror below).
 */
 
+extern int azopen_columnar(azio_stream *s, const char *path, int Flags);
+/*
+     Like azopen(), but a file created by the call is in the columnar
+   format. Its rows are not written with azwrite() and read with azread(),
+   but as blocks with azwrite_block() and azread_block().
+*/
+
+extern my_off_t azwrite_block(azio_stream *s, const uchar *blob,
+                              size_t length);
+/*
+     Appends a block to a file in the columnar format opened for writing.
+   Returns the position of the end of the block, or MY_FILEPOS_ERROR.
+*/
+
+extern size_t azread_block(azio_stream *s, uchar *blob, size_t length,
+                           my_off_t pos);
+/*
+     Reads up to length bytes at position pos of a file in the columnar
+   format. Returns the number of bytes read, less than length at the end of
+   the file, or (size_t) -1 on errors.
+*/
+
 extern int azwrite_frm (azio_stream *s, char *blob, unsigned int length);
 extern int azread_frm (azio_stream *s, char *blob);
 extern int azwrite_comment (azio_stream *s, char *blob, unsigned int length);
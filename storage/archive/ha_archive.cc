@@ -20,13 +20,19 @@
 #include "probes_mysql.h"
 #include "sql_class.h"                          // SSV
 #include "sql_table.h"
+#include "sql_time.h"                           // str_to_datetime
 #include <myisam.h>
 
 #include "ha_archive.h"
 #include <my_dir.h>
+#include <my_atomic.h>
 
 #include <mysql/plugin.h>
 
+#ifdef HAVE_ZSTD_COMPRESS
+#include <zstd.h>
+#endif
+
 /*
   First, if you want to understand storage engines you should look at 
   ha_example.cc and ha_example.h. 
@@ -98,6 +104,29 @@
   <5.1.5 - v.1
   5.1.5-5.1.15 - v.2
   >5.1.15 - v.3
+  v.4 - columnar, created when archive_columnar is set
+
+  The columnar format keeps the header, frm and comment of v.3, but the
+  rows are stored in blocks of up to ARCHIVE_BLOCK_ROWS rows rather than in
+  one deflate stream. Each column of a block is compressed on its own with
+  zstd:
+
+    block header   magic (4), rows (4), columns (2)
+    column header  flags (1), compressed length (4), length (4),
+                   smallest value (8), largest value (8), for each column
+    column data    for each column, in order
+
+  A column holds, for each row, a null flag if the column is nullable and
+  the value packed by Field::pack() if it is not NULL. The smallest and
+  largest values are kept for integer and DATE/DATETIME columns, so that a
+  scan skips the blocks which cannot match the condition pushed by the
+  optimizer. A scan only reads and decompresses the columns of the read
+  set. The position of a row is the position of its block shifted by
+  ARCHIVE_ROW_BITS, plus its row number in the block.
+
+  A writer buffers the rows of the next block in Archive_block, and writes
+  it when it is full or when readers have to see the rows, like the deflate
+  stream is flushed for them.
 */
 
 /* The file extension */
@@ -119,6 +148,23 @@
 #define DATA_BUFFER_SIZE 2       // Size of the data used in the data file
 #define ARCHIVE_CHECK_HEADER 254 // The number we use to determine corruption
 
+/* Columnar format */
+#define ARCHIVE_BLOCK_MAGIC 0x4B4C4241   // "ABLK"
+#define ARCHIVE_BLOCK_HEADER_SIZE 10
+#define ARCHIVE_COLUMN_HEADER_SIZE 25
+#define ARCHIVE_COLUMN_ZSTD  1           // Compressed with zstd
+#define ARCHIVE_COLUMN_STATS 2           // Smallest and largest values set
+#define ARCHIVE_COLUMN_NULL  4           // All values are NULL
+#define ARCHIVE_ROW_BITS 16
+#define ARCHIVE_ZSTD_LEVEL 3
+
+/* Create data files in the columnar format */
+static my_bool archive_columnar= FALSE;
+
+/* Blocks of the columnar format read and skipped by scans */
+static volatile int64 archive_blocks_read= 0;
+static volatile int64 archive_blocks_skipped= 0;
+
 #ifdef HAVE_PSI_INTERFACE
 extern "C" PSI_file_key arch_key_file_data;
 #endif
@@ -231,7 +277,10 @@ Archive_share::Archive_share()
 
 
 ha_archive::ha_archive(handlerton *hton, TABLE_SHARE *table_arg)
-  :handler(hton, table_arg), share(NULL), delayed_insert(0), bulk_insert(0)
+  :handler(hton, table_arg), share(NULL), delayed_insert(0), bulk_insert(0),
+  block_position(MY_FILEPOS_ERROR), next_block_position(0), block_rows(0),
+  block_row(0), column_readers(NULL), skip_record(NULL),
+  pushed_archive_cond(NULL), n_ranges(0)
 {
   /* Set our original buffer from pre-allocated memory */
   buffer.set((char *)byte_buffer, IO_SIZE, system_charset_info);
@@ -403,6 +452,9 @@ int ha_archive::read_data_header(azio_stream *file_to_read)
   if (azrewind(file_to_read) == -1)
     DBUG_RETURN(HA_ERR_CRASHED_ON_USAGE);
 
+  if (file_to_read->version == ARCHIVE_COLUMNAR_VERSION)
+    rewind_blocks();
+
   if (file_to_read->version >= 3)
     DBUG_RETURN(0);
   /* Everything below this is just legacy to version 2< */
@@ -485,6 +537,9 @@ Archive_share *ha_archive::get_share(const char *table_name, int *rc)
     stats.auto_increment_value= archive_tmp.auto_increment + 1;
     tmp_share->rows_recorded= (ha_rows)archive_tmp.rows;
     tmp_share->crashed= archive_tmp.dirty;
+    if (archive_tmp.version == ARCHIVE_COLUMNAR_VERSION)
+      tmp_share->write_block.end= my_seek(archive_tmp.file, 0L, MY_SEEK_END,
+                                          MYF(0));
     share= tmp_share;
     if (archive_tmp.version == 1)
       share->read_v1_metafile();
@@ -531,6 +586,9 @@ void Archive_share::close_archive_writer()
   {
     if (archive_write.version == 1)
       (void) write_v1_metafile();
+    if (archive_write.version == ARCHIVE_COLUMNAR_VERSION &&
+        write_block.rows)
+      (void) write_block.write(&archive_write);
     azclose(&archive_write);
     archive_write_open= false;
     dirty= false;
@@ -538,6 +596,129 @@ void Archive_share::close_archive_writer()
 }
 
 
+/*
+  Make the rows written visible to the readers.
+*/
+int Archive_share::flush_archive_writer()
+{
+  int rc;
+  mysql_mutex_assert_owner(&mutex);
+  if (archive_write.version == ARCHIVE_COLUMNAR_VERSION &&
+      write_block.rows && (rc= write_block.write(&archive_write)))
+    return rc;
+  return azflush(&archive_write, Z_SYNC_FLUSH);
+}
+
+
+/*
+  Start a new block with the rows of a writer, see ha_archive::write_row().
+*/
+bool Archive_block::init(uint fields_arg)
+{
+  if (columns)
+    return false;
+  if (!(columns= new Archive_column_buffer[fields_arg]))
+    return true;
+  fields= fields_arg;
+  reset();
+  return false;
+}
+
+
+void Archive_block::reset()
+{
+  for (uint i= 0; i < fields; i++)
+  {
+    columns[i].values.length(0);
+    columns[i].not_null= 0;
+    columns[i].min= columns[i].max= 0;
+  }
+  rows= 0;
+  length= 0;
+}
+
+
+/*
+  Compress the buffered rows column by column, and append them to the data
+  file as a block.
+*/
+int Archive_block::write(azio_stream *writer)
+{
+  size_t header_length= ARCHIVE_BLOCK_HEADER_SIZE +
+                        fields * ARCHIVE_COLUMN_HEADER_SIZE;
+  size_t size= header_length;
+  my_off_t block_end;
+  uchar *header, *data;
+  DBUG_ENTER("Archive_block::write");
+  DBUG_ASSERT(rows && writer->version == ARCHIVE_COLUMNAR_VERSION);
+
+  for (uint i= 0; i < fields; i++)
+  {
+#ifdef HAVE_ZSTD_COMPRESS
+    size+= ZSTD_compressBound(columns[i].values.length());
+#else
+    size+= columns[i].values.length();
+#endif
+  }
+  if (out.alloc((uint32) size))
+    DBUG_RETURN(HA_ERR_OUT_OF_MEM);
+
+  header= (uchar*) out.ptr();
+  int4store(header, ARCHIVE_BLOCK_MAGIC);
+  int4store(header + 4, rows);
+  int2store(header + 8, fields);
+  data= header + header_length;
+
+  for (uint i= 0; i < fields; i++)
+  {
+    Archive_column_buffer *column= &columns[i];
+    uchar *column_header= header + ARCHIVE_BLOCK_HEADER_SIZE +
+                          i * ARCHIVE_COLUMN_HEADER_SIZE;
+    size_t length= column->values.length();
+    size_t compressed_length= length;
+    uchar flags= 0;
+
+#ifdef HAVE_ZSTD_COMPRESS
+    if (length)
+    {
+      size_t res= ZSTD_compress(data, ZSTD_compressBound(length),
+                                column->values.ptr(), length,
+                                ARCHIVE_ZSTD_LEVEL);
+      if (!ZSTD_isError(res) && res < length)
+      {
+        compressed_length= res;
+        flags|= ARCHIVE_COLUMN_ZSTD;
+      }
+    }
+#endif
+    /* Values which do not compress are stored as they are */
+    if (!(flags & ARCHIVE_COLUMN_ZSTD))
+      memcpy(data, column->values.ptr(), length);
+
+    if (!column->not_null)
+      flags|= ARCHIVE_COLUMN_NULL;
+    else if (column->stats)
+      flags|= ARCHIVE_COLUMN_STATS;
+
+    column_header[0]= flags;
+    int4store(column_header + 1, (uint32) compressed_length);
+    int4store(column_header + 5, (uint32) length);
+    int8store(column_header + 9, column->min);
+    int8store(column_header + 17, column->max);
+    data+= compressed_length;
+  }
+
+  if ((block_end= azwrite_block(writer, header, data - header)) ==
+      MY_FILEPOS_ERROR)
+    DBUG_RETURN(my_errno ? my_errno : HA_ERR_INTERNAL_ERROR);
+
+  writer->rows+= rows;
+  end= block_end;
+  reset();
+  DBUG_RETURN(0);
+}
+
+
 /*
   No locks are required because it is associated with just one handler instance
 */
@@ -559,6 +740,16 @@ int ha_archive::init_archive_reader()
       DBUG_RETURN(1);
     }
     archive_reader_open= TRUE;
+    /* The block in memory may come from the file before an optimize */
+    block_position= MY_FILEPOS_ERROR;
+    rewind_blocks();
+  }
+
+  if (archive.version == ARCHIVE_COLUMNAR_VERSION && !column_readers)
+  {
+    if (!(column_readers= new Archive_column_reader[table->s->fields]) ||
+        !(skip_record= (uchar*) my_malloc(table->s->reclength, MYF(MY_WME))))
+      DBUG_RETURN(1);
   }
 
   DBUG_RETURN(0);
@@ -651,6 +842,10 @@ int ha_archive::close(void)
   DBUG_ENTER("ha_archive::close");
 
   destroy_record_buffer(record_buffer);
+  delete [] column_readers;
+  column_readers= NULL;
+  my_free(skip_record);
+  skip_record= NULL;
 
   if (archive_reader_open)
   {
@@ -814,7 +1009,9 @@ int ha_archive::create(const char *name, TABLE *table_arg,
   if (!(mysql_file_stat(arch_key_file_data, name_buff, &file_stat, MYF(0))))
   {
     my_errno= 0;
-    if (!(azopen(&create_stream, name_buff, O_CREAT|O_RDWR|O_BINARY)))
+    if (!(archive_columnar ?
+          azopen_columnar(&create_stream, name_buff, O_CREAT|O_RDWR|O_BINARY) :
+          azopen(&create_stream, name_buff, O_CREAT|O_RDWR|O_BINARY)))
     {
       error= errno;
       goto error2;
@@ -860,22 +1057,33 @@ error:
 /*
   This is where the actual row is written out.
 */
-int ha_archive::real_write_row(uchar *buf, azio_stream *writer)
+int ha_archive::real_write_row(uchar *buf, azio_stream *writer,
+                               Archive_block *block)
 {
   my_off_t written;
   unsigned int r_pack_length;
+  int rc;
   DBUG_ENTER("ha_archive::real_write_row");
 
-  /* We pack the row for writing */
-  r_pack_length= pack_row(buf, writer);
-
-  written= azwrite(writer, record_buffer->buffer, r_pack_length);
-  if (written != r_pack_length)
+  if (writer->version == ARCHIVE_COLUMNAR_VERSION)
   {
-    DBUG_PRINT("ha_archive", ("Wrote %d bytes expected %d", 
-                                              (uint32) written, 
-                                              (uint32)r_pack_length));
-    DBUG_RETURN(-1);
+    if ((rc= pack_row_columnar(buf, block)) ||
+        (block->is_full() && (rc= block->write(writer))))
+      DBUG_RETURN(rc);
+  }
+  else
+  {
+    /* We pack the row for writing */
+    r_pack_length= pack_row(buf, writer);
+
+    written= azwrite(writer, record_buffer->buffer, r_pack_length);
+    if (written != r_pack_length)
+    {
+      DBUG_PRINT("ha_archive", ("Wrote %d bytes expected %d", 
+                                                (uint32) written, 
+                                                (uint32)r_pack_length));
+      DBUG_RETURN(-1);
+    }
   }
 
   if (!delayed_insert || !bulk_insert)
@@ -942,6 +1150,108 @@ unsigned int ha_archive::pack_row(uchar *record, azio_stream *writer)
 }
 
 
+/*
+  Whether the blocks of the columnar format keep the smallest and largest
+  values of a column. The values are compared as the comparison functions
+  compare the column with constants: integers, and DATE/DATETIME as packed
+  temporals (TIMESTAMP depends on the time zone).
+*/
+static bool archive_column_has_stats(const Field *field)
+{
+  switch (field->type())
+  {
+  case MYSQL_TYPE_TINY:
+  case MYSQL_TYPE_SHORT:
+  case MYSQL_TYPE_INT24:
+  case MYSQL_TYPE_LONG:
+  case MYSQL_TYPE_LONGLONG:
+  case MYSQL_TYPE_DATE:
+  case MYSQL_TYPE_NEWDATE:
+  case MYSQL_TYPE_DATETIME:
+    return true;
+  default:
+    return false;
+  }
+}
+
+
+static longlong archive_column_value(Field *field)
+{
+  return field->is_temporal() ? field->val_date_temporal() : field->val_int();
+}
+
+
+/* Compare two integers, either of which may be unsigned */
+static int archive_cmp(longlong a, bool a_unsigned,
+                       longlong b, bool b_unsigned)
+{
+  if (a_unsigned && b_unsigned)
+    return (ulonglong) a < (ulonglong) b ? -1 : (ulonglong) a > (ulonglong) b;
+  if (a_unsigned && a < 0)
+    return 1;
+  if (b_unsigned && b < 0)
+    return -1;
+  return a < b ? -1 : a > b;
+}
+
+
+/*
+  Append a row to the columns of the block a columnar writer buffers.
+*/
+int ha_archive::pack_row_columnar(uchar *record, Archive_block *block)
+{
+  my_ptrdiff_t diff= record - table->record[0];
+  DBUG_ENTER("ha_archive::pack_row_columnar");
+
+  if (block->init(table->s->fields))
+    DBUG_RETURN(HA_ERR_OUT_OF_MEM);
+
+  for (Field **field_ptr= table->field; *field_ptr; field_ptr++)
+  {
+    Field *field= *field_ptr;
+    Archive_column_buffer *column= &block->columns[field->field_index];
+    String *values= &column->values;
+    uint32 max_length= field->pack_length() + 3;
+    uchar *ptr;
+
+    field->move_field_offset(diff);
+    if (!field->is_null() && (field->flags & BLOB_FLAG))
+      max_length+= ((Field_blob*) field)->get_length();
+    if (values->reserve(max_length))
+    {
+      field->move_field_offset(-diff);
+      DBUG_RETURN(HA_ERR_OUT_OF_MEM);
+    }
+
+    ptr= (uchar*) values->ptr() + values->length();
+    if (field->maybe_null())
+      *ptr++= field->is_null();
+    if (!field->is_null())
+    {
+      ptr= field->pack(ptr, field->ptr);
+      if ((column->stats= archive_column_has_stats(field)))
+      {
+        bool is_unsigned= MY_TEST(field->flags & UNSIGNED_FLAG);
+        longlong value= archive_column_value(field);
+        if (!column->not_null ||
+            archive_cmp(value, is_unsigned, column->min, is_unsigned) < 0)
+          column->min= value;
+        if (!column->not_null ||
+            archive_cmp(value, is_unsigned, column->max, is_unsigned) > 0)
+          column->max= value;
+      }
+      column->not_null++;
+    }
+    block->length+= ptr - ((uchar*) values->ptr() + values->length());
+    values->length((uint32) (ptr - (uchar*) values->ptr()));
+    field->move_field_offset(-diff);
+  }
+  block->rows++;
+
+  DBUG_RETURN(0);
+}
+
+
 /* 
   Look at ha_archive::open() for an explanation of the row format.
   Here we just write out the row.
@@ -1047,7 +1357,7 @@ int ha_archive::write_row(uchar *buf)
     In case of a failed row write, we will never try to reuse the value.
   */
   share->rows_recorded++;
-  rc= real_write_row(buf,  &(share->archive_write));
+  rc= real_write_row(buf,  &(share->archive_write), &(share->write_block));
 error:
   mysql_mutex_unlock(&share->mutex);
   if (read_buf)
@@ -1108,6 +1418,10 @@ int ha_archive::index_read_idx(uchar *buf, uint index, const uchar *key,
   if (rc)
     goto error;
 
+  /* The columnar format only reads the columns of the read set */
+  if (archive.version == ARCHIVE_COLUMNAR_VERSION)
+    table->mark_columns_used_by_index_no_reset(index, table->read_set);
+
   while (!(get_row(&archive, buf)))
   {
     if (!memcmp(current_key, buf + current_k_offset, current_key_len))
@@ -1175,6 +1489,9 @@ int ha_archive::rnd_init(bool scan)
 
     if (read_data_header(&archive))
       DBUG_RETURN(HA_ERR_CRASHED_ON_USAGE);
+
+    if (archive.version == ARCHIVE_COLUMNAR_VERSION)
+      prepare_ranges();
   }
 
   DBUG_RETURN(0);
@@ -1192,7 +1509,9 @@ int ha_archive::get_row(azio_stream *file_to_read, uchar *buf)
   DBUG_PRINT("ha_archive", ("Picking version for get_row() %d -> %d", 
                             (uchar)file_to_read->version, 
                             ARCHIVE_VERSION));
-  if (file_to_read->version == ARCHIVE_VERSION)
+  if (file_to_read->version == ARCHIVE_COLUMNAR_VERSION)
+    rc= get_row_columnar(buf);
+  else if (file_to_read->version == ARCHIVE_VERSION)
     rc= get_row_version3(file_to_read, buf);
   else
     rc= get_row_version2(file_to_read, buf);
@@ -1377,6 +1696,290 @@ int ha_archive::get_row_version2(azio_stream *file_to_read, uchar *buf)
 }
 
 
+/*
+  Start the next read of the columnar format at its first block.
+*/
+void ha_archive::rewind_blocks()
+{
+  next_block_position= archive.start;
+  block_rows= block_row= 0;
+  n_ranges= 0;
+}
+
+
+/*
+  Make the block at position the one rows are read from, reading its
+  header unless it is already in memory.
+
+  RETURN
+    HA_ERR_END_OF_FILE  past the last block written
+*/
+int ha_archive::read_block_header(my_off_t position)
+{
+  uint fields= table->s->fields;
+  size_t header_length= ARCHIVE_BLOCK_HEADER_SIZE +
+                        fields * ARCHIVE_COLUMN_HEADER_SIZE;
+  my_off_t data_pos;
+  uchar *header;
+  DBUG_ENTER("ha_archive::read_block_header");
+
+  block_row= 0;
+  if (position == block_position)
+    DBUG_RETURN(0);
+
+  /*
+    A block may be in the middle of being written after the end known to
+    the share, which is only moved when the block is written.
+  */
+  if (position >= share->write_block.end)
+    DBUG_RETURN(HA_ERR_END_OF_FILE);
+
+  if (block_buffer.alloc((uint32) header_length))
+    DBUG_RETURN(HA_ERR_OUT_OF_MEM);
+  header= (uchar*) block_buffer.ptr();
+  block_position= MY_FILEPOS_ERROR;
+  if (azread_block(&archive, header, header_length, position) !=
+      header_length ||
+      uint4korr(header) != ARCHIVE_BLOCK_MAGIC ||
+      uint2korr(header + 8) != fields)
+    DBUG_RETURN(HA_ERR_CRASHED_ON_USAGE);
+
+  block_rows= uint4korr(header + 4);
+  if (!block_rows || block_rows > ARCHIVE_BLOCK_ROWS)
+    DBUG_RETURN(HA_ERR_CRASHED_ON_USAGE);
+
+  data_pos= position + header_length;
+  for (uint i= 0; i < fields; i++)
+  {
+    Archive_column_reader *column= &column_readers[i];
+    const uchar *column_header= header + ARCHIVE_BLOCK_HEADER_SIZE +
+                                i * ARCHIVE_COLUMN_HEADER_SIZE;
+    column->flags= column_header[0];
+    column->compressed_length= uint4korr(column_header + 1);
+    column->length= uint4korr(column_header + 5);
+    column->min= sint8korr(column_header + 9);
+    column->max= sint8korr(column_header + 17);
+    column->data_pos= data_pos;
+    column->loaded= false;
+    column->indexed= false;
+    data_pos+= column->compressed_length;
+  }
+  block_position= position;
+  next_block_position= data_pos;
+
+  DBUG_RETURN(0);
+}
+
+
+/*
+  Whether rows of the block read may satisfy the pushed condition, from the
+  smallest and largest values of the columns of its ranges.
+*/
+bool ha_archive::block_may_match()
+{
+  for (uint i= 0; i < n_ranges; i++)
+  {
+    archive_range *range= &ranges[i];
+    Archive_column_reader *column= &column_readers[range->field_index];
+    bool is_unsigned=
+      MY_TEST(table->field[range->field_index]->flags & UNSIGNED_FLAG);
+    int cmp;
+
+    /* No comparison with NULL is true */
+    if (column->flags & ARCHIVE_COLUMN_NULL)
+      return false;
+    if (!(column->flags & ARCHIVE_COLUMN_STATS))
+      continue;
+
+    if (range->has_min)
+    {
+      cmp= archive_cmp(column->max, is_unsigned,
+                       range->min, range->min_unsigned);
+      if (cmp < 0 || (cmp == 0 && !range->min_inclusive))
+        return false;
+    }
+    if (range->has_max)
+    {
+      cmp= archive_cmp(column->min, is_unsigned,
+                       range->max, range->max_unsigned);
+      if (cmp > 0 || (cmp == 0 && !range->max_inclusive))
+        return false;
+    }
+  }
+  return true;
+}
+
+
+/*
+  Read and decompress a column of the block read.
+*/
+int ha_archive::read_column(uint index)
+{
+  Archive_column_reader *column= &column_readers[index];
+  uchar *values;
+  DBUG_ENTER("ha_archive::read_column");
+
+  if (column->values.alloc(column->length))
+    DBUG_RETURN(HA_ERR_OUT_OF_MEM);
+  values= (uchar*) column->values.ptr();
+
+  if (column->flags & ARCHIVE_COLUMN_ZSTD)
+  {
+#ifdef HAVE_ZSTD_COMPRESS
+    size_t res;
+    if (block_buffer.alloc(column->compressed_length))
+      DBUG_RETURN(HA_ERR_OUT_OF_MEM);
+    if (azread_block(&archive, (uchar*) block_buffer.ptr(),
+                     column->compressed_length, column->data_pos) !=
+        column->compressed_length)
+      DBUG_RETURN(HA_ERR_CRASHED_ON_USAGE);
+    res= ZSTD_decompress(values, column->length, block_buffer.ptr(),
+                         column->compressed_length);
+    if (ZSTD_isError(res) || res != column->length)
+      DBUG_RETURN(HA_ERR_CRASHED_ON_USAGE);
+#else
+    DBUG_RETURN(HA_ERR_UNSUPPORTED);
+#endif
+  }
+  else if (column->compressed_length != column->length ||
+           azread_block(&archive, values, column->length,
+                        column->data_pos) != column->length)
+    DBUG_RETURN(HA_ERR_CRASHED_ON_USAGE);
+
+  column->values.length(column->length);
+  column->pos= values;
+  column->row= 0;
+  column->loaded= true;
+  column->indexed= false;
+  DBUG_RETURN(0);
+}
+
+
+/*
+  Skip the value of the next row of a column. Values are unpacked to find
+  their length.
+*/
+static inline const uchar *archive_skip_value(Field *field, uchar *record,
+                                              const uchar *pos)
+{
+  if (field->maybe_null() && *pos++)
+    return pos;
+  return field->unpack(record + field->offset(field->table->record[0]), pos);
+}
+
+
+/*
+  Find the value of each row of a loaded column, for rnd_pos().
+*/
+int ha_archive::index_column(uint index)
+{
+  Archive_column_reader *column= &column_readers[index];
+  Field *field= table->field[index];
+  const uchar *pos= (const uchar*) column->values.ptr();
+  DBUG_ENTER("ha_archive::index_column");
+
+  if (!column->offsets &&
+      !(column->offsets= (uint32*) my_malloc(sizeof(uint32) *
+                                             ARCHIVE_BLOCK_ROWS, MYF(MY_WME))))
+    DBUG_RETURN(HA_ERR_OUT_OF_MEM);
+
+  for (uint row= 0; row < block_rows; row++)
+  {
+    column->offsets[row]= (uint32) (pos - (const uchar*) column->values.ptr());
+    pos= archive_skip_value(field, skip_record, pos);
+  }
+  column->indexed= true;
+  DBUG_RETURN(0);
+}
+
+
+/*
+  Move the next value of a loaded column to the value of row.
+*/
+void ha_archive::position_column(uint index, uint row)
+{
+  Archive_column_reader *column= &column_readers[index];
+  Field *field= table->field[index];
+
+  if (column->indexed)
+  {
+    column->pos= (const uchar*) column->values.ptr() + column->offsets[row];
+    column->row= row;
+    return;
+  }
+  if (row < column->row)
+  {
+    column->pos= (const uchar*) column->values.ptr();
+    column->row= 0;
+  }
+  for (; column->row < row; column->row++)
+    column->pos= archive_skip_value(field, skip_record, column->pos);
+}
+
+
+/*
+  Read the next row of the columnar format, from the columns of the read
+  set. Blocks which cannot match the ranges of the pushed condition are
+  skipped.
+*/
+int ha_archive::get_row_columnar(uchar *buf)
+{
+  my_ptrdiff_t diff= buf - table->record[0];
+  int rc;
+  DBUG_ENTER("ha_archive::get_row_columnar");
+
+  while (block_row >= block_rows)
+  {
+    if ((rc= read_block_header(next_block_position)))
+      DBUG_RETURN(rc);
+    if (n_ranges && !block_may_match())
+    {
+      my_atomic_add64(&archive_blocks_skipped, 1);
+      block_row= block_rows;
+      continue;
+    }
+    my_atomic_add64(&archive_blocks_read, 1);
+  }
+
+  /* See unpack_row() */
+  memset(buf, 0, table->s->reclength);
+  memcpy(buf, table->s->default_values, table->s->null_bytes);
+
+  for (Field **field_ptr= table->field; *field_ptr; field_ptr++)
+  {
+    Field *field= *field_ptr;
+    uint index= field->field_index;
+    Archive_column_reader *column= &column_readers[index];
+
+    if (!bitmap_is_set(table->read_set, index))
+      continue;
+    if (!column->loaded && (rc= read_column(index)))
+      DBUG_RETURN(rc);
+    if (column->row != block_row)
+    {
+      if (!column->indexed && block_row < column->row &&
+          (rc= index_column(index)))
+        DBUG_RETURN(rc);
+      position_column(index, block_row);
+    }
+
+    if (field->maybe_null() && *column->pos++)
+      field->set_null(diff);
+    else
+    {
+      if (field->maybe_null())
+        field->set_notnull(diff);
+      column->pos= field->unpack(buf + field->offset(table->record[0]),
+                                 column->pos);
+    }
+    column->row++;
+  }
+  block_row++;
+
+  DBUG_RETURN(0);
+}
+
+
 /* 
   Called during ORDER BY. Its position is either from being called sequentially
   or by having had ha_archive::rnd_pos() called before it is called.
@@ -1400,8 +2003,16 @@ int ha_archive::rnd_next(uchar *buf)
   scan_rows--;
 
   ha_statistic_increment(&SSV::ha_read_rnd_next_count);
-  current_position= aztell(&archive);
-  rc= get_row(&archive, buf);
+  if (archive.version == ARCHIVE_COLUMNAR_VERSION)
+  {
+    rc= get_row(&archive, buf);
+    current_position= (block_position << ARCHIVE_ROW_BITS) | (block_row - 1);
+  }
+  else
+  {
+    current_position= aztell(&archive);
+    rc= get_row(&archive, buf);
+  }
 
   table->status=rc ? STATUS_NOT_FOUND: 0;
 
@@ -1440,7 +2051,19 @@ int ha_archive::rnd_pos(uchar * buf, uchar *pos)
                        table_share->table_name.str, FALSE);
   ha_statistic_increment(&SSV::ha_read_rnd_next_count);
   current_position= (my_off_t)my_get_ptr(pos, ref_length);
-  if (azseek(&archive, current_position, SEEK_SET) == (my_off_t)(-1L))
+  if (archive.version == ARCHIVE_COLUMNAR_VERSION)
+  {
+    uint row= (uint) (current_position & ((1 << ARCHIVE_ROW_BITS) - 1));
+    if ((rc= read_block_header(current_position >> ARCHIVE_ROW_BITS)))
+      goto end;
+    if (row >= block_rows)
+    {
+      rc= HA_ERR_CRASHED_ON_USAGE;
+      goto end;
+    }
+    block_row= row;
+  }
+  else if (azseek(&archive, current_position, SEEK_SET) == (my_off_t)(-1L))
   {
     rc= HA_ERR_CRASHED_ON_USAGE;
     goto end;
@@ -1476,6 +2099,7 @@ int ha_archive::optimize(THD* thd, HA_CHECK_OPT* check_opt)
 {
   int rc= 0;
   azio_stream writer;
+  Archive_block block;
   ha_rows count;
   my_bitmap_map *org_bitmap;
   char writer_filename[FN_REFLEN];
@@ -1491,7 +2115,7 @@ int ha_archive::optimize(THD* thd, HA_CHECK_OPT* check_opt)
   /* remember the number of rows */
   count= share->rows_recorded;
   if (share->archive_write_open)
-    azflush(&share->archive_write, Z_SYNC_FLUSH);
+    (void) share->flush_archive_writer();
   mysql_mutex_unlock(&share->mutex);
 
   init_archive_reader();
@@ -1500,7 +2124,10 @@ int ha_archive::optimize(THD* thd, HA_CHECK_OPT* check_opt)
   fn_format(writer_filename, share->table_name, "", ARN, 
             MY_REPLACE_EXT | MY_UNPACK_FILENAME);
 
-  if (!(azopen(&writer, writer_filename, O_CREAT|O_RDWR|O_BINARY)))
+  /* The table is rebuilt in the format archive_columnar asks for */
+  if (!(archive_columnar ?
+        azopen_columnar(&writer, writer_filename, O_CREAT|O_RDWR|O_BINARY) :
+        azopen(&writer, writer_filename, O_CREAT|O_RDWR|O_BINARY)))
   {
     share->in_optimize= false;
     DBUG_RETURN(HA_ERR_CRASHED_ON_USAGE);
@@ -1542,7 +2169,7 @@ int ha_archive::optimize(THD* thd, HA_CHECK_OPT* check_opt)
   {
     if ((rc= get_row(&archive, table->record[0])))
       break;
-    real_write_row(table->record[0], &writer);
+    real_write_row(table->record[0], &writer, &block);
     if (table->found_next_number_field)
       save_auto_increment(table, &stats.auto_increment_value);
   }
@@ -1557,13 +2184,15 @@ int ha_archive::optimize(THD* thd, HA_CHECK_OPT* check_opt)
     {
       if ((rc= get_row(&archive, table->record[0])))
         break;
-      real_write_row(table->record[0], &writer);
+      real_write_row(table->record[0], &writer, &block);
       if (table->found_next_number_field)
         save_auto_increment(table, &stats.auto_increment_value);
     }
   }
 
   tmp_restore_column_map(table->read_set, org_bitmap);
+  if (block.rows && block.write(&writer) && !rc)
+    rc= HA_ERR_CRASHED_ON_USAGE;
   share->rows_recorded= (ha_rows) writer.rows;
   share->archive_write.auto_increment= stats.auto_increment_value - 1;
   DBUG_PRINT("info", ("recovered %llu archive rows", 
@@ -1593,6 +2222,7 @@ int ha_archive::optimize(THD* thd, HA_CHECK_OPT* check_opt)
 
   // make the file we just wrote be our data file
   rc= my_rename(writer_filename, share->data_file_name, MYF(0));
+  share->write_block.end= block.end;
   share->in_optimize= false;
   mysql_mutex_unlock(&share->mutex);
 
@@ -1679,7 +2309,7 @@ int ha_archive::info(uint flag)
   {
     DBUG_PRINT("ha_archive", ("archive flushing out rows for scan"));
     DBUG_ASSERT(share->archive_write_open);
-    azflush(&(share->archive_write), Z_SYNC_FLUSH);
+    (void) share->flush_archive_writer();
     share->dirty= FALSE;
   }
 
@@ -1812,6 +2442,202 @@ int ha_archive::truncate()
   DBUG_RETURN(HA_ERR_WRONG_COMMAND);
 }
 
+int ha_archive::reset()
+{
+  DBUG_ENTER("ha_archive::reset");
+  pushed_archive_cond= NULL;
+  n_ranges= 0;
+  DBUG_RETURN(0);
+}
+
+
+/*
+  The pushed condition only makes scans of the columnar format skip blocks,
+  the server still checks it for every row. Only the last condition pushed
+  is kept.
+*/
+const Item *ha_archive::cond_push(const Item *cond)
+{
+  DBUG_ENTER("ha_archive::cond_push");
+  pushed_archive_cond= cond;
+  DBUG_RETURN(cond);
+}
+
+
+void ha_archive::cond_pop()
+{
+  DBUG_ENTER("ha_archive::cond_pop");
+  pushed_archive_cond= NULL;
+  DBUG_VOID_RETURN;
+}
+
+
+/*
+  The column of a comparison, if it is one blocks keep the smallest and
+  largest values of.
+*/
+static Field *archive_range_field(TABLE *table, Item *item)
+{
+  Item *real_item= item->real_item();
+  Field *field;
+
+  if (real_item->type() != Item::FIELD_ITEM)
+    return NULL;
+  field= ((Item_field*) real_item)->field;
+  return field->table == table && archive_column_has_stats(field) ?
+         field : NULL;
+}
+
+
+/*
+  Evaluate the constant a column is compared with, as the comparison
+  functions do: integers with integer columns, and DATE/DATETIME values or
+  strings which are valid dates with temporal columns.
+
+  RETURN
+    false  blocks cannot be skipped by the comparison
+*/
+static bool archive_range_value(Field *field, Item *item,
+                                longlong *value, bool *value_unsigned)
+{
+  if (!item->const_item() || item->is_expensive())
+    return false;
+
+  *value_unsigned= false;
+  if (field->is_temporal())
+  {
+    if (item->is_temporal_with_date())
+      *value= item->val_date_temporal();
+    else if (!item->is_temporal() && item->result_type() == STRING_RESULT)
+    {
+      char buff[MAX_DATE_STRING_REP_LENGTH];
+      String tmp(buff, sizeof(buff), &my_charset_bin), *str;
+      MYSQL_TIME ltime;
+      MYSQL_TIME_STATUS status;
+
+      if (!(str= item->val_str(&tmp)) ||
+          str_to_datetime(str, &ltime, TIME_FUZZY_DATE | MODE_INVALID_DATES,
+                          &status) ||
+          status.warnings ||
+          (ltime.time_type != MYSQL_TIMESTAMP_DATETIME &&
+           ltime.time_type != MYSQL_TIMESTAMP_DATE))
+        return false;
+      *value= TIME_to_longlong_datetime_packed(&ltime);
+    }
+    else
+      return false;
+  }
+  else
+  {
+    if (item->result_type() != INT_RESULT || item->is_temporal())
+      return false;
+    *value= item->val_int();
+    *value_unsigned= item->unsigned_flag;
+  }
+  return !item->null_value;
+}
+
+
+/*
+  Collect the ranges of column values a pushed condition implies: the
+  comparisons of a column with a constant and the BETWEEN of its top level
+  AND. Other conditions do not skip blocks.
+*/
+void ha_archive::add_range(const Item *cond)
+{
+  Item_func *func;
+  Item **args;
+  archive_range *range= &ranges[n_ranges];
+  Item_func::Functype functype;
+  longlong value;
+  bool value_unsigned;
+  Field *field;
+
+  if (cond->type() == Item::COND_ITEM)
+  {
+    Item_cond *cond_item= (Item_cond*) cond;
+    Item *item;
+
+    if (cond_item->functype() != Item_func::COND_AND_FUNC)
+      return;
+    List_iterator_fast<Item> it(*cond_item->argument_list());
+    while ((item= it++))
+      add_range(item);
+    return;
+  }
+
+  if (cond->type() != Item::FUNC_ITEM || n_ranges == ARCHIVE_MAX_RANGES)
+    return;
+
+  func= (Item_func*) cond;
+  args= func->arguments();
+  functype= func->functype();
+  switch (functype)
+  {
+  case Item_func::BETWEEN:
+    if (((Item_func_opt_neg*) func)->negated ||
+        !(field= archive_range_field(table, args[0])) ||
+        !archive_range_value(field, args[1], &range->min,
+                             &range->min_unsigned) ||
+        !archive_range_value(field, args[2], &range->max,
+                             &range->max_unsigned))
+      return;
+    range->has_min= range->min_inclusive= true;
+    range->has_max= range->max_inclusive= true;
+    break;
+  case Item_func::EQ_FUNC:
+  case Item_func::LT_FUNC:
+  case Item_func::LE_FUNC:
+  case Item_func::GT_FUNC:
+  case Item_func::GE_FUNC:
+    if ((field= archive_range_field(table, args[0])) &&
+        archive_range_value(field, args[1], &value, &value_unsigned))
+      ;
+    else if ((field= archive_range_field(table, args[1])) &&
+             archive_range_value(field, args[0], &value, &value_unsigned))
+    {
+      /* The constant is first: a < b is b > a */
+      switch (functype)
+      {
+      case Item_func::LT_FUNC: functype= Item_func::GT_FUNC; break;
+      case Item_func::LE_FUNC: functype= Item_func::GE_FUNC; break;
+      case Item_func::GT_FUNC: functype= Item_func::LT_FUNC; break;
+      case Item_func::GE_FUNC: functype= Item_func::LE_FUNC; break;
+      default: break;
+      }
+    }
+    else
+      return;
+    range->has_min= functype == Item_func::EQ_FUNC ||
+                    functype == Item_func::GT_FUNC ||
+                    functype == Item_func::GE_FUNC;
+    range->min_inclusive= functype != Item_func::GT_FUNC;
+    range->has_max= functype == Item_func::EQ_FUNC ||
+                    functype == Item_func::LT_FUNC ||
+                    functype == Item_func::LE_FUNC;
+    range->max_inclusive= functype != Item_func::LT_FUNC;
+    range->min= range->max= value;
+    range->min_unsigned= range->max_unsigned= value_unsigned;
+    break;
+  default:
+    return;
+  }
+  range->field_index= field->field_index;
+  n_ranges++;
+}
+
+
+/*
+  Evaluate the ranges of the pushed condition for a new scan.
+*/
+void ha_archive::prepare_ranges()
+{
+  n_ranges= 0;
+  if (pushed_archive_cond)
+    add_range(pushed_archive_cond);
+}
+
+
 /*
   We just return state if asked.
 */
@@ -1853,6 +2679,7 @@ int ha_archive::check(THD* thd, HA_CHECK_OPT* check_opt)
   int rc= 0;
   const char *old_proc_info;
   ha_rows count;
+  my_bitmap_map *org_bitmap;
   DBUG_ENTER("ha_archive::check");
 
   old_proc_info= thd_proc_info(thd, "Checking table");
@@ -1860,7 +2687,7 @@ int ha_archive::check(THD* thd, HA_CHECK_OPT* check_opt)
   count= share->rows_recorded;
   /* Flush any waiting data */
   if (share->archive_write_open)
-    azflush(&(share->archive_write), Z_SYNC_FLUSH);
+    (void) share->flush_archive_writer();
   mysql_mutex_unlock(&share->mutex);
 
   if (init_archive_reader())
@@ -1870,6 +2697,8 @@ int ha_archive::check(THD* thd, HA_CHECK_OPT* check_opt)
     start of the file.
   */
   read_data_header(&archive);
+  /* The columnar format only reads the columns of the read set */
+  org_bitmap= tmp_use_all_columns(table, table->read_set);
   for (ha_rows cur_count= count; cur_count; cur_count--)
   {
     if ((rc= get_row(&archive, table->record[0])))
@@ -1883,7 +2712,7 @@ int ha_archive::check(THD* thd, HA_CHECK_OPT* check_opt)
   mysql_mutex_lock(&share->mutex);
   count= share->rows_recorded - count;
   if (share->archive_write_open)
-    azflush(&(share->archive_write), Z_SYNC_FLUSH);
+    (void) share->flush_archive_writer();
   while (!(rc= get_row(&archive, table->record[0])))
     count--;
   mysql_mutex_unlock(&share->mutex);
@@ -1891,10 +2720,12 @@ int ha_archive::check(THD* thd, HA_CHECK_OPT* check_opt)
   if ((rc && rc != HA_ERR_END_OF_FILE) || count)  
     goto error;
 
+  tmp_restore_column_map(table->read_set, org_bitmap);
   thd_proc_info(thd, old_proc_info);
   DBUG_RETURN(HA_ADMIN_OK);
 
 error:
+  tmp_restore_column_map(table->read_set, org_bitmap);
   thd_proc_info(thd, old_proc_info);
   share->crashed= FALSE;
   DBUG_RETURN(HA_ADMIN_CORRUPT);
@@ -1957,6 +2788,26 @@ bool ha_archive::check_if_incompatible_data(HA_CREATE_INFO *info,
 }
 
 
+static MYSQL_SYSVAR_BOOL(columnar, archive_columnar, PLUGIN_VAR_OPCMDARG,
+  "Create the data files of new tables, and the ones rebuilt by OPTIMIZE "
+  "TABLE, in the columnar format: blocks compressed column by column with "
+  "zstd, which keep the smallest and largest values of integer and date "
+  "columns for scans to skip blocks.",
+  NULL, NULL, FALSE);
+
+static struct st_mysql_sys_var *archive_system_variables[]=
+{
+  MYSQL_SYSVAR(columnar),
+  NULL
+};
+
+static struct st_mysql_show_var archive_status_variables[]=
+{
+  {"Archive_blocks_read", (char*) &archive_blocks_read, SHOW_LONGLONG},
+  {"Archive_blocks_skipped", (char*) &archive_blocks_skipped, SHOW_LONGLONG},
+  {0, 0, SHOW_UNDEF}
+};
+
 struct st_mysql_storage_engine archive_storage_engine=
 { MYSQL_HANDLERTON_INTERFACE_VERSION };
 
@@ -1971,8 +2822,8 @@ mysql_declare_plugin(archive)
   archive_db_init, /* Plugin Init */
   NULL, /* Plugin Deinit */
   0x0300 /* 3.0 */,
-  NULL,                       /* status variables                */
-  NULL,                       /* system variables                */
+  archive_status_variables,   /* status variables                */
+  archive_system_variables,   /* system variables                */
   NULL,                       /* config options                  */
   0,                          /* flags                           */
 }
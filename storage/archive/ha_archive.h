@@ -28,6 +28,84 @@ typedef struct st_archive_record_buffer {
 } archive_record_buffer;
 
 
+/*
+  Version for file format.
+  1 - Initial Version (Never Released)
+  2 - Stream Compression, seperate blobs, no packing
+  3 - One steam (row and blobs), with packing
+  4 - Blocks of columns (see ha_archive.cc), created with archive_columnar
+*/
+#define ARCHIVE_VERSION 3
+#define ARCHIVE_COLUMNAR_VERSION AZ_COLUMNAR_VERSION
+
+/* Most rows and bytes of values in a block of the columnar format */
+#define ARCHIVE_BLOCK_ROWS 4096
+#define ARCHIVE_BLOCK_SIZE (4 * 1024 * 1024)
+
+/* A column of the rows buffered for the next block */
+class Archive_column_buffer
+{
+public:
+  Archive_column_buffer() : min(0), max(0), not_null(0), stats(false) {}
+  String values;             /* Null flags and packed values */
+  longlong min;              /* Smallest and largest values, see */
+  longlong max;              /* archive_column_has_stats() */
+  uint not_null;             /* Values which are not NULL */
+  bool stats;                /* min and max are kept */
+};
+
+/* Rows of the columnar format buffered by a writer for its next block */
+class Archive_block
+{
+public:
+  Archive_block() : columns(NULL), fields(0), rows(0), length(0), end(0) {}
+  ~Archive_block() { delete [] columns; }
+  bool init(uint fields_arg);
+  void reset();
+  int write(azio_stream *writer);
+  bool is_full() const
+  {
+    return rows >= ARCHIVE_BLOCK_ROWS || length >= ARCHIVE_BLOCK_SIZE;
+  }
+
+  Archive_column_buffer *columns;
+  uint fields;
+  uint rows;
+  size_t length;             /* Bytes of values of all columns */
+  my_off_t end;              /* End of the blocks written */
+  String out;                /* Block being written */
+};
+
+/* A column of the block being read by a scan of the columnar format */
+class Archive_column_reader
+{
+public:
+  Archive_column_reader() : offsets(NULL) {}
+  ~Archive_column_reader() { my_free(offsets); }
+  my_off_t data_pos;         /* Position of the column in the file */
+  uint32 compressed_length;
+  uint32 length;
+  uchar flags;
+  longlong min, max;
+  bool loaded;               /* values holds the column */
+  uint row;                  /* Row of the value at pos */
+  bool indexed;              /* offsets are set */
+  String values;
+  const uchar *pos;          /* Value of the next row to read */
+  uint32 *offsets;           /* Value of each row, for rnd_pos() */
+};
+
+/* Values a column may have to satisfy a pushed condition */
+typedef struct st_archive_range {
+  uint field_index;
+  bool has_min, min_inclusive, min_unsigned;
+  bool has_max, max_inclusive, max_unsigned;
+  longlong min, max;
+} archive_range;
+
+#define ARCHIVE_MAX_RANGES 16
+
+
 class Archive_share : public Handler_share
 {
 public:
@@ -41,6 +119,7 @@ public:
   bool archive_write_open;
   bool dirty;               /* Flag for if a flush should occur */
   bool crashed;             /* Meta file is crashed */
+  Archive_block write_block; /* Rows buffered by archive_write, columnar */
   Archive_share();
   ~Archive_share()
   {
@@ -57,18 +136,11 @@ public:
   }
   int init_archive_writer();
   void close_archive_writer();
+  int flush_archive_writer();
   int write_v1_metafile();
   int read_v1_metafile();
 };
 
-/*
-  Version for file format.
-  1 - Initial Version (Never Released)
-  2 - Stream Compression, seperate blobs, no packing
-  3 - One steam (row and blobs), with packing
-*/
-#define ARCHIVE_VERSION 3
-
 class ha_archive: public handler
 {
   THR_LOCK_DATA lock;        /* MySQL lock */
@@ -87,11 +159,33 @@ class ha_archive: public handler
   archive_record_buffer *record_buffer;
   bool archive_reader_open;
 
+  /* Scans of the columnar format */
+  my_off_t block_position;   /* Block being read */
+  my_off_t next_block_position;
+  uint block_rows;
+  uint block_row;            /* Row of the block read next */
+  Archive_column_reader *column_readers;
+  String block_buffer;       /* Block header, compressed columns */
+  uchar *skip_record;        /* Values skipped are unpacked here */
+  const Item *pushed_archive_cond;
+  archive_range ranges[ARCHIVE_MAX_RANGES];
+  uint n_ranges;             /* Ranges blocks are skipped by */
+
   archive_record_buffer *create_record_buffer(unsigned int length);
   void destroy_record_buffer(archive_record_buffer *r);
   int frm_copy(azio_stream *src, azio_stream *dst);
   void frm_load(const char *name, azio_stream *dst);
   unsigned int pack_row_v1(uchar *record);
+  int pack_row_columnar(uchar *record, Archive_block *block);
+  void rewind_blocks();
+  int read_block_header(my_off_t position);
+  bool block_may_match();
+  int read_column(uint index);
+  int index_column(uint index);
+  void position_column(uint index, uint row);
+  int get_row_columnar(uchar *buf);
+  void add_range(const Item *cond);
+  void prepare_ranges();
 
 public:
   ha_archive(handlerton *hton, TABLE_SHARE *table_arg);
@@ -130,8 +224,11 @@ public:
   int open(const char *name, int mode, uint test_if_locked);
   int close(void);
   int write_row(uchar * buf);
-  int real_write_row(uchar *buf, azio_stream *writer);
+  int real_write_row(uchar *buf, azio_stream *writer, Archive_block *block);
   int truncate();
+  int reset();
+  const Item *cond_push(const Item *cond);
+  void cond_pop();
   int rnd_init(bool scan=1);
   int rnd_next(uchar *buf);
   int rnd_pos(uchar * buf, uchar *pos);
@@ -80,6 +80,8 @@ extern "C" my_bool tina_check_status(void* param);
 /* Stuff for shares */
 mysql_mutex_t tina_mutex;
 static HASH tina_open_tables;
+static my_bool tina_use_mmap= TRUE;
+static uint tina_scan_threads= 1;
 static handler *tina_create_handler(handlerton *hton,
                                     TABLE_SHARE *table, 
                                     MEM_ROOT *mem_root);
@@ -138,6 +140,8 @@ static void init_tina_psi_keys(void)
 
   count= array_elements(all_tina_files);
   mysql_file_register(category, all_tina_files, count);
+
+  init_tina_scan_psi_keys();
 }
 #endif /* HAVE_PSI_INTERFACE */
 
@@ -447,31 +451,71 @@ static int free_share(TINA_SHARE *share)
 my_off_t find_eoln_buff(Transparent_file *data_buff, my_off_t begin,
                      my_off_t end, int *eoln_len)
 {
+  const uchar *data;
+
+  if ((data= data_buff->mapped(end)))
+    return tina_find_eoln(data, begin, end, eoln_len);
+
   *eoln_len= 0;
 
-  for (my_off_t x= begin; x < end; x++)
+  /* Search the window, and read the next one until the end is reached */
+  for (my_off_t x= begin; x < end; )
   {
+    (void) data_buff->get_value(x);
+    if (x < data_buff->start() || x >= data_buff->end())
+      break;
+
+    const uchar *from= data_buff->ptr() + (x - data_buff->start());
+    const uchar *to= from + (min(end, data_buff->end()) - x);
+    const uchar *eoln= tina_find_byte(from, to, '\n', '\r');
+
+    x+= eoln - from;
+    if (eoln == to)
+      continue;
+
     /* Unix (includes Mac OS X) */
-    if (data_buff->get_value(x) == '\n')
+    if (*eoln == '\n')
       *eoln_len= 1;
-    else
-      if (data_buff->get_value(x) == '\r') // Mac or Dos
-      {
-        /* old Mac line ending */
-        if (x + 1 == end || (data_buff->get_value(x + 1) != '\n'))
-          *eoln_len= 1;
-        else // DOS style ending
-          *eoln_len= 2;
-      }
-
-    if (*eoln_len)  // end of line was found
-      return x;
+    else // Mac or Dos
+    {
+      /* old Mac line ending */
+      if (x + 1 == end || (data_buff->get_value(x + 1) != '\n'))
+        *eoln_len= 1;
+      else // DOS style ending
+        *eoln_len= 2;
+    }
+    return x;
   }
 
   return 0;
 }
 
 
+/*
+  Copies the bytes [begin, end) of the data file out of the window of
+  data_buff.
+*/
+
+static bool read_buff(Transparent_file *data_buff, my_off_t begin,
+                      my_off_t end, String *to)
+{
+  to->length(0);
+  while (begin < end)
+  {
+    (void) data_buff->get_value(begin);
+    if (begin < data_buff->start() || begin >= data_buff->end())
+      return TRUE;
+
+    my_off_t length= min(end, data_buff->end()) - begin;
+    if (to->append((const char*) data_buff->ptr() +
+                   (begin - data_buff->start()), (uint32) length))
+      return TRUE;
+    begin+= length;
+  }
+  return FALSE;
+}
+
+
 static handler *tina_create_handler(handlerton *hton,
                                     TABLE_SHARE *table, 
                                     MEM_ROOT *mem_root)
@@ -487,7 +531,8 @@ ha_tina::ha_tina(handlerton *hton, TABLE_SHARE *table_arg)
     They are not probably completely right.
   */
   current_position(0), next_position(0), local_saved_data_file_length(0),
-  file_buff(0), chain_alloced(0), chain_size(DEFAULT_CHAIN_LENGTH),
+  file_buff(0), row_fields(0), parallel_scan(0),
+  chain_alloced(0), chain_size(DEFAULT_CHAIN_LENGTH),
   local_data_file_version(0), records_is_known(0)
 {
   /* Set our original buffers from pre-allocated memory */
@@ -630,23 +675,53 @@ int ha_tina::chain_append()
 */
 int ha_tina::find_current_row(uchar *buf)
 {
-  my_off_t end_offset, curr_offset= current_position;
+  my_off_t end_offset;
   int eoln_len;
   my_bitmap_map *org_bitmap;
   int error;
-  bool read_all;
+  bool read_all, damaged;
+  const uchar *row;
+  const tina_field *span;
+  const tina_row *split_row;
   DBUG_ENTER("ha_tina::find_current_row");
 
   free_root(&blobroot, MYF(0));
 
+  if (parallel_scan && parallel_scan->running() &&
+      (split_row= parallel_scan->find_row(current_position, &span)))
+  {
+    /* The scan threads have split the row already */
+    end_offset= split_row->eoln;
+    eoln_len= split_row->eoln_len;
+    damaged= split_row->error;
+  }
   /*
     We do not read further then local_saved_data_file_length in order
     not to conflict with undergoing concurrent insert.
   */
-  if ((end_offset=
-        find_eoln_buff(file_buff, current_position,
-                       local_saved_data_file_length, &eoln_len)) == 0)
+  else if ((end_offset=
+             find_eoln_buff(file_buff, current_position,
+                            local_saved_data_file_length, &eoln_len)) == 0)
     DBUG_RETURN(HA_ERR_END_OF_FILE);
+  else
+    split_row= NULL;
+
+  /* Read the row in place when the file is mapped, copy it otherwise */
+  if ((row= file_buff->mapped(end_offset)))
+    row+= current_position;
+  else
+  {
+    if (read_buff(file_buff, current_position, end_offset, &row_buffer))
+      DBUG_RETURN(HA_ERR_CRASHED_ON_USAGE);
+    row= (const uchar*) row_buffer.ptr();
+  }
+
+  if (!split_row)
+  {
+    damaged= tina_split_row(row, (size_t) (end_offset - current_position),
+                            table->s->fields, row_fields);
+    span= row_fields;
+  }
 
   /* We must read all columns in case a table is opened for update */
   read_all= !bitmap_is_clear_all(table->write_set);
@@ -656,131 +731,28 @@ int ha_tina::find_current_row(uchar *buf)
 
   memset(buf, 0, table->s->null_bytes);
 
-  /*
-    Parse the line obtained using the following algorithm
-   
-    BEGIN
-      1) Store the EOL (end of line) for the current row
-      2) Until all the fields in the current query have not been 
-         filled
-         2.1) If the current character is a quote
-              2.1.1) Until EOL has not been reached
-                     a) If end of current field is reached, move
-                        to next field and jump to step 2.3
-                     b) If current character is a \\ handle
-                        \\n, \\r, \\, \\"
-                     c) else append the current character into the buffer
-                        before checking that EOL has not been reached.
-          2.2) If the current character does not begin with a quote
-               2.2.1) Until EOL has not been reached
-                      a) If the end of field has been reached move to the
-                         next field and jump to step 2.3
-                      b) If current character begins with \\ handle
-                        \\n, \\r, \\, \\"
-                      c) else append the current character into the buffer
-                         before checking that EOL has not been reached.
-          2.3) Store the current field value and jump to 2)
-    TERMINATE
-  */  
+  if (damaged)
+    goto err;
 
-  for (Field **field=table->field ; *field ; field++)
+  /*
+    Store the fields found by tina_split_row(). Fields without escape
+    sequences are stored from the row itself, the others are decoded
+    into buffer first.
+  */
+  for (Field **field=table->field ; *field ; field++, span++)
   {
-    char curr_char;
-    
-    buffer.length(0);
-    if (curr_offset >= end_offset)
-      goto err;
-    curr_char= file_buff->get_value(curr_offset);
-    /* Handle the case where the first character is a quote */
-    if (curr_char == '"')
+    if (read_all || bitmap_is_set(table->read_set, (*field)->field_index))
     {
-      /* Increment past the first quote */
-      curr_offset++;
+      bool is_enum= ((*field)->real_type() ==  MYSQL_TYPE_ENUM);
+      const char *value= (const char*) row + span->begin;
+      size_t value_length= span->end - span->begin;
 
-      /* Loop through the row to extract the values for the current field */
-      for ( ; curr_offset < end_offset; curr_offset++)
+      if (span->escaped)
       {
-        curr_char= file_buff->get_value(curr_offset);
-        /* check for end of the current field */
-        if (curr_char == '"' &&
-            (curr_offset == end_offset - 1 ||
-             file_buff->get_value(curr_offset + 1) == ','))
-        {
-          /* Move past the , and the " */
-          curr_offset+= 2;
-          break;
-        }
-        if (curr_char == '\\' && curr_offset != (end_offset - 1))
-        {
-          curr_offset++;
-          curr_char= file_buff->get_value(curr_offset);
-          if (curr_char == 'r')
-            buffer.append('\r');
-          else if (curr_char == 'n' )
-            buffer.append('\n');
-          else if (curr_char == '\\' || curr_char == '"')
-            buffer.append(curr_char);
-          else  /* This could only happed with an externally created file */
-          {
-            buffer.append('\\');
-            buffer.append(curr_char);
-          }
-        }
-        else // ordinary symbol
-        {
-          /*
-            If we are at final symbol and no last quote was found =>
-            we are working with a damaged file.
-          */
-          if (curr_offset == end_offset - 1)
-            goto err;
-          buffer.append(curr_char);
-        }
-      }
-    }
-    else 
-    {
-      for ( ; curr_offset < end_offset; curr_offset++)
-      {
-        curr_char= file_buff->get_value(curr_offset);
-        /* Move past the ,*/
-        if (curr_char == ',')
-        {
-          curr_offset++;
-          break;
-        }
-        if (curr_char == '\\' && curr_offset != (end_offset - 1))
-        {
-          curr_offset++;
-          curr_char= file_buff->get_value(curr_offset);
-          if (curr_char == 'r')
-            buffer.append('\r');
-          else if (curr_char == 'n' )
-            buffer.append('\n');
-          else if (curr_char == '\\' || curr_char == '"')
-            buffer.append(curr_char);
-          else  /* This could only happed with an externally created file */
-          {
-            buffer.append('\\');
-            buffer.append(curr_char);
-          }
-        }
-        else
-        {
-          /*
-             We are at the final symbol and a quote was found for the
-             unquoted field => We are working with a damaged field.
-          */
-          if (curr_offset == end_offset - 1 && curr_char == '"')
-            goto err;
-          buffer.append(curr_char);
-        }
+        tina_unescape(row + span->begin, value_length, &buffer);
+        value= buffer.ptr();
+        value_length= buffer.length();
       }
-    }
-
-    if (read_all || bitmap_is_set(table->read_set, (*field)->field_index))
-    {
-      bool is_enum= ((*field)->real_type() ==  MYSQL_TYPE_ENUM);
       /*
         Here CHECK_FIELD_WARN checks that all values in the csv file are valid
         which is normally the case, if they were written  by
@@ -789,7 +761,7 @@ int ha_tina::find_current_row(uchar *buf)
         Thus, for enums we silence the warning, as it doesn't really mean
         an invalid value.
       */
-      if ((*field)->store(buffer.ptr(), buffer.length(), buffer.charset(),
+      if ((*field)->store(value, value_length, buffer.charset(),
                           is_enum ? CHECK_FIELD_IGNORE : CHECK_FIELD_WARN))
       {
         if (!is_enum)
@@ -944,6 +916,15 @@ int ha_tina::open(const char *name, int mode, uint open_options)
     DBUG_RETURN(my_errno ? my_errno : -1);
   }
 
+  if (!(row_fields= (tina_field*) my_malloc(table->s->fields *
+                                            sizeof(tina_field),
+                                            MYF(MY_WME))))
+  {
+    mysql_file_close(data_file, MYF(0));
+    free_share(share);
+    DBUG_RETURN(HA_ERR_OUT_OF_MEM);
+  }
+
   /*
     Init locking. Pass handler object to the locking routines,
     so that they could save/update local_saved_data_file_length value
@@ -968,6 +949,8 @@ int ha_tina::close(void)
 {
   int rc= 0;
   DBUG_ENTER("ha_tina::close");
+  my_free(row_fields);
+  row_fields= NULL;
   rc= mysql_file_close(data_file, MYF(0));
   DBUG_RETURN(free_share(share) || rc);
 }
@@ -1116,8 +1099,9 @@ int ha_tina::delete_row(const uchar * buf)
   @details Compare the local version of the data file with the shared one.
   If they differ, there are some changes behind and we have to reopen
   the data file to make the changes visible.
-  Call @c file_buff->init_buff() at the end to read the beginning of the 
-  data file into buffer.
+  Call @c file_buff->init_mmap() at the end to map the data file, or
+  @c file_buff->init_buff() to read its beginning into buffer when
+  csv_use_mmap is off or the file cannot be mapped.
   
   @retval  0  OK.
   @retval  1  There was an error.
@@ -1134,11 +1118,38 @@ int ha_tina::init_data_file()
                                     MYF(MY_WME))) == -1)
       return my_errno ? my_errno : -1;
   }
-  file_buff->init_buff(data_file);
+  if (!tina_use_mmap || file_buff->init_mmap(data_file))
+    file_buff->init_buff(data_file);
   return 0;
 }
 
 
+/*
+  Starts the threads splitting the rows ahead of a table scan, when
+  csv_scan_threads is above 1 and the data file is mapped and holds
+  several blocks. The rows are stored in the scanning thread.
+*/
+
+void ha_tina::start_parallel_scan()
+{
+  const uchar *data;
+  ulonglong blocks;
+
+  if (tina_scan_threads < 2 ||
+      local_saved_data_file_length < 2 * TINA_SCAN_BLOCK_SIZE ||
+      !(data= file_buff->mapped(local_saved_data_file_length)))
+    return;
+
+  if (!parallel_scan)
+    parallel_scan= new Tina_parallel_scan();
+  blocks= (local_saved_data_file_length + TINA_SCAN_BLOCK_SIZE - 1) /
+          TINA_SCAN_BLOCK_SIZE;
+  (void) parallel_scan->start(data, local_saved_data_file_length,
+                              table->s->fields,
+                              (uint) min<ulonglong>(tina_scan_threads, blocks));
+}
+
+
 /*
   All table scans call this first.
   The order of a table scan is:
@@ -1174,6 +1185,9 @@ int ha_tina::rnd_init(bool scan)
 {
   DBUG_ENTER("ha_tina::rnd_init");
 
+  if (parallel_scan)
+    parallel_scan->stop();
+
   /* set buffer to the beginning of the file */
   if (share->crashed || init_data_file())
     DBUG_RETURN(HA_ERR_CRASHED_ON_USAGE);
@@ -1183,6 +1197,9 @@ int ha_tina::rnd_init(bool scan)
   records_is_known= 0;
   chain_ptr= chain;
 
+  if (scan)
+    start_parallel_scan();
+
   DBUG_RETURN(0);
 }
 
@@ -1328,6 +1345,11 @@ int ha_tina::rnd_end()
   my_off_t file_buffer_start= 0;
   DBUG_ENTER("ha_tina::rnd_end");
 
+  if (parallel_scan)
+    parallel_scan->stop();
+  /* Do not keep the file mapped, so that it can be truncated or replaced */
+  file_buff->unmap();
+
   free_root(&blobroot, MYF(0));
   records_is_known= 1;
 
@@ -1720,6 +1742,7 @@ int ha_tina::check(THD* thd, HA_CHECK_OPT* check_opt)
   }
 
   free_root(&blobroot, MYF(0));
+  file_buff->unmap();
 
   my_free(buf);
   thd_proc_info(thd, old_proc_info);
@@ -1740,6 +1763,24 @@ bool ha_tina::check_if_incompatible_data(HA_CREATE_INFO *info,
   return COMPATIBLE_DATA_YES;
 }
 
+static MYSQL_SYSVAR_BOOL(use_mmap, tina_use_mmap, PLUGIN_VAR_OPCMDARG,
+  "Map the data files of CSV tables in memory for table scans, and read "
+  "the rows in place rather than through a read buffer.",
+  NULL, NULL, TRUE);
+
+static MYSQL_SYSVAR_UINT(scan_threads, tina_scan_threads, PLUGIN_VAR_RQCMDARG,
+  "Number of threads splitting the rows of the mapped data file of a CSV "
+  "table into fields ahead of a table scan, for files of at least 1MB. "
+  "1 splits the rows in the thread doing the scan.",
+  NULL, NULL, 1, 1, 64, 0);
+
+static struct st_mysql_sys_var *tina_system_variables[]=
+{
+  MYSQL_SYSVAR(use_mmap),
+  MYSQL_SYSVAR(scan_threads),
+  NULL
+};
+
 struct st_mysql_storage_engine csv_storage_engine=
 { MYSQL_HANDLERTON_INTERFACE_VERSION };
 
@@ -1755,7 +1796,7 @@ mysql_declare_plugin(csv)
   tina_done_func, /* Plugin Deinit */
   0x0100 /* 1.0 */,
   NULL,                       /* status variables                */
-  NULL,                       /* system variables                */
+  tina_system_variables,      /* system variables                */
   NULL,                       /* config options                  */
   0,                          /* flags                           */
 }
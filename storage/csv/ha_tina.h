@@ -17,6 +17,7 @@
 #include <sys/stat.h>
 #include <my_dir.h>
 #include "transparent_file.h"
+#include "tina_scan.h"
 
 #define DEFAULT_CHAIN_LENGTH 512
 /*
@@ -70,6 +71,9 @@ class ha_tina: public handler
   File data_file;                   /* File handler for readers */
   File update_temp_file;
   String buffer;
+  String row_buffer;                /* Row copied out of file_buff */
+  tina_field *row_fields;           /* Fields of the row being read */
+  Tina_parallel_scan *parallel_scan;
   /*
     The chain contains "holes" in the file, occured because of
     deletes/updates. It is used in rnd_end() to get rid of them
@@ -89,11 +93,14 @@ private:
   int open_update_temp_file_if_needed();
   int init_tina_writer();
   int init_data_file();
+  void start_parallel_scan();
 
 public:
   ha_tina(handlerton *hton, TABLE_SHARE *table_arg);
   ~ha_tina()
   {
+    delete parallel_scan;
+    my_free(row_fields);
     if (chain_alloced)
       my_free(chain);
     if (file_buff)
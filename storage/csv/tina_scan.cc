@@ -0,0 +1,474 @@
+/* Copyright (c) 2020, Facebook, Inc.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA */
+
+#include "sql_priv.h"
+#include "sql_string.h"
+#include "tina_scan.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#ifdef HAVE_PSI_INTERFACE
+
+static PSI_mutex_key csv_key_mutex_Tina_parallel_scan_mutex;
+
+static PSI_mutex_info all_tina_scan_mutexes[]=
+{
+  { &csv_key_mutex_Tina_parallel_scan_mutex, "Tina_parallel_scan::mutex", 0}
+};
+
+static PSI_cond_key csv_key_cond_Tina_parallel_scan_cond;
+
+static PSI_cond_info all_tina_scan_conds[]=
+{
+  { &csv_key_cond_Tina_parallel_scan_cond, "Tina_parallel_scan::cond", 0}
+};
+
+static PSI_thread_key csv_key_thread_scan;
+
+static PSI_thread_info all_tina_scan_threads[]=
+{
+  { &csv_key_thread_scan, "scan", 0}
+};
+
+void init_tina_scan_psi_keys()
+{
+  const char* category= "csv";
+  int count;
+
+  count= array_elements(all_tina_scan_mutexes);
+  mysql_mutex_register(category, all_tina_scan_mutexes, count);
+
+  count= array_elements(all_tina_scan_conds);
+  mysql_cond_register(category, all_tina_scan_conds, count);
+
+  count= array_elements(all_tina_scan_threads);
+  mysql_thread_register(category, all_tina_scan_threads, count);
+}
+#endif /* HAVE_PSI_INTERFACE */
+
+
+/*
+  Returns the first byte of [from, to) equal to a or b, or to if there is
+  none.
+*/
+
+const uchar *tina_find_byte(const uchar *from, const uchar *to,
+                            uchar a, uchar b)
+{
+#ifdef __SSE2__
+  const __m128i va= _mm_set1_epi8((char) a);
+  const __m128i vb= _mm_set1_epi8((char) b);
+
+  for (; to - from >= 16; from+= 16)
+  {
+    __m128i v= _mm_loadu_si128((const __m128i*) from);
+    int mask= _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(v, va),
+                                             _mm_cmpeq_epi8(v, vb)));
+    if (mask)
+      return from + __builtin_ctz(mask);
+  }
+#endif
+  for (; from < to; from++)
+    if (*from == a || *from == b)
+      return from;
+  return to;
+}
+
+
+/*
+  Finds the end of the line beginning at begin, as find_eoln_buff() does
+  for rows read through a Transparent_file.
+
+  RETURN
+    offset of the line ending, 0 if there is none
+*/
+
+my_off_t tina_find_eoln(const uchar *data, my_off_t begin, my_off_t end,
+                        int *eoln_len)
+{
+  const uchar *eoln= tina_find_byte(data + begin, data + end, '\n', '\r');
+  my_off_t offset= eoln - data;
+
+  *eoln_len= 0;
+  if (offset == end)
+    return 0;
+
+  /* '\n', '\r' or '\r''\n' */
+  if (*eoln == '\r' && offset + 1 < end && eoln[1] == '\n')
+    *eoln_len= 2;
+  else
+    *eoln_len= 1;
+  return offset;
+}
+
+
+/*
+  Splits a row, without its line ending, into fields.
+
+  A field is either quoted, and ends at a quote followed by a comma or by
+  the end of the row, or unquoted, and ends at a comma. In both, a \ that
+  is not the last byte of the row begins a two bytes escape sequence,
+  which tina_unescape() decodes.
+
+  RETURN
+    FALSE  OK
+    TRUE   The row has too few fields or a field is damaged
+*/
+
+bool tina_split_row(const uchar *row, size_t length, uint fields,
+                    tina_field *field)
+{
+  size_t offset= 0;
+
+  for (uint i= 0; i < fields; i++, field++)
+  {
+    const uchar *hit;
+
+    if (offset >= length)
+      return TRUE;
+    field->escaped= false;
+
+    if (row[offset] == '"')
+    {
+      field->begin= ++offset;
+      for (;;)
+      {
+        hit= tina_find_byte(row + offset, row + length, '"', '\\');
+        if (hit == row + length)
+        {
+          /* The row ends before the closing quote */
+          if (offset < length)
+            return TRUE;
+          field->end= length;
+          break;
+        }
+        offset= hit - row;
+        if (*hit == '"')
+        {
+          if (offset == length - 1 || hit[1] == ',')
+          {
+            /* Move past the " and the , */
+            field->end= offset;
+            offset+= 2;
+            break;
+          }
+          offset++;
+        }
+        else
+        {
+          if (offset == length - 1)
+            return TRUE;
+          field->escaped= true;
+          offset+= 2;
+        }
+      }
+    }
+    else
+    {
+      field->begin= offset;
+      for (;;)
+      {
+        hit= tina_find_byte(row + offset, row + length, ',', '\\');
+        if (hit == row + length)
+        {
+          /* A quote ending an unquoted field means a damaged row */
+          if (offset < length && row[length - 1] == '"')
+            return TRUE;
+          field->end= offset= length;
+          break;
+        }
+        offset= hit - row;
+        if (*hit == ',')
+        {
+          field->end= offset++;
+          break;
+        }
+        if (offset == length - 1)
+        {
+          /* A \ ending the row is kept */
+          field->end= offset= length;
+          break;
+        }
+        field->escaped= true;
+        offset+= 2;
+      }
+    }
+  }
+  return FALSE;
+}
+
+
+/*
+  Decodes the escape sequences of a field: \r, \n, \\ and \" are replaced
+  by the byte they stand for, others are kept as they are.
+*/
+
+void tina_unescape(const uchar *from, size_t length, String *to)
+{
+  const uchar *end= from + length;
+
+  to->length(0);
+  for (;;)
+  {
+    const uchar *hit= tina_find_byte(from, end, '\\', '\\');
+    if (end - hit < 2)
+    {
+      to->append((const char*) from, (uint32) (end - from));
+      break;
+    }
+    to->append((const char*) from, (uint32) (hit - from));
+    switch (hit[1]) {
+    case 'r':
+      to->append('\r');
+      break;
+    case 'n':
+      to->append('\n');
+      break;
+    case '\\':
+    case '"':
+      to->append((char) hit[1]);
+      break;
+    default:  /* This could only happen with an externally created file */
+      to->append('\\');
+      to->append((char) hit[1]);
+    }
+    from= hit + 2;
+  }
+}
+
+
+Tina_parallel_scan::Tina_parallel_scan()
+  :data(NULL), length(0), fields(0), blocks(0), next_block(0),
+  read_block(0), stopping(false), read_ready(false), read_row(0)
+{
+  mysql_mutex_init(csv_key_mutex_Tina_parallel_scan_mutex, &mutex,
+                   MY_MUTEX_INIT_FAST);
+  mysql_cond_init(csv_key_cond_Tina_parallel_scan_cond, &cond, NULL);
+}
+
+
+Tina_parallel_scan::~Tina_parallel_scan()
+{
+  stop();
+  mysql_cond_destroy(&cond);
+  mysql_mutex_destroy(&mutex);
+}
+
+
+/*
+  Starts the threads splitting the rows of a mapped data file.
+
+  SYNOPSIS
+    start()
+    data_arg      The mapped file
+    length_arg    Length of the file the scan reads
+    fields_arg    Number of fields of the rows
+    thread_count  Number of threads
+
+  RETURN
+    FALSE  OK
+    TRUE   No thread could be started
+*/
+
+bool Tina_parallel_scan::start(const uchar *data_arg, my_off_t length_arg,
+                               uint fields_arg, uint thread_count)
+{
+  DBUG_ENTER("Tina_parallel_scan::start");
+  DBUG_ASSERT(!running());
+
+  data= data_arg;
+  length= length_arg;
+  fields= fields_arg;
+  blocks= (length + TINA_SCAN_BLOCK_SIZE - 1) / TINA_SCAN_BLOCK_SIZE;
+  next_block= read_block= 0;
+  stopping= false;
+  read_ready= false;
+  read_row= 0;
+
+  /* Let the threads split up to two blocks each ahead of the scan */
+  window.resize(2 * thread_count);
+  for (size_t i= 0; i < window.size(); i++)
+    window[i].number= ~0ULL;
+
+  for (uint i= 0; i < thread_count; i++)
+  {
+    pthread_t thread;
+    if (mysql_thread_create(csv_key_thread_scan, &thread, NULL,
+                            worker, (void*) this))
+      break;
+    threads.push_back(thread);
+  }
+  DBUG_RETURN(threads.empty());
+}
+
+
+/*
+  Stops the threads, which may not have split all the blocks.
+*/
+
+void Tina_parallel_scan::stop()
+{
+  if (threads.empty())
+    return;
+
+  mysql_mutex_lock(&mutex);
+  stopping= true;
+  mysql_cond_broadcast(&cond);
+  mysql_mutex_unlock(&mutex);
+
+  for (size_t i= 0; i < threads.size(); i++)
+    pthread_join(threads[i], NULL);
+  threads.clear();
+}
+
+
+/*
+  Returns the offset of the first row beginning in a block. Blocks are cut
+  after the first line ending found from their nominal start, so that the
+  rows of consecutive blocks follow each other as a scan reads them.
+*/
+
+my_off_t Tina_parallel_scan::block_bound(ulonglong number)
+{
+  my_off_t offset= number * TINA_SCAN_BLOCK_SIZE;
+  const uchar *eoln;
+
+  if (offset == 0)
+    return 0;
+  if (offset >= length)
+    return length;
+
+  /* The byte before the block may end the last row of the previous one */
+  eoln= tina_find_byte(data + offset - 1, data + length, '\n', '\r');
+  offset= eoln - data;
+  if (offset == length)
+    return length;
+  if (*eoln == '\r' && offset + 1 < length && eoln[1] == '\n')
+    return offset + 2;
+  return offset + 1;
+}
+
+
+void Tina_parallel_scan::split_block(ulonglong number, block *to)
+{
+  my_off_t begin= block_bound(number);
+  my_off_t end= block_bound(number + 1);
+
+  to->rows.clear();
+  to->fields.clear();
+
+  while (begin < end)
+  {
+    tina_row row;
+
+    /*
+      The scan stops at a row without line ending (one being written) and
+      at an empty first row.
+    */
+    if (!(row.eoln= tina_find_eoln(data, begin, length, &row.eoln_len)))
+      break;
+    row.begin= begin;
+    row.fields= to->fields.size();
+    to->fields.resize(row.fields + fields);
+    row.error= tina_split_row(data + begin, (size_t) (row.eoln - begin),
+                              fields, &to->fields[row.fields]);
+    to->rows.push_back(row);
+    begin= row.eoln + row.eoln_len;
+  }
+}
+
+
+void *Tina_parallel_scan::worker(void *arg)
+{
+  Tina_parallel_scan *scan= (Tina_parallel_scan*) arg;
+
+  my_thread_init();
+
+  mysql_mutex_lock(&scan->mutex);
+  for (;;)
+  {
+    while (!scan->stopping && scan->next_block < scan->blocks &&
+           scan->next_block >= scan->read_block + scan->window.size())
+      mysql_cond_wait(&scan->cond, &scan->mutex);
+    if (scan->stopping || scan->next_block >= scan->blocks)
+      break;
+
+    ulonglong number= scan->next_block++;
+    block *to= &scan->window[number % scan->window.size()];
+    mysql_mutex_unlock(&scan->mutex);
+
+    scan->split_block(number, to);
+
+    mysql_mutex_lock(&scan->mutex);
+    to->number= number;
+    mysql_cond_broadcast(&scan->cond);
+  }
+  mysql_mutex_unlock(&scan->mutex);
+
+  my_thread_end();
+  pthread_exit(0);
+  return NULL;
+}
+
+
+/*
+  Returns the split row beginning at offset, waiting for its block, and
+  sets field to its fields. The scan reads rows in the order of the file,
+  so the blocks before the row are released.
+
+  RETURN
+    the row, NULL if no split row begins at offset
+*/
+
+const tina_row *Tina_parallel_scan::find_row(my_off_t offset,
+                                             const tina_field **field)
+{
+  while (read_block < blocks)
+  {
+    block *from= &window[read_block % window.size()];
+
+    if (!read_ready)
+    {
+      mysql_mutex_lock(&mutex);
+      while (from->number != read_block)
+        mysql_cond_wait(&cond, &mutex);
+      mysql_mutex_unlock(&mutex);
+      read_ready= true;
+    }
+
+    while (read_row < from->rows.size() &&
+           from->rows[read_row].begin < offset)
+      read_row++;
+    if (read_row < from->rows.size())
+    {
+      const tina_row *row= &from->rows[read_row];
+      if (row->begin != offset)
+        return NULL;
+      *field= &from->fields[row->fields];
+      return row;
+    }
+
+    /* Release the block to the threads */
+    mysql_mutex_lock(&mutex);
+    read_block++;
+    mysql_cond_broadcast(&cond);
+    mysql_mutex_unlock(&mutex);
+    read_ready= false;
+    read_row= 0;
+  }
+  return NULL;
+}
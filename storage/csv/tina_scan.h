@@ -0,0 +1,117 @@
+/* Copyright (c) 2020, Facebook, Inc.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA */
+
+/*
+  Splitting of the rows of CSV data files into fields.
+
+  The functions below work on rows in memory, either mapped from the data
+  file or copied out of the Transparent_file window. They search for line
+  endings, separators, quotes and escapes 16 bytes at a time when SSE2 is
+  available.
+
+  Tina_parallel_scan splits the rows of a mapped data file ahead of a table
+  scan: worker threads take blocks of the file cut at line endings, and
+  record the fields of their rows, which the scan then only has to store.
+*/
+
+#ifndef TINA_SCAN_INCLUDED
+#define TINA_SCAN_INCLUDED
+
+#include "my_global.h"
+#include "my_pthread.h"
+#include <mysql/psi/mysql_thread.h>
+
+#include <vector>
+
+class String;
+
+/* Size of the blocks of a data file that the scan threads take */
+#define TINA_SCAN_BLOCK_SIZE (512 * 1024)
+
+/* A field of a row, as offsets from the beginning of the row */
+struct tina_field
+{
+  size_t begin;
+  size_t end;
+  bool escaped;                         /* contains \ sequences */
+};
+
+/* A row split by a scan thread */
+struct tina_row
+{
+  my_off_t begin;                       /* offset of the row in the file */
+  my_off_t eoln;                        /* offset of its line ending */
+  int eoln_len;
+  bool error;                           /* the row is damaged */
+  size_t fields;                        /* index of its first field */
+};
+
+my_off_t tina_find_eoln(const uchar *data, my_off_t begin, my_off_t end,
+                        int *eoln_len);
+const uchar *tina_find_byte(const uchar *from, const uchar *to,
+                            uchar a, uchar b);
+bool tina_split_row(const uchar *row, size_t length, uint fields,
+                    tina_field *field);
+void tina_unescape(const uchar *from, size_t length, String *to);
+
+#ifdef HAVE_PSI_INTERFACE
+void init_tina_scan_psi_keys();
+#endif
+
+
+class Tina_parallel_scan
+{
+  struct block
+  {
+    ulonglong number;                   /* block the results are for */
+    std::vector<tina_row> rows;
+    std::vector<tina_field> fields;
+  };
+
+  const uchar *data;
+  my_off_t length;
+  uint fields;
+  ulonglong blocks;
+
+  std::vector<pthread_t> threads;
+  std::vector<block> window;
+
+  /* Protected by mutex */
+  mysql_mutex_t mutex;
+  mysql_cond_t cond;
+  ulonglong next_block;                 /* next block to split */
+  ulonglong read_block;                 /* block the scan reads */
+  bool stopping;
+
+  /* Used by the scan only */
+  bool read_ready;
+  size_t read_row;
+
+  my_off_t block_bound(ulonglong number);
+  void split_block(ulonglong number, block *to);
+  static void *worker(void *arg);
+
+public:
+  Tina_parallel_scan();
+  ~Tina_parallel_scan();
+
+  bool start(const uchar *data_arg, my_off_t length_arg, uint fields_arg,
+             uint thread_count);
+  void stop();
+  bool running() { return !threads.empty(); }
+  const tina_row *find_row(my_off_t offset, const tina_field **field);
+};
+
+#endif /* TINA_SCAN_INCLUDED */
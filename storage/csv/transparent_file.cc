@@ -18,18 +18,21 @@
 #include "transparent_file.h"
 #include "my_sys.h"          // MY_WME, MY_ALLOW_ZERO_PTR, MY_SEEK_SET
 
-Transparent_file::Transparent_file() : lower_bound(0), buff_size(IO_SIZE)
+Transparent_file::Transparent_file()
+  : lower_bound(0), buff_size(IO_SIZE), map(NULL), map_length(0)
 { 
   buff= (uchar *) my_malloc(buff_size*sizeof(uchar),  MYF(MY_WME)); 
 }
 
 Transparent_file::~Transparent_file()
 { 
+  unmap();
   my_free(buff);
 }
 
 void Transparent_file::init_buff(File filedes_arg)
 {
+  unmap();
   filedes= filedes_arg;
   /* read the beginning of the file */
   lower_bound= 0;
@@ -38,6 +41,61 @@ void Transparent_file::init_buff(File filedes_arg)
     upper_bound= mysql_file_read(filedes, buff, buff_size, MYF(0));
 }
 
+/*
+  Maps the whole file, for the reads that go through mapped(). The window
+  is emptied, get_value() refills it from the file as after init_buff().
+
+  RETURN
+    FALSE  OK
+    TRUE   The file is empty or could not be mapped
+*/
+
+bool Transparent_file::init_mmap(File filedes_arg)
+{
+  MY_STAT stat_info;
+  void *area;
+
+  unmap();
+  filedes= filedes_arg;
+  lower_bound= upper_bound= 0;
+
+  if (mysql_file_fstat(filedes, &stat_info, MYF(0)) ||
+      !stat_info.st_size ||
+      (ulonglong) stat_info.st_size != (size_t) stat_info.st_size)
+    return TRUE;
+
+  area= my_mmap(0, (size_t) stat_info.st_size, PROT_READ, MAP_SHARED,
+                filedes, 0);
+  if (area == MAP_FAILED)
+    return TRUE;
+#if defined(HAVE_MADVISE) && defined(MADV_SEQUENTIAL)
+  madvise(area, (size_t) stat_info.st_size, MADV_SEQUENTIAL);
+#endif
+  map= (uchar*) area;
+  map_length= stat_info.st_size;
+  return FALSE;
+}
+
+void Transparent_file::unmap()
+{
+  if (map)
+  {
+    my_munmap(map, (size_t) map_length);
+    map= NULL;
+    map_length= 0;
+  }
+}
+
+/*
+  Returns the mapped file if it covers [0, end), NULL otherwise: the file
+  was not mapped, or grew after it was.
+*/
+
+const uchar *Transparent_file::mapped(my_off_t end)
+{
+  return end <= map_length ? map : NULL;
+}
+
 uchar *Transparent_file::ptr()
 { 
   return buff; 
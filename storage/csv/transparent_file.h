@@ -27,6 +27,9 @@ class Transparent_file
   my_off_t lower_bound;
   my_off_t upper_bound;
   uint buff_size;
+  /* the whole file, when it is mapped */
+  uchar *map;
+  my_off_t map_length;
 
 public:
 
@@ -34,6 +37,9 @@ public:
   ~Transparent_file();
 
   void init_buff(File filedes_arg);
+  bool init_mmap(File filedes_arg);
+  void unmap();
+  const uchar *mapped(my_off_t end);
   uchar *ptr();
   my_off_t start();
   my_off_t end();
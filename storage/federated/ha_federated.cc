@@ -376,6 +376,7 @@
 #include "sql_servers.h"         // FOREIGN_SERVER, get_server_by_name
 #include "sql_class.h"           // SSV
 #include "sql_analyse.h"         // append_escaped
+#include "item_cmpfunc.h"        // Item_cond, Item_func_like
 #include <mysql/plugin.h>
 
 #include "ha_federated.h"
@@ -898,7 +899,7 @@ error:
 ha_federated::ha_federated(handlerton *hton,
                            TABLE_SHARE *table_arg)
   :handler(hton, table_arg),
-  mysql(0), stored_result(0)
+  mysql(0), stored_result(0), remote_cond(0), mrr_batched(FALSE)
 {
   trx_next= 0;
   memset(&bulk_insert, 0, sizeof(bulk_insert));
@@ -1489,6 +1490,336 @@ err:
   DBUG_RETURN(1);
 }
 
+/*
+  The column of a pushed condition, if it is one of the table.
+*/
+static Field *federated_cond_field(TABLE *table, Item *item)
+{
+  Item *real_item= item->real_item();
+  Field *field;
+
+  if (real_item->type() != Item::FIELD_ITEM)
+    return NULL;
+  field= ((Item_field*) real_item)->field;
+  return field->table == table && field->type() != MYSQL_TYPE_GEOMETRY ?
+         field : NULL;
+}
+
+
+/*
+  Append to a remote query a constant a column is compared with, as a
+  literal the remote server reads as the same value.
+
+  RETURN
+    0   ok
+    1   the constant cannot be sent to the remote server
+*/
+static bool federated_append_value(String *to, TABLE *table, Field *field,
+                                   Item *item)
+{
+  char buff[MAX_FIELD_WIDTH];
+  String tmp(buff, sizeof(buff), &my_charset_bin), *res;
+
+  if (!item->const_item() || item->is_expensive())
+    return 1;
+
+  if (item->is_temporal())
+  {
+    /* Dates and times as strings, which temporal columns convert back */
+    if (!field->is_temporal())
+      return 1;
+    res= item->val_str(&tmp);
+  }
+  else
+  {
+    switch (item->result_type()) {
+    case INT_RESULT:
+    {
+      longlong value= item->val_int();
+      char *end;
+
+      if (item->null_value)
+        return to->append(STRING_WITH_LEN("NULL"));
+      end= longlong10_to_str(value, buff, item->unsigned_flag ? 10 : -10);
+      return to->append(buff, (uint32) (end - buff));
+    }
+    case DECIMAL_RESULT:
+    {
+      my_decimal decimal_value, *value= item->val_decimal(&decimal_value);
+
+      if (item->null_value)
+        return to->append(STRING_WITH_LEN("NULL"));
+      return my_decimal2string(E_DEC_FATAL_ERROR, value, 0, 0, 0, &tmp) ||
+             to->append(tmp);
+    }
+    case STRING_RESULT:
+      /* The connection reads strings in the character set of the table */
+      if (!my_charset_same(item->collation.collation,
+                           table->s->table_charset))
+        return 1;
+      /*
+        The remote server compares a literal with the collation of the
+        column, not with another collation given by COLLATE
+      */
+      if (field->result_type() == STRING_RESULT &&
+          item->collation.collation != field->charset())
+        return 1;
+      res= item->val_str(&tmp);
+      break;
+    default:
+      /* Floating point values may not print back to the same value */
+      return 1;
+    }
+  }
+
+  if (!res || item->null_value)
+    return to->append(STRING_WITH_LEN("NULL"));
+  return to->append(value_quote_char) || append_escaped(to, res) ||
+         to->append(value_quote_char);
+}
+
+
+/*
+  The operator of a comparison, the column on the left.
+*/
+static const char *federated_cmp_operator(Item_func::Functype functype,
+                                          bool swap)
+{
+  switch (functype) {
+  case Item_func::EQ_FUNC:    return "=";
+  case Item_func::EQUAL_FUNC: return "<=>";
+  case Item_func::NE_FUNC:    return "<>";
+  case Item_func::LT_FUNC:    return swap ? ">" : "<";
+  case Item_func::LE_FUNC:    return swap ? ">=" : "<=";
+  case Item_func::GT_FUNC:    return swap ? "<" : ">";
+  case Item_func::GE_FUNC:    return swap ? "<=" : ">=";
+  default:                    return NULL;
+  }
+}
+
+
+/*
+  Append to a remote query the part of a pushed condition the remote server
+  can check: ANDs, ORs and NOTs of comparisons, BETWEEN, IN, LIKE and
+  IS [NOT] NULL of the columns of the table with constants. An AND leaves
+  out the conditions it cannot send, so the remote server may return rows
+  the condition rejects but returns all the rows it accepts; the server
+  still checks the whole condition.
+
+  SYNOPSIS
+    federated_append_cond()
+      to          remote query
+      table       table of the columns
+      cond        pushed condition
+      complete    set to false if a part of the condition was left out
+
+  RETURN
+    0   ok
+    1   no part of the condition can be sent, to is unchanged
+*/
+static bool federated_append_cond(String *to, TABLE *table, Item *cond,
+                                  bool *complete)
+{
+  uint32 start= to->length();
+  Item_func *func;
+  Item **args;
+  Field *field;
+
+  if (cond->type() == Item::COND_ITEM)
+  {
+    Item_cond *cond_item= (Item_cond*) cond;
+    bool is_and= cond_item->functype() == Item_func::COND_AND_FUNC;
+    uint appended= 0;
+    Item *item;
+
+    if (!is_and && cond_item->functype() != Item_func::COND_OR_FUNC)
+      return 1;
+    List_iterator_fast<Item> it(*cond_item->argument_list());
+    while ((item= it++))
+    {
+      uint32 length= to->length();
+      if ((appended && (is_and ? to->append(STRING_WITH_LEN(" AND ")) :
+                                 to->append(STRING_WITH_LEN(" OR ")))) ||
+          to->append('(') ||
+          federated_append_cond(to, table, item, complete) ||
+          to->append(')'))
+      {
+        to->length(length);
+        if (!is_and)
+          goto err;
+        *complete= false;
+        continue;
+      }
+      appended++;
+    }
+    if (!appended)
+      goto err;
+    return 0;
+  }
+
+  if (cond->type() != Item::FUNC_ITEM)
+    return 1;
+
+  func= (Item_func*) cond;
+  args= func->arguments();
+  switch (func->functype()) {
+  case Item_func::EQ_FUNC:
+  case Item_func::EQUAL_FUNC:
+  case Item_func::NE_FUNC:
+  case Item_func::LT_FUNC:
+  case Item_func::LE_FUNC:
+  case Item_func::GT_FUNC:
+  case Item_func::GE_FUNC:
+  {
+    /* The constant may come first: 1 < a is a > 1 */
+    bool swap= !(field= federated_cond_field(table, args[0]));
+    if ((swap && !(field= federated_cond_field(table, args[1]))) ||
+        append_ident(to, field->field_name, strlen(field->field_name),
+                     ident_quote_char) ||
+        to->append(' ') ||
+        to->append(federated_cmp_operator(func->functype(), swap)) ||
+        to->append(' ') ||
+        federated_append_value(to, table, field, args[swap ? 0 : 1]))
+      goto err;
+    break;
+  }
+  case Item_func::BETWEEN:
+    if (!(field= federated_cond_field(table, args[0])) ||
+        append_ident(to, field->field_name, strlen(field->field_name),
+                     ident_quote_char) ||
+        (((Item_func_opt_neg*) func)->negated &&
+         to->append(STRING_WITH_LEN(" NOT"))) ||
+        to->append(STRING_WITH_LEN(" BETWEEN ")) ||
+        federated_append_value(to, table, field, args[1]) ||
+        to->append(STRING_WITH_LEN(" AND ")) ||
+        federated_append_value(to, table, field, args[2]))
+      goto err;
+    break;
+  case Item_func::IN_FUNC:
+    if (!(field= federated_cond_field(table, args[0])) ||
+        append_ident(to, field->field_name, strlen(field->field_name),
+                     ident_quote_char) ||
+        (((Item_func_opt_neg*) func)->negated &&
+         to->append(STRING_WITH_LEN(" NOT"))) ||
+        to->append(STRING_WITH_LEN(" IN (")))
+      goto err;
+    for (uint i= 1; i < func->argument_count(); i++)
+    {
+      if ((i > 1 && to->append(STRING_WITH_LEN(", "))) ||
+          federated_append_value(to, table, field, args[i]))
+        goto err;
+    }
+    if (to->append(')'))
+      goto err;
+    break;
+  case Item_func::ISNULL_FUNC:
+  case Item_func::ISNOTNULL_FUNC:
+    if (!(field= federated_cond_field(table, args[0])) ||
+        append_ident(to, field->field_name, strlen(field->field_name),
+                     ident_quote_char) ||
+        (func->functype() == Item_func::ISNULL_FUNC ?
+         to->append(STRING_WITH_LEN(" IS NULL")) :
+         to->append(STRING_WITH_LEN(" IS NOT NULL"))))
+      goto err;
+    break;
+  case Item_func::LIKE_FUNC:
+  {
+    /* The remote server takes backslash as the escape character */
+    Item_func_like *like= (Item_func_like*) func;
+    if (like->escape_was_used_in_parsing() || like->escape != '\\' ||
+        !(field= federated_cond_field(table, args[0])) ||
+        field->result_type() != STRING_RESULT ||
+        args[1]->result_type() != STRING_RESULT ||
+        append_ident(to, field->field_name, strlen(field->field_name),
+                     ident_quote_char) ||
+        to->append(STRING_WITH_LEN(" LIKE ")) ||
+        federated_append_value(to, table, field, args[1]))
+      goto err;
+    break;
+  }
+  case Item_func::NOT_FUNC:
+  {
+    /* The negation of a part of a condition would reject too many rows */
+    bool arg_complete= true;
+    if (to->append(STRING_WITH_LEN("NOT (")) ||
+        federated_append_cond(to, table, args[0], &arg_complete) ||
+        !arg_complete ||
+        to->append(')'))
+      goto err;
+    break;
+  }
+  default:
+    return 1;
+  }
+  return 0;
+
+err:
+  to->length(start);
+  return 1;
+}
+
+
+/*
+  Append the pushed condition to a remote query, as its WHERE clause or
+  after it.
+
+  RETURN
+    true   the whole condition was appended
+    false  a part of the condition or none of it was appended
+*/
+bool ha_federated::append_remote_cond(String *query, bool has_where)
+{
+  uint32 length= query->length();
+  bool complete= true;
+  DBUG_ENTER("ha_federated::append_remote_cond");
+
+  if (!remote_cond)
+    DBUG_RETURN(false);
+  if ((has_where ? query->append(STRING_WITH_LEN(" AND (")) :
+                   query->append(STRING_WITH_LEN(" WHERE ("))) ||
+      federated_append_cond(query, table, const_cast<Item*>(remote_cond),
+                            &complete) ||
+      query->append(')'))
+  {
+    query->length(length);
+    DBUG_RETURN(false);
+  }
+  DBUG_RETURN(complete);
+}
+
+
+/*
+  The number of rows the remote query of a table scan can stop at: the
+  LIMIT of a single table SELECT without grouping, ordering or DISTINCT,
+  when the remote server checks the whole WHERE clause. The optimizer does
+  not push the parts of the WHERE clause that use RAND(), non-deterministic
+  functions or variable assignments, the server checks them on the rows the
+  remote server returns.
+
+  RETURN
+    number of rows, or HA_POS_ERROR if all the rows must be read
+*/
+ha_rows ha_federated::remote_scan_limit(bool cond_sent)
+{
+  LEX *lex= table->in_use->lex;
+  SELECT_LEX *select_lex= &lex->select_lex;
+
+  if (lex->sql_command != SQLCOM_SELECT ||
+      lex->all_selects_list != select_lex ||
+      select_lex->next_select_in_list() ||
+      select_lex->table_list.elements != 1 ||
+      select_lex->table_list.first->table != table ||
+      select_lex->group_list.elements ||
+      select_lex->order_list.elements ||
+      select_lex->having || select_lex->with_sum_func ||
+      (select_lex->options & (SELECT_DISTINCT | OPTION_FOUND_ROWS)) ||
+      (select_lex->where &&
+       (!cond_sent || (select_lex->where->used_tables() & RAND_TABLE_BIT))))
+    return HA_POS_ERROR;
+  return lex->unit.select_limit_cnt;
+}
+
+
 /*
   Example of simple lock controls. The "share" it creates is structure we will
   pass to each federated handler. Do you have to have one of these? Well, you
@@ -1652,6 +1983,7 @@ int ha_federated::open(const char *name, int mode, uint test_if_locked)
   DBUG_PRINT("info", ("ref_length: %u", ref_length));
 
   my_init_dynamic_array(&results, sizeof(MYSQL_RES *), 4, 4);
+  init_alloc_root(&mrr_root, 4096, 0);
   reset();
 
   DBUG_RETURN(0);
@@ -1677,6 +2009,7 @@ int ha_federated::close(void)
   free_result();
 
   delete_dynamic(&results);
+  free_root(&mrr_root, MYF(0));
 
   /*
     Check to verify wheather the connection is still alive or not.
@@ -2419,6 +2752,7 @@ int ha_federated::index_read_idx_with_result_set(uchar *buf, uint index,
                    sizeof(sql_query_buffer),
                    &my_charset_bin);
   key_range range;
+  bool has_where;
   DBUG_ENTER("ha_federated::index_read_idx_with_result_set");
 
   *result= 0;                                   // In case of errors
@@ -2431,11 +2765,12 @@ int ha_federated::index_read_idx_with_result_set(uchar *buf, uint index,
   range.key= key;
   range.length= key_len;
   range.flag= find_flag;
-  create_where_from_key(&index_string,
-                        &table->key_info[index],
-                        &range,
-                        NULL, 0, 0);
+  has_where= !create_where_from_key(&index_string,
+                                    &table->key_info[index],
+                                    &range,
+                                    NULL, 0, 0);
   sql_query.append(index_string);
+  append_remote_cond(&sql_query, has_where);
 
   if (real_query(sql_query.ptr(), sql_query.length()))
   {
@@ -2515,9 +2850,11 @@ int ha_federated::read_range_first(const key_range *start_key,
 
   sql_query.length(0);
   sql_query.append(share->select_query);
-  create_where_from_key(&sql_query,
-                        &table->key_info[active_index],
-                        start_key, end_key, 0, eq_range_arg);
+  append_remote_cond(&sql_query,
+                     !create_where_from_key(&sql_query,
+                                            &table->key_info[active_index],
+                                            start_key, end_key, 0,
+                                            eq_range_arg));
   if (real_query(sql_query.ptr(), sql_query.length()))
   {
     retval= ER_QUERY_ON_FOREIGN_DATA_SOURCE;
@@ -2553,6 +2890,295 @@ int ha_federated::read_range_next()
 }
 
 
+/*
+  Multi-range reads of equality ranges, the key lookups of the batched key
+  access joins and of IN lists on keys, are sent to the remote server by
+  batches of FEDERATED_MRR_BATCH_RANGES lookups in a single query. Other
+  ranges, or with the mrr optimizer switch off, are read one by one by the
+  default implementation.
+*/
+
+static bool federated_mrr_eq_ranges(RANGE_SEQ_IF *seq, void *seq_init_param,
+                                    uint n_ranges, uint flags)
+{
+  KEY_MULTI_RANGE range;
+  range_seq_t seq_it= seq->init(seq_init_param, n_ranges, flags);
+
+  while (!seq->next(seq_it, &range))
+  {
+    if (!(range.range_flag & EQ_RANGE) || !range.start_key.length ||
+        range.start_key.flag != HA_READ_KEY_EXACT)
+      return FALSE;
+  }
+  return TRUE;
+}
+
+
+ha_rows ha_federated::multi_range_read_info_const(uint keyno,
+                                                  RANGE_SEQ_IF *seq,
+                                                  void *seq_init_param,
+                                                  uint n_ranges,
+                                                  uint *bufsz, uint *flags,
+                                                  Cost_estimate *cost)
+{
+  bool use_default_impl= *flags & HA_MRR_USE_DEFAULT_IMPL;
+  ha_rows rows;
+  DBUG_ENTER("ha_federated::multi_range_read_info_const");
+
+  rows= handler::multi_range_read_info_const(keyno, seq, seq_init_param,
+                                             n_ranges, bufsz, flags, cost);
+  if (rows != HA_POS_ERROR && !use_default_impl && n_ranges > 1 &&
+      table->in_use->optimizer_switch_flag(OPTIMIZER_SWITCH_MRR) &&
+      federated_mrr_eq_ranges(seq, seq_init_param, n_ranges, *flags))
+    *flags&= ~HA_MRR_USE_DEFAULT_IMPL;
+  DBUG_RETURN(rows);
+}
+
+
+ha_rows ha_federated::multi_range_read_info(uint keyno, uint n_ranges,
+                                            uint keys, uint *bufsz,
+                                            uint *flags, Cost_estimate *cost)
+{
+  bool use_default_impl= *flags & HA_MRR_USE_DEFAULT_IMPL;
+  ha_rows rows;
+  DBUG_ENTER("ha_federated::multi_range_read_info");
+
+  /* Only called for the key lookups of batched key access joins */
+  rows= handler::multi_range_read_info(keyno, n_ranges, keys, bufsz, flags,
+                                       cost);
+  if (rows != HA_POS_ERROR && !use_default_impl &&
+      table->in_use->optimizer_switch_flag(OPTIMIZER_SWITCH_MRR))
+    *flags&= ~HA_MRR_USE_DEFAULT_IMPL;
+  DBUG_RETURN(rows);
+}
+
+
+int ha_federated::multi_range_read_init(RANGE_SEQ_IF *seq,
+                                        void *seq_init_param,
+                                        uint n_ranges, uint mode,
+                                        HANDLER_BUFFER *buf)
+{
+  DBUG_ENTER("ha_federated::multi_range_read_init");
+  mrr_batched= !(mode & HA_MRR_USE_DEFAULT_IMPL);
+  mrr_ranges_end= FALSE;
+  mrr_ranges_count= mrr_range_no= 0;
+  mrr_rows_count= mrr_row_no= 0;
+  DBUG_RETURN(handler::multi_range_read_init(seq, seq_init_param, n_ranges,
+                                             mode, buf));
+}
+
+
+/*
+  Append the WHERE clause of the query of a batch: an IN list for lookups
+  of a whole single column key, else an OR of the conditions of the index
+  reads of the lookups.
+
+  RETURN
+    0   ok
+    1   out of memory
+*/
+bool ha_federated::append_mrr_where(String *query, KEY *key_info)
+{
+  KEY_PART_INFO *key_part= key_info->key_part;
+  bool in_list= key_info->user_defined_key_parts == 1;
+  char where_buffer[FEDERATED_QUERY_BUFFER_SIZE];
+  String where(where_buffer, sizeof(where_buffer), &my_charset_bin);
+  DBUG_ENTER("ha_federated::append_mrr_where");
+
+  for (uint i= 0; in_list && i < mrr_ranges_count; i++)
+    in_list= mrr_ranges[i].length == key_part->store_length &&
+             !(key_part->null_bit && mrr_ranges[i].key[0]);
+
+  if (query->append(STRING_WITH_LEN(" WHERE (")))
+    DBUG_RETURN(1);
+  if (in_list)
+  {
+    bool needs_quotes= key_part->field->str_needs_quotes();
+
+    if (emit_key_part_name(query, key_part) ||
+        query->append(STRING_WITH_LEN(" IN (")))
+      DBUG_RETURN(1);
+    for (uint i= 0; i < mrr_ranges_count; i++)
+    {
+      if ((i && query->append(STRING_WITH_LEN(", "))) ||
+          emit_key_part_element(query, key_part, needs_quotes, 0,
+                                mrr_ranges[i].key +
+                                MY_TEST(key_part->null_bit),
+                                key_part->store_length))
+        DBUG_RETURN(1);
+    }
+    if (query->append(')'))
+      DBUG_RETURN(1);
+  }
+  else
+  {
+    for (uint i= 0; i < mrr_ranges_count; i++)
+    {
+      key_range range;
+
+      range.key= mrr_ranges[i].key;
+      range.length= mrr_ranges[i].length;
+      range.keypart_map= mrr_ranges[i].keypart_map;
+      range.flag= HA_READ_KEY_EXACT;
+      where.length(0);
+      if (create_where_from_key(&where, key_info, &range, NULL, 0, 0) ||
+          (i && query->append(STRING_WITH_LEN(" OR "))) ||
+          query->append('(') ||
+          query->append(where.ptr() + sizeof_trailing_where,
+                        where.length() - sizeof_trailing_where) ||
+          query->append(')'))
+        DBUG_RETURN(1);
+    }
+  }
+  DBUG_RETURN(query->append(')'));
+}
+
+
+/*
+  Send the next batch of key lookups of a multi-range read to the remote
+  server, and compute the keys of the rows it returned.
+
+  RETURN
+    0   ok, mrr_ranges_end is set if there was no lookup left
+    #   error
+*/
+int ha_federated::read_mrr_batch()
+{
+  KEY *key_info= &table->key_info[active_index];
+  char sql_query_buffer[FEDERATED_QUERY_BUFFER_SIZE];
+  String sql_query(sql_query_buffer, sizeof(sql_query_buffer),
+                   &my_charset_bin);
+  KEY_MULTI_RANGE range;
+  my_bitmap_map *old_map;
+  DBUG_ENTER("ha_federated::read_mrr_batch");
+
+  free_root(&mrr_root, MYF(MY_MARK_BLOCKS_FREE));
+  mrr_ranges_count= mrr_range_no= 0;
+  mrr_rows_count= mrr_row_no= 0;
+  if (!(mrr_ranges= (FEDERATED_MRR_RANGE*)
+        alloc_root(&mrr_root, FEDERATED_MRR_BATCH_RANGES *
+                              sizeof(FEDERATED_MRR_RANGE))))
+    DBUG_RETURN(HA_ERR_OUT_OF_MEM);
+
+  /* The keys of the ranges may not outlive the next call of next() */
+  while (mrr_ranges_count < FEDERATED_MRR_BATCH_RANGES)
+  {
+    FEDERATED_MRR_RANGE *batch_range= &mrr_ranges[mrr_ranges_count];
+
+    if (mrr_funcs.next(mrr_iter, &range))
+    {
+      mrr_ranges_end= TRUE;
+      break;
+    }
+    DBUG_ASSERT(range.start_key.flag == HA_READ_KEY_EXACT);
+    if (!(batch_range->key= (uchar*) memdup_root(&mrr_root,
+                                                 range.start_key.key,
+                                                 range.start_key.length)))
+      DBUG_RETURN(HA_ERR_OUT_OF_MEM);
+    batch_range->length= range.start_key.length;
+    batch_range->keypart_map= range.start_key.keypart_map;
+    batch_range->ptr= range.ptr;
+    mrr_ranges_count++;
+  }
+  if (!mrr_ranges_count)
+    DBUG_RETURN(0);
+
+  ha_statistic_increment(&SSV::ha_read_key_count);
+  sql_query.length(0);
+  if (sql_query.append(share->select_query) ||
+      append_mrr_where(&sql_query, key_info))
+    DBUG_RETURN(HA_ERR_OUT_OF_MEM);
+  append_remote_cond(&sql_query, TRUE);
+
+  free_result();
+  if (real_query(sql_query.ptr(), sql_query.length()) ||
+      !(stored_result= store_result(mysql)))
+    DBUG_RETURN(stash_remote_error());
+
+  mrr_rows_count= mysql_num_rows(stored_result);
+  if (!(mrr_rows= (FEDERATED_MRR_ROW*)
+        alloc_root(&mrr_root, (size_t) mrr_rows_count *
+                              sizeof(FEDERATED_MRR_ROW) + 1)))
+    DBUG_RETURN(HA_ERR_OUT_OF_MEM);
+
+  /* The key of each row, from its key columns stored in the record */
+  old_map= dbug_tmp_use_all_columns(table, table->write_set);
+  for (ulonglong i= 0; i < mrr_rows_count; i++)
+  {
+    MYSQL_ROW row;
+    ulong *lengths;
+
+    mrr_rows[i].offset= mysql_row_tell(stored_result);
+    row= mysql_fetch_row(stored_result);
+    lengths= mysql_fetch_lengths(stored_result);
+    if (!(mrr_rows[i].key= (uchar*) alloc_root(&mrr_root,
+                                               key_info->key_length)))
+    {
+      dbug_tmp_restore_column_map(table->write_set, old_map);
+      DBUG_RETURN(HA_ERR_OUT_OF_MEM);
+    }
+    for (uint part= 0; part < key_info->user_defined_key_parts; part++)
+    {
+      Field *field= key_info->key_part[part].field;
+      uint column= field->field_index;
+
+      if (!row[column])
+        field->set_null();
+      else
+      {
+        field->set_notnull();
+        field->store(row[column], lengths[column], &my_charset_bin);
+      }
+    }
+    key_copy(mrr_rows[i].key, table->record[0], key_info,
+             key_info->key_length);
+  }
+  dbug_tmp_restore_column_map(table->write_set, old_map);
+  DBUG_RETURN(0);
+}
+
+
+/*
+  Return the rows of the lookups of the batch one lookup after the other,
+  each with the rows of the batch that have its key.
+*/
+int ha_federated::multi_range_read_next(char **range_info)
+{
+  KEY *key_info;
+  int retval;
+  DBUG_ENTER("ha_federated::multi_range_read_next");
+
+  if (!mrr_batched)
+    DBUG_RETURN(handler::multi_range_read_next(range_info));
+
+  key_info= &table->key_info[active_index];
+  for (;;)
+  {
+    for (; mrr_range_no < mrr_ranges_count; mrr_range_no++, mrr_row_no= 0)
+    {
+      FEDERATED_MRR_RANGE *range= &mrr_ranges[mrr_range_no];
+
+      while (mrr_row_no < mrr_rows_count)
+      {
+        FEDERATED_MRR_ROW *row= &mrr_rows[mrr_row_no++];
+
+        if (key_cmp2(key_info->key_part, range->key, range->length,
+                     row->key, range->length))
+          continue;
+        mysql_row_seek(stored_result, row->offset);
+        if (!(retval= read_next(table->record[0], stored_result)))
+          *range_info= range->ptr;
+        DBUG_RETURN(retval);
+      }
+    }
+    if (mrr_ranges_end)
+      DBUG_RETURN(HA_ERR_END_OF_FILE);
+    if ((retval= read_mrr_batch()))
+      DBUG_RETURN(retval);
+  }
+}
+
+
 /* Used to read forward through the index.  */
 int ha_federated::index_next(uchar *buf)
 {
@@ -2619,7 +3245,25 @@ int ha_federated::rnd_init(bool scan)
 
   if (scan)
   {
-    if (real_query(share->select_query, strlen(share->select_query)) ||
+    char sql_query_buffer[FEDERATED_QUERY_BUFFER_SIZE];
+    String sql_query(sql_query_buffer,
+                     sizeof(sql_query_buffer),
+                     &my_charset_bin);
+    ha_rows limit;
+
+    /*
+      The remote server filters the rows by the pushed condition, and stops
+      at the LIMIT when the server would not reject any row it returns.
+    */
+    sql_query.length(0);
+    sql_query.append(share->select_query);
+    limit= remote_scan_limit(append_remote_cond(&sql_query, FALSE));
+    if (limit != HA_POS_ERROR)
+    {
+      sql_query.append(STRING_WITH_LEN(" LIMIT "));
+      sql_query.append_ulonglong(limit);
+    }
+    if (real_query(sql_query.ptr(), sql_query.length()) ||
         !(stored_result= store_result(mysql)))
       DBUG_RETURN(stash_remote_error());
   }
@@ -2988,6 +3632,7 @@ int ha_federated::reset(void)
   insert_dup_update= FALSE;
   ignore_duplicates= FALSE;
   replace_duplicates= FALSE;
+  remote_cond= NULL;
 
   /* Free stored result sets. */
   for (uint i= 0; i < results.elements; i++)
@@ -3002,6 +3647,28 @@ int ha_federated::reset(void)
 }
 
 
+/*
+  The pushed condition is added to the remote queries of the scans and index
+  reads of the statement, the server still checks it for every row. Only the
+  last condition pushed is kept.
+*/
+
+const Item *ha_federated::cond_push(const Item *cond)
+{
+  DBUG_ENTER("ha_federated::cond_push");
+  remote_cond= cond;
+  DBUG_RETURN(cond);
+}
+
+
+void ha_federated::cond_pop()
+{
+  DBUG_ENTER("ha_federated::cond_pop");
+  remote_cond= NULL;
+  DBUG_VOID_RETURN;
+}
+
+
 /*
   Used to delete all rows in a table. Both for cases of truncate and
   for cases where the optimizer realizes that all rows will be
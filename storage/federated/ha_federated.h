@@ -33,6 +33,7 @@
 #define FEDERATED_QUERY_BUFFER_SIZE STRING_BUFFER_USUAL_SIZE * 5
 #define FEDERATED_RECORDS_IN_RANGE 2
 #define FEDERATED_MAX_KEY_LENGTH 3500 // Same as innodb
+#define FEDERATED_MRR_BATCH_RANGES 100 // Key lookups per remote query
 
 /*
   FEDERATED_SHARE is a structure that will be shared amoung all open handlers
@@ -71,6 +72,22 @@ typedef struct st_federated_share {
   THR_LOCK lock;
 } FEDERATED_SHARE;
 
+/*
+  A key lookup of a batch read by one remote query, and a row the query
+  returned, with its key to match it with the lookups.
+*/
+typedef struct st_federated_mrr_range {
+  uchar *key;
+  uint length;
+  key_part_map keypart_map;
+  char *ptr;                            // range_info of the lookup
+} FEDERATED_MRR_RANGE;
+
+typedef struct st_federated_mrr_row {
+  MYSQL_ROW_OFFSET offset;
+  uchar *key;
+} FEDERATED_MRR_ROW;
+
 /*
   Class definition for the storage engine
 */
@@ -92,6 +109,18 @@ class ha_federated: public handler
   bool ignore_duplicates, replace_duplicates;
   bool insert_dup_update;
   DYNAMIC_STRING bulk_insert;
+  /*
+    Condition pushed by the optimizer: the part of it the remote server can
+    check is added to the queries of scans and index reads.
+  */
+  const Item *remote_cond;
+  /* Key lookups of a multi-range read, sent to the remote server by batches */
+  bool mrr_batched, mrr_ranges_end;
+  MEM_ROOT mrr_root;                    // Lookups and rows of the batch
+  FEDERATED_MRR_RANGE *mrr_ranges;
+  uint mrr_ranges_count, mrr_range_no;
+  FEDERATED_MRR_ROW *mrr_rows;
+  ulonglong mrr_rows_count, mrr_row_no;
 
 private:
   /*
@@ -116,6 +145,10 @@ private:
                                      MYSQL_RES **result);
   int real_query(const char *query, size_t length);
   int real_connect();
+  bool append_remote_cond(String *query, bool has_where);
+  ha_rows remote_scan_limit(bool cond_sent);
+  bool append_mrr_where(String *query, KEY *key_info);
+  int read_mrr_batch();
 public:
   ha_federated(handlerton *hton, TABLE_SHARE *table_arg);
   ~ha_federated() {}
@@ -227,6 +260,16 @@ public:
                                const key_range *end_key,
                                bool eq_range, bool sorted);
   int read_range_next();
+  ha_rows multi_range_read_info_const(uint keyno, RANGE_SEQ_IF *seq,
+                                      void *seq_init_param, uint n_ranges,
+                                      uint *bufsz, uint *flags,
+                                      Cost_estimate *cost);
+  ha_rows multi_range_read_info(uint keyno, uint n_ranges, uint keys,
+                                uint *bufsz, uint *flags,
+                                Cost_estimate *cost);
+  int multi_range_read_init(RANGE_SEQ_IF *seq, void *seq_init_param,
+                            uint n_ranges, uint mode, HANDLER_BUFFER *buf);
+  int multi_range_read_next(char **range_info);
   /*
     unlike index_init(), rnd_init() can be called two times
     without rnd_end() in between (it only makes sense if scan=1).
@@ -269,5 +312,8 @@ public:
   int connection_autocommit(bool state);
   int execute_simple_query(const char *query, int len);
   int reset(void);
+
+  const Item *cond_push(const Item *cond);
+  void cond_pop();
 };
 
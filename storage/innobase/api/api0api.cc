@@ -1510,6 +1510,8 @@ ib_cursor_insert_row(
 	ib_cursor_t*	cursor = (ib_cursor_t*) ib_crsr;
 	const ib_tuple_t* src_tuple = (const ib_tuple_t*) ib_tpl;
 
+	innobase_col_mirror_api_write(cursor->prebuilt->table);
+
 	ib_insert_query_graph_create(cursor);
 
 	ut_ad(src_tuple->type == TPL_TYPE_ROW);
@@ -1848,6 +1850,8 @@ ib_cursor_update_row(
 	ut_a(old_tuple->type == TPL_TYPE_ROW);
 	ut_a(new_tuple->type == TPL_TYPE_ROW);
 
+	innobase_col_mirror_api_write(prebuilt->table);
+
 	upd = ib_update_vector_create(cursor);
 
 	err = ib_calc_diff(cursor, upd, old_tuple, new_tuple);
@@ -1959,6 +1963,8 @@ ib_cursor_delete_row(
 		pcur = &prebuilt->pcur;
 	}
 
+	innobase_col_mirror_api_write(prebuilt->table);
+
 	if (ib_btr_cursor_is_positioned(pcur)) {
 		const rec_t*	rec;
 		ib_bool_t	page_format;
@@ -3730,6 +3736,8 @@ ib_cursor_truncate(
 
 	*table_id = 0;
 
+	innobase_col_mirror_api_write(prebuilt->table);
+
 	err = ib_cursor_lock(*ib_crsr, IB_LOCK_X);
 
 	if (err == DB_SUCCESS) {
@@ -56,6 +56,7 @@ Created 10/16/1994 Heikki Tuuri
 #include "rem0rec.h"
 #include "rem0cmp.h"
 #include "buf0lru.h"
+#include "buf0rea.h"
 #include "btr0btr.h"
 #include "btr0sea.h"
 #include "row0log.h"
@@ -1013,6 +1014,155 @@ btr_cur_open_at_index_side_func(
 	}
 }
 
+/*****************************************************************//**
+Issues asynchronous reads for the pages on the path from the root of an
+index to the leaf page that a search with the given tuple and mode would
+end up on. Non-leaf pages that are already being read are waited for, so
+that each call descends at least one level further than the previous one
+and the reads for many indexes (for example the partitions of a table) can
+be overlapped by calling this for each of them in turn.
+@return TRUE if a non-leaf page read was issued and calling again later
+would descend further, FALSE if the whole path is in the buffer pool or
+has been requested */
+UNIV_INTERN
+ibool
+btr_cur_prefetch_path(
+/*==================*/
+	dict_index_t*	index,	/*!< in: index */
+	const dtuple_t*	tuple,	/*!< in: data tuple; if it has no fields,
+				the path to the first (mode PAGE_CUR_G or
+				PAGE_CUR_GE) or last leaf page is read */
+	ulint		mode)	/*!< in: PAGE_CUR_L, ... */
+{
+	mtr_t		mtr;
+	page_cur_t	page_cursor;
+	ulint		space;
+	ulint		zip_size;
+	ulint		page_no;
+	ulint		height;
+	ulint		page_mode;
+	ulint		up_match;
+	ulint		up_bytes;
+	ulint		low_match;
+	ulint		low_bytes;
+	ibool		pending		= FALSE;
+	mem_heap_t*	heap		= NULL;
+	ulint		offsets_[REC_OFFS_NORMAL_SIZE];
+	ulint*		offsets		= offsets_;
+	rec_offs_init(offsets_);
+
+	ut_ad(!(index->type & DICT_FTS));
+	ut_ad(!dict_index_is_ibuf(index));
+
+	switch (mode) {
+	case PAGE_CUR_GE:
+		page_mode = PAGE_CUR_L;
+		break;
+	case PAGE_CUR_G:
+		page_mode = PAGE_CUR_LE;
+		break;
+	default:
+		page_mode = mode;
+	}
+
+	mtr_start(&mtr);
+	mtr_s_lock(dict_index_get_lock(index), &mtr);
+
+	space = dict_index_get_space(index);
+	zip_size = dict_table_zip_size(index->table);
+	page_no = dict_index_get_page(index);
+
+	height = ULINT_UNDEFINED;
+
+	for (;;) {
+		buf_block_t*	block;
+		const rec_t*	node_ptr;
+
+		/* height is the level of page_no, or ULINT_UNDEFINED
+		for the root */
+
+		if (!buf_page_peek(space, page_no)) {
+			/* Nothing is left to descend to once the read of
+			the leaf page has been issued. */
+			pending = height != 0;
+			break;
+		}
+
+		if (height == 0) {
+			/* The leaf page is in the buffer pool or is
+			being read already. */
+			page_no = FIL_NULL;
+			break;
+		}
+
+		/* If the page is being read, this waits for the read
+		to complete. */
+		block = buf_page_get_gen(space, zip_size, page_no,
+					 RW_NO_LATCH, NULL, BUF_GET,
+					 __FILE__, __LINE__, &mtr);
+
+		if (height == ULINT_UNDEFINED) {
+			height = btr_page_get_level(
+				buf_block_get_frame(block), &mtr);
+		}
+
+		if (height == 0) {
+			/* The root is the only page of the index. */
+			page_no = FIL_NULL;
+			break;
+		}
+
+		if (dtuple_get_n_fields(tuple) > 0) {
+			page_cur_search_with_match(
+				block, index, tuple, page_mode,
+				&up_match, &up_bytes, &low_match, &low_bytes,
+				&page_cursor);
+		} else if (mode == PAGE_CUR_G || mode == PAGE_CUR_GE) {
+			page_cur_set_before_first(block, &page_cursor);
+			page_cur_move_to_next(&page_cursor);
+		} else {
+			page_cur_set_after_last(block, &page_cursor);
+			page_cur_move_to_prev(&page_cursor);
+		}
+
+		node_ptr = page_cur_get_rec(&page_cursor);
+
+		if (page_rec_is_infimum(node_ptr)) {
+			/* PAGE_CUR_L or PAGE_CUR_LE positioned before the
+			first node pointer; the search follows the first
+			one. */
+			node_ptr = page_rec_get_next_const(node_ptr);
+		}
+
+		if (!page_rec_is_user_rec(node_ptr)) {
+			page_no = FIL_NULL;
+			break;
+		}
+
+		offsets = rec_get_offsets(node_ptr, index, offsets,
+					  ULINT_UNDEFINED, &heap);
+		page_no = btr_node_ptr_get_child_page_no(node_ptr, offsets);
+		height--;
+	}
+
+	/* Release the index lock before submitting the read. */
+	mtr_commit(&mtr);
+
+	if (heap) {
+		mem_heap_free(heap);
+	}
+
+	if (page_no != FIL_NULL) {
+		if (buf_read_page_async(space, page_no)) {
+			os_aio_simulated_wake_handler_threads();
+		} else {
+			pending = FALSE;
+		}
+	}
+
+	return(pending);
+}
+
 /**********************************************************************//**
 Positions a cursor at a randomly chosen position within a B-tree. */
 UNIV_INTERN
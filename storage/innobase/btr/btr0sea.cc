@@ -1002,6 +1002,7 @@ btr_search_guess_on_hash(
 	record to determine if our guess for the cursor position is
 	right. */
 	if (UNIV_UNLIKELY(index_id != btr_page_get_index_id(block->frame))
+	    || UNIV_UNLIKELY(buf_block_get_space(block) != index->space)
 	    || !btr_search_check_guess(cursor,
 				       has_search_latch,
 				       tuple, mode, mtr)) {
@@ -1589,6 +1589,9 @@ buf_pool_init_instance(
 	/* Initialize the iterator for single page scan search */
 	new(&buf_pool->single_scan_itr) LRUItr(buf_pool, &buf_pool->mutex);
 
+	/* Initialize the hazard pointer for freeing stale pages */
+	new(&buf_pool->stale_hp) LRUHp(buf_pool, &buf_pool->mutex);
+
 	buf_pool_mutex_exit(buf_pool);
 
 	return(DB_SUCCESS);
@@ -1686,6 +1689,8 @@ buf_pool_init(
 	buf_pool_ptr = (buf_pool_t*) mem_zalloc(
 		n_instances * sizeof *buf_pool_ptr);
 
+	buf_LRU_stale_init();
+
 	for (i = 0; i < n_instances; i++) {
 		buf_pool_t*	ptr	= &buf_pool_ptr[i];
 
@@ -1737,6 +1742,8 @@ buf_pool_free(
 
 	mem_free(buf_pool_ptr);
 	buf_pool_ptr = NULL;
+
+	buf_LRU_stale_free();
 }
 
 UNIV_INTERN
@@ -939,27 +939,30 @@ buf_dblwr_write_block_to_datafile(
 	const ulint flags = sync
 		? OS_FILE_WRITE
 		: OS_FILE_WRITE | OS_AIO_SIMULATED_WAKE_LATER;
+	dberr_t	err;
 
 	if (bpage->zip.data) {
-		fil_io(flags, sync, buf_page_get_space(bpage),
-		       buf_page_get_zip_size(bpage),
-		       buf_page_get_page_no(bpage), 0,
-		       buf_page_get_zip_size(bpage),
-		       (void*) bpage->zip.data,
-		       (void*) bpage);
+		err = fil_io(flags, sync, buf_page_get_space(bpage),
+			     buf_page_get_zip_size(bpage),
+			     buf_page_get_page_no(bpage), 0,
+			     buf_page_get_zip_size(bpage),
+			     (void*) bpage->zip.data,
+			     (void*) bpage);
+	} else {
+		const buf_block_t* block = (buf_block_t*) bpage;
+		ut_a(buf_block_get_state(block) == BUF_BLOCK_FILE_PAGE);
+		buf_dblwr_check_page_lsn(block->frame);
 
-		return;
+		err = fil_io(flags, sync, buf_block_get_space(block), 0,
+			     buf_block_get_page_no(block), 0, UNIV_PAGE_SIZE,
+			     (void*) block->frame, (void*) block);
 	}
 
-
-	const buf_block_t* block = (buf_block_t*) bpage;
-	ut_a(buf_block_get_state(block) == BUF_BLOCK_FILE_PAGE);
-	buf_dblwr_check_page_lsn(block->frame);
-
-	fil_io(flags, sync, buf_block_get_space(block), 0,
-	       buf_block_get_page_no(block), 0, UNIV_PAGE_SIZE,
-	       (void*) block->frame, (void*) block);
-
+	if (err == DB_TABLESPACE_DELETED && !sync) {
+		/* The write of a page of a stale tablespace was skipped,
+		there is no aio to complete it and release its slot. */
+		buf_page_io_complete(const_cast<buf_page_t*>(bpage));
+	}
 }
 
 /********************************************************************//**
@@ -935,11 +935,18 @@ buf_flush_write_block_low(
 	}
 
 	if (!srv_use_doublewrite_buf || !buf_dblwr) {
-		fil_io(OS_FILE_WRITE | OS_AIO_SIMULATED_WAKE_LATER,
-		       sync, buf_page_get_space(bpage), zip_size,
-		       buf_page_get_page_no(bpage), 0,
-		       zip_size ? zip_size : UNIV_PAGE_SIZE,
-		       frame, bpage);
+		dberr_t	err = fil_io(
+			OS_FILE_WRITE | OS_AIO_SIMULATED_WAKE_LATER,
+			sync, buf_page_get_space(bpage), zip_size,
+			buf_page_get_page_no(bpage), 0,
+			zip_size ? zip_size : UNIV_PAGE_SIZE,
+			frame, bpage);
+
+		if (err == DB_TABLESPACE_DELETED && !sync) {
+			/* The write of a page of a stale tablespace was
+			skipped, there is no aio to complete it. */
+			buf_page_io_complete(bpage);
+		}
 	} else if (flush_type == BUF_FLUSH_SINGLE_PAGE) {
 		buf_dblwr_write_single_page(bpage, sync);
 	} else {
@@ -2579,6 +2586,9 @@ DECLARE_THREAD(buf_flush_page_cleaner_thread)(
 		next_loop_time = ut_time_ms() +
 			 page_cleaner_adapt_sleep_time();
 
+		/* Free the pages of the tablespaces dropped lazily */
+		buf_LRU_sweep_stale_pages();
+
 		if (srv_check_activity(last_activity)) {
 			last_activity = srv_get_activity_count();
 
@@ -55,6 +55,8 @@ Created 11/5/1995 Heikki Tuuri
 
 #include "ha_prototypes.h"
 
+#include <set>
+
 /** The number of blocks from the LRU_old pointer onward, including
 the block pointed to, must be buf_pool->LRU_old_ratio/BUF_LRU_OLD_RATIO_DIV
 of the whole LRU list length, except that the tolerance defined below
@@ -85,6 +87,23 @@ buffer pools. */
 during LRU eviction. */
 #define BUF_LRU_SEARCH_SCAN_THRESHOLD	100
 
+/** Ids of the dropped tablespaces whose pages may still be in the buffer
+pool, see BUF_REMOVE_LAZY. Protected by buf_LRU_stale_mutex. */
+typedef std::set<ulint>	buf_LRU_space_set;
+static buf_LRU_space_set*	buf_LRU_stale_spaces;
+
+/** Protects buf_LRU_stale_spaces. This is a leaf mutex. */
+static os_fast_mutex_t	buf_LRU_stale_mutex;
+
+/** Number of elements of buf_LRU_stale_spaces. Read without the mutex
+to skip the lookup when no tablespace is stale. */
+static ulint	buf_LRU_n_stale_spaces;
+
+/** Serializes buf_LRU_sweep_stale_pages() and
+buf_LRU_reclaim_stale_space(), so that a sweep never works from a list
+of stale ids that includes a reused id. */
+static os_fast_mutex_t	buf_LRU_sweep_mutex;
+
 /** If we switch on the InnoDB monitor because there are too few available
 frames in the buffer pool, we set this to TRUE */
 static ibool	buf_lru_switched_on_innodb_mon	= FALSE;
@@ -867,6 +886,9 @@ buf_LRU_remove_pages(
 		os_aio_wait_until_no_pending_writes();
 		fil_flush(id, FLUSH_FROM_OTHER);
 		break;
+
+	case BUF_REMOVE_LAZY:
+		ut_error;
 	}
 }
 
@@ -886,6 +908,13 @@ buf_LRU_flush_or_remove_pages(
 {
 	ulint		i;
 
+	if (buf_remove == BUF_REMOVE_LAZY) {
+		/* The pages are freed by buf_LRU_sweep_stale_pages(),
+		and their writes skipped by fil_io(). */
+		buf_LRU_mark_space_stale(id);
+		return;
+	}
+
 	/* Before we attempt to drop pages one by one we first
 	attempt to drop page hash index entries in batches to make
 	it more efficient. The batching attempt is a best effort
@@ -928,12 +957,263 @@ buf_LRU_flush_or_remove_pages(
 			/* We allow read-only queries against the
 			table, there is no need to drop the AHI entries. */
 			break;
+
+		case BUF_REMOVE_LAZY:
+			ut_error;
 		}
 
 		buf_LRU_remove_pages(buf_pool, id, buf_remove, trx);
 	}
 }
 
+/******************************************************************//**
+Initializes the list of stale tablespaces. */
+UNIV_INTERN
+void
+buf_LRU_stale_init(void)
+/*====================*/
+{
+	os_fast_mutex_init(PFS_NOT_INSTRUMENTED, &buf_LRU_stale_mutex);
+	os_fast_mutex_init(PFS_NOT_INSTRUMENTED, &buf_LRU_sweep_mutex);
+	buf_LRU_stale_spaces = new buf_LRU_space_set();
+	buf_LRU_n_stale_spaces = 0;
+}
+
+/******************************************************************//**
+Frees the list of stale tablespaces. */
+UNIV_INTERN
+void
+buf_LRU_stale_free(void)
+/*====================*/
+{
+	delete buf_LRU_stale_spaces;
+	buf_LRU_stale_spaces = NULL;
+	buf_LRU_n_stale_spaces = 0;
+	os_fast_mutex_free(&buf_LRU_sweep_mutex);
+	os_fast_mutex_free(&buf_LRU_stale_mutex);
+}
+
+/******************************************************************//**
+Marks a dropped tablespace stale: its pages stay in the buffer pool until
+buf_LRU_sweep_stale_pages() frees them, and fil_io() skips their writes. */
+UNIV_INTERN
+void
+buf_LRU_mark_space_stale(
+/*=====================*/
+	ulint	id)	/*!< in: space id */
+{
+	os_fast_mutex_lock(&buf_LRU_stale_mutex);
+	buf_LRU_stale_spaces->insert(id);
+	buf_LRU_n_stale_spaces = buf_LRU_stale_spaces->size();
+	os_fast_mutex_unlock(&buf_LRU_stale_mutex);
+}
+
+/******************************************************************//**
+Removes tablespaces from the stale list. */
+static
+void
+buf_LRU_unmark_spaces_stale(
+/*========================*/
+	const buf_LRU_space_set&	spaces)	/*!< in: space ids */
+{
+	os_fast_mutex_lock(&buf_LRU_stale_mutex);
+	for (buf_LRU_space_set::const_iterator it = spaces.begin();
+	     it != spaces.end(); ++it) {
+		buf_LRU_stale_spaces->erase(*it);
+	}
+	buf_LRU_n_stale_spaces = buf_LRU_stale_spaces->size();
+	os_fast_mutex_unlock(&buf_LRU_stale_mutex);
+}
+
+/******************************************************************//**
+Checks if a tablespace was dropped while its pages were left in the
+buffer pool.
+@return true if the space is stale */
+UNIV_INTERN
+bool
+buf_LRU_space_is_stale(
+/*===================*/
+	ulint	id)	/*!< in: space id */
+{
+	bool	stale;
+
+	if (buf_LRU_n_stale_spaces == 0) {
+		return(false);
+	}
+
+	os_fast_mutex_lock(&buf_LRU_stale_mutex);
+	stale = buf_LRU_stale_spaces->count(id) > 0;
+	os_fast_mutex_unlock(&buf_LRU_stale_mutex);
+
+	return(stale);
+}
+
+/******************************************************************//**
+Checks if any tablespace is stale.
+@return true if buf_LRU_sweep_stale_pages() has work to do */
+UNIV_INTERN
+bool
+buf_LRU_have_stale_spaces(void)
+/*===========================*/
+{
+	return(buf_LRU_n_stale_spaces > 0);
+}
+
+/******************************************************************//**
+Frees a page of a stale tablespace, dropping it from the flush list
+without writing it if it is dirty. The caller must hold buf_pool->mutex,
+which this function may release temporarily.
+@return true if the page was freed */
+static
+bool
+buf_LRU_free_stale_page(
+/*====================*/
+	buf_pool_t*	buf_pool,	/*!< in: buffer pool instance */
+	buf_page_t*	bpage)		/*!< in: page of a stale space */
+{
+	ib_mutex_t*	block_mutex = buf_page_get_mutex(bpage);
+	ibool		removed;
+
+	ut_ad(buf_pool_mutex_own(buf_pool));
+
+	mutex_enter(block_mutex);
+
+	if (!buf_page_can_relocate(bpage)) {
+		/* A write that fil_io() skips is being completed */
+		mutex_exit(block_mutex);
+		return(false);
+	}
+
+	if (bpage->oldest_modification != 0) {
+		buf_flush_remove(bpage);
+	}
+
+	mutex_exit(block_mutex);
+
+	return(buf_LRU_free_page(bpage, true, &removed));
+}
+
+/******************************************************************//**
+Frees the pages of the given stale tablespaces in a buffer pool
+instance, releasing buf_pool->mutex every BUF_LRU_DROP_SEARCH_SIZE pages.
+@return true if no page of these spaces is left in the instance */
+static
+bool
+buf_LRU_sweep_stale_instance(
+/*=========================*/
+	buf_pool_t*			buf_pool,	/*!< in: buffer pool
+							instance */
+	const buf_LRU_space_set&	spaces)		/*!< in: stale space
+							ids */
+{
+	bool		all_freed = true;
+	ulint		scanned = 0;
+	buf_page_t*	bpage;
+
+	buf_pool_mutex_enter(buf_pool);
+
+	for (bpage = UT_LIST_GET_LAST(buf_pool->LRU);
+	     bpage != NULL;
+	     bpage = buf_pool->stale_hp.get()) {
+
+		buf_page_t*	prev = UT_LIST_GET_PREV(LRU, bpage);
+
+		buf_pool->stale_hp.set(prev);
+
+		ut_ad(buf_page_in_file(bpage));
+
+		if (spaces.count(buf_page_get_space(bpage)) > 0
+		    && !buf_LRU_free_stale_page(buf_pool, bpage)) {
+
+			all_freed = false;
+		}
+
+		if (++scanned % BUF_LRU_DROP_SEARCH_SIZE == 0) {
+			/* Let other threads use the instance; the hazard
+			pointer is adjusted if prev goes away meanwhile. */
+			buf_pool_mutex_exit(buf_pool);
+			os_thread_yield();
+			buf_pool_mutex_enter(buf_pool);
+		}
+	}
+
+	buf_pool->stale_hp.set(NULL);
+
+	buf_pool_mutex_exit(buf_pool);
+
+	return(all_freed);
+}
+
+/******************************************************************//**
+Frees the buffer pool pages of the stale tablespaces, and forgets about
+the tablespaces that have no page left. Called by the page cleaner,
+and when an index must wait for its adaptive hash index entries to be
+dropped. */
+UNIV_INTERN
+void
+buf_LRU_sweep_stale_pages(void)
+/*===========================*/
+{
+	buf_LRU_space_set	spaces;
+	bool			all_freed = true;
+
+	if (!buf_LRU_have_stale_spaces()) {
+		return;
+	}
+
+	os_fast_mutex_lock(&buf_LRU_sweep_mutex);
+
+	os_fast_mutex_lock(&buf_LRU_stale_mutex);
+	spaces = *buf_LRU_stale_spaces;
+	os_fast_mutex_unlock(&buf_LRU_stale_mutex);
+
+	for (ulint i = 0; !spaces.empty() && i < srv_buf_pool_instances; i++) {
+		if (!buf_LRU_sweep_stale_instance(
+			buf_pool_from_array(i), spaces)) {
+
+			all_freed = false;
+		}
+	}
+
+	/* No page of a stale space can be read in, so the spaces whose
+	pages were all freed stay empty. */
+	if (all_freed) {
+		buf_LRU_unmark_spaces_stale(spaces);
+	}
+
+	os_fast_mutex_unlock(&buf_LRU_sweep_mutex);
+}
+
+/******************************************************************//**
+Removes the pages of a stale tablespace before its id is used again by
+a new tablespace, as for an IMPORT after a DISCARD. */
+UNIV_INTERN
+void
+buf_LRU_reclaim_stale_space(
+/*========================*/
+	ulint	id)	/*!< in: space id */
+{
+	if (!buf_LRU_space_is_stale(id)) {
+		return;
+	}
+
+	os_fast_mutex_lock(&buf_LRU_sweep_mutex);
+
+	for (ulint i = 0; i < srv_buf_pool_instances; i++) {
+		buf_pool_t*	buf_pool = buf_pool_from_array(i);
+
+		buf_LRU_drop_page_hash_for_tablespace(buf_pool, id);
+		buf_LRU_remove_all_pages(buf_pool, id);
+	}
+
+	buf_LRU_space_set	spaces;
+
+	spaces.insert(id);
+	buf_LRU_unmark_spaces_stale(spaces);
+
+	os_fast_mutex_unlock(&buf_LRU_sweep_mutex);
+}
+
 #if defined UNIV_DEBUG || defined UNIV_BUF_DEBUG
 /********************************************************************//**
 Insert a compressed block into buf_pool->zip_clean in the LRU order. */
@@ -1583,6 +1863,7 @@ buf_LRU_adjust_hp(
 	buf_pool->lru_hp.adjust(bpage);
 	buf_pool->lru_scan_itr.adjust(bpage);
 	buf_pool->single_scan_itr.adjust(bpage);
+	buf_pool->stale_hp.adjust(bpage);
 }
 
 /******************************************************************//**
@@ -51,6 +51,7 @@ ib_warn_row_too_big(const dict_table_t*	table);
 
 #ifndef UNIV_HOTBACKUP
 #include "buf0buf.h"
+#include "buf0lru.h"
 #include "data0type.h"
 #include "mach0data.h"
 #include "dict0boot.h"
@@ -2730,6 +2731,10 @@ dict_index_remove_from_cache_low(
 			break;
 		}
 
+		/* The entries may point to the pages of a truncated or
+		discarded tablespace that were left in the buffer pool. */
+		buf_LRU_sweep_stale_pages();
+
 		/* Sleep for 10ms before trying again. */
 		os_thread_sleep(10000);
 		++retries;
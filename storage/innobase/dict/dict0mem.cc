@@ -199,6 +199,10 @@ dict_mem_table_free(
 	}
 #ifndef UNIV_HOTBACKUP
 	dict_table_autoinc_destroy(table);
+
+	if (table->col_mirror) {
+		innobase_col_mirror_free(table);
+	}
 #endif /* UNIV_HOTBACKUP */
 
 	dict_table_stats_latch_destroy(table);
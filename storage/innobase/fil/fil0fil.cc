@@ -28,6 +28,9 @@ Created 10/25/1995 Heikki Tuuri
 #include <debug_sync.h>
 #include <my_dbug.h>
 
+#include <algorithm>
+#include <vector>
+
 #include "log.h"
 
 #include "mem0mem.h"
@@ -1500,6 +1503,12 @@ fil_space_create(
 	ut_a(fil_system);
 	ut_a(fsp_flags_is_valid(flags));
 
+#ifndef UNIV_HOTBACKUP
+	/* Pages of a dropped tablespace that had this id may still be in
+	the buffer pool, see BUF_REMOVE_LAZY. */
+	buf_LRU_reclaim_stale_space(id);
+#endif /* !UNIV_HOTBACKUP */
+
 	/* Look for a matching tablespace and if found free it. */
 	do {
 		mutex_enter(&fil_system->mutex);
@@ -3092,6 +3101,16 @@ fil_delete_tablespace(
 	To deal with potential read requests by checking the
 	::stop_new_ops flag in fil_io() */
 
+	if (srv_buf_lazy_drop
+	    && buf_remove != BUF_REMOVE_FLUSH_WRITE
+	    && !recv_recovery_is_on()) {
+
+		/* Leave the pages in the buffer pool, to be freed as
+		the page cleaner reaches them. fil_io() no longer writes
+		them, but writes issued before may still be pending. */
+		buf_remove = BUF_REMOVE_LAZY;
+	}
+
 	buf_LRU_flush_or_remove_pages(id, buf_remove, 0);
 
 #endif /* !UNIV_HOTBACKUP */
@@ -3111,6 +3130,21 @@ fil_delete_tablespace(
 
 	mutex_enter(&fil_system->mutex);
 
+#ifndef UNIV_HOTBACKUP
+	if (buf_remove == BUF_REMOVE_LAZY && fil_space_get_by_id(id)) {
+		fil_node_t*	node;
+		ulint		count = 0;
+
+		/* Wait for the writes issued before the space was
+		marked stale. */
+		while ((count = fil_check_pending_io(space, &node, count))) {
+			mutex_exit(&fil_system->mutex);
+			os_thread_sleep(20000);
+			mutex_enter(&fil_system->mutex);
+		}
+	}
+#endif /* !UNIV_HOTBACKUP */
+
 	/* Double check the sanity of pending ops after reacquiring
 	the fil_system::mutex. */
 	if (fil_space_get_by_id(id)) {
@@ -5180,48 +5214,214 @@ fil_file_readdir_next_file(
 	return(-1);
 }
 
-/********************************************************************
- * below is the date struct and function to implement
- * parallelize opening table files
- ********************************************************************/
-
+/** Number of threads that scan the database directories and read the
+first page of the .ibd files in fil_load_single_table_tablespaces() */
 UNIV_INTERN uint innobase_load_table_thread_num = 10;
 
-struct database_node_t {
-  char* db_name;
-  ulint database_id;
-  hash_node_t name_hash;
+/** A database directory, or a tablespace file in it */
+struct fil_load_file_t {
+	const char*	db_name;	/*!< database directory name */
+	char*		file_name;	/*!< .ibd or .isl file name, NULL
+					for a directory */
 };
 
-struct table_file_node_t {
-  char* db_name;
-  char* file_name;
-  ulint database_id;
-  UT_LIST_NODE_T(table_file_node_t) table_file;
+typedef std::vector<fil_load_file_t>	fil_load_files_t;
+
+/** Orders tablespace files by table, an .ibd file next to its .isl */
+struct fil_load_file_less {
+	bool operator()(
+		const fil_load_file_t&	a,
+		const fil_load_file_t&	b) const
+	{
+		int	cmp = strcmp(a.db_name, b.db_name);
+
+		if (cmp == 0) {
+			ulint	a_len = strlen(a.file_name) - 4;
+			ulint	b_len = strlen(b.file_name) - 4;
+
+			cmp = memcmp(a.file_name, b.file_name,
+				     ut_min(a_len, b_len));
+
+			if (cmp == 0) {
+				return(a_len < b_len);
+			}
+		}
+
+		return(cmp < 0);
+	}
 };
 
-struct thread_params {
-  ulint task_id;
-  os_event_t event;
-  UT_LIST_BASE_NODE_T(table_file_node_t) *task;
+/** The work shared by the threads of fil_load_single_table_tablespaces(),
+which first scan the database directories, then load the tablespaces.
+The threads take the items in turn, so that a large database does not
+leave the other threads idle. */
+struct fil_load_work_t {
+	fil_load_files_t	items;	/*!< directories or files to process */
+	bool			scan;	/*!< true if items are database
+					directories to scan */
+	ulint			next;	/*!< number of items taken */
 };
 
-void* load_table_file(void* args) {
-  thread_params *params = static_cast<thread_params*>(args);
-  table_file_node_t *table_file_node = NULL;
-  for (table_file_node = UT_LIST_GET_FIRST(*params->task);
-       table_file_node != NULL;
-       table_file_node = UT_LIST_GET_NEXT(table_file, table_file_node)) {
-    // partition tasks
-    if ((table_file_node->database_id % innobase_load_table_thread_num)
-        == params->task_id) {
-      fil_load_single_table_tablespace(table_file_node->db_name,
-                                       table_file_node->file_name);
-    }
-  }
-  os_event_set(params->event);
-  os_thread_exit(NULL);
-  OS_THREAD_DUMMY_RETURN;
+/** A thread of fil_load_single_table_tablespaces() */
+struct fil_load_thread_t {
+	fil_load_work_t*	work;	/*!< in: shared work */
+	fil_load_files_t	found;	/*!< out: tablespace files found
+					when scanning directories */
+	dberr_t			err;	/*!< out: DB_ERROR if a directory
+					could not be read */
+	os_event_t		done;	/*!< set when the thread exits */
+};
+
+/********************************************************************//**
+Looks for .ibd and .isl files in a database directory. */
+static
+void
+fil_load_scan_database(
+/*===================*/
+	const char*		dbname,	/*!< in: database directory name */
+	fil_load_files_t*	found,	/*!< in/out: files found */
+	dberr_t*		err)	/*!< out: DB_ERROR if the directory
+					could not be read */
+{
+	ulint		dbpath_len = strlen(fil_path_to_mysql_datadir)
+		+ strlen(dbname) + 2;
+	char*		dbpath = static_cast<char*>(mem_alloc(dbpath_len));
+	os_file_dir_t	dbdir;
+	os_file_stat_t	fileinfo;
+	int		ret;
+
+	ut_snprintf(dbpath, dbpath_len,
+		    "%s/%s", fil_path_to_mysql_datadir, dbname);
+	srv_normalize_path_for_win(dbpath);
+
+	/* A symlink may not point to a directory */
+	dbdir = os_file_opendir(dbpath, FALSE);
+
+	if (dbdir == NULL) {
+		mem_free(dbpath);
+		return;
+	}
+
+	ret = fil_file_readdir_next_file(err, dbpath, dbdir, &fileinfo);
+
+	while (ret == 0) {
+		ulint	len = strlen(fileinfo.name);
+
+		/* We found a symlink or a file ending in .ibd or .isl */
+		if (fileinfo.type != OS_FILE_TYPE_DIR
+		    && len > 4
+		    && (0 == strcmp(fileinfo.name + len - 4, ".ibd")
+			|| 0 == strcmp(fileinfo.name + len - 4, ".isl"))) {
+
+			fil_load_file_t	file;
+
+			file.db_name = dbname;
+			file.file_name = mem_strdup(fileinfo.name);
+			found->push_back(file);
+		}
+
+		ret = fil_file_readdir_next_file(err, dbpath, dbdir,
+						 &fileinfo);
+	}
+
+	if (0 != os_file_closedir(dbdir)) {
+		ib_logf(IB_LOG_LEVEL_WARN,
+			"Could not close database directory %s", dbpath);
+
+		*err = DB_ERROR;
+	}
+
+	mem_free(dbpath);
+}
+
+/********************************************************************//**
+Thread that scans database directories or loads tablespaces for
+fil_load_single_table_tablespaces().
+@return a dummy parameter */
+extern "C" UNIV_INTERN
+os_thread_ret_t
+DECLARE_THREAD(fil_load_thread)(
+/*============================*/
+	void*	arg)	/*!< in: fil_load_thread_t */
+{
+	fil_load_thread_t*	thread = static_cast<fil_load_thread_t*>(arg);
+	fil_load_work_t*	work = thread->work;
+	ulint			n_items = work->items.size();
+
+	for (;;) {
+		ulint	i = os_atomic_increment_ulint(&work->next, 1) - 1;
+
+		if (i >= n_items) {
+			break;
+		}
+
+		const fil_load_file_t&	item = work->items[i];
+
+		if (work->scan) {
+			fil_load_scan_database(
+				item.db_name, &thread->found, &thread->err);
+		} else {
+			fil_load_single_table_tablespace(
+				item.db_name, item.file_name);
+		}
+	}
+
+	os_event_set(thread->done);
+
+	os_thread_exit(NULL);
+
+	OS_THREAD_DUMMY_RETURN;
+}
+
+/********************************************************************//**
+Processes the items of a work with up to innobase_load_table_thread_num
+threads.
+@return DB_SUCCESS or DB_ERROR if a directory could not be read */
+static
+dberr_t
+fil_load_run_threads(
+/*=================*/
+	fil_load_work_t*	work,	/*!< in/out: work */
+	fil_load_files_t*	found)	/*!< out: files found when scanning
+					directories, or NULL */
+{
+	ulint	n_threads = ut_min(static_cast<ulint>(
+					   innobase_load_table_thread_num),
+				   work->items.size());
+	dberr_t	err = DB_SUCCESS;
+
+	if (n_threads == 0) {
+		return(err);
+	}
+
+	fil_load_thread_t*	threads = new fil_load_thread_t[n_threads];
+
+	work->next = 0;
+
+	for (ulint i = 0; i < n_threads; i++) {
+		threads[i].work = work;
+		threads[i].err = DB_SUCCESS;
+		threads[i].done = os_event_create();
+		os_thread_create(fil_load_thread, &threads[i], NULL);
+	}
+
+	for (ulint i = 0; i < n_threads; i++) {
+		os_event_wait(threads[i].done);
+		os_event_free(threads[i].done);
+
+		if (threads[i].err != DB_SUCCESS) {
+			err = threads[i].err;
+		}
+
+		if (found != NULL) {
+			found->insert(found->end(), threads[i].found.begin(),
+				      threads[i].found.end());
+		}
+	}
+
+	delete[] threads;
+
+	return(err);
 }
 
 /********************************************************************//**
@@ -5231,6 +5431,10 @@ single-table tablespaces. We need to know the space id in each of them so that
 we know into which file we should look to check the contents of a page stored
 in the doublewrite buffer, also to know where to apply log records where the
 space id is != 0.
+
+The directories are scanned, and the first page of the files read, by
+innobase_load_table_thread_num threads. The files are closed again: they
+are opened by fil_node_open_file() when a page is first accessed.
 @return	DB_SUCCESS or error number */
 UNIV_INTERN
 dberr_t
@@ -5238,17 +5442,12 @@ fil_load_single_table_tablespaces(void)
 /*===================================*/
 {
 	int		ret;
-	char*		dbpath		= NULL;
-	ulint		dbpath_len	= 100;
 	os_file_dir_t	dir;
-	os_file_dir_t	dbdir;
 	os_file_stat_t	dbinfo;
-	os_file_stat_t	fileinfo;
 	dberr_t		err		= DB_SUCCESS;
-  UT_LIST_BASE_NODE_T(table_file_node_t) table_file_list;
-  UT_LIST_INIT(table_file_list);
-  ulint database_num = 0;
-  hash_table_t *database_table = hash_create(50);
+	fil_load_work_t	work;
+	fil_load_files_t	files;
+
 	/* The datadir of MySQL is always the default directory of mysqld */
 
 	dir = os_file_opendir(fil_path_to_mysql_datadir, TRUE);
@@ -5258,159 +5457,67 @@ fil_load_single_table_tablespaces(void)
 		return(DB_ERROR);
 	}
 
-	dbpath = static_cast<char*>(mem_alloc(dbpath_len));
-
-	/* Scan all directories under the datadir. They are the database
-	directories of MySQL. */
+	/* List all directories under the datadir, and the symlinks that
+	may point to one. They are the database directories of MySQL. */
 
 	ret = fil_file_readdir_next_file(&err, fil_path_to_mysql_datadir, dir,
 					 &dbinfo);
 	while (ret == 0) {
-		ulint len;
-		/* printf("Looking at %s in datadir\n", dbinfo.name); */
+		if (dbinfo.type != OS_FILE_TYPE_FILE
+		    && dbinfo.type != OS_FILE_TYPE_UNKNOWN) {
 
-		if (dbinfo.type == OS_FILE_TYPE_FILE
-		    || dbinfo.type == OS_FILE_TYPE_UNKNOWN) {
+			fil_load_file_t	db;
 
-			goto next_datadir_item;
+			db.db_name = mem_strdup(dbinfo.name);
+			db.file_name = NULL;
+			work.items.push_back(db);
 		}
 
-		/* We found a symlink or a directory; try opening it to see
-		if a symlink is a directory */
-
-		len = strlen(fil_path_to_mysql_datadir)
-			+ strlen (dbinfo.name) + 2;
-		if (len > dbpath_len) {
-			dbpath_len = len;
-
-			if (dbpath) {
-				mem_free(dbpath);
-			}
-
-			dbpath = static_cast<char*>(mem_alloc(dbpath_len));
-		}
-		ut_snprintf(dbpath, dbpath_len,
-			    "%s/%s", fil_path_to_mysql_datadir, dbinfo.name);
-		srv_normalize_path_for_win(dbpath);
+		ret = fil_file_readdir_next_file(&err,
+						 fil_path_to_mysql_datadir,
+						 dir, &dbinfo);
+	}
 
-		dbdir = os_file_opendir(dbpath, FALSE);
+	/* Look for .ibd and .isl files in each database directory */
+	work.scan = true;
 
-		if (dbdir != NULL) {
+	if (fil_load_run_threads(&work, &files) != DB_SUCCESS) {
+		err = DB_ERROR;
+	}
 
-			/* We found a database directory; loop through it,
-			looking for possible .ibd files in it */
+	/* There may be both an .ibd and an .isl file for a table, and
+	fil_load_single_table_tablespace() looks at both: keep one of
+	them, so that a table is loaded by one thread only. */
+	std::sort(files.begin(), files.end(), fil_load_file_less());
 
-			ret = fil_file_readdir_next_file(&err, dbpath, dbdir,
-							 &fileinfo);
-			while (ret == 0) {
+	fil_load_work_t	load;
+	fil_load_file_less	less;
 
-				if (fileinfo.type == OS_FILE_TYPE_DIR) {
+	load.scan = false;
 
-					goto next_file_item;
-				}
+	for (fil_load_files_t::iterator it = files.begin();
+	     it != files.end(); ++it) {
 
-				/* We found a symlink or a file */
-				if (strlen(fileinfo.name) > 4
-				    && (0 == strcmp(fileinfo.name
-						   + strlen(fileinfo.name) - 4,
-						   ".ibd")
-					|| 0 == strcmp(fileinfo.name
-						   + strlen(fileinfo.name) - 4,
-						   ".isl"))) {
-					/* The name ends in .ibd or .isl;
-					try opening the file */
-
-          table_file_node_t* table_file_node =
-            static_cast<table_file_node_t*>(
-                mem_zalloc(sizeof(table_file_node_t))
-                );
-          table_file_node->db_name = mem_strdup(dbinfo.name);
-          table_file_node->file_name = mem_strdup(fileinfo.name);
-          database_node_t *database_node = NULL;
-          ulint fold = ut_fold_string(dbinfo.name);
-          HASH_SEARCH(name_hash, database_table, fold,
-              database_node_t*, database_node, ut_ad(database_node->db_name),
-              ut_strcmp(database_node->db_name, dbinfo.name) == 0);
-          if (database_node == NULL) {
-            database_node = static_cast<database_node_t*>(
-                mem_zalloc(sizeof(database_node_t)));
-            database_node->db_name = mem_strdup(dbinfo.name);
-            database_node->database_id = database_num;
-            database_num++;
-            HASH_INSERT(database_node_t, name_hash,
-                database_table, fold, database_node);
-          }
-          table_file_node->database_id = database_node->database_id;
-          UT_LIST_ADD_FIRST(table_file, table_file_list, table_file_node);
-				}
-next_file_item:
-				ret = fil_file_readdir_next_file(&err,
-								 dbpath, dbdir,
-								 &fileinfo);
-			}
+		if (!load.items.empty() && !less(load.items.back(), *it)) {
+			mem_free(it->file_name);
+		} else {
+			load.items.push_back(*it);
+		}
+	}
 
-			if (0 != os_file_closedir(dbdir)) {
-				fputs("InnoDB: Warning: could not"
-				      " close database directory ", stderr);
-				ut_print_filename(stderr, dbpath);
-				putc('\n', stderr);
+	/* Read the first page of the files and create the tablespaces */
+	fil_load_run_threads(&load, NULL);
 
-				err = DB_ERROR;
-			}
-		}
+	for (fil_load_files_t::iterator it = load.items.begin();
+	     it != load.items.end(); ++it) {
+		mem_free(it->file_name);
+	}
 
-next_datadir_item:
-		ret = fil_file_readdir_next_file(&err,
-						 fil_path_to_mysql_datadir,
-						 dir, &dbinfo);
+	for (fil_load_files_t::iterator it = work.items.begin();
+	     it != work.items.end(); ++it) {
+		mem_free(const_cast<char*>(it->db_name));
 	}
 
-  // parallelize read table file
-  thread_params *params = static_cast<thread_params*>(
-      mem_zalloc(innobase_load_table_thread_num * sizeof(thread_params)));
-  for (ulint i = 0;
-       i < innobase_load_table_thread_num && i < database_num;
-       ++i) {
-    params[i].task = &table_file_list;
-    params[i].task_id = i;
-    params[i].event = os_event_create();
-    os_thread_create(load_table_file, &params[i], NULL);
-  }
-
-  for (uint32 i = 0;
-       i < innobase_load_table_thread_num && i < database_num;
-       ++i) {
-    os_event_wait(params[i].event);
-    os_event_free(params[i].event);
-  }
-  mem_free(params);
-  // free space
-  ulint len = 0;
-  table_file_node_t *table_file_node = NULL;
-  for (len = UT_LIST_GET_LEN(table_file_list);
-       len > 0;
-       len = UT_LIST_GET_LEN(table_file_list)) {
-    table_file_node = UT_LIST_GET_FIRST(table_file_list);
-    mem_free(table_file_node->db_name);
-    mem_free(table_file_node->file_name);
-    UT_LIST_REMOVE(table_file, table_file_list, table_file_node);
-    mem_free(table_file_node);
-  }
-  ulint i;
-  for (i = 0; i < hash_get_n_cells(database_table); i++) {
-    database_node_t *database_node = NULL;
-    database_node = static_cast<database_node_t*>(
-        HASH_GET_FIRST(database_table, i));
-    while (database_node) {
-      database_node_t *prev_node = database_node;
-      database_node = static_cast<database_node_t*>(
-          HASH_GET_NEXT(name_hash, prev_node));
-      mem_free(prev_node->db_name);
-      mem_free(prev_node);
-    }
-  }
-  hash_table_free(database_table);
-	mem_free(dbpath);
 	if (0 != os_file_closedir(dir)) {
 		fprintf(stderr,
 			"InnoDB: Error: could not close MySQL datadir\n");
@@ -6293,6 +6400,16 @@ _fil_io(
 
 	space = fil_space_get_by_id(space_id);
 
+#ifndef UNIV_HOTBACKUP
+	/* The pages of a tablespace dropped with BUF_REMOVE_LAZY are not
+	written: the caller completes the write as if it was done. */
+	if (type == OS_FILE_WRITE && buf_LRU_space_is_stale(space_id)) {
+		mutex_exit(&fil_system->mutex);
+
+		return(DB_TABLESPACE_DELETED);
+	}
+#endif /* !UNIV_HOTBACKUP */
+
 	/* If we are deleting a tablespace we don't allow async read operations
 	on that. However, we do allow write and sync read operations */
 	if (space == 0
@@ -185,6 +185,10 @@ static char*	innobase_file_flush_method		= NULL;
 stopword table to be used */
 static char*	innobase_server_stopword_table		= NULL;
 
+/* Comma separated db.table list of the tables with an in-memory column
+store, see handler0mirror.h */
+static char*	innobase_col_mirror_tables		= NULL;
+
 /* Below we have boolean-valued start-up parameters, and their default
 values */
 
@@ -287,7 +291,9 @@ static mysql_pfs_key_t	commit_cond_key;
 
 static PSI_mutex_info	all_pthread_mutexes[] = {
 	{&commit_cond_mutex_key, "commit_cond_mutex", 0},
-	{&innobase_share_mutex_key, "innobase_share_mutex", 0}
+	{&innobase_share_mutex_key, "innobase_share_mutex", 0},
+	{&col_mirror_mutex_key, "col_mirror_mutex", 0},
+	{&col_mirror_list_mutex_key, "col_mirror_list_mutex", 0}
 };
 
 static PSI_cond_info	all_innodb_conds[] = {
@@ -780,6 +786,16 @@ static SHOW_VAR innodb_status_variables[]= {
   (char*) &export_vars.innodb_buffer_pool_neighbors_flushed_lru, SHOW_LONG},
   {"checkpoint_lsn",
   (char*) &export_vars.innodb_checkpoint_lsn,             SHOW_LONGLONG},
+  {"column_mirror_builds",
+  (char*) &export_vars.innodb_column_mirror_builds,	  SHOW_LONG},
+  {"column_mirror_bytes",
+  (char*) &export_vars.innodb_column_mirror_bytes,	  SHOW_LONG},
+  {"column_mirror_chunks_skipped",
+  (char*) &export_vars.innodb_column_mirror_chunks_skipped, SHOW_LONG},
+  {"column_mirror_rows_read",
+  (char*) &export_vars.innodb_column_mirror_rows_read,	  SHOW_LONG},
+  {"column_mirror_scans",
+  (char*) &export_vars.innodb_column_mirror_scans,	  SHOW_LONG},
   {"data_fsyncs",
   (char*) &export_vars.innodb_data_fsyncs,		  SHOW_LONG},
   {"data_fsync_seconds",
@@ -982,6 +998,10 @@ static SHOW_VAR innodb_status_variables[]= {
   (char*) &export_vars.innodb_row_recreations,		  SHOW_LONG},
   {"row_recreation_steps",
   (char*) &export_vars.innodb_row_recreation_steps,		  SHOW_LONG},
+  {"row_recreation_cache_hits",
+  (char*) &export_vars.innodb_row_recreation_cache_hits,	  SHOW_LONG},
+  {"row_recreation_undo_prefetches",
+  (char*) &export_vars.innodb_row_recreation_undo_prefetches,	  SHOW_LONG},
   {"rows_deleted",
   (char*) &export_vars.innodb_rows_deleted,		  SHOW_LONG},
   {"rows_inserted",
@@ -1657,8 +1677,10 @@ bool
 innobase_flush_logs(
 /*================*/
 	handlerton*	hton,		/*!< in: InnoDB handlerton */
-	ulonglong	target_lsn);	/*! <in: write/fsync redo to this lsn, or
+	ulonglong	target_lsn,	/*! <in: write/fsync redo to this lsn, or
 					 sync to max lsn if target_lsn = 0. */
+	bool*		durable);	/*!< out: set to false if the redo log
+					was not synced to target_lsn, or NULL */
 
 /************************************************************************//**
 Implements the SHOW ENGINE INNODB STATUS command. Sends the output of the
@@ -3128,10 +3150,16 @@ ha_innobase::ha_innobase(
 		  HA_BINLOG_ROW_CAPABLE |
 		  HA_CAN_GEOMETRY | HA_PARTIAL_COLUMN_READ |
 		  HA_TABLE_SCAN_ON_INDEX | HA_CAN_FULLTEXT |
-		  HA_CAN_FULLTEXT_EXT | HA_CAN_EXPORT | HA_ONLINE_ANALYZE),
+		  HA_CAN_FULLTEXT_EXT | HA_CAN_EXPORT | HA_ONLINE_ANALYZE |
+		  HA_HAS_RECORDS),
 	start_of_scan(0),
 	num_write_row(0),
-	ha_partition_stats(NULL)
+	ha_partition_stats(NULL),
+	mirror_scan(NULL),
+	mirror_mode(COL_MIRROR_SCAN_NONE),
+	mirror_cond(NULL),
+	mirror_layout(0),
+	mirror_heap(NULL)
 {}
 
 /*********************************************************************//**
@@ -4214,6 +4242,7 @@ innobase_change_buffering_inited_ok:
 	mysql_mutex_init(commit_cond_mutex_key,
 			 &commit_cond_m, MY_MUTEX_INIT_FAST);
 	mysql_cond_init(commit_cond_key, &commit_cond, NULL);
+	innobase_col_mirror_init(innobase_col_mirror_tables);
 	innodb_inited= 1;
 #ifdef MYSQL_DYNAMIC_PLUGIN
 	if (innobase_hton != p) {
@@ -4291,6 +4320,7 @@ innobase_end(
 		mysql_mutex_destroy(&innobase_share_mutex);
 		mysql_mutex_destroy(&commit_cond_m);
 		mysql_cond_destroy(&commit_cond);
+		innobase_col_mirror_close();
 	}
 
 	DBUG_RETURN(err);
@@ -4305,8 +4335,10 @@ bool
 innobase_flush_logs(
 /*================*/
 	handlerton*	hton,	/*!< in/out: InnoDB handlerton */
-	ulonglong	target_lsn)/*! <in: write/fsync redo to this lsn, or
+	ulonglong	target_lsn,/*! <in: write/fsync redo to this lsn, or
 				    sync to max lsn if target_lsn = 0 */
+	bool*		durable)/*!< out: set to false if the redo log
+				was not synced to target_lsn, or NULL */
 {
 	bool	result = 0;
 
@@ -4323,6 +4355,11 @@ innobase_flush_logs(
 					sync, sync ?
 					LOG_WRITE_FROM_COMMIT_SYNC :
 					LOG_WRITE_FROM_COMMIT_ASYNC);
+			if (!sync && durable != NULL) {
+				*durable = false;
+			}
+		} else if (durable != NULL) {
+			*durable = false;
 		}
 	}
 
@@ -6111,6 +6148,9 @@ table_opened:
 	info_low(HA_STATUS_NO_LOCK | HA_STATUS_VARIABLE | HA_STATUS_CONST,
 		 false /* not ANALYZE */);
 
+	mirror_layout = prebuilt->clust_index_was_generated
+		? 0 : innobase_col_mirror_layout(table);
+
 	if (no_trx) {
 		buf_pool_reference_end(trx);
 	}
@@ -6173,6 +6213,15 @@ ha_innobase::close()
 		innobase_release_temporary_latches(ht, thd);
 	}
 
+	innobase_col_mirror_scan_free(mirror_scan);
+	mirror_scan = NULL;
+	mirror_mode = COL_MIRROR_SCAN_NONE;
+
+	if (mirror_heap != NULL) {
+		mem_heap_free(mirror_heap);
+		mirror_heap = NULL;
+	}
+
 	row_prebuilt_free(prebuilt, FALSE);
 
 	if (upd_buf != NULL) {
@@ -7578,6 +7627,33 @@ ha_innobase::innobase_set_max_autoinc(
 	return(error);
 }
 
+/********************************************************************//**
+Stores a batch of rows in an InnoDB database. The rows are inserted one
+by one, but a row is inserted into the clustered index leaf page of the
+previous row without a descent down the tree when it belongs there, which
+is the common case for rows that are sorted by the primary key. That page
+is remembered until a row is inserted outside of a batch, so it is also
+used when a batch is passed one row per call.
+@return	error code */
+UNIV_INTERN
+int
+ha_innobase::write_rows(
+/*====================*/
+	uchar**	rows,		/*!< in: rows in MySQL format */
+	uint	n_rows,		/*!< in: number of rows */
+	uint*	n_written)	/*!< out: number of rows written */
+{
+	int	error;
+
+	DBUG_ENTER("ha_innobase::write_rows");
+
+	prebuilt->ins_batch = TRUE;
+	error = handler::write_rows(rows, n_rows, n_written);
+	prebuilt->ins_batch = FALSE;
+
+	DBUG_RETURN(error);
+}
+
 /********************************************************************//**
 Stores a row in an InnoDB database, to the table specified in this
 handle.
@@ -7592,6 +7668,7 @@ ha_innobase::write_row(
 	int		error_result= 0;
 	ibool		auto_inc_used= FALSE;
 	ulint		sql_command;
+	undo_no_t	undo_no;
 	trx_t*		trx = thd_to_trx(user_thd);
 
 	DBUG_ENTER("ha_innobase::write_row");
@@ -7731,12 +7808,20 @@ no_commit:
 
 	innobase_srv_conc_enter_innodb(prebuilt->trx, true);
 
+	undo_no = trx->undo_no;
+
 	error = row_insert_for_mysql((byte*) record, prebuilt);
 	DEBUG_SYNC(user_thd, "ib_after_row_insert");
 
-	if (error == DB_SUCCESS)
+	if (error == DB_SUCCESS) {
 		stats.rows_inserted++;
 
+		if (col_mirror_t* mirror = innobase_get_col_mirror(false)) {
+			innobase_col_mirror_capture(
+				mirror, trx, table, undo_no, NULL, record);
+		}
+	}
+
 	/* Handle duplicate key errors */
 	if (auto_inc_used) {
 		ulonglong	auto_inc;
@@ -8137,6 +8222,7 @@ ha_innobase::update_row(
 {
 	upd_t*		uvect;
 	dberr_t		error;
+	undo_no_t	undo_no;
 	trx_t*		trx = thd_to_trx(user_thd);
 
 	DBUG_ENTER("ha_innobase::update_row");
@@ -8192,11 +8278,22 @@ ha_innobase::update_row(
 
 	innobase_srv_conc_enter_innodb(trx, true);
 
+	undo_no = trx->undo_no;
+
 	error = row_update_for_mysql((byte*) old_row, prebuilt);
 
-	if (error == DB_SUCCESS)
+	if (error == DB_SUCCESS) {
 		stats.rows_updated++;
 
+		col_mirror_t*	mirror;
+
+		if (uvect->n_fields
+		    && (mirror = innobase_get_col_mirror(false))) {
+			innobase_col_mirror_capture(
+				mirror, trx, table, undo_no, old_row, new_row);
+		}
+	}
+
 	/* We need to do some special AUTOINC handling for the following case:
 
 	INSERT INTO t (c1,c2) VALUES(x,y) ON DUPLICATE KEY UPDATE ...
@@ -8272,6 +8369,7 @@ ha_innobase::delete_row(
 	const uchar*	record)	/*!< in: a row in MySQL format */
 {
 	dberr_t		error;
+	undo_no_t	undo_no;
 	trx_t*		trx = thd_to_trx(user_thd);
 
 	DBUG_ENTER("ha_innobase::delete_row");
@@ -8297,11 +8395,19 @@ ha_innobase::delete_row(
 
 	innobase_srv_conc_enter_innodb(trx, true);
 
+	undo_no = trx->undo_no;
+
 	error = row_update_for_mysql((byte*) record, prebuilt);
 
-	if (error == DB_SUCCESS)
+	if (error == DB_SUCCESS) {
 		stats.rows_deleted++;
 
+		if (col_mirror_t* mirror = innobase_get_col_mirror(false)) {
+			innobase_col_mirror_capture(
+				mirror, trx, table, undo_no, record, NULL);
+		}
+	}
+
 	innobase_srv_conc_exit_innodb(trx, true);
 
 	/* Tell the InnoDB server that there might be work for
@@ -8711,6 +8817,64 @@ ha_innobase::index_read(
 	DBUG_RETURN(error);
 }
 
+/**********************************************************************//**
+Issues asynchronous reads for the index pages a following index_read()
+with the same key and search flag will access.
+@return	true if reads are pending and calling again would read further
+down the index tree */
+UNIV_INTERN
+bool
+ha_innobase::index_read_prefetch(
+/*=============================*/
+	const uchar*	key_ptr,	/*!< in: key value, or NULL to
+					prefetch the start or end of index */
+	key_part_map	keypart_map,	/*!< in: key parts used in key_ptr */
+	enum ha_rkey_function find_flag)/*!< in: search flags from my_base.h */
+{
+	dict_index_t*	index;
+	ulint		mode;
+
+	DBUG_ENTER("ha_innobase::index_read_prefetch");
+
+	index = prebuilt->index;
+
+	if (index == NULL
+	    || !prebuilt->index_usable
+	    || dict_index_is_corrupted(index)
+	    || (index->type & DICT_FTS)
+	    || index->page == FIL_NULL
+	    || prebuilt->table->ibd_file_missing) {
+		DBUG_RETURN(false);
+	}
+
+	mode = convert_search_mode_to_innobase(find_flag);
+
+	if (mode == PAGE_CUR_UNSUPP) {
+		DBUG_RETURN(false);
+	}
+
+	if (key_ptr) {
+		uint	key_len = calculate_key_len(
+			table, active_index, key_ptr, keypart_map);
+
+		/* index_read() converts the key again into the same
+		tuple before searching. */
+		row_sel_convert_mysql_key_to_innobase(
+			prebuilt->search_tuple,
+			prebuilt->srch_key_val1,
+			prebuilt->srch_key_val_len,
+			index,
+			(byte*) key_ptr,
+			(ulint) key_len,
+			prebuilt->trx);
+	} else {
+		dtuple_set_n_fields(prebuilt->search_tuple, 0);
+	}
+
+	DBUG_RETURN(btr_cur_prefetch_path(
+			    index, prebuilt->search_tuple, mode));
+}
+
 /*******************************************************************//**
 The following functions works like index_read, but it find the last
 row with the current key value or prefix.
@@ -8813,6 +8977,31 @@ ha_innobase::innobase_get_index(
 	DBUG_RETURN(index);
 }
 
+/********************************************************************//**
+Gets the column store of the table of a handle, see handler0mirror.h.
+@return	column store, or NULL if the table has none or, for_read, if the
+current read of the handle cannot use it */
+UNIV_INTERN
+col_mirror_t*
+ha_innobase::innobase_get_col_mirror(
+/*=================================*/
+	bool	for_read)	/*!< in: true for a consistent read */
+{
+	if (mirror_layout == 0) {
+		return(NULL);
+	}
+
+	if (for_read
+	    && (prebuilt->select_lock_type != LOCK_NONE
+		|| prebuilt->trx->isolation_level
+		<= TRX_ISO_READ_UNCOMMITTED)) {
+		return(NULL);
+	}
+
+	return(innobase_col_mirror_get(prebuilt->table, table,
+				       mirror_layout));
+}
+
 /********************************************************************//**
 Changes the active index of a handle.
 @return	0 or error code */
@@ -9128,7 +9317,31 @@ ha_innobase::rnd_init(
 /*==================*/
 	bool	scan)	/*!< in: TRUE if table/index scan FALSE otherwise */
 {
-	int	err;
+	int		err;
+	col_mirror_t*	mirror;
+
+	innobase_col_mirror_scan_end(mirror_scan, false);
+	mirror_mode = COL_MIRROR_SCAN_NONE;
+
+	/* A consistent read of the whole table may be served from the
+	column store of the table, or build it */
+
+	if (scan && !prebuilt->read_just_key
+	    && (mirror = innobase_get_col_mirror(true))) {
+
+		trx_start_if_not_started(prebuilt->trx);
+		trx_assign_read_view(prebuilt->trx);
+
+		mirror_mode = innobase_col_mirror_scan_start(
+			&mirror_scan, mirror, prebuilt->trx, table,
+			mirror_cond);
+
+		if (mirror_mode == COL_MIRROR_SCAN_BUILD) {
+			/* The store is built from whole rows */
+			prebuilt->hint_need_to_fetch_extra_cols
+				= ROW_RETRIEVE_ALL_COLS;
+		}
+	}
 
 	/* Store the active index value so that we can restore the original
 	value after a scan */
@@ -9159,6 +9372,9 @@ int
 ha_innobase::rnd_end(void)
 /*======================*/
 {
+	innobase_col_mirror_scan_end(mirror_scan, false);
+	mirror_mode = COL_MIRROR_SCAN_NONE;
+
 	return(index_end());
 }
 
@@ -9178,6 +9394,25 @@ ha_innobase::rnd_next(
 	DBUG_ENTER("rnd_next");
 	ha_statistic_increment(&SSV::ha_read_rnd_next_count);
 
+	if (mirror_mode == COL_MIRROR_SCAN_READ) {
+		error = innobase_col_mirror_scan_next(
+			mirror_scan, buf, &mirror_heap);
+
+		stats.rows_requested++;
+		if (error) {
+			table->status = STATUS_NOT_FOUND;
+		} else {
+			table->status = 0;
+			srv_stats.n_rows_read.add(
+				(size_t) prebuilt->trx->id, 1);
+			srv_stats.n_col_mirror_rows_read.add(
+				(size_t) prebuilt->trx->id, 1);
+			stats.rows_read++;
+		}
+
+		DBUG_RETURN(error);
+	}
+
 	if (start_of_scan) {
 		error = index_first(buf);
 
@@ -9195,6 +9430,15 @@ ha_innobase::rnd_next(
 		}
 	}
 
+	if (mirror_mode == COL_MIRROR_SCAN_BUILD) {
+		if (!error) {
+			innobase_col_mirror_scan_add(mirror_scan, buf);
+		} else if (error == HA_ERR_END_OF_FILE) {
+			innobase_col_mirror_scan_end(mirror_scan, true);
+			mirror_mode = COL_MIRROR_SCAN_NONE;
+		}
+	}
+
 	DBUG_RETURN(error);
 }
 
@@ -11194,6 +11438,8 @@ ha_innobase::discard_or_import_tablespace(
 	/* Commit the transaction in order to release the table lock. */
 	trx_commit_for_mysql(prebuilt->trx);
 
+	innobase_col_mirror_reset(dict_table);
+
 	if (err == DB_SUCCESS && !discard
 	    && dict_stats_is_persistent_enabled(dict_table)) {
 		dberr_t		ret;
@@ -11245,6 +11491,8 @@ ha_innobase::truncate()
 
 	err = row_truncate_table_for_mysql(prebuilt->table, prebuilt->trx);
 
+	innobase_col_mirror_reset(prebuilt->table);
+
 	switch (err) {
 
 	case DB_TABLESPACE_DELETED:
@@ -11895,6 +12143,31 @@ func_exit:
 	DBUG_RETURN((ha_rows) n_rows);
 }
 
+/*********************************************************************//**
+Counts the rows of the table a consistent read sees, for COUNT(*) without
+a condition. Only a table with a column store counts them without a scan.
+@return	number of rows, or HA_POS_ERROR */
+UNIV_INTERN
+ha_rows
+ha_innobase::records()
+/*==================*/
+{
+	col_mirror_t*	mirror;
+
+	DBUG_ENTER("ha_innobase::records");
+
+	update_thd(ha_thd());
+
+	if (!(mirror = innobase_get_col_mirror(true))) {
+		DBUG_RETURN(HA_POS_ERROR);
+	}
+
+	trx_start_if_not_started(prebuilt->trx);
+	trx_assign_read_view(prebuilt->trx);
+
+	DBUG_RETURN(innobase_col_mirror_count(mirror, prebuilt->trx));
+}
+
 /*********************************************************************//**
 Gives an UPPER BOUND to the number of rows in a table. This is used in
 filesort.cc.
@@ -13325,6 +13598,43 @@ ha_innobase::referenced_by_foreign_key(void)
 	return(0);
 }
 
+/*******************************************************************//**
+Checks if a foreign key is defined on the table (index == MAX_KEY) or if a
+foreign key uses the given index.
+@return	true if a foreign key is defined on the table or index */
+UNIV_INTERN
+bool
+ha_innobase::is_fk_defined_on_table_or_index(
+/*=========================================*/
+	uint	index)	/*!< in: index number or MAX_KEY */
+{
+	const dict_table_t*	table = prebuilt->table;
+
+	if (index == MAX_KEY) {
+		return(!table->foreign_set.empty()
+		       || !table->referenced_set.empty());
+	}
+
+	const dict_index_t*	dict_index = innobase_get_index(index);
+
+	for (dict_foreign_set::const_iterator it = table->foreign_set.begin();
+	     it != table->foreign_set.end(); ++it) {
+		if ((*it)->foreign_index == dict_index) {
+			return(true);
+		}
+	}
+
+	for (dict_foreign_set::const_iterator it
+		     = table->referenced_set.begin();
+	     it != table->referenced_set.end(); ++it) {
+		if ((*it)->referenced_index == dict_index) {
+			return(true);
+		}
+	}
+
+	return(false);
+}
+
 /*******************************************************************//**
 Frees the foreign key create info for a table stored in InnoDB, if it is
 non-NULL. */
@@ -13420,6 +13730,10 @@ ha_innobase::reset()
 	/* This is a statement level counter. */
 	prebuilt->autoinc_last_value = 0;
 
+	innobase_col_mirror_scan_end(mirror_scan, false);
+	mirror_mode = COL_MIRROR_SCAN_NONE;
+	mirror_cond = NULL;
+
 	return(0);
 }
 
@@ -15808,6 +16122,28 @@ innodb_monitor_gaplock_query_filename_update(
 	const void*)
 {}
 
+/****************************************************************//**
+Update the system variable innodb_column_mirror_tables. The tables
+removed from the list drop their column store when they are next used. */
+static
+void
+innodb_column_mirror_tables_update(
+/*===============================*/
+	THD*				thd,	/*!< in: thread handle */
+	struct st_mysql_sys_var*	var,	/*!< in: pointer to
+						system variable */
+	void*				var_ptr,/*!< out: where the
+						formal string goes */
+	const void*			save)	/*!< in: immediate result
+						from check function */
+{
+	char*	tables = *static_cast<char*const*>(save);
+
+	*static_cast<char**>(var_ptr) = tables;
+
+	innobase_col_mirror_set_tables(tables);
+}
+
 /*************************************************************//**
 Check if valid argument to innodb_file_format_max. This function
 is registered as a callback with MySQL.
@@ -17778,6 +18114,35 @@ static MYSQL_SYSVAR_ULONG(purge_threads, srv_n_purge_threads,
   1,			/* Minimum value */
   32, 0);		/* Maximum value */
 
+static MYSQL_SYSVAR_ULONG(rollback_threads, srv_n_rollback_threads,
+  PLUGIN_VAR_RQCMDARG | PLUGIN_VAR_READONLY,
+  "Number of threads rolling back the transactions left incomplete by a "
+  "crash. Transactions are rolled back in parallel, and the undo records "
+  "of large transactions are split among the threads by table and primary "
+  "key. Default is 1.",
+  NULL, NULL,
+  1,			/* Default setting */
+  1,			/* Minimum value */
+  64, 0);		/* Maximum value */
+
+static MYSQL_SYSVAR_ULONG(mvcc_version_cache_size, srv_mvcc_version_cache_size,
+  PLUGIN_VAR_RQCMDARG,
+  "Largest size in bytes of the old versions of rows a consistent read view "
+  "keeps, so that reading a row again in the view does not apply its undo "
+  "log records again. The versions are freed when the view is closed. "
+  "0 disables the cache. Default is 0.",
+  NULL, NULL,
+  0,			/* Default setting */
+  0,			/* Minimum value */
+  ULONG_MAX, 0);	/* Maximum value */
+
+static MYSQL_SYSVAR_BOOL(mvcc_undo_prefetch, srv_mvcc_undo_prefetch,
+  PLUGIN_VAR_OPCMDARG,
+  "Read ahead the undo log pages needed to build the old versions of the "
+  "rows of a clustered index page when a consistent read first builds an "
+  "old version on the page.",
+  NULL, NULL, TRUE);
+
 static MYSQL_SYSVAR_ULONG(sync_array_size, srv_sync_array_size,
   PLUGIN_VAR_OPCMDARG | PLUGIN_VAR_READONLY,
   "Size of the mutex/lock wait array.",
@@ -18132,6 +18497,13 @@ static MYSQL_SYSVAR_BOOL(buffer_pool_populate, srv_buf_pool_populate,
   "established by the buffer pool memory region. Disabled by default.",
   NULL, NULL, FALSE);
 
+static MYSQL_SYSVAR_BOOL(lazy_drop_tablespace, srv_buf_lazy_drop,
+  PLUGIN_VAR_OPCMDARG,
+  "Leave the buffer pool pages of a dropped, truncated or discarded "
+  "file-per-table tablespace to be freed in the background, instead of "
+  "scanning the buffer pool for them in the DROP. Disabled by default.",
+  NULL, NULL, FALSE);
+
 static MYSQL_SYSVAR_LONG(buffer_pool_instances, innobase_buffer_pool_instances,
   PLUGIN_VAR_RQCMDARG | PLUGIN_VAR_READONLY,
   "Number of buffer pool instances, set to higher value on high-end machines to increase scalability",
@@ -18274,6 +18646,22 @@ static MYSQL_SYSVAR_ULONG(commit_concurrency, innobase_commit_concurrency,
   "Helps in performance tuning in heavily concurrent environments.",
   innobase_commit_concurrency_validate, NULL, 0, 0, 1000, 0);
 
+static MYSQL_SYSVAR_STR(column_mirror_tables, innobase_col_mirror_tables,
+  PLUGIN_VAR_RQCMDARG | PLUGIN_VAR_MEMALLOC,
+  "Comma separated list of db.table InnoDB tables kept in memory by "
+  "column for consistent table scans and COUNT(*).",
+  NULL, innodb_column_mirror_tables_update, NULL);
+
+static MYSQL_SYSVAR_ULONGLONG(column_mirror_max_size, srv_col_mirror_max_size,
+  PLUGIN_VAR_RQCMDARG,
+  "Largest size in bytes of the in-memory column stores of the tables of "
+  "innodb_column_mirror_tables. A store which does not fit is not kept. "
+  "Default is 1GB.",
+  NULL, NULL,
+  1ULL << 30,		/* Default setting */
+  0,			/* Minimum value */
+  ULONGLONG_MAX, 0);	/* Maximum value */
+
 static MYSQL_SYSVAR_ULONG(concurrency_tickets, srv_n_free_tickets_to_enter,
   PLUGIN_VAR_RQCMDARG,
   "Number of times a thread is allowed to enter InnoDB within the same SQL query after it has once got the ticket",
@@ -18445,7 +18833,8 @@ static MYSQL_SYSVAR_ULONGLONG(txlog_init_rate, os_txlog_init_rate,
 
 static MYSQL_SYSVAR_UINT(load_table_thread_num, innobase_load_table_thread_num,
   PLUGIN_VAR_RQCMDARG,
-  "thread num of loading table file during crash recovery.",
+  "Number of threads that scan the database directories and read the "
+  "first page of the .ibd files during crash recovery.",
   NULL, NULL, 10, 1, 256, 0);
 
 static MYSQL_SYSVAR_ULONG(thread_concurrency, srv_thread_concurrency,
@@ -18836,6 +19225,7 @@ static struct st_mysql_sys_var* innobase_system_variables[]= {
   MYSQL_SYSVAR(autoextend_increment),
   MYSQL_SYSVAR(buffer_pool_size),
   MYSQL_SYSVAR(buffer_pool_populate),
+  MYSQL_SYSVAR(lazy_drop_tablespace),
   MYSQL_SYSVAR(buffer_pool_chunk_size),
   MYSQL_SYSVAR(sync_pool_size),
   MYSQL_SYSVAR(buffer_pool_instances),
@@ -18873,6 +19263,8 @@ static struct st_mysql_sys_var* innobase_system_variables[]= {
   MYSQL_SYSVAR(checksum_algorithm),
   MYSQL_SYSVAR(checksums),
   MYSQL_SYSVAR(commit_concurrency),
+  MYSQL_SYSVAR(column_mirror_max_size),
+  MYSQL_SYSVAR(column_mirror_tables),
   MYSQL_SYSVAR(concurrency_tickets),
   MYSQL_SYSVAR(compression_level),
   MYSQL_SYSVAR(data_file_path),
@@ -18998,6 +19390,9 @@ static struct st_mysql_sys_var* innobase_system_variables[]= {
   MYSQL_SYSVAR(monitor_reset_all),
   MYSQL_SYSVAR(purge_threads),
   MYSQL_SYSVAR(purge_batch_size),
+  MYSQL_SYSVAR(rollback_threads),
+  MYSQL_SYSVAR(mvcc_version_cache_size),
+  MYSQL_SYSVAR(mvcc_undo_prefetch),
 #ifdef UNIV_DEBUG
   MYSQL_SYSVAR(purge_run_now),
   MYSQL_SYSVAR(purge_stop_now),
@@ -19363,6 +19758,30 @@ ha_innobase::idx_cond_push(
 	DBUG_RETURN(NULL);
 }
 
+/** Push down a table condition. The table scans served from the column
+store of the table skip the rows its comparisons of integer columns with
+constants rule out; the condition is still evaluated by the server.
+* @param[in] cond	Condition to be checked
+* @return cond */
+UNIV_INTERN
+const Item*
+ha_innobase::cond_push(
+	const Item*	cond)
+{
+	DBUG_ENTER("ha_innobase::cond_push");
+
+	mirror_cond = cond;
+	DBUG_RETURN(cond);
+}
+
+/** Pop the condition pushed by cond_push(). */
+UNIV_INTERN
+void
+ha_innobase::cond_pop()
+{
+	mirror_cond = NULL;
+}
+
 /******************************************************************//**
 Use this when the args are passed to the format string from
 errmsg-utf8.txt directly as is.
@@ -24,6 +24,7 @@ this program; if not, write to the Free Software Foundation, Inc.,
 */
 
 #include "dict0stats.h"
+#include "handler0mirror.h"
 
 /* Structure defines translation table between mysql index and innodb
 index structures */
@@ -84,6 +85,17 @@ class ha_innobase: public handler
 	uint		num_write_row;	/*!< number of write_row() calls */
 	ha_statistics*	ha_partition_stats; /*!< stats of the partition owner
 					handler (if there is one) */
+	col_mirror_scan_t* mirror_scan;	/*!< state of the table scans using
+					the column store, or NULL */
+	col_mirror_scan_mode mirror_mode;/*!< how the current table scan
+					uses the column store */
+	const Item*	mirror_cond;	/*!< condition pushed by cond_push(),
+					or NULL */
+	ulint		mirror_layout;	/*!< innobase_col_mirror_layout() of
+					the table, 0 if it cannot have a
+					column store */
+	mem_heap_t*	mirror_heap;	/*!< heap for the BLOBs of the rows
+					read from the column store, or NULL */
 
 	uint store_key_val_for_row(uint keynr, char* buff, uint buff_len,
                                    const uchar* record);
@@ -98,6 +110,7 @@ class ha_innobase: public handler
 	dberr_t innobase_get_autoinc(ulonglong* value);
 	void innobase_initialize_autoinc();
 	dict_index_t* innobase_get_index(uint keynr);
+	col_mirror_t* innobase_get_col_mirror(bool for_read);
 
 	inline void init_trx_table_stats(trx_t* trx, bool write);
 	inline void update_stats_from_trx(trx_t* trx, bool write);
@@ -133,6 +146,7 @@ class ha_innobase: public handler
 	longlong get_memory_buffer_size() const;
 
 	int write_row(uchar * buf);
+	int write_rows(uchar** rows, uint n_rows, uint* n_written);
 	int update_row(const uchar * old_data, uchar * new_data);
 	int delete_row(const uchar * buf);
 	bool was_semi_consistent_read();
@@ -148,6 +162,8 @@ class ha_innobase: public handler
 	int index_read_idx(uchar * buf, uint index, const uchar * key,
 			   uint key_len, enum ha_rkey_function find_flag);
 	int index_read_last(uchar * buf, const uchar * key, uint key_len);
+	bool index_read_prefetch(const uchar * key, key_part_map keypart_map,
+				 enum ha_rkey_function find_flag);
 	int index_next(uchar * buf);
 	int index_next_same(uchar * buf, const uchar *key, uint keylen);
 	int index_prev(uchar * buf);
@@ -178,6 +194,7 @@ class ha_innobase: public handler
 	ha_rows records_in_range(uint inx, key_range *min_key, key_range
 								*max_key);
 	ha_rows estimate_rows_upper_bound();
+	ha_rows records();
 
 	void update_create_info(HA_CREATE_INFO* create_info);
 	int parse_table_name(const char*name,
@@ -202,6 +219,7 @@ class ha_innobase: public handler
 					List<FOREIGN_KEY_INFO> *f_key_list);
 	bool can_switch_engines();
 	uint referenced_by_foreign_key();
+	bool is_fk_defined_on_table_or_index(uint index);
 	void free_foreign_key_create_info(char* str);
 	THR_LOCK_DATA **store_lock_with_x_type(THD *thd, THR_LOCK_DATA **to,
 					enum thr_lock_type lock_type,
@@ -385,6 +403,9 @@ public:
 	*/
 	class Item* idx_cond_push(uint keyno, class Item* idx_cond);
 
+	const Item* cond_push(const Item* cond);
+	void cond_pop();
+
 private:
 	/** The multi range read session object */
 	DsMrr_impl ds_mrr;
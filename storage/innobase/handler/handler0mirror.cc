@@ -0,0 +1,2291 @@
+/*****************************************************************************
+
+Copyright (c) 2020, Facebook, Inc. All Rights Reserved.
+
+This program is free software; you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation; version 2 of the License.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program; if not, write to the Free Software Foundation, Inc.,
+51 Franklin Street, Suite 500, Boston, MA 02110-1335 USA
+
+*****************************************************************************/
+
+/**************************************************//**
+@file handler/handler0mirror.cc
+In-memory column stores of InnoDB tables, see handler0mirror.h
+*******************************************************/
+
+#include <sql_class.h>
+#include <item_cmpfunc.h>
+
+#include "ha_prototypes.h"
+#include "handler0mirror.h"
+#include "dict0dict.h"
+#include "read0read.h"
+#include "srv0srv.h"
+#include "trx0sys.h"
+#include "trx0trx.h"
+#include "ut0rnd.h"
+
+#include <algorithm>
+#include <atomic>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#ifdef HAVE_PSI_INTERFACE
+UNIV_INTERN mysql_pfs_key_t	col_mirror_mutex_key;
+UNIV_INTERN mysql_pfs_key_t	col_mirror_list_mutex_key;
+#endif /* HAVE_PSI_INTERFACE */
+
+/** Number of delta rows of a block of a column store */
+#define COL_MIRROR_DELTA_BLOCK		4096
+
+/** Location of a row of a column store in the delta rows rather than in
+the base */
+#define COL_MIRROR_IN_DELTA		((ib_uint64_t) 1 << 63)
+
+/** Most changes kept for a column store being built, before its build is
+started over */
+#define COL_MIRROR_MAX_PENDING		(1024 * 1024)
+
+/** The base of a column store is built again when its delta rows are more
+than a quarter of its base rows and this */
+#define COL_MIRROR_REBUILD_DELTAS	10000
+
+/** A column store is dropped when its delta rows are more than twice its
+base rows and this */
+#define COL_MIRROR_DROP_DELTAS		100000
+
+/** Bytes counted for an entry of col_mirror_snapshot_t::rows, besides the
+primary key */
+#define COL_MIRROR_ROW_OVERHEAD		64
+
+/** Bytes of the snapshots of all the column stores, see
+col_mirror_snapshot_t::size */
+static std::atomic<ulint>		col_mirror_bytes(0);
+
+/** Protects col_mirror_list */
+static mysql_mutex_t			col_mirror_list_mutex;
+
+/** The tables of innodb_column_mirror_tables, as db.table */
+static std::vector<std::string>		col_mirror_list;
+
+/** Incremented when innodb_column_mirror_tables changes, the tables check
+the list again when dict_table_t::col_mirror_version differs */
+static std::atomic<ulint>		col_mirror_list_version(1);
+
+/** How a column is kept */
+enum col_mirror_kind {
+	COL_MIRROR_INT,		/*!< integer, bit-packed */
+	COL_MIRROR_FIXED,	/*!< fixed length bytes */
+	COL_MIRROR_VARCHAR,	/*!< length and bytes of a VARCHAR */
+	COL_MIRROR_BLOB		/*!< bytes of a BLOB or TEXT */
+};
+
+/** A row change captured for a column store */
+struct col_mirror_change_t {
+	col_mirror_t*	mirror;		/*!< column store */
+	ulint		generation;	/*!< col_mirror_t::generation when
+					the change was captured */
+	undo_no_t	undo_no;	/*!< undo number of the change in the
+					transaction */
+	trx_id_t	trx_id;		/*!< id of the transaction, once
+					committed */
+	std::string	pk;		/*!< primary key of the row */
+	std::string	image;		/*!< row after the change, empty if
+					it was deleted */
+};
+
+/** The changes of a transaction to tables with a column store, in the
+order they were made */
+struct col_mirror_trx_t {
+	std::vector<col_mirror_change_t>	changes;
+};
+
+/** A delta row of a column store */
+struct col_mirror_delta_t {
+	trx_id_t	trx_id;		/*!< transaction which created the
+					version */
+	std::atomic<trx_id_t>
+			next_trx;	/*!< transaction which replaced or
+					deleted the version, or 0 */
+	bool		replaces;	/*!< true if the version replaced an
+					earlier version of the row */
+	std::string	image;		/*!< row, or empty if the version
+					marks the deletion of the row */
+};
+
+/** A column of a chunk of the base of a column store */
+struct col_mirror_chunk_t {
+	ib_uint64_t		min_key;/*!< smallest key of the integers
+					which are not NULL */
+	ib_uint64_t		max_key;/*!< largest key of the integers
+					which are not NULL */
+	ulint			n_not_null;
+					/*!< number of values not NULL */
+	ulint			bits;	/*!< bits of the packed integers */
+	std::vector<ib_uint64_t>
+				packed;	/*!< integer keys less min_key */
+	std::vector<uint32>	offsets;/*!< offsets of the values in data,
+					and of its end */
+	std::string		data;	/*!< values other than integers */
+	std::vector<byte>	nulls;	/*!< bitmap of the NULL values, or
+					empty if there are none */
+};
+
+/** A column of the base of a column store */
+struct col_mirror_column_t {
+	col_mirror_kind		kind;	/*!< how the column is kept */
+	bool			is_unsigned;
+					/*!< true for unsigned integers */
+	ulint			offset;	/*!< offset in the MySQL row */
+	ulint			length;	/*!< length in the MySQL row, or
+					the length of the length of BLOBs and
+					VARCHARs */
+	ulint			null_offset;
+					/*!< offset of the NULL bit */
+	byte			null_bit;
+					/*!< NULL bit, 0 if NOT NULL */
+	std::vector<col_mirror_chunk_t>
+				chunks;	/*!< the chunks */
+};
+
+/** The transactions a read view sees */
+struct col_mirror_view_t {
+	trx_id_t		low_limit_id;
+					/*!< read_view_t::low_limit_id */
+	trx_id_t		up_limit_id;
+					/*!< read_view_t::up_limit_id */
+	std::vector<trx_id_t>	ids;	/*!< read_view_t::trx_ids and the
+					creator, in ascending order */
+
+	/** @return true if the view sees the changes of a transaction */
+	bool sees(trx_id_t trx_id) const
+	{
+		if (trx_id < up_limit_id) {
+			return(true);
+		} else if (trx_id >= low_limit_id) {
+			return(false);
+		}
+		return(!std::binary_search(ids.begin(), ids.end(), trx_id));
+	}
+};
+
+/** Rows of a column store. A snapshot is not changed once installed,
+except for the delta rows appended and next_trx. */
+struct col_mirror_snapshot_t {
+	ulint			ref_count;
+					/*!< number of users, protected by
+					col_mirror_t::mutex */
+	col_mirror_view_t	view;	/*!< view the base rows were read
+					with */
+	ulint			n_rows;	/*!< number of base rows */
+	std::vector<col_mirror_column_t>
+				columns;/*!< columns of the base rows */
+	std::atomic<trx_id_t>*	next_trx;
+					/*!< transaction which replaced or
+					deleted each base row, or 0 */
+	ulint			n_next_trx;
+					/*!< size of next_trx */
+	std::vector<col_mirror_delta_t*>
+				blocks;	/*!< blocks of the delta rows,
+					protected by col_mirror_t::mutex */
+	ulint			n_deltas;
+					/*!< number of delta rows, protected
+					by col_mirror_t::mutex */
+	std::unordered_map<std::string, ib_uint64_t>
+				rows;	/*!< location of the latest version
+					of each row by primary key, base row
+					or COL_MIRROR_IN_DELTA | delta row,
+					protected by col_mirror_t::mutex */
+	ulint			size;	/*!< bytes of the snapshot counted
+					in col_mirror_bytes, protected by
+					col_mirror_t::mutex once installed */
+
+	col_mirror_snapshot_t() :
+		ref_count(1), n_rows(0), next_trx(NULL), n_next_trx(0),
+		n_deltas(0), size(0) {}
+
+	~col_mirror_snapshot_t()
+	{
+		for (ulint i = 0; i < blocks.size(); i++) {
+			delete[] blocks[i];
+		}
+		delete[] next_trx;
+		col_mirror_bytes -= size;
+	}
+
+	/** Counts memory allocated for the snapshot */
+	void grow(ulint n)
+	{
+		size += n;
+		col_mirror_bytes += n;
+	}
+
+	/** @return a delta row */
+	col_mirror_delta_t* delta(ulint i) const
+	{
+		return(&blocks[i / COL_MIRROR_DELTA_BLOCK]
+		       [i % COL_MIRROR_DELTA_BLOCK]);
+	}
+};
+
+/** Column store of a table */
+struct col_mirror_t {
+	mysql_mutex_t		mutex;	/*!< protects the fields below,
+					and the ones of the snapshot marked
+					so */
+	std::atomic<bool>	listed;	/*!< true if the table is in
+					innodb_column_mirror_tables */
+	std::atomic<bool>	capturing;
+					/*!< true if writes to the table are
+					captured */
+	std::atomic<bool>	api_written;
+					/*!< true if rows were written
+					through the InnoDB API, which the
+					capture does not see: the table is
+					not kept any more */
+	std::atomic<ulint>	generation;
+					/*!< incremented when the rows are
+					dropped, changes captured before are
+					ignored */
+	std::atomic<ulint>	layout;	/*!< innobase_col_mirror_layout() of
+					the rows kept, or 0 */
+	col_mirror_snapshot_t*	snapshot;
+					/*!< the rows, or NULL */
+	bool			pending_active;
+					/*!< true if committed changes are
+					kept in pending for a build */
+	trx_id_t		pending_mark;
+					/*!< changes of transactions with a
+					smaller id may be missing from
+					pending */
+	ulint			pending_epoch;
+					/*!< incremented when pending is
+					started over */
+	std::vector<col_mirror_change_t>
+				pending;/*!< committed changes to apply to
+					the snapshot being built */
+	bool			building;
+					/*!< true if a scan builds a
+					snapshot */
+};
+
+/** A full table scan on a table with a column store */
+struct col_mirror_scan_t {
+	col_mirror_scan_mode	mode;	/*!< how the scan uses the store */
+	col_mirror_t*		mirror;	/*!< the store */
+	const TABLE*		table;	/*!< MySQL table */
+	const read_view_t*	view;	/*!< read view of the scan */
+	col_mirror_snapshot_t*	snapshot;
+					/*!< snapshot read or built */
+	ulint			generation;
+					/*!< col_mirror_t::generation at
+					the start of a build */
+	ulint			epoch;	/*!< col_mirror_t::pending_epoch at
+					the start of a build */
+
+	/* Reads */
+	std::vector<col_mirror_delta_t*>
+				blocks;	/*!< blocks of the delta rows */
+	ulint			n_deltas;
+					/*!< delta rows read */
+	ulint			row;	/*!< next base row */
+	ulint			delta;	/*!< next delta row */
+	ulint			chunk;	/*!< chunk of the base row keys and
+					sel are for, or ULINT_UNDEFINED */
+	std::vector<ulint>	fields;	/*!< columns to read */
+	std::vector<ib_uint64_t>
+				keys;	/*!< keys of the integer columns to
+					read, by COL_MIRROR_CHUNK_ROWS */
+	std::vector<ulint>	ranges;	/*!< column of each range */
+	std::vector<ib_uint64_t>
+				lows;	/*!< smallest key of each range */
+	std::vector<ib_uint64_t>
+				highs;	/*!< largest key of each range */
+	bool			empty;	/*!< true if a range is empty */
+	byte			sel[COL_MIRROR_CHUNK_ROWS];
+					/*!< rows of the chunk which may
+					match the ranges */
+
+	/* Builds */
+	ulint			build_n;/*!< rows of the chunk built */
+	std::vector<ib_uint64_t>
+				build_keys;
+					/*!< keys of the integer columns of
+					the chunk built */
+	std::vector<byte>	build_nulls;
+					/*!< NULL flags of the columns of the
+					chunk built */
+	std::string		pk;	/*!< primary key buffer */
+};
+
+/*******************************************************************//**
+Reads the key of an integer: its value, with the sign bit flipped for
+signed integers so that the keys compare as the values.
+@return key */
+static inline
+ib_uint64_t
+col_mirror_int_key(
+/*===============*/
+	const byte*	ptr,		/*!< in: integer in a MySQL row */
+	ulint		len,		/*!< in: length of the integer */
+	bool		is_unsigned)	/*!< in: true if unsigned */
+{
+	ib_uint64_t	v = 0;
+
+	for (ulint i = len; i--; ) {
+		v = (v << 8) | ptr[i];
+	}
+
+	if (!is_unsigned) {
+		if (len < 8 && (ptr[len - 1] & 0x80)) {
+			v |= ~(ib_uint64_t) 0 << (len * 8);
+		}
+		v ^= (ib_uint64_t) 1 << 63;
+	}
+
+	return(v);
+}
+
+/*******************************************************************//**
+Stores an integer from its key in a MySQL row. */
+static inline
+void
+col_mirror_int_store(
+/*=================*/
+	byte*		ptr,		/*!< out: integer in a MySQL row */
+	ulint		len,		/*!< in: length of the integer */
+	bool		is_unsigned,	/*!< in: true if unsigned */
+	ib_uint64_t	key)		/*!< in: key */
+{
+	if (!is_unsigned) {
+		key ^= (ib_uint64_t) 1 << 63;
+	}
+
+	for (ulint i = 0; i < len; i++) {
+		ptr[i] = (byte) key;
+		key >>= 8;
+	}
+}
+
+/*******************************************************************//**
+Reads a little-endian length. */
+static inline
+ulint
+col_mirror_read_length(
+/*===================*/
+	const byte*	ptr,		/*!< in: length */
+	ulint		len)		/*!< in: length of the length */
+{
+	ulint	n = 0;
+
+	for (ulint i = len; i--; ) {
+		n = (n << 8) | ptr[i];
+	}
+
+	return(n);
+}
+
+/*******************************************************************//**
+Appends the value of a column other than an integer to a buffer: the
+bytes of fixed length columns, the length and bytes of VARCHARs and the
+bytes of BLOBs. */
+static
+void
+col_mirror_append_value(
+/*====================*/
+	std::string*			to,	/*!< in/out: buffer */
+	const col_mirror_column_t*	col,	/*!< in: column */
+	const byte*			rec)	/*!< in: MySQL row */
+{
+	const byte*	ptr = rec + col->offset;
+	ulint		len;
+
+	switch (col->kind) {
+	case COL_MIRROR_VARCHAR:
+		len = col->length + col_mirror_read_length(ptr, col->length);
+		break;
+	case COL_MIRROR_BLOB:
+		len = col_mirror_read_length(ptr, col->length);
+		memcpy(&ptr, ptr + col->length, sizeof ptr);
+		break;
+	default:
+		len = col->length;
+	}
+
+	to->append(reinterpret_cast<const char*>(ptr), len);
+}
+
+/*******************************************************************//**
+Stores the value of a column other than an integer in a MySQL row, from
+col_mirror_append_value(). BLOBs are copied to a heap. */
+static
+void
+col_mirror_store_value(
+/*===================*/
+	const col_mirror_column_t*	col,	/*!< in: column */
+	byte*				rec,	/*!< out: MySQL row */
+	const byte*			data,	/*!< in: value */
+	ulint				len,	/*!< in: length of data */
+	mem_heap_t**			heap)	/*!< in/out: BLOB heap */
+{
+	byte*	ptr = rec + col->offset;
+
+	if (col->kind != COL_MIRROR_BLOB) {
+		memcpy(ptr, data, len);
+		return;
+	}
+
+	byte*	copy = NULL;
+
+	if (len) {
+		if (*heap == NULL) {
+			*heap = mem_heap_create(UNIV_PAGE_SIZE);
+		}
+		copy = static_cast<byte*>(mem_heap_dup(*heap, data, len));
+	}
+
+	for (ulint i = 0; i < col->length; i++) {
+		ptr[i] = (byte) (len >> (8 * i));
+	}
+	memcpy(ptr + col->length, &copy, sizeof copy);
+}
+
+/*******************************************************************//**
+Describes the columns of a MySQL table.
+@return false if a column cannot be kept */
+static
+bool
+col_mirror_columns(
+/*===============*/
+	const TABLE*				table,	/*!< in: table */
+	std::vector<col_mirror_column_t>*	columns)/*!< out: columns */
+{
+	columns->resize(table->s->fields);
+
+	for (uint i = 0; i < table->s->fields; i++) {
+		const Field*		field = table->field[i];
+		col_mirror_column_t*	col = &(*columns)[i];
+
+		col->is_unsigned = false;
+		col->offset = field->ptr - table->record[0];
+		col->length = field->pack_length();
+
+		switch (field->real_type()) {
+		case MYSQL_TYPE_TINY:
+		case MYSQL_TYPE_SHORT:
+		case MYSQL_TYPE_INT24:
+		case MYSQL_TYPE_LONG:
+		case MYSQL_TYPE_LONGLONG:
+			col->kind = COL_MIRROR_INT;
+			col->is_unsigned = static_cast<const Field_num*>(
+				field)->unsigned_flag;
+			break;
+		case MYSQL_TYPE_VARCHAR:
+			col->kind = COL_MIRROR_VARCHAR;
+			col->length = static_cast<const Field_varstring*>(
+				field)->length_bytes;
+			break;
+		case MYSQL_TYPE_BIT:
+			/* Some bits may be with the NULL bits */
+			return(false);
+		default:
+			if (field->flags & BLOB_FLAG) {
+				col->kind = COL_MIRROR_BLOB;
+				col->length = static_cast<const Field_blob*>(
+					field)->pack_length_no_ptr();
+			} else {
+				col->kind = COL_MIRROR_FIXED;
+			}
+		}
+
+		if (field->real_maybe_null()) {
+			col->null_offset = field->null_offset();
+			col->null_bit = (byte) field->null_bit;
+		} else {
+			col->null_offset = 0;
+			col->null_bit = 0;
+		}
+	}
+
+	return(true);
+}
+
+/*******************************************************************//**
+Computes the layout of the rows of a MySQL table the column store of the
+table is made for.
+@return layout, 0 if the table cannot have a column store */
+UNIV_INTERN
+ulint
+innobase_col_mirror_layout(
+/*=======================*/
+	const TABLE*	table)		/*!< in: MySQL table */
+{
+	std::vector<col_mirror_column_t>	columns;
+	const TABLE_SHARE*			share = table->s;
+
+	/* Rows are identified by a primary key of whole columns */
+	if (share->primary_key >= MAX_KEY
+	    || !col_mirror_columns(table, &columns)) {
+		return(0);
+	}
+
+	const KEY*	key = &table->key_info[share->primary_key];
+	ulint		fold = ut_fold_ulint_pair(share->reclength,
+						  share->fields);
+
+	for (uint i = 0; i < key->user_defined_key_parts; i++) {
+		const KEY_PART_INFO*	part = &key->key_part[i];
+
+		if ((part->key_part_flag & HA_PART_KEY_SEG)
+		    || (part->field->flags & BLOB_FLAG)) {
+			return(0);
+		}
+		fold = ut_fold_ulint_pair(fold, part->fieldnr);
+	}
+
+	for (ulint i = 0; i < columns.size(); i++) {
+		fold = ut_fold_ulint_pair(fold, columns[i].kind);
+		fold = ut_fold_ulint_pair(fold, columns[i].offset);
+		fold = ut_fold_ulint_pair(fold, columns[i].length);
+		fold = ut_fold_ulint_pair(fold, columns[i].null_offset);
+		fold = ut_fold_ulint_pair(fold, columns[i].null_bit);
+		fold = ut_fold_ulint_pair(fold, columns[i].is_unsigned);
+	}
+
+	return(fold ? fold : 1);
+}
+
+/*******************************************************************//**
+Computes the primary key of a row, as the bytes of its columns. */
+static
+void
+col_mirror_pk(
+/*==========*/
+	const TABLE*	table,		/*!< in: MySQL table */
+	const byte*	rec,		/*!< in: MySQL row */
+	std::string*	pk)		/*!< out: primary key */
+{
+	const KEY*	key = &table->key_info[table->s->primary_key];
+
+	pk->clear();
+
+	for (uint i = 0; i < key->user_defined_key_parts; i++) {
+		const Field*	field = key->key_part[i].field;
+		const byte*	ptr = rec + (field->ptr - table->record[0]);
+		ulint		len = field->pack_length();
+
+		if (field->real_type() == MYSQL_TYPE_VARCHAR) {
+			ulint	length_bytes = static_cast<const
+				Field_varstring*>(field)->length_bytes;
+
+			len = length_bytes
+				+ col_mirror_read_length(ptr, length_bytes);
+		}
+
+		pk->append(reinterpret_cast<const char*>(ptr), len);
+	}
+}
+
+/*******************************************************************//**
+Makes the image of a row kept for a delta row: the MySQL row followed by
+the bytes of its BLOBs. */
+static
+void
+col_mirror_image(
+/*=============*/
+	const TABLE*	table,		/*!< in: MySQL table */
+	const byte*	rec,		/*!< in: MySQL row */
+	std::string*	image)		/*!< out: image */
+{
+	image->assign(reinterpret_cast<const char*>(rec),
+		      table->s->reclength);
+
+	for (uint i = 0; i < table->s->blob_fields; i++) {
+		const Field_blob*	field = static_cast<const Field_blob*>(
+			table->field[table->s->blob_field[i]]);
+		const byte*		ptr = rec
+			+ (field->ptr - table->record[0]);
+		ulint			packlength
+			= field->pack_length_no_ptr();
+		ulint			len
+			= col_mirror_read_length(ptr, packlength);
+		const byte*		data;
+
+		memcpy(&data, ptr + packlength, sizeof data);
+		image->append(reinterpret_cast<const char*>(data), len);
+	}
+}
+
+/*******************************************************************//**
+Stores a row in MySQL format from its col_mirror_image(). */
+static
+void
+col_mirror_image_to_rec(
+/*====================*/
+	const TABLE*		table,	/*!< in: MySQL table */
+	const std::string&	image,	/*!< in: image */
+	byte*			rec,	/*!< out: MySQL row */
+	mem_heap_t**		heap)	/*!< in/out: BLOB heap */
+{
+	const byte*	data = reinterpret_cast<const byte*>(image.data())
+		+ table->s->reclength;
+
+	memcpy(rec, image.data(), table->s->reclength);
+
+	for (uint i = 0; i < table->s->blob_fields; i++) {
+		const Field_blob*	field = static_cast<const Field_blob*>(
+			table->field[table->s->blob_field[i]]);
+		byte*			ptr = rec
+			+ (field->ptr - table->record[0]);
+		ulint			packlength
+			= field->pack_length_no_ptr();
+		ulint			len
+			= col_mirror_read_length(ptr, packlength);
+		byte*			copy = NULL;
+
+		if (len) {
+			if (*heap == NULL) {
+				*heap = mem_heap_create(UNIV_PAGE_SIZE);
+			}
+			copy = static_cast<byte*>(
+				mem_heap_dup(*heap, data, len));
+		}
+		memcpy(ptr + packlength, &copy, sizeof copy);
+		data += len;
+	}
+}
+
+/*******************************************************************//**
+Copies a read view. The creator is not seen: the changes it commits after
+the view was created are applied to the snapshot. */
+static
+void
+col_mirror_view_copy(
+/*=================*/
+	col_mirror_view_t*	to,	/*!< out: copy */
+	const read_view_t*	view)	/*!< in: read view */
+{
+	to->low_limit_id = view->low_limit_id;
+	to->up_limit_id = view->up_limit_id;
+	to->ids.assign(view->trx_ids, view->trx_ids + view->n_trx_ids);
+
+	if (view->creator_trx_id) {
+		to->ids.push_back(view->creator_trx_id);
+	}
+
+	std::sort(to->ids.begin(), to->ids.end());
+}
+
+/*******************************************************************//**
+Checks if a read view sees all the transactions a snapshot view sees: as
+views see more transactions over time, any transaction not seen by the
+read view must not be seen by the snapshot view either.
+@return true if the read view can read the snapshot */
+static
+bool
+col_mirror_view_covers(
+/*===================*/
+	const read_view_t*		view,	/*!< in: read view */
+	const col_mirror_view_t*	base)	/*!< in: snapshot view */
+{
+	if (view->low_limit_id < base->low_limit_id) {
+		return(false);
+	}
+
+	for (ulint i = 0; i < view->n_trx_ids; i++) {
+		if (base->sees(view->trx_ids[i])) {
+			return(false);
+		}
+	}
+
+	return(true);
+}
+
+/*******************************************************************//**
+Releases a snapshot. */
+static
+void
+col_mirror_snapshot_release(
+/*========================*/
+	col_mirror_t*		mirror,		/*!< in/out: column store */
+	col_mirror_snapshot_t*	snapshot)	/*!< in, own: snapshot */
+{
+	bool	last;
+
+	mysql_mutex_lock(&mirror->mutex);
+	last = !--snapshot->ref_count;
+	mysql_mutex_unlock(&mirror->mutex);
+
+	if (last) {
+		delete snapshot;
+	}
+}
+
+/*******************************************************************//**
+Starts keeping the committed changes for a new build: the builds must
+read the table with views seeing all the transactions which started
+before. Called with the mutex of the store held. */
+static
+void
+col_mirror_mark_pending(
+/*====================*/
+	col_mirror_t*	mirror)		/*!< in/out: column store */
+{
+	mirror->pending.clear();
+	mirror->pending_active = true;
+	mirror->pending_epoch++;
+	mirror->pending_mark = trx_sys_get_max_trx_id();
+}
+
+/*******************************************************************//**
+Drops the rows of a column store. Called with its mutex held.
+@return snapshot to release, or NULL */
+static
+col_mirror_snapshot_t*
+col_mirror_drop(
+/*============*/
+	col_mirror_t*	mirror)		/*!< in/out: column store */
+{
+	col_mirror_snapshot_t*	snapshot = mirror->snapshot;
+
+	mirror->generation++;
+	mirror->snapshot = NULL;
+
+	if (mirror->capturing.load()) {
+		col_mirror_mark_pending(mirror);
+	} else {
+		mirror->pending.clear();
+		mirror->pending_active = false;
+	}
+
+	if (snapshot && --snapshot->ref_count) {
+		snapshot = NULL;
+	}
+
+	return(snapshot);
+}
+
+/*******************************************************************//**
+Applies a committed change to a snapshot. Called with the mutex of the
+store held. */
+static
+void
+col_mirror_snapshot_apply(
+/*======================*/
+	col_mirror_snapshot_t*	snapshot,	/*!< in/out: snapshot */
+	trx_id_t		trx_id,		/*!< in: transaction */
+	const std::string&	pk,		/*!< in: primary key */
+	const std::string&	image)		/*!< in: image, or empty */
+{
+	std::unordered_map<std::string, ib_uint64_t>::iterator	it
+		= snapshot->rows.find(pk);
+	bool	replaces = it != snapshot->rows.end();
+
+	if (replaces) {
+		ib_uint64_t	loc = it->second;
+		std::atomic<trx_id_t>*	next = loc & COL_MIRROR_IN_DELTA
+			? &snapshot->delta(loc & ~COL_MIRROR_IN_DELTA)
+			->next_trx
+			: &snapshot->next_trx[loc];
+
+		next->store(trx_id, std::memory_order_release);
+	} else if (image.empty()) {
+		return;
+	}
+
+	if (snapshot->n_deltas
+	    == snapshot->blocks.size() * COL_MIRROR_DELTA_BLOCK) {
+		snapshot->blocks.push_back(
+			new col_mirror_delta_t[COL_MIRROR_DELTA_BLOCK]);
+		snapshot->grow(sizeof(col_mirror_delta_t)
+			       * COL_MIRROR_DELTA_BLOCK);
+	}
+
+	col_mirror_delta_t*	delta = snapshot->delta(snapshot->n_deltas);
+
+	delta->trx_id = trx_id;
+	delta->next_trx.store(0, std::memory_order_relaxed);
+	delta->replaces = replaces;
+	delta->image = image;
+	snapshot->grow(image.size());
+
+	if (image.empty()) {
+		snapshot->rows.erase(it);
+	} else if (replaces) {
+		it->second = COL_MIRROR_IN_DELTA | snapshot->n_deltas;
+	} else {
+		snapshot->rows.insert(std::make_pair(
+			pk, COL_MIRROR_IN_DELTA | snapshot->n_deltas));
+		snapshot->grow(pk.size() + COL_MIRROR_ROW_OVERHEAD);
+	}
+
+	snapshot->n_deltas++;
+}
+
+/*******************************************************************//**
+Checks the size of a column store after changes were applied: a base with
+many delta rows is built again, and dropped if they keep growing or the
+column stores take more than innodb_column_mirror_max_size. Called with
+the mutex of the store held.
+@return snapshot to release, or NULL */
+static
+col_mirror_snapshot_t*
+col_mirror_check_size(
+/*==================*/
+	col_mirror_t*	mirror)		/*!< in/out: column store */
+{
+	col_mirror_snapshot_t*	snapshot = mirror->snapshot;
+
+	if (mirror->pending.size() > COL_MIRROR_MAX_PENDING) {
+		col_mirror_mark_pending(mirror);
+	}
+
+	if (snapshot == NULL) {
+		return(NULL);
+	}
+
+	if (snapshot->n_deltas
+	    > 2 * snapshot->n_rows + COL_MIRROR_DROP_DELTAS
+	    || col_mirror_bytes.load() > srv_col_mirror_max_size) {
+		return(col_mirror_drop(mirror));
+	}
+
+	if (!mirror->pending_active
+	    && snapshot->n_deltas
+	    > snapshot->n_rows / 4 + COL_MIRROR_REBUILD_DELTAS) {
+		col_mirror_mark_pending(mirror);
+	}
+
+	return(NULL);
+}
+
+/*******************************************************************//**
+Stops capturing the writes to a table, and drops its rows. */
+static
+void
+col_mirror_stop(
+/*============*/
+	col_mirror_t*	mirror)		/*!< in/out: column store */
+{
+	col_mirror_snapshot_t*	snapshot;
+
+	mysql_mutex_lock(&mirror->mutex);
+	mirror->capturing.store(false);
+	snapshot = col_mirror_drop(mirror);
+	mysql_mutex_unlock(&mirror->mutex);
+
+	delete snapshot;
+}
+
+/*******************************************************************//**
+Checks if a table is in innodb_column_mirror_tables.
+@return true if it is */
+static
+bool
+col_mirror_listed(
+/*==============*/
+	const TABLE*	table)		/*!< in: MySQL table */
+{
+	std::string	name;
+	bool		found = false;
+
+	name.append(table->s->db.str, table->s->db.length);
+	name.push_back('.');
+	name.append(table->s->table_name.str, table->s->table_name.length);
+
+	mysql_mutex_lock(&col_mirror_list_mutex);
+	for (ulint i = 0; i < col_mirror_list.size() && !found; i++) {
+		found = !my_strcasecmp(system_charset_info,
+				       col_mirror_list[i].c_str(),
+				       name.c_str());
+	}
+	mysql_mutex_unlock(&col_mirror_list_mutex);
+
+	return(found);
+}
+
+/*******************************************************************//**
+Initializes the list of tables with a column store from
+innodb_column_mirror_tables. */
+UNIV_INTERN
+void
+innobase_col_mirror_init(
+/*=====================*/
+	const char*	tables)		/*!< in: comma separated db.table */
+{
+	mysql_mutex_init(col_mirror_list_mutex_key, &col_mirror_list_mutex,
+			 MY_MUTEX_INIT_FAST);
+	innobase_col_mirror_set_tables(tables);
+}
+
+/*******************************************************************//**
+Frees the list of tables with a column store. */
+UNIV_INTERN
+void
+innobase_col_mirror_close(void)
+/*===========================*/
+{
+	col_mirror_list.clear();
+	mysql_mutex_destroy(&col_mirror_list_mutex);
+}
+
+/*******************************************************************//**
+Changes the list of tables with a column store. The tables check the list
+again when they are next used. */
+UNIV_INTERN
+void
+innobase_col_mirror_set_tables(
+/*===========================*/
+	const char*	tables)		/*!< in: comma separated db.table */
+{
+	std::vector<std::string>	list;
+
+	while (tables && *tables) {
+		const char*	end = strchr(tables, ',');
+		const char*	next;
+
+		if (end == NULL) {
+			end = tables + strlen(tables);
+			next = end;
+		} else {
+			next = end + 1;
+		}
+
+		while (tables < end && my_isspace(system_charset_info,
+						  *tables)) {
+			tables++;
+		}
+		while (end > tables && my_isspace(system_charset_info,
+						  end[-1])) {
+			end--;
+		}
+		if (end > tables) {
+			list.push_back(std::string(tables, end - tables));
+		}
+		tables = next;
+	}
+
+	mysql_mutex_lock(&col_mirror_list_mutex);
+	col_mirror_list.swap(list);
+	col_mirror_list_version++;
+	mysql_mutex_unlock(&col_mirror_list_mutex);
+}
+
+/*******************************************************************//**
+Checks a table against innodb_column_mirror_tables, creating its column
+store when it was added and dropping the rows when it was removed.
+@return column store, or NULL */
+static
+col_mirror_t*
+col_mirror_check_list(
+/*==================*/
+	dict_table_t*	table,		/*!< in/out: InnoDB table */
+	const TABLE*	mysql_table,	/*!< in: MySQL table */
+	ulint		version)	/*!< in: col_mirror_list_version */
+{
+	bool		listed = col_mirror_listed(mysql_table);
+	col_mirror_t*	mirror;
+
+	mutex_enter(&dict_sys->mutex);
+
+	mirror = table->col_mirror;
+
+	if (listed && mirror == NULL) {
+		mirror = new col_mirror_t();
+		mysql_mutex_init(col_mirror_mutex_key, &mirror->mutex,
+				 MY_MUTEX_INIT_FAST);
+		mirror->listed.store(false);
+		mirror->capturing.store(false);
+		mirror->api_written.store(false);
+		mirror->generation.store(0);
+		mirror->layout.store(0);
+		mirror->snapshot = NULL;
+		mirror->pending_active = false;
+		mirror->pending_mark = 0;
+		mirror->pending_epoch = 0;
+		mirror->building = false;
+
+		table->col_mirror = mirror;
+
+		/* Keep the table and its rows in the cache */
+		if (table->can_be_evicted) {
+			dict_table_move_from_lru_to_non_lru(table);
+		}
+	}
+
+	if (mirror) {
+		mirror->listed.store(listed);
+	}
+
+	table->col_mirror_version = version;
+
+	mutex_exit(&dict_sys->mutex);
+
+	if (mirror && !listed && mirror->capturing.load()) {
+		col_mirror_stop(mirror);
+	}
+
+	return(mirror);
+}
+
+/*******************************************************************//**
+Gets the column store of a table, creating it when the table was added to
+innodb_column_mirror_tables.
+@return column store, or NULL if the table has none */
+UNIV_INTERN
+col_mirror_t*
+innobase_col_mirror_get(
+/*====================*/
+	dict_table_t*	table,		/*!< in/out: InnoDB table */
+	const TABLE*	mysql_table,	/*!< in: MySQL table */
+	ulint		layout)		/*!< in: innobase_col_mirror_layout() */
+{
+	col_mirror_t*	mirror = table->col_mirror;
+	ulint		version = col_mirror_list_version.load();
+
+	if (table->col_mirror_version != version) {
+		mirror = col_mirror_check_list(table, mysql_table, version);
+	}
+
+	if (mirror == NULL || !mirror->listed.load()
+	    || mirror->api_written.load()) {
+		return(NULL);
+	}
+
+	/* The changes made by foreign key cascades are not seen by the
+	handler */
+	if (layout == 0 || !table->foreign_set.empty()) {
+		if (mirror->capturing.load()) {
+			col_mirror_stop(mirror);
+		}
+		return(NULL);
+	}
+
+	if (mirror->capturing.load() && mirror->layout.load() == layout) {
+		return(mirror);
+	}
+
+	col_mirror_snapshot_t*	snapshot = NULL;
+
+	mysql_mutex_lock(&mirror->mutex);
+
+	if (mirror->layout.load() != layout) {
+		snapshot = col_mirror_drop(mirror);
+		mirror->layout.store(layout);
+	}
+
+	if (!mirror->capturing.load()) {
+		/* The writes of the transactions which get an id after
+		the mark are captured */
+		mirror->capturing.store(true);
+		col_mirror_mark_pending(mirror);
+	}
+
+	mysql_mutex_unlock(&mirror->mutex);
+
+	delete snapshot;
+
+	return(mirror);
+}
+
+/*******************************************************************//**
+Drops the rows of the column store of a table, after it was truncated or
+its tablespace discarded or imported. */
+UNIV_INTERN
+void
+innobase_col_mirror_reset(
+/*======================*/
+	dict_table_t*	table)		/*!< in/out: InnoDB table */
+{
+	col_mirror_t*		mirror = table->col_mirror;
+	col_mirror_snapshot_t*	snapshot;
+
+	if (mirror == NULL) {
+		return;
+	}
+
+	mysql_mutex_lock(&mirror->mutex);
+	snapshot = col_mirror_drop(mirror);
+	mysql_mutex_unlock(&mirror->mutex);
+
+	delete snapshot;
+}
+
+/*******************************************************************//**
+Stops keeping the rows of a table written through the InnoDB API, before
+the write. Only the handler captures the rows written to a table. */
+UNIV_INTERN
+void
+innobase_col_mirror_api_write(
+/*==========================*/
+	dict_table_t*	table)		/*!< in/out: InnoDB table */
+{
+	col_mirror_t*	mirror = table->col_mirror;
+
+	if (mirror == NULL || mirror->api_written.load()) {
+		return;
+	}
+
+	mirror->api_written.store(true);
+	col_mirror_stop(mirror);
+}
+
+/*******************************************************************//**
+Gets the memory of the column stores of all the tables.
+@return bytes */
+UNIV_INTERN
+ulint
+innobase_col_mirror_size(void)
+/*==========================*/
+{
+	return(col_mirror_bytes.load());
+}
+
+/*******************************************************************//**
+Frees the column store of a table evicted or dropped from the dictionary
+cache. */
+UNIV_INTERN
+void
+innobase_col_mirror_free(
+/*=====================*/
+	dict_table_t*	table)		/*!< in/out: table */
+{
+	col_mirror_t*	mirror = table->col_mirror;
+
+	/* No scan or transaction uses a table being freed */
+	ut_a(!mirror->building);
+	ut_a(mirror->snapshot == NULL || mirror->snapshot->ref_count == 1);
+
+	delete mirror->snapshot;
+	mysql_mutex_destroy(&mirror->mutex);
+	delete mirror;
+
+	table->col_mirror = NULL;
+}
+
+/*******************************************************************//**
+Captures a row written to a table with a column store, to be applied to
+the store when the transaction commits. */
+UNIV_INTERN
+void
+innobase_col_mirror_capture(
+/*========================*/
+	col_mirror_t*	mirror,		/*!< in/out: column store */
+	trx_t*		trx,		/*!< in/out: transaction */
+	const TABLE*	table,		/*!< in: MySQL table */
+	undo_no_t	undo_no,	/*!< in: trx->undo_no before the
+					row was written */
+	const uchar*	old_rec,	/*!< in: row before the update or
+					delete, or NULL for an insert */
+	const uchar*	new_rec)	/*!< in: row after the insert or
+					update, or NULL for a delete */
+{
+	if (!mirror->capturing.load(std::memory_order_acquire)) {
+		return;
+	}
+
+	if (trx->col_mirror_changes == NULL) {
+		trx->col_mirror_changes = new col_mirror_trx_t();
+	}
+
+	std::vector<col_mirror_change_t>&	changes
+		= trx->col_mirror_changes->changes;
+	col_mirror_change_t			change;
+
+	change.mirror = mirror;
+	change.generation = mirror->generation.load();
+	change.undo_no = undo_no;
+	change.trx_id = 0;
+
+	if (old_rec) {
+		col_mirror_pk(table, old_rec, &change.pk);
+
+		if (new_rec == NULL) {
+			changes.push_back(change);
+			return;
+		}
+
+		std::string	pk;
+
+		col_mirror_pk(table, new_rec, &pk);
+
+		if (pk != change.pk) {
+			/* The row moved to another primary key */
+			changes.push_back(change);
+			change.pk.swap(pk);
+		}
+	} else {
+		col_mirror_pk(table, new_rec, &change.pk);
+	}
+
+	col_mirror_image(table, new_rec, &change.image);
+	changes.push_back(change);
+}
+
+/*******************************************************************//**
+Applies the changes a transaction made to tables with a column store at
+its commit, or discards them when it was rolled back. */
+UNIV_INTERN
+void
+innobase_col_mirror_trx_end(
+/*========================*/
+	trx_t*	trx,		/*!< in/out: transaction */
+	ibool	for_commit)	/*!< in: FALSE on rollback */
+{
+	std::vector<col_mirror_change_t>&	changes
+		= trx->col_mirror_changes->changes;
+	std::vector<col_mirror_snapshot_t*>	released;
+	col_mirror_t*				locked = NULL;
+
+	for (ulint i = 0; for_commit && i < changes.size(); i++) {
+		col_mirror_change_t&	change = changes[i];
+		col_mirror_t*		mirror = change.mirror;
+
+		if (mirror != locked) {
+			if (locked) {
+				released.push_back(
+					col_mirror_check_size(locked));
+				mysql_mutex_unlock(&locked->mutex);
+			}
+			mysql_mutex_lock(&mirror->mutex);
+			locked = mirror;
+		}
+
+		if (change.generation != mirror->generation.load()) {
+			continue;
+		}
+
+		if (mirror->snapshot) {
+			col_mirror_snapshot_apply(mirror->snapshot, trx->id,
+						  change.pk, change.image);
+		}
+
+		if (mirror->pending_active) {
+			change.trx_id = trx->id;
+			mirror->pending.push_back(change);
+		}
+	}
+
+	if (locked) {
+		released.push_back(col_mirror_check_size(locked));
+		mysql_mutex_unlock(&locked->mutex);
+	}
+
+	for (ulint i = 0; i < released.size(); i++) {
+		delete released[i];
+	}
+
+	innobase_col_mirror_trx_free(trx);
+}
+
+/*******************************************************************//**
+Discards the changes to tables with a column store that a rollback to a
+savepoint undid. */
+UNIV_INTERN
+void
+innobase_col_mirror_trx_rollback(
+/*=============================*/
+	trx_t*		trx,		/*!< in/out: transaction */
+	undo_no_t	undo_no)	/*!< in: undo number of the savepoint */
+{
+	std::vector<col_mirror_change_t>&	changes
+		= trx->col_mirror_changes->changes;
+
+	while (!changes.empty() && changes.back().undo_no >= undo_no) {
+		changes.pop_back();
+	}
+}
+
+/*******************************************************************//**
+Frees the changes to tables with a column store of a transaction. */
+UNIV_INTERN
+void
+innobase_col_mirror_trx_free(
+/*=========================*/
+	trx_t*	trx)	/*!< in/out: transaction */
+{
+	delete trx->col_mirror_changes;
+	trx->col_mirror_changes = NULL;
+}
+
+/*******************************************************************//**
+Checks if a transaction has uncommitted changes to a column store.
+@return true if it has */
+static
+bool
+col_mirror_trx_changed(
+/*===================*/
+	const trx_t*		trx,	/*!< in: transaction */
+	const col_mirror_t*	mirror)	/*!< in: column store */
+{
+	if (trx->col_mirror_changes == NULL) {
+		return(false);
+	}
+
+	const std::vector<col_mirror_change_t>&	changes
+		= trx->col_mirror_changes->changes;
+
+	for (ulint i = 0; i < changes.size(); i++) {
+		if (changes[i].mirror == mirror) {
+			return(true);
+		}
+	}
+
+	return(false);
+}
+
+/*******************************************************************//**
+Gets the snapshot of a column store a transaction can read.
+@return snapshot to release, or NULL */
+static
+col_mirror_snapshot_t*
+col_mirror_snapshot_get(
+/*====================*/
+	col_mirror_t*	mirror,		/*!< in/out: column store */
+	const trx_t*	trx)		/*!< in: transaction */
+{
+	col_mirror_snapshot_t*	snapshot = mirror->snapshot;
+
+	if (snapshot == NULL
+	    || col_mirror_trx_changed(trx, mirror)
+	    || !col_mirror_view_covers(trx->read_view, &snapshot->view)) {
+		return(NULL);
+	}
+
+	snapshot->ref_count++;
+
+	return(snapshot);
+}
+
+/*******************************************************************//**
+Checks if a delta row is the version of its row a read view sees.
+@return true if it is */
+static inline
+bool
+col_mirror_delta_visible(
+/*=====================*/
+	const col_mirror_delta_t*	delta,	/*!< in: delta row */
+	const read_view_t*		view)	/*!< in: read view */
+{
+	if (!read_view_sees_trx_id(view, delta->trx_id)) {
+		return(false);
+	}
+
+	trx_id_t	next = delta->next_trx.load(std::memory_order_acquire);
+
+	return(!next || !read_view_sees_trx_id(view, next));
+}
+
+/*******************************************************************//**
+Counts the rows of a table a transaction sees, from the column store.
+@return number of rows, or HA_POS_ERROR if the store cannot be used */
+UNIV_INTERN
+ha_rows
+innobase_col_mirror_count(
+/*======================*/
+	col_mirror_t*	mirror,		/*!< in: column store */
+	trx_t*		trx)		/*!< in/out: transaction, with a read
+					view */
+{
+	col_mirror_snapshot_t*	snapshot;
+	ulint			n_deltas;
+
+	mysql_mutex_lock(&mirror->mutex);
+	snapshot = col_mirror_snapshot_get(mirror, trx);
+	n_deltas = snapshot ? snapshot->n_deltas : 0;
+	mysql_mutex_unlock(&mirror->mutex);
+
+	if (snapshot == NULL) {
+		return(HA_POS_ERROR);
+	}
+
+	/* A delta row the view sees adds a row, and removes the version
+	it replaced, which the view also sees */
+	ib_int64_t	count = snapshot->n_rows;
+	const read_view_t*	view = trx->read_view;
+
+	for (ulint i = 0; i < n_deltas; i++) {
+		const col_mirror_delta_t*	delta = snapshot->delta(i);
+
+		if (read_view_sees_trx_id(view, delta->trx_id)) {
+			count += !delta->image.empty();
+			count -= delta->replaces;
+		}
+	}
+
+	col_mirror_snapshot_release(mirror, snapshot);
+
+	ut_a(count >= 0);
+
+	return((ha_rows) count);
+}
+
+/*******************************************************************//**
+Checks if a MySQL field is a column of the base kept as integers.
+@return true if it is */
+static
+bool
+col_mirror_int_field(
+/*=================*/
+	const col_mirror_snapshot_t*	snapshot,	/*!< in: snapshot */
+	const TABLE*			table,		/*!< in: table */
+	const Field*			field)		/*!< in: field */
+{
+	return(field->table == table
+	       && snapshot->columns[field->field_index].kind
+	       == COL_MIRROR_INT);
+}
+
+/*******************************************************************//**
+Converts a constant compared with an integer column to a key of the
+column.
+@return -1 if the constant is smaller than all the values of the column,
+1 if it is larger, 0 if key was set */
+static
+int
+col_mirror_const_key(
+/*=================*/
+	const Field*	field,		/*!< in: integer column */
+	Item*		item,		/*!< in: constant */
+	ib_uint64_t*	key,		/*!< out: key */
+	bool*		ok)		/*!< out: false if the constant
+					cannot be used */
+{
+	*ok = false;
+
+	if (!item->const_item() || item->is_expensive()
+	    || item->result_type() != INT_RESULT || item->is_temporal()) {
+		return(0);
+	}
+
+	longlong	value = item->val_int();
+
+	if (item->null_value) {
+		return(0);
+	}
+
+	*ok = true;
+
+	if (static_cast<const Field_num*>(field)->unsigned_flag) {
+		if (!item->unsigned_flag && value < 0) {
+			return(-1);
+		}
+		*key = (ib_uint64_t) value;
+	} else {
+		if (item->unsigned_flag && (ulonglong) value > LONGLONG_MAX) {
+			return(1);
+		}
+		*key = (ib_uint64_t) value ^ ((ib_uint64_t) 1 << 63);
+	}
+
+	return(0);
+}
+
+/*******************************************************************//**
+Adds the range of keys a comparison of an integer column with a constant
+implies. */
+static
+void
+col_mirror_add_range(
+/*=================*/
+	col_mirror_scan_t*	scan,	/*!< in/out: scan */
+	const Field*		field,	/*!< in: integer column */
+	Item*			item,	/*!< in: constant */
+	Item_func::Functype	op)	/*!< in: column op constant */
+{
+	ib_uint64_t	key = 0;
+	bool		ok;
+	int		pos = col_mirror_const_key(field, item, &key, &ok);
+	ib_uint64_t	low = 0;
+	ib_uint64_t	high = ~(ib_uint64_t) 0;
+	bool		empty = false;
+
+	if (!ok) {
+		return;
+	}
+
+	switch (op) {
+	case Item_func::EQ_FUNC:
+		empty = pos != 0;
+		low = high = key;
+		break;
+	case Item_func::GT_FUNC:
+	case Item_func::GE_FUNC:
+		if (pos > 0) {
+			empty = true;
+		} else if (pos == 0) {
+			low = key;
+			if (op == Item_func::GT_FUNC) {
+				empty = low == ~(ib_uint64_t) 0;
+				low++;
+			}
+		}
+		break;
+	case Item_func::LT_FUNC:
+	case Item_func::LE_FUNC:
+		if (pos < 0) {
+			empty = true;
+		} else if (pos == 0) {
+			high = key;
+			if (op == Item_func::LT_FUNC) {
+				empty = high == 0;
+				high--;
+			}
+		}
+		break;
+	default:
+		return;
+	}
+
+	if (empty) {
+		scan->empty = true;
+	} else {
+		scan->ranges.push_back(field->field_index);
+		scan->lows.push_back(low);
+		scan->highs.push_back(high);
+	}
+}
+
+/*******************************************************************//**
+Gets the integer column of the base of an argument of a comparison.
+@return field, or NULL */
+static
+const Field*
+col_mirror_range_field(
+/*===================*/
+	const col_mirror_scan_t*	scan,	/*!< in: scan */
+	Item*				item)	/*!< in: argument */
+{
+	Item*	real_item = item->real_item();
+
+	if (real_item->type() != Item::FIELD_ITEM) {
+		return(NULL);
+	}
+
+	const Field*	field = static_cast<Item_field*>(real_item)->field;
+
+	return(col_mirror_int_field(scan->snapshot, scan->table, field)
+	       ? field : NULL);
+}
+
+/*******************************************************************//**
+Collects the ranges of keys of integer columns a pushed condition implies:
+the comparisons with constants and the BETWEEN of its top level AND. */
+static
+void
+col_mirror_add_ranges(
+/*==================*/
+	col_mirror_scan_t*	scan,	/*!< in/out: scan */
+	const Item*		cond)	/*!< in: condition */
+{
+	if (cond->type() == Item::COND_ITEM) {
+		const Item_cond*	cond_item
+			= static_cast<const Item_cond*>(cond);
+
+		if (cond_item->functype() != Item_func::COND_AND_FUNC) {
+			return;
+		}
+
+		List_iterator_fast<Item>	it(*const_cast<Item_cond*>(
+			cond_item)->argument_list());
+		Item*				item;
+
+		while ((item = it++)) {
+			col_mirror_add_ranges(scan, item);
+		}
+		return;
+	}
+
+	if (cond->type() != Item::FUNC_ITEM) {
+		return;
+	}
+
+	const Item_func*	func = static_cast<const Item_func*>(cond);
+	Item**			args = func->arguments();
+	Item_func::Functype	op = func->functype();
+	const Field*		field;
+
+	switch (op) {
+	case Item_func::BETWEEN:
+		if (static_cast<const Item_func_opt_neg*>(func)->negated
+		    || !(field = col_mirror_range_field(scan, args[0]))) {
+			return;
+		}
+		col_mirror_add_range(scan, field, args[1],
+				     Item_func::GE_FUNC);
+		col_mirror_add_range(scan, field, args[2],
+				     Item_func::LE_FUNC);
+		return;
+	case Item_func::EQ_FUNC:
+	case Item_func::LT_FUNC:
+	case Item_func::LE_FUNC:
+	case Item_func::GT_FUNC:
+	case Item_func::GE_FUNC:
+		if ((field = col_mirror_range_field(scan, args[0]))) {
+			col_mirror_add_range(scan, field, args[1], op);
+		} else if ((field = col_mirror_range_field(scan, args[1]))) {
+			/* The constant is first: a < b is b > a */
+			switch (op) {
+			case Item_func::LT_FUNC: op = Item_func::GT_FUNC; break;
+			case Item_func::LE_FUNC: op = Item_func::GE_FUNC; break;
+			case Item_func::GT_FUNC: op = Item_func::LT_FUNC; break;
+			case Item_func::GE_FUNC: op = Item_func::LE_FUNC; break;
+			default: break;
+			}
+			col_mirror_add_range(scan, field, args[0], op);
+		}
+		return;
+	default:
+		return;
+	}
+}
+
+/*******************************************************************//**
+Unpacks the keys of an integer column of a chunk. */
+static
+void
+col_mirror_unpack(
+/*==============*/
+	const col_mirror_chunk_t*	chunk,	/*!< in: column of a chunk */
+	ulint				n,	/*!< in: number of rows */
+	ib_uint64_t*			keys)	/*!< out: keys */
+{
+	const ib_uint64_t*	words = chunk->packed.data();
+	ulint			bits = chunk->bits;
+	ib_uint64_t		min_key = chunk->min_key;
+
+	if (bits == 0) {
+		for (ulint i = 0; i < n; i++) {
+			keys[i] = min_key;
+		}
+		return;
+	}
+
+	ib_uint64_t	mask = bits == 64
+		? ~(ib_uint64_t) 0 : ((ib_uint64_t) 1 << bits) - 1;
+
+	for (ulint i = 0; i < n; i++) {
+		ulint		pos = i * bits;
+		ulint		shift = pos & 63;
+		ib_uint64_t	v = words[pos >> 6] >> shift;
+
+		if (shift + bits > 64) {
+			v |= words[(pos >> 6) + 1] << (64 - shift);
+		}
+		keys[i] = min_key + (v & mask);
+	}
+}
+
+/*******************************************************************//**
+Packs the keys of an integer column of a chunk. */
+static
+void
+col_mirror_pack(
+/*============*/
+	col_mirror_chunk_t*	chunk,	/*!< in/out: column of a chunk */
+	const ib_uint64_t*	keys,	/*!< in: keys */
+	const byte*		nulls,	/*!< in: NULL flags */
+	ulint			n)	/*!< in: number of rows */
+{
+	ib_uint64_t	min_key = ~(ib_uint64_t) 0;
+	ib_uint64_t	max_key = 0;
+
+	chunk->n_not_null = 0;
+
+	for (ulint i = 0; i < n; i++) {
+		if (!nulls[i]) {
+			min_key = std::min(min_key, keys[i]);
+			max_key = std::max(max_key, keys[i]);
+			chunk->n_not_null++;
+		}
+	}
+
+	if (chunk->n_not_null == 0) {
+		min_key = max_key = 0;
+	}
+
+	chunk->min_key = min_key;
+	chunk->max_key = max_key;
+
+	ulint		bits = 0;
+
+	for (ib_uint64_t range = max_key - min_key; range; range >>= 1) {
+		bits++;
+	}
+
+	chunk->bits = bits;
+	/* One more word, for reading the last values by two words */
+	chunk->packed.assign((n * bits + 63) / 64 + 1, 0);
+
+	for (ulint i = 0; bits && i < n; i++) {
+		ib_uint64_t	v = nulls[i] ? 0 : keys[i] - min_key;
+		ulint		pos = i * bits;
+		ulint		shift = pos & 63;
+
+		chunk->packed[pos >> 6] |= v << shift;
+
+		if (shift + bits > 64) {
+			chunk->packed[(pos >> 6) + 1] |= v >> (64 - shift);
+		}
+	}
+}
+
+/*******************************************************************//**
+Prepares the reads of a chunk: unpacks the integer columns read and
+selects the rows in the ranges of the scan.
+@return false if no row of the chunk is in the ranges */
+static
+bool
+col_mirror_scan_chunk(
+/*==================*/
+	col_mirror_scan_t*	scan,	/*!< in/out: scan */
+	ulint			chunk)	/*!< in: chunk */
+{
+	const col_mirror_snapshot_t*	snapshot = scan->snapshot;
+	ulint				n = std::min(
+		snapshot->n_rows - chunk * COL_MIRROR_CHUNK_ROWS,
+		(ulint) COL_MIRROR_CHUNK_ROWS);
+
+	scan->chunk = chunk;
+
+	if (scan->empty) {
+		return(false);
+	}
+
+	/* Skip the chunk if the values of a column are all out of a
+	range, comparisons with NULL never match */
+	for (ulint r = 0; r < scan->ranges.size(); r++) {
+		const col_mirror_chunk_t*	col = &snapshot->columns[
+			scan->ranges[r]].chunks[chunk];
+
+		if (col->n_not_null == 0
+		    || col->max_key < scan->lows[r]
+		    || col->min_key > scan->highs[r]) {
+			return(false);
+		}
+	}
+
+	memset(scan->sel, 1, n);
+
+	for (ulint r = 0; r < scan->ranges.size(); r++) {
+		const col_mirror_chunk_t*	col = &snapshot->columns[
+			scan->ranges[r]].chunks[chunk];
+		ib_uint64_t*			keys = &scan->keys[
+			scan->fields.size() * COL_MIRROR_CHUNK_ROWS];
+		ib_uint64_t			low = scan->lows[r];
+		ib_uint64_t			width = scan->highs[r] - low;
+
+		col_mirror_unpack(col, n, keys);
+
+		for (ulint i = 0; i < n; i++) {
+			scan->sel[i] &= keys[i] - low <= width;
+		}
+
+		if (!col->nulls.empty()) {
+			for (ulint i = 0; i < n; i++) {
+				scan->sel[i] &= !((col->nulls[i >> 3]
+						   >> (i & 7)) & 1);
+			}
+		}
+	}
+
+	for (ulint f = 0; f < scan->fields.size(); f++) {
+		const col_mirror_column_t*	col = &snapshot->columns[
+			scan->fields[f]];
+
+		if (col->kind == COL_MIRROR_INT) {
+			col_mirror_unpack(&col->chunks[chunk], n,
+					  &scan->keys[f * COL_MIRROR_CHUNK_ROWS]);
+		}
+	}
+
+	return(true);
+}
+
+/*******************************************************************//**
+Stores a base row in MySQL format. */
+static
+void
+col_mirror_scan_store(
+/*==================*/
+	const col_mirror_scan_t*	scan,	/*!< in: scan */
+	ulint				i,	/*!< in: row of the chunk */
+	byte*				buf,	/*!< out: MySQL row */
+	mem_heap_t**			heap)	/*!< in/out: BLOB heap */
+{
+	const col_mirror_snapshot_t*	snapshot = scan->snapshot;
+
+	for (ulint f = 0; f < scan->fields.size(); f++) {
+		const col_mirror_column_t*	col = &snapshot->columns[
+			scan->fields[f]];
+		const col_mirror_chunk_t*	chunk
+			= &col->chunks[scan->chunk];
+
+		if (col->null_bit) {
+			if (!chunk->nulls.empty()
+			    && ((chunk->nulls[i >> 3] >> (i & 7)) & 1)) {
+				buf[col->null_offset] |= col->null_bit;
+				continue;
+			}
+			buf[col->null_offset] &= (byte) ~col->null_bit;
+		}
+
+		if (col->kind == COL_MIRROR_INT) {
+			col_mirror_int_store(
+				buf + col->offset, col->length,
+				col->is_unsigned,
+				scan->keys[f * COL_MIRROR_CHUNK_ROWS + i]);
+		} else {
+			col_mirror_store_value(
+				col, buf,
+				reinterpret_cast<const byte*>(
+					chunk->data.data())
+				+ chunk->offsets[i],
+				chunk->offsets[i + 1] - chunk->offsets[i],
+				heap);
+		}
+	}
+}
+
+/*******************************************************************//**
+Starts a full table scan on a table with a column store.
+@return how the scan uses the store */
+UNIV_INTERN
+col_mirror_scan_mode
+innobase_col_mirror_scan_start(
+/*===========================*/
+	col_mirror_scan_t**	scanp,	/*!< in/out: scan state, allocated
+					on first use */
+	col_mirror_t*		mirror,	/*!< in/out: column store */
+	trx_t*			trx,	/*!< in/out: transaction, with a
+					read view */
+	const TABLE*		table,	/*!< in: MySQL table */
+	const Item*		cond)	/*!< in: pushed condition, or NULL */
+{
+	col_mirror_scan_t*	scan = *scanp;
+	const read_view_t*	view = trx->read_view;
+
+	if (scan == NULL) {
+		scan = *scanp = new col_mirror_scan_t();
+		scan->mode = COL_MIRROR_SCAN_NONE;
+	}
+
+	ut_a(scan->mode == COL_MIRROR_SCAN_NONE);
+
+	scan->mirror = mirror;
+	scan->table = table;
+	scan->view = view;
+
+	mysql_mutex_lock(&mirror->mutex);
+
+	scan->snapshot = mirror->pending_active && !mirror->building
+		? NULL : col_mirror_snapshot_get(mirror, trx);
+
+	if (scan->snapshot) {
+		scan->mode = COL_MIRROR_SCAN_READ;
+		scan->blocks = scan->snapshot->blocks;
+		scan->n_deltas = scan->snapshot->n_deltas;
+	} else if (mirror->pending_active && !mirror->building
+		   && view->up_limit_id >= mirror->pending_mark
+		   && (!view->creator_trx_id
+		       || view->creator_trx_id >= mirror->pending_mark)
+		   && !col_mirror_trx_changed(trx, mirror)) {
+		/* The view sees all the transactions whose writes
+		may not be in pending */
+		scan->mode = COL_MIRROR_SCAN_BUILD;
+		scan->generation = mirror->generation.load();
+		scan->epoch = mirror->pending_epoch;
+		mirror->building = true;
+	} else {
+		scan->snapshot = col_mirror_snapshot_get(mirror, trx);
+
+		if (scan->snapshot) {
+			scan->mode = COL_MIRROR_SCAN_READ;
+			scan->blocks = scan->snapshot->blocks;
+			scan->n_deltas = scan->snapshot->n_deltas;
+		}
+	}
+
+	mysql_mutex_unlock(&mirror->mutex);
+
+	if (scan->mode == COL_MIRROR_SCAN_BUILD) {
+		col_mirror_snapshot_t*	snapshot = new col_mirror_snapshot_t();
+
+		col_mirror_columns(table, &snapshot->columns);
+		col_mirror_view_copy(&snapshot->view, view);
+		scan->snapshot = snapshot;
+		scan->build_n = 0;
+		scan->build_keys.assign(
+			snapshot->columns.size() * COL_MIRROR_CHUNK_ROWS, 0);
+		scan->build_nulls.assign(
+			snapshot->columns.size() * COL_MIRROR_CHUNK_ROWS, 0);
+		return(scan->mode);
+	}
+
+	if (scan->mode != COL_MIRROR_SCAN_READ) {
+		return(scan->mode);
+	}
+
+	/* Read the columns of the read set, and of the primary key for
+	position() */
+	const KEY*	key = &table->key_info[table->s->primary_key];
+
+	scan->fields.clear();
+	for (uint i = 0; i < table->s->fields; i++) {
+		if (bitmap_is_set(table->read_set, i)) {
+			scan->fields.push_back(i);
+		}
+	}
+	for (uint i = 0; i < key->user_defined_key_parts; i++) {
+		uint	field_index = key->key_part[i].fieldnr - 1;
+
+		if (!bitmap_is_set(table->read_set, field_index)) {
+			scan->fields.push_back(field_index);
+		}
+	}
+
+	scan->ranges.clear();
+	scan->lows.clear();
+	scan->highs.clear();
+	scan->empty = false;
+
+	if (cond) {
+		col_mirror_add_ranges(scan, cond);
+	}
+
+	scan->keys.resize((scan->fields.size() + 1) * COL_MIRROR_CHUNK_ROWS);
+	scan->row = 0;
+	scan->delta = 0;
+	scan->chunk = ULINT_UNDEFINED;
+
+	srv_stats.n_col_mirror_scans.inc();
+
+	return(scan->mode);
+}
+
+/*******************************************************************//**
+Reads the next row of a scan served from a column store. The columns of
+the read set and of the primary key are set.
+@return 0 or HA_ERR_END_OF_FILE */
+UNIV_INTERN
+int
+innobase_col_mirror_scan_next(
+/*==========================*/
+	col_mirror_scan_t*	scan,	/*!< in/out: scan state */
+	uchar*			buf,	/*!< out: row in MySQL format */
+	mem_heap_t**		heap)	/*!< in/out: heap for the values of
+					BLOB columns, emptied for each
+					row */
+{
+	const col_mirror_snapshot_t*	snapshot = scan->snapshot;
+	const read_view_t*		view = scan->view;
+
+	ut_ad(scan->mode == COL_MIRROR_SCAN_READ);
+
+	if (*heap) {
+		mem_heap_empty(*heap);
+	}
+
+	while (scan->row < snapshot->n_rows) {
+		ulint	chunk = scan->row / COL_MIRROR_CHUNK_ROWS;
+		ulint	i = scan->row % COL_MIRROR_CHUNK_ROWS;
+
+		if (chunk != scan->chunk
+		    && !col_mirror_scan_chunk(scan, chunk)) {
+			srv_stats.n_col_mirror_chunks_skipped.inc();
+			scan->row = (chunk + 1) * COL_MIRROR_CHUNK_ROWS;
+			continue;
+		}
+
+		trx_id_t	next = snapshot->next_trx[scan->row++].load(
+			std::memory_order_acquire);
+
+		if (!scan->sel[i]
+		    || (next && read_view_sees_trx_id(view, next))) {
+			continue;
+		}
+
+		col_mirror_scan_store(scan, i, buf, heap);
+		return(0);
+	}
+
+	while (scan->delta < scan->n_deltas) {
+		const col_mirror_delta_t*	delta = &scan->blocks[
+			scan->delta / COL_MIRROR_DELTA_BLOCK][
+			scan->delta % COL_MIRROR_DELTA_BLOCK];
+
+		scan->delta++;
+
+		if (!delta->image.empty()
+		    && col_mirror_delta_visible(delta, view)) {
+			col_mirror_image_to_rec(scan->table, delta->image,
+						buf, heap);
+			return(0);
+		}
+	}
+
+	return(HA_ERR_END_OF_FILE);
+}
+
+/*******************************************************************//**
+Completes the chunk being built. */
+static
+void
+col_mirror_build_chunk(
+/*===================*/
+	col_mirror_scan_t*	scan)	/*!< in/out: scan */
+{
+	col_mirror_snapshot_t*	snapshot = scan->snapshot;
+	ulint			n = scan->build_n;
+
+	for (ulint c = 0; c < snapshot->columns.size(); c++) {
+		col_mirror_column_t*	col = &snapshot->columns[c];
+		col_mirror_chunk_t*	chunk = &col->chunks.back();
+		const byte*		nulls = &scan->build_nulls[
+			c * COL_MIRROR_CHUNK_ROWS];
+
+		if (col->kind == COL_MIRROR_INT) {
+			col_mirror_pack(chunk, &scan->build_keys[
+						c * COL_MIRROR_CHUNK_ROWS],
+					nulls, n);
+		}
+
+		for (ulint i = 0; i < n; i++) {
+			if (nulls[i]) {
+				chunk->nulls.resize(
+					(COL_MIRROR_CHUNK_ROWS + 7) / 8, 0);
+				chunk->nulls[i >> 3] |= (byte) (1 << (i & 7));
+			}
+		}
+	}
+
+	scan->build_n = 0;
+}
+
+/*******************************************************************//**
+Adds a row returned by a scan building a column store. */
+UNIV_INTERN
+void
+innobase_col_mirror_scan_add(
+/*=========================*/
+	col_mirror_scan_t*	scan,	/*!< in/out: scan state */
+	const uchar*		buf)	/*!< in: whole row in MySQL format */
+{
+	col_mirror_snapshot_t*	snapshot = scan->snapshot;
+	ulint			i = scan->build_n;
+
+	ut_ad(scan->mode == COL_MIRROR_SCAN_BUILD);
+
+	for (ulint c = 0; c < snapshot->columns.size(); c++) {
+		col_mirror_column_t*	col = &snapshot->columns[c];
+		bool			is_null = col->null_bit
+			&& (buf[col->null_offset] & col->null_bit);
+
+		if (i == 0) {
+			col->chunks.push_back(col_mirror_chunk_t());
+			if (col->kind != COL_MIRROR_INT) {
+				col->chunks.back().offsets.push_back(0);
+			}
+		}
+
+		col_mirror_chunk_t*	chunk = &col->chunks.back();
+
+		scan->build_nulls[c * COL_MIRROR_CHUNK_ROWS + i] = is_null;
+
+		if (col->kind == COL_MIRROR_INT) {
+			scan->build_keys[c * COL_MIRROR_CHUNK_ROWS + i]
+				= is_null ? 0 : col_mirror_int_key(
+					buf + col->offset, col->length,
+					col->is_unsigned);
+			continue;
+		}
+
+		if (!is_null) {
+			col_mirror_append_value(&chunk->data, col, buf);
+		}
+		chunk->offsets.push_back((uint32) chunk->data.size());
+	}
+
+	col_mirror_pk(scan->table, buf, &scan->pk);
+	snapshot->rows.insert(std::make_pair(scan->pk, snapshot->n_rows));
+	snapshot->n_rows++;
+
+	if (++scan->build_n == COL_MIRROR_CHUNK_ROWS) {
+		col_mirror_build_chunk(scan);
+	}
+}
+
+/*******************************************************************//**
+Counts the memory of the base rows of a snapshot built by a scan. */
+static
+void
+col_mirror_count_base(
+/*==================*/
+	col_mirror_snapshot_t*	snapshot)	/*!< in/out: snapshot */
+{
+	ulint	n = snapshot->n_rows * sizeof(*snapshot->next_trx);
+
+	for (ulint c = 0; c < snapshot->columns.size(); c++) {
+		const col_mirror_column_t*	col = &snapshot->columns[c];
+
+		for (ulint i = 0; i < col->chunks.size(); i++) {
+			const col_mirror_chunk_t*	chunk = &col->chunks[i];
+
+			n += sizeof(*chunk)
+				+ chunk->packed.size()
+				* sizeof(chunk->packed[0])
+				+ chunk->offsets.size()
+				* sizeof(chunk->offsets[0])
+				+ chunk->data.size() + chunk->nulls.size();
+		}
+	}
+
+	for (std::unordered_map<std::string, ib_uint64_t>::const_iterator it
+		     = snapshot->rows.begin();
+	     it != snapshot->rows.end(); ++it) {
+		n += it->first.size() + COL_MIRROR_ROW_OVERHEAD;
+	}
+
+	snapshot->grow(n);
+}
+
+/*******************************************************************//**
+Installs a snapshot built by a scan, after applying to it the changes
+committed since which its view does not see. A snapshot which would take
+the column stores above innodb_column_mirror_max_size is not installed,
+and the build is not started again until the store needs one.
+@return true if installed */
+static
+bool
+col_mirror_install(
+/*===============*/
+	col_mirror_scan_t*	scan)	/*!< in/out: scan */
+{
+	col_mirror_t*		mirror = scan->mirror;
+	col_mirror_snapshot_t*	snapshot = scan->snapshot;
+	col_mirror_snapshot_t*	old = NULL;
+	bool			installed = false;
+
+	if (scan->build_n) {
+		col_mirror_build_chunk(scan);
+	}
+
+	snapshot->next_trx = new std::atomic<trx_id_t>[snapshot->n_rows];
+	snapshot->n_next_trx = snapshot->n_rows;
+	for (ulint i = 0; i < snapshot->n_rows; i++) {
+		snapshot->next_trx[i].store(0, std::memory_order_relaxed);
+	}
+
+	col_mirror_count_base(snapshot);
+
+	mysql_mutex_lock(&mirror->mutex);
+
+	mirror->building = false;
+
+	if (mirror->generation.load() == scan->generation
+	    && mirror->pending_epoch == scan->epoch
+	    && mirror->pending_active
+	    && col_mirror_bytes.load()
+	    - (mirror->snapshot ? mirror->snapshot->size : 0)
+	    > srv_col_mirror_max_size) {
+
+		mirror->pending.clear();
+		mirror->pending_active = false;
+
+	} else if (mirror->generation.load() == scan->generation
+		   && mirror->pending_epoch == scan->epoch
+		   && mirror->pending_active) {
+
+		for (ulint i = 0; i < mirror->pending.size(); i++) {
+			const col_mirror_change_t&	change
+				= mirror->pending[i];
+
+			if (!snapshot->view.sees(change.trx_id)) {
+				col_mirror_snapshot_apply(
+					snapshot, change.trx_id,
+					change.pk, change.image);
+			}
+		}
+
+		mirror->pending.clear();
+		mirror->pending_active = false;
+
+		old = mirror->snapshot;
+		if (old && --old->ref_count) {
+			old = NULL;
+		}
+		mirror->snapshot = snapshot;
+		installed = true;
+	}
+
+	mysql_mutex_unlock(&mirror->mutex);
+
+	delete old;
+
+	if (installed) {
+		srv_stats.n_col_mirror_builds.inc();
+	}
+
+	return(installed);
+}
+
+/*******************************************************************//**
+Ends a scan. A scan building a column store installs it if it read the
+whole table. */
+UNIV_INTERN
+void
+innobase_col_mirror_scan_end(
+/*=========================*/
+	col_mirror_scan_t*	scan,	/*!< in/out: scan state, or NULL */
+	bool			at_end)	/*!< in: true if the scan returned
+					all the rows of the table */
+{
+	if (scan == NULL) {
+		return;
+	}
+
+	switch (scan->mode) {
+	case COL_MIRROR_SCAN_NONE:
+		return;
+	case COL_MIRROR_SCAN_READ:
+		col_mirror_snapshot_release(scan->mirror, scan->snapshot);
+		scan->blocks.clear();
+		break;
+	case COL_MIRROR_SCAN_BUILD:
+		if (!at_end || !col_mirror_install(scan)) {
+			if (!at_end) {
+				mysql_mutex_lock(&scan->mirror->mutex);
+				scan->mirror->building = false;
+				mysql_mutex_unlock(&scan->mirror->mutex);
+			}
+			delete scan->snapshot;
+		}
+		scan->build_keys.clear();
+		scan->build_nulls.clear();
+		break;
+	}
+
+	scan->snapshot = NULL;
+	scan->mode = COL_MIRROR_SCAN_NONE;
+}
+
+/*******************************************************************//**
+Frees the state of the scans of a handler. */
+UNIV_INTERN
+void
+innobase_col_mirror_scan_free(
+/*==========================*/
+	col_mirror_scan_t*	scan)	/*!< in, own: scan state, or NULL */
+{
+	innobase_col_mirror_scan_end(scan, false);
+	delete scan;
+}
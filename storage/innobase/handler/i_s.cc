@@ -6817,6 +6817,42 @@ static ST_FIELD_INFO	innodb_sys_tablestats_fields_info[] =
 	 STRUCT_FLD(old_name,		""),
 	 STRUCT_FLD(open_method,	SKIP_OPEN_TABLE)},
 
+#define SYS_TABLESTATS_VERS_BUILDS	9
+	{STRUCT_FLD(field_name,		"VERSION_BUILDS"),
+	 STRUCT_FLD(field_length,	MY_INT64_NUM_DECIMAL_DIGITS),
+	 STRUCT_FLD(field_type,		MYSQL_TYPE_LONGLONG),
+	 STRUCT_FLD(value,		0),
+	 STRUCT_FLD(field_flags,	MY_I_S_UNSIGNED),
+	 STRUCT_FLD(old_name,		""),
+	 STRUCT_FLD(open_method,	SKIP_OPEN_TABLE)},
+
+#define SYS_TABLESTATS_VERS_BUILD_STEPS	10
+	{STRUCT_FLD(field_name,		"VERSION_BUILD_STEPS"),
+	 STRUCT_FLD(field_length,	MY_INT64_NUM_DECIMAL_DIGITS),
+	 STRUCT_FLD(field_type,		MYSQL_TYPE_LONGLONG),
+	 STRUCT_FLD(value,		0),
+	 STRUCT_FLD(field_flags,	MY_I_S_UNSIGNED),
+	 STRUCT_FLD(old_name,		""),
+	 STRUCT_FLD(open_method,	SKIP_OPEN_TABLE)},
+
+#define SYS_TABLESTATS_VERS_BUILD_MAX_DEPTH	11
+	{STRUCT_FLD(field_name,		"VERSION_BUILD_MAX_DEPTH"),
+	 STRUCT_FLD(field_length,	MY_INT64_NUM_DECIMAL_DIGITS),
+	 STRUCT_FLD(field_type,		MYSQL_TYPE_LONGLONG),
+	 STRUCT_FLD(value,		0),
+	 STRUCT_FLD(field_flags,	MY_I_S_UNSIGNED),
+	 STRUCT_FLD(old_name,		""),
+	 STRUCT_FLD(open_method,	SKIP_OPEN_TABLE)},
+
+#define SYS_TABLESTATS_VERS_CACHE_HITS	12
+	{STRUCT_FLD(field_name,		"VERSION_CACHE_HITS"),
+	 STRUCT_FLD(field_length,	MY_INT64_NUM_DECIMAL_DIGITS),
+	 STRUCT_FLD(field_type,		MYSQL_TYPE_LONGLONG),
+	 STRUCT_FLD(value,		0),
+	 STRUCT_FLD(field_flags,	MY_I_S_UNSIGNED),
+	 STRUCT_FLD(old_name,		""),
+	 STRUCT_FLD(open_method,	SKIP_OPEN_TABLE)},
+
 	END_OF_ST_FIELD_INFO
 };
 
@@ -6879,6 +6915,18 @@ i_s_dict_fill_sys_tablestats(
 	OK(fields[SYS_TABLESTATS_TABLE_REF_COUNT]->store(
 		static_cast<double>(table->n_ref_count)));
 
+	OK(fields[SYS_TABLESTATS_VERS_BUILDS]->store(
+		table->n_vers_builds, TRUE));
+
+	OK(fields[SYS_TABLESTATS_VERS_BUILD_STEPS]->store(
+		table->n_vers_build_steps, TRUE));
+
+	OK(fields[SYS_TABLESTATS_VERS_BUILD_MAX_DEPTH]->store(
+		table->max_vers_build_depth, TRUE));
+
+	OK(fields[SYS_TABLESTATS_VERS_CACHE_HITS]->store(
+		table->n_vers_cache_hits, TRUE));
+
 	OK(schema_table_store_record(thd, table_to_fill));
 
 	DBUG_RETURN(0);
@@ -189,6 +189,23 @@ btr_cur_open_at_index_side_func(
 	MY_ATTRIBUTE((nonnull));
 #define btr_cur_open_at_index_side(f,i,l,c,lv,m)			\
 	btr_cur_open_at_index_side_func(f,i,l,c,lv,__FILE__,__LINE__,m)
+/*****************************************************************//**
+Issues asynchronous reads for the pages on the path from the root of an
+index to the leaf page that a search with the given tuple and mode would
+end up on. Non-leaf pages that are already being read are waited for.
+@return TRUE if a non-leaf page read was issued and calling again later
+would descend further, FALSE if the whole path is in the buffer pool or
+has been requested */
+UNIV_INTERN
+ibool
+btr_cur_prefetch_path(
+/*==================*/
+	dict_index_t*	index,	/*!< in: index */
+	const dtuple_t*	tuple,	/*!< in: data tuple; if it has no fields,
+				the path to the first (mode PAGE_CUR_G or
+				PAGE_CUR_GE) or last leaf page is read */
+	ulint		mode)	/*!< in: PAGE_CUR_L, ... */
+	MY_ATTRIBUTE((nonnull));
 /**********************************************************************//**
 Positions a cursor at a randomly chosen position within a B-tree. */
 UNIV_INTERN
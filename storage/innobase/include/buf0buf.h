@@ -2299,6 +2299,11 @@ struct buf_pool_t{
 	single page flushing victim.  Protected by buf_pool::mutex. */
 	LRUItr		single_scan_itr;
 
+	/** "hazard pointer" used when freeing the pages of dropped
+	tablespaces, see buf_LRU_sweep_stale_pages().
+	Protected by buf_pool::mutex. */
+	LRUHp		stale_hp;
+
 	UT_LIST_BASE_NODE_T(buf_page_t) LRU;
 					/*!< base node of the LRU list */
 	buf_page_t*	LRU_old;	/*!< pointer to the about
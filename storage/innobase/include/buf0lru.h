@@ -65,6 +65,66 @@ buf_LRU_flush_or_remove_pages(
 	const trx_t*	trx);		/*!< to check if the operation must
 					be interrupted */
 
+/******************************************************************//**
+Initializes the list of stale tablespaces. */
+UNIV_INTERN
+void
+buf_LRU_stale_init(void);
+/*====================*/
+
+/******************************************************************//**
+Frees the list of stale tablespaces. */
+UNIV_INTERN
+void
+buf_LRU_stale_free(void);
+/*====================*/
+
+/******************************************************************//**
+Marks a dropped tablespace stale: its pages stay in the buffer pool until
+buf_LRU_sweep_stale_pages() frees them, and fil_io() skips their writes. */
+UNIV_INTERN
+void
+buf_LRU_mark_space_stale(
+/*=====================*/
+	ulint	id);	/*!< in: space id */
+
+/******************************************************************//**
+Checks if a tablespace was dropped while its pages were left in the
+buffer pool.
+@return true if the space is stale */
+UNIV_INTERN
+bool
+buf_LRU_space_is_stale(
+/*===================*/
+	ulint	id);	/*!< in: space id */
+
+/******************************************************************//**
+Checks if any tablespace is stale.
+@return true if buf_LRU_sweep_stale_pages() has work to do */
+UNIV_INTERN
+bool
+buf_LRU_have_stale_spaces(void);
+/*===========================*/
+
+/******************************************************************//**
+Frees the buffer pool pages of the stale tablespaces, and forgets about
+the tablespaces that have no page left. Called by the page cleaner,
+and when an index must wait for its adaptive hash index entries to be
+dropped. */
+UNIV_INTERN
+void
+buf_LRU_sweep_stale_pages(void);
+/*===========================*/
+
+/******************************************************************//**
+Removes the pages of a stale tablespace before its id is used again by
+a new tablespace, as for an IMPORT after a DISCARD. */
+UNIV_INTERN
+void
+buf_LRU_reclaim_stale_space(
+/*========================*/
+	ulint	id);	/*!< in: space id */
+
 #if defined UNIV_DEBUG || defined UNIV_BUF_DEBUG
 /********************************************************************//**
 Insert a compressed block into buf_pool->zip_clean in the LRU order. */
@@ -65,8 +65,11 @@ enum buf_remove_t {
 					pool, don't write or sync to disk */
 	BUF_REMOVE_FLUSH_NO_WRITE,	/*!< Remove only, from the flush list,
 					don't write or sync to disk */
-	BUF_REMOVE_FLUSH_WRITE		/*!< Flush dirty pages to disk only
+	BUF_REMOVE_FLUSH_WRITE,		/*!< Flush dirty pages to disk only
 					don't remove from the buffer pool */
+	BUF_REMOVE_LAZY			/*!< Mark the space stale only; its
+					pages are freed without being written
+					as the page cleaner reaches them */
 };
 
 /** Flags for io_fix types */
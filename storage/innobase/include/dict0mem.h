@@ -1196,6 +1196,24 @@ struct dict_table_t{
 				Writes are covered by dict_sys->mutex.
 				Dirty reads are possible. */
 				/* @} */
+	/*----------------------*/
+				/**!< Statistics of the old versions of rows
+				built by consistent reads, shown in
+				INFORMATION_SCHEMA.INNODB_SYS_TABLESTATS;
+				they are not protected by any latch */
+				/* @{ */
+	ulint		n_vers_builds;
+				/*!< number of old versions built */
+	ulint		n_vers_build_steps;
+				/*!< number of undo log records applied
+				to build them */
+	ulint		max_vers_build_depth;
+				/*!< largest number of undo log records
+				applied to build one version */
+	ulint		n_vers_cache_hits;
+				/*!< number of old versions found in the
+				version cache of the read view */
+				/* @} */
 	/*----------------------*/
 				/**!< The following fields are used by the
 				AUTOINC code.  The actual collection of
@@ -1271,6 +1289,15 @@ struct dict_table_t{
 	UT_LIST_BASE_NODE_T(lock_t)
 			locks;	/*!< list of locks on the table; protected
 				by lock_sys->mutex */
+	/*----------------------*/
+	col_mirror_t*	col_mirror;
+				/*!< in-memory column store of the table,
+				see handler0mirror.h, or NULL; created
+				under dict_sys->mutex */
+	ulint		col_mirror_version;
+				/*!< value of the innodb_column_mirror_tables
+				version when the table was last checked
+				against the list */
 #endif /* !UNIV_HOTBACKUP */
 
 #ifdef UNIV_DEBUG
@@ -32,6 +32,8 @@ struct dict_field_t;
 struct dict_index_t;
 struct dict_table_t;
 struct dict_foreign_t;
+/** In-memory column store of a table, see handler0mirror.h */
+struct col_mirror_t;
 
 struct ind_node_t;
 struct tab_node_t;
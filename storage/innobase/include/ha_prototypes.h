@@ -35,6 +35,7 @@ Created 5/11/2006 Osku Salerma
 #include "debug_sync.h"
 
 #include "trx0types.h"
+#include "dict0types.h"
 #include "m_ctype.h" /* CHARSET_INFO */
 
 // Forward declarations
@@ -659,4 +660,58 @@ innobase_timeout_message(
 	const char*	name1,	 /* in: first item */
 	const char*	name2);	 /* in: second item */
 
+/*******************************************************************//**
+Applies the changes a transaction made to tables with a column store at
+its commit, or discards them when it was rolled back. */
+UNIV_INTERN
+void
+innobase_col_mirror_trx_end(
+/*========================*/
+	trx_t*	trx,		/*!< in/out: transaction */
+	ibool	for_commit);	/*!< in: FALSE on rollback */
+
+/*******************************************************************//**
+Discards the changes to tables with a column store that a rollback to a
+savepoint undid. */
+UNIV_INTERN
+void
+innobase_col_mirror_trx_rollback(
+/*=============================*/
+	trx_t*		trx,		/*!< in/out: transaction */
+	undo_no_t	undo_no);	/*!< in: undo number of the savepoint */
+
+/*******************************************************************//**
+Frees the changes to tables with a column store of a transaction. */
+UNIV_INTERN
+void
+innobase_col_mirror_trx_free(
+/*=========================*/
+	trx_t*	trx);	/*!< in/out: transaction */
+
+/*******************************************************************//**
+Stops keeping the rows of a table written through the InnoDB API, before
+the write. Only the handler captures the rows written to a table. */
+UNIV_INTERN
+void
+innobase_col_mirror_api_write(
+/*==========================*/
+	dict_table_t*	table);	/*!< in/out: InnoDB table */
+
+/*******************************************************************//**
+Gets the memory of the column stores of all the tables.
+@return bytes */
+UNIV_INTERN
+ulint
+innobase_col_mirror_size(void);
+/*==========================*/
+
+/*******************************************************************//**
+Frees the column store of a table evicted or dropped from the dictionary
+cache. */
+UNIV_INTERN
+void
+innobase_col_mirror_free(
+/*=====================*/
+	dict_table_t*	table);	/*!< in/out: table */
+
 #endif /* HA_INNODB_PROTOTYPES_H */
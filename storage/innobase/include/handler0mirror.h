@@ -0,0 +1,223 @@
+/*****************************************************************************
+
+Copyright (c) 2020, Facebook, Inc. All Rights Reserved.
+
+This program is free software; you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation; version 2 of the License.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program; if not, write to the Free Software Foundation, Inc.,
+51 Franklin Street, Suite 500, Boston, MA 02110-1335 USA
+
+*****************************************************************************/
+
+/**************************************************//**
+@file include/handler0mirror.h
+In-memory column stores of InnoDB tables
+
+The tables listed in innodb_column_mirror_tables get an in-memory copy of
+their rows, kept by column, that consistent table scans read instead of
+the clustered index.
+
+A column store is built by a full table scan: the rows it returns make the
+base of the store, which is the table as the read view of the scan sees
+it. Integer columns are kept frame-of-reference and bit-packed by chunks
+of COL_MIRROR_CHUNK_ROWS rows, with the smallest and largest value of each
+chunk, other columns in their packed MySQL format.
+
+The rows written by the handler are captured in the transaction, and
+applied at commit to the store as delta rows tagged with the transaction
+id, before the transaction becomes visible to new read views. Each version
+of a row records the first transaction that replaced or deleted it, so a
+read view sees the version created by a transaction it sees and not
+replaced by a transaction it sees, as in the clustered index.
+
+A scan uses a column store if its read view sees all the transactions the
+base of the store sees. The comparisons of integer columns with constants
+of a pushed condition skip the chunks and rows that cannot match.
+
+The rows written through the InnoDB API (innodb_memcached) bypass the
+handler: the first such write drops the rows of the store, and the table
+is not kept again while it stays in the dictionary cache. The column
+stores of all the tables take at most innodb_column_mirror_max_size
+bytes: a store whose base does not fit is not installed, and a store
+growing above it is dropped and built again.
+*******************************************************/
+
+#ifndef handler0mirror_h
+#define handler0mirror_h
+
+#include "univ.i"
+#include "dict0types.h"
+#include "trx0types.h"
+#include "mem0mem.h"
+
+struct TABLE;
+class Item;
+
+/** Number of rows of a chunk of the base of a column store */
+#define COL_MIRROR_CHUNK_ROWS	1024
+
+/** A full table scan, served from a column store or building one */
+struct col_mirror_scan_t;
+
+/** How a full table scan uses the column store of the table */
+enum col_mirror_scan_mode {
+	COL_MIRROR_SCAN_NONE,	/*!< the scan reads the clustered index */
+	COL_MIRROR_SCAN_READ,	/*!< the scan reads the column store */
+	COL_MIRROR_SCAN_BUILD	/*!< the scan reads the clustered index
+				and builds the column store from the
+				rows it returns */
+};
+
+#ifdef HAVE_PSI_INTERFACE
+extern mysql_pfs_key_t	col_mirror_mutex_key;
+extern mysql_pfs_key_t	col_mirror_list_mutex_key;
+#endif /* HAVE_PSI_INTERFACE */
+
+/*******************************************************************//**
+Initializes the list of tables with a column store from
+innodb_column_mirror_tables. */
+UNIV_INTERN
+void
+innobase_col_mirror_init(
+/*=====================*/
+	const char*	tables);	/*!< in: comma separated db.table */
+
+/*******************************************************************//**
+Frees the list of tables with a column store. */
+UNIV_INTERN
+void
+innobase_col_mirror_close(void);
+/*===========================*/
+
+/*******************************************************************//**
+Changes the list of tables with a column store. The tables check the list
+again when they are next used. */
+UNIV_INTERN
+void
+innobase_col_mirror_set_tables(
+/*===========================*/
+	const char*	tables);	/*!< in: comma separated db.table */
+
+/*******************************************************************//**
+Computes the layout of the rows of a MySQL table the column store of the
+table is made for. */
+UNIV_INTERN
+ulint
+innobase_col_mirror_layout(
+/*=======================*/
+	const TABLE*	table);		/*!< in: MySQL table */
+
+/*******************************************************************//**
+Gets the column store of a table, creating it when the table was added to
+innodb_column_mirror_tables.
+@return column store, or NULL if the table has none */
+UNIV_INTERN
+col_mirror_t*
+innobase_col_mirror_get(
+/*====================*/
+	dict_table_t*	table,		/*!< in/out: InnoDB table */
+	const TABLE*	mysql_table,	/*!< in: MySQL table */
+	ulint		layout);	/*!< in: innobase_col_mirror_layout() */
+
+/*******************************************************************//**
+Drops the rows of the column store of a table, after it was truncated or
+its tablespace discarded or imported. */
+UNIV_INTERN
+void
+innobase_col_mirror_reset(
+/*======================*/
+	dict_table_t*	table);		/*!< in/out: InnoDB table */
+
+/*******************************************************************//**
+Captures a row written to a table with a column store, to be applied to
+the store when the transaction commits. */
+UNIV_INTERN
+void
+innobase_col_mirror_capture(
+/*========================*/
+	col_mirror_t*	mirror,		/*!< in/out: column store */
+	trx_t*		trx,		/*!< in/out: transaction */
+	const TABLE*	table,		/*!< in: MySQL table */
+	undo_no_t	undo_no,	/*!< in: trx->undo_no before the
+					row was written */
+	const uchar*	old_rec,	/*!< in: row before the update or
+					delete, or NULL for an insert */
+	const uchar*	new_rec);	/*!< in: row after the insert or
+					update, or NULL for a delete */
+
+/*******************************************************************//**
+Counts the rows of a table a transaction sees, from the column store.
+@return number of rows, or HA_POS_ERROR if the store cannot be used */
+UNIV_INTERN
+ha_rows
+innobase_col_mirror_count(
+/*======================*/
+	col_mirror_t*	mirror,		/*!< in: column store */
+	trx_t*		trx);		/*!< in/out: transaction, with a read
+					view */
+
+/*******************************************************************//**
+Starts a full table scan on a table with a column store.
+@return how the scan uses the store */
+UNIV_INTERN
+col_mirror_scan_mode
+innobase_col_mirror_scan_start(
+/*===========================*/
+	col_mirror_scan_t**	scan,	/*!< in/out: scan state, allocated
+					on first use */
+	col_mirror_t*		mirror,	/*!< in/out: column store */
+	trx_t*			trx,	/*!< in/out: transaction, with a
+					read view */
+	const TABLE*		table,	/*!< in: MySQL table */
+	const Item*		cond);	/*!< in: pushed condition, or NULL */
+
+/*******************************************************************//**
+Reads the next row of a scan served from a column store. The columns of
+the read set and of the primary key are set.
+@return 0 or HA_ERR_END_OF_FILE */
+UNIV_INTERN
+int
+innobase_col_mirror_scan_next(
+/*==========================*/
+	col_mirror_scan_t*	scan,	/*!< in/out: scan state */
+	uchar*			buf,	/*!< out: row in MySQL format */
+	mem_heap_t**		heap);	/*!< in/out: heap for the values of
+					BLOB columns, emptied for each
+					row */
+
+/*******************************************************************//**
+Adds a row returned by a scan building a column store. */
+UNIV_INTERN
+void
+innobase_col_mirror_scan_add(
+/*=========================*/
+	col_mirror_scan_t*	scan,	/*!< in/out: scan state */
+	const uchar*		buf);	/*!< in: whole row in MySQL format */
+
+/*******************************************************************//**
+Ends a scan. A scan building a column store installs it if it read the
+whole table. */
+UNIV_INTERN
+void
+innobase_col_mirror_scan_end(
+/*=========================*/
+	col_mirror_scan_t*	scan,	/*!< in/out: scan state, or NULL */
+	bool			at_end);/*!< in: true if the scan returned
+					all the rows of the table */
+
+/*******************************************************************//**
+Frees the state of the scans of a handler. */
+UNIV_INTERN
+void
+innobase_col_mirror_scan_free(
+/*==========================*/
+	col_mirror_scan_t*	scan);	/*!< in, own: scan state, or NULL */
+
+#endif /* handler0mirror_h */
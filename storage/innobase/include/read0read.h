@@ -34,6 +34,8 @@ Created 2/16/1997 Heikki Tuuri
 #include "trx0trx.h"
 #include "read0types.h"
 
+struct row_vers_cache_t;
+
 /*********************************************************************//**
 Opens a read view where exactly the transactions serialized before this
 point in time are seen in the view.
@@ -158,6 +160,10 @@ struct read_view_t{
 				0 used in purge */
 	UT_LIST_NODE_T(read_view_t) view_list;
 				/*!< List of read views in trx_sys */
+	row_vers_cache_t* vers_cache;
+				/*!< versions of clustered index records
+				built for this view, or NULL; see
+				row_vers_build_for_consistent_read() */
 };
 
 /** Read view types @{ */
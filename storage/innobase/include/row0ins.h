@@ -32,6 +32,7 @@ Created 4/20/1996 Heikki Tuuri
 #include "dict0types.h"
 #include "trx0types.h"
 #include "row0types.h"
+#include "buf0types.h"
 
 /***************************************************************//**
 Checks if foreign key constraint fails for an index entry. Sets shared locks
@@ -248,6 +249,17 @@ struct ins_node_t{
 				entry_list and sys fields are stored here;
 				if this is NULL, entry list should be created
 				and buffers for sys fields in row allocated */
+	ibool		batch;	/*!< TRUE if the row is one of a batch of
+				rows written by one handler call; the
+				clustered index leaf page of the previous
+				row of the batch is then kept in hint_block */
+	buf_block_t*	hint_block;
+				/*!< NULL, or the clustered index leaf page
+				where the previous row of the batch was
+				inserted */
+	ib_uint64_t	hint_modify_clock;
+				/*!< modify clock of hint_block after that
+				insert */
 	ulint		magic_n;
 };
 
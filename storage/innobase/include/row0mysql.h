@@ -736,6 +736,9 @@ struct row_prebuilt_t {
 	ins_node_t*	ins_node;	/*!< Innobase SQL insert node
 					used to perform inserts
 					to the table */
+	ibool		ins_batch;	/*!< TRUE while the rows of one
+					ha_innobase::write_rows() call are
+					inserted */
 	byte*		ins_upd_rec_buff;/*!< buffer for storing data converted
 					to the Innobase format from the MySQL
 					format */
@@ -855,6 +858,11 @@ struct row_prebuilt_t {
 					to this heap */
 	mem_heap_t*	old_vers_heap;	/*!< memory heap where a previous
 					version is built in consistent read */
+	ulint		undo_prefetch_page_no;
+					/*!< page number of the clustered
+					index page the undo log pages were
+					last read ahead for, or FIL_NULL;
+					see row_vers_prefetch_undo() */
 	bool		in_fts_query;	/*!< Whether we are in a FTS query */
 	/*----------------------*/
 	ulonglong	autoinc_last_value;
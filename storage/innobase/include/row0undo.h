@@ -59,6 +59,22 @@ row_undo_search_clust_to_pcur(
 /*==========================*/
 	undo_node_t*	node);	/*!< in: row undo node */
 /***********************************************************//**
+Undoes the operation of an undo log record that the caller popped with
+trx_roll_pop_top_rec_of_trx(). Used when the undo log records of a
+transaction are split among several threads. The caller must hold an
+s-latch on dict_operation_lock, and trx->dict_operation_lock_mode must be
+RW_S_LATCH.
+@return	DB_SUCCESS if operation successfully completed, else error code */
+UNIV_INTERN
+dberr_t
+row_undo_rec(
+/*=========*/
+	undo_node_t*	node,	/*!< in: row undo node */
+	que_thr_t*	thr,	/*!< in: query thread */
+	trx_undo_rec_t*	undo_rec,/*!< in: undo log record */
+	roll_ptr_t	roll_ptr)/*!< in: roll pointer to the record */
+	MY_ATTRIBUTE((nonnull, warn_unused_result));
+/***********************************************************//**
 Undoes a row operation in a table. This is a high-level function used
 in SQL execution graphs.
 @return	query thread to run next or NULL */
@@ -138,6 +138,31 @@ row_vers_build_for_semi_consistent_read(
 				it was freshly inserted afterwards */
 	MY_ATTRIBUTE((nonnull(1,2,3,4,5)));
 
+/*****************************************************************//**
+Issues asynchronous reads of the undo log pages holding the newest undo
+log records of the records of a clustered index page that a consistent
+read view does not see. A scan calls this when it first builds an old
+version on a page, so that the undo log pages of the page are read
+together instead of one by one as the scan reaches each record. */
+UNIV_INTERN
+void
+row_vers_prefetch_undo(
+/*===================*/
+	const rec_t*		rec,	/*!< in: record on the page; the
+					caller must have a latch on the
+					page */
+	dict_index_t*		index,	/*!< in: the clustered index */
+	const read_view_t*	view);	/*!< in: the consistent read view */
+
+/*****************************************************************//**
+Frees the versions of clustered index records built for a read view,
+when the view is closed. */
+UNIV_INTERN
+void
+row_vers_cache_free(
+/*================*/
+	read_view_t*	view);	/*!< in/out: read view */
+
 
 #ifndef UNIV_NONINL
 #include "row0vers.ic"
@@ -70,6 +70,13 @@ struct srv_stats_t {
 	/** Count the amount of step in row recreations */
 	ulint_ctr_1_t		row_recreation_steps;
 
+	/** Number of row recreations served from the version cache of
+	the read view */
+	ulint_ctr_1_t		row_recreation_cache_hits;
+
+	/** Number of undo log pages read ahead for row recreations */
+	ulint_ctr_1_t		row_recreation_undo_prefetches;
+
 	/** Number of the log write requests done */
 	ulint_ctr_1_t		log_write_requests;
 
@@ -148,6 +155,18 @@ struct srv_stats_t {
 	/** Number of buffered aio requests submitted */
 	ulint_ctr_64_t		n_aio_submitted;
 
+	/** Number of table scans served from a column store */
+	ulint_ctr_1_t		n_col_mirror_scans;
+
+	/** Number of column stores built */
+	ulint_ctr_1_t		n_col_mirror_builds;
+
+	/** Number of rows read from column stores */
+	ulint_ctr_64_t		n_col_mirror_rows_read;
+
+	/** Number of chunks of column stores skipped by scans */
+	ulint_ctr_1_t		n_col_mirror_chunks_skipped;
+
 	/** total number of pages that logical-read-ahead missed while doing
 	a table scan. The number is the total for all transactions that used a
 	non-zero innodb_lra_size. */
@@ -357,6 +376,8 @@ extern ulint	srv_buf_pool_size;	/*!< requested size in bytes */
 extern ulong	srv_buf_pool_chunk_unit;/*!< requested unit size of chunks in bytes */
 
 extern my_bool	srv_buf_pool_populate;	/*!< virtual page preallocation */
+extern my_bool	srv_buf_lazy_drop;	/*!< leave the pages of dropped
+					tablespaces in the buffer pool */
 extern ulint    srv_buf_pool_instances; /*!< requested number of buffer pool instances */
 extern ulong	srv_n_page_hash_locks;	/*!< number of locks to
 					protect buf_pool->page_hash */
@@ -615,6 +636,22 @@ extern ulong srv_n_purge_threads;
 /* the number of pages to purge in one batch */
 extern ulong srv_purge_batch_size;
 
+/* the number of threads rolling back the transactions left incomplete by
+a crash */
+extern ulong srv_n_rollback_threads;
+
+/* the largest size in bytes of the versions of clustered index records
+kept for a read view */
+extern ulong srv_mvcc_version_cache_size;
+
+/* whether scans read ahead the undo log pages needed to build old
+versions of the records of a clustered index page */
+extern my_bool srv_mvcc_undo_prefetch;
+
+/* the largest size in bytes of the in-memory column stores of the tables
+of innodb_column_mirror_tables */
+extern ulonglong srv_col_mirror_max_size;
+
 /* the number of sync wait arrays */
 extern ulong srv_sync_array_size;
 
@@ -1015,6 +1052,16 @@ srv_purge_wakeup(void);
 /** Status variables to be passed to MySQL */
 struct export_var_t{
 	ib_int64_t innodb_checkpoint_lsn;	/*!< last_checkpoint_lsn */
+	ulint innodb_column_mirror_builds;	/*!< srv_stats.
+						n_col_mirror_builds */
+	ulint innodb_column_mirror_bytes;	/*!< innobase_col_mirror_size() */
+	ulint innodb_column_mirror_chunks_skipped;
+						/*!< srv_stats.
+						n_col_mirror_chunks_skipped */
+	ulint innodb_column_mirror_rows_read;	/*!< srv_stats.
+						n_col_mirror_rows_read */
+	ulint innodb_column_mirror_scans;	/*!< srv_stats.
+						n_col_mirror_scans */
 	ib_int64_t innodb_checkpoint_diff;	/*!< lsn - last_checkpoint_lsn */
 	ulint innodb_data_pending_reads;	/*!< Pending reads */
 	ulint innodb_data_pending_writes;	/*!< Pending writes */
@@ -1141,6 +1188,8 @@ struct export_var_t{
 						/ 1000 */
   ulint innodb_row_recreations;  /*!< srv_stats.row_recreations */
   ulint innodb_row_recreation_steps;  /*!< srv_stats.row_recreation_steps */
+  ulint innodb_row_recreation_cache_hits;  /*!< srv_stats.row_recreation_cache_hits */
+  ulint innodb_row_recreation_undo_prefetches;  /*!< srv_stats.row_recreation_undo_prefetches */
 	ulint innodb_rows_read;			/*!< srv_n_rows_read */
 	ulint innodb_rows_inserted;		/*!< srv_n_rows_inserted */
 	ulint innodb_rows_updated;		/*!< srv_n_rows_updated */
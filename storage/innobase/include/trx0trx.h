@@ -1142,6 +1142,12 @@ struct trx_t{
 					with FTS indexes (yet). */
 	doc_id_t	fts_next_doc_id;/* The document id used for updates */
 	/*------------------------------*/
+	col_mirror_trx_t*
+			col_mirror_changes;
+					/*!< rows the transaction changed in
+					tables with a column store, applied
+					to it at commit; NULL if none */
+	/*------------------------------*/
 	ulint		flush_tables;	/*!< if "covering" the FLUSH TABLES",
 					count of tables being flushed. */
 
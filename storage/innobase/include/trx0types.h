@@ -93,6 +93,8 @@ struct roll_node_t;
 struct commit_node_t;
 /** SAVEPOINT command node in a query graph */
 struct trx_named_savept_t;
+/** Changes of a transaction to tables with a column store */
+struct col_mirror_trx_t;
 /* @} */
 
 /** Rollback contexts */
@@ -31,6 +31,7 @@ Created 2/16/1997 Heikki Tuuri
 
 #include "srv0srv.h"
 #include "trx0sys.h"
+#include "row0vers.h"
 
 /*
 -------------------------------------------------------------------------------
@@ -192,6 +193,7 @@ read_view_create_low(
 
 	view->n_trx_ids = n;
 	view->trx_ids = (trx_id_t*) &view[1];
+	view->vers_cache = NULL;
 
 	return(view);
 }
@@ -231,10 +233,12 @@ read_view_clone(
 	memcpy(clone, view, sz);
 
 	clone->trx_ids = (trx_id_t*) &clone[1];
+	clone->vers_cache = NULL;
 
 	new_view = (read_view_t*) &clone->trx_ids[clone->n_trx_ids];
 	new_view->trx_ids = (trx_id_t*) &new_view[1];
 	new_view->n_trx_ids = clone->n_trx_ids + 1;
+	new_view->vers_cache = NULL;
 
 	ut_a(new_view->n_trx_ids == view->n_trx_ids + 1);
 
@@ -489,6 +493,8 @@ read_view_close_for_mysql(
 
 	read_view_remove(trx->global_read_view, false);
 
+	row_vers_cache_free(trx->global_read_view);
+
 	mem_heap_empty(trx->global_read_view_heap);
 
 	trx->read_view = NULL;
@@ -622,6 +628,8 @@ read_cursor_view_close_for_mysql(
 
 	read_view_remove(curview->read_view, false);
 
+	row_vers_cache_free(curview->read_view);
+
 	trx->read_view = trx->global_read_view;
 
 	mem_heap_free(curview->heap);
@@ -100,6 +100,9 @@ ins_node_create(
 
 	node->entry_sys_heap = mem_heap_create(128);
 
+	node->batch = FALSE;
+	node->hint_block = NULL;
+
 	node->magic_n = INS_NODE_MAGIC_N;
 
 	return(node);
@@ -2297,6 +2300,104 @@ row_ins_must_modify_rec(
 	       && !page_rec_is_infimum(btr_cur_get_rec(cursor)));
 }
 
+/***************************************************************//**
+Gets the insert node of a row that is inserted as part of a batch.
+@return the insert node, or NULL if thr is not inserting a row of a batch */
+static
+ins_node_t*
+row_ins_get_batch_node(
+/*===================*/
+	que_thr_t*	thr)	/*!< in: query thread or NULL */
+{
+	ins_node_t*	node;
+
+	if (thr == NULL || thr->run_node == NULL
+	    || que_node_get_type(thr->run_node) != QUE_NODE_INSERT) {
+		return(NULL);
+	}
+
+	node = static_cast<ins_node_t*>(thr->run_node);
+
+	return(node->batch ? node : NULL);
+}
+
+/***************************************************************//**
+Positions a cursor for inserting an entry into the clustered index leaf
+page where the previous row of the batch was inserted, without a descent
+down the tree. This is done only if the page is still a leaf of the
+index, and the entry sorts between two records of the page, or after
+the last record of the rightmost leaf, or before the first record of the
+leftmost leaf, so that a descent would end on the same page.
+@return true if the cursor is positioned and the page is x-latched;
+false if the mtr holds no latches, and a descent is needed */
+static
+bool
+row_ins_clust_index_position_by_hint(
+/*=================================*/
+	ins_node_t*	node,	/*!< in/out: insert node with the hint */
+	dict_index_t*	index,	/*!< in: clustered index */
+	const dtuple_t*	entry,	/*!< in: index entry to insert */
+	btr_cur_t*	cursor,	/*!< out: cursor on the record to
+				insert after */
+	que_thr_t*	thr,	/*!< in: query thread */
+	mtr_t*		mtr)	/*!< in/out: mtr, started and holding
+				no latches */
+{
+	buf_block_t*	block	= node->hint_block;
+	const page_t*	page;
+	const rec_t*	rec;
+
+	if (block == NULL) {
+		return(false);
+	}
+
+	if (!buf_page_optimistic_get(RW_X_LATCH, block,
+				     node->hint_modify_clock,
+				     __FILE__, __LINE__, mtr)) {
+		node->hint_block = NULL;
+		return(false);
+	}
+
+	page = buf_block_get_frame(block);
+
+	if (buf_block_get_space(block) != dict_index_get_space(index)
+	    || !page_is_leaf(page)
+	    || btr_page_get_index_id(page) != index->id) {
+		goto no_hint;
+	}
+
+	cursor->index = index;
+	cursor->flag = BTR_CUR_BINARY;
+	cursor->up_match = 0;
+	cursor->up_bytes = 0;
+	cursor->low_match = 0;
+	cursor->low_bytes = 0;
+
+	page_cur_search_with_match(
+		block, index, entry, PAGE_CUR_LE,
+		&cursor->up_match, &cursor->up_bytes,
+		&cursor->low_match, &cursor->low_bytes,
+		btr_cur_get_page_cur(cursor));
+
+	rec = btr_cur_get_rec(cursor);
+
+	if ((page_rec_is_infimum(rec)
+	     && btr_page_get_prev(page, mtr) != FIL_NULL)
+	    || (page_rec_is_supremum(page_rec_get_next_const(rec))
+		&& btr_page_get_next(page, mtr) != FIL_NULL)) {
+		goto no_hint;
+	}
+
+	return(true);
+
+no_hint:
+	/* Release the page, the caller descends in a new mtr */
+	node->hint_block = NULL;
+	mtr_commit(mtr);
+	mtr_start_trx(mtr, thr_get_trx(thr));
+	return(false);
+}
+
 /***************************************************************//**
 Tries to insert an entry into a clustered index, ignoring foreign key
 constraints. If a record with the same unique key is found, the other
@@ -2344,6 +2445,7 @@ row_ins_clust_index_entry_low(
 	big_rec_t*	big_rec		= NULL;
 	mtr_t		mtr;
 	mem_heap_t*	offsets_heap	= NULL;
+	ins_node_t*	batch_node	= NULL;
 
 	ut_ad(dict_index_is_clust(index));
 	ut_ad(!dict_index_is_unique(index)
@@ -2359,12 +2461,21 @@ row_ins_clust_index_entry_low(
 
 	cursor.thr = thr;
 
+	if (mode == BTR_MODIFY_LEAF) {
+		batch_node = row_ins_get_batch_node(thr);
+	}
+
 	/* Note that we use PAGE_CUR_LE as the search mode, because then
 	the function will return in both low_match and up_match of the
 	cursor sensible values */
 
-	btr_cur_search_to_nth_level(index, 0, entry, PAGE_CUR_LE, mode,
-				    &cursor, 0, __FILE__, __LINE__, &mtr);
+	if (batch_node == NULL
+	    || !row_ins_clust_index_position_by_hint(
+		    batch_node, index, entry, &cursor, thr, &mtr)) {
+		btr_cur_search_to_nth_level(index, 0, entry, PAGE_CUR_LE,
+					    mode, &cursor, 0,
+					    __FILE__, __LINE__, &mtr);
+	}
 
 #ifdef UNIV_DEBUG
 	{
@@ -2507,6 +2618,17 @@ err_exit:
 				*modify_clock = buf_block_get_modify_clock(
 						btr_cur_get_block(&cursor));
 			}
+			if (batch_node != NULL) {
+				/* The next row of the batch is likely to
+				go to the same page */
+				batch_node->hint_block = err == DB_SUCCESS
+					? btr_cur_get_block(&cursor) : NULL;
+				if (err == DB_SUCCESS) {
+					batch_node->hint_modify_clock =
+						buf_block_get_modify_clock(
+							batch_node->hint_block);
+				}
+			}
 		} else {
 			if (buf_LRU_buf_pool_running_out()) {
 
@@ -815,6 +815,8 @@ row_create_prebuilt(
 	prebuilt->magic_n = ROW_PREBUILT_ALLOCATED;
 	prebuilt->magic_n2 = ROW_PREBUILT_ALLOCATED;
 
+	prebuilt->undo_prefetch_page_no = FIL_NULL;
+
 	prebuilt->table = table;
 
 	prebuilt->sql_stat_start = TRUE;
@@ -1363,6 +1365,11 @@ row_insert_for_mysql(
 	row_get_prebuilt_insert_row(prebuilt);
 	node = prebuilt->ins_node;
 
+	node->batch = prebuilt->ins_batch;
+	if (!node->batch) {
+		node->hint_block = NULL;
+	}
+
 	row_mysql_convert_row_to_innobase(node->row, prebuilt, mysql_rec);
 
 	savept = trx_savept_take(trx);
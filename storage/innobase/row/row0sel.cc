@@ -4232,6 +4232,7 @@ row_search_for_mysql(
 		prebuilt->n_rows_fetched = 0;
 		prebuilt->n_fetch_cached = 0;
 		prebuilt->fetch_cache_first = 0;
+		prebuilt->undo_prefetch_page_no = FIL_NULL;
 
 		if (prebuilt->sel_graph == NULL) {
 			/* Build a dummy select query graph */
@@ -5048,6 +5049,20 @@ no_gap_lock:
 				    rec, index, offsets, trx->read_view)) {
 
 				rec_t*	old_vers;
+
+				if (srv_mvcc_undo_prefetch
+				    && prebuilt->undo_prefetch_page_no
+				    != page_get_page_no(page_align(rec))) {
+					/* Read ahead the undo log pages
+					for the other records of the page */
+					prebuilt->undo_prefetch_page_no
+						= page_get_page_no(
+							page_align(rec));
+					row_vers_prefetch_undo(
+						rec, clust_index,
+						trx->read_view);
+				}
+
 				/* The following call returns 'offsets'
 				associated with 'old_vers' */
 				err = row_sel_build_prev_vers_for_mysql(
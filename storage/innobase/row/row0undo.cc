@@ -324,6 +324,39 @@ row_undo(
 	return(err);
 }
 
+/***********************************************************//**
+Undoes the operation of an undo log record that the caller popped with
+trx_roll_pop_top_rec_of_trx(). Used when the undo log records of a
+transaction are split among several threads. The caller must hold an
+s-latch on dict_operation_lock, and trx->dict_operation_lock_mode must be
+RW_S_LATCH.
+@return	DB_SUCCESS if operation successfully completed, else error code */
+UNIV_INTERN
+dberr_t
+row_undo_rec(
+/*=========*/
+	undo_node_t*	node,	/*!< in: row undo node */
+	que_thr_t*	thr,	/*!< in: query thread */
+	trx_undo_rec_t*	undo_rec,/*!< in: undo log record */
+	roll_ptr_t	roll_ptr)/*!< in: roll pointer to the record */
+{
+	ut_ad(node->state == UNDO_NODE_FETCH_NEXT);
+	ut_ad(node->trx->dict_operation_lock_mode == RW_S_LATCH);
+
+	node->undo_rec = undo_rec;
+	node->roll_ptr = roll_ptr;
+	node->undo_no = trx_undo_rec_get_undo_no(undo_rec);
+
+	if (trx_undo_roll_ptr_is_insert(roll_ptr)) {
+
+		node->state = UNDO_NODE_INSERT;
+	} else {
+		node->state = UNDO_NODE_MODIFY;
+	}
+
+	return(row_undo(node, thr));
+}
+
 /***********************************************************//**
 Undoes a row operation in a table. This is a high-level function used
 in SQL execution graphs.
@@ -46,11 +46,348 @@ Created 2/6/1997 Heikki Tuuri
 #include "read0read.h"
 #include "lock0lock.h"
 #include "srv0srv.h"
+#include "trx0sys.h"
+#include "buf0buf.h"
+#include "buf0rea.h"
+#include "hash0hash.h"
 
 #ifdef UNIV_DEBUG
 uint		row_build_prev_version_sleep = 0;
 #endif
 
+/** Number of cells in the hash table of a version cache */
+#define ROW_VERS_CACHE_CELLS	1024
+
+/** Largest number of undo log pages row_vers_prefetch_undo() reads
+for one clustered index page */
+#define ROW_VERS_PREFETCH_MAX	64
+
+/** A version of a clustered index record built for a read view */
+struct row_vers_cache_entry_t {
+	index_id_t	index_id;	/*!< the clustered index */
+	trx_id_t	trx_id;		/*!< DB_TRX_ID of the newest version */
+	roll_ptr_t	roll_ptr;	/*!< DB_ROLL_PTR of the newest version */
+	byte*		key;		/*!< the unique fields of the newest
+					version, each as a 4-byte length
+					followed by the data */
+	ulint		key_len;	/*!< length of key */
+	byte*		buf;		/*!< the version the view sees, with
+					its header, or NULL if the record
+					does not exist in the view */
+	ulint		extra_size;	/*!< rec_offs_extra_size() of the
+					version */
+	ulint		size;		/*!< rec_offs_size() of the version */
+	row_vers_cache_entry_t*	hash;	/*!< hash chain node */
+};
+
+/** Versions of clustered index records built for a read view, so that
+reading a record again in the view does not apply its undo log records
+again. The view cannot see the versions after the one it sees, and their
+undo log records cannot be purged while the view is open, so an entry is
+valid as long as the newest version of the record has the same DB_TRX_ID
+and DB_ROLL_PTR. DB_ROLL_PTR alone does not identify the record: after a
+partial rollback the transaction writes the undo log records of other
+records at the truncated offsets again. Entries therefore also keep the
+key of the record. A read view is only used by the thread of its
+transaction, so the cache needs no latch. */
+struct row_vers_cache_t {
+	mem_heap_t*	heap;		/*!< entries and versions */
+	hash_table_t*	hash;		/*!< entries, by DB_ROLL_PTR */
+};
+
+/*****************************************************************//**
+Gets the length of the key of a clustered index record in a version
+cache entry.
+@return length of the key */
+static
+ulint
+row_vers_cache_key_len(
+/*===================*/
+	const rec_t*		rec,	/*!< in: record */
+	const dict_index_t*	index,	/*!< in: the clustered index */
+	const ulint*		offsets)/*!< in: rec_get_offsets(rec) */
+{
+	ulint	len	= 0;
+
+	for (ulint i = 0; i < dict_index_get_n_unique(index); i++) {
+		ulint	field_len;
+
+		rec_get_nth_field_offs(offsets, i, &field_len);
+		len += 4 + (field_len == UNIV_SQL_NULL ? 0 : field_len);
+	}
+
+	return(len);
+}
+
+/*****************************************************************//**
+Checks if the key of a version cache entry is the key of a clustered
+index record.
+@return true if the entry is for the record */
+static
+bool
+row_vers_cache_key_eq(
+/*==================*/
+	const row_vers_cache_entry_t*	entry,	/*!< in: cache entry */
+	const rec_t*			rec,	/*!< in: record */
+	const dict_index_t*		index,	/*!< in: the clustered index */
+	const ulint*			offsets)/*!< in: rec_get_offsets(rec) */
+{
+	const byte*	key	= entry->key;
+	const byte*	end	= key + entry->key_len;
+
+	for (ulint i = 0; i < dict_index_get_n_unique(index); i++) {
+		ulint		field_len;
+		const byte*	field;
+
+		field = rec_get_nth_field(rec, offsets, i, &field_len);
+
+		if (key + 4 > end
+		    || mach_read_from_4(key) != field_len) {
+			return(false);
+		}
+
+		key += 4;
+
+		if (field_len != UNIV_SQL_NULL) {
+			if (key + field_len > end
+			    || memcmp(key, field, field_len)) {
+				return(false);
+			}
+
+			key += field_len;
+		}
+	}
+
+	return(key == end);
+}
+
+/*****************************************************************//**
+Looks up the version of a clustered index record built for a read view.
+@return the entry, or NULL */
+static
+const row_vers_cache_entry_t*
+row_vers_cache_find(
+/*================*/
+	const read_view_t*	view,	/*!< in: read view */
+	const dict_index_t*	index,	/*!< in: the clustered index */
+	const rec_t*		rec,	/*!< in: the newest version */
+	const ulint*		offsets,/*!< in: rec_get_offsets(rec) */
+	trx_id_t		trx_id,	/*!< in: DB_TRX_ID of the record */
+	roll_ptr_t		roll_ptr)/*!< in: DB_ROLL_PTR of the record */
+{
+	row_vers_cache_entry_t*	entry;
+
+	if (view->vers_cache == NULL) {
+		return(NULL);
+	}
+
+	HASH_SEARCH(hash, view->vers_cache->hash, ut_fold_ull(roll_ptr),
+		    row_vers_cache_entry_t*, entry, ut_ad(1),
+		    entry->roll_ptr == roll_ptr
+		    && entry->trx_id == trx_id
+		    && entry->index_id == index->id
+		    && row_vers_cache_key_eq(entry, rec, index, offsets));
+
+	return(entry);
+}
+
+/*****************************************************************//**
+Adds the version of a clustered index record built for a read view to
+its cache, unless the cache would grow over innodb_mvcc_version_cache_size. */
+static
+void
+row_vers_cache_add(
+/*===============*/
+	read_view_t*		view,	/*!< in/out: read view */
+	const dict_index_t*	index,	/*!< in: the clustered index */
+	const rec_t*		rec,	/*!< in: the newest version */
+	const ulint*		rec_offsets,/*!< in: rec_get_offsets(rec) */
+	trx_id_t		trx_id,	/*!< in: DB_TRX_ID of the record */
+	roll_ptr_t		roll_ptr,/*!< in: DB_ROLL_PTR of the record */
+	const rec_t*		vers,	/*!< in: the version the view sees,
+					or NULL */
+	const ulint*		offsets)/*!< in: rec_get_offsets(vers) */
+{
+	row_vers_cache_t*	cache	= view->vers_cache;
+	row_vers_cache_entry_t*	entry;
+	ulint			key_len;
+	ulint			size	= 0;
+	byte*			key;
+
+	if (vers != NULL) {
+		size = rec_offs_size(offsets);
+	}
+
+	key_len = row_vers_cache_key_len(rec, index, rec_offsets);
+	size += key_len;
+
+	if (cache == NULL) {
+		if (sizeof *entry + size > srv_mvcc_version_cache_size) {
+			return;
+		}
+
+		cache = static_cast<row_vers_cache_t*>(
+			ut_malloc(sizeof *cache));
+		cache->heap = mem_heap_create(UNIV_PAGE_SIZE);
+		cache->hash = hash_create(ROW_VERS_CACHE_CELLS);
+		view->vers_cache = cache;
+	} else if (mem_heap_get_size(cache->heap) + sizeof *entry + size
+		   > srv_mvcc_version_cache_size) {
+		return;
+	}
+
+	entry = static_cast<row_vers_cache_entry_t*>(
+		mem_heap_alloc(cache->heap, sizeof *entry));
+
+	entry->index_id = index->id;
+	entry->trx_id = trx_id;
+	entry->roll_ptr = roll_ptr;
+	entry->buf = NULL;
+	entry->extra_size = 0;
+	entry->size = size - key_len;
+	entry->key_len = key_len;
+	entry->key = key = static_cast<byte*>(
+		mem_heap_alloc(cache->heap, key_len));
+
+	for (ulint i = 0; i < dict_index_get_n_unique(index); i++) {
+		ulint		field_len;
+		const byte*	field;
+
+		field = rec_get_nth_field(rec, rec_offsets, i, &field_len);
+		mach_write_to_4(key, field_len);
+		key += 4;
+
+		if (field_len != UNIV_SQL_NULL) {
+			memcpy(key, field, field_len);
+			key += field_len;
+		}
+	}
+
+	if (vers != NULL) {
+		entry->extra_size = rec_offs_extra_size(offsets);
+		entry->buf = static_cast<byte*>(
+			mem_heap_dup(cache->heap, vers - entry->extra_size,
+				     entry->size));
+	}
+
+	HASH_INSERT(row_vers_cache_entry_t, hash, cache->hash,
+		    ut_fold_ull(roll_ptr), entry);
+}
+
+/*****************************************************************//**
+Frees the versions of clustered index records built for a read view,
+when the view is closed. */
+UNIV_INTERN
+void
+row_vers_cache_free(
+/*================*/
+	read_view_t*	view)	/*!< in/out: read view */
+{
+	row_vers_cache_t*	cache	= view->vers_cache;
+
+	if (cache != NULL) {
+		hash_table_free(cache->hash);
+		mem_heap_free(cache->heap);
+		ut_free(cache);
+		view->vers_cache = NULL;
+	}
+}
+
+/*****************************************************************//**
+Issues asynchronous reads of the undo log pages holding the newest undo
+log records of the records of a clustered index page that a consistent
+read view does not see. A scan calls this when it first builds an old
+version on a page, so that the undo log pages of the page are read
+together instead of one by one as the scan reaches each record. */
+UNIV_INTERN
+void
+row_vers_prefetch_undo(
+/*===================*/
+	const rec_t*		rec,	/*!< in: record on the page; the
+					caller must have a latch on the
+					page */
+	dict_index_t*		index,	/*!< in: the clustered index */
+	const read_view_t*	view)	/*!< in: the consistent read view */
+{
+	ulint		spaces[ROW_VERS_PREFETCH_MAX];
+	ulint		page_nos[ROW_VERS_PREFETCH_MAX];
+	ulint		n_pages		= 0;
+	ulint		n_reads		= 0;
+	mem_heap_t*	heap		= NULL;
+	ulint		offsets_[REC_OFFS_NORMAL_SIZE];
+	ulint*		offsets		= offsets_;
+	ulint		i;
+
+	rec_offs_init(offsets_);
+
+	ut_ad(dict_index_is_clust(index));
+
+	for (rec = page_rec_get_next_const(
+		     page_get_infimum_rec(page_align(rec)));
+	     !page_rec_is_supremum(rec) && n_pages < ROW_VERS_PREFETCH_MAX;
+	     rec = page_rec_get_next_const(rec)) {
+
+		roll_ptr_t	roll_ptr;
+		ibool		is_insert;
+		ulint		rseg_id;
+		ulint		page_no;
+		ulint		offset;
+		trx_rseg_t*	rseg;
+
+		offsets = rec_get_offsets(rec, index, offsets,
+					  ULINT_UNDEFINED, &heap);
+
+		if (read_view_sees_trx_id(
+			    view, row_get_rec_trx_id(rec, index, offsets))) {
+			continue;
+		}
+
+		roll_ptr = row_get_rec_roll_ptr(rec, index, offsets);
+		trx_undo_decode_roll_ptr(roll_ptr, &is_insert, &rseg_id,
+					 &page_no, &offset);
+
+		if (is_insert) {
+			/* The record was inserted after the view was
+			created: no undo log record needs to be read. */
+			continue;
+		}
+
+		rseg = trx_sys_get_nth_rseg(trx_sys, rseg_id);
+
+		if (rseg == NULL) {
+			continue;
+		}
+
+		for (i = 0; i < n_pages; i++) {
+			if (page_nos[i] == page_no
+			    && spaces[i] == rseg->space) {
+				break;
+			}
+		}
+
+		if (i == n_pages) {
+			spaces[n_pages] = rseg->space;
+			page_nos[n_pages++] = page_no;
+		}
+	}
+
+	if (heap != NULL) {
+		mem_heap_free(heap);
+	}
+
+	for (i = 0; i < n_pages; i++) {
+		if (!buf_page_peek(spaces[i], page_nos[i])
+		    && buf_read_page_async(spaces[i], page_nos[i])) {
+			n_reads++;
+		}
+	}
+
+	if (n_reads > 0) {
+		os_aio_simulated_wake_handler_threads();
+		srv_stats.row_recreation_undo_prefetches.add(n_reads);
+	}
+}
+
 /*****************************************************************//**
 Finds out if an active transaction has inserted or modified a secondary
 index record.
@@ -529,6 +866,11 @@ row_vers_build_for_consistent_read(
 	const rec_t*	version;
 	rec_t*		prev_version;
 	trx_id_t	trx_id;
+	trx_id_t	rec_trx_id;
+	roll_ptr_t	rec_roll_ptr;
+	const row_vers_cache_entry_t*	entry;
+	dict_table_t*	table		= index->table;
+	ulint		depth		= 0;
 	mem_heap_t*	heap		= NULL;
 	byte*		buf;
 	dberr_t		err;
@@ -542,10 +884,35 @@ row_vers_build_for_consistent_read(
 
 	ut_ad(rec_offs_validate(rec, index, *offsets));
 
-	trx_id = row_get_rec_trx_id(rec, index, *offsets);
+	rec_trx_id = trx_id = row_get_rec_trx_id(rec, index, *offsets);
 
 	ut_ad(!read_view_sees_trx_id(view, trx_id));
 
+	rec_roll_ptr = row_get_rec_roll_ptr(rec, index, *offsets);
+
+	entry = row_vers_cache_find(view, index, rec, *offsets, trx_id,
+				    rec_roll_ptr);
+
+	if (entry != NULL) {
+		/* The version was built for the view before */
+
+		table->n_vers_cache_hits++;
+		srv_stats.row_recreation_cache_hits.inc();
+
+		if (entry->buf == NULL) {
+			*old_vers = NULL;
+			return(DB_SUCCESS);
+		}
+
+		buf = static_cast<byte*>(
+			mem_heap_dup(in_heap, entry->buf, entry->size));
+
+		*old_vers = buf + entry->extra_size;
+		*offsets = rec_get_offsets(*old_vers, index, *offsets,
+					   ULINT_UNDEFINED, offset_heap);
+		return(DB_SUCCESS);
+	}
+
 	version = rec;
 
 #ifdef UNIV_DEBUG
@@ -556,6 +923,7 @@ row_vers_build_for_consistent_read(
 
 	for (;;) {
     srv_stats.row_recreation_steps.inc();
+		depth++;
 		mem_heap_t*	heap2	= heap;
 		trx_undo_rec_t* undo_rec;
 		roll_ptr_t	roll_ptr;
@@ -650,6 +1018,27 @@ row_vers_build_for_consistent_read(
 
 	mem_heap_free(heap);
 
+	/* The counters are not protected by any latch: they are
+	statistics only. */
+	table->n_vers_builds++;
+	table->n_vers_build_steps += depth;
+	if (depth > table->max_vers_build_depth) {
+		table->max_vers_build_depth = depth;
+	}
+
+	if (err == DB_SUCCESS && srv_mvcc_version_cache_size > 0) {
+		ulint	rec_offsets_[REC_OFFS_NORMAL_SIZE];
+		ulint*	rec_offsets	= rec_offsets_;
+		rec_offs_init(rec_offsets_);
+
+		rec_offsets = rec_get_offsets(rec, index, rec_offsets,
+					      dict_index_get_n_unique(index),
+					      offset_heap);
+
+		row_vers_cache_add(view, index, rec, rec_offsets, rec_trx_id,
+				   rec_roll_ptr, *old_vers, *offsets);
+	}
+
 	return(err);
 }
 
@@ -226,6 +226,9 @@ UNIV_INTERN ulint	srv_buf_pool_size	= ULINT_MAX;
 ulong	srv_buf_pool_chunk_unit = 0;
 /* force virtual page preallocation (prefault) */
 UNIV_INTERN my_bool	srv_buf_pool_populate	= FALSE;
+/* If this flag is TRUE, then the pages of a dropped or truncated
+tablespace are freed in the background instead of by the DROP. */
+UNIV_INTERN my_bool	srv_buf_lazy_drop	= FALSE;
 /* requested number of buffer pool instances */
 UNIV_INTERN ulint       srv_buf_pool_instances  = 1;
 /* number of locks to protect buf_pool->page_hash */
@@ -329,6 +332,18 @@ UNIV_INTERN ulong	srv_n_purge_threads = 1;
 /* the number of pages to purge in one batch */
 UNIV_INTERN ulong	srv_purge_batch_size = 20;
 
+/* The number of threads rolling back the recovered transactions. */
+UNIV_INTERN ulong	srv_n_rollback_threads = 1;
+
+/* The largest size of the version cache of a read view, 0 to disable. */
+UNIV_INTERN ulong	srv_mvcc_version_cache_size = 0;
+
+/* Read ahead undo log pages for consistent reads of clustered index pages. */
+UNIV_INTERN my_bool	srv_mvcc_undo_prefetch = TRUE;
+
+/* The largest size of the column stores of innodb_column_mirror_tables. */
+UNIV_INTERN ulonglong	srv_col_mirror_max_size = 1ULL << 30;
+
 /* Internal setting for "innodb_stats_method". Decides how InnoDB treats
 NULL value when collecting statistics. By default, it is set to
 SRV_STATS_NULLS_EQUAL(0), ie. all NULL value are treated equal */
@@ -1954,6 +1969,10 @@ srv_export_innodb_status(void)
 
   export_vars.innodb_row_recreations = srv_stats.row_recreations;
   export_vars.innodb_row_recreation_steps = srv_stats.row_recreation_steps;
+  export_vars.innodb_row_recreation_cache_hits =
+    srv_stats.row_recreation_cache_hits;
+  export_vars.innodb_row_recreation_undo_prefetches =
+    srv_stats.row_recreation_undo_prefetches;
 
 	export_vars.innodb_rows_read = srv_stats.n_rows_read;
 
@@ -2058,6 +2077,16 @@ srv_export_innodb_status(void)
 			(log_sys->max_modified_age_sync - lsn_gap) : 0;
 	}
 	export_vars.innodb_checkpoint_lsn = lsn_checkpoint;
+
+	export_vars.innodb_column_mirror_builds =
+		srv_stats.n_col_mirror_builds;
+	export_vars.innodb_column_mirror_bytes = innobase_col_mirror_size();
+	export_vars.innodb_column_mirror_chunks_skipped =
+		srv_stats.n_col_mirror_chunks_skipped;
+	export_vars.innodb_column_mirror_rows_read =
+		srv_stats.n_col_mirror_rows_read;
+	export_vars.innodb_column_mirror_scans =
+		srv_stats.n_col_mirror_scans;
 	export_vars.innodb_checkpoint_diff = lsn_current - lsn_checkpoint;
 	export_vars.innodb_lsn_current = lsn_current;
 	export_vars.innodb_lsn_oldest = lsn_oldest;
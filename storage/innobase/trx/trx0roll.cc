@@ -45,11 +45,23 @@ Created 3/26/1996 Heikki Tuuri
 #include "pars0pars.h"
 #include "srv0mon.h"
 #include "trx0sys.h"
+#include "ha_prototypes.h"
+
+#include <vector>
 
 /** This many pages must be undone before a truncate is tried within
 rollback */
 #define TRX_ROLL_TRUNC_THRESHOLD	1
 
+/** Recovered transactions with more undo log records than this are rolled
+back one at a time, their records split among the rollback threads; the
+others are rolled back concurrently, each by a single thread */
+#define TRX_ROLL_SPLIT_MIN_RECS		1000
+
+/** Number of undo log records handed out to the rollback threads at a
+time when the records of a transaction are split */
+#define TRX_ROLL_SPLIT_BATCH		1024
+
 /** true if trx_rollback_or_clean_all_recovered() thread is active */
 bool			trx_rollback_or_clean_is_active;
 
@@ -71,6 +83,15 @@ trx_rollback_finish(
 /*================*/
 	trx_t*		trx);	/*!< in: transaction */
 
+/*******************************************************************//**
+Undoes the records of a recovered transaction with several threads. */
+static
+void
+trx_roll_split(
+/*===========*/
+	trx_t*		trx,		/*!< in/out: transaction */
+	ulint		n_threads);	/*!< in: number of threads */
+
 /*******************************************************************//**
 Rollback a transaction used in MySQL. */
 static
@@ -121,6 +142,11 @@ trx_rollback_to_savepoint_low(
 		MONITOR_INC(MONITOR_TRX_ROLLBACK);
 		srv_n_rollback_total++;
 	} else {
+		if (trx->col_mirror_changes) {
+			innobase_col_mirror_trx_rollback(
+				trx, savept->least_undo_no);
+		}
+
 		trx->lock.que_state = TRX_QUE_RUNNING;
 		MONITOR_INC(MONITOR_TRX_ROLLBACK_SAVEPOINT);
 		srv_n_rollback_partial++;
@@ -545,7 +571,11 @@ static
 void
 trx_rollback_active(
 /*================*/
-	trx_t*	trx)	/*!< in/out: transaction */
+	trx_t*	trx,		/*!< in/out: transaction */
+	ulint	n_threads)	/*!< in: number of threads undoing the
+				records of trx, 0 if other transactions are
+				rolled back concurrently; the progress is
+				only printed if nonzero */
 {
 	mem_heap_t*	heap;
 	que_fork_t*	fork;
@@ -572,17 +602,19 @@ trx_rollback_active(
 
 	ut_a(thr == que_fork_start_command(fork));
 
-	mutex_enter(&trx_sys->mutex);
+	rows_to_undo = trx->undo_no;
 
-	trx_roll_crash_recv_trx	= trx;
+	if (n_threads > 0) {
+		mutex_enter(&trx_sys->mutex);
 
-	trx_roll_max_undo_no = trx->undo_no;
+		trx_roll_crash_recv_trx	= trx;
 
-	trx_roll_progress_printed_pct = 0;
+		trx_roll_max_undo_no = trx->undo_no;
 
-	rows_to_undo = trx_roll_max_undo_no;
+		trx_roll_progress_printed_pct = 0;
 
-	mutex_exit(&trx_sys->mutex);
+		mutex_exit(&trx_sys->mutex);
+	}
 
 	if (rows_to_undo > 1000000000) {
 		rows_to_undo = rows_to_undo / 1000000;
@@ -604,6 +636,13 @@ trx_rollback_active(
 	que_run_threads(thr);
 	ut_a(roll_node->undo_thr != NULL);
 
+	if (n_threads > 1 && !dictionary_locked
+	    && trx->undo_no > TRX_ROLL_SPLIT_MIN_RECS) {
+
+		trx_roll_split(trx, n_threads);
+	}
+
+	/* Undo what is left, and truncate the undo logs */
 	que_run_threads(roll_node->undo_thr);
 
 	trx_rollback_finish(thr_get_trx(roll_node->undo_thr));
@@ -659,7 +698,9 @@ trx_rollback_active(
 
 	mem_heap_free(heap);
 
-	trx_roll_crash_recv_trx	= NULL;
+	if (n_threads > 0) {
+		trx_roll_crash_recv_trx	= NULL;
+	}
 }
 
 /*******************************************************************//**
@@ -704,7 +745,7 @@ trx_rollback_resurrected(
 	case TRX_STATE_ACTIVE:
 		if (all || trx_get_dict_operation(trx) != TRX_DICT_OP_NONE) {
 			mutex_exit(&trx_sys->mutex);
-			trx_rollback_active(trx);
+			trx_rollback_active(trx, 1);
 			trx_free_for_background(trx);
 			return(TRUE);
 		}
@@ -719,6 +760,114 @@ trx_rollback_resurrected(
 	return(FALSE);
 }
 
+/** Recovered transactions rolled back concurrently */
+struct trx_roll_queue_t {
+	std::vector<trx_t*>	trxs;	/*!< the transactions */
+	ulint			next;	/*!< index of the next transaction
+					to roll back, incremented
+					atomically */
+	ulint			n_busy;	/*!< number of threads still running,
+					decremented atomically */
+	os_event_t		done;	/*!< set when n_busy reaches 0 */
+};
+
+/*******************************************************************//**
+Rolls back recovered transactions of a queue until it is empty.
+@return	a dummy parameter */
+extern "C" UNIV_INTERN
+os_thread_ret_t
+DECLARE_THREAD(trx_roll_queue_thread)(
+/*==================================*/
+	void*	arg)	/*!< in: trx_roll_queue_t */
+{
+	trx_roll_queue_t*	queue = static_cast<trx_roll_queue_t*>(arg);
+	ulint			i;
+
+#ifdef UNIV_PFS_THREAD
+	pfs_register_thread(trx_rollback_clean_thread_key);
+#endif /* UNIV_PFS_THREAD */
+
+	while ((i = os_atomic_increment_ulint(&queue->next, 1) - 1)
+	       < queue->trxs.size()) {
+
+		trx_t*	trx = queue->trxs[i];
+
+		trx_rollback_active(trx, 0);
+		trx_free_for_background(trx);
+	}
+
+	if (os_atomic_decrement_ulint(&queue->n_busy, 1) == 0) {
+		os_event_set(queue->done);
+	}
+
+	os_thread_exit(NULL);
+
+	OS_THREAD_DUMMY_RETURN;
+}
+
+/*******************************************************************//**
+Rolls back the recovered active transactions with srv_n_rollback_threads
+threads. The small transactions are rolled back concurrently, then the
+large ones one at a time, with their undo log records split among the
+threads. Transactions for dictionary operations are left to the caller. */
+static
+void
+trx_rollback_recovered_parallel(void)
+/*=================================*/
+{
+	trx_roll_queue_t	queue;
+	std::vector<trx_t*>	large;
+
+	mutex_enter(&trx_sys->mutex);
+
+	for (trx_t* trx = UT_LIST_GET_FIRST(trx_sys->rw_trx_list);
+	     trx != NULL;
+	     trx = UT_LIST_GET_NEXT(trx_list, trx)) {
+
+		assert_trx_in_rw_list(trx);
+
+		/* See trx_rollback_resurrected() */
+		trx_mutex_enter(trx);
+		bool	take = trx->is_recovered
+			&& trx->state == TRX_STATE_ACTIVE
+			&& trx_get_dict_operation(trx) == TRX_DICT_OP_NONE;
+		trx_mutex_exit(trx);
+
+		if (!take) {
+		} else if (trx->undo_no > TRX_ROLL_SPLIT_MIN_RECS) {
+			large.push_back(trx);
+		} else {
+			queue.trxs.push_back(trx);
+		}
+	}
+
+	mutex_exit(&trx_sys->mutex);
+
+	if (!queue.trxs.empty()) {
+		ulint	n_threads = ut_min(srv_n_rollback_threads,
+					   queue.trxs.size());
+
+		queue.next = 0;
+		queue.n_busy = n_threads;
+		queue.done = os_event_create();
+
+		for (ulint i = 0; i < n_threads; i++) {
+			os_thread_create(trx_roll_queue_thread, &queue, NULL);
+		}
+
+		os_event_wait(queue.done);
+		os_event_free(queue.done);
+	}
+
+	for (std::vector<trx_t*>::iterator it = large.begin();
+	     it != large.end();
+	     ++it) {
+
+		trx_rollback_active(*it, srv_n_rollback_threads);
+		trx_free_for_background(*it);
+	}
+}
+
 /*******************************************************************//**
 Rollback or clean up any incomplete transactions which were
 encountered in crash recovery.  If the transaction already was
@@ -751,6 +900,10 @@ trx_rollback_or_clean_recovered(
 	is shutdown and they are still lingering in trx_sys_t::trx_list
 	then the shutdown will hang. */
 
+	if (all && srv_n_rollback_threads > 1) {
+		trx_rollback_recovered_parallel();
+	}
+
 	/* Loop over the transaction list as long as there are
 	recovered transactions to clean up or recover. */
 
@@ -1269,6 +1422,280 @@ trx_roll_graph_build(
 	return(fork);
 }
 
+/** An undo log record handed out to a rollback thread */
+struct trx_roll_rec_t {
+	trx_undo_rec_t*	undo_rec;	/*!< copy of the record */
+	roll_ptr_t	roll_ptr;	/*!< roll pointer to the record */
+};
+
+struct trx_roll_split_t;
+
+/** A thread undoing a partition of the records of a transaction */
+struct trx_roll_worker_t {
+	trx_roll_split_t*		split;	/*!< the rollback */
+	que_t*				graph;	/*!< undo graph of the
+						thread */
+	std::vector<trx_roll_rec_t>	recs;	/*!< records of the current
+						batch, in undo order */
+	os_event_t			start;	/*!< set when the batch is
+						handed out */
+};
+
+/** Rollback of a transaction whose undo log records are split among
+threads. The records are popped in batches, in the usual order, and a
+record goes to the thread of its table and primary key: all the records
+of a row are undone by one thread, newest first. The records of a batch
+stay reserved in trx->undo_no_arr until they are undone, so that the undo
+logs are not truncated past them. */
+struct trx_roll_split_t {
+	trx_t*				trx;	/*!< the transaction */
+	std::vector<trx_roll_worker_t>	workers;/*!< the threads */
+	bool				exit;	/*!< true when the threads
+						should exit */
+	ulint				n_busy;	/*!< number of threads that
+						did not finish the batch,
+						decremented atomically */
+	os_event_t			done;	/*!< set when n_busy
+						reaches 0 */
+};
+
+/*******************************************************************//**
+Undoes the batches of records handed out to a thread, until told to exit.
+@return	a dummy parameter */
+extern "C" UNIV_INTERN
+os_thread_ret_t
+DECLARE_THREAD(trx_roll_split_thread)(
+/*==================================*/
+	void*	arg)	/*!< in: trx_roll_worker_t */
+{
+	trx_roll_worker_t*	worker = static_cast<trx_roll_worker_t*>(arg);
+	trx_roll_split_t*	split = worker->split;
+	que_thr_t*		thr = UT_LIST_GET_FIRST(worker->graph->thrs);
+	undo_node_t*		node = static_cast<undo_node_t*>(thr->child);
+
+#ifdef UNIV_PFS_THREAD
+	pfs_register_thread(trx_rollback_clean_thread_key);
+#endif /* UNIV_PFS_THREAD */
+
+	for (;;) {
+		os_event_wait(worker->start);
+		os_event_reset(worker->start);
+
+		if (split->exit) {
+			break;
+		}
+
+		/* Prevent DROP TABLE etc. while the batch is undone */
+		rw_lock_s_lock(&dict_operation_lock);
+
+		for (std::vector<trx_roll_rec_t>::const_iterator it
+			     = worker->recs.begin();
+		     it != worker->recs.end();
+		     ++it) {
+
+			dberr_t	err = row_undo_rec(
+				node, thr, it->undo_rec, it->roll_ptr);
+
+			if (err != DB_SUCCESS) {
+				ib_logf(IB_LOG_LEVEL_FATAL,
+					"Error (%s) in rollback.",
+					ut_strerr(err));
+			}
+		}
+
+		rw_lock_s_unlock(&dict_operation_lock);
+
+		if (os_atomic_decrement_ulint(&split->n_busy, 1) == 0) {
+			os_event_set(split->done);
+		}
+	}
+
+	if (os_atomic_decrement_ulint(&split->n_busy, 1) == 0) {
+		os_event_set(split->done);
+	}
+
+	os_thread_exit(NULL);
+
+	OS_THREAD_DUMMY_RETURN;
+}
+
+/*******************************************************************//**
+Wakes up the threads of a split rollback, and waits until they are done
+with the current batch or, if split->exit is set, until they exit. */
+static
+void
+trx_roll_split_run(
+/*===============*/
+	trx_roll_split_t*	split)	/*!< in/out: split rollback */
+{
+	split->n_busy = split->workers.size();
+	os_event_reset(split->done);
+
+	for (ulint i = 0; i < split->workers.size(); i++) {
+		os_event_set(split->workers[i].start);
+	}
+
+	os_event_wait(split->done);
+}
+
+/*******************************************************************//**
+Computes which thread of a split rollback undoes an undo log record: the
+records of a row must all go to the same thread.
+@return	fold of the table id and of the primary key of the row */
+static
+ulint
+trx_roll_split_fold(
+/*================*/
+	trx_undo_rec_t*	undo_rec,	/*!< in: undo log record */
+	dict_table_t**	table,		/*!< in/out: opened table of the
+					previous record, or NULL; replaced
+					if the record is for another table */
+	mem_heap_t*	heap)		/*!< in: memory heap */
+{
+	byte*		ptr;
+	ulint		type;
+	ulint		cmpl_info;
+	bool		updated_extern;
+	undo_no_t	undo_no;
+	table_id_t	table_id;
+	dict_index_t*	clust_index;
+	dtuple_t*	ref;
+
+	ptr = trx_undo_rec_get_pars(undo_rec, &type, &cmpl_info,
+				    &updated_extern, &undo_no, &table_id);
+
+	if (*table != NULL && (*table)->id != table_id) {
+		dict_table_close(*table, FALSE, FALSE);
+		*table = NULL;
+	}
+
+	if (*table == NULL) {
+		*table = dict_table_open_on_id(
+			table_id, FALSE, DICT_TABLE_OP_NORMAL);
+	}
+
+	/* The undo skips the records of tables that are missing; their
+	order does not matter */
+	if (*table == NULL
+	    || (*table)->ibd_file_missing
+	    || (clust_index = dict_table_get_first_index(*table)) == NULL) {
+
+		return(ut_fold_ull(table_id));
+	}
+
+	if (type != TRX_UNDO_INSERT_REC) {
+		trx_id_t	trx_id;
+		roll_ptr_t	roll_ptr;
+		ulint		info_bits;
+
+		ptr = trx_undo_update_rec_get_sys_cols(
+			ptr, &trx_id, &roll_ptr, &info_bits);
+	}
+
+	trx_undo_rec_get_row_ref(ptr, clust_index, &ref, heap);
+
+	return(dtuple_fold(ref, dtuple_get_n_fields(ref), 0, table_id));
+}
+
+/*******************************************************************//**
+Undoes the records of a recovered transaction with several threads,
+see trx_roll_split_t. Called by the rollback of the transaction after
+trx_rollback_start(). Records are undone until the undo logs are empty;
+the caller then finishes the rollback. */
+static
+void
+trx_roll_split(
+/*===========*/
+	trx_t*		trx,		/*!< in/out: transaction */
+	ulint		n_threads)	/*!< in: number of threads */
+{
+	trx_roll_split_t	split;
+	mem_heap_t*		heap;
+	ulint			n_recs;
+
+	ut_ad(trx->dict_operation_lock_mode == 0);
+
+	ib_logf(IB_LOG_LEVEL_INFO,
+		"Undoing the records of trx with id " TRX_ID_FMT
+		" with %lu threads", trx->id, (ulong) n_threads);
+
+	/* A whole batch of records is reserved at a time */
+	mutex_enter(&trx->undo_mutex);
+	ut_a(trx->undo_no_arr->n_used == 0);
+	trx_undo_arr_free(trx->undo_no_arr);
+	trx->undo_no_arr = trx_undo_arr_create(TRX_ROLL_SPLIT_BATCH);
+	mutex_exit(&trx->undo_mutex);
+
+	split.trx = trx;
+	split.exit = false;
+	split.done = os_event_create();
+	split.workers.resize(n_threads);
+
+	for (ulint i = 0; i < n_threads; i++) {
+		trx_roll_worker_t*	worker = &split.workers[i];
+
+		worker->split = &split;
+		worker->start = os_event_create();
+
+		trx_mutex_enter(trx);
+		worker->graph = trx_roll_graph_build(trx);
+		trx_mutex_exit(trx);
+
+		os_thread_create(trx_roll_split_thread, worker, NULL);
+	}
+
+	heap = mem_heap_create(UNIV_PAGE_SIZE);
+
+	/* The threads s-latch dict_operation_lock themselves, for each
+	batch; this tells row_undo() not to do it for each record */
+	trx->dict_operation_lock_mode = RW_S_LATCH;
+
+	do {
+		dict_table_t*	table = NULL;
+
+		for (n_recs = 0; n_recs < TRX_ROLL_SPLIT_BATCH; n_recs++) {
+			trx_roll_rec_t	rec;
+			ulint		fold;
+
+			rec.undo_rec = trx_roll_pop_top_rec_of_trx(
+				trx, trx->roll_limit, &rec.roll_ptr, heap);
+
+			if (rec.undo_rec == NULL) {
+				break;
+			}
+
+			fold = trx_roll_split_fold(rec.undo_rec, &table, heap);
+
+			split.workers[fold % n_threads].recs.push_back(rec);
+		}
+
+		if (table != NULL) {
+			dict_table_close(table, FALSE, FALSE);
+		}
+
+		trx_roll_split_run(&split);
+
+		for (ulint i = 0; i < n_threads; i++) {
+			split.workers[i].recs.clear();
+		}
+
+		mem_heap_empty(heap);
+	} while (n_recs == TRX_ROLL_SPLIT_BATCH);
+
+	trx->dict_operation_lock_mode = 0;
+
+	split.exit = true;
+	trx_roll_split_run(&split);
+
+	for (ulint i = 0; i < n_threads; i++) {
+		que_graph_free(split.workers[i].graph);
+		os_event_free(split.workers[i].start);
+	}
+
+	os_event_free(split.done);
+	mem_heap_free(heap);
+}
+
 /*********************************************************************//**
 Starts a rollback operation, creates the UNDO graph that will do the
 actual undo operation.
@@ -37,6 +37,7 @@ Created 3/26/1996 Heikki Tuuri
 #include "trx0roll.h"
 #include "usr0sess.h"
 #include "read0read.h"
+#include "row0vers.h"
 #include "srv0srv.h"
 #include "srv0start.h"
 #include "btr0sea.h"
@@ -517,6 +518,14 @@ trx_free(
 
 	ut_a(UT_LIST_GET_LEN(trx->lock.trx_locks) == 0);
 
+	if (trx->col_mirror_changes) {
+		innobase_col_mirror_trx_free(trx);
+	}
+
+	if (trx->global_read_view != NULL) {
+		row_vers_cache_free(trx->global_read_view);
+	}
+
 	if (trx->global_read_view_heap) {
 		mem_heap_free(trx->global_read_view_heap);
 	}
@@ -1567,6 +1576,8 @@ trx_commit_in_memory(
 
 	if (trx->global_read_view != NULL) {
 
+		row_vers_cache_free(trx->global_read_view);
+
 		mem_heap_empty(trx->global_read_view_heap);
 
 		trx->global_read_view = NULL;
@@ -1735,6 +1746,12 @@ trx_commit_low(
 		lsn = 0;
 	}
 
+	/* Apply the changes to the column stores while the transaction
+	is still active for the read views created in the meantime. */
+	if (trx->col_mirror_changes) {
+		innobase_col_mirror_trx_end(trx, for_commit);
+	}
+
 	trx_commit_in_memory(trx, lsn, for_commit);
 }
 
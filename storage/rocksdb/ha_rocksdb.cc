@@ -79,6 +79,7 @@
 #include "./rdb_datadic.h"
 #include "./rdb_i_s.h"
 #include "./rdb_index_merge.h"
+#include "./rdb_memcached.h"
 #include "./rdb_mutex_wrapper.h"
 #include "./rdb_psi.h"
 #include "./rdb_threads.h"
@@ -196,13 +197,14 @@ std::unordered_map<ulonglong, std::weak_ptr<Rdb_explicit_snapshot>>
 /**
   Updates row counters based on the table type and operation type.
 */
-void ha_rocksdb::update_row_stats(const operation_type &type) {
+void ha_rocksdb::update_row_stats(const operation_type &type,
+                                  const ulonglong count) {
   DBUG_ASSERT(type < ROWS_MAX);
   // Find if we are modifying system databases.
   if (table->s && m_tbl_def->m_is_mysql_system_table) {
-    global_stats.system_rows[type].inc();
+    global_stats.system_rows[type].add(count);
   } else {
-    global_stats.rows[type].inc();
+    global_stats.rows[type].add(count);
   }
 }
 
@@ -3945,18 +3947,24 @@ static std::string rdb_xid_to_string(const XID &src) {
   transactions.
 */
 static bool rocksdb_flush_wal(handlerton *const hton MY_ATTRIBUTE((__unused__)),
-                              ulonglong target_lsn MY_ATTRIBUTE((__unused__))) {
+                              ulonglong target_lsn MY_ATTRIBUTE((__unused__)),
+                              bool *const durable) {
   DBUG_ASSERT(rdb != nullptr);
 
   rocksdb::Status s;
+  bool sync = false;
   /*
     target_lsn is set to 0 when MySQL wants to sync the wal files
   */
   if ((target_lsn == 0 && !rocksdb_db_options->allow_mmap_writes) ||
       rocksdb_flush_log_at_trx_commit != FLUSH_LOG_NEVER) {
     rocksdb_wal_group_syncs++;
-    s = rdb->FlushWAL(target_lsn == 0 ||
-                      rocksdb_flush_log_at_trx_commit == FLUSH_LOG_SYNC);
+    sync = target_lsn == 0 ||
+           rocksdb_flush_log_at_trx_commit == FLUSH_LOG_SYNC;
+    s = rdb->FlushWAL(sync);
+  }
+  if (!sync && durable != nullptr) {
+    *durable = false;
   }
 
   if (!s.ok()) {
@@ -9365,17 +9373,68 @@ int ha_rocksdb::write_row(uchar *const buf) {
   DBUG_RETURN(rv);
 }
 
-// Increment the number of rows in the table by one.
+/**
+  Write the rows of a multi-row INSERT
+
+  The rows go to the write batch of the transaction one by one as in
+  write_row(); the unique check decision, the row counters and the table
+  statistics are handled once for the whole batch.
+
+  @param[in]  rows       rows to write, in table->record[0] format
+  @param[in]  n_rows     number of rows
+  @param[out] n_written  number of rows written before an error
+  @return
+    HA_EXIT_SUCCESS  OK
+    other            HA_ERR error code of the row at rows[*n_written]
+*/
+int ha_rocksdb::write_rows(uchar **const rows, const uint n_rows,
+                           uint *const n_written) {
+  DBUG_ENTER_FUNC();
+
+  DBUG_ASSERT(rows != nullptr);
+  DBUG_ASSERT(n_written != nullptr);
+  DBUG_ASSERT(m_lock_rows == RDB_LOCK_WRITE);
+  DBUG_ASSERT(table->next_number_field == nullptr);
+
+  const bool skip_unique = skip_unique_check();
+  int rv = HA_EXIT_SUCCESS;
+  uint i;
+
+  for (i = 0; i < n_rows; i++) {
+    if (rows[i] != table->record[0]) {
+      memcpy(table->record[0], rows[i], table->s->reclength);
+    }
+    ha_statistic_increment(&SSV::ha_write_count);
+    m_dup_pk_found = false;
+
+    rv = update_write_row(nullptr, table->record[0], skip_unique);
+    if (rv != HA_EXIT_SUCCESS) {
+      break;
+    }
+  }
+
+  *n_written = i;
+  if (i > 0) {
+    stats.rows_inserted += i;
+    inc_table_n_rows(i);
+    update_table_stats_if_needed(i);
+    update_row_stats(ROWS_INSERTED, i);
+  }
+
+  DBUG_RETURN(rv);
+}
+
+// Increment the number of rows in the table by count.
 // This operation is not protected by ddl manager lock.
 // The number is estimated.
-void ha_rocksdb::inc_table_n_rows() {
+void ha_rocksdb::inc_table_n_rows(const uint64 count) {
   if (!rocksdb_table_stats_use_table_scan) {
     return;
   }
 
   uint64 n_rows = m_tbl_def->m_tbl_stats.m_stat_n_rows;
-  if (n_rows < std::numeric_limits<ulonglong>::max()) {
-    m_tbl_def->m_tbl_stats.m_stat_n_rows = n_rows + 1;
+  if (n_rows <= std::numeric_limits<ulonglong>::max() - count) {
+    m_tbl_def->m_tbl_stats.m_stat_n_rows = n_rows + count;
   }
 }
 
@@ -10947,7 +11006,7 @@ int ha_rocksdb::update_row(const uchar *const old_data, uchar *const new_data) {
   DBUG_RETURN(rv);
 }
 
-void ha_rocksdb::update_table_stats_if_needed() {
+void ha_rocksdb::update_table_stats_if_needed(const uint64 count) {
   DBUG_ENTER_FUNC();
 
   if (!rocksdb_table_stats_use_table_scan) {
@@ -10961,7 +11020,8 @@ void ha_rocksdb::update_table_stats_if_needed() {
     before the transaction performing the update commits. Hence the
     cardinality scan might miss the keys for these pending transactions.
   */
-  uint64 counter = m_tbl_def->m_tbl_stats.m_stat_modified_counter++;
+  uint64 counter = m_tbl_def->m_tbl_stats.m_stat_modified_counter;
+  m_tbl_def->m_tbl_stats.m_stat_modified_counter = counter + count;
   uint64 n_rows = m_tbl_def->m_tbl_stats.m_stat_n_rows;
 
   if (counter > std::max(rocksdb_table_stats_recalc_threshold_count,
@@ -15108,4 +15168,5 @@ mysql_declare_plugin(rocksdb_se){
     myrocks::rdb_i_s_global_info, myrocks::rdb_i_s_ddl,
     myrocks::rdb_i_s_sst_props, myrocks::rdb_i_s_index_file_map,
     myrocks::rdb_i_s_lock_info, myrocks::rdb_i_s_trx_info,
-    myrocks::rdb_i_s_deadlock_info mysql_declare_plugin_end;
+    myrocks::rdb_i_s_deadlock_info, myrocks::rdb_memcached_plugin
+    mysql_declare_plugin_end;
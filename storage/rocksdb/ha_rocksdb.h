@@ -361,7 +361,7 @@ class ha_rocksdb : public my_core::handler {
   bool has_hidden_pk(const TABLE *const table) const
       MY_ATTRIBUTE((__nonnull__, __warn_unused_result__));
 
-  void update_row_stats(const operation_type &type);
+  void update_row_stats(const operation_type &type, const ulonglong count = 1);
 
   void set_last_rowkey(const uchar *const old_data);
 
@@ -618,11 +618,14 @@ class ha_rocksdb : public my_core::handler {
 
   int write_row(uchar *const buf) override
       MY_ATTRIBUTE((__warn_unused_result__));
+  int write_rows(uchar **const rows, const uint n_rows,
+                 uint *const n_written) override
+      MY_ATTRIBUTE((__warn_unused_result__));
   int update_row(const uchar *const old_data, uchar *const new_data) override
       MY_ATTRIBUTE((__warn_unused_result__));
   int delete_row(const uchar *const buf) override
       MY_ATTRIBUTE((__warn_unused_result__));
-  void update_table_stats_if_needed();
+  void update_table_stats_if_needed(const uint64 count = 1);
   rocksdb::Status delete_or_singledelete(uint index, Rdb_transaction *const tx,
                                          rocksdb::ColumnFamilyHandle *const cf,
                                          const rocksdb::Slice &key)
@@ -828,7 +831,7 @@ class ha_rocksdb : public my_core::handler {
   int finalize_bulk_load(bool print_client_error = true)
       MY_ATTRIBUTE((__warn_unused_result__));
 
-  void inc_table_n_rows();
+  void inc_table_n_rows(const uint64 count = 1);
   void dec_table_n_rows();
 
   bool should_skip_invalidated_record(const int rc);
@@ -126,6 +126,11 @@ const char *const INDEX_STATS_THREAD_NAME = "myrocks-is";
 */
 const char *const MANUAL_COMPACTION_THREAD_NAME = "myrocks-mc";
 
+/*
+  Name for the memcached frontend network threads.
+*/
+const char *const MEMCACHED_THREAD_NAME = "myrocks-memc";
+
 /*
   Separator between partition name and the qualifier. Sample usage:
 
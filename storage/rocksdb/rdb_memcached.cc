@@ -0,0 +1,1164 @@
+/*
+   Copyright (c) 2020, Facebook, Inc.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
+
+#define MYSQL_SERVER 1
+
+/* This C++ file's header */
+#include "./rdb_memcached.h"
+
+/* C++ standard header files */
+#include <algorithm>
+#include <atomic>
+#include <string>
+#include <vector>
+
+/* C standard header files */
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+/* MySQL header files */
+#include <mysql/plugin.h>
+#include "../../sql/key.h"
+#include "../../sql/sql_base.h"
+#include "../../sql/sql_class.h"
+#include "../../sql/sql_parse.h"
+#include "../../sql/transaction.h"
+
+/* MyRocks header files */
+#include "./ha_rocksdb.h"
+#include "./ha_rocksdb_proto.h"
+#include "./rdb_converter.h"
+#include "./rdb_psi.h"
+
+namespace myrocks {
+
+/* Limits of the memcached protocol */
+static const size_t MEMCACHED_MAX_KEY_LENGTH = 250;
+static const size_t MEMCACHED_MAX_LINE_LENGTH = 2048;
+static const size_t MEMCACHED_MAX_VALUE_LENGTH = 1024 * 1024;
+
+/* Stop reading from a connection while this much output is pending */
+static const size_t MEMCACHED_MAX_PENDING_OUTPUT = 4 * 1024 * 1024;
+
+static const int MEMCACHED_MAX_EVENTS = 256;
+static const size_t MEMCACHED_READ_SIZE = 16 * 1024;
+
+/* Milliseconds between checks for shutdown */
+static const int MEMCACHED_POLL_TIMEOUT_MS = 100;
+
+static uint rocksdb_memcached_port = 0;
+static char *rocksdb_memcached_bind_address = nullptr;
+static uint rocksdb_memcached_threads = 4;
+static char *rocksdb_memcached_mappings = nullptr;
+static my_bool rocksdb_memcached_enable_set = FALSE;
+
+static std::vector<Rdb_memcached_mapping> rdb_memcached_mappings;
+static std::vector<std::unique_ptr<Rdb_memcached_thread>> rdb_memcached_threads;
+static int rdb_memcached_listen_fd = -1;
+
+/* Counters reported by the stats command */
+static std::atomic<ulonglong> rdb_memcached_curr_connections(0);
+static std::atomic<ulonglong> rdb_memcached_total_connections(0);
+static std::atomic<ulonglong> rdb_memcached_cmd_get(0);
+static std::atomic<ulonglong> rdb_memcached_get_hits(0);
+static std::atomic<ulonglong> rdb_memcached_get_misses(0);
+static std::atomic<ulonglong> rdb_memcached_cmd_set(0);
+
+static MYSQL_SYSVAR_UINT(port, rocksdb_memcached_port,
+                         PLUGIN_VAR_RQCMDARG | PLUGIN_VAR_READONLY,
+                         "TCP port of the memcached frontend for MyRocks "
+                         "tables, 0 disables it",
+                         nullptr, nullptr, 0, 0, 65535, 0);
+
+static MYSQL_SYSVAR_STR(bind_address, rocksdb_memcached_bind_address,
+                        PLUGIN_VAR_RQCMDARG | PLUGIN_VAR_READONLY,
+                        "IPv4 address the memcached frontend listens on. The "
+                        "frontend does not authenticate clients",
+                        nullptr, nullptr, "127.0.0.1");
+
+static MYSQL_SYSVAR_UINT(threads, rocksdb_memcached_threads,
+                         PLUGIN_VAR_RQCMDARG | PLUGIN_VAR_READONLY,
+                         "Number of network threads of the memcached frontend",
+                         nullptr, nullptr, 4, 1, 256, 0);
+
+static MYSQL_SYSVAR_STR(mappings, rocksdb_memcached_mappings,
+                        PLUGIN_VAR_RQCMDARG | PLUGIN_VAR_READONLY,
+                        "Tables served by the memcached frontend, a ';' "
+                        "separated list of "
+                        "name=db.table:key_column:value_column[,value_column]",
+                        nullptr, nullptr, "");
+
+static MYSQL_SYSVAR_BOOL(enable_set, rocksdb_memcached_enable_set,
+                         PLUGIN_VAR_RQCMDARG,
+                         "Allow set commands on the memcached frontend",
+                         nullptr, nullptr, FALSE);
+
+static struct st_mysql_sys_var *rdb_memcached_system_variables[] = {
+    MYSQL_SYSVAR(port),     MYSQL_SYSVAR(bind_address),
+    MYSQL_SYSVAR(threads),  MYSQL_SYSVAR(mappings),
+    MYSQL_SYSVAR(enable_set), nullptr};
+
+/*
+  Parse rocksdb_memcached_mappings.
+
+  @return true on a syntax error, which is reported to the error log
+*/
+static bool rdb_memcached_parse_mappings(
+    const char *str, std::vector<Rdb_memcached_mapping> *mappings) {
+  const std::string config = str ? str : "";
+  size_t pos = 0;
+
+  while (pos < config.size()) {
+    size_t end = config.find(';', pos);
+    if (end == std::string::npos) {
+      end = config.size();
+    }
+    const std::string entry = config.substr(pos, end - pos);
+    pos = end + 1;
+
+    if (entry.empty()) {
+      continue;
+    }
+
+    Rdb_memcached_mapping mapping;
+    const size_t eq = entry.find('=');
+    const size_t dot = entry.find('.', eq + 1);
+    const size_t colon1 = entry.find(':', dot + 1);
+    const size_t colon2 = entry.find(':', colon1 + 1);
+    if (eq == std::string::npos || eq == 0 || dot == std::string::npos ||
+        colon1 == std::string::npos || colon2 == std::string::npos) {
+      // NO_LINT_DEBUG
+      sql_print_error("RocksDB: Invalid rocksdb_memcached_mappings entry '%s'",
+                      entry.c_str());
+      return true;
+    }
+
+    mapping.name = entry.substr(0, eq);
+    mapping.db = entry.substr(eq + 1, dot - eq - 1);
+    mapping.table = entry.substr(dot + 1, colon1 - dot - 1);
+    mapping.key_column = entry.substr(colon1 + 1, colon2 - colon1 - 1);
+
+    size_t col = colon2 + 1;
+    while (col <= entry.size()) {
+      size_t comma = entry.find(',', col);
+      if (comma == std::string::npos) {
+        comma = entry.size();
+      }
+      mapping.value_columns.push_back(entry.substr(col, comma - col));
+      col = comma + 1;
+    }
+
+    bool empty = mapping.db.empty() || mapping.table.empty() ||
+                 mapping.key_column.empty();
+    for (const auto &column : mapping.value_columns) {
+      empty = empty || column.empty();
+    }
+    if (empty) {
+      // NO_LINT_DEBUG
+      sql_print_error("RocksDB: Invalid rocksdb_memcached_mappings entry '%s'",
+                      entry.c_str());
+      return true;
+    }
+
+    mappings->push_back(mapping);
+  }
+
+  return false;
+}
+
+static Field *rdb_memcached_find_field(TABLE *table, const std::string &name) {
+  for (Field **field = table->field; *field; field++) {
+    if (!my_strcasecmp(system_charset_info, (*field)->field_name,
+                       name.c_str())) {
+      return *field;
+    }
+  }
+  return nullptr;
+}
+
+/*
+  Store a memcached value in the value columns of record[0].
+
+  @return true if a part of the value does not fit its column
+*/
+static bool rdb_memcached_store_value(const std::vector<Field *> &fields,
+                                      const std::string &data) {
+  size_t pos = 0;
+  for (size_t i = 0; i < fields.size(); i++) {
+    Field *const field = fields[i];
+
+    if (pos > data.size()) {
+      // Fewer parts than value columns
+      if (field->real_maybe_null()) {
+        field->set_null();
+      } else {
+        field->reset();
+      }
+      continue;
+    }
+
+    size_t end = data.size();
+    if (i + 1 < fields.size()) {
+      end = std::min(data.find('|', pos), data.size());
+    }
+
+    field->set_notnull();
+    if (field->store(data.data() + pos, end - pos, field->charset())) {
+      return true;
+    }
+    pos = end + 1;
+  }
+  return false;
+}
+
+bool Rdb_memcached_thread::is_killed() {
+  RDB_MUTEX_LOCK_CHECK(m_signal_mutex);
+  const bool killed = m_killed != THD::NOT_KILLED;
+  RDB_MUTEX_UNLOCK_CHECK(m_signal_mutex);
+  return killed;
+}
+
+void Rdb_memcached_thread::run() {
+  THD *const thd = new THD;
+  thd->thread_stack = reinterpret_cast<char *>(&thd);
+  thd->store_globals();
+  thd->security_ctx->skip_grants();
+  // Sets are logged in row format like the changes of any other statement
+  thd->binlog_setup_trx_data();
+  m_thd = thd;
+
+  m_tables.resize(rdb_memcached_mappings.size());
+
+  m_epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+  if (m_epoll_fd < 0) {
+    // NO_LINT_DEBUG
+    sql_print_error("RocksDB: memcached epoll_create1 failed (errno=%d)",
+                    errno);
+  } else {
+    struct epoll_event event;
+    event.events = EPOLLIN;
+#ifdef EPOLLEXCLUSIVE
+    // Wake up one of the threads for a new connection
+    event.events |= EPOLLEXCLUSIVE;
+#endif
+    event.data.fd = m_listen_fd;
+    if (epoll_ctl(m_epoll_fd, EPOLL_CTL_ADD, m_listen_fd, &event)) {
+      // NO_LINT_DEBUG
+      sql_print_error("RocksDB: memcached epoll_ctl failed (errno=%d)", errno);
+      close(m_epoll_fd);
+      m_epoll_fd = -1;
+    }
+  }
+
+  struct epoll_event events[MEMCACHED_MAX_EVENTS];
+  std::vector<Rdb_memcached_conn *> ready;
+  std::vector<std::vector<Rdb_memcached_cmd>> batch;
+
+  while (m_epoll_fd >= 0 && !is_killed()) {
+    const int n = epoll_wait(m_epoll_fd, events, MEMCACHED_MAX_EVENTS,
+                             m_resumed.empty() ? MEMCACHED_POLL_TIMEOUT_MS : 0);
+    if (n < 0 && errno != EINTR) {
+      // NO_LINT_DEBUG
+      sql_print_error("RocksDB: memcached epoll_wait failed (errno=%d)", errno);
+      break;
+    }
+
+    ready.clear();
+    for (const int fd : m_resumed) {
+      const auto it = m_conns.find(fd);
+      if (it != m_conns.end()) {
+        ready.push_back(it->second.get());
+      }
+    }
+    m_resumed.clear();
+
+    for (int i = 0; i < n; i++) {
+      if (events[i].data.fd == m_listen_fd) {
+        accept_connections();
+        continue;
+      }
+
+      const auto it = m_conns.find(events[i].data.fd);
+      if (it == m_conns.end()) {
+        continue;
+      }
+      Rdb_memcached_conn *const conn = it->second.get();
+
+      if (events[i].events & EPOLLOUT) {
+        write_connection(conn);
+      }
+      if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) {
+        read_connection(conn);
+      }
+      ready.push_back(conn);
+    }
+
+    // A resumed connection may have had an event as well
+    std::sort(ready.begin(), ready.end());
+    ready.erase(std::unique(ready.begin(), ready.end()), ready.end());
+
+    // Parse what was received and run the commands of all connections
+    batch.clear();
+    for (const auto conn : ready) {
+      if (conn->out.size() - conn->out_pos < MEMCACHED_MAX_PENDING_OUTPUT) {
+        batch.emplace_back();
+        parse_commands(conn, &batch.back());
+      }
+    }
+    execute(&batch);
+
+    for (const auto conn : ready) {
+      write_connection(conn);
+      if (conn->closing && conn->out_pos == conn->out.size()) {
+        close_connection(conn);
+      }
+    }
+  }
+
+  while (!m_conns.empty()) {
+    close_connection(m_conns.begin()->second.get());
+  }
+  if (m_epoll_fd >= 0) {
+    close(m_epoll_fd);
+  }
+
+  // Stay until shutdown after an error, signal() needs the mutex
+  RDB_MUTEX_LOCK_CHECK(m_signal_mutex);
+  while (m_killed == THD::NOT_KILLED) {
+    mysql_cond_wait(&m_signal_cond, &m_signal_mutex);
+  }
+  RDB_MUTEX_UNLOCK_CHECK(m_signal_mutex);
+
+  m_tables.clear();
+  m_thd = nullptr;
+  thd->restore_globals();
+  delete thd;
+}
+
+void Rdb_memcached_thread::accept_connections() {
+  for (;;) {
+    const int fd = accept4(m_listen_fd, nullptr, nullptr,
+                           SOCK_NONBLOCK | SOCK_CLOEXEC);
+    if (fd < 0) {
+      // EAGAIN once another thread took the connection
+      return;
+    }
+
+    const int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+    struct epoll_event event;
+    event.events = EPOLLIN;
+    event.data.fd = fd;
+    if (epoll_ctl(m_epoll_fd, EPOLL_CTL_ADD, fd, &event)) {
+      close(fd);
+      continue;
+    }
+
+    std::unique_ptr<Rdb_memcached_conn> conn(new Rdb_memcached_conn);
+    conn->fd = fd;
+    m_conns[fd] = std::move(conn);
+    rdb_memcached_curr_connections++;
+    rdb_memcached_total_connections++;
+  }
+}
+
+void Rdb_memcached_thread::read_connection(Rdb_memcached_conn *conn) {
+  char buf[MEMCACHED_READ_SIZE];
+
+  if (!conn->want_read) {
+    // EPOLLHUP or EPOLLERR while reading is stopped, the next write fails
+    return;
+  }
+
+  for (;;) {
+    const ssize_t len = read(conn->fd, buf, sizeof(buf));
+    if (len > 0) {
+      conn->in.append(buf, len);
+      continue;
+    }
+    if (len < 0 && errno == EINTR) {
+      continue;
+    }
+    if (len == 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) {
+      // Closed by the client, nothing more will be sent back
+      conn->closing = true;
+      conn->out.clear();
+      conn->out_pos = 0;
+    }
+    return;
+  }
+}
+
+void Rdb_memcached_thread::write_connection(Rdb_memcached_conn *conn) {
+  while (conn->out_pos < conn->out.size()) {
+    const ssize_t len = write(conn->fd, conn->out.data() + conn->out_pos,
+                              conn->out.size() - conn->out_pos);
+    if (len > 0) {
+      conn->out_pos += len;
+      continue;
+    }
+    if (len < 0 && errno == EINTR) {
+      continue;
+    }
+    if (len < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+      break;
+    }
+    conn->closing = true;
+    conn->out.clear();
+    conn->out_pos = 0;
+    return;
+  }
+
+  if (conn->out_pos == conn->out.size()) {
+    conn->out.clear();
+    conn->out_pos = 0;
+  }
+
+  update_events(conn);
+}
+
+/*
+  Register the events the connection waits for: EPOLLOUT while output is
+  pending, EPOLLIN unless MEMCACHED_MAX_PENDING_OUTPUT is pending, so that
+  a client which does not read its responses is not buffered without
+  limit. Once reading is resumed, the commands received before are parsed
+  in the next loop iteration.
+*/
+void Rdb_memcached_thread::update_events(Rdb_memcached_conn *conn) {
+  const size_t pending = conn->out.size() - conn->out_pos;
+  const bool want_write = pending > 0;
+  const bool want_read = pending < MEMCACHED_MAX_PENDING_OUTPUT;
+
+  if (want_write == conn->want_write && want_read == conn->want_read) {
+    return;
+  }
+
+  struct epoll_event event;
+  event.events = (want_read ? EPOLLIN : 0) | (want_write ? EPOLLOUT : 0);
+  event.data.fd = conn->fd;
+  epoll_ctl(m_epoll_fd, EPOLL_CTL_MOD, conn->fd, &event);
+
+  if (want_read && !conn->want_read && !conn->in.empty()) {
+    m_resumed.push_back(conn->fd);
+  }
+  conn->want_write = want_write;
+  conn->want_read = want_read;
+}
+
+void Rdb_memcached_thread::close_connection(Rdb_memcached_conn *conn) {
+  const int fd = conn->fd;
+  epoll_ctl(m_epoll_fd, EPOLL_CTL_DEL, fd, nullptr);
+  close(fd);
+  m_conns.erase(fd);
+  rdb_memcached_curr_connections--;
+}
+
+/*
+  Parse the complete commands received on a connection. Commands that do
+  not read or write a table are answered right away in cmd.reply.
+*/
+void Rdb_memcached_thread::parse_commands(
+    Rdb_memcached_conn *conn, std::vector<Rdb_memcached_cmd> *cmds) {
+  std::string &in = conn->in;
+  size_t pos = 0;
+
+  while (!conn->closing) {
+    const size_t eol = in.find('\n', pos);
+    if (eol == std::string::npos) {
+      if (in.size() - pos > MEMCACHED_MAX_LINE_LENGTH) {
+        conn->out.append("CLIENT_ERROR line too long\r\n");
+        conn->closing = true;
+      }
+      break;
+    }
+
+    size_t line_end = eol;
+    if (line_end > pos && in[line_end - 1] == '\r') {
+      line_end--;
+    }
+
+    std::vector<std::string> tokens;
+    size_t token = pos;
+    while (token < line_end) {
+      size_t space = in.find(' ', token);
+      if (space == std::string::npos || space > line_end) {
+        space = line_end;
+      }
+      if (space > token) {
+        tokens.push_back(in.substr(token, space - token));
+      }
+      token = space + 1;
+    }
+
+    Rdb_memcached_cmd cmd;
+    cmd.type = Rdb_memcached_cmd::REPLY;
+    cmd.conn = conn;
+    size_t next = eol + 1;
+
+    const std::string name = tokens.empty() ? "" : tokens[0];
+    if ((name == "get" || name == "gets") && tokens.size() > 1) {
+      cmd.type = Rdb_memcached_cmd::GET;
+      cmd.keys.assign(tokens.begin() + 1, tokens.end());
+      for (const auto &key : cmd.keys) {
+        if (key.size() > MEMCACHED_MAX_KEY_LENGTH) {
+          cmd.type = Rdb_memcached_cmd::REPLY;
+          cmd.reply = "CLIENT_ERROR bad command line format\r\n";
+        }
+      }
+    } else if (name == "set" && (tokens.size() == 5 || tokens.size() == 6)) {
+      // set <key> <flags> <exptime> <bytes> [noreply]
+      char *end;
+      const ulonglong bytes = strtoull(tokens[4].c_str(), &end, 10);
+      if (*end || tokens[1].size() > MEMCACHED_MAX_KEY_LENGTH ||
+          (tokens.size() == 6 && tokens[5] != "noreply")) {
+        cmd.reply = "CLIENT_ERROR bad command line format\r\n";
+      } else if (bytes > MEMCACHED_MAX_VALUE_LENGTH) {
+        conn->out.append("SERVER_ERROR object too large for cache\r\n");
+        conn->closing = true;
+        break;
+      } else if (in.size() < next + bytes + 2) {
+        // Wait for the rest of the data block
+        break;
+      } else if (in.compare(next + bytes, 2, "\r\n") != 0) {
+        conn->out.append("CLIENT_ERROR bad data chunk\r\n");
+        conn->closing = true;
+        break;
+      } else {
+        cmd.type = Rdb_memcached_cmd::SET;
+        cmd.keys.push_back(tokens[1]);
+        cmd.data = in.substr(next, bytes);
+        cmd.noreply = tokens.size() == 6;
+        next += bytes + 2;
+      }
+    } else if (name == "version" && tokens.size() == 1) {
+      cmd.reply = std::string("VERSION ") + server_version + "\r\n";
+    } else if (name == "stats" && tokens.size() == 1) {
+      append_stats(&cmd.reply);
+    } else if (name == "quit" && tokens.size() == 1) {
+      conn->closing = true;
+      pos = next;
+      break;
+    } else {
+      cmd.reply = "ERROR\r\n";
+    }
+
+    cmds->push_back(std::move(cmd));
+    pos = next;
+  }
+
+  in.erase(0, pos);
+}
+
+void Rdb_memcached_thread::append_stats(std::string *out) const {
+  const std::pair<const char *, ulonglong> stats[] = {
+      {"curr_connections", rdb_memcached_curr_connections.load()},
+      {"total_connections", rdb_memcached_total_connections.load()},
+      {"cmd_get", rdb_memcached_cmd_get.load()},
+      {"get_hits", rdb_memcached_get_hits.load()},
+      {"get_misses", rdb_memcached_get_misses.load()},
+      {"cmd_set", rdb_memcached_cmd_set.load()},
+  };
+
+  for (const auto &stat : stats) {
+    out->append("STAT ").append(stat.first).append(" ");
+    out->append(std::to_string(stat.second)).append("\r\n");
+  }
+  out->append("END\r\n");
+}
+
+/*
+  Run the commands parsed in one iteration of the network loop, the
+  commands of each connection in order.
+
+  The gets that precede the first set of their connection run in one
+  transaction and share its snapshot. The commands after a set run one
+  by one so that they see its change.
+*/
+void Rdb_memcached_thread::execute(
+    std::vector<std::vector<Rdb_memcached_cmd>> *batch) {
+  std::vector<uint> mappings;
+  std::vector<size_t> first_set(batch->size());
+
+  const auto add_mappings = [&](const Rdb_memcached_cmd &cmd) {
+    uint mapping;
+    const char *name;
+    size_t length;
+    for (const auto &key : cmd.keys) {
+      if (resolve_key(key, &mapping, &name, &length) &&
+          std::find(mappings.begin(), mappings.end(), mapping) ==
+              mappings.end()) {
+        mappings.push_back(mapping);
+      }
+    }
+  };
+
+  for (size_t i = 0; i < batch->size(); i++) {
+    auto &cmds = (*batch)[i];
+    size_t j = 0;
+    for (; j < cmds.size() && cmds[j].type != Rdb_memcached_cmd::SET; j++) {
+      if (cmds[j].type == Rdb_memcached_cmd::GET) {
+        add_mappings(cmds[j]);
+      }
+    }
+    first_set[i] = j;
+  }
+
+  if (!mappings.empty()) {
+    begin_reads(mappings);
+  }
+  for (size_t i = 0; i < batch->size(); i++) {
+    auto &cmds = (*batch)[i];
+    for (size_t j = 0; j < first_set[i]; j++) {
+      if (cmds[j].type == Rdb_memcached_cmd::GET) {
+        execute_get(cmds[j]);
+      } else {
+        cmds[j].conn->out.append(cmds[j].reply);
+      }
+    }
+  }
+  if (!mappings.empty()) {
+    end_reads();
+  }
+
+  for (size_t i = 0; i < batch->size(); i++) {
+    auto &cmds = (*batch)[i];
+    for (size_t j = first_set[i]; j < cmds.size(); j++) {
+      if (cmds[j].type == Rdb_memcached_cmd::SET) {
+        execute_set(cmds[j]);
+      } else if (cmds[j].type == Rdb_memcached_cmd::GET) {
+        mappings.clear();
+        add_mappings(cmds[j]);
+        if (!mappings.empty()) {
+          begin_reads(mappings);
+        }
+        execute_get(cmds[j]);
+        if (!mappings.empty()) {
+          end_reads();
+        }
+      } else {
+        cmds[j].conn->out.append(cmds[j].reply);
+      }
+    }
+  }
+}
+
+/*
+  Find the container of a key.
+
+  @param[out] mapping  index of the container in rdb_memcached_mappings
+  @param[out] name     the key without the container prefix
+  @param[out] length   length of name
+
+  @return false if no container is configured
+*/
+bool Rdb_memcached_thread::resolve_key(const std::string &key, uint *mapping,
+                                       const char **name,
+                                       size_t *length) const {
+  if (rdb_memcached_mappings.empty()) {
+    return false;
+  }
+
+  *mapping = 0;
+  *name = key.data();
+  *length = key.size();
+
+  if (key.compare(0, 2, "@@") == 0) {
+    const size_t dot = key.find('.', 2);
+    if (dot != std::string::npos) {
+      for (uint i = 0; i < rdb_memcached_mappings.size(); i++) {
+        if (key.compare(2, dot - 2, rdb_memcached_mappings[i].name) == 0) {
+          *mapping = i;
+          *name = key.data() + dot + 1;
+          *length = key.size() - dot - 1;
+          break;
+        }
+      }
+    }
+  }
+
+  return true;
+}
+
+void Rdb_memcached_thread::begin_statement() {
+  lex_start(m_thd);
+  mysql_reset_thd_for_next_command(m_thd);
+  m_thd->set_query_id(next_query_id());
+  m_thd->set_time();
+  // Keys and values that do not convert exactly are rejected
+  m_thd->count_cuted_fields = CHECK_FIELD_WARN;
+  m_thd->set_current_stmt_binlog_format_row();
+}
+
+/*
+  Check that an opened table can serve its container and resolve the key
+  and value columns.
+
+  @return true if it can not, with the reason in ot->error
+*/
+bool Rdb_memcached_thread::resolve_fields(const Rdb_memcached_mapping &mapping,
+                                         mapped_table *ot) {
+  TABLE *const table = ot->table;
+  table->use_all_columns();
+
+  ot->key_field = rdb_memcached_find_field(table, mapping.key_column);
+  if (ot->key_field == nullptr) {
+    ot->error = "key column not found";
+    return true;
+  }
+
+  const uint pk = table->s->primary_key;
+  if (pk == MAX_KEY || table->key_info[pk].user_defined_key_parts != 1 ||
+      table->key_info[pk].key_part[0].field != ot->key_field) {
+    ot->error = "key column is not the primary key";
+    return true;
+  }
+
+  ot->value_fields.clear();
+  for (const auto &column : mapping.value_columns) {
+    Field *const field = rdb_memcached_find_field(table, column);
+    if (field == nullptr) {
+      ot->error = "value column not found";
+      return true;
+    }
+    ot->value_fields.push_back(field);
+  }
+
+  const std::string name = mapping.db + "." + mapping.table;
+  ot->tbl_def = rdb_get_ddl_manager()->find(name);
+  if (ot->tbl_def == nullptr) {
+    ot->error = "not a RocksDB table";
+    return true;
+  }
+
+  return false;
+}
+
+/*
+  Open and lock the tables of the given containers for reading, and take
+  the snapshot all gets until end_reads() read.
+*/
+void Rdb_memcached_thread::begin_reads(const std::vector<uint> &mappings) {
+  begin_statement();
+
+  m_table_lists.clear();
+  m_table_lists.resize(mappings.size());
+  for (size_t i = 0; i < mappings.size(); i++) {
+    const Rdb_memcached_mapping &mapping = rdb_memcached_mappings[mappings[i]];
+    TABLE_LIST *const tl = &m_table_lists[i];
+    tl->init_one_table(mapping.db.c_str(), mapping.db.size(),
+                       mapping.table.c_str(), mapping.table.size(),
+                       mapping.table.c_str(), TL_READ);
+    if (i > 0) {
+      m_table_lists[i - 1].next_global = tl;
+      m_table_lists[i - 1].next_local = tl;
+    }
+  }
+
+  if (open_and_lock_tables(m_thd, m_table_lists.data(), false, 0)) {
+    const std::string error =
+        m_thd->is_error() ? m_thd->get_stmt_da()->message() : "open failed";
+    m_thd->clear_error();
+    for (const uint mapping : mappings) {
+      m_tables[mapping].error = error;
+    }
+    return;
+  }
+
+  for (size_t i = 0; i < mappings.size(); i++) {
+    mapped_table *const ot = &m_tables[mappings[i]];
+    ot->table = m_table_lists[i].table;
+    if (resolve_fields(rdb_memcached_mappings[mappings[i]], ot)) {
+      continue;
+    }
+
+    ot->pk_def = ot->tbl_def->m_key_descr_arr[ot->table->s->primary_key];
+    ot->converter.reset(new Rdb_converter(m_thd, ot->tbl_def, ot->table));
+    ot->converter->setup_field_decoders(ot->table->read_set);
+  }
+
+  Rdb_transaction *const tx = get_tx_from_thd(m_thd);
+  if (tx != nullptr && rdb_tx_started(tx)) {
+    rdb_tx_acquire_snapshot(tx);
+  }
+}
+
+void Rdb_memcached_thread::end_reads() {
+  for (auto &ot : m_tables) {
+    ot.converter.reset();
+    ot.pk_def.reset();
+    ot.table = nullptr;
+    ot.tbl_def = nullptr;
+    ot.error.clear();
+  }
+
+  trans_commit_stmt(m_thd);
+  close_thread_tables(m_thd);
+  m_thd->mdl_context.release_transactional_locks();
+  m_thd->clear_error();
+  free_root(m_thd->mem_root, MYF(MY_KEEP_PREALLOC));
+}
+
+/*
+  get <key>*: look up the keys with one MultiGet per container, in the
+  snapshot of the current batch.
+*/
+void Rdb_memcached_thread::execute_get(const Rdb_memcached_cmd &cmd) {
+  std::string &out = cmd.conn->out;
+  const size_t n = cmd.keys.size();
+  rdb_memcached_cmd_get += n;
+
+  std::vector<uint> key_mappings(n);
+  std::vector<std::pair<const char *, size_t>> key_names(n);
+  for (size_t i = 0; i < n; i++) {
+    if (!resolve_key(cmd.keys[i], &key_mappings[i], &key_names[i].first,
+                     &key_names[i].second)) {
+      out.append("SERVER_ERROR no containers configured\r\n");
+      return;
+    }
+
+    const mapped_table &ot = m_tables[key_mappings[i]];
+    if (ot.table == nullptr || !ot.error.empty()) {
+      out.append("SERVER_ERROR ")
+          .append(ot.error.empty() ? "table is not open" : ot.error)
+          .append("\r\n");
+      return;
+    }
+  }
+
+  Rdb_transaction *const tx = get_tx_from_thd(m_thd);
+  std::vector<std::string> values(n);
+  std::vector<bool> found(n, false);
+  std::vector<size_t> key_index;
+  std::vector<rocksdb::Slice> key_slices;
+
+  for (size_t first = 0; first < n; first++) {
+    // Handle each container once, at its first key
+    const uint mapping = key_mappings[first];
+    if (std::find(key_mappings.begin(), key_mappings.begin() + first,
+                  mapping) != key_mappings.begin() + first) {
+      continue;
+    }
+
+    mapped_table &ot = m_tables[mapping];
+    TABLE *const table = ot.table;
+    const uint max_length = ot.pk_def->max_storage_fmt_length();
+    m_pack_buffer.resize(max_length);
+    m_packed_keys.resize(n * max_length);
+    key_index.clear();
+    key_slices.clear();
+
+    for (size_t i = first; i < n; i++) {
+      if (key_mappings[i] != mapping) {
+        continue;
+      }
+
+      // A key that does not convert to the key column can not be found
+      ot.key_field->set_notnull();
+      if (ot.key_field->store(key_names[i].first, key_names[i].second,
+                              ot.key_field->charset())) {
+        continue;
+      }
+
+      uchar *const packed =
+          m_packed_keys.data() + key_slices.size() * max_length;
+      const uint size = ot.pk_def->pack_record(
+          table, m_pack_buffer.data(), table->record[0], packed, nullptr,
+          false);
+      key_slices.emplace_back(reinterpret_cast<const char *>(packed), size);
+      key_index.push_back(i);
+    }
+
+    if (key_slices.empty()) {
+      continue;
+    }
+
+    const size_t count = key_slices.size();
+    std::vector<rocksdb::PinnableSlice> value_slices(count);
+    std::vector<rocksdb::Status> statuses(count);
+    rdb_tx_multi_get(tx, ot.pk_def->get_cf(), count, key_slices.data(),
+                     value_slices.data(), statuses.data(), false);
+
+    for (size_t k = 0; k < count; k++) {
+      if (statuses[k].IsNotFound()) {
+        continue;
+      }
+      if (!statuses[k].ok()) {
+        if (statuses[k].IsIOError() || statuses[k].IsCorruption()) {
+          rdb_handle_io_error(statuses[k], RDB_IO_ERROR_GENERAL);
+        }
+        out.append("SERVER_ERROR ").append(statuses[k].ToString());
+        out.append("\r\n");
+        return;
+      }
+
+      if (ot.converter->decode(ot.pk_def, table->record[0], &key_slices[k],
+                               &value_slices[k]) != HA_EXIT_SUCCESS) {
+        out.append("SERVER_ERROR failed to decode row\r\n");
+        return;
+      }
+
+      std::string &value = values[key_index[k]];
+      for (size_t f = 0; f < ot.value_fields.size(); f++) {
+        if (f > 0) {
+          value.push_back('|');
+        }
+        Field *const field = ot.value_fields[f];
+        if (!field->is_null()) {
+          const String *const str = field->val_str(&m_value_buffer);
+          value.append(str->ptr(), str->length());
+        }
+      }
+      found[key_index[k]] = true;
+    }
+  }
+
+  for (size_t i = 0; i < n; i++) {
+    if (!found[i]) {
+      rdb_memcached_get_misses++;
+      continue;
+    }
+    rdb_memcached_get_hits++;
+    out.append("VALUE ").append(cmd.keys[i]).append(" 0 ");
+    out.append(std::to_string(values[i].size())).append("\r\n");
+    out.append(values[i]).append("\r\n");
+  }
+  out.append("END\r\n");
+}
+
+/*
+  set <key>: insert the row, or update the value columns of the row with
+  the key, in a transaction of its own. Flags and expiration time are
+  ignored.
+*/
+void Rdb_memcached_thread::execute_set(const Rdb_memcached_cmd &cmd) {
+  std::string reply;
+  rdb_memcached_cmd_set++;
+
+  uint mapping;
+  const char *name;
+  size_t length;
+  if (!rocksdb_memcached_enable_set) {
+    reply = "SERVER_ERROR set is disabled";
+  } else if (opt_readonly || opt_super_readonly) {
+    // Clients are not authenticated, so they never have SUPER
+    reply = "SERVER_ERROR the server is read-only";
+  } else if (!resolve_key(cmd.keys[0], &mapping, &name, &length)) {
+    reply = "SERVER_ERROR no containers configured";
+  } else {
+    const Rdb_memcached_mapping &m = rdb_memcached_mappings[mapping];
+    begin_statement();
+    m_thd->lex->sql_command = SQLCOM_INSERT;
+
+    TABLE_LIST tl;
+    tl.init_one_table(m.db.c_str(), m.db.size(), m.table.c_str(),
+                      m.table.size(), m.table.c_str(), TL_WRITE);
+    mapped_table ot;
+    ot.table = open_n_lock_single_table(m_thd, &tl, TL_WRITE, 0);
+
+    int error = 0;
+    if (ot.table == nullptr) {
+      reply = std::string("SERVER_ERROR ") +
+              (m_thd->is_error() ? m_thd->get_stmt_da()->message()
+                                 : "table is not open");
+    } else if (resolve_fields(m, &ot)) {
+      reply = "SERVER_ERROR " + ot.error;
+    } else {
+      TABLE *const table = ot.table;
+      const uint pk = table->s->primary_key;
+      KEY *const key_info = &table->key_info[pk];
+      uchar key[MAX_KEY_LENGTH];
+
+      restore_record(table, s->default_values);
+      ot.key_field->set_notnull();
+      if (ot.key_field->store(name, length, ot.key_field->charset())) {
+        reply = "CLIENT_ERROR invalid key";
+      } else {
+        key_copy(key, table->record[0], key_info, key_info->key_length);
+        error = table->file->ha_index_read_idx_map(
+            table->record[0], pk, key, HA_WHOLE_KEY, HA_READ_KEY_EXACT);
+        if (!error) {
+          // Update the value columns of the existing row
+          store_record(table, record[1]);
+          if (rdb_memcached_store_value(ot.value_fields, cmd.data)) {
+            reply = "CLIENT_ERROR invalid value";
+          } else {
+            error = table->file->ha_update_row(table->record[1],
+                                               table->record[0]);
+            if (error == HA_ERR_RECORD_IS_THE_SAME) {
+              error = 0;
+            }
+          }
+        } else if (error == HA_ERR_KEY_NOT_FOUND ||
+                   error == HA_ERR_END_OF_FILE) {
+          restore_record(table, s->default_values);
+          ot.key_field->store(name, length, ot.key_field->charset());
+          if (rdb_memcached_store_value(ot.value_fields, cmd.data)) {
+            error = 0;
+            reply = "CLIENT_ERROR invalid value";
+          } else {
+            error = table->file->ha_write_row(table->record[0]);
+          }
+        }
+      }
+
+      if (error == HA_ERR_FOUND_DUPP_KEY) {
+        // Conflict on a unique secondary key
+        reply = "NOT_STORED";
+      } else if (error) {
+        table->file->print_error(error, MYF(0));
+        reply = std::string("SERVER_ERROR ") +
+                (m_thd->is_error() ? m_thd->get_stmt_da()->message()
+                                   : "write failed");
+      }
+    }
+
+    if (reply.empty() && !trans_commit_stmt(m_thd)) {
+      reply = "STORED";
+    } else {
+      trans_rollback_stmt(m_thd);
+      if (reply.empty()) {
+        reply = "SERVER_ERROR commit failed";
+      }
+    }
+    close_thread_tables(m_thd);
+    m_thd->mdl_context.release_transactional_locks();
+    m_thd->clear_error();
+    free_root(m_thd->mem_root, MYF(MY_KEEP_PREALLOC));
+  }
+
+  if (!cmd.noreply) {
+    cmd.conn->out.append(reply).append("\r\n");
+  }
+}
+
+static int rdb_memcached_init(void *const p MY_ATTRIBUTE((__unused__))) {
+  DBUG_ENTER_FUNC();
+
+  if (rdb_memcached_parse_mappings(rocksdb_memcached_mappings,
+                                   &rdb_memcached_mappings)) {
+    DBUG_RETURN(HA_EXIT_FAILURE);
+  }
+
+  if (rocksdb_memcached_port == 0) {
+    DBUG_RETURN(HA_EXIT_SUCCESS);
+  }
+
+  struct sockaddr_in addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(rocksdb_memcached_port);
+  if (inet_pton(AF_INET, rocksdb_memcached_bind_address, &addr.sin_addr) != 1) {
+    // NO_LINT_DEBUG
+    sql_print_error("RocksDB: Invalid rocksdb_memcached_bind_address '%s'",
+                    rocksdb_memcached_bind_address);
+    DBUG_RETURN(HA_EXIT_FAILURE);
+  }
+
+  const int fd =
+      socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+  const int one = 1;
+  if (fd < 0 ||
+      setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one)) ||
+      bind(fd, reinterpret_cast<struct sockaddr *>(&addr), sizeof(addr)) ||
+      listen(fd, SOMAXCONN)) {
+    // NO_LINT_DEBUG
+    sql_print_error("RocksDB: Couldn't listen on memcached port %u (errno=%d)",
+                    rocksdb_memcached_port, errno);
+    if (fd >= 0) {
+      close(fd);
+    }
+    DBUG_RETURN(HA_EXIT_FAILURE);
+  }
+  rdb_memcached_listen_fd = fd;
+
+  for (uint i = 0; i < rocksdb_memcached_threads; i++) {
+    std::unique_ptr<Rdb_memcached_thread> thread(new Rdb_memcached_thread(fd));
+#ifdef HAVE_PSI_INTERFACE
+    thread->init(rdb_signal_memcached_psi_mutex_key,
+                 rdb_signal_memcached_psi_cond_key);
+    const int err = thread->create_thread(MEMCACHED_THREAD_NAME,
+                                          rdb_memcached_psi_thread_key);
+#else
+    thread->init();
+    const int err = thread->create_thread(MEMCACHED_THREAD_NAME);
+#endif
+    if (err != 0) {
+      // NO_LINT_DEBUG
+      sql_print_error(
+          "RocksDB: Couldn't start the memcached thread: (errno=%d)", err);
+      break;
+    }
+    rdb_memcached_threads.push_back(std::move(thread));
+  }
+
+  // NO_LINT_DEBUG
+  sql_print_information("RocksDB: memcached frontend listening on %s:%u",
+                        rocksdb_memcached_bind_address, rocksdb_memcached_port);
+
+  DBUG_RETURN(HA_EXIT_SUCCESS);
+}
+
+static int rdb_memcached_deinit(void *const p MY_ATTRIBUTE((__unused__))) {
+  DBUG_ENTER_FUNC();
+
+  for (auto &thread : rdb_memcached_threads) {
+    thread->signal(true);
+  }
+  for (auto &thread : rdb_memcached_threads) {
+    const int err = thread->join();
+    if (err != 0) {
+      // NO_LINT_DEBUG
+      sql_print_error(
+          "RocksDB: Couldn't stop the memcached thread: (errno=%d)", err);
+    }
+  }
+  rdb_memcached_threads.clear();
+
+  if (rdb_memcached_listen_fd >= 0) {
+    close(rdb_memcached_listen_fd);
+    rdb_memcached_listen_fd = -1;
+  }
+  rdb_memcached_mappings.clear();
+
+  DBUG_RETURN(HA_EXIT_SUCCESS);
+}
+
+static struct st_mysql_daemon rdb_memcached_daemon = {
+    MYSQL_DAEMON_INTERFACE_VERSION};
+
+struct st_mysql_plugin rdb_memcached_plugin = {
+    MYSQL_DAEMON_PLUGIN,
+    &rdb_memcached_daemon,
+    "ROCKSDB_MEMCACHED",
+    "Facebook",
+    "Memcached protocol frontend for RocksDB tables",
+    PLUGIN_LICENSE_GPL,
+    rdb_memcached_init,
+    rdb_memcached_deinit,
+    0x0001,                         /* version number (0.1) */
+    nullptr,                        /* status variables */
+    rdb_memcached_system_variables, /* system variables */
+    nullptr,                        /* config options */
+    0,                              /* flags */
+};
+
+}  // namespace myrocks
@@ -0,0 +1,171 @@
+/*
+   Copyright (c) 2020, Facebook, Inc.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
+#pragma once
+
+/* C++ standard header files */
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/* MySQL header files */
+#include "./sql_string.h"
+
+/* MyRocks header files */
+#include "./rdb_datadic.h"
+#include "./rdb_threads.h"
+
+namespace myrocks {
+
+class Rdb_converter;
+
+/*
+  Maps a memcached container to a MyRocks table. Keys are looked up in the
+  single column primary key key_column; the value is value_columns joined
+  with '|'.
+
+  Configured with rocksdb_memcached_mappings, a ';' separated list of
+
+    name=db.table:key_column:value_column[,value_column...]
+
+  A key of the form "@@name.key" is looked up in container name, any other
+  key in the first container of the list.
+*/
+struct Rdb_memcached_mapping {
+  std::string name;
+  std::string db;
+  std::string table;
+  std::string key_column;
+  std::vector<std::string> value_columns;
+};
+
+/*
+  A client connection, owned by the network thread that accepted it.
+*/
+struct Rdb_memcached_conn {
+  int fd = -1;
+
+  // Received bytes that have not been parsed yet
+  std::string in;
+
+  // Responses not written yet, starting at out_pos
+  std::string out;
+  size_t out_pos = 0;
+
+  // EPOLLOUT is registered as out could not be written completely
+  bool want_write = false;
+
+  // EPOLLIN is registered as not too much output is pending
+  bool want_read = true;
+
+  // Close once out has been written
+  bool closing = false;
+};
+
+/*
+  A parsed memcached command.
+*/
+struct Rdb_memcached_cmd {
+  enum cmd_type { GET, SET, REPLY } type;
+
+  Rdb_memcached_conn *conn;
+
+  // Keys of get and gets, key and data of set
+  std::vector<std::string> keys;
+  std::string data;
+  bool noreply = false;
+
+  // Response of the commands answered while parsing
+  std::string reply;
+};
+
+/*
+  Network thread of the memcached frontend.
+
+  Each thread runs an epoll loop over the shared listening socket and the
+  connections it accepted, and executes the commands received in a loop
+  iteration in one batch: the gets of the batch read a single snapshot,
+  and the keys of a get are fetched with one MultiGet per table. A set
+  ends the batch for its connection and runs in its own transaction
+  through the handler interface, so secondary keys and binary logging are
+  maintained as for an INSERT.
+*/
+class Rdb_memcached_thread : public Rdb_thread {
+ public:
+  explicit Rdb_memcached_thread(int listen_fd) : m_listen_fd(listen_fd) {}
+
+  virtual void run() override;
+
+ private:
+  /*
+    A mapped table opened for a batch of gets.
+  */
+  struct mapped_table {
+    TABLE *table = nullptr;
+    Rdb_tbl_def *tbl_def = nullptr;
+    Field *key_field = nullptr;
+    std::vector<Field *> value_fields;
+    std::shared_ptr<Rdb_key_def> pk_def;
+    std::unique_ptr<Rdb_converter> converter;
+
+    // Why the table can not be used, empty if it can
+    std::string error;
+  };
+
+  bool is_killed();
+  void accept_connections();
+  void read_connection(Rdb_memcached_conn *conn);
+  void write_connection(Rdb_memcached_conn *conn);
+  void close_connection(Rdb_memcached_conn *conn);
+  void update_events(Rdb_memcached_conn *conn);
+  void parse_commands(Rdb_memcached_conn *conn,
+                      std::vector<Rdb_memcached_cmd> *cmds);
+  void execute(std::vector<std::vector<Rdb_memcached_cmd>> *batch);
+
+  bool resolve_key(const std::string &key, uint *mapping,
+                   const char **name, size_t *length) const;
+  void begin_statement();
+  void begin_reads(const std::vector<uint> &mappings);
+  void end_reads();
+  bool resolve_fields(const Rdb_memcached_mapping &mapping,
+                      mapped_table *ot);
+  void execute_get(const Rdb_memcached_cmd &cmd);
+  void execute_set(const Rdb_memcached_cmd &cmd);
+  void append_stats(std::string *out) const;
+
+  const int m_listen_fd;
+  int m_epoll_fd = -1;
+  THD *m_thd = nullptr;
+
+  std::unordered_map<int, std::unique_ptr<Rdb_memcached_conn>> m_conns;
+
+  // Connections that may hold received commands not parsed yet as they
+  // were over the output limit
+  std::vector<int> m_resumed;
+
+  // Tables of the current batch of gets, indexed like the mappings
+  std::vector<mapped_table> m_tables;
+  std::vector<TABLE_LIST> m_table_lists;
+
+  // Buffers for packing keys
+  std::vector<uchar> m_pack_buffer;
+  std::vector<uchar> m_packed_keys;
+  String m_value_buffer;
+};
+
+extern struct st_mysql_plugin rdb_memcached_plugin;
+
+}  // namespace myrocks
@@ -0,0 +1,310 @@
+/* Copyright (c) 2020, Facebook, Inc.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA */
+
+/**
+  @file
+
+  Unit tests and concurrency benchmarks of the key cache, with one lock
+  and partitioned (key_cache_partitions)
+*/
+
+// First include (the generated) my_config.h, to get correct platform defines.
+#include "my_config.h"
+#include <gtest/gtest.h>
+
+#include <my_global.h>
+#include <my_sys.h>
+#include <my_atomic.h>
+#include <keycache.h>
+
+
+namespace mysys_keycache_unittest {
+
+#include "thr_template.cc"
+
+const uint BLOCK_SIZE= 1024;
+const uint FILE_BLOCKS= 4096;
+const uint WORDS= BLOCK_SIZE / sizeof(ulonglong);
+
+KEY_CACHE keycache;
+File file;
+char file_name[FN_REFLEN];
+volatile int32 writer_id;
+
+/* Every word of a block holds the block number and a generation */
+static inline ulonglong word(uint block, uint gen)
+{
+  return ((ulonglong) block << 32) | gen;
+}
+
+static void fill_block(ulonglong *buff, uint block, uint gen)
+{
+  for (uint i= 0; i < WORDS; i++)
+    buff[i]= word(block, gen);
+}
+
+/* A block is consistent if it was not mixed from several writes */
+static bool check_block(const ulonglong *buff, uint block)
+{
+  for (uint i= 0; i < WORDS; i++)
+    if (buff[i] >> 32 != block || buff[i] != buff[0])
+      return false;
+  return true;
+}
+
+static void create_file()
+{
+  ulonglong buff[WORDS];
+  file= create_temp_file(file_name, NULL, "kc", O_RDWR, MYF(MY_WME));
+  ASSERT_LE(0, file);
+  for (uint b= 0; b < FILE_BLOCKS; b++)
+  {
+    fill_block(buff, b, 0);
+    ASSERT_EQ(0U, my_pwrite(file, (uchar*) buff, BLOCK_SIZE,
+                            (my_off_t) b * BLOCK_SIZE, MYF(MY_NABP)));
+  }
+}
+
+static void init_cache(uint partitions, size_t use_mem)
+{
+  memset(&keycache, 0, sizeof(keycache));
+  keycache.param_partitions= partitions;
+  EXPECT_LT(0, init_key_cache(&keycache, BLOCK_SIZE, use_mem, 100, 300));
+}
+
+static void end_cache()
+{
+  EXPECT_EQ(0, flush_key_blocks(&keycache, file, FLUSH_RELEASE));
+  end_key_cache(&keycache, 1);
+}
+
+/*
+  Random single block and multi block reads
+*/
+pthread_handler_t test_read(void *arg)
+{
+  int m= *(int *)arg;
+  ulonglong buff[WORDS * 8];
+  uint x= (uint) (intptr) &m;
+  int errors= 0;
+
+  my_thread_init();
+  for (; m ; m--)
+  {
+    x= x * 1103515245 + 12345;
+    uint count= (x >> 8) % 8 == 0 ? 1 + (x >> 12) % 8 : 1;
+    uint block= (x >> 16) % (FILE_BLOCKS - count + 1);
+    if (!key_cache_read(&keycache, file, (my_off_t) block * BLOCK_SIZE, 3,
+                        (uchar*) buff, count * BLOCK_SIZE, BLOCK_SIZE, 0))
+      errors++;
+    for (uint i= 0; i < count; i++)
+      if (!check_block(buff + i * WORDS, block + i))
+        errors++;
+  }
+
+  mysql_mutex_lock(&mutex);
+  bad+= errors;
+  if (!--running_threads) mysql_cond_signal(&cond);
+  mysql_mutex_unlock(&mutex);
+  my_thread_end();
+  return 0;
+}
+
+/*
+  Reads as above, every tenth request rewrites a block. Each thread writes
+  its own blocks, as a MyISAM index is not written concurrently.
+*/
+pthread_handler_t test_read_write(void *arg)
+{
+  int m= *(int *)arg;
+  ulonglong buff[WORDS];
+  uint x= (uint) (intptr) &m;
+  uint id= (uint) my_atomic_add32(&writer_id, 1);
+  int errors= 0;
+
+  my_thread_init();
+  for (uint gen= 1; m ; m--, gen++)
+  {
+    x= x * 1103515245 + 12345;
+    uint block= (x >> 16) % FILE_BLOCKS;
+    if ((x >> 8) % 10 == 0)
+    {
+      block= block - block % THREADS + id % THREADS;
+      if (block >= FILE_BLOCKS)
+        continue;
+      fill_block(buff, block, gen);
+      if (key_cache_write(&keycache, file, (my_off_t) block * BLOCK_SIZE, 3,
+                          (uchar*) buff, BLOCK_SIZE, BLOCK_SIZE, 1))
+        errors++;
+      continue;
+    }
+    if (!key_cache_read(&keycache, file, (my_off_t) block * BLOCK_SIZE, 3,
+                        (uchar*) buff, BLOCK_SIZE, BLOCK_SIZE, 0) ||
+        !check_block(buff, block))
+      errors++;
+  }
+
+  mysql_mutex_lock(&mutex);
+  bad+= errors;
+  if (!--running_threads) mysql_cond_signal(&cond);
+  mysql_mutex_unlock(&mutex);
+  my_thread_end();
+  return 0;
+}
+
+/* The cached blocks must match the file */
+static void check_file()
+{
+  ulonglong cached[WORDS], direct[WORDS];
+  uint mismatches= 0;
+
+  for (uint b= 0; b < FILE_BLOCKS; b++)
+  {
+    ASSERT_TRUE(key_cache_read(&keycache, file, (my_off_t) b * BLOCK_SIZE, 3,
+                               (uchar*) cached, BLOCK_SIZE, BLOCK_SIZE, 0));
+    ASSERT_EQ(0U, my_pread(file, (uchar*) direct, BLOCK_SIZE,
+                           (my_off_t) b * BLOCK_SIZE, MYF(MY_NABP)));
+    if (memcmp(cached, direct, BLOCK_SIZE))
+      mismatches++;
+  }
+  EXPECT_EQ(0U, mismatches);
+}
+
+/*
+  Concurrent reads, then concurrent reads and writes, cycles per thread.
+  Every block read must be consistent, and the cache must match the file.
+*/
+static void run_concurrently(const char *name, uint partitions, int cycles)
+{
+  /* A quarter of the file fits in the cache */
+  init_cache(partitions, FILE_BLOCKS / 4 * (BLOCK_SIZE + 256));
+
+  test_concurrently(name, test_read, THREADS, cycles);
+
+  writer_id= 0;
+  test_concurrently(name, test_read_write, THREADS, cycles);
+
+  EXPECT_EQ(0, flush_key_blocks(&keycache, file, FLUSH_KEEP));
+  check_file();
+  end_cache();
+}
+
+
+class KeyCacheTest : public ::testing::Test
+{
+protected:
+  virtual void SetUp()
+  {
+    mysql_mutex_init(0, &mutex, 0);
+    mysql_cond_init(0, &cond, NULL);
+    pthread_attr_init(&thr_attr);
+    pthread_attr_setdetachstate(&thr_attr, PTHREAD_CREATE_DETACHED);
+    create_file();
+  }
+
+  virtual void TearDown()
+  {
+    my_close(file, MYF(0));
+    my_delete(file_name, MYF(0));
+    mysql_mutex_destroy(&mutex);
+    mysql_cond_destroy(&cond);
+    pthread_attr_destroy(&thr_attr);
+  }
+};
+
+
+TEST_F(KeyCacheTest, Partitioned)
+{
+  ulonglong buff[WORDS * 16];
+
+  init_cache(4, 256 * (BLOCK_SIZE + 256));
+  ASSERT_TRUE(keycache.part_cache != NULL);
+
+  /* Misses of several blocks are read at once, then hit */
+  for (int pass= 0; pass < 2; pass++)
+  {
+    ASSERT_TRUE(key_cache_read(&keycache, file, 10 * BLOCK_SIZE, 3,
+                               (uchar*) buff, 16 * BLOCK_SIZE, BLOCK_SIZE, 0));
+    for (uint i= 0; i < 16; i++)
+      EXPECT_TRUE(check_block(buff + i * WORDS, 10 + i));
+  }
+  update_key_cache_stats(&keycache);
+  EXPECT_EQ(32U, keycache.global_cache_r_requests);
+  EXPECT_EQ(16U, keycache.global_cache_read);
+  EXPECT_EQ(16U, keycache.blocks_used);
+
+  /* Reads not aligned to cache blocks */
+  ASSERT_TRUE(key_cache_read(&keycache, file, 20 * BLOCK_SIZE + 512, 3,
+                             (uchar*) buff, BLOCK_SIZE, BLOCK_SIZE, 0));
+  EXPECT_EQ(word(20, 0), buff[0]);
+  EXPECT_EQ(word(21, 0), buff[WORDS - 1]);
+
+  /* Writes update cached blocks and the file */
+  fill_block(buff, 12, 7);
+  EXPECT_EQ(0, key_cache_write(&keycache, file, 12 * BLOCK_SIZE, 3,
+                               (uchar*) buff, BLOCK_SIZE / 2, BLOCK_SIZE, 1));
+  memset(buff, 0, sizeof(buff));
+  ASSERT_TRUE(key_cache_read(&keycache, file, 12 * BLOCK_SIZE, 3,
+                             (uchar*) buff, BLOCK_SIZE, BLOCK_SIZE, 0));
+  EXPECT_EQ(word(12, 7), buff[0]);
+  EXPECT_EQ(word(12, 0), buff[WORDS - 1]);
+  EXPECT_EQ(0U, my_pread(file, (uchar*) buff, BLOCK_SIZE, 12 * BLOCK_SIZE,
+                         MYF(MY_NABP)));
+  EXPECT_EQ(word(12, 7), buff[0]);
+
+  /* Releasing the file drops its blocks */
+  EXPECT_EQ(0, flush_key_blocks(&keycache, file, FLUSH_RELEASE));
+  update_key_cache_stats(&keycache);
+  EXPECT_EQ(0U, keycache.blocks_used);
+
+  /* Reads past the end of the file fail */
+  EXPECT_TRUE(key_cache_read(&keycache, file, FILE_BLOCKS * BLOCK_SIZE, 3,
+                             (uchar*) buff, BLOCK_SIZE, BLOCK_SIZE, 0) ==
+              NULL);
+
+  /* Resize, also changing the number of partitions */
+  keycache.param_partitions= 2;
+  EXPECT_LT(0, resize_key_cache(&keycache, BLOCK_SIZE,
+                                512 * (BLOCK_SIZE + 256), 100, 300));
+  check_file();
+
+  EXPECT_EQ(0, reset_key_cache_counters("test", &keycache));
+  update_key_cache_stats(&keycache);
+  EXPECT_EQ(0U, keycache.global_cache_r_requests);
+  end_cache();
+}
+
+
+TEST_F(KeyCacheTest, ConcurrentAccess)
+{
+  run_concurrently("key cache", 0, CYCLES / 10);
+  run_concurrently("partitioned key cache", 16, CYCLES / 10);
+}
+
+
+/*
+  Benchmarks, compare the times of the two tests.
+*/
+TEST_F(KeyCacheTest, DISABLED_ConcurrentAccessOneLock)
+{
+  run_concurrently("key cache", 0, CYCLES * 4);
+}
+
+TEST_F(KeyCacheTest, DISABLED_ConcurrentAccessPartitioned)
+{
+  run_concurrently("partitioned key cache", 16, CYCLES * 4);
+}
+
+}
@@ -0,0 +1,126 @@
+/* Copyright (c) 2020, Facebook, Inc.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA */
+
+// First include (the generated) my_config.h, to get correct platform defines.
+#include "my_config.h"
+#include <gtest/gtest.h>
+
+#include <my_global.h>
+#include <my_sys.h>
+
+namespace mysys_my_alloc_unittest {
+
+const size_t PREALLOC_SIZE= 8192;
+const size_t MAX_SIZE= 1024 * 1024;
+
+/* Allocate total bytes in pieces, like a statement building its tree */
+static void allocate(MEM_ROOT *root, size_t total)
+{
+  for (size_t done= 0; done < total; done+= 200)
+    ASSERT_TRUE(alloc_root(root, 200) != NULL);
+}
+
+static uint count_blocks(MEM_ROOT *root)
+{
+  uint blocks= 0;
+  for (USED_MEM *block= root->free; block; block= block->next)
+    blocks++;
+  for (USED_MEM *block= root->used; block; block= block->next)
+    blocks++;
+  return blocks;
+}
+
+class MemRootRecycleTest : public ::testing::Test
+{
+protected:
+  virtual void SetUp()
+  {
+    init_alloc_root(&m_root, 1024, PREALLOC_SIZE);
+    m_recycle_size= 0;
+  }
+
+  virtual void TearDown()
+  {
+    free_root(&m_root, MYF(0));
+  }
+
+  void recycle(size_t max_size= MAX_SIZE)
+  {
+    recycle_root(&m_root, &m_recycle_size, PREALLOC_SIZE, max_size);
+  }
+
+  MEM_ROOT m_root;
+  size_t m_recycle_size;
+};
+
+
+TEST_F(MemRootRecycleTest, GrowsToStatements)
+{
+  allocate(&m_root, 100000);
+  EXPECT_LT(1U, count_blocks(&m_root));
+  recycle();
+  EXPECT_EQ(1U, count_blocks(&m_root));
+  EXPECT_TRUE(m_root.pre_alloc == m_root.free);
+
+  /* The same statement again fits in the kept block */
+  size_t allocated= m_root.allocated_size;
+  allocate(&m_root, 100000);
+  EXPECT_EQ(allocated, m_root.allocated_size);
+  EXPECT_EQ(1U, count_blocks(&m_root));
+  USED_MEM *block= m_root.used ? m_root.used : m_root.free;
+  recycle();
+  EXPECT_TRUE(block == m_root.free);
+  EXPECT_EQ(allocated, m_root.allocated_size);
+}
+
+
+TEST_F(MemRootRecycleTest, ShrinksSlowly)
+{
+  allocate(&m_root, 200000);
+  recycle();
+  size_t allocated= m_root.allocated_size;
+
+  /* Small statements keep the block for a while, then shrink it */
+  allocate(&m_root, 1000);
+  recycle();
+  EXPECT_EQ(allocated, m_root.allocated_size);
+  for (int i= 0; i < 30; i++)
+  {
+    allocate(&m_root, 1000);
+    recycle();
+  }
+  EXPECT_GT(allocated, m_root.allocated_size);
+  EXPECT_LE(PREALLOC_SIZE, m_root.allocated_size);
+  EXPECT_EQ(1U, count_blocks(&m_root));
+}
+
+
+TEST_F(MemRootRecycleTest, Limits)
+{
+  /* Never larger than max_size */
+  allocate(&m_root, 4 * MAX_SIZE);
+  recycle();
+  EXPECT_GE(MAX_SIZE + 1024, m_root.allocated_size);
+  EXPECT_EQ(1U, count_blocks(&m_root));
+
+  /* Without max_size, the same as free_root() keeping the prealloc block */
+  allocate(&m_root, 4 * MAX_SIZE);
+  recycle(0);
+  EXPECT_TRUE(m_root.pre_alloc == m_root.free);
+  EXPECT_EQ(m_root.pre_alloc->size, m_root.allocated_size);
+  EXPECT_EQ(1U, count_blocks(&m_root));
+}
+
+}
@@ -0,0 +1,207 @@
+/* Copyright (c) 2016, Facebook. All rights reserved.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA */
+
+// First include (the generated) my_config.h, to get correct platform defines,
+// then gtest.h (before any other MySQL headers), to avoid min() macros etc ...
+#include "my_config.h"
+#include <gtest/gtest.h>
+
+#include "rpl_gtid.h"
+
+namespace rpl_gtid_set_unittest {
+
+/*
+  Tests and microbenchmarks for Gtid_set operations on fragmented sets.
+
+  A fragmented set is what gtid_executed looks like after many
+  failovers, or on a server that applies transactions from many
+  sources out of order: many SIDs, each with many short intervals.
+  The sets below contain every other GNO, which gives the maximal
+  number of intervals for a given number of GTIDs.
+*/
+class GtidSetTest : public ::testing::Test
+{
+protected:
+  // Do each operation this many times. Increase value for benchmarking!
+  static const int num_iterations= 1;
+  // Number of SIDs in the sets.
+  static const int num_sids= 64;
+  // Number of intervals per SID.
+  static const int num_intervals= 2000;
+
+  GtidSetTest() : sid_map(NULL) {}
+
+  virtual void SetUp()
+  {
+    for (int i= 0; i < num_sids; i++)
+    {
+      rpl_sid sid;
+      char buf[rpl_sid::TEXT_LENGTH + 1];
+      my_snprintf(buf, sizeof(buf), "%08x-0000-0000-0000-%012x",
+                  i + 1, i + 1);
+      ASSERT_EQ(0, sid.parse(buf));
+      sidnos[i]= sid_map.add_sid(sid);
+      ASSERT_GT(sidnos[i], 0);
+    }
+  }
+
+  /*
+    Adds GNOs start, start + step, start + 2 * step, ... for all SIDs,
+    one at a time, the way gtid_executed is updated at commit.
+  */
+  void add_fragmented(Gtid_set *set, rpl_gno start, rpl_gno step)
+  {
+    for (int i= 0; i < num_sids; i++)
+    {
+      ASSERT_EQ(RETURN_STATUS_OK, set->ensure_sidno(sidnos[i]));
+      for (int j= 0; j < num_intervals; j++)
+        ASSERT_EQ(RETURN_STATUS_OK,
+                  set->_add_gtid(sidnos[i], start + j * step));
+    }
+  }
+
+  /// Returns the number of intervals of the given SIDNO.
+  static int n_intervals(const Gtid_set &set, rpl_sidno sidno)
+  {
+    Gtid_set::Const_interval_iterator ivit(&set, sidno);
+    int ret= 0;
+    while (ivit.get() != NULL)
+    {
+      ret++;
+      ivit.next();
+    }
+    return ret;
+  }
+
+  Sid_map sid_map;
+  rpl_sidno sidnos[num_sids];
+};
+const int GtidSetTest::num_iterations;
+const int GtidSetTest::num_sids;
+const int GtidSetTest::num_intervals;
+
+
+TEST_F(GtidSetTest, ContainsGtid)
+{
+  Gtid_set set(&sid_map);
+  add_fragmented(&set, 1, 2);
+  for (int iter= 0; iter < num_iterations; iter++)
+  {
+    for (int i= 0; i < num_sids; i++)
+    {
+      for (rpl_gno gno= 1; gno <= 2 * num_intervals; gno++)
+        EXPECT_EQ(gno % 2 == 1, set.contains_gtid(sidnos[i], gno));
+      EXPECT_FALSE(set.contains_gtid(sidnos[i], 2 * num_intervals + 1));
+    }
+  }
+}
+
+
+TEST_F(GtidSetTest, AddFillsHoles)
+{
+  Gtid_set set(&sid_map);
+  add_fragmented(&set, 1, 2);
+  EXPECT_EQ(num_intervals, n_intervals(set, sidnos[0]));
+  // Adding the even GNOs in reverse order merges all intervals into one.
+  for (rpl_gno gno= 2 * num_intervals; gno > 0; gno-= 2)
+    ASSERT_EQ(RETURN_STATUS_OK, set._add_gtid(sidnos[0], gno));
+  EXPECT_EQ(1, n_intervals(set, sidnos[0]));
+  EXPECT_TRUE(set.contains_gtid(sidnos[0], 2 * num_intervals));
+  // Removing GNOs in the middle splits the interval again.
+  for (rpl_gno gno= 2; gno <= 2 * num_intervals; gno+= 2)
+    ASSERT_EQ(RETURN_STATUS_OK, set._remove_gtid(sidnos[0], gno));
+  EXPECT_EQ(num_intervals, n_intervals(set, sidnos[0]));
+}
+
+
+TEST_F(GtidSetTest, AddGtidSet)
+{
+  Gtid_set odd(&sid_map);
+  Gtid_set even(&sid_map);
+  add_fragmented(&odd, 1, 2);
+  add_fragmented(&even, 2, 2);
+  for (int iter= 0; iter < num_iterations; iter++)
+  {
+    Gtid_set all(&sid_map);
+    ASSERT_EQ(RETURN_STATUS_OK, all.add_gtid_set(&odd));
+    EXPECT_EQ(num_intervals, n_intervals(all, sidnos[0]));
+    ASSERT_EQ(RETURN_STATUS_OK, all.add_gtid_set(&even));
+    for (int i= 0; i < num_sids; i++)
+      EXPECT_EQ(1, n_intervals(all, sidnos[i]));
+    EXPECT_TRUE(odd.is_subset(&all));
+    EXPECT_TRUE(even.is_subset(&all));
+    EXPECT_FALSE(all.is_subset(&odd));
+
+    ASSERT_EQ(RETURN_STATUS_OK, all.remove_gtid_set(&even));
+    EXPECT_TRUE(all.is_subset(&odd));
+    EXPECT_TRUE(odd.is_subset(&all));
+  }
+}
+
+
+TEST_F(GtidSetTest, Intersection)
+{
+  Gtid_set odd(&sid_map);
+  Gtid_set even(&sid_map);
+  Gtid_set every_third(&sid_map);
+  add_fragmented(&odd, 1, 2);
+  add_fragmented(&even, 2, 2);
+  add_fragmented(&every_third, 3, 3);
+  EXPECT_FALSE(odd.is_intersection_nonempty(&even));
+  EXPECT_TRUE(odd.is_intersection_nonempty(&every_third));
+  for (int iter= 0; iter < num_iterations; iter++)
+  {
+    Gtid_set result(&sid_map);
+    ASSERT_EQ(RETURN_STATUS_OK, odd.intersection(&even, &result));
+    EXPECT_TRUE(result.is_empty());
+    ASSERT_EQ(RETURN_STATUS_OK, odd.intersection(&every_third, &result));
+    // The odd multiples of 3 up to 2 * num_intervals.
+    EXPECT_EQ((2 * num_intervals / 3 + 1) / 2,
+              n_intervals(result, sidnos[0]));
+    EXPECT_TRUE(result.contains_gtid(sidnos[0], 3));
+    EXPECT_FALSE(result.contains_gtid(sidnos[0], 6));
+    EXPECT_TRUE(result.is_subset(&odd));
+    EXPECT_TRUE(result.is_subset(&every_third));
+  }
+}
+
+
+TEST_F(GtidSetTest, TextAndEncoding)
+{
+  Gtid_set set(&sid_map);
+  add_fragmented(&set, 1, 2);
+  for (int iter= 0; iter < num_iterations; iter++)
+  {
+    char *text;
+    ASSERT_LT(0, set.to_string(&text));
+    Gtid_set from_text(&sid_map);
+    ASSERT_EQ(RETURN_STATUS_OK, from_text.add_gtid_text(text));
+    my_free(text);
+    EXPECT_TRUE(from_text.is_subset(&set));
+    EXPECT_TRUE(set.is_subset(&from_text));
+
+    uint length;
+    uchar *encoded= set.encode(&length);
+    ASSERT_TRUE(encoded != NULL);
+    Gtid_set from_encoding(&sid_map);
+    ASSERT_EQ(RETURN_STATUS_OK,
+              from_encoding.add_gtid_encoding(encoded, length));
+    my_free(encoded);
+    EXPECT_TRUE(from_encoding.is_subset(&set));
+    EXPECT_TRUE(set.is_subset(&from_encoding));
+  }
+}
+
+}
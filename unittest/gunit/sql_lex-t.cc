@@ -0,0 +1,180 @@
+/* Copyright (c) 2020, Facebook, Inc.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA */
+
+/**
+  @file
+
+  Unit tests of the lexer token copies, and parse benchmarks over common
+  statement shapes, with and without query_prealloc_max_size.
+*/
+
+// First include (the generated) my_config.h, to get correct platform defines.
+#include "my_config.h"
+#include <gtest/gtest.h>
+
+#include "test_utils.h"
+
+#include "item.h"
+#include "sql_lex.h"
+#include "sql_parse.h"
+
+namespace sql_lex_unittest {
+
+using my_testing::Server_initializer;
+
+/* Statement shapes of a typical OLTP workload */
+const char *statement_shapes[]=
+{
+  "SELECT c1, c2, c3 FROM db1.t1 WHERE id = 12345",
+  "SELECT /* app:feed */ id, data, version FROM t2 WHERE user_id = 42 "
+  "AND type IN (1, 2, 3, 7, 11) ORDER BY time DESC LIMIT 50",
+  "SELECT COUNT(*) FROM t3 AS a JOIN t4 AS b ON a.id = b.a_id "
+  "WHERE a.status = 'active' AND b.created > '2020-01-01 00:00:00'",
+  "INSERT INTO t5 (id, name, value, updated) VALUES "
+  "(1, 'first', 1.5, NOW()), (2, 'second', 2.5, NOW()), "
+  "(3, 'third''s', 3.5, NOW())",
+  "UPDATE t6 SET counter = counter + 1, touched = 0x0A0B WHERE id = 99 "
+  "AND version = 3",
+  "DELETE FROM `t7` WHERE `key` = 'abc\\ndef' LIMIT 1",
+  "SELECT t.id, SUM(o.amount) AS total FROM t8 t LEFT JOIN orders o "
+  "USING (id) WHERE t.region = _latin1'emea' GROUP BY t.id "
+  "HAVING total > 1000",
+  "REPLACE INTO t9 SET k = 'x', v = 'y', expires = 1600000000"
+};
+
+class SqlLexTest : public ::testing::Test
+{
+protected:
+  virtual void SetUp()
+  {
+    initializer.SetUp();
+    reset_root_defaults(thd()->mem_root,
+                        thd()->variables.query_alloc_block_size,
+                        thd()->variables.query_prealloc_size);
+  }
+  virtual void TearDown() { initializer.TearDown(); }
+
+  THD *thd() { return initializer.thd(); }
+
+  /* Parse a statement like mysql_parse() does, without executing it */
+  bool parse(const char *query, bool keep_lex= false)
+  {
+    uint length= (uint) strlen(query);
+    /* The lexer may look a few characters past the end of the query */
+    char *buff= (char*) thd()->calloc(length + 32);
+    memcpy(buff, query, length);
+    thd()->set_query(buff, length);
+
+    Parser_state parser_state;
+    if (parser_state.init(thd(), buff, length))
+      return true;
+    lex_start(thd());
+    bool error= parse_sql(thd(), &parser_state, NULL);
+    if (!keep_lex)
+      end_statement();
+    return error;
+  }
+
+  void end_statement()
+  {
+    thd()->end_statement();
+    thd()->cleanup_after_query();
+    thd()->reset_query();
+  }
+
+  /* Parse all the statement shapes, rounds times */
+  void parse_shapes(ulong max_size, uint rounds)
+  {
+    thd()->variables.query_prealloc_max_size= max_size;
+    for (uint i= 0; i < rounds; i++)
+    {
+      for (uint j= 0; j < array_elements(statement_shapes); j++)
+      {
+        EXPECT_FALSE(parse(statement_shapes[j]));
+        thd()->free_statement_mem_root();
+      }
+    }
+  }
+
+  Server_initializer initializer;
+};
+
+
+TEST_F(SqlLexTest, TokenCopies)
+{
+  ASSERT_FALSE(parse("SELECT a1, `b``c`, 'x''y', 'p\\tq', 12, 2.5, "
+                     "very_long_identifier_name_of_a_column FROM t1",
+                     true));
+  List_iterator<Item> it(thd()->lex->select_lex.item_list);
+  Item *item;
+  String buff;
+
+  item= it++;
+  EXPECT_STREQ("a1", item->item_name.ptr());
+  item= it++;
+  EXPECT_STREQ("b`c", item->item_name.ptr());
+  item= it++;
+  EXPECT_STREQ("x'y", item->val_str(&buff)->c_ptr_safe());
+  item= it++;
+  EXPECT_STREQ("p\tq", item->val_str(&buff)->c_ptr_safe());
+  item= it++;
+  EXPECT_EQ(12, item->val_int());
+  item= it++;
+  EXPECT_EQ(2.5, item->val_real());
+  item= it++;
+  EXPECT_STREQ("very_long_identifier_name_of_a_column",
+               item->item_name.ptr());
+  end_statement();
+
+  ASSERT_TRUE(parse("SELECT a FROM t1 WHERE"));
+  thd()->clear_error();
+}
+
+
+/*
+  With query_prealloc_max_size, a statement shape that was seen before
+  is parsed without allocating memory.
+*/
+TEST_F(SqlLexTest, RecycledMemRoot)
+{
+  thd()->variables.query_prealloc_max_size= 1024 * 1024;
+  const char *query= statement_shapes[3];
+
+  ASSERT_FALSE(parse(query));
+  thd()->free_statement_mem_root();
+  size_t allocated= thd()->mem_root->allocated_size;
+  ASSERT_FALSE(parse(query));
+  EXPECT_EQ(allocated, thd()->mem_root->allocated_size);
+  thd()->free_statement_mem_root();
+  EXPECT_EQ(allocated, thd()->mem_root->allocated_size);
+}
+
+
+/*
+  Benchmarks, compare the times of the two tests.
+*/
+const uint parse_rounds= 20000;
+
+TEST_F(SqlLexTest, DISABLED_ParseFixedMemRoot)
+{
+  parse_shapes(0, parse_rounds);
+}
+
+TEST_F(SqlLexTest, DISABLED_ParseRecycledMemRoot)
+{
+  parse_shapes(1024 * 1024, parse_rounds);
+}
+
+}
@@ -0,0 +1,155 @@
+/* Copyright (c) 2020, Facebook, Inc.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA */
+
+/**
+  @file
+
+  Unit tests of the status published for processlist_snapshot, and of
+  snapshots taken while a thread keeps publishing.
+*/
+
+// First include (the generated) my_config.h, to get correct platform defines.
+#include "my_config.h"
+#include <gtest/gtest.h>
+
+#include "test_utils.h"
+
+#include "thd_status.h"
+
+#include <atomic>
+#include <thread>
+
+namespace thd_status_unittest {
+
+using my_testing::Server_initializer;
+
+class ThdStatusTest : public ::testing::Test
+{
+protected:
+  virtual void SetUp()
+  {
+    initializer.SetUp();
+    thd()->status_record= thd_status_acquire();
+    thd()->publish_status();
+  }
+  virtual void TearDown()
+  {
+    thd_status_release(thd()->status_record);
+    thd()->status_record= NULL;
+    initializer.TearDown();
+  }
+
+  THD *thd() { return initializer.thd(); }
+
+  /* The published status of thd(), NULL if it is not in the snapshot */
+  const Thd_status *find(const std::vector<Thd_status> &statuses)
+  {
+    for (const auto &status: statuses)
+      if (status.thread_id == thd()->thread_id())
+        return &status;
+    return NULL;
+  }
+
+  Server_initializer initializer;
+};
+
+
+TEST_F(ThdStatusTest, Publish)
+{
+  std::vector<Thd_status> statuses;
+  char query[]= "SELECT 1";
+
+  thd()->set_command(COM_QUERY);
+  thd()->set_query(query, strlen(query));
+  thd()->set_db(C_STRING_WITH_LEN("test"));
+  THD_STAGE_INFO(thd(), stage_sending_data);
+  thd()->set_stmt_start(12345);
+
+  thd_status_snapshot(&statuses);
+  const Thd_status *status= find(statuses);
+  ASSERT_TRUE(status != NULL);
+  EXPECT_EQ(COM_QUERY, status->command);
+  EXPECT_TRUE(status->has_query);
+  EXPECT_STREQ("SELECT 1", status->query);
+  EXPECT_TRUE(status->has_db);
+  EXPECT_STREQ("test", status->db);
+  EXPECT_STREQ(stage_sending_data.m_name, status->state);
+  EXPECT_EQ(12345U, status->stmt_start);
+  EXPECT_FALSE(status->killed);
+
+  /* Long queries are truncated */
+  std::string long_query(THD_STATUS_QUERY_LENGTH * 2, 'x');
+  thd()->set_query(&long_query[0], long_query.length());
+  statuses.clear();
+  thd_status_snapshot(&statuses);
+  status= find(statuses);
+  ASSERT_TRUE(status != NULL);
+  EXPECT_EQ((uint) THD_STATUS_QUERY_LENGTH, status->query_length);
+  EXPECT_EQ((size_t) THD_STATUS_QUERY_LENGTH, strlen(status->query));
+  thd()->reset_query();
+
+  /* Released records are not part of snapshots */
+  thd_status_release(thd()->status_record);
+  statuses.clear();
+  thd_status_snapshot(&statuses);
+  EXPECT_TRUE(find(statuses) == NULL);
+  thd()->status_record= thd_status_acquire();
+}
+
+
+/*
+  A thread publishes queries whose text encodes their length, while
+  snapshots are taken: every copy must come from a single publish.
+*/
+TEST_F(ThdStatusTest, ConcurrentSnapshots)
+{
+  Thd_status_record *record= thd()->status_record;
+  std::atomic<bool> done(false);
+  uint torn= 0, copies= 0;
+
+  std::thread writer([record, &done]()
+  {
+    for (uint i= 0; !done.load(); i++)
+    {
+      uint length= 1 + i % THD_STATUS_QUERY_LENGTH;
+      Thd_status *status= record->begin_write();
+      status->has_query= true;
+      status->query_length= length;
+      memset(status->query, 'a' + i % 26, length);
+      status->query[length]= 0;
+      record->end_write();
+    }
+  });
+
+  for (uint i= 0; i < 20000; i++)
+  {
+    std::vector<Thd_status> statuses;
+    thd_status_snapshot(&statuses);
+    const Thd_status *status= find(statuses);
+    if (!status || !status->has_query)
+      continue;
+    copies++;
+    if (strlen(status->query) != status->query_length ||
+        status->query[status->query_length - 1] != status->query[0])
+      torn++;
+  }
+  done.store(true);
+  writer.join();
+
+  EXPECT_LT(0U, copies);
+  EXPECT_EQ(0U, torn);
+}
+
+}